@@ -0,0 +1,109 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "client/annotation_arena.h"
+
+#include <type_traits>
+#include <utility>
+
+namespace crashpad {
+
+namespace {
+
+using AnnotationArenaForAssertion = TAnnotationArena<4, 1>;
+
+static_assert(std::is_standard_layout<AnnotationArenaForAssertion>::value,
+              "AnnotationArena must be standard layout");
+
+// ReadAnnotationArena() expects the entry table to immediately follow the
+// header, and the data area to immediately follow the entry table.
+static_assert(sizeof(AnnotationArenaForAssertion) ==
+                  sizeof(AnnotationArenaHeader) +
+                      sizeof(AnnotationArenaEntry) + 4,
+              "AnnotationArena must not contain padding");
+
+// Limits on the values accepted from another process’ header, so that a
+// corrupt header doesn’t cause an unreasonably large read.
+constexpr uint32_t kMaxMaxEntries = 64 * 1024;
+constexpr uint32_t kMaxCapacity = 16 * 1024 * 1024;
+
+}  // namespace
+
+size_t AnnotationArenaSizeInUse(const AnnotationArenaHeader& header) {
+  if (header.signature != AnnotationArenaHeader::kSignature ||
+      header.version < 1 ||
+      header.max_entries > kMaxMaxEntries ||
+      header.capacity > kMaxCapacity ||
+      header.entry_count > header.max_entries ||
+      header.used > header.capacity) {
+    return 0;
+  }
+
+  return sizeof(header) + header.max_entries * sizeof(AnnotationArenaEntry) +
+         header.used;
+}
+
+bool ReadAnnotationArena(const void* data,
+                         size_t size,
+                         std::map<std::string, std::string>* entries) {
+  if (size < sizeof(AnnotationArenaHeader)) {
+    LOG(WARNING) << "annotation arena too small";
+    return false;
+  }
+
+  AnnotationArenaHeader header;
+  memcpy(&header, data, sizeof(header));
+  const size_t size_in_use = AnnotationArenaSizeInUse(header);
+  if (!size_in_use) {
+    LOG(WARNING) << "unexpected annotation arena header";
+    return false;
+  }
+  if (size < size_in_use) {
+    LOG(WARNING) << "annotation arena too small";
+    return false;
+  }
+
+  const char* table =
+      static_cast<const char*>(data) + sizeof(AnnotationArenaHeader);
+  const char* arena_data =
+      table + header.max_entries * sizeof(AnnotationArenaEntry);
+
+  for (size_t index = 0; index < header.entry_count; ++index) {
+    AnnotationArenaEntry entry;
+    memcpy(&entry, table + index * sizeof(entry), sizeof(entry));
+
+    // Compare sizes against the space remaining after each offset, so that
+    // the sums can’t overflow.
+    if (entry.key_offset > header.used ||
+        entry.key_size > header.used - entry.key_offset ||
+        entry.value_offset > header.used ||
+        entry.value_size > header.used - entry.value_offset) {
+      LOG(WARNING) << "annotation arena entry " << index << " out of range";
+      continue;
+    }
+    if (!entry.key_size) {
+      continue;
+    }
+
+    std::string key(arena_data + entry.key_offset, entry.key_size);
+    std::string value(arena_data + entry.value_offset, entry.value_size);
+    if (!entries->insert(std::make_pair(key, value)).second) {
+      LOG(INFO) << "duplicate annotation " << key;
+    }
+  }
+
+  return true;
+}
+
+}  // namespace crashpad
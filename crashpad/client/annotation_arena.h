@@ -0,0 +1,359 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_CLIENT_ANNOTATION_ARENA_H_
+#define CRASHPAD_CLIENT_ANNOTATION_ARENA_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+
+#include "base/logging.h"
+#include "base/macros.h"
+#include "base/strings/string_piece.h"
+
+namespace crashpad {
+
+//! \brief The header at the start of every TAnnotationArena.
+//!
+//! All fields are 32 bits wide, so that the layout is the same in 32-bit and
+//! 64-bit processes. The header is followed by #max_entries
+//! AnnotationArenaEntry structures and then #capacity bytes of data.
+struct AnnotationArenaHeader {
+  enum : uint32_t {
+    kSignature = 'CPAn',
+    kVersion = 1,
+  };
+
+  //! \brief #kSignature.
+  uint32_t signature;
+
+  //! \brief #kVersion.
+  uint32_t version;
+
+  //! \brief The number of entries that the entry table has room for.
+  uint32_t max_entries;
+
+  //! \brief The number of bytes in the data area.
+  uint32_t capacity;
+
+  //! \brief The number of entries in use, at the start of the entry table.
+  uint32_t entry_count;
+
+  //! \brief The number of bytes allocated, at the start of the data area.
+  //!     Bytes beyond this are free.
+  uint32_t used;
+};
+
+//! \brief An entry in the table of a TAnnotationArena.
+//!
+//! Offsets are measured from the start of the data area.
+struct AnnotationArenaEntry {
+  uint32_t key_offset;
+  uint32_t key_size;
+  uint32_t value_offset;
+  uint32_t value_size;
+};
+
+//! \brief A map of annotations with variable-length keys and values, stored in
+//!     a fixed amount of storage so that it does not perform any dynamic
+//!     allocations for its operations.
+//!
+//! Keys and values are bump-allocated from a single data area and located
+//! through a table of offsets. When the data area is exhausted, the space left
+//! behind by replaced and removed entries is reclaimed by moving the remaining
+//! keys and values to the start of the data area. Because everything in use is
+//! at the start of the entry table and the data area, another process can copy
+//! an arena with a single read of AnnotationArenaSizeInUse() bytes. See
+//! ReadAnnotationArena().
+//!
+//! Unlike TSimpleStringDictionary, keys and values are never truncated. A key
+//! or value that does not fit is rejected instead.
+//!
+//! This class is not thread-safe.
+//!
+//! The template parameters control the amount of storage used. \a Capacity is
+//! the total number of bytes available to keys and values, and \a MaxEntries is
+//! the total number of entries that will fit in the map.
+template <size_t Capacity = 64 * 1024, size_t MaxEntries = 256>
+class TAnnotationArena {
+ public:
+  //! \brief Constant and publicly accessible versions of the template
+  //!     parameters.
+  //! \{
+  static const size_t capacity = Capacity;
+  static const size_t max_entries = MaxEntries;
+  //! \}
+
+  //! \brief An iterator to traverse all of the entries in a TAnnotationArena.
+  //!
+  //! The arena must not be modified while it is being traversed.
+  class Iterator {
+   public:
+    explicit Iterator(const TAnnotationArena& arena)
+        : arena_(arena), current_(0) {}
+
+    //! \brief Obtains the next entry in the map.
+    //!
+    //! \return `true` with \a key and \a value set on success, or `false` if at
+    //!     the end of the collection.
+    bool Next(base::StringPiece* key, base::StringPiece* value) {
+      if (current_ >= arena_.header_.entry_count) {
+        return false;
+      }
+      const AnnotationArenaEntry& entry = arena_.entries_[current_++];
+      *key = arena_.EntryKey(entry);
+      *value = arena_.EntryValue(entry);
+      return true;
+    }
+
+   private:
+    const TAnnotationArena& arena_;
+    size_t current_;
+
+    DISALLOW_COPY_AND_ASSIGN(Iterator);
+  };
+
+  TAnnotationArena() : header_(), entries_(), data_() {
+    header_.signature = AnnotationArenaHeader::kSignature;
+    header_.version = AnnotationArenaHeader::kVersion;
+    header_.max_entries = MaxEntries;
+    header_.capacity = Capacity;
+  }
+
+  //! \brief Returns the number of key/value pairs. The upper limit for this is
+  //!     \a MaxEntries.
+  size_t GetCount() const { return header_.entry_count; }
+
+  //! \brief Returns the number of bytes of the data area allocated, including
+  //!     space that will be reclaimed by the next compaction.
+  size_t GetUsed() const { return header_.used; }
+
+  //! \brief Given \a key, returns its corresponding value.
+  //!
+  //! \param[in] key The key to look up. This must not be an empty string.
+  //!
+  //! \return The corresponding value for \a key, or if \a key is not found, a
+  //!     StringPiece whose `data()` is `nullptr`. The value remains valid until
+  //!     the arena is next modified.
+  base::StringPiece GetValueForKey(base::StringPiece key) const {
+    DCHECK(key.size());
+    const AnnotationArenaEntry* entry = GetConstEntryForKey(key);
+    if (!entry) {
+      return base::StringPiece();
+    }
+    return EntryValue(*entry);
+  }
+
+  //! \brief Stores \a value into \a key, replacing the existing value if \a key
+  //!     is already present.
+  //!
+  //! \param[in] key The key to store. This must not be an empty string.
+  //! \param[in] value The value to store. If its `data()` is `nullptr`, \a key
+  //!     is removed from the map.
+  //!
+  //! \return `true` on success. `false` if \a key is empty, or if the map
+  //!     doesn’t have room for the new entry, in which case the map is left
+  //!     unchanged.
+  bool SetKeyValue(base::StringPiece key, base::StringPiece value) {
+    if (!value.data()) {
+      RemoveKey(key);
+      return true;
+    }
+
+    DCHECK(key.size());
+    if (!key.size()) {
+      return false;
+    }
+
+    AnnotationArenaEntry* entry = GetEntryForKey(key);
+    if (entry) {
+      if (value.size() <= entry->value_size) {
+        // Reuse the existing allocation. The bytes it no longer needs are
+        // reclaimed by the next compaction.
+        entry->value_size = static_cast<uint32_t>(value.size());
+        value.copy(&data_[entry->value_offset], value.size());
+        return true;
+      }
+
+      if (LiveBytes() - entry->value_size + value.size() > Capacity) {
+        return false;
+      }
+
+      // Release the old value before compacting, so that its space can be
+      // reclaimed.
+      entry->value_size = 0;
+      uint32_t offset;
+      Allocate(value.size(), &offset);
+      value.copy(&data_[offset], value.size());
+
+      // Publish the new value only once it has been written, so that a reader
+      // never sees a value that is only partially written.
+      entry->value_offset = offset;
+      entry->value_size = static_cast<uint32_t>(value.size());
+      return true;
+    }
+
+    if (header_.entry_count >= MaxEntries ||
+        LiveBytes() + key.size() + value.size() > Capacity) {
+      return false;
+    }
+
+    uint32_t offset;
+    Allocate(key.size() + value.size(), &offset);
+    key.copy(&data_[offset], key.size());
+    value.copy(&data_[offset + key.size()], value.size());
+
+    entry = &entries_[header_.entry_count];
+    entry->key_offset = offset;
+    entry->key_size = static_cast<uint32_t>(key.size());
+    entry->value_offset = static_cast<uint32_t>(offset + key.size());
+    entry->value_size = static_cast<uint32_t>(value.size());
+    ++header_.entry_count;
+    return true;
+  }
+
+  //! \brief Removes \a key from the map.
+  //!
+  //! If \a key is not found, this is a no-op.
+  //!
+  //! \param[in] key The key of the entry to remove. This must not be an empty
+  //!     string.
+  void RemoveKey(base::StringPiece key) {
+    DCHECK(key.size());
+    AnnotationArenaEntry* entry = GetEntryForKey(key);
+    if (!entry) {
+      return;
+    }
+
+    // Keep the entries in use at the start of the table by moving the last
+    // entry into the removed one’s place.
+    *entry = entries_[header_.entry_count - 1];
+    --header_.entry_count;
+  }
+
+ private:
+  // Allocates |size| bytes from the data area, compacting it if necessary.
+  // The caller must have ensured that LiveBytes() + |size| <= Capacity.
+  void Allocate(size_t size, uint32_t* offset) {
+    if (size > Capacity - header_.used) {
+      Compact();
+    }
+    DCHECK_LE(size, Capacity - header_.used);
+    *offset = header_.used;
+    header_.used += static_cast<uint32_t>(size);
+  }
+
+  // Moves all keys and values to the start of the data area, in their existing
+  // order, and updates the offsets in the entry table to match.
+  void Compact() {
+    struct Allocation {
+      uint32_t* offset;
+      uint32_t size;
+    };
+    Allocation allocations[2 * MaxEntries];
+    size_t allocation_count = 0;
+    for (size_t index = 0; index < header_.entry_count; ++index) {
+      AnnotationArenaEntry* entry = &entries_[index];
+      allocations[allocation_count++] = {&entry->key_offset, entry->key_size};
+      allocations[allocation_count++] = {&entry->value_offset,
+                                         entry->value_size};
+    }
+    std::sort(allocations,
+              allocations + allocation_count,
+              [](const Allocation& lhs, const Allocation& rhs) {
+                return *lhs.offset < *rhs.offset;
+              });
+
+    // Because allocations are visited in order of increasing offset, each
+    // moves toward the start and never overwrites one not yet moved.
+    uint32_t used = 0;
+    for (size_t index = 0; index < allocation_count; ++index) {
+      const Allocation& allocation = allocations[index];
+      memmove(&data_[used], &data_[*allocation.offset], allocation.size);
+      *allocation.offset = used;
+      used += allocation.size;
+    }
+    header_.used = used;
+  }
+
+  // Returns the number of bytes of the data area that are referenced by the
+  // entry table.
+  size_t LiveBytes() const {
+    size_t live = 0;
+    for (size_t index = 0; index < header_.entry_count; ++index) {
+      live += entries_[index].key_size + entries_[index].value_size;
+    }
+    return live;
+  }
+
+  base::StringPiece EntryKey(const AnnotationArenaEntry& entry) const {
+    return base::StringPiece(&data_[entry.key_offset], entry.key_size);
+  }
+
+  base::StringPiece EntryValue(const AnnotationArenaEntry& entry) const {
+    return base::StringPiece(&data_[entry.value_offset], entry.value_size);
+  }
+
+  const AnnotationArenaEntry* GetConstEntryForKey(base::StringPiece key) const {
+    for (size_t index = 0; index < header_.entry_count; ++index) {
+      if (EntryKey(entries_[index]) == key) {
+        return &entries_[index];
+      }
+    }
+    return nullptr;
+  }
+
+  AnnotationArenaEntry* GetEntryForKey(base::StringPiece key) {
+    return const_cast<AnnotationArenaEntry*>(GetConstEntryForKey(key));
+  }
+
+  AnnotationArenaHeader header_;
+  AnnotationArenaEntry entries_[MaxEntries];
+  char data_[Capacity];
+
+  DISALLOW_COPY_AND_ASSIGN(TAnnotationArena);
+};
+
+//! \brief A TAnnotationArena with default template parameters.
+using AnnotationArena = TAnnotationArena<>;
+
+//! \brief Returns the number of bytes at the start of an arena that must be
+//!     read to obtain all of its entries, given its \a header.
+//!
+//! \return The number of bytes, including the header, or `0` if \a header is
+//!     not valid.
+size_t AnnotationArenaSizeInUse(const AnnotationArenaHeader& header);
+
+//! \brief Reads the entries of an arena copied from another process.
+//!
+//! \param[in] data The first AnnotationArenaSizeInUse() bytes of the arena.
+//! \param[in] size The number of bytes at \a data.
+//! \param[out] entries The entries found in the arena, which are added to any
+//!     already present. Entries whose keys are already present are ignored.
+//!     Entries whose offsets or sizes lie outside of \a data are skipped.
+//!
+//! \return `true` on success, or `false` with a message logged if the header
+//!     of the arena is not valid or \a size is too small.
+bool ReadAnnotationArena(const void* data,
+                         size_t size,
+                         std::map<std::string, std::string>* entries);
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_CLIENT_ANNOTATION_ARENA_H_
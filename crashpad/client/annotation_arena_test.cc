@@ -0,0 +1,224 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "client/annotation_arena.h"
+
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+// Copies the bytes of |arena| that another process would read.
+template <typename Arena>
+std::vector<char> CopyInUse(const Arena& arena) {
+  AnnotationArenaHeader header;
+  memcpy(&header, &arena, sizeof(header));
+  const size_t size = AnnotationArenaSizeInUse(header);
+  EXPECT_GT(size, sizeof(header));
+  const char* begin = reinterpret_cast<const char*>(&arena);
+  return std::vector<char>(begin, begin + size);
+}
+
+TEST(AnnotationArena, SetGetRemove) {
+  using TestArena = TAnnotationArena<64, 4>;
+  TestArena arena;
+  EXPECT_EQ(arena.GetCount(), 0u);
+  EXPECT_FALSE(arena.GetValueForKey("key1").data());
+
+  EXPECT_TRUE(arena.SetKeyValue("key1", "value1"));
+  EXPECT_TRUE(arena.SetKeyValue("key2", "value2"));
+  EXPECT_TRUE(arena.SetKeyValue("key3", ""));
+  EXPECT_EQ(arena.GetCount(), 3u);
+  EXPECT_EQ(arena.GetValueForKey("key1"), "value1");
+  EXPECT_EQ(arena.GetValueForKey("key2"), "value2");
+  EXPECT_TRUE(arena.GetValueForKey("key3").data());
+  EXPECT_EQ(arena.GetValueForKey("key3"), "");
+  EXPECT_FALSE(arena.GetValueForKey("key").data());
+
+  arena.RemoveKey("key1");
+  EXPECT_EQ(arena.GetCount(), 2u);
+  EXPECT_FALSE(arena.GetValueForKey("key1").data());
+  EXPECT_EQ(arena.GetValueForKey("key2"), "value2");
+
+  EXPECT_TRUE(arena.SetKeyValue("key2", base::StringPiece()));
+  EXPECT_EQ(arena.GetCount(), 1u);
+  EXPECT_FALSE(arena.GetValueForKey("key2").data());
+
+  // Removing a key that isn’t present does nothing.
+  arena.RemoveKey("key1");
+  EXPECT_EQ(arena.GetCount(), 1u);
+
+  TestArena::Iterator iterator(arena);
+  base::StringPiece key;
+  base::StringPiece value;
+  ASSERT_TRUE(iterator.Next(&key, &value));
+  EXPECT_EQ(key, "key3");
+  EXPECT_EQ(value, "");
+  EXPECT_FALSE(iterator.Next(&key, &value));
+}
+
+TEST(AnnotationArena, Replace) {
+  TAnnotationArena<64, 4> arena;
+
+  ASSERT_TRUE(arena.SetKeyValue("key", "long value"));
+  const size_t used = arena.GetUsed();
+
+  // A shorter value reuses the existing space.
+  ASSERT_TRUE(arena.SetKeyValue("key", "short"));
+  EXPECT_EQ(arena.GetValueForKey("key"), "short");
+  EXPECT_EQ(arena.GetUsed(), used);
+
+  // A longer one doesn’t fit there.
+  ASSERT_TRUE(arena.SetKeyValue("key", "a longer value"));
+  EXPECT_EQ(arena.GetValueForKey("key"), "a longer value");
+  EXPECT_EQ(arena.GetCount(), 1u);
+}
+
+TEST(AnnotationArena, LongValues) {
+  AnnotationArena arena;
+
+  // Values far longer than a SimpleStringDictionary allows are kept intact,
+  // including embedded NULs.
+  const std::string value_1(20000, 'a');
+  std::string value_2(30000, 'b');
+  value_2[100] = '\0';
+  ASSERT_TRUE(arena.SetKeyValue("key1", value_1));
+  ASSERT_TRUE(arena.SetKeyValue("key2", value_2));
+  EXPECT_EQ(arena.GetValueForKey("key1"), value_1);
+  EXPECT_EQ(arena.GetValueForKey("key2"), value_2);
+
+  // A value that can’t fit is rejected, and the existing value is kept.
+  const std::string too_long(AnnotationArena::capacity, 'c');
+  EXPECT_FALSE(arena.SetKeyValue("key1", too_long));
+  EXPECT_EQ(arena.GetValueForKey("key1"), value_1);
+  EXPECT_FALSE(arena.SetKeyValue("key3", too_long));
+  EXPECT_FALSE(arena.GetValueForKey("key3").data());
+}
+
+TEST(AnnotationArena, Full) {
+  TAnnotationArena<64, 2> arena;
+
+  // The table is full.
+  ASSERT_TRUE(arena.SetKeyValue("a", "1"));
+  ASSERT_TRUE(arena.SetKeyValue("b", "2"));
+  EXPECT_FALSE(arena.SetKeyValue("c", "3"));
+  EXPECT_EQ(arena.GetCount(), 2u);
+
+  // Replacing a value doesn’t need another entry.
+  EXPECT_TRUE(arena.SetKeyValue("b", "22"));
+  arena.RemoveKey("a");
+  EXPECT_TRUE(arena.SetKeyValue("c", "3"));
+
+  // The data area is full.
+  EXPECT_FALSE(arena.SetKeyValue("b", std::string(63, 'b')));
+  EXPECT_EQ(arena.GetValueForKey("b"), "22");
+  EXPECT_TRUE(arena.SetKeyValue("b", std::string(61, 'b')));
+  EXPECT_EQ(arena.GetValueForKey("b"), std::string(61, 'b'));
+  EXPECT_EQ(arena.GetValueForKey("c"), "3");
+}
+
+TEST(AnnotationArena, Compaction) {
+  using TestArena = TAnnotationArena<256, 8>;
+  TestArena arena;
+  const size_t capacity = TestArena::capacity;
+
+  // Churn through many more bytes than the data area holds. Each time it fills,
+  // the space left behind by old values is reclaimed.
+  for (int iteration = 0; iteration < 100; ++iteration) {
+    const std::string value(10 + iteration % 20, 'a' + iteration % 26);
+    ASSERT_TRUE(arena.SetKeyValue("key1", value));
+    ASSERT_TRUE(arena.SetKeyValue("key2", value + value));
+    ASSERT_TRUE(arena.SetKeyValue("key3", "constant"));
+    EXPECT_EQ(arena.GetValueForKey("key1"), value);
+    EXPECT_EQ(arena.GetValueForKey("key2"), value + value);
+    EXPECT_EQ(arena.GetValueForKey("key3"), "constant");
+    EXPECT_LE(arena.GetUsed(), capacity);
+
+    if (iteration % 7 == 0) {
+      arena.RemoveKey("key3");
+    }
+  }
+  EXPECT_EQ(arena.GetCount(), 3u);
+}
+
+TEST(AnnotationArena, ReadInUse) {
+  using TestArena = TAnnotationArena<1024, 8>;
+  std::unique_ptr<TestArena> arena(new TestArena());
+  ASSERT_TRUE(arena->SetKeyValue("key1", "value1"));
+  ASSERT_TRUE(arena->SetKeyValue("key2", "value2"));
+  ASSERT_TRUE(arena->SetKeyValue("key3", "value3"));
+  arena->RemoveKey("key2");
+
+  // Only the header, table, and bytes allocated are copied.
+  std::vector<char> copy = CopyInUse(*arena);
+  EXPECT_EQ(copy.size(),
+            sizeof(AnnotationArenaHeader) +
+                TestArena::max_entries * sizeof(AnnotationArenaEntry) +
+                arena->GetUsed());
+  EXPECT_LT(copy.size(), sizeof(*arena));
+
+  std::map<std::string, std::string> entries;
+  entries["key3"] = "preexisting";
+  ASSERT_TRUE(ReadAnnotationArena(copy.data(), copy.size(), &entries));
+  EXPECT_EQ(entries.size(), 2u);
+  EXPECT_EQ(entries["key1"], "value1");
+  EXPECT_EQ(entries["key3"], "preexisting");
+
+  // A copy that is too short is rejected.
+  entries.clear();
+  EXPECT_FALSE(ReadAnnotationArena(copy.data(), copy.size() - 1, &entries));
+  EXPECT_FALSE(
+      ReadAnnotationArena(copy.data(), sizeof(AnnotationArenaHeader) - 1,
+                          &entries));
+  EXPECT_TRUE(entries.empty());
+}
+
+TEST(AnnotationArena, ReadCorrupt) {
+  TAnnotationArena<64, 2> arena;
+  ASSERT_TRUE(arena.SetKeyValue("key1", "value1"));
+  ASSERT_TRUE(arena.SetKeyValue("key2", "value2"));
+  std::vector<char> copy = CopyInUse(arena);
+
+  // An entry that points outside of the bytes in use is skipped.
+  AnnotationArenaEntry entry;
+  char* const first_entry = &copy[sizeof(AnnotationArenaHeader)];
+  memcpy(&entry, first_entry, sizeof(entry));
+  entry.value_offset = 0xfffffff0;
+  memcpy(first_entry, &entry, sizeof(entry));
+
+  std::map<std::string, std::string> entries;
+  ASSERT_TRUE(ReadAnnotationArena(copy.data(), copy.size(), &entries));
+  EXPECT_EQ(entries.size(), 1u);
+  EXPECT_EQ(entries["key2"], "value2");
+
+  // A header that isn’t consistent is rejected.
+  AnnotationArenaHeader header;
+  memcpy(&header, copy.data(), sizeof(header));
+  header.entry_count = header.max_entries + 1;
+  EXPECT_EQ(AnnotationArenaSizeInUse(header), 0u);
+  memcpy(&copy[0], &header, sizeof(header));
+  EXPECT_FALSE(ReadAnnotationArena(copy.data(), copy.size(), &entries));
+
+  header.entry_count = 0;
+  header.signature = 0;
+  EXPECT_EQ(AnnotationArenaSizeInUse(header), 0u);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
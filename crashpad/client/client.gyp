@@ -29,6 +29,8 @@
         '..',
       ],
       'sources': [
+        'annotation_arena.cc',
+        'annotation_arena.h',
         'capture_context_mac.S',
         'capture_context_mac.h',
         'crash_report_database.cc',
@@ -36,6 +38,7 @@
         'crash_report_database_mac.mm',
         'crash_report_database_win.cc',
         'crashpad_client.h',
+        'crashpad_client_linux.cc',
         'crashpad_client_mac.cc',
         'crashpad_client_win.cc',
         'crashpad_info.cc',
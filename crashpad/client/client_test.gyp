@@ -35,8 +35,10 @@
         '..',
       ],
       'sources': [
+        'annotation_arena_test.cc',
         'capture_context_mac_test.cc',
         'crash_report_database_test.cc',
+        'crashpad_client_linux_test.cc',
         'crashpad_client_win_test.cc',
         'prune_crash_reports_test.cc',
         'settings_test.cc',
@@ -14,8 +14,146 @@
 
 #include "client/crash_report_database.h"
 
+#include <string.h>
+
+#include <algorithm>
+#include <limits>
+
+#include "base/logging.h"
+
 namespace crashpad {
 
+namespace {
+
+using ReportQuery = CrashReportDatabase::ReportQuery;
+
+// Orders reports by creation time, with ties broken by UUID, in the direction
+// requested by a ReportQuery.
+class ReportOrder {
+ public:
+  explicit ReportOrder(ReportQuery::Order order) : order_(order) {}
+
+  bool Precedes(time_t lhs_creation_time,
+                const UUID& lhs_uuid,
+                time_t rhs_creation_time,
+                const UUID& rhs_uuid) const {
+    if (order_ == ReportQuery::Order::kNewestFirst) {
+      return Less(rhs_creation_time, rhs_uuid, lhs_creation_time, lhs_uuid);
+    }
+    return Less(lhs_creation_time, lhs_uuid, rhs_creation_time, rhs_uuid);
+  }
+
+  bool operator()(const CrashReportDatabase::Report& lhs,
+                  const CrashReportDatabase::Report& rhs) const {
+    return Precedes(lhs.creation_time, lhs.uuid, rhs.creation_time, rhs.uuid);
+  }
+
+ private:
+  static bool Less(time_t lhs_creation_time,
+                   const UUID& lhs_uuid,
+                   time_t rhs_creation_time,
+                   const UUID& rhs_uuid) {
+    if (lhs_creation_time != rhs_creation_time) {
+      return lhs_creation_time < rhs_creation_time;
+    }
+    return memcmp(&lhs_uuid, &rhs_uuid, sizeof(lhs_uuid)) < 0;
+  }
+
+  ReportQuery::Order order_;
+};
+
+// Keeps the first |limit| reports, in query order, of those that follow a
+// cursor position and satisfy a query’s creation time bounds. The reports are
+// kept in a heap whose front is the report that would be returned last, so that
+// memory use is bounded by the limit rather than by the number of reports
+// visited.
+class ReportSelector final : public CrashReportDatabase::ReportVisitor {
+ public:
+  ReportSelector(const ReportQuery& query,
+                 bool has_start,
+                 time_t start_creation_time,
+                 const UUID& start_uuid)
+      : reports_(),
+        query_(query),
+        order_(query.order),
+        start_uuid_(start_uuid),
+        start_creation_time_(start_creation_time),
+        has_start_(has_start) {}
+
+  ~ReportSelector() {}
+
+  // Moves the selected reports, in query order, to |reports|.
+  void TakeReports(std::vector<CrashReportDatabase::Report>* reports) {
+    std::sort_heap(reports_.begin(), reports_.end(), order_);
+    reports->swap(reports_);
+    reports_.clear();
+  }
+
+  // CrashReportDatabase::ReportVisitor:
+  void VisitReport(const CrashReportDatabase::Report& report) override {
+    if (report.creation_time < query_.min_creation_time ||
+        report.creation_time > query_.max_creation_time) {
+      return;
+    }
+
+    if (has_start_ && !order_.Precedes(start_creation_time_,
+                                       start_uuid_,
+                                       report.creation_time,
+                                       report.uuid)) {
+      return;
+    }
+
+    if (query_.limit == 0 || reports_.size() < query_.limit) {
+      reports_.push_back(report);
+      std::push_heap(reports_.begin(), reports_.end(), order_);
+      return;
+    }
+
+    if (order_(report, reports_.front())) {
+      std::pop_heap(reports_.begin(), reports_.end(), order_);
+      reports_.back() = report;
+      std::push_heap(reports_.begin(), reports_.end(), order_);
+    }
+  }
+
+ private:
+  std::vector<CrashReportDatabase::Report> reports_;
+  ReportQuery query_;
+  ReportOrder order_;
+  UUID start_uuid_;
+  time_t start_creation_time_;
+  bool has_start_;
+
+  DISALLOW_COPY_AND_ASSIGN(ReportSelector);
+};
+
+// Passes on to another visitor the reports that satisfy a query’s creation
+// time bounds.
+class ReportFilter final : public CrashReportDatabase::ReportVisitor {
+ public:
+  ReportFilter(const ReportQuery& query,
+               CrashReportDatabase::ReportVisitor* visitor)
+      : query_(query), visitor_(visitor) {}
+
+  ~ReportFilter() {}
+
+  // CrashReportDatabase::ReportVisitor:
+  void VisitReport(const CrashReportDatabase::Report& report) override {
+    if (report.creation_time >= query_.min_creation_time &&
+        report.creation_time <= query_.max_creation_time) {
+      visitor_->VisitReport(report);
+    }
+  }
+
+ private:
+  ReportQuery query_;
+  CrashReportDatabase::ReportVisitor* visitor_;  // weak
+
+  DISALLOW_COPY_AND_ASSIGN(ReportFilter);
+};
+
+}  // namespace
+
 CrashReportDatabase::Report::Report()
     : uuid(),
       file_path(),
@@ -44,4 +182,78 @@ void CrashReportDatabase::CallErrorWritingCrashReport::Disarm() {
   new_report_ = nullptr;
 }
 
+CrashReportDatabase::ReportQuery::ReportQuery()
+    : states(kStateAny),
+      min_creation_time(std::numeric_limits<time_t>::min()),
+      max_creation_time(std::numeric_limits<time_t>::max()),
+      limit(0),
+      order(Order::kOldestFirst) {}
+
+CrashReportDatabase::ReportCursor::ReportCursor()
+    : last_uuid_(), last_creation_time_(0), started_(false), done_(false) {}
+
+CrashReportDatabase::OperationStatus CrashReportDatabase::GetReports(
+    const ReportQuery& query,
+    ReportCursor* cursor,
+    std::vector<Report>* reports) {
+  DCHECK(reports->empty());
+
+  if (cursor->done_) {
+    return kNoError;
+  }
+
+  ReportSelector selector(query,
+                          cursor->started_,
+                          cursor->last_creation_time_,
+                          cursor->last_uuid_);
+  OperationStatus os = VisitReports(query.states, &selector);
+  if (os != kNoError) {
+    return os;
+  }
+  selector.TakeReports(reports);
+
+  if (!reports->empty()) {
+    cursor->last_uuid_ = reports->back().uuid;
+    cursor->last_creation_time_ = reports->back().creation_time;
+    cursor->started_ = true;
+  }
+  cursor->done_ = query.limit == 0 || reports->size() < query.limit;
+  return kNoError;
+}
+
+CrashReportDatabase::OperationStatus CrashReportDatabase::ForEachReport(
+    const ReportQuery& query,
+    ReportVisitor* visitor) {
+  ReportFilter filter(query, visitor);
+  return VisitReports(query.states, &filter);
+}
+
+CrashReportDatabase::OperationStatus CrashReportDatabase::VisitReports(
+    uint8_t states,
+    ReportVisitor* visitor) {
+  if (states & ReportQuery::kStatePending) {
+    std::vector<Report> reports;
+    OperationStatus os = GetPendingReports(&reports);
+    if (os != kNoError) {
+      return os;
+    }
+    for (const Report& report : reports) {
+      visitor->VisitReport(report);
+    }
+  }
+
+  if (states & ReportQuery::kStateCompleted) {
+    std::vector<Report> reports;
+    OperationStatus os = GetCompletedReports(&reports);
+    if (os != kNoError) {
+      return os;
+    }
+    for (const Report& report : reports) {
+      visitor->VisitReport(report);
+    }
+  }
+
+  return kNoError;
+}
+
 }  // namespace crashpad
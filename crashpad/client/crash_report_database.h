@@ -15,6 +15,7 @@
 #ifndef CRASHPAD_CLIENT_CRASH_REPORT_DATABASE_H_
 #define CRASHPAD_CLIENT_CRASH_REPORT_DATABASE_H_
 
+#include <stdint.h>
 #include <time.h>
 
 #include <memory>
@@ -288,6 +289,147 @@ class CrashReportDatabase {
   //! \return The operation status code.
   virtual OperationStatus GetCompletedReports(std::vector<Report>* reports) = 0;
 
+  //! \brief Describes the crash report records returned by GetReports(), and
+  //!     the order in which they are returned.
+  struct ReportQuery {
+    //! \brief Report states, which may be combined in #states.
+    enum State : uint8_t {
+      //! \brief Reports that GetPendingReports() would return.
+      kStatePending = 1 << 0,
+
+      //! \brief Reports that GetCompletedReports() would return.
+      kStateCompleted = 1 << 1,
+
+      //! \brief Reports in any of the above states.
+      kStateAny = kStatePending | kStateCompleted,
+    };
+
+    //! \brief The order in which reports are returned.
+    enum class Order {
+      //! \brief Reports with the earliest Report::creation_time first.
+      kOldestFirst,
+
+      //! \brief Reports with the latest Report::creation_time first.
+      kNewestFirst,
+    };
+
+    ReportQuery();
+
+    //! \brief A bitfield of State values selecting the reports to return.
+    uint8_t states;
+
+    //! \brief Only reports with a Report::creation_time at or after this time
+    //!     are returned.
+    time_t min_creation_time;
+
+    //! \brief Only reports with a Report::creation_time at or before this time
+    //!     are returned.
+    time_t max_creation_time;
+
+    //! \brief The maximum number of reports returned by a single call to
+    //!     GetReports(), or `0` for no limit.
+    size_t limit;
+
+    //! \brief The order in which reports are returned.
+    Order order;
+  };
+
+  //! \brief The position of an enumeration performed with GetReports().
+  //!
+  //! A newly-constructed cursor refers to the start of an enumeration. The
+  //! position is recorded as the creation time and UUID of the last report
+  //! returned, so an enumeration remains consistent when reports are added,
+  //! deleted, or change state between calls to GetReports().
+  class ReportCursor {
+   public:
+    ReportCursor();
+
+    //! \return `true` if GetReports() has returned every report matching the
+    //!     query.
+    bool done() const { return done_; }
+
+   private:
+    friend class CrashReportDatabase;
+
+    UUID last_uuid_;
+    time_t last_creation_time_;
+    bool started_;
+    bool done_;
+  };
+
+  //! \brief Returns the next page of crash report records matching a query.
+  //!
+  //! Reports are ordered by Report::creation_time, with ties broken by UUID.
+  //! Each call returns up to ReportQuery::limit reports that follow those
+  //! already returned for \a cursor, and advances \a cursor past them. Only
+  //! one page of reports is held in memory at a time, regardless of the
+  //! number of reports in the database.
+  //!
+  //! Each call enumerates every report in the database to find its page, so
+  //! walking all of the reports a page at a time takes time proportional to
+  //! the square of their number. Use ForEachReport() to visit every report
+  //! in a single pass when their order doesn’t matter.
+  //!
+  //! \param[in] query The reports to return. The same query must be used for
+  //!     every call made with \a cursor.
+  //! \param[in,out] cursor The position of the enumeration. When this returns
+  //!     #kNoError and ReportCursor::done() becomes `true`, no further reports
+  //!     match \a query.
+  //! \param[out] reports A list of crash report record objects. This must be
+  //!     empty on entry. Only valid if this returns #kNoError.
+  //!
+  //! \return The operation status code.
+  OperationStatus GetReports(const ReportQuery& query,
+                             ReportCursor* cursor,
+                             std::vector<Report>* reports);
+
+  //! \brief An interface for receiving crash report records from
+  //!     ForEachReport() and VisitReports().
+  //!
+  //! A visitor may be called while the database is locked against other users,
+  //! including other processes. It should do no more than copy what it needs
+  //! from each report, leaving slow work such as reading the report’s file
+  //! until the visit is complete, and must not call back into the database.
+  class ReportVisitor {
+   public:
+    //! \brief Called for each report.
+    virtual void VisitReport(const Report& report) = 0;
+
+   protected:
+    ~ReportVisitor() {}
+  };
+
+  //! \brief Calls \a visitor once for each crash report record matching a
+  //!     query, in a single pass over the database.
+  //!
+  //! Reports are visited in no particular order, and are not held in memory.
+  //! ReportQuery::limit and ReportQuery::order are ignored. A report added or
+  //! removed during the pass may or may not be visited. The database may be
+  //! locked for the whole pass, so \a visitor must be quick, as described at
+  //! ReportVisitor.
+  //!
+  //! \param[in] query The reports to visit.
+  //! \param[in] visitor The object to call for each report.
+  //!
+  //! \return The operation status code.
+  OperationStatus ForEachReport(const ReportQuery& query,
+                                ReportVisitor* visitor);
+
+  //! \brief Calls \a visitor once for each crash report record in the
+  //!     requested states, in no particular order.
+  //!
+  //! The default implementation obtains every report with GetPendingReports()
+  //! and GetCompletedReports(). Implementations that are able to produce
+  //! reports one at a time should override this method so that GetReports()
+  //! does not need to hold every report in memory. An implementation may hold
+  //! its lock on the database’s metadata while \a visitor is called.
+  //!
+  //! \param[in] states A bitfield of ReportQuery::State values.
+  //! \param[in] visitor The object to call for each report.
+  //!
+  //! \return The operation status code.
+  virtual OperationStatus VisitReports(uint8_t states, ReportVisitor* visitor);
+
   //! \brief Obtains a report object for uploading to a collection server.
   //!
   //! The file at Report::file_path should be uploaded by the caller, and then
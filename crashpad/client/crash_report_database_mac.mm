@@ -107,6 +107,25 @@ std::string XattrNameInternal(const base::StringPiece& name, bool new_name) {
                             name.data());
 }
 
+// Collects every visited report into a vector.
+class ReportCollector final : public CrashReportDatabase::ReportVisitor {
+ public:
+  explicit ReportCollector(std::vector<CrashReportDatabase::Report>* reports)
+      : reports_(reports) {}
+
+  ~ReportCollector() {}
+
+  // CrashReportDatabase::ReportVisitor:
+  void VisitReport(const CrashReportDatabase::Report& report) override {
+    reports_->push_back(report);
+  }
+
+ private:
+  std::vector<CrashReportDatabase::Report>* reports_;  // weak
+
+  DISALLOW_COPY_AND_ASSIGN(ReportCollector);
+};
+
 //! \brief A CrashReportDatabase that uses HFS+ extended attributes to store
 //!     report metadata.
 //!
@@ -146,6 +165,7 @@ class CrashReportDatabaseMac : public CrashReportDatabase {
                                    Metrics::CrashSkippedReason reason) override;
   OperationStatus DeleteReport(const UUID& uuid) override;
   OperationStatus RequestUpload(const UUID& uuid) override;
+  OperationStatus VisitReports(uint8_t states, ReportVisitor* visitor) override;
 
  private:
   //! \brief Report states for use with LocateCrashReport().
@@ -207,11 +227,11 @@ class CrashReportDatabaseMac : public CrashReportDatabase {
   //!      Invalid reports are skipped.
   //!
   //! \param[in] path The database subdirectory path.
-  //! \param[out] reports An empty vector of reports, which will be filled.
+  //! \param[in] visitor The object to call with each report, as it is read.
   //!
   //! \return The operation status code.
   OperationStatus ReportsInDirectory(const base::FilePath& path,
-                                     std::vector<Report>* reports);
+                                     ReportVisitor* visitor);
 
   //! \brief Creates a database xattr name from the short constant name.
   //!
@@ -428,7 +448,10 @@ CrashReportDatabaseMac::GetPendingReports(
     std::vector<CrashReportDatabase::Report>* reports) {
   INITIALIZATION_STATE_DCHECK_VALID(initialized_);
 
-  return ReportsInDirectory(base_dir_.Append(kUploadPendingDirectory), reports);
+  DCHECK(reports->empty());
+  ReportCollector collector(reports);
+  return ReportsInDirectory(base_dir_.Append(kUploadPendingDirectory),
+                            &collector);
 }
 
 CrashReportDatabase::OperationStatus
@@ -436,7 +459,33 @@ CrashReportDatabaseMac::GetCompletedReports(
     std::vector<CrashReportDatabase::Report>* reports) {
   INITIALIZATION_STATE_DCHECK_VALID(initialized_);
 
-  return ReportsInDirectory(base_dir_.Append(kCompletedDirectory), reports);
+  DCHECK(reports->empty());
+  ReportCollector collector(reports);
+  return ReportsInDirectory(base_dir_.Append(kCompletedDirectory), &collector);
+}
+
+CrashReportDatabase::OperationStatus CrashReportDatabaseMac::VisitReports(
+    uint8_t states,
+    ReportVisitor* visitor) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+
+  if (states & ReportQuery::kStatePending) {
+    OperationStatus os = ReportsInDirectory(
+        base_dir_.Append(kUploadPendingDirectory), visitor);
+    if (os != kNoError) {
+      return os;
+    }
+  }
+
+  if (states & ReportQuery::kStateCompleted) {
+    OperationStatus os =
+        ReportsInDirectory(base_dir_.Append(kCompletedDirectory), visitor);
+    if (os != kNoError) {
+      return os;
+    }
+  }
+
+  return kNoError;
 }
 
 CrashReportDatabase::OperationStatus
@@ -703,11 +752,9 @@ bool CrashReportDatabaseMac::ReadReportMetadataLocked(
 
 CrashReportDatabase::OperationStatus CrashReportDatabaseMac::ReportsInDirectory(
     const base::FilePath& path,
-    std::vector<CrashReportDatabase::Report>* reports) {
+    ReportVisitor* visitor) {
   base::mac::ScopedNSAutoreleasePool pool;
 
-  DCHECK(reports->empty());
-
   NSError* error = nil;
   NSArray* paths = [[NSFileManager defaultManager]
       contentsOfDirectoryAtPath:base::SysUTF8ToNSString(path.value())
@@ -718,7 +765,6 @@ CrashReportDatabase::OperationStatus CrashReportDatabaseMac::ReportsInDirectory(
     return kFileSystemError;
   }
 
-  reports->reserve([paths count]);
   for (NSString* entry in paths) {
     Report report;
     report.file_path = path.Append([entry fileSystemRepresentation]);
@@ -731,7 +777,7 @@ CrashReportDatabase::OperationStatus CrashReportDatabaseMac::ReportsInDirectory(
                    << report.file_path.value();
       continue;
     }
-    reports->push_back(report);
+    visitor->VisitReport(report);
   }
 
   return kNoError;
@@ -14,6 +14,9 @@
 
 #include "client/crash_report_database.h"
 
+#include <algorithm>
+
+#include "base/macros.h"
 #include "build/build_config.h"
 #include "client/settings.h"
 #include "gtest/gtest.h"
@@ -461,6 +464,150 @@ TEST_F(CrashReportDatabaseTest, GetCompletedAndNotUploadedReports) {
   }
 }
 
+TEST_F(CrashReportDatabaseTest, GetReports) {
+  std::vector<CrashReportDatabase::Report> reports(5);
+  for (CrashReportDatabase::Report& report : reports) {
+    CreateCrashReport(&report);
+  }
+  UploadReport(reports[1].uuid, true, "report1");
+
+  // Enumerate every report, oldest first, two at a time.
+  CrashReportDatabase::ReportQuery query;
+  query.limit = 2;
+
+  std::vector<CrashReportDatabase::Report> oldest_first;
+  CrashReportDatabase::ReportCursor cursor;
+  size_t pages = 0;
+  while (!cursor.done()) {
+    std::vector<CrashReportDatabase::Report> page;
+    ASSERT_EQ(db()->GetReports(query, &cursor, &page),
+              CrashReportDatabase::kNoError);
+    EXPECT_LE(page.size(), query.limit);
+    oldest_first.insert(oldest_first.end(), page.begin(), page.end());
+    ++pages;
+  }
+  EXPECT_EQ(pages, 3u);
+
+  ASSERT_EQ(oldest_first.size(), reports.size());
+  for (size_t index = 1; index < oldest_first.size(); ++index) {
+    EXPECT_LE(oldest_first[index - 1].creation_time,
+              oldest_first[index].creation_time);
+  }
+  for (const CrashReportDatabase::Report& report : reports) {
+    const UUID& uuid = report.uuid;
+    EXPECT_EQ(std::count_if(oldest_first.begin(),
+                            oldest_first.end(),
+                            [&uuid](const CrashReportDatabase::Report& found) {
+                              return found.uuid == uuid;
+                            }),
+              1);
+  }
+
+  // Enumerating newest first produces the same reports in reverse.
+  query.order = CrashReportDatabase::ReportQuery::Order::kNewestFirst;
+  std::vector<CrashReportDatabase::Report> newest_first;
+  cursor = CrashReportDatabase::ReportCursor();
+  while (!cursor.done()) {
+    std::vector<CrashReportDatabase::Report> page;
+    ASSERT_EQ(db()->GetReports(query, &cursor, &page),
+              CrashReportDatabase::kNoError);
+    newest_first.insert(newest_first.end(), page.begin(), page.end());
+  }
+  ASSERT_EQ(newest_first.size(), oldest_first.size());
+  for (size_t index = 0; index < newest_first.size(); ++index) {
+    EXPECT_EQ(newest_first[index].uuid,
+              oldest_first[oldest_first.size() - index - 1].uuid);
+  }
+
+  // Filter by state, without a limit.
+  query.states = CrashReportDatabase::ReportQuery::kStateCompleted;
+  query.limit = 0;
+  std::vector<CrashReportDatabase::Report> completed;
+  cursor = CrashReportDatabase::ReportCursor();
+  ASSERT_EQ(db()->GetReports(query, &cursor, &completed),
+            CrashReportDatabase::kNoError);
+  EXPECT_TRUE(cursor.done());
+  ASSERT_EQ(completed.size(), 1u);
+  EXPECT_EQ(completed[0].uuid, reports[1].uuid);
+  EXPECT_TRUE(completed[0].uploaded);
+
+  // Filter by creation time.
+  query.states = CrashReportDatabase::ReportQuery::kStateAny;
+  query.max_creation_time = oldest_first.front().creation_time - 1;
+  std::vector<CrashReportDatabase::Report> none;
+  cursor = CrashReportDatabase::ReportCursor();
+  ASSERT_EQ(db()->GetReports(query, &cursor, &none),
+            CrashReportDatabase::kNoError);
+  EXPECT_TRUE(cursor.done());
+  EXPECT_TRUE(none.empty());
+}
+
+class ReportCollector final : public CrashReportDatabase::ReportVisitor {
+ public:
+  ReportCollector() : reports_() {}
+  ~ReportCollector() {}
+
+  const std::vector<CrashReportDatabase::Report>& reports() const {
+    return reports_;
+  }
+
+  // CrashReportDatabase::ReportVisitor:
+  void VisitReport(const CrashReportDatabase::Report& report) override {
+    reports_.push_back(report);
+  }
+
+ private:
+  std::vector<CrashReportDatabase::Report> reports_;
+
+  DISALLOW_COPY_AND_ASSIGN(ReportCollector);
+};
+
+TEST_F(CrashReportDatabaseTest, ForEachReport) {
+  std::vector<CrashReportDatabase::Report> reports(5);
+  for (CrashReportDatabase::Report& report : reports) {
+    CreateCrashReport(&report);
+  }
+  UploadReport(reports[1].uuid, true, "report1");
+
+  // Every report is visited exactly once. The limit is ignored.
+  CrashReportDatabase::ReportQuery query;
+  query.limit = 2;
+  ReportCollector all;
+  ASSERT_EQ(db()->ForEachReport(query, &all), CrashReportDatabase::kNoError);
+  ASSERT_EQ(all.reports().size(), reports.size());
+  for (const CrashReportDatabase::Report& report : reports) {
+    const UUID& uuid = report.uuid;
+    EXPECT_EQ(std::count_if(all.reports().begin(),
+                            all.reports().end(),
+                            [&uuid](const CrashReportDatabase::Report& found) {
+                              return found.uuid == uuid;
+                            }),
+              1);
+  }
+
+  // Filter by state.
+  query.states = CrashReportDatabase::ReportQuery::kStateCompleted;
+  ReportCollector completed;
+  ASSERT_EQ(db()->ForEachReport(query, &completed),
+            CrashReportDatabase::kNoError);
+  ASSERT_EQ(completed.reports().size(), 1u);
+  EXPECT_EQ(completed.reports()[0].uuid, reports[1].uuid);
+
+  // Filter by creation time.
+  query.states = CrashReportDatabase::ReportQuery::kStateAny;
+  query.max_creation_time =
+      std::min_element(all.reports().begin(),
+                       all.reports().end(),
+                       [](const CrashReportDatabase::Report& a,
+                          const CrashReportDatabase::Report& b) {
+                         return a.creation_time < b.creation_time;
+                       })->creation_time -
+      1;
+  ReportCollector none;
+  ASSERT_EQ(db()->ForEachReport(query, &none), CrashReportDatabase::kNoError);
+  EXPECT_TRUE(none.reports().empty());
+}
+
 TEST_F(CrashReportDatabaseTest, DuelingUploads) {
   CrashReportDatabase::Report report;
   CreateCrashReport(&report);
@@ -223,6 +223,13 @@ class Metadata {
       ReportState desired_state,
       std::vector<CrashReportDatabase::Report>* reports) const;
 
+  //! \brief Calls \a visitor for each report in a given state.
+  //!
+  //! \param[in] desired_state The state to match.
+  //! \param[in] visitor The object to call with each matching report.
+  void VisitReports(ReportState desired_state,
+                    CrashReportDatabase::ReportVisitor* visitor) const;
+
   //! \brief Finds the report matching the given UUID.
   //!
   //! The returned report is only valid if CrashReportDatabase::kNoError is
@@ -351,6 +358,16 @@ OperationStatus Metadata::FindReports(
   return CrashReportDatabase::kNoError;
 }
 
+void Metadata::VisitReports(ReportState desired_state,
+                            CrashReportDatabase::ReportVisitor* visitor) const {
+  for (const auto& report : reports_) {
+    if (report.state == desired_state &&
+        VerifyReport(report, desired_state) == CrashReportDatabase::kNoError) {
+      visitor->VisitReport(report);
+    }
+  }
+}
+
 OperationStatus Metadata::FindSingleReport(
     const UUID& uuid,
     const ReportDisk** out_report) const {
@@ -598,6 +615,7 @@ class CrashReportDatabaseWin : public CrashReportDatabase {
                                    Metrics::CrashSkippedReason reason) override;
   OperationStatus DeleteReport(const UUID& uuid) override;
   OperationStatus RequestUpload(const UUID& uuid) override;
+  OperationStatus VisitReports(uint8_t states, ReportVisitor* visitor) override;
 
  private:
   std::unique_ptr<Metadata> AcquireMetadata();
@@ -745,6 +763,20 @@ OperationStatus CrashReportDatabaseWin::GetCompletedReports(
                   : kDatabaseError;
 }
 
+OperationStatus CrashReportDatabaseWin::VisitReports(uint8_t states,
+                                                     ReportVisitor* visitor) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+
+  std::unique_ptr<Metadata> metadata(AcquireMetadata());
+  if (!metadata)
+    return kDatabaseError;
+  if (states & ReportQuery::kStatePending)
+    metadata->VisitReports(ReportState::kPending, visitor);
+  if (states & ReportQuery::kStateCompleted)
+    metadata->VisitReports(ReportState::kCompleted, visitor);
+  return kNoError;
+}
+
 OperationStatus CrashReportDatabaseWin::GetReportForUploading(
     const UUID& uuid,
     const Report** report) {
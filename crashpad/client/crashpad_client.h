@@ -30,6 +30,9 @@
 #elif defined(OS_WIN)
 #include <windows.h>
 #include "util/win/scoped_handle.h"
+#elif defined(OS_LINUX) || defined(OS_ANDROID)
+#include <sys/types.h>
+#include "util/file/file_io.h"
 #endif
 
 namespace crashpad {
@@ -41,9 +44,12 @@ class CrashpadClient {
   CrashpadClient();
   ~CrashpadClient();
 
+#if defined(OS_MACOSX) || defined(OS_WIN) || DOXYGEN
   //! \brief Starts a Crashpad handler process, performing any necessary
   //!     handshake to configure it.
   //!
+  //! This method is only defined on macOS and Windows.
+  //!
   //! This method directs crashes to the Crashpad handler. On macOS, this is
   //! applicable to this process and all subsequent child processes. On Windows,
   //! child processes must also register by using SetHandlerIPCPipe().
@@ -104,6 +110,36 @@ class CrashpadClient {
                     const std::vector<std::string>& arguments,
                     bool restartable,
                     bool asynchronous_start);
+#endif
+
+#if defined(OS_LINUX) || defined(OS_ANDROID) || DOXYGEN
+  //! \brief Sets the process’ crash handler to a handler process connected
+  //!     by a socket.
+  //!
+  //! This method is only defined on Linux and Android, where it takes the place
+  //! of StartHandler(). The caller is responsible for starting the handler
+  //! and connecting \a sock to it.
+  //!
+  //! This method installs signal handlers for crash signals. All of the work
+  //! that can be done ahead of a crash is done here, so that the signal handler
+  //! only needs to send a single message over \a sock and wait for the handler
+  //! to reply once it has captured the process. If the process was using
+  //! another signal handler for a crash signal, that signal handler is
+  //! restored and the signal re-raised afterwards.
+  //!
+  //! The handler must have enabled credential passing on its end of \a sock,
+  //! as by EnableClientCredentials().
+  //!
+  //! \param[in] sock A connected `AF_UNIX` `SOCK_SEQPACKET` socket whose peer
+  //!     is the handler.
+  //! \param[in] pid The process ID of the handler. If positive, the handler is
+  //!     permitted to trace this process with `PR_SET_PTRACER`, which is
+  //!     required under Yama’s restricted ptrace scope when the handler is not
+  //!     an ancestor of this process. If `0`, no tracer is set.
+  //!
+  //! \return `true` on success, `false` on failure with a message logged.
+  bool SetHandlerSocket(ScopedFileHandle sock, pid_t pid);
+#endif
 
 #if defined(OS_MACOSX) || DOXYGEN
   //! \brief Sets the process’ crash handler to a Mach service registered with
@@ -0,0 +1,133 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "client/crashpad_client.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "base/atomicops.h"
+#include "base/logging.h"
+#include "util/file/file_io.h"
+#include "util/linux/exception_handler_protocol.h"
+#include "util/linux/exception_information.h"
+#include "util/misc/clock.h"
+#include "util/misc/from_pointer_cast.h"
+#include "util/posix/signals.h"
+
+// Yama’s prctl() option, from <linux/prctl.h>, which may not be available.
+#if !defined(PR_SET_PTRACER)
+#define PR_SET_PTRACER 0x59616d61
+#endif
+
+namespace crashpad {
+
+namespace {
+
+// The socket connected to the handler. Once set, it is never closed, because
+// a crashing thread may be using it at any time.
+int g_handler_socket = -1;
+
+// Where we store the exception information that the crash handler reads.
+ExceptionInformation g_exception_information;
+
+// The signal actions in effect before the crash handlers were installed. These
+// are restored before a crash signal is re-raised.
+Signals::OldActions g_old_actions;
+
+// The thread ID of the thread that is having its crash handled, or 0.
+base::subtle::Atomic32 g_handling_thread_id;
+
+// Set to 1 once the handler has responded to the crash request, successfully
+// or not.
+base::subtle::Atomic32 g_crash_handled;
+
+pid_t GetTid() {
+  return static_cast<pid_t>(syscall(SYS_gettid));
+}
+
+void HandleCrashSignal(int sig, siginfo_t* siginfo, void* context) {
+  // Everything here must be async-signal-safe. The request to the handler is
+  // a single message on an already-connected socket, so that the handler can
+  // begin capturing as soon as the signal is delivered.
+  const pid_t tid = GetTid();
+  const base::subtle::Atomic32 handling_thread_id =
+      base::subtle::NoBarrier_CompareAndSwap(&g_handling_thread_id, 0, tid);
+  if (handling_thread_id == 0) {
+    // This is the first thread to crash. Record the exception and ask the
+    // handler to capture the process, which includes all other threads.
+    g_exception_information.siginfo_address =
+        FromPointerCast<LinuxVMAddress>(siginfo);
+    g_exception_information.context_address =
+        FromPointerCast<LinuxVMAddress>(context);
+    g_exception_information.thread_id = tid;
+
+    ClientInformation info;
+    info.exception_information_address =
+        FromPointerCast<LinuxVMAddress>(&g_exception_information);
+    RequestCrashDump(g_handler_socket, info);
+
+    base::subtle::Release_Store(&g_crash_handled, 1);
+  } else if (handling_thread_id != tid) {
+    // Another thread crashed first. Wait here, where the handler will capture
+    // this thread’s stack, until that crash has been handled. The process will
+    // normally be terminated before this wait ends.
+    while (!base::subtle::Acquire_Load(&g_crash_handled)) {
+      SleepNanoseconds(1E6);
+    }
+  }
+
+  // If this thread crashed again while its first crash was being handled,
+  // it falls through to here directly.
+  Signals::RestoreHandlerAndReraiseSignalOnReturn(
+      siginfo, g_old_actions.ActionForSignal(sig));
+}
+
+}  // namespace
+
+CrashpadClient::CrashpadClient() {}
+
+CrashpadClient::~CrashpadClient() {}
+
+bool CrashpadClient::SetHandlerSocket(ScopedFileHandle sock, pid_t pid) {
+  if (!sock.is_valid()) {
+    LOG(ERROR) << "invalid handler socket";
+    return false;
+  }
+
+  // Under Yama’s restricted ptrace scope, the handler may only attach to this
+  // process if it is named as a tracer. Doing this now, rather than at crash
+  // time, keeps it out of the signal handler. EINVAL indicates that Yama is
+  // not in use, in which case nothing needs to be done.
+  if (pid > 0 && prctl(PR_SET_PTRACER, pid, 0, 0, 0) != 0 && errno != EINVAL) {
+    PLOG(WARNING) << "prctl";
+  }
+
+  const int old_socket = g_handler_socket;
+  g_handler_socket = sock.release();
+  if (old_socket >= 0) {
+    // The crash handlers are already installed and only the socket changes.
+    // The old socket is leaked rather than closed, in case a crashing thread
+    // is still using it.
+    return true;
+  }
+
+  return Signals::InstallCrashHandlers(
+      HandleCrashSignal, SA_ONSTACK, &g_old_actions);
+}
+
+}  // namespace crashpad
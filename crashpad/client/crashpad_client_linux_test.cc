@@ -0,0 +1,121 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "client/crashpad_client.h"
+
+#include <signal.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <utility>
+
+#include "gtest/gtest.h"
+#include "test/errors.h"
+#include "test/multiprocess.h"
+#include "util/file/file_io.h"
+#include "util/linux/exception_handler_protocol.h"
+#include "util/linux/exception_information.h"
+#include "util/process/process_memory.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+// The parent acts as the handler for a child that crashes after connecting to
+// it with SetHandlerSocket().
+class HandlerSocketTest : public Multiprocess {
+ public:
+  explicit HandlerSocketTest(bool respond)
+      : Multiprocess(), respond_(respond), server_sock_(), client_sock_() {
+    SetExpectedChildTermination(kTerminationSignal, SIGSEGV);
+  }
+
+  ~HandlerSocketTest() {}
+
+ private:
+  void PreFork() override {
+    ASSERT_NO_FATAL_FAILURE(Multiprocess::PreFork());
+
+    int sockets[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sockets), 0)
+        << ErrnoMessage("socketpair");
+    server_sock_.reset(sockets[0]);
+    client_sock_.reset(sockets[1]);
+    ASSERT_TRUE(EnableClientCredentials(server_sock_.get()));
+  }
+
+  void MultiprocessParent() override {
+    client_sock_.reset();
+
+    ClientToServerMessage message;
+    pid_t client_pid;
+    ASSERT_TRUE(
+        ReceiveClientMessage(server_sock_.get(), &message, &client_pid));
+    EXPECT_EQ(client_pid, ChildPID());
+    EXPECT_EQ(message.type, ClientToServerMessage::kCrashDumpRequest);
+
+    ProcessMemory memory;
+    ASSERT_TRUE(memory.Initialize(ChildPID()));
+
+    ExceptionInformation exception_information;
+    ASSERT_TRUE(memory.Read(message.client_info.exception_information_address,
+                            sizeof(exception_information),
+                            &exception_information));
+    EXPECT_EQ(exception_information.thread_id, ChildPID());
+    EXPECT_NE(exception_information.context_address, 0u);
+
+    siginfo_t siginfo;
+    ASSERT_TRUE(memory.Read(exception_information.siginfo_address,
+                            sizeof(siginfo),
+                            &siginfo));
+    EXPECT_EQ(siginfo.si_signo, SIGSEGV);
+
+    if (respond_) {
+      EXPECT_TRUE(SendServerResponse(
+          server_sock_.get(), ServerToClientMessage::kCrashDumpComplete));
+    } else {
+      // Without a response, the client proceeds once the connection closes.
+      server_sock_.reset();
+    }
+  }
+
+  void MultiprocessChild() override {
+    server_sock_.reset();
+
+    CrashpadClient client;
+    ASSERT_TRUE(client.SetHandlerSocket(std::move(client_sock_), getppid()));
+
+    raise(SIGSEGV);
+  }
+
+  bool respond_;
+  ScopedFileHandle server_sock_;
+  ScopedFileHandle client_sock_;
+
+  DISALLOW_COPY_AND_ASSIGN(HandlerSocketTest);
+};
+
+TEST(CrashpadClientLinux, SetHandlerSocket) {
+  HandlerSocketTest test(true);
+  test.Run();
+}
+
+TEST(CrashpadClientLinux, SetHandlerSocketHandlerGone) {
+  HandlerSocketTest test(false);
+  test.Run();
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
@@ -28,7 +28,9 @@
 
 namespace {
 
-constexpr uint32_t kCrashpadInfoVersion = 1;
+// Version 2 added annotation_arena_. Readers may not look for fields that a
+// structure’s version does not have.
+constexpr uint32_t kCrashpadInfoVersion = 2;
 
 }  // namespace
 
@@ -120,7 +122,8 @@ CrashpadInfo::CrashpadInfo()
       padding_1_(0),
       extra_memory_ranges_(nullptr),
       simple_annotations_(nullptr),
-      user_data_minidump_stream_head_(nullptr)
+      user_data_minidump_stream_head_(nullptr),
+      annotation_arena_(nullptr)
 #if !defined(NDEBUG) && defined(OS_WIN)
       ,
       invalid_read_detection_(0xbadc0de)
@@ -19,6 +19,7 @@
 
 #include "base/macros.h"
 #include "build/build_config.h"
+#include "client/annotation_arena.h"
 #include "client/simple_address_range_bag.h"
 #include "client/simple_string_dictionary.h"
 #include "util/misc/tri_state.h"
@@ -109,6 +110,32 @@ struct CrashpadInfo {
     return simple_annotations_;
   }
 
+  //! \brief Sets the annotation arena.
+  //!
+  //! Like simple annotations, annotations set in an AnnotationArena are
+  //! interpreted by Crashpad as module-level annotations. Unlike simple
+  //! annotations, their keys and values may be of any length that fits in the
+  //! arena. If the same key is present in both, the simple annotation is used.
+  //!
+  //! Annotations may exist in \a annotation_arena at the time that this method
+  //! is called, or they may be added, removed, or modified in \a
+  //! annotation_arena after this method is called.
+  //!
+  //! \param[in] annotation_arena An arena of annotations. The CrashpadInfo
+  //!     object does not take ownership of the AnnotationArena object. It is
+  //!     the caller’s responsibility to ensure that this pointer remains valid
+  //!     while it is in effect for a CrashpadInfo object.
+  //!
+  //! \sa annotation_arena()
+  void set_annotation_arena(AnnotationArena* annotation_arena) {
+    annotation_arena_ = annotation_arena;
+  }
+
+  //! \return The annotation arena.
+  //!
+  //! \sa set_annotation_arena()
+  AnnotationArena* annotation_arena() const { return annotation_arena_; }
+
   //! \brief Enables or disables Crashpad handler processing.
   //!
   //! When handling an exception, the Crashpad handler will scan all modules in
@@ -219,6 +246,9 @@ struct CrashpadInfo {
   SimpleStringDictionary* simple_annotations_;  // weak
   internal::UserDataMinidumpStreamListEntry* user_data_minidump_stream_head_;
 
+  // Fields present in version 2:
+  AnnotationArena* annotation_arena_;  // weak
+
 #if !defined(NDEBUG) && defined(OS_WIN)
   uint32_t invalid_read_detection_;
 #endif
@@ -16,7 +16,6 @@
 
 #include <sys/stat.h>
 
-#include <algorithm>
 #include <vector>
 
 #include "base/logging.h"
@@ -27,31 +26,24 @@ namespace crashpad {
 
 void PruneCrashReportDatabase(CrashReportDatabase* database,
                               PruneCondition* condition) {
-  std::vector<CrashReportDatabase::Report> all_reports;
-  CrashReportDatabase::OperationStatus status;
-
-  status = database->GetPendingReports(&all_reports);
-  if (status != CrashReportDatabase::kNoError) {
-    LOG(ERROR) << "PruneCrashReportDatabase: Failed to get pending reports";
-    return;
-  }
-
-  std::vector<CrashReportDatabase::Report> completed_reports;
-  status = database->GetCompletedReports(&completed_reports);
+  // Conditions such as DatabaseSizePruneCondition accumulate state over the
+  // reports they are shown, so reports are visited newest first, across all
+  // states. Ordering them requires every report, so they are obtained in a
+  // single pass over the database.
+  CrashReportDatabase::ReportQuery query;
+  query.states = CrashReportDatabase::ReportQuery::kStateAny;
+  query.order = CrashReportDatabase::ReportQuery::Order::kNewestFirst;
+
+  CrashReportDatabase::ReportCursor cursor;
+  std::vector<CrashReportDatabase::Report> reports;
+  CrashReportDatabase::OperationStatus status =
+      database->GetReports(query, &cursor, &reports);
   if (status != CrashReportDatabase::kNoError) {
-    LOG(ERROR) << "PruneCrashReportDatabase: Failed to get completed reports";
+    LOG(ERROR) << "PruneCrashReportDatabase: Failed to get reports";
     return;
   }
-  all_reports.insert(all_reports.end(), completed_reports.begin(),
-                     completed_reports.end());
-
-  std::sort(all_reports.begin(), all_reports.end(),
-      [](const CrashReportDatabase::Report& lhs,
-         const CrashReportDatabase::Report& rhs) {
-        return lhs.creation_time > rhs.creation_time;
-      });
 
-  for (const auto& report : all_reports) {
+  for (const auto& report : reports) {
     if (condition->ShouldPruneReport(report)) {
       status = database->DeleteReport(report.uuid);
       if (status != CrashReportDatabase::kNoError) {
@@ -43,6 +43,12 @@
 //! \sa MINIDUMP_LOCATION_DESCRIPTOR
 typedef uint32_t RVA;
 
+//! \brief A 64-bit offset within a minidump file, relative to the start of its
+//!     MINIDUMP_HEADER.
+//!
+//! \sa MINIDUMP_MEMORY64_LIST
+typedef uint64_t RVA64;
+
 //! \brief A pointer to a structure or union within a minidump file.
 struct __attribute__((packed, aligned(4))) MINIDUMP_LOCATION_DESCRIPTOR {
   //! \brief The size of the referenced structure or union, in bytes.
@@ -66,6 +72,20 @@ struct __attribute__((packed, aligned(4))) MINIDUMP_MEMORY_DESCRIPTOR {
   MINIDUMP_LOCATION_DESCRIPTOR Memory;
 };
 
+//! \brief A snapshot of a region of memory contained within a minidump file’s
+//!     MINIDUMP_MEMORY64_LIST.
+//!
+//! The location of the region’s contents is implied by its position in the
+//! list.
+struct __attribute__((packed, aligned(4))) MINIDUMP_MEMORY_DESCRIPTOR64 {
+  //! \brief The base address of the memory region in the address space of the
+  //!     process that the minidump file contains a snapshot of.
+  uint64_t StartOfMemoryRange;
+
+  //! \brief The size of the memory region, in bytes.
+  uint64_t DataSize;
+};
+
 //! \brief The top-level structure identifying a minidump file.
 //!
 //! This structure contains a pointer to the stream directory, a second-level
@@ -154,6 +174,9 @@ enum MINIDUMP_STREAM_TYPE {
   //! \brief The stream type for MINIDUMP_EXCEPTION_STREAM.
   ExceptionStream = 6,
 
+  //! \brief The stream type for MINIDUMP_MEMORY64_LIST.
+  Memory64ListStream = 9,
+
   //! \brief The stream type for MINIDUMP_SYSTEM_INFO.
   SystemInfoStream = 7,
 
@@ -633,6 +656,23 @@ struct __attribute__((packed, aligned(4))) MINIDUMP_MEMORY_LIST {
   MINIDUMP_MEMORY_DESCRIPTOR MemoryRanges[0];
 };
 
+//! \brief Information about memory regions within the process, as written to
+//!     minidump files containing full memory.
+//!
+//! The contents of the memory regions are stored contiguously, in the order in
+//! which they are listed, beginning at #BaseRva.
+struct __attribute__((packed, aligned(4))) MINIDUMP_MEMORY64_LIST {
+  //! \brief The number of memory regions present in the #MemoryRanges array.
+  uint64_t NumberOfMemoryRanges;
+
+  //! \brief The location of the contents of the first memory region.
+  RVA64 BaseRva;
+
+  //! \brief Structures identifying each memory region present in the minidump
+  //!     file.
+  MINIDUMP_MEMORY_DESCRIPTOR64 MemoryRanges[0];
+};
+
 //! \brief Contains the state of an individual system handle at the time the
 //!     snapshot was taken. This structure is Windows-specific.
 //!
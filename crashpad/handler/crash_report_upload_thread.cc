@@ -15,28 +15,38 @@
 #include "handler/crash_report_upload_thread.h"
 
 #include <errno.h>
+#include <stdio.h>
 #include <time.h>
 
 #include <algorithm>
 #include <map>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "base/logging.h"
+#include "base/numerics/safe_conversions.h"
 #include "base/strings/stringprintf.h"
 #include "base/strings/utf_string_conversions.h"
 #include "build/build_config.h"
 #include "client/settings.h"
+#include "snapshot/minidump/light_minidump.h"
 #include "snapshot/minidump/process_snapshot_minidump.h"
 #include "snapshot/module_snapshot.h"
+#include "snapshot/process_snapshot.h"
+#include "util/file/file_io.h"
 #include "util/file/file_reader.h"
+#include "util/file/file_writer.h"
+#include "util/misc/clock.h"
 #include "util/misc/metrics.h"
 #include "util/misc/uuid.h"
 #include "util/net/http_body.h"
+#include "util/net/http_body_gzip.h"
 #include "util/net/http_multipart_builder.h"
 #include "util/net/http_transport.h"
 #include "util/net/url.h"
 #include "util/stdlib/map_insert.h"
+#include "util/stdlib/string_number_conversion.h"
 
 #if defined(OS_MACOSX)
 #include "handler/mac/file_limit_annotation.h"
@@ -46,6 +56,67 @@ namespace crashpad {
 
 namespace {
 
+// The timeout for each upload attempt.
+// TODO(mark): The timeout should be configurable by the client.
+constexpr double kUploadTimeoutSeconds = 60;  // 1 minute.
+
+// The amount of a report being written that may be held in memory for an
+// early upload, and the total time that writing the report may be held up
+// waiting for the upload before it is abandoned.
+constexpr size_t kEarlyUploadBufferSize = 1024 * 1024;
+constexpr double kEarlyUploadMaxStallSeconds = 1;
+
+// The form data key of the minidump file attachment.
+constexpr char kMinidumpKey[] = "upload_file_minidump";
+
+// The line in the response to a light minidump upload with which the server
+// asks for the full minidump.
+constexpr char kFullMinidumpRequested[] = "full_minidump_requested";
+
+// Writes a light minidump derived from the minidump file at |minidump_path| to
+// |light_file_writer|.
+bool WriteLightMinidumpFile(const base::FilePath& minidump_path,
+                            FileWriterInterface* light_file_writer) {
+  FileReader minidump_file_reader;
+  if (!minidump_file_reader.Open(minidump_path)) {
+    return false;
+  }
+
+  return WriteLightMinidump(&minidump_file_reader, light_file_writer);
+}
+
+// Splits the response to a light minidump upload into the crash ID on its first
+// line, returned in |crash_id|, and whether any following line asks for the
+// full minidump.
+bool ParseLightUploadResponse(const std::string& response_body,
+                              std::string* crash_id) {
+  size_t line_end = response_body.find('\n');
+  crash_id->assign(response_body, 0, line_end);
+  if (!crash_id->empty() && crash_id->back() == '\r') {
+    crash_id->pop_back();
+  }
+
+  while (line_end != std::string::npos) {
+    const size_t line_start = line_end + 1;
+    line_end = response_body.find('\n', line_start);
+    std::string line(response_body, line_start, line_end - line_start);
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+    if (line == kFullMinidumpRequested) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+HTTPEndpointSelector::Options EndpointOptions() {
+  HTTPEndpointSelector::Options options;
+  options.failure_cost_seconds = kUploadTimeoutSeconds;
+  return options;
+}
+
 void InsertOrReplaceMapEntry(std::map<std::string, std::string>* map,
                              const std::string& key,
                              const std::string& value) {
@@ -56,31 +127,24 @@ void InsertOrReplaceMapEntry(std::map<std::string, std::string>* map,
   }
 }
 
-// Given a minidump file readable by |minidump_file_reader|, returns a map of
-// key-value pairs to use as HTTP form parameters for upload to a Breakpad
-// server. The map is built by combining the process simple annotations map with
-// each module’s simple annotations map. In the case of duplicate keys, the map
-// will retain the first value found for any key, and will log a warning about
-// discarded values. Each module’s annotations vector is also examined and built
-// into a single string value, with distinct elements separated by newlines, and
-// stored at the key named “list_annotations”, which supersedes any other key
-// found by that name. The client ID stored in the minidump is converted to
-// a string and stored at the key named “guid”, which supersedes any other key
-// found by that name.
-//
-// In the event of an error reading the minidump file, a message will be logged.
-std::map<std::string, std::string> BreakpadHTTPFormParametersFromMinidump(
-    FileReader* minidump_file_reader) {
-  ProcessSnapshotMinidump minidump_process_snapshot;
-  if (!minidump_process_snapshot.Initialize(minidump_file_reader)) {
-    return std::map<std::string, std::string>();
-  }
-
+// Given |process_snapshot|, returns a map of key-value pairs to use as HTTP
+// form parameters for upload to a Breakpad server. The map is built by
+// combining the process simple annotations map with each module’s simple
+// annotations map. In the case of duplicate keys, the map will retain the first
+// value found for any key, and will log a warning about discarded values. Each
+// module’s annotations vector is also examined and built into a single string
+// value, with distinct elements separated by newlines, and stored at the key
+// named “list_annotations”, which supersedes any other key found by that name.
+// The client ID is converted to a string and stored at the key named “guid”,
+// which supersedes any other key found by that name.
+std::map<std::string, std::string>
+BreakpadHTTPFormParametersFromProcessSnapshot(
+    const ProcessSnapshot& process_snapshot) {
   std::map<std::string, std::string> parameters =
-      minidump_process_snapshot.AnnotationsSimpleMap();
+      process_snapshot.AnnotationsSimpleMap();
 
   std::string list_annotations;
-  for (const ModuleSnapshot* module : minidump_process_snapshot.Modules()) {
+  for (const ModuleSnapshot* module : process_snapshot.Modules()) {
     for (const auto& kv : module->AnnotationsSimpleMap()) {
       if (!parameters.insert(kv).second) {
         LOG(WARNING) << "duplicate key " << kv.first << ", discarding value "
@@ -102,12 +166,28 @@ std::map<std::string, std::string> BreakpadHTTPFormParametersFromMinidump(
   }
 
   UUID client_id;
-  minidump_process_snapshot.ClientID(&client_id);
+  process_snapshot.ClientID(&client_id);
   InsertOrReplaceMapEntry(&parameters, "guid", client_id.ToString());
 
   return parameters;
 }
 
+// Given a minidump file readable by |minidump_file_reader|, returns the
+// parameters that BreakpadHTTPFormParametersFromProcessSnapshot() would return
+// for its snapshot.
+//
+// In the event of an error reading the minidump file, a message will be logged.
+std::map<std::string, std::string> BreakpadHTTPFormParametersFromMinidump(
+    FileReader* minidump_file_reader) {
+  ProcessSnapshotMinidump minidump_process_snapshot;
+  if (!minidump_process_snapshot.Initialize(minidump_file_reader)) {
+    return std::map<std::string, std::string>();
+  }
+
+  return BreakpadHTTPFormParametersFromProcessSnapshot(
+      minidump_process_snapshot);
+}
+
 // Calls CrashReportDatabase::RecordUploadAttempt() with |successful| set to
 // false upon destruction unless disarmed by calling Fire() or Disarm(). Fire()
 // triggers an immediate call. Armed upon construction.
@@ -144,11 +224,17 @@ class CallRecordUploadAttempt {
 
 }  // namespace
 
-CrashReportUploadThread::CrashReportUploadThread(CrashReportDatabase* database,
-                                                 const std::string& url,
-                                                 const Options& options)
+CrashReportUploadThread::CrashReportUploadThread(
+    CrashReportDatabase* database,
+    const std::vector<std::string>& urls,
+    const Options& options)
     : options_(options),
-      url_(url),
+      lock_(),
+      endpoints_(urls, EndpointOptions()),
+      early_upload_report_uuids_(),
+      report_properties_(),
+      previous_report_properties_(),
+      adaptive_gzip_(),
       // When watching for pending reports, check every 15 minutes, even in the
       // absence of a signal from the handler thread. This allows for failed
       // uploads to be retried periodically, and for pending reports written by
@@ -156,7 +242,9 @@ CrashReportUploadThread::CrashReportUploadThread(CrashReportDatabase* database,
       thread_(options.watch_pending_reports ? 15 * 60.0
                                             : WorkerThread::kIndefiniteWait,
               this),
+      upload_queue_(UploadQueue::Options()),
       known_pending_report_uuids_(),
+      early_uploads_(),
       database_(database) {}
 
 CrashReportUploadThread::~CrashReportUploadThread() {
@@ -176,58 +264,380 @@ void CrashReportUploadThread::ReportPending(const UUID& report_uuid) {
   thread_.DoWorkNow();
 }
 
+void CrashReportUploadThread::ReportPending(
+    const UUID& report_uuid,
+    std::unique_ptr<EarlyUpload> early_upload) {
+  if (!early_upload) {
+    ReportPending(report_uuid);
+    return;
+  }
+
+  DCHECK_EQ(early_upload->report_uuid_, report_uuid);
+  early_uploads_.PushBack(std::move(early_upload));
+  thread_.DoWorkNow();
+}
+
+std::unique_ptr<CrashReportUploadThread::EarlyUpload>
+CrashReportUploadThread::StartEarlyUpload(
+    const ProcessSnapshot& process_snapshot,
+    const CrashReportDatabase::NewReport& new_report,
+    FileWriterInterface* report_file_writer) {
+  // Rate limiting and light minidumps are decided on when the report is
+  // processed, so an early upload can’t take place with either.
+  if (!options_.early_upload || options_.rate_limit ||
+      options_.upload_light_first || endpoints_.size() == 0) {
+    return nullptr;
+  }
+
+  Settings* const settings = database_->GetSettings();
+  bool uploads_enabled;
+  if (!settings || !settings->GetUploadsEnabled(&uploads_enabled) ||
+      !uploads_enabled) {
+    return nullptr;
+  }
+
+  // The early upload goes to the endpoint that an upload made now would try
+  // first. If it fails, the report is uploaded again later, when every endpoint
+  // can be tried.
+  size_t endpoint_index;
+  {
+    base::AutoLock lock(lock_);
+    const std::vector<size_t> endpoint_indices =
+        endpoints_.SelectEndpoints(ClockMonotonicNanoseconds());
+    if (endpoint_indices.empty()) {
+      return nullptr;
+    }
+    endpoint_index = endpoint_indices[0];
+  }
+
+  const std::map<std::string, std::string> parameters =
+      BreakpadHTTPFormParametersFromProcessSnapshot(process_snapshot);
+
+  std::unique_ptr<EarlyUpload> early_upload(new EarlyUpload(
+      this, new_report.uuid, endpoint_index, report_file_writer));
+
+  // The size of the report isn’t known in advance, so adaptive compression
+  // can’t be used, and the default compression level is used instead.
+  HTTPMultipartBuilder http_multipart_builder;
+  http_multipart_builder.SetGzipEnabled(options_.upload_gzip);
+
+  for (const auto& kv : parameters) {
+    if (kv.first == kMinidumpKey) {
+      LOG(WARNING) << "reserved key " << kv.first << ", discarding value "
+                   << kv.second;
+    } else {
+      http_multipart_builder.SetFormData(kv.first, kv.second);
+    }
+  }
+
+  http_multipart_builder.SetFileAttachmentStream(
+      kMinidumpKey,
+#if defined(OS_WIN)
+      base::UTF16ToUTF8(new_report.path.BaseName().value()),
+#else
+      new_report.path.BaseName().value(),
+#endif
+      early_upload->tee_file_writer_.GetBodyStream(),
+      "application/octet-stream");
+
+  HTTPHeaders content_headers;
+  http_multipart_builder.PopulateContentHeaders(&content_headers);
+
+  std::unique_ptr<HTTPTransport> http_transport(HTTPTransport::Create());
+  for (const auto& content_header : content_headers) {
+    http_transport->SetHeader(content_header.first, content_header.second);
+  }
+  http_transport->SetBodyStream(http_multipart_builder.GetBodyStream());
+  http_transport->SetTimeout(kUploadTimeoutSeconds);
+  http_transport->SetURL(UploadURL(endpoint_index, parameters));
+
+  early_upload->http_transport_ = std::move(http_transport);
+  early_upload->Start();
+  early_upload->started_ = true;
+  return early_upload;
+}
+
+CrashReportUploadThread::EarlyUpload::EarlyUpload(
+    CrashReportUploadThread* upload_thread,
+    const UUID& report_uuid,
+    size_t endpoint_index,
+    FileWriterInterface* report_file_writer)
+    : Thread(),
+      upload_thread_(upload_thread),
+      report_uuid_(report_uuid),
+      endpoint_index_(endpoint_index),
+      tee_file_writer_(report_file_writer,
+                       kEarlyUploadBufferSize,
+                       kEarlyUploadMaxStallSeconds),
+      http_transport_(),
+      response_body_(),
+      duration_ns_(0),
+      started_(false),
+      joined_(false),
+      success_(false),
+      endpoint_failed_(false) {
+  base::AutoLock lock(upload_thread_->lock_);
+  upload_thread_->early_upload_report_uuids_.push_back(report_uuid_);
+}
+
+CrashReportUploadThread::EarlyUpload::~EarlyUpload() {
+  // If the report was not written in full, this aborts the upload.
+  Finish(false);
+
+  std::string response_body;
+  uint64_t duration_ns;
+  WaitForCompletion(&response_body, &duration_ns);
+
+  base::AutoLock lock(upload_thread_->lock_);
+  std::vector<UUID>& report_uuids = upload_thread_->early_upload_report_uuids_;
+  const auto it =
+      std::find(report_uuids.begin(), report_uuids.end(), report_uuid_);
+  DCHECK(it != report_uuids.end());
+  report_uuids.erase(it);
+}
+
+bool CrashReportUploadThread::EarlyUpload::WaitForCompletion(
+    std::string* response_body,
+    uint64_t* duration_ns) {
+  if (started_ && !joined_) {
+    Join();
+    joined_ = true;
+  }
+
+  if (!success_) {
+    return false;
+  }
+
+  *response_body = response_body_;
+  *duration_ns = duration_ns_;
+  return true;
+}
+
+void CrashReportUploadThread::EarlyUpload::ThreadMain() {
+  const uint64_t start_time = ClockMonotonicNanoseconds();
+  const bool executed = http_transport_->ExecuteSynchronously(&response_body_);
+
+  // A failure is the endpoint’s only if the report was still being streamed
+  // to it, rather than abandoned or written incompletely.
+  const bool streaming = tee_file_writer_.streaming();
+  success_ = executed && streaming;
+  endpoint_failed_ = !executed && streaming;
+
+  // Only the time spent on the network reflects on the endpoint, so the time
+  // spent waiting for the report to be written is left out.
+  const uint64_t elapsed_ns = ClockMonotonicNanoseconds() - start_time;
+  const uint64_t waited_ns = tee_file_writer_.reader_waited_ns();
+  duration_ns_ = elapsed_ns > waited_ns ? elapsed_ns - waited_ns : 0;
+
+  // The body stream refers to |tee_file_writer_|, so release it here rather
+  // than leaving it to outlive this thread.
+  http_transport_.reset();
+}
+
+class CrashReportUploadThread::PendingReportVisitor final
+    : public CrashReportDatabase::ReportVisitor {
+ public:
+  explicit PendingReportVisitor(
+      std::vector<CrashReportDatabase::Report>* reports)
+      : reports_(reports) {}
+
+  ~PendingReportVisitor() {}
+
+  // CrashReportDatabase::ReportVisitor:
+  void VisitReport(const CrashReportDatabase::Report& report) override {
+    // This runs with the database locked, so only what EnqueueReport() needs
+    // is copied here, and the minidump is read after the pass completes.
+    CrashReportDatabase::Report found_report;
+    found_report.uuid = report.uuid;
+    found_report.file_path = report.file_path;
+    found_report.creation_time = report.creation_time;
+    found_report.upload_explicitly_requested =
+        report.upload_explicitly_requested;
+    reports_->push_back(found_report);
+  }
+
+ private:
+  std::vector<CrashReportDatabase::Report>* reports_;  // weak
+
+  DISALLOW_COPY_AND_ASSIGN(PendingReportVisitor);
+};
+
 void CrashReportUploadThread::ProcessPendingReports() {
-  std::vector<UUID> known_report_uuids = known_pending_report_uuids_.Drain();
-  for (const UUID& report_uuid : known_report_uuids) {
+  // Properties of reports enqueued during the last pass are kept if the report
+  // is enqueued again during this one.
+  previous_report_properties_.clear();
+  previous_report_properties_.swap(report_properties_);
+
+  EnqueueKnownPendingReports();
+
+  // Scan for pending reports not already known to this thread.
+  if (options_.watch_pending_reports) {
+    // Pending reports are found in a single pass over the database. Only a
+    // few fields of each are kept while the database is being visited, and
+    // their minidumps are read once the pass is complete.
+    CrashReportDatabase::ReportQuery query;
+    query.states = CrashReportDatabase::ReportQuery::kStatePending;
+
+    std::vector<CrashReportDatabase::Report> found_reports;
+    PendingReportVisitor visitor(&found_reports);
+    // If the database is sick, it might be prudent to stop trying to poke it
+    // from this thread by abandoning the thread altogether. On the other hand,
+    // if the problem is transient, it might be possible to talk to it again on
+    // the next pass. For now, take the latter approach, but process the
+    // reports already found.
+    database_->ForEachReport(query, &visitor);
+
+    for (const CrashReportDatabase::Report& report : found_reports) {
+      if (!upload_queue_.Contains(report.uuid) &&
+          !HasEarlyUpload(report.uuid)) {
+        EnqueueReport(report);
+      }
+    }
+  }
+
+  // Each report found above is processed once in this pass. A report that is
+  // still pending afterwards, because its upload failed, can wait until at
+  // least the next pass through this method.
+  UUID report_uuid;
+  while (upload_queue_.Pop(time(nullptr), &report_uuid)) {
     CrashReportDatabase::Report report;
-    if (database_->LookUpCrashReport(report_uuid, &report) !=
+    if (database_->LookUpCrashReport(report_uuid, &report) ==
         CrashReportDatabase::kNoError) {
-      continue;
+      ProcessPendingReport(report);
     }
 
-    ProcessPendingReport(report);
-
     // Respect Stop() being called after at least one attempt to process a
     // report.
     if (!thread_.is_running()) {
       return;
     }
+
+    // Reports added while the last one was being processed are placed in the
+    // queue now, so that a fresh crash need not wait for a backlog.
+    EnqueueKnownPendingReports();
   }
+}
 
-  // Known pending reports are always processed (above). The rest of this
-  // function is concerned with scanning for pending reports not already known
-  // to this thread.
-  if (!options_.watch_pending_reports) {
-    return;
+void CrashReportUploadThread::EnqueueKnownPendingReports() {
+  // Early uploads are completed first, because they are likely to be complete
+  // or nearly so already. A report whose early upload failed is queued as any
+  // other known pending report.
+  std::vector<UUID> known_report_uuids;
+  for (const auto& early_upload : early_uploads_.Drain()) {
+    if (!CompleteEarlyUpload(early_upload.get())) {
+      known_report_uuids.push_back(early_upload->report_uuid_);
+    }
   }
 
-  std::vector<CrashReportDatabase::Report> reports;
-  if (database_->GetPendingReports(&reports) != CrashReportDatabase::kNoError) {
-    // The database is sick. It might be prudent to stop trying to poke it from
-    // this thread by abandoning the thread altogether. On the other hand, if
-    // the problem is transient, it might be possible to talk to it again on the
-    // next pass. For now, take the latter approach.
-    return;
+  std::vector<UUID> other_report_uuids = known_pending_report_uuids_.Drain();
+  known_report_uuids.insert(known_report_uuids.end(),
+                            other_report_uuids.begin(),
+                            other_report_uuids.end());
+  for (const UUID& report_uuid : known_report_uuids) {
+    CrashReportDatabase::Report report;
+    if (database_->LookUpCrashReport(report_uuid, &report) ==
+        CrashReportDatabase::kNoError) {
+      EnqueueReport(report);
+    }
+  }
+}
+
+void CrashReportUploadThread::EnqueueReport(
+    const CrashReportDatabase::Report& report) {
+  UploadQueue::Entry entry;
+  entry.uuid = report.uuid;
+  entry.upload_explicitly_requested = report.upload_explicitly_requested;
+  entry.creation_time = report.creation_time;
+
+  auto it = report_properties_.find(report.uuid);
+  if (it == report_properties_.end()) {
+    auto previous_it = previous_report_properties_.find(report.uuid);
+    if (previous_it != previous_report_properties_.end()) {
+      it = report_properties_.insert(*previous_it).first;
+      previous_report_properties_.erase(previous_it);
+    } else {
+      const ReportProperties properties = ReadReportProperties(report);
+      it = report_properties_.insert(std::make_pair(report.uuid, properties))
+               .first;
+    }
+  }
+  entry.priority = it->second.priority;
+  entry.size = it->second.size;
+
+  upload_queue_.Push(entry);
+}
+
+// static
+CrashReportUploadThread::ReportProperties
+CrashReportUploadThread::ReadReportProperties(
+    const CrashReportDatabase::Report& report) {
+  ReportProperties properties;
+  properties.priority = 0;
+  properties.size = 0;
+
+  FileReader minidump_file_reader;
+  if (!minidump_file_reader.Open(report.file_path)) {
+    return properties;
   }
 
-  for (const CrashReportDatabase::Report& report : reports) {
-    if (std::find(known_report_uuids.begin(),
-                  known_report_uuids.end(),
-                  report.uuid) != known_report_uuids.end()) {
-      // An attempt to process the report already occurred above. The report is
-      // still pending, so upload must have failed. Don’t retry it immediately,
-      // it can wait until at least the next pass through this method.
-      continue;
+  const FileOffset size = minidump_file_reader.Seek(0, SEEK_END);
+  if (size > 0) {
+    properties.size = size;
+  }
+
+  // The priority annotation may be set in the process or in any module, as
+  // for any other annotation sent as a form parameter.
+  if (minidump_file_reader.SeekSet(0)) {
+    const std::map<std::string, std::string> parameters =
+        BreakpadHTTPFormParametersFromMinidump(&minidump_file_reader);
+    const auto it = parameters.find(kUploadPriorityAnnotationKey);
+    if (it != parameters.end() &&
+        !StringToNumber(it->second, &properties.priority)) {
+      LOG(WARNING) << "invalid " << kUploadPriorityAnnotationKey << " "
+                   << it->second;
+      properties.priority = 0;
     }
+  }
 
-    ProcessPendingReport(report);
+  return properties;
+}
 
-    // Respect Stop() being called after at least one attempt to process a
-    // report.
-    if (!thread_.is_running()) {
-      return;
+bool CrashReportUploadThread::HasEarlyUpload(const UUID& report_uuid) const {
+  base::AutoLock lock(lock_);
+  return std::find(early_upload_report_uuids_.begin(),
+                   early_upload_report_uuids_.end(),
+                   report_uuid) != early_upload_report_uuids_.end();
+}
+
+bool CrashReportUploadThread::CompleteEarlyUpload(EarlyUpload* early_upload) {
+  std::string response_body;
+  uint64_t duration_ns;
+  if (!early_upload->WaitForCompletion(&response_body, &duration_ns)) {
+    LOG(WARNING) << "early upload failed";
+    if (early_upload->endpoint_failed_) {
+      base::AutoLock lock(lock_);
+      endpoints_.RecordFailure(early_upload->endpoint_index_,
+                               ClockMonotonicNanoseconds());
     }
+    return false;
+  }
+
+  {
+    base::AutoLock lock(lock_);
+    endpoints_.RecordSuccess(early_upload->endpoint_index_, duration_ns);
+  }
+
+  const CrashReportDatabase::Report* upload_report;
+  if (database_->GetReportForUploading(early_upload->report_uuid_,
+                                       &upload_report) !=
+      CrashReportDatabase::kNoError) {
+    // The upload took place, but it can’t be recorded. Don’t upload the report
+    // again.
+    return true;
   }
+
+  database_->RecordUploadAttempt(upload_report, true, response_body);
+  return true;
 }
 
 void CrashReportUploadThread::ProcessPendingReport(
@@ -239,7 +649,7 @@ void CrashReportUploadThread::ProcessPendingReport(
   Settings* const settings = database_->GetSettings();
 
   bool uploads_enabled;
-  if (url_.empty() ||
+  if (endpoints_.size() == 0 ||
       (!report.upload_explicitly_requested &&
        (!settings->GetUploadsEnabled(&uploads_enabled) || !uploads_enabled))) {
     // Don’t attempt an upload if there’s no URL to upload to. Allow upload if
@@ -342,15 +752,87 @@ void CrashReportUploadThread::ProcessPendingReport(
 CrashReportUploadThread::UploadResult CrashReportUploadThread::UploadReport(
     const CrashReportDatabase::Report* report,
     std::string* response_body) {
+  if (options_.upload_light_first) {
+    // The light minidump is written to a new report in the database, which is
+    // never finished, so that it stays out of the pending reports and is
+    // removed when |call_error_writing_crash_report| goes out of scope.
+    CrashReportDatabase::NewReport* light_report;
+    if (database_->PrepareNewCrashReport(&light_report) ==
+        CrashReportDatabase::kNoError) {
+      CrashReportDatabase::CallErrorWritingCrashReport
+          call_error_writing_crash_report(database_, light_report);
+
+      WeakFileHandleFileWriter light_file_writer(light_report->handle);
+      if (WriteLightMinidumpFile(report->file_path, &light_file_writer)) {
+        std::string light_response_body;
+        UploadResult upload_result =
+            UploadMinidump(report,
+                           light_report->path,
+                           {{"minidump_tier", "light"}},
+                           &light_response_body);
+        if (upload_result != UploadResult::kSuccess) {
+          return upload_result;
+        }
+
+        std::string crash_id;
+        if (!ParseLightUploadResponse(light_response_body, &crash_id)) {
+          *response_body = crash_id;
+          return UploadResult::kSuccess;
+        }
+
+        return UploadMinidump(
+            report,
+            report->file_path,
+            {{"minidump_tier", "full"}, {"light_crash_id", crash_id}},
+            response_body);
+      }
+    }
+
+    LOG(WARNING) << "uploading full minidump without a light minidump";
+  }
+
+  return UploadMinidump(report,
+                        report->file_path,
+                        std::map<std::string, std::string>(),
+                        response_body);
+}
+
+CrashReportUploadThread::UploadResult CrashReportUploadThread::UploadMinidump(
+    const CrashReportDatabase::Report* report,
+    const base::FilePath& minidump_path,
+    const std::map<std::string, std::string>& extra_parameters,
+    std::string* response_body) {
   std::map<std::string, std::string> parameters;
+  FileOffset report_size;
+  bool gzip_enabled = options_.upload_gzip;
+  int gzip_compression_level = GzipHTTPBodyStream::kDefaultCompressionLevel;
 
   {
     FileReader minidump_file_reader;
-    if (!minidump_file_reader.Open(report->file_path)) {
+    if (!minidump_file_reader.Open(minidump_path)) {
       // If the minidump file can’t be opened, all hope is lost.
       return UploadResult::kPermanentFailure;
     }
 
+    report_size = minidump_file_reader.Seek(0, SEEK_END);
+    if (report_size < 0 || !minidump_file_reader.SeekSet(0)) {
+      return UploadResult::kPermanentFailure;
+    }
+
+    if (gzip_enabled && options_.upload_gzip_adaptive) {
+      // Choose how to compress based on a sample from the start of the file.
+      std::unique_ptr<uint8_t[]> sample(
+          new uint8_t[AdaptiveGzip::kSampleSize]);
+      FileOperationResult sample_size =
+          minidump_file_reader.Read(sample.get(), AdaptiveGzip::kSampleSize);
+      if (sample_size >= 0 && minidump_file_reader.SeekSet(0)) {
+        AdaptiveGzip::Choice choice =
+            adaptive_gzip_.Choose(sample.get(), sample_size, report_size);
+        gzip_enabled = choice.gzip_enabled;
+        gzip_compression_level = choice.compression_level;
+      }
+    }
+
     // If the minidump file could be opened, ignore any errors that might occur
     // when attempting to interpret it. This may result in its being uploaded
     // with few or no parameters, but as long as there’s a dump file, the server
@@ -358,10 +840,13 @@ CrashReportUploadThread::UploadResult CrashReportUploadThread::UploadReport(
     parameters = BreakpadHTTPFormParametersFromMinidump(&minidump_file_reader);
   }
 
-  HTTPMultipartBuilder http_multipart_builder;
-  http_multipart_builder.SetGzipEnabled(options_.upload_gzip);
+  for (const auto& kv : extra_parameters) {
+    InsertOrReplaceMapEntry(&parameters, kv.first, kv.second);
+  }
 
-  static constexpr char kMinidumpKey[] = "upload_file_minidump";
+  HTTPMultipartBuilder http_multipart_builder;
+  http_multipart_builder.SetGzipEnabled(gzip_enabled);
+  http_multipart_builder.SetGzipCompressionLevel(gzip_compression_level);
 
   for (const auto& kv : parameters) {
     if (kv.first == kMinidumpKey) {
@@ -379,20 +864,70 @@ CrashReportUploadThread::UploadResult CrashReportUploadThread::UploadReport(
 #else
       report->file_path.BaseName().value(),
 #endif
-      report->file_path,
+      minidump_path,
       "application/octet-stream");
 
-  std::unique_ptr<HTTPTransport> http_transport(HTTPTransport::Create());
   HTTPHeaders content_headers;
   http_multipart_builder.PopulateContentHeaders(&content_headers);
-  for (const auto& content_header : content_headers) {
-    http_transport->SetHeader(content_header.first, content_header.second);
+
+  // The body stream is consumed by each attempt, so a new one is obtained from
+  // |http_multipart_builder| for each endpoint tried.
+  std::vector<size_t> endpoint_indices;
+  {
+    base::AutoLock lock(lock_);
+    endpoint_indices = endpoints_.SelectEndpoints(ClockMonotonicNanoseconds());
   }
-  http_transport->SetBodyStream(http_multipart_builder.GetBodyStream());
-  // TODO(mark): The timeout should be configurable by the client.
-  http_transport->SetTimeout(60.0);  // 1 minute.
+  for (size_t index : endpoint_indices) {
+    std::unique_ptr<HTTPTransport> http_transport(HTTPTransport::Create());
+    for (const auto& content_header : content_headers) {
+      http_transport->SetHeader(content_header.first, content_header.second);
+    }
+    MeasuringHTTPBodyStream::Measurements body_measurements;
+    http_transport->SetBodyStream(
+        std::unique_ptr<HTTPBodyStream>(new MeasuringHTTPBodyStream(
+            http_multipart_builder.GetBodyStream(), &body_measurements)));
+    http_transport->SetTimeout(kUploadTimeoutSeconds);
+
+    const std::string url = UploadURL(index, parameters);
+    http_transport->SetURL(url);
+
+    const uint64_t start_time = ClockMonotonicNanoseconds();
+    if (http_transport->ExecuteSynchronously(response_body)) {
+      const uint64_t duration = ClockMonotonicNanoseconds() - start_time;
+      {
+        base::AutoLock lock(lock_);
+        endpoints_.RecordSuccess(index, duration);
+      }
+      adaptive_gzip_.RecordUpload(body_measurements, duration);
+      Metrics::CrashUploadCompression(
+          gzip_enabled,
+          gzip_compression_level,
+          report_size > 0 ? base::saturated_cast<int>(
+                                body_measurements.bytes * 100 /
+                                static_cast<uint64_t>(report_size))
+                          : 100);
+      return UploadResult::kSuccess;
+    }
 
-  std::string url = url_;
+    {
+      base::AutoLock lock(lock_);
+      endpoints_.RecordFailure(index, ClockMonotonicNanoseconds());
+    }
+    LOG(WARNING) << "upload to endpoint " << index << " failed";
+
+    // Respect Stop() being called while an upload attempt was in progress.
+    if (!thread_.is_running()) {
+      break;
+    }
+  }
+
+  return UploadResult::kRetry;
+}
+
+std::string CrashReportUploadThread::UploadURL(
+    size_t index,
+    const std::map<std::string, std::string>& parameters) const {
+  std::string url = endpoints_.url(index);
   if (options_.identify_client_via_url) {
     // Add parameters to the URL which identify the client to the server.
     static constexpr struct {
@@ -415,13 +950,7 @@ CrashReportUploadThread::UploadResult CrashReportUploadThread::UploadReport(
       }
     }
   }
-  http_transport->SetURL(url);
-
-  if (!http_transport->ExecuteSynchronously(response_body)) {
-    return UploadResult::kRetry;
-  }
-
-  return UploadResult::kSuccess;
+  return url;
 }
 
 void CrashReportUploadThread::DoWork(const WorkerThread* thread) {
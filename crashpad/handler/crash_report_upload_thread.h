@@ -15,17 +15,32 @@
 #ifndef CRASHPAD_HANDLER_CRASH_REPORT_UPLOAD_THREAD_H_
 #define CRASHPAD_HANDLER_CRASH_REPORT_UPLOAD_THREAD_H_
 
+#include <stdint.h>
+
+#include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
+#include "base/files/file_path.h"
 #include "base/macros.h"
+#include "base/synchronization/lock.h"
 #include "client/crash_report_database.h"
+#include "handler/upload_queue.h"
+#include "util/file/file_writer.h"
 #include "util/misc/uuid.h"
+#include "util/net/adaptive_gzip.h"
+#include "util/net/http_body_tee_file_writer.h"
+#include "util/net/http_endpoint_selector.h"
+#include "util/net/http_transport.h"
 #include "util/stdlib/thread_safe_vector.h"
+#include "util/thread/thread.h"
 #include "util/thread/worker_thread.h"
 
 namespace crashpad {
 
+class ProcessSnapshot;
+
 //! \brief A thread that processes pending crash reports in a
 //!     CrashReportDatabase by uploading them or marking them as completed
 //!     without upload, as desired.
@@ -43,6 +58,11 @@ class CrashReportUploadThread : public WorkerThread::Delegate {
  public:
    //! \brief Options to be passed to the CrashReportUploadThread constructor.
    struct Options {
+    //! Whether each report should begin uploading while it is still being
+    //! written, rather than after it has been written in full. See
+    //! StartEarlyUpload().
+    bool early_upload;
+
     //! Whether client identifying parameters like product name or version
     //! should be added to the URL.
     bool identify_client_via_url;
@@ -53,6 +73,17 @@ class CrashReportUploadThread : public WorkerThread::Delegate {
     //! Whether uploads should use `gzip` compression.
     bool upload_gzip;
 
+    //! Whether the `gzip` compression level, or whether to compress at all,
+    //! should be chosen for each upload based on the measured network
+    //! throughput and the compressibility of the report. Only meaningful when
+    //! #upload_gzip is `true`.
+    bool upload_gzip_adaptive;
+
+    //! Whether each report should first be uploaded as a light minidump,
+    //! without the contents of memory, with the full minidump uploaded only if
+    //! the server asks for it. See UploadReport().
+    bool upload_light_first;
+
     //! Whether to periodically check for new pending reports not already known
     //! to exist. When `false`, only an initial upload attempt will be made for
     //! reports known to exist by having been added by the ReportPending()
@@ -60,13 +91,76 @@ class CrashReportUploadThread : public WorkerThread::Delegate {
     bool watch_pending_reports;
   };
 
+  //! \brief An upload of a crash report that takes place while the report is
+  //!     being written.
+  //!
+  //! Objects of this class are obtained from StartEarlyUpload(). The report is
+  //! written to file_writer(), and the upload continues on its own thread.
+  class EarlyUpload final : public Thread {
+   public:
+    ~EarlyUpload() override;
+
+    //! \brief Returns the writer that the report must be written to, from
+    //!     beginning to end, without seeking.
+    //!
+    //! Everything written is passed to the file writer given to
+    //! StartEarlyUpload(), and also uploaded.
+    FileWriterInterface* file_writer() { return &tee_file_writer_; }
+
+    //! \brief Signals that the report has been written.
+    //!
+    //! \param[in] success `true` if the report was written in full. If
+    //!     `false`, the upload is aborted.
+    void Finish(bool success) { tee_file_writer_.Finish(success); }
+
+   private:
+    friend class CrashReportUploadThread;
+
+    EarlyUpload(CrashReportUploadThread* upload_thread,
+                const UUID& report_uuid,
+                size_t endpoint_index,
+                FileWriterInterface* report_file_writer);
+
+    //! \brief Waits for the upload to complete.
+    //!
+    //! \param[out] response_body The response body sent by the server, if the
+    //!     upload was successful.
+    //! \param[out] duration_ns The time that the upload spent sending the
+    //!     report and receiving the response, in nanoseconds, if the upload
+    //!     was successful. Time spent waiting for the report to be written is
+    //!     excluded.
+    //!
+    //! \return `true` if the report was uploaded in full, `false` otherwise.
+    bool WaitForCompletion(std::string* response_body, uint64_t* duration_ns);
+
+    // Thread:
+    void ThreadMain() override;
+
+    CrashReportUploadThread* upload_thread_;  // weak
+    UUID report_uuid_;
+    size_t endpoint_index_;
+    HTTPBodyTeeFileWriter tee_file_writer_;
+    std::unique_ptr<HTTPTransport> http_transport_;
+    std::string response_body_;
+    uint64_t duration_ns_;
+    bool started_;
+    bool joined_;
+    bool success_;
+    bool endpoint_failed_;
+
+    DISALLOW_COPY_AND_ASSIGN(EarlyUpload);
+  };
+
   //! \brief Constructs a new object.
   //!
   //! \param[in] database The database to upload crash reports from.
-  //! \param[in] url The URL of the server to upload crash reports to.
+  //! \param[in] urls The URLs of equivalent servers to upload crash reports
+  //!     to. Each upload is sent to the server that has recently been the
+  //!     fastest and most reliable, and is retried with the others if it
+  //!     fails. If this is empty, no uploads will be attempted.
   //! \param[in] options Options for the report uploads.
   CrashReportUploadThread(CrashReportDatabase* database,
-                          const std::string& url,
+                          const std::vector<std::string>& urls,
                           const Options& options);
   ~CrashReportUploadThread();
 
@@ -99,7 +193,55 @@ class CrashReportUploadThread : public WorkerThread::Delegate {
   //! This method may be called from any thread.
   void ReportPending(const UUID& report_uuid);
 
+  //! \brief Informs the upload thread that a new pending report has been added
+  //!     to the database, and that an upload of it may already have taken
+  //!     place.
+  //!
+  //! The upload thread waits for \a early_upload to complete. If it succeeded,
+  //! the report is recorded as uploaded. Otherwise, the report is processed as
+  //! though ReportPending() had been called without \a early_upload.
+  //!
+  //! \param[in] report_uuid The unique identifier of the newly added pending
+  //!     report.
+  //! \param[in] early_upload The upload begun by StartEarlyUpload() while the
+  //!     report was being written. This may be `nullptr`.
+  //!
+  //! This method may be called from any thread.
+  void ReportPending(const UUID& report_uuid,
+                     std::unique_ptr<EarlyUpload> early_upload);
+
+  //! \brief Begins uploading a report that is about to be written.
+  //!
+  //! This allows the collector to receive the report sooner after a crash,
+  //! because the upload and the writing of the report overlap. The upload is
+  //! sent to the first of the URLs given to the constructor, and is not
+  //! retried. If it fails, or the report is not written in full, the report is
+  //! uploaded in the usual way once it is reported by ReportPending().
+  //!
+  //! If the upload cannot keep up with the writing of the report, it is
+  //! abandoned, so that the report is written without delay.
+  //!
+  //! \param[in] process_snapshot The snapshot from which the report will be
+  //!     written, used to obtain the form parameters for the upload.
+  //! \param[in] new_report The report being written.
+  //! \param[in] report_file_writer The writer for \a new_report’s file.
+  //!
+  //! \return An EarlyUpload whose EarlyUpload::file_writer() the report must be
+  //!     written to, or `nullptr` if Options::early_upload is not set, or if an
+  //!     upload should not take place now. The report must then be written to
+  //!     \a report_file_writer directly.
+  //!
+  //! This method may be called from any thread.
+  std::unique_ptr<EarlyUpload> StartEarlyUpload(
+      const ProcessSnapshot& process_snapshot,
+      const CrashReportDatabase::NewReport& new_report,
+      FileWriterInterface* report_file_writer);
+
  private:
+  //! \brief Collects the fields of pending reports found in the database
+  //!     that EnqueueReport() needs, without reading their minidumps.
+  class PendingReportVisitor;
+
   //! \brief The result code from UploadReport().
   enum class UploadResult {
     //! \brief The crash report was uploaded successfully.
@@ -126,9 +268,59 @@ class CrashReportUploadThread : public WorkerThread::Delegate {
   //! object has been made aware of in ReportPending(). Additionally, if the
   //! object was constructed with \a watch_pending_reports, it will also scan
   //! the crash report database for other pending reports, and process those as
-  //! well.
+  //! well. Early uploads passed to ReportPending() are completed first.
+  //!
+  //! Reports are processed in the order chosen by an UploadQueue, so that
+  //! explicitly requested, high-priority, and recent reports are uploaded
+  //! ahead of a backlog. Reports made known by ReportPending() while others
+  //! are being processed join the queue before the next report is chosen.
   void ProcessPendingReports();
 
+  //! \brief Adds the reports made known by ReportPending() to #upload_queue_,
+  //!     after completing any early uploads.
+  void EnqueueKnownPendingReports();
+
+  //! \brief Adds \a report to #upload_queue_, with a priority taken from its
+  //!     #kUploadPriorityAnnotationKey annotation.
+  //!
+  //! The report’s minidump file is only read the first time that the report is
+  //! enqueued. Its priority and size are then kept in #report_properties_ for
+  //! as long as the report is enqueued again on each pass. Only Report::uuid,
+  //! Report::file_path, Report::creation_time, and
+  //! Report::upload_explicitly_requested are used.
+  void EnqueueReport(const CrashReportDatabase::Report& report);
+
+  //! \brief The properties of a report that are read from its minidump file.
+  struct ReportProperties {
+    //! \brief The value of the #kUploadPriorityAnnotationKey annotation, or
+    //!     `0` if it is absent or invalid.
+    int priority;
+
+    //! \brief The size of the minidump file, in bytes, or `0` if unknown.
+    uint64_t size;
+  };
+
+  //! \brief Reads the properties of \a report from its minidump file.
+  static ReportProperties ReadReportProperties(
+      const CrashReportDatabase::Report& report);
+
+  //! \brief Returns `true` if an EarlyUpload exists for the report identified
+  //!     by \a report_uuid, whether or not it has been completed.
+  bool HasEarlyUpload(const UUID& report_uuid) const;
+
+  //! \brief Waits for \a early_upload to complete, and records its result.
+  //!
+  //! \return `true` if the report was uploaded and has been recorded as such.
+  //!     `false` if the report is still pending.
+  bool CompleteEarlyUpload(EarlyUpload* early_upload);
+
+  //! \brief Returns the URL of the endpoint at \a index, with client
+  //!     identifying parameters taken from \a parameters added if
+  //!     Options::identify_client_via_url is set.
+  std::string UploadURL(
+      size_t index,
+      const std::map<std::string, std::string>& parameters) const;
+
   //! \brief Processes a single pending report from the database.
   //!
   //! \param[in] report The crash report to process.
@@ -145,6 +337,17 @@ class CrashReportUploadThread : public WorkerThread::Delegate {
 
   //! \brief Attempts to upload a crash report.
   //!
+  //! If Options::upload_light_first is set, a light minidump written by
+  //! WriteLightMinidump() is uploaded first, with the form parameter
+  //! `minidump_tier=light`. It is written to a new report in the database that
+  //! is never finished, so it never becomes pending and is always removed. A
+  //! server that wants the full minidump as well responds with the crash ID on
+  //! the first line of the response body, and `full_minidump_requested` on a
+  //! following line. The full minidump is then
+  //! uploaded with the parameters `minidump_tier=full` and `light_crash_id` set
+  //! to that crash ID. Otherwise, only the light minidump is uploaded. If a
+  //! light minidump can’t be written, the full minidump is uploaded directly.
+  //!
   //! \param[in] report The report to upload. The caller is responsible for
   //!     calling CrashReportDatabase::GetReportForUploading() before calling
   //!     this method, and for calling
@@ -158,15 +361,60 @@ class CrashReportUploadThread : public WorkerThread::Delegate {
   UploadResult UploadReport(const CrashReportDatabase::Report* report,
                             std::string* response_body);
 
+  //! \brief Uploads the minidump file at \a minidump_path for \a report.
+  //!
+  //! The upload is attempted with each server chosen by #endpoints_ in turn,
+  //! until one succeeds. The outcome of each attempt is recorded in
+  //! #endpoints_.
+  //!
+  //! \param[in] report The report being uploaded.
+  //! \param[in] minidump_path The minidump file to upload, which is either
+  //!     \a report’s file or a light minidump derived from it.
+  //! \param[in] extra_parameters Form parameters to send in addition to those
+  //!     derived from the minidump file.
+  //! \param[out] response_body The response body sent by the server, if the
+  //!     upload is successful.
+  //!
+  //! \return A member of UploadResult indicating the result of the upload
+  //!    attempt.
+  UploadResult UploadMinidump(
+      const CrashReportDatabase::Report* report,
+      const base::FilePath& minidump_path,
+      const std::map<std::string, std::string>& extra_parameters,
+      std::string* response_body);
+
   // WorkerThread::Delegate:
   //! \brief Calls ProcessPendingReports() in response to ReportPending() having
   //!     been called on any thread, as well as periodically on a timer.
   void DoWork(const WorkerThread* thread) override;
 
   const Options options_;
-  const std::string url_;
+
+  // The following members are protected by lock_, because early uploads are
+  // started on the thread writing the report. The URLs of endpoints_ never
+  // change, so its size() and url() may be used without holding lock_.
+  mutable base::Lock lock_;
+  HTTPEndpointSelector endpoints_;
+
+  // The reports with an EarlyUpload in existence. These are left out of the
+  // scan for pending reports until their early upload has been completed.
+  // There are rarely more than a few. These members are declared before
+  // early_uploads_ so that they outlive the objects that it holds.
+  std::vector<UUID> early_upload_report_uuids_;
+
+  // The properties of the reports enqueued during the current and previous
+  // passes through ProcessPendingReports(). Properties that are not used
+  // during one pass are discarded at the start of the next, so that only those
+  // of reports that are still pending are kept. Only used on the upload
+  // thread.
+  std::map<UUID, ReportProperties> report_properties_;
+  std::map<UUID, ReportProperties> previous_report_properties_;
+
+  AdaptiveGzip adaptive_gzip_;  // Only used on the upload thread.
   WorkerThread thread_;
+  UploadQueue upload_queue_;  // Only used on the upload thread.
   ThreadSafeVector<UUID> known_pending_report_uuids_;
+  ThreadSafeVector<std::unique_ptr<EarlyUpload>> early_uploads_;
   CrashReportDatabase* database_;  // weak
 
   DISALLOW_COPY_AND_ASSIGN(CrashReportUploadThread);
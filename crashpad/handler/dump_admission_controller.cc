@@ -0,0 +1,204 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "handler/dump_admission_controller.h"
+
+#include "base/logging.h"
+#include "util/misc/clock.h"
+#include "util/synchronization/semaphore.h"
+
+namespace crashpad {
+
+namespace {
+
+// Once this many executables are being tracked, those whose most recent
+// request is outside the repeat window are forgotten.
+constexpr size_t kMaxTrackedExecutables = 1024;
+
+}  // namespace
+
+struct DumpAdmissionController::Waiter {
+  enum State {
+    kStateQueued,
+    kStateAdmitted,
+    kStateDisplaced,
+  };
+
+  Waiter(uint64_t bytes, bool high_priority)
+      : semaphore(0),
+        bytes(bytes),
+        high_priority(high_priority),
+        state(kStateQueued) {}
+
+  Semaphore semaphore;
+  uint64_t bytes;
+  bool high_priority;
+  State state;
+};
+
+DumpAdmissionController::Options::Options()
+    : max_concurrent_dumps(2),
+      max_concurrent_bytes(512 * 1024 * 1024),
+      max_queued_requests(64),
+      repeat_window_nanoseconds(10 * 60 * 1000000000ull) {}
+
+DumpAdmissionController::Admission::Admission(
+    DumpAdmissionController* controller,
+    uint64_t bytes,
+    bool reduced_capture)
+    : controller_(controller),
+      bytes_(bytes),
+      reduced_capture_(reduced_capture) {}
+
+DumpAdmissionController::Admission::~Admission() {
+  controller_->Release(bytes_);
+}
+
+DumpAdmissionController::DumpAdmissionController(const Options& options)
+    : options_(options),
+      queue_(),
+      last_request_times_(),
+      active_dumps_(0),
+      active_bytes_(0),
+      lock_() {
+  DCHECK_GE(options_.max_concurrent_dumps, 1u);
+}
+
+DumpAdmissionController::~DumpAdmissionController() {
+  DCHECK(queue_.empty());
+  DCHECK_EQ(active_dumps_, 0u);
+}
+
+std::unique_ptr<DumpAdmissionController::Admission>
+DumpAdmissionController::Admit(const std::string& executable,
+                               uint64_t full_capture_bytes,
+                               uint64_t reduced_capture_bytes) {
+  const uint64_t now = ClockMonotonicNanoseconds();
+
+  bool reduced_capture;
+  uint64_t bytes;
+
+  // The waiter is linked into queue_ while this thread blocks, and is removed
+  // from it by whichever thread signals it.
+  std::unique_ptr<Waiter> waiter;
+  {
+    base::AutoLock lock_owner(lock_);
+
+    if (last_request_times_.size() >= kMaxTrackedExecutables) {
+      for (auto it = last_request_times_.begin();
+           it != last_request_times_.end();) {
+        if (now - it->second >= options_.repeat_window_nanoseconds) {
+          it = last_request_times_.erase(it);
+        } else {
+          ++it;
+        }
+      }
+    }
+
+    bool high_priority;
+    auto last_request_time = last_request_times_.find(executable);
+    if (last_request_time == last_request_times_.end()) {
+      high_priority = true;
+      last_request_times_[executable] = now;
+    } else {
+      high_priority =
+          now - last_request_time->second >= options_.repeat_window_nanoseconds;
+      if (high_priority) {
+        last_request_time->second = now;
+      }
+    }
+
+    reduced_capture = !high_priority;
+    bytes = reduced_capture ? reduced_capture_bytes : full_capture_bytes;
+
+    if (queue_.empty() && CanStart(bytes)) {
+      ++active_dumps_;
+      active_bytes_ += bytes;
+      return std::unique_ptr<Admission>(
+          new Admission(this, bytes, reduced_capture));
+    }
+
+    if (queue_.size() >= options_.max_queued_requests) {
+      if (!high_priority || queue_.empty() || queue_.back()->high_priority) {
+        LOG(WARNING) << "rejecting dump request from " << executable
+                     << ", queue full";
+        return nullptr;
+      }
+
+      Waiter* displaced = queue_.back();
+      queue_.pop_back();
+      displaced->state = Waiter::kStateDisplaced;
+      displaced->semaphore.Signal();
+    }
+
+    waiter.reset(new Waiter(bytes, high_priority));
+    auto position = queue_.end();
+    if (high_priority) {
+      position = queue_.begin();
+      while (position != queue_.end() && (*position)->high_priority) {
+        ++position;
+      }
+    }
+    queue_.insert(position, waiter.get());
+  }
+
+  waiter->semaphore.Wait();
+
+  if (waiter->state != Waiter::kStateAdmitted) {
+    DCHECK_EQ(waiter->state, Waiter::kStateDisplaced);
+    LOG(WARNING) << "dropping dump request from " << executable
+                 << ", displaced by higher priority request";
+    return nullptr;
+  }
+
+  return std::unique_ptr<Admission>(
+      new Admission(this, bytes, reduced_capture));
+}
+
+size_t DumpAdmissionController::QueuedRequests() {
+  base::AutoLock lock_owner(lock_);
+  return queue_.size();
+}
+
+bool DumpAdmissionController::CanStart(uint64_t bytes) const {
+  if (active_dumps_ == 0) {
+    return true;
+  }
+  return active_dumps_ < options_.max_concurrent_dumps &&
+         active_bytes_ <= options_.max_concurrent_bytes &&
+         bytes <= options_.max_concurrent_bytes - active_bytes_;
+}
+
+void DumpAdmissionController::AdmitWaiters() {
+  while (!queue_.empty() && CanStart(queue_.front()->bytes)) {
+    Waiter* waiter = queue_.front();
+    queue_.pop_front();
+    ++active_dumps_;
+    active_bytes_ += waiter->bytes;
+    waiter->state = Waiter::kStateAdmitted;
+    waiter->semaphore.Signal();
+  }
+}
+
+void DumpAdmissionController::Release(uint64_t bytes) {
+  base::AutoLock lock_owner(lock_);
+
+  DCHECK_GT(active_dumps_, 0u);
+  DCHECK_GE(active_bytes_, bytes);
+  --active_dumps_;
+  active_bytes_ -= bytes;
+  AdmitWaiters();
+}
+
+}  // namespace crashpad
@@ -0,0 +1,145 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_HANDLER_DUMP_ADMISSION_CONTROLLER_H_
+#define CRASHPAD_HANDLER_DUMP_ADMISSION_CONTROLLER_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "base/macros.h"
+#include "base/synchronization/lock.h"
+
+namespace crashpad {
+
+//! \brief Limits the number of minidump files that a handler writes at once.
+//!
+//! When many clients crash at the same time, writing a full minidump file for
+//! each of them concurrently can exhaust the handler’s memory, the disk’s
+//! bandwidth, and the system’s process limits. A handler calls Admit() before
+//! writing each minidump file, and writes it only once admitted.
+//!
+//! Requests are admitted while both the number of dumps in progress and the
+//! estimated number of bytes they will write are within limits. Other requests
+//! wait in a bounded queue. The first request from an executable within
+//! Options::repeat_window_nanoseconds has high priority and is admitted for a
+//! full capture. Repeated requests from the same executable have low priority
+//! and are admitted for a reduced capture, as in
+//! MinidumpFileWriter::SetReducedCapture(). High-priority requests are admitted
+//! ahead of low-priority ones, and in arrival order otherwise. When the queue
+//! is full, a high-priority request displaces the most recent low-priority
+//! one, and any other request is rejected.
+//!
+//! This class is thread-safe.
+class DumpAdmissionController {
+ public:
+  //! \brief Limits that a DumpAdmissionController enforces.
+  struct Options {
+    Options();
+
+    //! \brief The maximum number of dumps in progress at once. Must be at
+    //!     least 1.
+    size_t max_concurrent_dumps;
+
+    //! \brief The maximum total estimated size of the dumps in progress.
+    //!
+    //! A single dump that exceeds this is still admitted when no other dump is
+    //! in progress.
+    uint64_t max_concurrent_bytes;
+
+    //! \brief The maximum number of requests waiting to be admitted.
+    size_t max_queued_requests;
+
+    //! \brief The time after a request from an executable during which further
+    //!     requests from that executable are considered repeats.
+    uint64_t repeat_window_nanoseconds;
+  };
+
+  //! \brief Permission to write one minidump file.
+  //!
+  //! Destroying this object releases the limits it holds, allowing waiting
+  //! requests to be admitted.
+  class Admission {
+   public:
+    ~Admission();
+
+    //! \brief Whether the minidump file should be a reduced capture.
+    bool reduced_capture() const { return reduced_capture_; }
+
+   private:
+    friend class DumpAdmissionController;
+
+    Admission(DumpAdmissionController* controller,
+              uint64_t bytes,
+              bool reduced_capture);
+
+    DumpAdmissionController* controller_;  // weak
+    uint64_t bytes_;
+    bool reduced_capture_;
+
+    DISALLOW_COPY_AND_ASSIGN(Admission);
+  };
+
+  explicit DumpAdmissionController(const Options& options);
+  ~DumpAdmissionController();
+
+  //! \brief Waits until a minidump file may be written.
+  //!
+  //! \param[in] executable A name identifying the crashing program, such as
+  //!     the path to its executable, used to recognize repeated requests.
+  //! \param[in] full_capture_bytes The estimated size of a full capture.
+  //! \param[in] reduced_capture_bytes The estimated size of a reduced capture.
+  //!
+  //! \return An Admission, which must be kept until the minidump file has been
+  //!     written, and which must not outlive this object. `nullptr` if the
+  //!     request was rejected or displaced because the queue was full, with a
+  //!     message logged.
+  std::unique_ptr<Admission> Admit(const std::string& executable,
+                                   uint64_t full_capture_bytes,
+                                   uint64_t reduced_capture_bytes);
+
+  //! \brief Returns the number of requests waiting to be admitted.
+  size_t QueuedRequests();
+
+ private:
+  struct Waiter;
+
+  // Returns whether a dump of |bytes| can start now. lock_ must be held.
+  bool CanStart(uint64_t bytes) const;
+
+  // Admits waiters from the front of queue_ for as long as limits permit.
+  // lock_ must be held.
+  void AdmitWaiters();
+
+  // Releases the limits held by an Admission for a dump of |bytes|.
+  void Release(uint64_t bytes);
+
+  Options options_;
+  std::list<Waiter*> queue_;  // weak
+  std::map<std::string, uint64_t> last_request_times_;
+  size_t active_dumps_;
+  uint64_t active_bytes_;
+  base::Lock lock_;
+
+  DISALLOW_COPY_AND_ASSIGN(DumpAdmissionController);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_HANDLER_DUMP_ADMISSION_CONTROLLER_H_
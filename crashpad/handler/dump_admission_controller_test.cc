@@ -0,0 +1,222 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "handler/dump_admission_controller.h"
+
+#include <memory>
+#include <string>
+
+#include "base/macros.h"
+#include "gtest/gtest.h"
+#include "util/misc/clock.h"
+#include "util/thread/thread.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+constexpr uint64_t kFullBytes = 100;
+constexpr uint64_t kReducedBytes = 10;
+
+// Calls DumpAdmissionController::Admit() on a separate thread, and holds the
+// admission until Finish() is called.
+class AdmitThread : public Thread {
+ public:
+  AdmitThread(DumpAdmissionController* controller,
+              const std::string& executable)
+      : Thread(),
+        controller_(controller),
+        executable_(executable),
+        admission_(),
+        admitted_(false),
+        reduced_capture_(false) {}
+  ~AdmitThread() override {}
+
+  void Finish() {
+    Join();
+    admission_.reset();
+  }
+
+  bool admitted() const { return admitted_; }
+
+  bool reduced_capture() const { return reduced_capture_; }
+
+ private:
+  void ThreadMain() override {
+    admission_ = controller_->Admit(executable_, kFullBytes, kReducedBytes);
+    admitted_ = admission_ != nullptr;
+    reduced_capture_ = admitted_ && admission_->reduced_capture();
+  }
+
+  DumpAdmissionController* controller_;  // weak
+  std::string executable_;
+  std::unique_ptr<DumpAdmissionController::Admission> admission_;
+  bool admitted_;
+  bool reduced_capture_;
+
+  DISALLOW_COPY_AND_ASSIGN(AdmitThread);
+};
+
+// Waits for |controller| to have |count| requests queued.
+void WaitForQueuedRequests(DumpAdmissionController* controller, size_t count) {
+  while (controller->QueuedRequests() != count) {
+    SleepNanoseconds(1E6);
+  }
+}
+
+TEST(DumpAdmissionController, RepeatsAreReduced) {
+  DumpAdmissionController::Options options;
+  options.max_concurrent_dumps = 8;
+  DumpAdmissionController controller(options);
+
+  auto first = controller.Admit("a", kFullBytes, kReducedBytes);
+  ASSERT_TRUE(first);
+  EXPECT_FALSE(first->reduced_capture());
+
+  auto repeat = controller.Admit("a", kFullBytes, kReducedBytes);
+  ASSERT_TRUE(repeat);
+  EXPECT_TRUE(repeat->reduced_capture());
+
+  auto other = controller.Admit("b", kFullBytes, kReducedBytes);
+  ASSERT_TRUE(other);
+  EXPECT_FALSE(other->reduced_capture());
+}
+
+TEST(DumpAdmissionController, RepeatWindow) {
+  DumpAdmissionController::Options options;
+  options.max_concurrent_dumps = 8;
+  options.repeat_window_nanoseconds = 0;
+  DumpAdmissionController controller(options);
+
+  auto first = controller.Admit("a", kFullBytes, kReducedBytes);
+  ASSERT_TRUE(first);
+  EXPECT_FALSE(first->reduced_capture());
+
+  auto second = controller.Admit("a", kFullBytes, kReducedBytes);
+  ASSERT_TRUE(second);
+  EXPECT_FALSE(second->reduced_capture());
+}
+
+TEST(DumpAdmissionController, ConcurrentDumps) {
+  DumpAdmissionController::Options options;
+  options.max_concurrent_dumps = 1;
+  DumpAdmissionController controller(options);
+
+  auto first = controller.Admit("a", kFullBytes, kReducedBytes);
+  ASSERT_TRUE(first);
+
+  AdmitThread thread(&controller, "b");
+  thread.Start();
+  WaitForQueuedRequests(&controller, 1);
+  EXPECT_FALSE(thread.admitted());
+
+  first.reset();
+  thread.Finish();
+  EXPECT_TRUE(thread.admitted());
+  EXPECT_EQ(controller.QueuedRequests(), 0u);
+}
+
+TEST(DumpAdmissionController, ConcurrentBytes) {
+  DumpAdmissionController::Options options;
+  options.max_concurrent_dumps = 8;
+  options.max_concurrent_bytes = kFullBytes + kReducedBytes;
+  DumpAdmissionController controller(options);
+
+  // A dump larger than the limit is still admitted when nothing else is in
+  // progress.
+  auto large = controller.Admit("a", kFullBytes * 2, kReducedBytes);
+  ASSERT_TRUE(large);
+
+  AdmitThread thread(&controller, "b");
+  thread.Start();
+  WaitForQueuedRequests(&controller, 1);
+
+  large.reset();
+  thread.Finish();
+  EXPECT_TRUE(thread.admitted());
+
+  // A full dump and a reduced dump fit together.
+  auto full = controller.Admit("c", kFullBytes, kReducedBytes);
+  ASSERT_TRUE(full);
+  auto reduced = controller.Admit("c", kFullBytes, kReducedBytes);
+  ASSERT_TRUE(reduced);
+  EXPECT_TRUE(reduced->reduced_capture());
+}
+
+TEST(DumpAdmissionController, Priority) {
+  DumpAdmissionController::Options options;
+  options.max_concurrent_dumps = 1;
+  DumpAdmissionController controller(options);
+
+  auto active = controller.Admit("a", kFullBytes, kReducedBytes);
+  ASSERT_TRUE(active);
+
+  // A repeat from “a” is queued before the first request from “b”, but “b” is
+  // admitted first.
+  AdmitThread repeat(&controller, "a");
+  repeat.Start();
+  WaitForQueuedRequests(&controller, 1);
+
+  AdmitThread first(&controller, "b");
+  first.Start();
+  WaitForQueuedRequests(&controller, 2);
+
+  active.reset();
+  WaitForQueuedRequests(&controller, 1);
+  EXPECT_FALSE(repeat.admitted());
+
+  first.Finish();
+  EXPECT_TRUE(first.admitted());
+  EXPECT_FALSE(first.reduced_capture());
+
+  repeat.Finish();
+  EXPECT_TRUE(repeat.admitted());
+  EXPECT_TRUE(repeat.reduced_capture());
+}
+
+TEST(DumpAdmissionController, QueueFull) {
+  DumpAdmissionController::Options options;
+  options.max_concurrent_dumps = 1;
+  options.max_queued_requests = 1;
+  DumpAdmissionController controller(options);
+
+  auto active = controller.Admit("a", kFullBytes, kReducedBytes);
+  ASSERT_TRUE(active);
+
+  AdmitThread repeat(&controller, "a");
+  repeat.Start();
+  WaitForQueuedRequests(&controller, 1);
+
+  // Another repeat is rejected outright.
+  EXPECT_FALSE(controller.Admit("a", kFullBytes, kReducedBytes));
+
+  // A first request displaces the queued repeat.
+  AdmitThread first(&controller, "b");
+  first.Start();
+  repeat.Finish();
+  EXPECT_FALSE(repeat.admitted());
+  WaitForQueuedRequests(&controller, 1);
+
+  // Another first request is rejected, because nothing of lower priority is
+  // queued.
+  EXPECT_FALSE(controller.Admit("c", kFullBytes, kReducedBytes));
+
+  active.reset();
+  first.Finish();
+  EXPECT_TRUE(first.admitted());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
@@ -37,8 +37,14 @@
       'sources': [
         'crash_report_upload_thread.cc',
         'crash_report_upload_thread.h',
+        'dump_admission_controller.cc',
+        'dump_admission_controller.h',
         'handler_main.cc',
         'handler_main.h',
+        'linux/capture_budget.cc',
+        'linux/capture_budget.h',
+        'linux/multi_process_capture.cc',
+        'linux/multi_process_capture.h',
         'mac/crash_report_exception_handler.cc',
         'mac/crash_report_exception_handler.h',
         'mac/exception_handler_server.cc',
@@ -47,6 +53,8 @@
         'mac/file_limit_annotation.h',
         'prune_crash_reports_thread.cc',
         'prune_crash_reports_thread.h',
+        'upload_queue.cc',
+        'upload_queue.h',
         'user_stream_data_source.cc',
         'user_stream_data_source.h',
         'win/crash_report_exception_handler.cc',
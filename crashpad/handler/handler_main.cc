@@ -85,8 +85,11 @@ void Usage(const base::FilePath& me) {
 "Usage: %" PRFilePath " [OPTION]...\n"
 "Crashpad's exception handler server.\n"
 "\n"
+"      --adaptive-upload-gzip  choose the gzip compression level for each upload\n"
+"                              to minimize upload time\n"
 "      --annotation=KEY=VALUE  set a process annotation in each crash report\n"
 "      --database=PATH         store the crash report database at PATH\n"
+"      --early-upload          begin uploading each report while writing it\n"
 #if defined(OS_MACOSX)
 "      --handshake-fd=FD       establish communication with the client over FD\n"
 #endif  // OS_MACOSX
@@ -123,8 +126,11 @@ void Usage(const base::FilePath& me) {
 "      --reset-own-crash-exception-port-to-system-default\n"
 "                              reset the server's exception handler to default\n"
 #endif  // OS_MACOSX
+"      --upload-light-first    upload each report without memory first, and\n"
+"                              upload it in full only if the server asks\n"
 "      --url=URL               send crash reports to this Breakpad server URL,\n"
-"                              only if uploads are enabled for the database\n"
+"                              only if uploads are enabled for the database;\n"
+"                              may be repeated to name fallback servers\n"
 "      --help                  display this help and exit\n"
 "      --version               output version information and exit\n",
           me.value().c_str());
@@ -134,7 +140,7 @@ void Usage(const base::FilePath& me) {
 struct Options {
   std::map<std::string, std::string> annotations;
   std::map<std::string, std::string> monitor_self_annotations;
-  std::string url;
+  std::vector<std::string> urls;
   base::FilePath database;
   base::FilePath metrics_dir;
   std::vector<std::string> monitor_self_arguments;
@@ -146,11 +152,14 @@ struct Options {
   std::string pipe_name;
   InitialClientData initial_client_data;
 #endif  // OS_MACOSX
+  bool adaptive_upload_gzip;
+  bool early_upload;
   bool identify_client_via_url;
   bool monitor_self;
   bool periodic_tasks;
   bool rate_limit;
   bool upload_gzip;
+  bool upload_light_first;
 };
 
 // Splits |key_value| on '=' and inserts the resulting key and value into |map|.
@@ -360,6 +369,10 @@ void MonitorSelf(const Options& options) {
     return;
   }
   std::vector<std::string> extra_arguments(options.monitor_self_arguments);
+  for (size_t index = 1; index < options.urls.size(); ++index) {
+    extra_arguments.push_back(
+        base::StringPrintf("--url=%s", options.urls[index].c_str()));
+  }
   if (!options.identify_client_via_url) {
     extra_arguments.push_back("--no-identify-client-via-url");
   }
@@ -370,6 +383,15 @@ void MonitorSelf(const Options& options) {
   if (!options.upload_gzip) {
     extra_arguments.push_back("--no-upload-gzip");
   }
+  if (options.adaptive_upload_gzip) {
+    extra_arguments.push_back("--adaptive-upload-gzip");
+  }
+  if (options.upload_light_first) {
+    extra_arguments.push_back("--upload-light-first");
+  }
+  if (options.early_upload) {
+    extra_arguments.push_back("--early-upload");
+  }
   for (const auto& iterator : options.monitor_self_annotations) {
     extra_arguments.push_back(
         base::StringPrintf("--monitor-self-annotation=%s=%s",
@@ -384,7 +406,8 @@ void MonitorSelf(const Options& options) {
   if (!crashpad_client.StartHandler(executable_path,
                                     options.database,
                                     base::FilePath(),
-                                    options.url,
+                                    options.urls.empty() ? std::string()
+                                                         : options.urls[0],
                                     options.annotations,
                                     extra_arguments,
                                     true,
@@ -412,8 +435,10 @@ int HandlerMain(int argc,
   enum OptionFlags {
     // Long options without short equivalents.
     kOptionLastChar = 255,
+    kOptionAdaptiveUploadGzip,
     kOptionAnnotation,
     kOptionDatabase,
+    kOptionEarlyUpload,
 #if defined(OS_MACOSX)
     kOptionHandshakeFD,
 #endif  // OS_MACOSX
@@ -437,6 +462,7 @@ int HandlerMain(int argc,
 #if defined(OS_MACOSX)
     kOptionResetOwnCrashExceptionPortToSystemDefault,
 #endif  // OS_MACOSX
+    kOptionUploadLightFirst,
     kOptionURL,
 
     // Standard options.
@@ -445,8 +471,10 @@ int HandlerMain(int argc,
   };
 
   static constexpr option long_options[] = {
+    {"adaptive-upload-gzip", no_argument, nullptr, kOptionAdaptiveUploadGzip},
     {"annotation", required_argument, nullptr, kOptionAnnotation},
     {"database", required_argument, nullptr, kOptionDatabase},
+    {"early-upload", no_argument, nullptr, kOptionEarlyUpload},
 #if defined(OS_MACOSX)
     {"handshake-fd", required_argument, nullptr, kOptionHandshakeFD},
 #endif  // OS_MACOSX
@@ -485,6 +513,7 @@ int HandlerMain(int argc,
      nullptr,
      kOptionResetOwnCrashExceptionPortToSystemDefault},
 #endif  // OS_MACOSX
+    {"upload-light-first", no_argument, nullptr, kOptionUploadLightFirst},
     {"url", required_argument, nullptr, kOptionURL},
     {"help", no_argument, nullptr, kOptionHelp},
     {"version", no_argument, nullptr, kOptionVersion},
@@ -503,6 +532,10 @@ int HandlerMain(int argc,
   int opt;
   while ((opt = getopt_long(argc, argv, "", long_options, nullptr)) != -1) {
     switch (opt) {
+      case kOptionAdaptiveUploadGzip: {
+        options.adaptive_upload_gzip = true;
+        break;
+      }
       case kOptionAnnotation: {
         if (!AddKeyValueToMap(&options.annotations, optarg, "--annotation")) {
           return ExitFailure();
@@ -514,6 +547,10 @@ int HandlerMain(int argc,
             ToolSupport::CommandLineArgumentToFilePathStringType(optarg));
         break;
       }
+      case kOptionEarlyUpload: {
+        options.early_upload = true;
+        break;
+      }
 #if defined(OS_MACOSX)
       case kOptionHandshakeFD: {
         if (!StringToNumber(optarg, &options.handshake_fd) ||
@@ -588,8 +625,16 @@ int HandlerMain(int argc,
         break;
       }
 #endif  // OS_MACOSX
+      case kOptionUploadLightFirst: {
+        options.upload_light_first = true;
+        break;
+      }
       case kOptionURL: {
-        options.url = optarg;
+        // An empty --url has always meant that uploads are disabled, so it
+        // does not name an endpoint.
+        if (optarg[0] != '\0') {
+          options.urls.push_back(optarg);
+        }
         break;
       }
       case kOptionHelp: {
@@ -752,13 +797,16 @@ int HandlerMain(int argc,
   // configurable database setting to control upload limiting.
   // See https://crashpad.chromium.org/bug/23.
   CrashReportUploadThread::Options upload_thread_options;
+  upload_thread_options.early_upload = options.early_upload;
   upload_thread_options.identify_client_via_url =
       options.identify_client_via_url;
   upload_thread_options.rate_limit = options.rate_limit;
   upload_thread_options.upload_gzip = options.upload_gzip;
+  upload_thread_options.upload_gzip_adaptive = options.adaptive_upload_gzip;
+  upload_thread_options.upload_light_first = options.upload_light_first;
   upload_thread_options.watch_pending_reports = options.periodic_tasks;
   CrashReportUploadThread upload_thread(database.get(),
-                                        options.url,
+                                        options.urls,
                                         upload_thread_options);
   upload_thread.Start();
 
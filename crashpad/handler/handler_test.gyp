@@ -17,6 +17,39 @@
     '../build/crashpad.gypi',
   ],
   'targets': [
+    {
+      'target_name': 'crashpad_handler_test',
+      'type': 'executable',
+      'dependencies': [
+        'crashpad_handler_test_extended_handler',
+        'handler.gyp:crashpad_handler_lib',
+        '../client/client.gyp:crashpad_client',
+        '../compat/compat.gyp:crashpad_compat',
+        '../test/test.gyp:crashpad_gtest_main',
+        '../test/test.gyp:crashpad_test',
+        '../third_party/gtest/gtest.gyp:gtest',
+        '../third_party/mini_chromium/mini_chromium.gyp:base',
+        '../util/util.gyp:crashpad_util',
+      ],
+      'include_dirs': [
+        '..',
+      ],
+      'sources': [
+        'crashpad_handler_test.cc',
+        'dump_admission_controller_test.cc',
+        'linux/capture_budget_test.cc',
+        'linux/multi_process_capture_test.cc',
+        'upload_queue_test.cc',
+      ],
+      'conditions': [
+        ['OS!="win"', {
+          'sources!': [
+            # The handler itself is only tested on Windows for now.
+            'crashpad_handler_test.cc',
+          ],
+        }],
+      ],
+    },
     {
       'target_name': 'crashpad_handler_test_extended_handler',
       'type': 'executable',
@@ -52,28 +85,6 @@
             'win/crash_other_program.cc',
           ],
         },
-        {
-          # The handler is only tested on Windows for now.
-          'target_name': 'crashpad_handler_test',
-          'type': 'executable',
-          'dependencies': [
-            'crashpad_handler_test_extended_handler',
-            'handler.gyp:crashpad_handler_lib',
-            '../client/client.gyp:crashpad_client',
-            '../compat/compat.gyp:crashpad_compat',
-            '../test/test.gyp:crashpad_gtest_main',
-            '../test/test.gyp:crashpad_test',
-            '../third_party/gtest/gtest.gyp:gtest',
-            '../third_party/mini_chromium/mini_chromium.gyp:base',
-            '../util/util.gyp:crashpad_util',
-          ],
-          'include_dirs': [
-            '..',
-          ],
-          'sources': [
-            'crashpad_handler_test.cc',
-          ],
-        },
         {
           'target_name': 'crashy_program',
           'type': 'executable',
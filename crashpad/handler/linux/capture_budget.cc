@@ -0,0 +1,126 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "handler/linux/capture_budget.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "base/logging.h"
+#include "util/linux/io_uring_file_writer.h"
+#include "util/linux/memory_pressure.h"
+
+namespace crashpad {
+
+namespace {
+
+// The smallest write buffer worth using. IoUringFileWriter always queues at
+// least one chunk of this size.
+constexpr size_t kMinimumWriteBufferBytes = 64 * 1024;
+
+// Stall percentages, from /proc/pressure/memory, at which the pressure level
+// rises.
+constexpr double kElevatedSomeAvg10 = 10;
+constexpr double kCriticalFullAvg10 = 10;
+
+}  // namespace
+
+const char kMemoryPressureLevelAnnotationKey[] = "crashpad_memory_pressure";
+
+CaptureBudget::CaptureBudget()
+    : memory_pressure_level(MemoryPressureLevel::kNormal),
+      max_extra_memory_bytes(std::numeric_limits<uint64_t>::max()),
+      write_buffer_bytes(IoUringFileWriter::kDefaultMaxBufferedBytes),
+      reduced_capture(false),
+      admission() {}
+
+MemoryPressureLevel ClassifyMemoryPressure(const MemoryPressure& pressure) {
+  const uint64_t total = pressure.total_bytes;
+  const uint64_t available = pressure.available_bytes;
+  const bool psi = pressure.has_pressure_stall_information;
+
+  if (available < total / 20 ||
+      (psi && pressure.full_avg10 >= kCriticalFullAvg10)) {
+    return MemoryPressureLevel::kCritical;
+  }
+  if (available < total / 5 ||
+      (psi && pressure.some_avg10 >= kElevatedSomeAvg10)) {
+    return MemoryPressureLevel::kElevated;
+  }
+  return MemoryPressureLevel::kNormal;
+}
+
+const char* MemoryPressureLevelName(MemoryPressureLevel level) {
+  switch (level) {
+    case MemoryPressureLevel::kNormal:
+      return "normal";
+    case MemoryPressureLevel::kElevated:
+      return "elevated";
+    case MemoryPressureLevel::kCritical:
+      return "critical";
+  }
+
+  NOTREACHED();
+  return "unknown";
+}
+
+CaptureBudget ScaleCaptureBudget(const CaptureBudget& budget,
+                                 const MemoryPressure& pressure) {
+  CaptureBudget scaled = budget;
+  scaled.memory_pressure_level = ClassifyMemoryPressure(pressure);
+
+  uint64_t available_fraction;
+  switch (scaled.memory_pressure_level) {
+    case MemoryPressureLevel::kNormal:
+      available_fraction = 2;
+      break;
+
+    case MemoryPressureLevel::kElevated:
+      available_fraction = 4;
+      scaled.max_extra_memory_bytes /= 4;
+      scaled.write_buffer_bytes /= 2;
+      scaled.admission.max_concurrent_dumps /= 2;
+      break;
+
+    case MemoryPressureLevel::kCritical:
+      available_fraction = 8;
+      scaled.max_extra_memory_bytes = 0;
+      scaled.write_buffer_bytes = 0;
+      scaled.admission.max_concurrent_dumps = 1;
+      scaled.reduced_capture = true;
+      break;
+
+    default:
+      NOTREACHED();
+      return budget;
+  }
+
+  scaled.write_buffer_bytes =
+      std::max(scaled.write_buffer_bytes, kMinimumWriteBufferBytes);
+  scaled.admission.max_concurrent_dumps =
+      std::max(scaled.admission.max_concurrent_dumps, static_cast<size_t>(1));
+  scaled.admission.max_concurrent_bytes =
+      std::min(scaled.admission.max_concurrent_bytes,
+               pressure.available_bytes / available_fraction);
+  return scaled;
+}
+
+void AddCaptureBudgetAnnotations(
+    const CaptureBudget& budget,
+    std::map<std::string, std::string>* annotations) {
+  (*annotations)[kMemoryPressureLevelAnnotationKey] =
+      MemoryPressureLevelName(budget.memory_pressure_level);
+}
+
+}  // namespace crashpad
@@ -0,0 +1,111 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_HANDLER_LINUX_CAPTURE_BUDGET_H_
+#define CRASHPAD_HANDLER_LINUX_CAPTURE_BUDGET_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <map>
+#include <string>
+
+#include "handler/dump_admission_controller.h"
+
+namespace crashpad {
+
+struct MemoryPressure;
+
+//! \brief How close the system is to running out of memory.
+enum class MemoryPressureLevel {
+  //! \brief Memory is plentiful.
+  kNormal,
+
+  //! \brief Memory is becoming scarce, or tasks are sometimes stalled waiting
+  //!     for it.
+  kElevated,
+
+  //! \brief Memory is nearly exhausted, or all tasks are frequently stalled
+  //!     waiting for it.
+  kCritical,
+};
+
+//! \brief The resources that a handler may spend on capturing crashes.
+struct CaptureBudget {
+  CaptureBudget();
+
+  //! \brief The memory pressure level that this budget was chosen for.
+  MemoryPressureLevel memory_pressure_level;
+
+  //! \brief The limit on extra memory in each minidump file, for
+  //!     MinidumpFileWriter::SetExtraMemoryLimit().
+  uint64_t max_extra_memory_bytes;
+
+  //! \brief The amount of data to buffer while writing each minidump file,
+  //!     for IoUringFileWriter.
+  size_t write_buffer_bytes;
+
+  //! \brief Whether to write reduced minidump files, for
+  //!     MinidumpFileWriter::SetReducedCapture().
+  bool reduced_capture;
+
+  //! \brief The limits on concurrent dumps, for DumpAdmissionController.
+  DumpAdmissionController::Options admission;
+};
+
+//! \brief The process annotation key under which a handler records
+//!     MemoryPressureLevelName() for the level that a minidump file was
+//!     captured at.
+extern const char kMemoryPressureLevelAnnotationKey[];
+
+//! \brief Classifies \a pressure.
+//!
+//! The level is critical when less than 5% of memory is available or all tasks
+//! were stalled on memory for at least 10% of the last 10 seconds. It is
+//! elevated when less than 20% of memory is available or some task was
+//! stalled on memory for at least 10% of the last 10 seconds.
+MemoryPressureLevel ClassifyMemoryPressure(const MemoryPressure& pressure);
+
+//! \brief Returns a short name for \a level, suitable for an annotation.
+const char* MemoryPressureLevelName(MemoryPressureLevel level);
+
+//! \brief Scales a capture budget to the current memory pressure.
+//!
+//! At elevated pressure, extra memory is limited to a quarter of \a budget’s,
+//! write buffers are halved, and the number of concurrent dumps is halved. At
+//! critical pressure, no extra memory is captured, write buffers are
+//! minimal, only one dump is written at a time, and captures are reduced. At
+//! every level, the bytes that concurrent dumps may use are limited to a
+//! fraction of the available memory.
+//!
+//! \param[in] budget The budget to use when memory is plentiful.
+//! \param[in] pressure The current memory pressure.
+//!
+//! \return The scaled budget, with CaptureBudget::memory_pressure_level set.
+CaptureBudget ScaleCaptureBudget(const CaptureBudget& budget,
+                                 const MemoryPressure& pressure);
+
+//! \brief Records the level that \a budget was chosen for in \a annotations,
+//!     under #kMemoryPressureLevelAnnotationKey.
+//!
+//! A handler passes these annotations to the process snapshot, such as by
+//! ProcessSnapshotMac::SetAnnotationsSimpleMap(), so that they appear in the
+//! minidump file.
+void AddCaptureBudgetAnnotations(
+    const CaptureBudget& budget,
+    std::map<std::string, std::string>* annotations);
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_HANDLER_LINUX_CAPTURE_BUDGET_H_
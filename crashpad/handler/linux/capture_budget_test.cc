@@ -0,0 +1,114 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "handler/linux/capture_budget.h"
+
+#include "gtest/gtest.h"
+#include "util/linux/memory_pressure.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+constexpr uint64_t kTotalBytes = 8ull * 1024 * 1024 * 1024;
+
+MemoryPressure PressureWithAvailable(uint64_t available_bytes) {
+  MemoryPressure pressure;
+  pressure.total_bytes = kTotalBytes;
+  pressure.available_bytes = available_bytes;
+  return pressure;
+}
+
+CaptureBudget TestBudget() {
+  CaptureBudget budget;
+  budget.max_extra_memory_bytes = 16 * 1024 * 1024;
+  budget.write_buffer_bytes = 1024 * 1024;
+  budget.admission.max_concurrent_dumps = 4;
+  budget.admission.max_concurrent_bytes = 1024 * 1024 * 1024;
+  return budget;
+}
+
+TEST(CaptureBudget, Classify) {
+  EXPECT_EQ(ClassifyMemoryPressure(PressureWithAvailable(kTotalBytes / 2)),
+            MemoryPressureLevel::kNormal);
+  EXPECT_EQ(ClassifyMemoryPressure(PressureWithAvailable(kTotalBytes / 10)),
+            MemoryPressureLevel::kElevated);
+  EXPECT_EQ(ClassifyMemoryPressure(PressureWithAvailable(kTotalBytes / 50)),
+            MemoryPressureLevel::kCritical);
+
+  // Stalls raise the level even when memory appears to be available.
+  MemoryPressure pressure = PressureWithAvailable(kTotalBytes / 2);
+  pressure.has_pressure_stall_information = true;
+  pressure.some_avg10 = 25;
+  EXPECT_EQ(ClassifyMemoryPressure(pressure), MemoryPressureLevel::kElevated);
+  pressure.full_avg10 = 15;
+  EXPECT_EQ(ClassifyMemoryPressure(pressure), MemoryPressureLevel::kCritical);
+
+  // Stall values are ignored when they are not valid.
+  pressure.has_pressure_stall_information = false;
+  EXPECT_EQ(ClassifyMemoryPressure(pressure), MemoryPressureLevel::kNormal);
+}
+
+TEST(CaptureBudget, Normal) {
+  const CaptureBudget budget = TestBudget();
+  const CaptureBudget scaled =
+      ScaleCaptureBudget(budget, PressureWithAvailable(kTotalBytes / 2));
+  EXPECT_EQ(scaled.memory_pressure_level, MemoryPressureLevel::kNormal);
+  EXPECT_EQ(scaled.max_extra_memory_bytes, budget.max_extra_memory_bytes);
+  EXPECT_EQ(scaled.write_buffer_bytes, budget.write_buffer_bytes);
+  EXPECT_FALSE(scaled.reduced_capture);
+  EXPECT_EQ(scaled.admission.max_concurrent_dumps, 4u);
+  EXPECT_EQ(scaled.admission.max_concurrent_bytes,
+            budget.admission.max_concurrent_bytes);
+}
+
+TEST(CaptureBudget, Elevated) {
+  const CaptureBudget budget = TestBudget();
+  const CaptureBudget scaled =
+      ScaleCaptureBudget(budget, PressureWithAvailable(kTotalBytes / 10));
+  EXPECT_EQ(scaled.memory_pressure_level, MemoryPressureLevel::kElevated);
+  EXPECT_EQ(scaled.max_extra_memory_bytes, budget.max_extra_memory_bytes / 4);
+  EXPECT_EQ(scaled.write_buffer_bytes, budget.write_buffer_bytes / 2);
+  EXPECT_FALSE(scaled.reduced_capture);
+  EXPECT_EQ(scaled.admission.max_concurrent_dumps, 2u);
+  EXPECT_EQ(scaled.admission.max_concurrent_bytes, kTotalBytes / 10 / 4);
+}
+
+TEST(CaptureBudget, Critical) {
+  const CaptureBudget budget = TestBudget();
+  const CaptureBudget scaled =
+      ScaleCaptureBudget(budget, PressureWithAvailable(kTotalBytes / 50));
+  EXPECT_EQ(scaled.memory_pressure_level, MemoryPressureLevel::kCritical);
+  EXPECT_EQ(scaled.max_extra_memory_bytes, 0u);
+  EXPECT_GT(scaled.write_buffer_bytes, 0u);
+  EXPECT_LT(scaled.write_buffer_bytes, budget.write_buffer_bytes);
+  EXPECT_TRUE(scaled.reduced_capture);
+  EXPECT_EQ(scaled.admission.max_concurrent_dumps, 1u);
+  EXPECT_EQ(scaled.admission.max_concurrent_bytes, kTotalBytes / 50 / 8);
+}
+
+TEST(CaptureBudget, Annotations) {
+  CaptureBudget budget;
+  budget.memory_pressure_level = MemoryPressureLevel::kElevated;
+
+  std::map<std::string, std::string> annotations;
+  annotations["other"] = "value";
+  AddCaptureBudgetAnnotations(budget, &annotations);
+  EXPECT_EQ(annotations.size(), 2u);
+  EXPECT_EQ(annotations[kMemoryPressureLevelAnnotationKey], "elevated");
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
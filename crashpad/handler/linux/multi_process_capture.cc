@@ -0,0 +1,213 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "handler/linux/multi_process_capture.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+#include "base/logging.h"
+#include "base/strings/string_number_conversions.h"
+#include "snapshot/linux/process_reader.h"
+#include "util/linux/direct_ptrace_connection.h"
+#include "util/linux/related_processes.h"
+#include "util/thread/thread.h"
+
+namespace crashpad {
+
+namespace {
+
+// The number of times the processes are frozen before they are captured even
+// though more are still being created.
+constexpr int kMaxFreezeAttempts = 3;
+
+// Selects the processes related to |pid|. The handler is often a child of the
+// process that it captures, or in the same cgroup, and is never selected, so
+// that it doesn’t freeze itself.
+bool SelectProcesses(pid_t pid,
+                     MultiProcessCapture::Selection selection,
+                     std::vector<pid_t>* pids) {
+  switch (selection) {
+    case MultiProcessCapture::Selection::kProcessTree:
+      if (!ReadProcessTree(pid, pids)) {
+        return false;
+      }
+      break;
+    case MultiProcessCapture::Selection::kCgroup:
+      if (!ReadCgroupProcesses(pid, pids)) {
+        return false;
+      }
+      break;
+  }
+
+  pids->erase(std::remove(pids->begin(), pids->end(), getpid()), pids->end());
+  if (pids->empty()) {
+    LOG(ERROR) << "no processes to capture";
+    return false;
+  }
+  return true;
+}
+
+// Captures processes until none are left. Each process is attached, read, and
+// detached on the same thread, as ptrace requires.
+class CaptureThread : public Thread {
+ public:
+  CaptureThread(const std::vector<pid_t>* pids,
+                const std::map<std::string, std::string>* annotations,
+                MultiProcessCapture::Delegate* delegate,
+                std::atomic<size_t>* next_index)
+      : Thread(),
+        pids_(pids),
+        annotations_(annotations),
+        delegate_(delegate),
+        next_index_(next_index),
+        failures_(0) {}
+  ~CaptureThread() override {}
+
+  size_t failures() const { return failures_; }
+
+ private:
+  void ThreadMain() override {
+    size_t index;
+    while ((index = next_index_->fetch_add(1)) < pids_->size()) {
+      if (!CaptureProcess((*pids_)[index])) {
+        ++failures_;
+      }
+    }
+  }
+
+  bool CaptureProcess(pid_t pid) {
+    DirectPtraceConnection connection;
+    if (!connection.InitializeAlreadyFrozen(pid)) {
+      return false;
+    }
+
+    ProcessReader reader;
+    if (!reader.Initialize(&connection)) {
+      return false;
+    }
+    return delegate_->CaptureProcess(&reader, *annotations_);
+  }
+
+  const std::vector<pid_t>* pids_;  // weak
+  const std::map<std::string, std::string>* annotations_;  // weak
+  MultiProcessCapture::Delegate* delegate_;  // weak
+  std::atomic<size_t>* next_index_;  // weak
+  size_t failures_;
+
+  DISALLOW_COPY_AND_ASSIGN(CaptureThread);
+};
+
+}  // namespace
+
+const char kCaptureGroupIDAnnotationKey[] = "crashpad_capture_group_id";
+const char kCaptureGroupProcessesAnnotationKey[] =
+    "crashpad_capture_group_pids";
+
+MultiProcessCapture::Options::Options()
+    : selection(Selection::kProcessTree),
+      freeze_method(ScopedProcessFreeze::Method::kAutomatic),
+      timeout_seconds(5),
+      max_threads(0) {}
+
+MultiProcessCapture::MultiProcessCapture() : group_id_(), pids_() {}
+
+MultiProcessCapture::~MultiProcessCapture() {}
+
+bool MultiProcessCapture::Capture(pid_t pid,
+                                  const Options& options,
+                                  Delegate* delegate) {
+  pids_.clear();
+  if (!group_id_.InitializeWithNew()) {
+    return false;
+  }
+
+  // A process created between selecting the processes and freezing them isn’t
+  // frozen, so the processes are selected again until the selection settles.
+  // Frozen processes can’t create any more.
+  ScopedProcessFreeze freeze;
+  std::vector<pid_t> pids;
+  if (!SelectProcesses(pid, options.selection, &pids)) {
+    return false;
+  }
+  for (int attempt = 1;; ++attempt) {
+    if (!freeze.ResetFreeze(
+            pids, options.freeze_method, options.timeout_seconds)) {
+      return false;
+    }
+
+    std::vector<pid_t> frozen_pids;
+    if (!SelectProcesses(pid, options.selection, &frozen_pids)) {
+      return false;
+    }
+    if (std::includes(pids.begin(),
+                      pids.end(),
+                      frozen_pids.begin(),
+                      frozen_pids.end())) {
+      // Processes that exited since they were selected needn’t be captured.
+      pids.swap(frozen_pids);
+      break;
+    }
+    if (attempt == kMaxFreezeAttempts) {
+      LOG(WARNING) << "processes still being created, capturing "
+                   << pids.size() << " of them";
+      break;
+    }
+    pids.swap(frozen_pids);
+  }
+  pids_ = pids;
+
+  std::map<std::string, std::string> annotations;
+  annotations[kCaptureGroupIDAnnotationKey] = group_id_.ToString();
+  std::string pids_string;
+  for (pid_t member : pids_) {
+    if (!pids_string.empty()) {
+      pids_string.push_back(',');
+    }
+    pids_string.append(base::IntToString(member));
+  }
+  annotations[kCaptureGroupProcessesAnnotationKey] = pids_string;
+
+  size_t thread_count = options.max_threads;
+  if (thread_count == 0) {
+    const long cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+    thread_count = cpu_count > 0 ? cpu_count : 1;
+  }
+  thread_count = std::min(thread_count, pids_.size());
+
+  std::atomic<size_t> next_index(0);
+  std::vector<std::unique_ptr<CaptureThread>> threads;
+  for (size_t index = 0; index < thread_count; ++index) {
+    threads.push_back(std::unique_ptr<CaptureThread>(
+        new CaptureThread(&pids_, &annotations, delegate, &next_index)));
+    threads.back()->Start();
+  }
+
+  size_t failures = 0;
+  for (const auto& thread : threads) {
+    thread->Join();
+    failures += thread->failures();
+  }
+  if (failures > 0) {
+    LOG(ERROR) << "failed to capture " << failures << " of " << pids_.size()
+               << " processes";
+    return false;
+  }
+  return true;
+}
+
+}  // namespace crashpad
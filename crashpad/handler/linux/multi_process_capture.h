@@ -0,0 +1,145 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_HANDLER_LINUX_MULTI_PROCESS_CAPTURE_H_
+#define CRASHPAD_HANDLER_LINUX_MULTI_PROCESS_CAPTURE_H_
+
+#include <stddef.h>
+#include <sys/types.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "util/linux/scoped_process_freeze.h"
+#include "util/misc/uuid.h"
+
+namespace crashpad {
+
+class ProcessReader;
+
+//! \brief The process annotation key under which a handler records the ID
+//!     shared by every report of a MultiProcessCapture.
+extern const char kCaptureGroupIDAnnotationKey[];
+
+//! \brief The process annotation key under which a handler records the
+//!     comma-separated process IDs of every process in a MultiProcessCapture.
+extern const char kCaptureGroupProcessesAnnotationKey[];
+
+//! \brief Captures a set of related processes, such as a supervisor and its
+//!     workers, in one coordinated pass.
+//!
+//! All of the processes are frozen together with one ScopedProcessFreeze, so
+//! that state shared between them is captured as it was at a single point in
+//! time. The processes are then captured in parallel, each on its own worker
+//! thread, and remain frozen until all have been captured. Each process is
+//! written to a separate report by the Delegate, and the reports are linked by
+//! the annotations under #kCaptureGroupIDAnnotationKey and
+//! #kCaptureGroupProcessesAnnotationKey.
+class MultiProcessCapture {
+ public:
+  //! \brief How the processes related to a process are chosen.
+  enum class Selection {
+    //! \brief The process and all of its descendants.
+    kProcessTree,
+
+    //! \brief The processes in the process’ cgroup v2 cgroup.
+    kCgroup,
+  };
+
+  //! \brief Options for Capture().
+  struct Options {
+    Options();
+
+    //! \brief How the processes to capture are chosen.
+    Selection selection;
+
+    //! \brief The method with which to freeze the processes.
+    //!
+    //! With ScopedProcessFreeze::Method::kAutomatic, the cgroup freezer is
+    //! used when the processes are exactly those in a cgroup, which is usually
+    //! the case for Selection::kCgroup.
+    ScopedProcessFreeze::Method freeze_method;
+
+    //! \brief The maximum time to wait for the processes to stop.
+    double timeout_seconds;
+
+    //! \brief The maximum number of processes to capture at once. `0` uses one
+    //!     worker thread for each online CPU.
+    size_t max_threads;
+  };
+
+  //! \brief The interface that writes the report of each captured process.
+  class Delegate {
+   public:
+    //! \brief Writes the report of one process.
+    //!
+    //! This is called on a worker thread, concurrently for different
+    //! processes, while all of the processes are frozen. \a reader and the
+    //! `ptrace` attachments it uses belong to the calling thread, and are only
+    //! valid for the duration of the call.
+    //!
+    //! \param[in] reader A reader for the process.
+    //! \param[in] annotations The annotations that link the report to the
+    //!     others in the group, to be added to the report’s process
+    //!     annotations.
+    //!
+    //! \return `true` if the report was written. `false` on failure, with a
+    //!     message logged.
+    virtual bool CaptureProcess(
+        ProcessReader* reader,
+        const std::map<std::string, std::string>& annotations) = 0;
+
+   protected:
+    virtual ~Delegate() {}
+  };
+
+  MultiProcessCapture();
+  ~MultiProcessCapture();
+
+  //! \brief Selects the processes related to process \a pid, freezes them all
+  //!     together, and captures each of them with \a delegate.
+  //!
+  //! The processes are selected again once frozen, and frozen again if any
+  //! were created in the meantime, so that none run unfrozen during the
+  //! capture.
+  //!
+  //! \param[in] pid The process ID of the process whose related processes are
+  //!     captured. It is always captured itself.
+  //! \param[in] options How to select, freeze, and capture the processes.
+  //! \param[in] delegate The delegate to write each process’ report.
+  //!
+  //! \return `true` if every process was captured. `false` with a message
+  //!     logged if the processes couldn’t be selected or frozen, in which
+  //!     case none were captured, or if any process couldn’t be captured.
+  bool Capture(pid_t pid, const Options& options, Delegate* delegate);
+
+  //! \brief Returns the ID shared by the reports of the last Capture().
+  const UUID& group_id() const { return group_id_; }
+
+  //! \brief Returns the process IDs of the processes selected by the last
+  //!     Capture(), in ascending order.
+  const std::vector<pid_t>& pids() const { return pids_; }
+
+ private:
+  UUID group_id_;
+  std::vector<pid_t> pids_;
+
+  DISALLOW_COPY_AND_ASSIGN(MultiProcessCapture);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_HANDLER_LINUX_MULTI_PROCESS_CAPTURE_H_
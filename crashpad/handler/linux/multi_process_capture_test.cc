@@ -0,0 +1,230 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "handler/linux/multi_process_capture.h"
+
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/strings/stringprintf.h"
+#include "gtest/gtest.h"
+#include "snapshot/linux/process_reader.h"
+#include "test/errors.h"
+#include "test/multiprocess.h"
+#include "util/file/file_io.h"
+#include "util/misc/clock.h"
+#include "util/posix/scoped_mmap.h"
+#include "util/thread/thread.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+// Each process under test spins, counting in shared memory, until it is
+// frozen.
+struct Counters {
+  std::atomic<uint64_t> counts[2];
+};
+
+// Checks that every process is frozen while each is captured, and records
+// which were captured.
+class TestDelegate : public MultiProcessCapture::Delegate {
+ public:
+  TestDelegate(const std::vector<pid_t>& pids, const Counters* counters)
+      : MultiProcessCapture::Delegate(),
+        pids_(pids),
+        counters_(counters),
+        captured_(new std::atomic<bool>[pids.size()]),
+        group_ids_(pids.size()) {
+    for (size_t index = 0; index < pids_.size(); ++index) {
+      captured_[index] = false;
+    }
+  }
+  ~TestDelegate() override {}
+
+  bool Captured(size_t index) const { return captured_[index]; }
+
+  const std::string& GroupID(size_t index) const { return group_ids_[index]; }
+
+  bool CaptureProcess(
+      ProcessReader* reader,
+      const std::map<std::string, std::string>& annotations) override {
+    uint64_t counts[arraysize(counters_->counts)];
+    for (size_t index = 0; index < arraysize(counts); ++index) {
+      counts[index] = counters_->counts[index].load();
+    }
+    SleepNanoseconds(10 * 1000 * 1000);
+    for (size_t index = 0; index < arraysize(counts); ++index) {
+      EXPECT_EQ(counters_->counts[index].load(), counts[index]) << index;
+    }
+
+    EXPECT_FALSE(reader->Threads().empty());
+
+    size_t index = 0;
+    while (index < pids_.size() && pids_[index] != reader->ProcessID()) {
+      ++index;
+    }
+    if (index == pids_.size()) {
+      ADD_FAILURE() << "unexpected process " << reader->ProcessID();
+      return false;
+    }
+    EXPECT_FALSE(captured_[index].exchange(true));
+
+    const auto group_id = annotations.find(kCaptureGroupIDAnnotationKey);
+    EXPECT_NE(group_id, annotations.end());
+    if (group_id != annotations.end()) {
+      group_ids_[index] = group_id->second;
+    }
+    const auto processes =
+        annotations.find(kCaptureGroupProcessesAnnotationKey);
+    EXPECT_NE(processes, annotations.end());
+    if (processes != annotations.end()) {
+      EXPECT_EQ(processes->second,
+                base::StringPrintf("%d,%d", pids_[0], pids_[1]));
+    }
+    return true;
+  }
+
+ private:
+  std::vector<pid_t> pids_;
+  const Counters* counters_;  // weak
+  std::unique_ptr<std::atomic<bool>[]> captured_;
+  std::vector<std::string> group_ids_;
+
+  DISALLOW_COPY_AND_ASSIGN(TestDelegate);
+};
+
+// Returns whether the counter advances within a short time.
+bool CounterAdvances(const std::atomic<uint64_t>& counter) {
+  const uint64_t count = counter.load();
+  for (int attempt = 0; attempt < 1000; ++attempt) {
+    if (counter.load() != count) {
+      return true;
+    }
+    SleepNanoseconds(1000 * 1000);
+  }
+  return false;
+}
+
+class CountingThread : public Thread {
+ public:
+  CountingThread(std::atomic<uint64_t>* counter, const std::atomic<bool>* stop)
+      : Thread(), counter_(counter), stop_(stop) {}
+  ~CountingThread() override {}
+
+ private:
+  void ThreadMain() override {
+    while (!stop_->load()) {
+      ++*counter_;
+    }
+  }
+
+  std::atomic<uint64_t>* counter_;  // weak
+  const std::atomic<bool>* stop_;  // weak
+
+  DISALLOW_COPY_AND_ASSIGN(CountingThread);
+};
+
+// The child creates a grandchild, and both count until the parent is done.
+class CaptureTreeTest : public Multiprocess {
+ public:
+  CaptureTreeTest()
+      : Multiprocess(), counters_mapping_(), counters_(nullptr) {
+    EXPECT_TRUE(counters_mapping_.ResetMmap(nullptr,
+                                            getpagesize(),
+                                            PROT_READ | PROT_WRITE,
+                                            MAP_SHARED | MAP_ANONYMOUS,
+                                            -1,
+                                            0));
+    counters_ = new (counters_mapping_.addr()) Counters();
+  }
+  ~CaptureTreeTest() {}
+
+ private:
+  void MultiprocessParent() override {
+    pid_t grandchild;
+    CheckedReadFileExactly(ReadPipeHandle(), &grandchild, sizeof(grandchild));
+    const std::vector<pid_t> pids = {ChildPID(), grandchild};
+
+    TestDelegate delegate(pids, counters_);
+    MultiProcessCapture::Options options;
+    options.selection = MultiProcessCapture::Selection::kProcessTree;
+    options.freeze_method = ScopedProcessFreeze::Method::kGroupStop;
+    options.max_threads = 2;
+    MultiProcessCapture capture;
+    ASSERT_TRUE(capture.Capture(ChildPID(), options, &delegate));
+
+    EXPECT_EQ(capture.pids(), pids);
+    EXPECT_TRUE(delegate.Captured(0));
+    EXPECT_TRUE(delegate.Captured(1));
+    // Both reports are linked by the same ID.
+    EXPECT_EQ(delegate.GroupID(0), capture.group_id().ToString());
+    EXPECT_EQ(delegate.GroupID(1), capture.group_id().ToString());
+
+    // Both are resumed.
+    EXPECT_TRUE(CounterAdvances(counters_->counts[0]));
+    EXPECT_TRUE(CounterAdvances(counters_->counts[1]));
+
+    char c = '\0';
+    CheckedWriteFile(WritePipeHandle(), &c, sizeof(c));
+  }
+
+  void MultiprocessChild() override {
+    const pid_t grandchild = fork();
+    ASSERT_GE(grandchild, 0) << ErrnoMessage("fork");
+    if (grandchild == 0) {
+      while (true) {
+        ++counters_->counts[1];
+      }
+    }
+
+    std::atomic<bool> stop(false);
+    CountingThread thread(&counters_->counts[0], &stop);
+    thread.Start();
+
+    CheckedWriteFile(WritePipeHandle(), &grandchild, sizeof(grandchild));
+    char c;
+    CheckedReadFileExactly(ReadPipeHandle(), &c, sizeof(c));
+
+    stop.store(true);
+    thread.Join();
+    ASSERT_EQ(kill(grandchild, SIGKILL), 0) << ErrnoMessage("kill");
+    ASSERT_EQ(waitpid(grandchild, nullptr, 0), grandchild)
+        << ErrnoMessage("waitpid");
+  }
+
+  ScopedMmap counters_mapping_;
+  Counters* counters_;  // weak
+
+  DISALLOW_COPY_AND_ASSIGN(CaptureTreeTest);
+};
+
+TEST(MultiProcessCapture, ProcessTree) {
+  CaptureTreeTest test;
+  test.Run();
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
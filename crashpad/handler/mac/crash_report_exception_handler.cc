@@ -14,6 +14,8 @@
 
 #include "handler/mac/crash_report_exception_handler.h"
 
+#include <memory>
+#include <utility>
 #include <vector>
 
 #include "base/logging.h"
@@ -176,7 +178,20 @@ kern_return_t CrashReportExceptionHandler::CatchMachException(
     AddUserExtensionStreams(
         user_stream_data_sources_, &process_snapshot, &minidump);
 
-    if (!minidump.WriteEverything(&file_writer)) {
+    // If an early upload is in progress, the minidump is written through it,
+    // without seeking, so that it can be uploaded as it is written.
+    std::unique_ptr<CrashReportUploadThread::EarlyUpload> early_upload =
+        upload_thread_->StartEarlyUpload(
+            process_snapshot, *new_report, &file_writer);
+    const bool written =
+        early_upload
+            ? minidump.WriteMinidump(early_upload->file_writer(), false)
+            : minidump.WriteEverything(&file_writer);
+    if (early_upload) {
+      early_upload->Finish(written);
+    }
+
+    if (!written) {
       Metrics::ExceptionCaptureResult(
           Metrics::CaptureResult::kMinidumpWriteFailed);
       return KERN_FAILURE;
@@ -192,7 +207,7 @@ kern_return_t CrashReportExceptionHandler::CatchMachException(
       return KERN_FAILURE;
     }
 
-    upload_thread_->ReportPending(uuid);
+    upload_thread_->ReportPending(uuid, std::move(early_upload));
   }
 
   if (client_options.system_crash_reporter_forwarding != TriState::kDisabled &&
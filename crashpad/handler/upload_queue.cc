@@ -0,0 +1,228 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "handler/upload_queue.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "base/logging.h"
+
+namespace crashpad {
+
+UploadQueue::Options::Options()
+    : aging_seconds_per_day(10 * 60),
+      priority_step_seconds(20 * 60),
+      max_priority(3),
+      recency_bonus_seconds(60 * 60),
+      recency_window_seconds(24 * 60 * 60),
+      size_penalty_seconds_per_mib(60),
+      max_size_penalty_seconds(30 * 60) {}
+
+UploadQueue::Entry::Entry()
+    : uuid(),
+      upload_explicitly_requested(false),
+      priority(0),
+      creation_time(0),
+      size(0) {}
+
+UploadQueue::UploadQueue(const Options& options)
+    : entries_(), by_rank_(), by_time_(), band_time_(0), options_(options) {
+  DCHECK_GE(options_.max_priority, 0);
+  DCHECK_GT(options_.recency_window_seconds, 0);
+}
+
+UploadQueue::~UploadQueue() {}
+
+void UploadQueue::Push(const Entry& entry) {
+  auto it = entries_.find(entry.uuid);
+  if (it != entries_.end()) {
+    Erase(it);
+  }
+
+  // Reports are banded as of the last Pop(), and moved if necessary by the
+  // next one.
+  Insert(entry, BandAt(entry.creation_time, band_time_));
+}
+
+bool UploadQueue::Pop(time_t now, UUID* uuid) {
+  if (entries_.empty()) {
+    return false;
+  }
+
+  Rebalance(now);
+
+  // Only the best report of each band is a candidate.
+  const Entry* best = nullptr;
+  double best_score = 0;
+  for (const std::set<RankKey>& band_by_rank : by_rank_) {
+    if (band_by_rank.empty()) {
+      continue;
+    }
+
+    const Entry& entry =
+        entries_.find(std::get<UUID>(*band_by_rank.rbegin()))->second.entry;
+    const double score = Score(entry, now);
+    if (best) {
+      // Explicitly requested uploads come first. Among reports with equal
+      // scores, the more recent crash is uploaded first.
+      const bool explicitly_requested = entry.upload_explicitly_requested;
+      const bool best_explicitly_requested = best->upload_explicitly_requested;
+      if (explicitly_requested != best_explicitly_requested) {
+        if (!explicitly_requested) {
+          continue;
+        }
+      } else if (score < best_score ||
+                 (score == best_score &&
+                  entry.creation_time <= best->creation_time)) {
+        continue;
+      }
+    }
+
+    best = &entry;
+    best_score = score;
+  }
+
+  *uuid = best->uuid;
+  Erase(entries_.find(best->uuid));
+  return true;
+}
+
+bool UploadQueue::Contains(const UUID& uuid) const {
+  return entries_.find(uuid) != entries_.end();
+}
+
+double UploadQueue::Score(const Entry& entry, time_t now) const {
+  // A report from the future, because the clock went backwards, is treated as
+  // new.
+  const double age = std::max(difftime(now, entry.creation_time), 0.0);
+
+  const double recency =
+      std::max(1 - age / options_.recency_window_seconds, 0.0);
+
+  return age / (24 * 60 * 60) * options_.aging_seconds_per_day +
+         recency * options_.recency_bonus_seconds + BaseScore(entry);
+}
+
+UploadQueue::Band UploadQueue::BandAt(time_t creation_time, time_t now) const {
+  const double age = difftime(now, creation_time);
+  if (age < 0) {
+    return kBandFuture;
+  }
+  if (age < options_.recency_window_seconds) {
+    return kBandRecent;
+  }
+  return kBandOld;
+}
+
+UploadQueue::RankKey UploadQueue::MakeRankKey(const Entry& entry,
+                                              Band band) const {
+  // Score() at |now| is the key’s score plus |now| times a rate that is the
+  // same for the whole band.
+  const double aging_per_second = AgingPerSecond();
+  double score = BaseScore(entry);
+  switch (band) {
+    case kBandFuture:
+      score += options_.recency_bonus_seconds;
+      break;
+    case kBandRecent:
+      score += options_.recency_bonus_seconds -
+               entry.creation_time *
+                   (aging_per_second - RecencyDecayPerSecond());
+      break;
+    case kBandOld:
+      score -= entry.creation_time * aging_per_second;
+      break;
+    case kBandCount:
+      NOTREACHED();
+      break;
+  }
+
+  return RankKey(entry.upload_explicitly_requested,
+                 score,
+                 entry.creation_time,
+                 entry.uuid);
+}
+
+void UploadQueue::Insert(const Entry& entry, Band band) {
+  IndexedEntry indexed;
+  indexed.entry = entry;
+  indexed.band = band;
+  indexed.rank_key = MakeRankKey(entry, band);
+  by_rank_[band].insert(indexed.rank_key);
+  by_time_[band].insert(TimeKey(entry.creation_time, entry.uuid));
+  entries_[entry.uuid] = indexed;
+}
+
+void UploadQueue::Erase(std::map<UUID, IndexedEntry>::iterator it) {
+  const IndexedEntry& indexed = it->second;
+  by_rank_[indexed.band].erase(indexed.rank_key);
+  by_time_[indexed.band].erase(
+      TimeKey(indexed.entry.creation_time, indexed.entry.uuid));
+  entries_.erase(it);
+}
+
+void UploadQueue::Rebalance(time_t now) {
+  // The bands are contiguous ranges of creation time, so a report that has
+  // changed band is at the oldest or newest end of the band it is in.
+  std::vector<UUID> moved;
+  for (int band = 0; band < kBandCount; ++band) {
+    const std::set<TimeKey>& band_by_time = by_time_[band];
+    for (auto it = band_by_time.begin();
+         it != band_by_time.end() && BandAt(it->first, now) != band;
+         ++it) {
+      moved.push_back(it->second);
+    }
+    for (auto it = band_by_time.rbegin();
+         it != band_by_time.rend() && BandAt(it->first, now) != band;
+         ++it) {
+      moved.push_back(it->second);
+    }
+  }
+
+  band_time_ = now;
+  for (const UUID& uuid : moved) {
+    auto it = entries_.find(uuid);
+    const Band band = BandAt(it->second.entry.creation_time, now);
+    if (it->second.band == band) {
+      // Already moved, having been found at both ends of its old band.
+      continue;
+    }
+    const Entry entry = it->second.entry;
+    Erase(it);
+    Insert(entry, band);
+  }
+}
+
+double UploadQueue::BaseScore(const Entry& entry) const {
+  const int priority = std::min(
+      std::max(entry.priority, -options_.max_priority), options_.max_priority);
+
+  const double size_mib = entry.size / (1024.0 * 1024.0);
+  const double size_penalty =
+      std::min(size_mib * options_.size_penalty_seconds_per_mib,
+               options_.max_size_penalty_seconds);
+
+  return priority * options_.priority_step_seconds - size_penalty;
+}
+
+double UploadQueue::AgingPerSecond() const {
+  return options_.aging_seconds_per_day / (24 * 60 * 60);
+}
+
+double UploadQueue::RecencyDecayPerSecond() const {
+  return options_.recency_bonus_seconds / options_.recency_window_seconds;
+}
+
+}  // namespace crashpad
@@ -0,0 +1,218 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_HANDLER_UPLOAD_QUEUE_H_
+#define CRASHPAD_HANDLER_UPLOAD_QUEUE_H_
+
+#include <stdint.h>
+#include <time.h>
+
+#include <map>
+#include <set>
+#include <tuple>
+#include <utility>
+
+#include "base/macros.h"
+#include "util/misc/uuid.h"
+
+namespace crashpad {
+
+//! \brief The key of the simple annotation with which a client may set the
+//!     upload priority of its crash reports.
+//!
+//! The value is a decimal integer. Reports with higher values are uploaded
+//! sooner. See UploadQueue::Entry::priority.
+constexpr char kUploadPriorityAnnotationKey[] = "crashpad_upload_priority";
+
+//! \brief Orders pending crash reports for upload.
+//!
+//! Each report is given a score, measured in seconds, and the report with the
+//! highest score is uploaded first. Reports whose upload was explicitly
+//! requested are always uploaded before all others. The score of every other
+//! report is made up of:
+//!  - A bonus for the report’s age, from Options::aging_seconds_per_day. This
+//!    ages every report at the same rate, so that none starve. Age is measured
+//!    from the report’s creation, so it is not lost when the queue is rebuilt.
+//!  - A bonus for the report’s priority, from Entry::priority.
+//!  - A bonus for recent crashes, which falls to nothing as the crash ages.
+//!  - A penalty for large reports, which take longer to upload.
+//!
+//! Because the bonuses and penalty other than age are bounded, a report whose
+//! age bonus exceeds the difference between the largest and smallest possible
+//! sums of them is uploaded ahead of any report created later.
+//!
+//! This class is not thread-safe.
+class UploadQueue {
+ public:
+  //! \brief The weights used to score reports.
+  struct Options {
+    Options();
+
+    //! \brief The bonus given for each day since a report was created. This
+    //!     should be smaller than the rate at which the recency bonus falls,
+    //!     so that recent crashes are still uploaded ahead of a backlog.
+    double aging_seconds_per_day;
+
+    //! \brief The bonus given for each step of Entry::priority.
+    double priority_step_seconds;
+
+    //! \brief The largest magnitude of Entry::priority that is recognized.
+    //!     Priorities beyond this are clamped to it.
+    int max_priority;
+
+    //! \brief The bonus given to a report created at the time it is scored.
+    double recency_bonus_seconds;
+
+    //! \brief The age of a report at which its recency bonus has fallen to
+    //!     nothing. The bonus falls linearly until then.
+    double recency_window_seconds;
+
+    //! \brief The penalty given for each MiB of a report’s size.
+    double size_penalty_seconds_per_mib;
+
+    //! \brief The largest penalty given for a report’s size.
+    double max_size_penalty_seconds;
+  };
+
+  //! \brief A report in the queue.
+  struct Entry {
+    Entry();
+
+    //! \brief The report’s unique identifier.
+    UUID uuid;
+
+    //! \brief Whether the report’s upload was explicitly requested.
+    bool upload_explicitly_requested;
+
+    //! \brief The report’s priority, as set by the client with the
+    //!     #kUploadPriorityAnnotationKey annotation. The default is `0`.
+    int priority;
+
+    //! \brief The time at which the report was created.
+    time_t creation_time;
+
+    //! \brief The size of the report, in bytes.
+    uint64_t size;
+  };
+
+  explicit UploadQueue(const Options& options);
+  ~UploadQueue();
+
+  //! \brief Adds a report to the queue.
+  //!
+  //! If a report with the same UUID is already in the queue, it is updated.
+  //! This takes time logarithmic in the size of the queue.
+  //!
+  //! \param[in] entry The report to add.
+  void Push(const Entry& entry);
+
+  //! \brief Removes the report that should be uploaded next from the queue.
+  //!
+  //! This takes time logarithmic in the size of the queue, plus a logarithmic
+  //! time for each report that has moved between the bands of age described
+  //! at #Band since the last call.
+  //!
+  //! \param[in] now The current time.
+  //! \param[out] uuid The unique identifier of the report.
+  //!
+  //! \return `true` on success, or `false` if the queue is empty.
+  bool Pop(time_t now, UUID* uuid);
+
+  //! \brief Returns whether a report is in the queue.
+  bool Contains(const UUID& uuid) const;
+
+  //! \brief Returns the number of reports in the queue.
+  size_t size() const { return entries_.size(); }
+
+  //! \brief Returns the score of \a entry at \a now, as described in the
+  //!     class documentation.
+  double Score(const Entry& entry, time_t now) const;
+
+ private:
+  //! \brief Ranges of a report’s age.
+  //!
+  //! Within each band, every report’s score changes with time at the same
+  //! rate, so the order of the reports in a band stays the same as time
+  //! passes. Pop() need only compare the best report of each band.
+  enum Band {
+    //! \brief Reports created after the current time, whose age is taken as
+    //!     `0`.
+    kBandFuture = 0,
+
+    //! \brief Reports that still receive a recency bonus.
+    kBandRecent,
+
+    //! \brief Reports whose recency bonus has fallen to nothing.
+    kBandOld,
+
+    kBandCount,
+  };
+
+  //! \brief Orders the reports in a band. The greatest is best: explicitly
+  //!     requested, then highest scoring, then most recently created.
+  using RankKey = std::tuple<bool, double, time_t, UUID>;
+
+  //! \brief Orders the reports in a band by creation time, to find those that
+  //!     have moved to another band.
+  using TimeKey = std::pair<time_t, UUID>;
+
+  struct IndexedEntry {
+    Entry entry;
+    Band band;
+    RankKey rank_key;
+  };
+
+  //! \brief Returns the band of a report created at \a creation_time at
+  //!     \a now.
+  Band BandAt(time_t creation_time, time_t now) const;
+
+  //! \brief Returns a key that orders \a entry among the other reports in
+  //!     \a band. Its score is the key’s score term plus a term that depends
+  //!     only on \a band and the current time.
+  RankKey MakeRankKey(const Entry& entry, Band band) const;
+
+  //! \brief Returns the parts of \a entry’s score that don’t depend on its
+  //!     age.
+  double BaseScore(const Entry& entry) const;
+
+  //! \brief Returns the rate at which a report’s age bonus grows.
+  double AgingPerSecond() const;
+
+  //! \brief Returns the rate at which a recent report’s recency bonus falls.
+  double RecencyDecayPerSecond() const;
+
+  //! \brief Adds \a entry to the indices of \a band.
+  void Insert(const Entry& entry, Band band);
+
+  //! \brief Removes \a it from #entries_ and from its band’s indices.
+  void Erase(std::map<UUID, IndexedEntry>::iterator it);
+
+  //! \brief Moves the reports that have changed band since #band_time_ to
+  //!     the bands that they are in at \a now.
+  void Rebalance(time_t now);
+
+  // Every report, by UUID. Each is also kept in the two indices of the band
+  // that it was in at band_time_.
+  std::map<UUID, IndexedEntry> entries_;
+  std::set<RankKey> by_rank_[kBandCount];
+  std::set<TimeKey> by_time_[kBandCount];
+  time_t band_time_;
+  Options options_;
+
+  DISALLOW_COPY_AND_ASSIGN(UploadQueue);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_HANDLER_UPLOAD_QUEUE_H_
@@ -0,0 +1,220 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "handler/upload_queue.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+constexpr time_t kNow = 1500000000;
+constexpr time_t kDay = 24 * 60 * 60;
+
+UploadQueue::Entry MakeEntry(uint8_t id, time_t creation_time) {
+  UploadQueue::Entry entry;
+  entry.uuid.data_1 = id;
+  entry.creation_time = creation_time;
+  entry.size = 100 * 1024;
+  return entry;
+}
+
+UUID PopUUID(UploadQueue* queue, time_t now) {
+  UUID uuid;
+  EXPECT_TRUE(queue->Pop(now, &uuid));
+  return uuid;
+}
+
+TEST(UploadQueue, Empty) {
+  UploadQueue queue((UploadQueue::Options()));
+  EXPECT_EQ(queue.size(), 0u);
+
+  UUID uuid;
+  EXPECT_FALSE(queue.Pop(kNow, &uuid));
+}
+
+TEST(UploadQueue, NewestCrashFirst) {
+  UploadQueue queue((UploadQueue::Options()));
+
+  // A backlog of old reports doesn’t hold up a new crash. Within the backlog,
+  // the oldest report goes first.
+  const UploadQueue::Entry old_1 = MakeEntry(1, kNow - 3 * kDay);
+  const UploadQueue::Entry old_2 = MakeEntry(2, kNow - 2 * kDay);
+  const UploadQueue::Entry fresh = MakeEntry(3, kNow - 10);
+  queue.Push(old_1);
+  queue.Push(old_2);
+  queue.Push(fresh);
+  EXPECT_EQ(queue.size(), 3u);
+  EXPECT_TRUE(queue.Contains(fresh.uuid));
+
+  EXPECT_EQ(PopUUID(&queue, kNow), fresh.uuid);
+  EXPECT_FALSE(queue.Contains(fresh.uuid));
+  EXPECT_EQ(PopUUID(&queue, kNow), old_1.uuid);
+  EXPECT_EQ(PopUUID(&queue, kNow), old_2.uuid);
+  EXPECT_EQ(queue.size(), 0u);
+}
+
+TEST(UploadQueue, ExplicitRequestFirst) {
+  UploadQueue queue((UploadQueue::Options()));
+
+  UploadQueue::Entry requested = MakeEntry(1, kNow - 3 * kDay);
+  requested.upload_explicitly_requested = true;
+  requested.priority = -3;
+  requested.size = 1024 * 1024 * 1024;
+  UploadQueue::Entry important = MakeEntry(2, kNow);
+  important.priority = 3;
+  queue.Push(important);
+  queue.Push(requested);
+
+  EXPECT_EQ(PopUUID(&queue, kNow), requested.uuid);
+  EXPECT_EQ(PopUUID(&queue, kNow), important.uuid);
+}
+
+TEST(UploadQueue, PriorityAndSize) {
+  UploadQueue queue((UploadQueue::Options()));
+
+  UploadQueue::Entry large = MakeEntry(1, kNow);
+  large.size = 100 * 1024 * 1024;
+  UploadQueue::Entry low = MakeEntry(2, kNow);
+  low.priority = -1;
+  UploadQueue::Entry high = MakeEntry(3, kNow - 2 * kDay);
+  high.priority = 3;
+  UploadQueue::Entry normal = MakeEntry(4, kNow - 2 * kDay);
+  queue.Push(large);
+  queue.Push(low);
+  queue.Push(high);
+  queue.Push(normal);
+
+  // In minutes, high: 3 * 20 + 2 * 10. low: 60 - 20. large: 60 - 30.
+  // normal: 2 * 10.
+  EXPECT_EQ(PopUUID(&queue, kNow), high.uuid);
+  EXPECT_EQ(PopUUID(&queue, kNow), low.uuid);
+  EXPECT_EQ(PopUUID(&queue, kNow), large.uuid);
+  EXPECT_EQ(PopUUID(&queue, kNow), normal.uuid);
+}
+
+TEST(UploadQueue, PriorityClamped) {
+  UploadQueue queue((UploadQueue::Options()));
+
+  UploadQueue::Entry entry = MakeEntry(1, kNow - 2 * kDay);
+  entry.priority = 1000;
+  entry.size = 0;
+  UploadQueue::Entry clamped = entry;
+  clamped.priority = 3;
+  EXPECT_EQ(queue.Score(entry, kNow), queue.Score(clamped, kNow));
+  EXPECT_EQ(queue.Score(entry, kNow), 3 * 20 * 60 + 2 * 10 * 60);
+}
+
+TEST(UploadQueue, Aging) {
+  UploadQueue queue((UploadQueue::Options()));
+
+  // The old report loses to a fresh one each day, but once it is old enough,
+  // it goes first. Its age is measured from its creation, so it doesn’t matter
+  // when it was added to the queue.
+  UploadQueue::Entry old = MakeEntry(1, kNow - 2 * kDay);
+  old.priority = -3;
+  queue.Push(old);
+
+  time_t now = kNow;
+  UUID uuid;
+  for (uint8_t id = 2; id < 100; ++id) {
+    now += kDay;
+    queue.Push(MakeEntry(id, now));
+    uuid = PopUUID(&queue, now);
+    if (uuid == old.uuid) {
+      break;
+    }
+  }
+  EXPECT_EQ(uuid, old.uuid);
+
+  // Bounded by the difference in priority and recency bonuses, at 10 minutes
+  // per day of age.
+  EXPECT_LE(now - kNow, 11 * kDay);
+}
+
+TEST(UploadQueue, PushUpdates) {
+  UploadQueue queue((UploadQueue::Options()));
+
+  UploadQueue::Entry first = MakeEntry(1, kNow - 2 * kDay);
+  UploadQueue::Entry second = MakeEntry(2, kNow - 3 * kDay);
+  queue.Push(first);
+  queue.Push(second);
+  EXPECT_EQ(PopUUID(&queue, kNow), second.uuid);
+  queue.Push(second);
+
+  // Pushing |first| again updates it, rather than adding it a second time.
+  first.upload_explicitly_requested = true;
+  queue.Push(first);
+  EXPECT_EQ(queue.size(), 2u);
+  EXPECT_EQ(PopUUID(&queue, kNow), first.uuid);
+  EXPECT_EQ(PopUUID(&queue, kNow), second.uuid);
+  EXPECT_EQ(queue.size(), 0u);
+}
+
+TEST(UploadQueue, BandsMatchExhaustiveSearch) {
+  UploadQueue queue((UploadQueue::Options()));
+
+  // Reports are spread from long before the recency window to the future, and
+  // popped as the clock moves, sometimes backwards, so that they move between
+  // bands. Each pop must choose a report with the best score of any.
+  std::mt19937 random(1);
+  std::vector<UploadQueue::Entry> remaining;
+  for (uint32_t id = 1; id <= 200; ++id) {
+    UploadQueue::Entry entry;
+    entry.uuid.data_1 = id;
+    entry.creation_time = kNow - 40 * kDay + random() % (42 * kDay);
+    entry.upload_explicitly_requested = random() % 10 == 0;
+    entry.priority = static_cast<int>(random() % 9) - 4;
+    entry.size = random() % (64 * 1024 * 1024);
+    queue.Push(entry);
+    remaining.push_back(entry);
+  }
+
+  time_t now = kNow - kDay;
+  while (!remaining.empty()) {
+    now += static_cast<time_t>(random() % (kDay / 2)) - kDay / 8;
+
+    auto best = remaining.begin();
+    for (auto it = remaining.begin() + 1; it != remaining.end(); ++it) {
+      if (it->upload_explicitly_requested !=
+              best->upload_explicitly_requested
+          ? it->upload_explicitly_requested
+          : queue.Score(*it, now) > queue.Score(*best, now)) {
+        best = it;
+      }
+    }
+
+    const UUID uuid = PopUUID(&queue, now);
+    auto popped = std::find_if(remaining.begin(),
+                               remaining.end(),
+                               [&uuid](const UploadQueue::Entry& entry) {
+                                 return entry.uuid == uuid;
+                               });
+    ASSERT_NE(popped, remaining.end());
+    EXPECT_EQ(popped->upload_explicitly_requested,
+              best->upload_explicitly_requested);
+    EXPECT_NEAR(queue.Score(*popped, now), queue.Score(*best, now), 1e-6);
+    remaining.erase(popped);
+    EXPECT_EQ(queue.size(), remaining.size());
+  }
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
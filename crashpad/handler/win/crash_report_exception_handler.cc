@@ -14,7 +14,9 @@
 
 #include "handler/win/crash_report_exception_handler.h"
 
+#include <memory>
 #include <type_traits>
+#include <utility>
 
 #include "client/crash_report_database.h"
 #include "client/settings.h"
@@ -112,7 +114,20 @@ unsigned int CrashReportExceptionHandler::ExceptionHandlerServerException(
     AddUserExtensionStreams(
         user_stream_data_sources_, &process_snapshot, &minidump);
 
-    if (!minidump.WriteEverything(&file_writer)) {
+    // If an early upload is in progress, the minidump is written through it,
+    // without seeking, so that it can be uploaded as it is written.
+    std::unique_ptr<CrashReportUploadThread::EarlyUpload> early_upload =
+        upload_thread_->StartEarlyUpload(
+            process_snapshot, *new_report, &file_writer);
+    const bool written =
+        early_upload
+            ? minidump.WriteMinidump(early_upload->file_writer(), false)
+            : minidump.WriteEverything(&file_writer);
+    if (early_upload) {
+      early_upload->Finish(written);
+    }
+
+    if (!written) {
       LOG(ERROR) << "WriteEverything failed";
       Metrics::ExceptionCaptureResult(
           Metrics::CaptureResult::kMinidumpWriteFailed);
@@ -130,7 +145,7 @@ unsigned int CrashReportExceptionHandler::ExceptionHandlerServerException(
       return termination_code;
     }
 
-    upload_thread_->ReportPending(uuid);
+    upload_thread_->ReportPending(uuid, std::move(early_upload));
   }
 
   Metrics::ExceptionCaptureResult(Metrics::CaptureResult::kSuccess);
@@ -38,10 +38,14 @@
         'minidump_context_writer.h',
         'minidump_crashpad_info_writer.cc',
         'minidump_crashpad_info_writer.h',
+        'minidump_deduplicated_memory_writer.cc',
+        'minidump_deduplicated_memory_writer.h',
         'minidump_exception_writer.cc',
         'minidump_exception_writer.h',
         'minidump_extensions.cc',
         'minidump_extensions.h',
+        'minidump_file_backed_memory_writer.cc',
+        'minidump_file_backed_memory_writer.h',
         'minidump_file_writer.cc',
         'minidump_file_writer.h',
         'minidump_handle_writer.cc',
@@ -70,6 +74,8 @@
         'minidump_thread_id_map.h',
         'minidump_thread_writer.cc',
         'minidump_thread_writer.h',
+        'minidump_triage_summary_writer.cc',
+        'minidump_triage_summary_writer.h',
         'minidump_unloaded_module_writer.cc',
         'minidump_unloaded_module_writer.h',
         'minidump_user_extension_stream_data_source.cc',
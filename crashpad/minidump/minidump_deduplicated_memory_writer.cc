@@ -0,0 +1,360 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "minidump/minidump_deduplicated_memory_writer.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/auto_reset.h"
+#include "base/logging.h"
+#include "util/file/file_writer.h"
+#include "util/numeric/safe_assignment.h"
+
+namespace crashpad {
+
+namespace {
+
+// A fast hash of a page, processing it 64 bits at a time in two independent
+// lanes. This need not be resistant to deliberate collisions, because a
+// process can only confuse its own minidump that way.
+internal::DeduplicatedMemoryPageHash HashPage(const uint8_t* page,
+                                              size_t size) {
+  DCHECK_EQ(size % sizeof(uint64_t), 0u);
+
+  uint64_t hash_1 = size;
+  uint64_t hash_2 = ~static_cast<uint64_t>(size);
+  for (size_t offset = 0; offset < size; offset += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, page + offset, sizeof(word));
+    hash_1 ^= word * 0x87c37b91114253d5;
+    hash_1 = ((hash_1 << 31) | (hash_1 >> 33)) * 0x4cf5ad432745937f;
+    hash_2 ^= word * 0x9e3779b185ebca87;
+    hash_2 = ((hash_2 << 27) | (hash_2 >> 37)) * 0xc2b2ae3d27d4eb4f;
+  }
+
+  hash_1 ^= hash_1 >> 33;
+  hash_1 *= 0xff51afd7ed558ccd;
+  hash_1 ^= hash_1 >> 33;
+  hash_2 ^= hash_2 >> 29;
+  hash_2 *= 0x165667b19e3779f9;
+  hash_2 ^= hash_2 >> 32;
+  return internal::DeduplicatedMemoryPageHash(hash_1, hash_2);
+}
+
+}  // namespace
+
+namespace internal {
+
+MinidumpDeduplicatedMemoryPageReferencesWriter::
+    MinidumpDeduplicatedMemoryPageReferencesWriter()
+    : MinidumpWritable(), page_references_() {}
+
+MinidumpDeduplicatedMemoryPageReferencesWriter::
+    ~MinidumpDeduplicatedMemoryPageReferencesWriter() {}
+
+size_t MinidumpDeduplicatedMemoryPageReferencesWriter::SizeOfObject() {
+  DCHECK_GE(state(), kStateFrozen);
+
+  return page_references_.size() * sizeof(page_references_[0]);
+}
+
+bool MinidumpDeduplicatedMemoryPageReferencesWriter::WriteObject(
+    FileWriterInterface* file_writer) {
+  DCHECK_EQ(state(), kStateWritable);
+
+  return page_references_.empty() ||
+         file_writer->Write(&page_references_[0],
+                            page_references_.size() *
+                                sizeof(page_references_[0]));
+}
+
+MinidumpDeduplicatedMemoryPagesWriter::MinidumpDeduplicatedMemoryPagesWriter()
+    : MinidumpWritable(),
+      MemorySnapshot::Delegate(),
+      pages_(),
+      writing_page_(0),
+      file_writer_(nullptr) {}
+
+MinidumpDeduplicatedMemoryPagesWriter::
+    ~MinidumpDeduplicatedMemoryPagesWriter() {}
+
+uint32_t MinidumpDeduplicatedMemoryPagesWriter::AddPage(
+    const MemorySnapshot* memory_snapshot,
+    size_t offset,
+    size_t size,
+    size_t page_offset,
+    const DeduplicatedMemoryPageHash& hash) {
+  DCHECK_LE(state(), kStateFrozen);
+  DCHECK_LE(page_offset + size,
+            MinidumpDeduplicatedMemoryListWriter::kPageSize);
+
+  Page page;
+  page.memory_snapshot = memory_snapshot;
+  page.offset = offset;
+  page.size = static_cast<uint32_t>(size);
+  page.page_offset = static_cast<uint32_t>(page_offset);
+  page.hash = hash;
+  pages_.push_back(page);
+  return static_cast<uint32_t>(pages_.size() - 1);
+}
+
+size_t MinidumpDeduplicatedMemoryPagesWriter::SizeOfObject() {
+  DCHECK_GE(state(), kStateFrozen);
+
+  return pages_.size() * MinidumpDeduplicatedMemoryListWriter::kPageSize;
+}
+
+bool MinidumpDeduplicatedMemoryPagesWriter::WriteObject(
+    FileWriterInterface* file_writer) {
+  DCHECK_EQ(state(), kStateWritable);
+  DCHECK(!file_writer_);
+
+  base::AutoReset<FileWriterInterface*> file_writer_reset(&file_writer_,
+                                                          file_writer);
+
+  // Each snapshot’s pages are consecutive, because they were added as the
+  // snapshots were read in turn.
+  writing_page_ = 0;
+  while (writing_page_ < pages_.size()) {
+    const size_t first_page = writing_page_;
+
+    // This will result in MemorySnapshotDelegateRead() being called.
+    if (!pages_[first_page].memory_snapshot->Read(this)) {
+      return false;
+    }
+    if (writing_page_ == first_page) {
+      LOG(ERROR) << "memory snapshot read nothing";
+      return false;
+    }
+  }
+
+  return true;
+}
+
+MinidumpWritable::Phase MinidumpDeduplicatedMemoryPagesWriter::WritePhase() {
+  return kPhaseLate;
+}
+
+bool MinidumpDeduplicatedMemoryPagesWriter::MemorySnapshotDelegateRead(
+    void* data,
+    size_t size) {
+  DCHECK_EQ(state(), kStateWritable);
+  DCHECK(file_writer_);
+
+  constexpr size_t kPageSize = MinidumpDeduplicatedMemoryListWriter::kPageSize;
+  const MemorySnapshot* memory_snapshot = pages_[writing_page_].memory_snapshot;
+  size_t end_page = writing_page_;
+  while (end_page < pages_.size() &&
+         pages_[end_page].memory_snapshot == memory_snapshot) {
+    ++end_page;
+  }
+
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  std::vector<uint8_t> buffer((end_page - writing_page_) * kPageSize);
+  bool changed = false;
+  for (size_t index = writing_page_; index < end_page; ++index) {
+    const Page& page = pages_[index];
+    if (page.offset + page.size > size) {
+      LOG(ERROR) << "memory snapshot shrank";
+      return false;
+    }
+
+    uint8_t* const page_data = &buffer[(index - writing_page_) * kPageSize];
+    memcpy(page_data + page.page_offset, bytes + page.offset, page.size);
+    changed |= HashPage(page_data, kPageSize) != page.hash;
+  }
+
+  // Other ranges may refer to a page that has changed, and would now appear
+  // to hold its new contents.
+  LOG_IF(WARNING, changed) << "memory changed after being deduplicated";
+
+  writing_page_ = end_page;
+  return file_writer_->Write(&buffer[0], buffer.size());
+}
+
+}  // namespace internal
+
+constexpr uint32_t MinidumpDeduplicatedMemoryListWriter::kPageSize;
+
+MinidumpDeduplicatedMemoryListWriter::MinidumpDeduplicatedMemoryListWriter()
+    : MinidumpStreamWriter(),
+      MemorySnapshot::Delegate(),
+      memory_list_base_(),
+      memory_snapshots_(),
+      ranges_(),
+      page_indices_(),
+      page_references_writer_(),
+      pages_writer_(),
+      reading_snapshot_(nullptr),
+      reading_range_(nullptr) {}
+
+MinidumpDeduplicatedMemoryListWriter::~MinidumpDeduplicatedMemoryListWriter() {
+}
+
+void MinidumpDeduplicatedMemoryListWriter::AddMemory(
+    const MemorySnapshot* memory_snapshot) {
+  DCHECK_EQ(state(), kStateMutable);
+
+  memory_snapshots_.push_back(memory_snapshot);
+}
+
+bool MinidumpDeduplicatedMemoryListWriter::IsUseful() const {
+  return !memory_snapshots_.empty();
+}
+
+bool MinidumpDeduplicatedMemoryListWriter::Freeze() {
+  DCHECK_EQ(state(), kStateMutable);
+
+  if (!MinidumpStreamWriter::Freeze()) {
+    return false;
+  }
+
+  std::vector<uint32_t>* page_references =
+      page_references_writer_.page_references();
+  ranges_.reserve(memory_snapshots_.size());
+  for (const MemorySnapshot* memory_snapshot : memory_snapshots_) {
+    MinidumpDeduplicatedMemoryRange range = {};
+    range.start_of_memory_range = memory_snapshot->Address();
+    range.data_size = memory_snapshot->Size();
+    if (!AssignIfInRange(&range.first_page_reference,
+                         page_references->size())) {
+      LOG(ERROR) << "page_reference_count " << page_references->size()
+                 << " out of range";
+      return false;
+    }
+    ranges_.push_back(range);
+
+    // This will result in MemorySnapshotDelegateRead() being called.
+    base::AutoReset<const MemorySnapshot*> reading_snapshot_reset(
+        &reading_snapshot_, memory_snapshot);
+    base::AutoReset<MinidumpDeduplicatedMemoryRange*> reading_range_reset(
+        &reading_range_, &ranges_.back());
+    if (!memory_snapshot->Read(this)) {
+      return false;
+    }
+  }
+
+  // The hashes are only needed while pages are being added.
+  page_indices_.clear();
+
+  memory_list_base_.version = MinidumpDeduplicatedMemoryList::kVersion;
+  memory_list_base_.page_size = kPageSize;
+  if (!AssignIfInRange(&memory_list_base_.page_count,
+                       pages_writer_.page_count()) ||
+      !AssignIfInRange(&memory_list_base_.page_reference_count,
+                       page_references->size()) ||
+      !AssignIfInRange(&memory_list_base_.range_count, ranges_.size())) {
+    LOG(ERROR) << "deduplicated memory list too large";
+    return false;
+  }
+
+  page_references_writer_.RegisterLocationDescriptor(
+      &memory_list_base_.page_references);
+  pages_writer_.RegisterLocationDescriptor(&memory_list_base_.pages);
+
+  return true;
+}
+
+size_t MinidumpDeduplicatedMemoryListWriter::SizeOfObject() {
+  DCHECK_GE(state(), kStateFrozen);
+
+  return sizeof(memory_list_base_) +
+         ranges_.size() * sizeof(MinidumpDeduplicatedMemoryRange);
+}
+
+std::vector<internal::MinidumpWritable*>
+MinidumpDeduplicatedMemoryListWriter::Children() {
+  DCHECK_GE(state(), kStateFrozen);
+
+  std::vector<MinidumpWritable*> children;
+  children.push_back(&page_references_writer_);
+  children.push_back(&pages_writer_);
+  return children;
+}
+
+bool MinidumpDeduplicatedMemoryListWriter::WriteObject(
+    FileWriterInterface* file_writer) {
+  DCHECK_EQ(state(), kStateWritable);
+
+  WritableIoVec iov;
+  iov.iov_base = &memory_list_base_;
+  iov.iov_len = sizeof(memory_list_base_);
+  std::vector<WritableIoVec> iovecs(1, iov);
+
+  if (!ranges_.empty()) {
+    iov.iov_base = &ranges_[0];
+    iov.iov_len = ranges_.size() * sizeof(ranges_[0]);
+    iovecs.push_back(iov);
+  }
+
+  return file_writer->WriteIoVec(&iovecs);
+}
+
+MinidumpStreamType MinidumpDeduplicatedMemoryListWriter::StreamType() const {
+  return kMinidumpStreamTypeCrashpadDeduplicatedMemoryList;
+}
+
+bool MinidumpDeduplicatedMemoryListWriter::MemorySnapshotDelegateRead(
+    void* data,
+    size_t size) {
+  DCHECK_EQ(state(), kStateFrozen);
+  DCHECK(reading_range_);
+  DCHECK_EQ(size, reading_range_->data_size);
+
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  const uint64_t address = reading_range_->start_of_memory_range;
+  uint8_t page[kPageSize];
+  size_t consumed = 0;
+  while (consumed < size) {
+    // Chunks are divided at page boundaries in the address space, so the first
+    // and last chunks may start or end partway through a page. Bytes outside
+    // the chunk are zeroed.
+    const size_t page_offset = (address + consumed) % kPageSize;
+    const size_t chunk_size =
+        std::min(kPageSize - page_offset, size - consumed);
+    if (chunk_size != kPageSize) {
+      memset(page, 0, sizeof(page));
+    }
+    memcpy(page + page_offset, bytes + consumed, chunk_size);
+    page_references_writer_.page_references()->push_back(
+        AddPage(page, consumed, chunk_size, page_offset));
+    ++reading_range_->page_reference_count;
+    consumed += chunk_size;
+  }
+
+  return true;
+}
+
+uint32_t MinidumpDeduplicatedMemoryListWriter::AddPage(const uint8_t* page,
+                                                       size_t offset,
+                                                       size_t size,
+                                                       size_t page_offset) {
+  const internal::DeduplicatedMemoryPageHash hash =
+      HashPage(page, kPageSize);
+  auto candidates = page_indices_.equal_range(hash.first);
+  for (auto it = candidates.first; it != candidates.second; ++it) {
+    if (pages_writer_.PageHash(it->second) == hash) {
+      return it->second;
+    }
+  }
+
+  const uint32_t index =
+      pages_writer_.AddPage(reading_snapshot_, offset, size, page_offset, hash);
+  page_indices_.insert(std::make_pair(hash.first, index));
+  return index;
+}
+
+}  // namespace crashpad
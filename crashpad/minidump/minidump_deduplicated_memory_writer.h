@@ -0,0 +1,232 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_MINIDUMP_MINIDUMP_DEDUPLICATED_MEMORY_WRITER_H_
+#define CRASHPAD_MINIDUMP_MINIDUMP_DEDUPLICATED_MEMORY_WRITER_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "base/macros.h"
+#include "minidump/minidump_extensions.h"
+#include "minidump/minidump_stream_writer.h"
+#include "minidump/minidump_writable.h"
+#include "snapshot/memory_snapshot.h"
+
+namespace crashpad {
+
+namespace internal {
+
+//! \brief The writer for the page references of a
+//!     MinidumpDeduplicatedMemoryList.
+//!
+//! This class is an implementation detail of
+//! MinidumpDeduplicatedMemoryListWriter.
+class MinidumpDeduplicatedMemoryPageReferencesWriter final
+    : public MinidumpWritable {
+ public:
+  MinidumpDeduplicatedMemoryPageReferencesWriter();
+  ~MinidumpDeduplicatedMemoryPageReferencesWriter() override;
+
+  //! \brief The page references to be written.
+  //!
+  //! \note Valid in #kStateMutable and #kStateFrozen.
+  std::vector<uint32_t>* page_references() { return &page_references_; }
+
+ protected:
+  // MinidumpWritable:
+  size_t SizeOfObject() override;
+  bool WriteObject(FileWriterInterface* file_writer) override;
+
+ private:
+  std::vector<uint32_t> page_references_;
+
+  DISALLOW_COPY_AND_ASSIGN(MinidumpDeduplicatedMemoryPageReferencesWriter);
+};
+
+//! \brief A hash of a page of memory, made of two independent 64-bit hashes.
+using DeduplicatedMemoryPageHash = std::pair<uint64_t, uint64_t>;
+
+//! \brief The writer for the unique pages of a MinidumpDeduplicatedMemoryList.
+//!
+//! This class is an implementation detail of
+//! MinidumpDeduplicatedMemoryListWriter.
+class MinidumpDeduplicatedMemoryPagesWriter final
+    : public MinidumpWritable,
+      public MemorySnapshot::Delegate {
+ public:
+  MinidumpDeduplicatedMemoryPagesWriter();
+  ~MinidumpDeduplicatedMemoryPagesWriter() override;
+
+  //! \brief Adds a page, whose contents are read from \a memory_snapshot when
+  //!     this object is written.
+  //!
+  //! Pages must be added in the order in which their contents are found in the
+  //! memory snapshots, so that each snapshot is read once when this object is
+  //! written.
+  //!
+  //! \param[in] memory_snapshot The memory snapshot holding the page’s
+  //!     contents. The caller retains ownership of this object, which must
+  //!     remain valid until this object is written.
+  //! \param[in] offset The offset of the page’s contents within the data read
+  //!     from \a memory_snapshot.
+  //! \param[in] size The number of bytes of the page’s contents found in
+  //!     \a memory_snapshot. The rest of the page is zeroed.
+  //! \param[in] page_offset The offset within the page at which the contents
+  //!     from \a memory_snapshot begin.
+  //! \param[in] hash The hash of the page, as zeroed and filled.
+  //!
+  //! \return The index of the page.
+  //!
+  //! \note Valid in #kStateMutable and #kStateFrozen.
+  uint32_t AddPage(const MemorySnapshot* memory_snapshot,
+                   size_t offset,
+                   size_t size,
+                   size_t page_offset,
+                   const DeduplicatedMemoryPageHash& hash);
+
+  //! \brief Returns the hash given to AddPage() for the page at \a index.
+  const DeduplicatedMemoryPageHash& PageHash(uint32_t index) const {
+    return pages_[index].hash;
+  }
+
+  //! \brief Returns the number of pages added by AddPage().
+  size_t page_count() const { return pages_.size(); }
+
+ protected:
+  // MinidumpWritable:
+  size_t SizeOfObject() override;
+  bool WriteObject(FileWriterInterface* file_writer) override;
+
+  //! \brief Returns the object’s desired write phase.
+  //!
+  //! Like the contents of other memory regions, pages are written at the end
+  //! of minidump files.
+  //!
+  //! \return #kPhaseLate.
+  Phase WritePhase() override;
+
+ private:
+  //! \brief Where the contents of a page are found.
+  struct Page {
+    const MemorySnapshot* memory_snapshot;  // weak
+    size_t offset;
+    uint32_t size;
+    uint32_t page_offset;
+    DeduplicatedMemoryPageHash hash;
+  };
+
+  // MemorySnapshot::Delegate:
+  bool MemorySnapshotDelegateRead(void* data, size_t size) override;
+
+  std::vector<Page> pages_;
+
+  // The page being written by MemorySnapshotDelegateRead(), the first from
+  // the snapshot being read.
+  size_t writing_page_;
+  FileWriterInterface* file_writer_;  // weak
+
+  DISALLOW_COPY_AND_ASSIGN(MinidumpDeduplicatedMemoryPagesWriter);
+};
+
+}  // namespace internal
+
+//! \brief The writer for a MinidumpDeduplicatedMemoryList stream in a minidump
+//!     file.
+//!
+//! The contents of memory snapshots added to this object are read when it is
+//! frozen. They are divided into pages, and each distinct page is stored once.
+//! Pages are matched by a fast non-cryptographic 128-bit hash. It is not
+//! resistant to deliberate collisions, but pages with different contents are
+//! otherwise vanishingly unlikely to be merged.
+//!
+//! Only the hash and location of each distinct page are held from the time
+//! this object is frozen. As with SnapshotMinidumpMemoryWriter, the memory
+//! snapshots are read again for their contents when this object is written.
+class MinidumpDeduplicatedMemoryListWriter final
+    : public internal::MinidumpStreamWriter,
+      public MemorySnapshot::Delegate {
+ public:
+  //! \brief The page size used to divide memory, MinidumpDeduplicatedMemoryList
+  //!     ::page_size.
+  static constexpr uint32_t kPageSize = 4096;
+
+  MinidumpDeduplicatedMemoryListWriter();
+  ~MinidumpDeduplicatedMemoryListWriter() override;
+
+  //! \brief Adds a memory snapshot whose contents are to be stored.
+  //!
+  //! \param[in] memory_snapshot The memory snapshot. The caller retains
+  //!     ownership of this object, which must remain valid until this object
+  //!     is written.
+  //!
+  //! \note Valid in #kStateMutable.
+  void AddMemory(const MemorySnapshot* memory_snapshot);
+
+  //! \brief Determines whether the object is useful.
+  //!
+  //! A useful object is one that carries data that makes a meaningful
+  //! contribution to a minidump file. An object carrying memory ranges would be
+  //! considered useful.
+  //!
+  //! \return `true` if the object is useful, `false` otherwise.
+  bool IsUseful() const;
+
+ protected:
+  // MinidumpWritable:
+  bool Freeze() override;
+  size_t SizeOfObject() override;
+  std::vector<internal::MinidumpWritable*> Children() override;
+  bool WriteObject(FileWriterInterface* file_writer) override;
+
+  // MinidumpStreamWriter:
+  MinidumpStreamType StreamType() const override;
+
+ private:
+  // MemorySnapshot::Delegate:
+  bool MemorySnapshotDelegateRead(void* data, size_t size) override;
+
+  // Returns the index of the page with the contents of |page|, adding it if no
+  // such page has been stored yet. The remaining arguments are passed to
+  // MinidumpDeduplicatedMemoryPagesWriter::AddPage().
+  uint32_t AddPage(const uint8_t* page,
+                   size_t offset,
+                   size_t size,
+                   size_t page_offset);
+
+  MinidumpDeduplicatedMemoryList memory_list_base_;
+  std::vector<const MemorySnapshot*> memory_snapshots_;  // weak
+  std::vector<MinidumpDeduplicatedMemoryRange> ranges_;
+
+  // Maps the first half of page hashes to indices of pages with that hash.
+  std::unordered_multimap<uint64_t, uint32_t> page_indices_;
+
+  internal::MinidumpDeduplicatedMemoryPageReferencesWriter
+      page_references_writer_;
+  internal::MinidumpDeduplicatedMemoryPagesWriter pages_writer_;
+
+  // The snapshot and range being read by MemorySnapshotDelegateRead().
+  const MemorySnapshot* reading_snapshot_;  // weak
+  MinidumpDeduplicatedMemoryRange* reading_range_;
+
+  DISALLOW_COPY_AND_ASSIGN(MinidumpDeduplicatedMemoryListWriter);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_MINIDUMP_MINIDUMP_DEDUPLICATED_MEMORY_WRITER_H_
@@ -0,0 +1,344 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "minidump/minidump_deduplicated_memory_writer.h"
+
+#include <string.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/memory/ptr_util.h"
+#include "gtest/gtest.h"
+#include "minidump/minidump_extensions.h"
+#include "minidump/minidump_file_writer.h"
+#include "minidump/minidump_memory_writer.h"
+#include "minidump/test/minidump_file_writer_test_util.h"
+#include "minidump/test/minidump_writable_test_util.h"
+#include "snapshot/test/test_memory_snapshot.h"
+#include "util/file/string_file.h"
+#include "util/stdlib/pointer_container.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+constexpr uint32_t kPageSize = MinidumpDeduplicatedMemoryListWriter::kPageSize;
+
+// A memory snapshot that counts how many times it has been read, and that can
+// fail reads after the first.
+class CountingMemorySnapshot final : public MemorySnapshot {
+ public:
+  CountingMemorySnapshot(uint64_t address, size_t size, char value)
+      : address_(address),
+        size_(size),
+        value_(value),
+        reads_(0),
+        fail_later_reads_(false) {}
+  ~CountingMemorySnapshot() {}
+
+  int reads() const { return reads_; }
+  void SetFailLaterReads() { fail_later_reads_ = true; }
+
+  // MemorySnapshot:
+  uint64_t Address() const override { return address_; }
+  size_t Size() const override { return size_; }
+  bool Read(Delegate* delegate) const override {
+    if (reads_++ > 0 && fail_later_reads_) {
+      return false;
+    }
+    std::string buffer(size_, value_);
+    return delegate->MemorySnapshotDelegateRead(&buffer[0], buffer.size());
+  }
+
+ private:
+  uint64_t address_;
+  size_t size_;
+  char value_;
+  mutable int reads_;
+  bool fail_later_reads_;
+
+  DISALLOW_COPY_AND_ASSIGN(CountingMemorySnapshot);
+};
+
+const MinidumpDeduplicatedMemoryList* GetDeduplicatedMemoryListStream(
+    const std::string& file_contents,
+    uint32_t expected_streams) {
+  const MINIDUMP_DIRECTORY* directory;
+  const MINIDUMP_HEADER* header =
+      MinidumpHeaderAtStart(file_contents, &directory);
+  EXPECT_NO_FATAL_FAILURE(VerifyMinidumpHeader(header, expected_streams, 0));
+  if (!directory) {
+    return nullptr;
+  }
+
+  for (uint32_t index = 0; index < expected_streams; ++index) {
+    if (directory[index].StreamType ==
+        kMinidumpStreamTypeCrashpadDeduplicatedMemoryList) {
+      return MinidumpWritableAtLocationDescriptor<
+          MinidumpDeduplicatedMemoryList>(file_contents,
+                                          directory[index].Location);
+    }
+  }
+
+  ADD_FAILURE() << "no deduplicated memory list stream";
+  return nullptr;
+}
+
+std::vector<uint32_t> PageReferences(
+    const std::string& file_contents,
+    const MinidumpDeduplicatedMemoryList* list) {
+  std::vector<uint32_t> page_references(list->page_reference_count);
+  EXPECT_EQ(list->page_references.DataSize,
+            page_references.size() * sizeof(uint32_t));
+  EXPECT_LE(list->page_references.Rva + list->page_references.DataSize,
+            file_contents.size());
+  if (!page_references.empty()) {
+    memcpy(&page_references[0],
+           &file_contents[list->page_references.Rva],
+           list->page_references.DataSize);
+  }
+  return page_references;
+}
+
+std::string Page(const std::string& file_contents,
+                 const MinidumpDeduplicatedMemoryList* list,
+                 uint32_t index) {
+  EXPECT_LT(index, list->page_count);
+  EXPECT_EQ(list->pages.DataSize, list->page_count * kPageSize);
+  return file_contents.substr(list->pages.Rva + index * kPageSize, kPageSize);
+}
+
+TEST(MinidumpDeduplicatedMemoryListWriter, Empty) {
+  auto list_writer =
+      base::WrapUnique(new MinidumpDeduplicatedMemoryListWriter());
+  EXPECT_FALSE(list_writer->IsUseful());
+
+  MinidumpFileWriter minidump_file_writer;
+  ASSERT_TRUE(minidump_file_writer.AddStream(std::move(list_writer)));
+
+  StringFile string_file;
+  ASSERT_TRUE(minidump_file_writer.WriteEverything(&string_file));
+
+  const MinidumpDeduplicatedMemoryList* list =
+      GetDeduplicatedMemoryListStream(string_file.string(), 1);
+  ASSERT_TRUE(list);
+  EXPECT_EQ(list->version, MinidumpDeduplicatedMemoryList::kVersion);
+  EXPECT_EQ(list->page_size, kPageSize);
+  EXPECT_EQ(list->page_count, 0u);
+  EXPECT_EQ(list->page_reference_count, 0u);
+  EXPECT_EQ(list->pages.DataSize, 0u);
+  EXPECT_EQ(list->range_count, 0u);
+}
+
+TEST(MinidumpDeduplicatedMemoryListWriter, Pages) {
+  TestMemorySnapshot memory_a;
+  memory_a.SetAddress(0x10000);
+  memory_a.SetSize(3 * kPageSize);
+  memory_a.SetValue('a');
+
+  // Identical in content to memory_a’s pages.
+  TestMemorySnapshot memory_b;
+  memory_b.SetAddress(0x20000);
+  memory_b.SetSize(2 * kPageSize);
+  memory_b.SetValue('a');
+
+  // Straddles a page boundary, so it occupies parts of two pages.
+  TestMemorySnapshot memory_c;
+  memory_c.SetAddress(0x30000 + kPageSize / 2);
+  memory_c.SetSize(kPageSize);
+  memory_c.SetValue('c');
+
+  TestMemorySnapshot memory_d;
+  memory_d.SetAddress(0x40000);
+  memory_d.SetSize(0);
+
+  auto list_writer =
+      base::WrapUnique(new MinidumpDeduplicatedMemoryListWriter());
+  list_writer->AddMemory(&memory_a);
+  list_writer->AddMemory(&memory_b);
+  list_writer->AddMemory(&memory_c);
+  list_writer->AddMemory(&memory_d);
+  EXPECT_TRUE(list_writer->IsUseful());
+
+  MinidumpFileWriter minidump_file_writer;
+  ASSERT_TRUE(minidump_file_writer.AddStream(std::move(list_writer)));
+
+  StringFile string_file;
+  ASSERT_TRUE(minidump_file_writer.WriteEverything(&string_file));
+  const std::string& file_contents = string_file.string();
+
+  const MinidumpDeduplicatedMemoryList* list =
+      GetDeduplicatedMemoryListStream(file_contents, 1);
+  ASSERT_TRUE(list);
+  EXPECT_EQ(list->version, MinidumpDeduplicatedMemoryList::kVersion);
+  EXPECT_EQ(list->page_size, kPageSize);
+  ASSERT_EQ(list->range_count, 4u);
+
+  EXPECT_EQ(list->ranges[0].start_of_memory_range, 0x10000u);
+  EXPECT_EQ(list->ranges[0].data_size, 3 * kPageSize);
+  EXPECT_EQ(list->ranges[0].first_page_reference, 0u);
+  EXPECT_EQ(list->ranges[0].page_reference_count, 3u);
+
+  EXPECT_EQ(list->ranges[1].start_of_memory_range, 0x20000u);
+  EXPECT_EQ(list->ranges[1].data_size, 2 * kPageSize);
+  EXPECT_EQ(list->ranges[1].first_page_reference, 3u);
+  EXPECT_EQ(list->ranges[1].page_reference_count, 2u);
+
+  EXPECT_EQ(list->ranges[2].start_of_memory_range, 0x30000u + kPageSize / 2);
+  EXPECT_EQ(list->ranges[2].data_size, kPageSize);
+  EXPECT_EQ(list->ranges[2].first_page_reference, 5u);
+  EXPECT_EQ(list->ranges[2].page_reference_count, 2u);
+
+  EXPECT_EQ(list->ranges[3].start_of_memory_range, 0x40000u);
+  EXPECT_EQ(list->ranges[3].data_size, 0u);
+  EXPECT_EQ(list->ranges[3].first_page_reference, 7u);
+  EXPECT_EQ(list->ranges[3].page_reference_count, 0u);
+
+  // All five pages of 'a' share a single stored page.
+  ASSERT_EQ(list->page_count, 3u);
+  ASSERT_EQ(list->page_reference_count, 7u);
+  EXPECT_EQ(PageReferences(file_contents, list),
+            std::vector<uint32_t>({0, 0, 0, 0, 0, 1, 2}));
+
+  EXPECT_EQ(Page(file_contents, list, 0), std::string(kPageSize, 'a'));
+  EXPECT_EQ(Page(file_contents, list, 1),
+            std::string(kPageSize / 2, '\0') + std::string(kPageSize / 2, 'c'));
+  EXPECT_EQ(Page(file_contents, list, 2),
+            std::string(kPageSize / 2, 'c') + std::string(kPageSize / 2, '\0'));
+}
+
+TEST(MinidumpDeduplicatedMemoryListWriter, PagesReadWhenWritten) {
+  // Pages aren’t kept from the time that they’re deduplicated, so each
+  // snapshot holding a unique page is read again when the pages are written.
+  // memory_b holds no unique page, so it is only read once.
+  CountingMemorySnapshot memory_a(0x10000, 2 * kPageSize, 'a');
+  CountingMemorySnapshot memory_b(0x20000, kPageSize, 'a');
+  CountingMemorySnapshot memory_c(0x30000, kPageSize, 'c');
+
+  auto list_writer =
+      base::WrapUnique(new MinidumpDeduplicatedMemoryListWriter());
+  list_writer->AddMemory(&memory_a);
+  list_writer->AddMemory(&memory_b);
+  list_writer->AddMemory(&memory_c);
+
+  MinidumpFileWriter minidump_file_writer;
+  ASSERT_TRUE(minidump_file_writer.AddStream(std::move(list_writer)));
+
+  StringFile string_file;
+  ASSERT_TRUE(minidump_file_writer.WriteEverything(&string_file));
+  EXPECT_EQ(memory_a.reads(), 2);
+  EXPECT_EQ(memory_b.reads(), 1);
+  EXPECT_EQ(memory_c.reads(), 2);
+
+  const std::string& file_contents = string_file.string();
+  const MinidumpDeduplicatedMemoryList* list =
+      GetDeduplicatedMemoryListStream(file_contents, 1);
+  ASSERT_TRUE(list);
+  ASSERT_EQ(list->page_count, 2u);
+  EXPECT_EQ(PageReferences(file_contents, list),
+            std::vector<uint32_t>({0, 0, 0, 1}));
+  EXPECT_EQ(Page(file_contents, list, 0), std::string(kPageSize, 'a'));
+  EXPECT_EQ(Page(file_contents, list, 1), std::string(kPageSize, 'c'));
+}
+
+TEST(MinidumpDeduplicatedMemoryListWriter, ReadFailsWhenWritten) {
+  CountingMemorySnapshot memory(0x10000, kPageSize, 'a');
+  memory.SetFailLaterReads();
+
+  auto list_writer =
+      base::WrapUnique(new MinidumpDeduplicatedMemoryListWriter());
+  list_writer->AddMemory(&memory);
+
+  MinidumpFileWriter minidump_file_writer;
+  ASSERT_TRUE(minidump_file_writer.AddStream(std::move(list_writer)));
+
+  StringFile string_file;
+  EXPECT_FALSE(minidump_file_writer.WriteEverything(&string_file));
+  EXPECT_EQ(memory.reads(), 2);
+}
+
+TEST(MinidumpDeduplicatedMemoryListWriter, MemoryListAddFromSnapshot) {
+  struct {
+    uint64_t address;
+    size_t size;
+    char value;
+  } const kSnapshots[] = {
+      {0x10000, kPageSize, 'a'},
+      {0x20000, 2 * kPageSize, 'a'},
+      {0x30000, 0x100, 'b'},
+  };
+
+  PointerVector<TestMemorySnapshot> memory_snapshots_owner;
+  std::vector<const MemorySnapshot*> memory_snapshots;
+  for (const auto& snapshot : kSnapshots) {
+    TestMemorySnapshot* memory_snapshot = new TestMemorySnapshot();
+    memory_snapshots_owner.push_back(memory_snapshot);
+    memory_snapshot->SetAddress(snapshot.address);
+    memory_snapshot->SetSize(snapshot.size);
+    memory_snapshot->SetValue(snapshot.value);
+    memory_snapshots.push_back(memory_snapshot);
+  }
+
+  auto list_writer =
+      base::WrapUnique(new MinidumpDeduplicatedMemoryListWriter());
+  auto memory_list_writer = base::WrapUnique(new MinidumpMemoryListWriter());
+  memory_list_writer->SetDeduplicatedMemoryListWriter(list_writer.get());
+  memory_list_writer->AddFromSnapshot(memory_snapshots);
+
+  MinidumpFileWriter minidump_file_writer;
+  ASSERT_TRUE(minidump_file_writer.AddStream(std::move(list_writer)));
+  ASSERT_TRUE(minidump_file_writer.AddStream(std::move(memory_list_writer)));
+
+  StringFile string_file;
+  ASSERT_TRUE(minidump_file_writer.WriteEverything(&string_file));
+
+  // The memory list still describes every range, but carries none of its
+  // contents.
+  const MINIDUMP_DIRECTORY* directory;
+  const MINIDUMP_HEADER* header =
+      MinidumpHeaderAtStart(string_file.string(), &directory);
+  ASSERT_NO_FATAL_FAILURE(VerifyMinidumpHeader(header, 2, 0));
+  ASSERT_TRUE(directory);
+  ASSERT_EQ(directory[1].StreamType, kMinidumpStreamTypeMemoryList);
+  const MINIDUMP_MEMORY_LIST* memory_list =
+      MinidumpWritableAtLocationDescriptor<MINIDUMP_MEMORY_LIST>(
+          string_file.string(), directory[1].Location);
+  ASSERT_TRUE(memory_list);
+  ASSERT_EQ(memory_list->NumberOfMemoryRanges, arraysize(kSnapshots));
+  for (size_t index = 0; index < arraysize(kSnapshots); ++index) {
+    SCOPED_TRACE(index);
+    EXPECT_EQ(memory_list->MemoryRanges[index].StartOfMemoryRange,
+              kSnapshots[index].address);
+    EXPECT_EQ(memory_list->MemoryRanges[index].Memory.DataSize, 0u);
+  }
+
+  const MinidumpDeduplicatedMemoryList* list =
+      GetDeduplicatedMemoryListStream(string_file.string(), 2);
+  ASSERT_TRUE(list);
+  ASSERT_EQ(list->range_count, arraysize(kSnapshots));
+  for (size_t index = 0; index < arraysize(kSnapshots); ++index) {
+    SCOPED_TRACE(index);
+    EXPECT_EQ(list->ranges[index].start_of_memory_range,
+              kSnapshots[index].address);
+    EXPECT_EQ(list->ranges[index].data_size, kSnapshots[index].size);
+  }
+  EXPECT_EQ(list->page_count, 2u);
+  EXPECT_EQ(list->page_reference_count, 4u);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
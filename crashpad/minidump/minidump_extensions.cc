@@ -18,5 +18,10 @@ namespace crashpad {
 
 constexpr uint32_t MinidumpModuleCrashpadInfo::kVersion;
 constexpr uint32_t MinidumpCrashpadInfo::kVersion;
+constexpr uint32_t MinidumpFileBackedMemoryList::kVersion;
+constexpr uint32_t MinidumpDeduplicatedMemoryList::kVersion;
+constexpr uint32_t MinidumpTriageFrame::kNoModule;
+constexpr uint32_t MinidumpTriageSummary::kVersion;
+constexpr uint32_t MinidumpTriageSummary::kFlagHasException;
 
 }  // namespace crashpad
@@ -66,6 +66,11 @@ enum MinidumpStreamType : uint32_t {
   //! \sa ExceptionStream
   kMinidumpStreamTypeException = ExceptionStream,
 
+  //! \brief The stream type for MINIDUMP_MEMORY64_LIST.
+  //!
+  //! \sa Memory64ListStream
+  kMinidumpStreamTypeMemory64List = Memory64ListStream,
+
   //! \brief The stream type for MINIDUMP_SYSTEM_INFO.
   //!
   //! \sa SystemInfoStream
@@ -96,6 +101,15 @@ enum MinidumpStreamType : uint32_t {
 
   //! \brief The stream type for MinidumpCrashpadInfo.
   kMinidumpStreamTypeCrashpadInfo = 0x43500001,
+
+  //! \brief The stream type for MinidumpFileBackedMemoryList.
+  kMinidumpStreamTypeCrashpadFileBackedMemoryList = 0x43500002,
+
+  //! \brief The stream type for MinidumpDeduplicatedMemoryList.
+  kMinidumpStreamTypeCrashpadDeduplicatedMemoryList = 0x43500003,
+
+  //! \brief The stream type for MinidumpTriageSummary.
+  kMinidumpStreamTypeCrashpadTriageSummary = 0x43500004,
 };
 
 //! \brief A variable-length UTF-8-encoded string carried within a minidump
@@ -271,6 +285,273 @@ struct ALIGNAS(4) PACKED MinidumpSimpleStringDictionary {
   MinidumpSimpleStringDictionaryEntry entries[0];
 };
 
+//! \brief A range of memory whose contents were not written to the minidump
+//!     file because they are identical to a range of a file.
+struct ALIGNAS(4) PACKED MinidumpFileBackedMemoryDescriptor {
+  //! \brief The base address of the memory range in the address space of the
+  //!     process that the minidump file contains a snapshot of.
+  uint64_t start_of_memory_range;
+
+  //! \brief The size of the memory range.
+  uint64_t data_size;
+
+  //! \brief The offset within the file at which the contents of the memory
+  //!     range begin.
+  uint64_t file_offset;
+
+  //! \brief ::RVA of a MinidumpUTF8String containing the name of the file, as
+  //!     known to the process that the minidump file contains a snapshot of.
+  RVA file_name;
+};
+
+//! \brief A list of memory ranges whose contents were not written to the
+//!     minidump file because they are identical to ranges of files.
+//!
+//! Memory ranges listed here do not appear in the memory list stream
+//! (::kMinidumpStreamTypeMemoryList). A reader that has the files, such as a
+//! symbol server that has the modules loaded by the process, can rebuild their
+//! contents.
+//!
+//! This structure is versioned. When changing this structure, leave the
+//! existing structure intact so that earlier parsers will be able to understand
+//! the fields they are aware of, and make additions at the end of the
+//! structure. Revise #kVersion and document each field’s validity based on
+//! #version, so that newer parsers will be able to determine whether the added
+//! fields are valid or not.
+struct ALIGNAS(4) PACKED MinidumpFileBackedMemoryList {
+  //! \brief The structure’s currently-defined version number.
+  //!
+  //! \sa version
+  static constexpr uint32_t kVersion = 1;
+
+  //! \brief The structure’s version number.
+  //!
+  //! Readers can use this field to determine which other fields in the
+  //! structure are valid. Upon encountering a value greater than #kVersion, a
+  //! reader should assume that the structure’s layout is compatible with the
+  //! structure defined as having value #kVersion.
+  //!
+  //! Writers may produce values less than #kVersion in this field if there is
+  //! no need for any fields present in later versions.
+  uint32_t version;
+
+  //! \brief The number of memory ranges present in the #ranges array.
+  //!
+  //! This field is present when #version is at least `1`.
+  uint32_t count;
+
+  //! \brief The memory ranges.
+  //!
+  //! This field is present when #version is at least `1`.
+  MinidumpFileBackedMemoryDescriptor ranges[0];
+};
+
+//! \brief A range of memory whose contents are carried in a
+//!     MinidumpDeduplicatedMemoryList.
+//!
+//! The range is divided into chunks at multiples of
+//! MinidumpDeduplicatedMemoryList::page_size in the address space of the
+//! process that the minidump file contains a snapshot of. Only the first and
+//! last chunks may be smaller than a page. Each chunk is described by a page
+//! reference. A chunk’s contents are found in the referenced page at the same
+//! offset within the page as the chunk has within its page of address space.
+struct ALIGNAS(4) PACKED MinidumpDeduplicatedMemoryRange {
+  //! \brief The base address of the memory range.
+  uint64_t start_of_memory_range;
+
+  //! \brief The size of the memory range.
+  uint64_t data_size;
+
+  //! \brief The index of the range’s first chunk’s page reference within
+  //!     MinidumpDeduplicatedMemoryList::page_references.
+  uint32_t first_page_reference;
+
+  //! \brief The number of chunks in the range, and thus the number of
+  //!     consecutive page references describing it.
+  uint32_t page_reference_count;
+};
+
+//! \brief Memory ranges whose contents are stored as deduplicated pages.
+//!
+//! Identical pages, such as those found in the stacks of idle threads or in
+//! data captured by overlapping ranges, are stored once. Memory ranges carried
+//! in this structure also appear in the memory list stream
+//! (::kMinidumpStreamTypeMemoryList), and as thread stacks in the thread list
+//! stream (::kMinidumpStreamTypeThreadList), with their addresses but with no
+//! data.
+//!
+//! This structure is versioned. When changing this structure, leave the
+//! existing structure intact so that earlier parsers will be able to understand
+//! the fields they are aware of, and make additions at the end of the
+//! structure. Revise #kVersion and document each field’s validity based on
+//! #version, so that newer parsers will be able to determine whether the added
+//! fields are valid or not.
+struct ALIGNAS(4) PACKED MinidumpDeduplicatedMemoryList {
+  //! \brief The structure’s currently-defined version number.
+  //!
+  //! \sa version
+  static constexpr uint32_t kVersion = 1;
+
+  //! \brief The structure’s version number.
+  //!
+  //! Readers can use this field to determine which other fields in the
+  //! structure are valid. Upon encountering a value greater than #kVersion, a
+  //! reader should assume that the structure’s layout is compatible with the
+  //! structure defined as having value #kVersion.
+  //!
+  //! Writers may produce values less than #kVersion in this field if there is
+  //! no need for any fields present in later versions.
+  uint32_t version;
+
+  //! \brief The size of each page, in bytes.
+  //!
+  //! This field is present when #version is at least `1`.
+  uint32_t page_size;
+
+  //! \brief The number of unique pages present in #pages.
+  //!
+  //! This field is present when #version is at least `1`.
+  uint32_t page_count;
+
+  //! \brief The number of page references present in #page_references.
+  //!
+  //! This field is present when #version is at least `1`.
+  uint32_t page_reference_count;
+
+  //! \brief An array of `uint32_t` indices into #pages.
+  //!
+  //! This field is present when #version is at least `1`.
+  MINIDUMP_LOCATION_DESCRIPTOR page_references;
+
+  //! \brief The contents of the unique pages, #page_size bytes each.
+  //!
+  //! This field is present when #version is at least `1`.
+  MINIDUMP_LOCATION_DESCRIPTOR pages;
+
+  //! \brief The number of memory ranges present in the #ranges array.
+  //!
+  //! This field is present when #version is at least `1`.
+  uint32_t range_count;
+
+  //! \brief The memory ranges.
+  //!
+  //! This field is present when #version is at least `1`.
+  MinidumpDeduplicatedMemoryRange ranges[0];
+};
+
+//! \brief A stack frame in a MinidumpTriageSummary.
+struct ALIGNAS(4) PACKED MinidumpTriageFrame {
+  //! \brief The value of #module_name_offset for a frame whose address is not
+  //!     within any module.
+  static constexpr uint32_t kNoModule = 0xffffffff;
+
+  //! \brief The offset within the summary’s string data of the `NUL`-terminated
+  //!     base name of the module containing the frame’s address, or #kNoModule.
+  uint32_t module_name_offset;
+
+  //! \brief The frame’s address relative to the base address of its module,
+  //!     or the frame’s absolute address if #module_name_offset is #kNoModule.
+  uint64_t address;
+};
+
+//! \brief An annotation in a MinidumpTriageSummary.
+struct ALIGNAS(4) PACKED MinidumpTriageAnnotation {
+  //! \brief The offset within the summary’s string data of the annotation’s
+  //!     `NUL`-terminated key.
+  uint32_t key_offset;
+
+  //! \brief The offset within the summary’s string data of the annotation’s
+  //!     `NUL`-terminated value.
+  uint32_t value_offset;
+};
+
+//! \brief A compact summary of a crash, for readers that need to classify a
+//!     minidump file without parsing it in full.
+//!
+//! MinidumpFileWriter writes this stream immediately following the stream
+//! directory, so that it can be found within the first few kilobytes of the
+//! file. Unlike most other minidump structures, it carries no RVAs. All of its
+//! data is contained within the stream, in this order:
+//!  - This structure.
+//!  - #frame_count MinidumpTriageFrame structures.
+//!  - #annotation_count MinidumpTriageAnnotation structures.
+//!  - #string_data_size bytes of `NUL`-terminated UTF-8 strings, referenced by
+//!    offset from the start of this string data.
+//!
+//! This structure is versioned. When changing this structure, leave the
+//! existing structure intact so that earlier parsers will be able to understand
+//! the fields they are aware of, and make additions at the end of the
+//! structure. Revise #kVersion and document each field’s validity based on
+//! #version, so that newer parsers will be able to determine whether the added
+//! fields are valid or not.
+struct ALIGNAS(4) PACKED MinidumpTriageSummary {
+  //! \brief The structure’s currently-defined version number.
+  //!
+  //! \sa version
+  static constexpr uint32_t kVersion = 1;
+
+  //! \brief Set in #flags when the minidump file contains an exception.
+  static constexpr uint32_t kFlagHasException = 1 << 0;
+
+  //! \brief The structure’s version number.
+  //!
+  //! Readers can use this field to determine which other fields in the
+  //! structure are valid. Upon encountering a value greater than #kVersion, a
+  //! reader should assume that the structure’s layout is compatible with the
+  //! structure defined as having value #kVersion.
+  //!
+  //! Writers may produce values less than #kVersion in this field if there is
+  //! no need for any fields present in later versions.
+  uint32_t version;
+
+  //! \brief A bitfield of `kFlag*` values.
+  //!
+  //! This field is present when #version is at least `1`.
+  uint32_t flags;
+
+  //! \brief The exception code, as in MINIDUMP_EXCEPTION::ExceptionCode.
+  //!
+  //! This field is present when #version is at least `1`. It is `0` if
+  //! #kFlagHasException is not set in #flags.
+  uint32_t exception_code;
+
+  //! \brief The exception address, as in
+  //!     MINIDUMP_EXCEPTION::ExceptionAddress.
+  //!
+  //! This field is present when #version is at least `1`. It is `0` if
+  //! #kFlagHasException is not set in #flags.
+  uint64_t exception_address;
+
+  //! \brief A hash identifying the crash, computed from #exception_code and the
+  //!     module names and module-relative addresses of the frames.
+  //!
+  //! Crashes with the same exception at the same code locations have the same
+  //! hash, regardless of where their modules were loaded. The hash is 64-bit
+  //! FNV-1a over the little-endian exception code followed by, for each frame,
+  //! the module’s base name, a `NUL` byte, and the little-endian 64-bit
+  //! module-relative address. Frames that are not within any module
+  //! contribute only a `NUL` byte.
+  //!
+  //! This field is present when #version is at least `1`.
+  uint64_t signature_hash;
+
+  //! \brief The number of frames, starting with the exception’s instruction
+  //!     pointer.
+  //!
+  //! This field is present when #version is at least `1`.
+  uint32_t frame_count;
+
+  //! \brief The number of annotations.
+  //!
+  //! This field is present when #version is at least `1`.
+  uint32_t annotation_count;
+
+  //! \brief The size of the string data, in bytes.
+  //!
+  //! This field is present when #version is at least `1`.
+  uint32_t string_data_size;
+};
+
 //! \brief Additional Crashpad-specific information about a module carried
 //!     within a minidump file.
 //!
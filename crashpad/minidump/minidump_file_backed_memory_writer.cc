@@ -0,0 +1,128 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "minidump/minidump_file_backed_memory_writer.h"
+
+#include <utility>
+
+#include "base/logging.h"
+#include "util/file/file_writer.h"
+#include "util/numeric/safe_assignment.h"
+
+namespace crashpad {
+
+MinidumpFileBackedMemoryListWriter::MinidumpFileBackedMemoryListWriter()
+    : MinidumpStreamWriter(),
+      file_backed_memory_list_base_(),
+      descriptors_(),
+      descriptor_file_names_(),
+      file_name_indices_(),
+      file_names_() {}
+
+MinidumpFileBackedMemoryListWriter::~MinidumpFileBackedMemoryListWriter() {}
+
+void MinidumpFileBackedMemoryListWriter::AddRange(
+    uint64_t address,
+    uint64_t size,
+    const std::string& file_name,
+    uint64_t file_offset) {
+  DCHECK_EQ(state(), kStateMutable);
+
+  auto result = file_name_indices_.insert(
+      std::make_pair(file_name, file_names_.size()));
+  if (result.second) {
+    internal::MinidumpUTF8StringWriter* file_name_writer =
+        new internal::MinidumpUTF8StringWriter();
+    file_name_writer->SetUTF8(file_name);
+    file_names_.push_back(file_name_writer);
+  }
+
+  MinidumpFileBackedMemoryDescriptor descriptor = {};
+  descriptor.start_of_memory_range = address;
+  descriptor.data_size = size;
+  descriptor.file_offset = file_offset;
+  descriptors_.push_back(descriptor);
+  descriptor_file_names_.push_back(result.first->second);
+}
+
+bool MinidumpFileBackedMemoryListWriter::IsUseful() const {
+  return !descriptors_.empty();
+}
+
+bool MinidumpFileBackedMemoryListWriter::Freeze() {
+  DCHECK_EQ(state(), kStateMutable);
+
+  if (!MinidumpStreamWriter::Freeze()) {
+    return false;
+  }
+
+  file_backed_memory_list_base_.version =
+      MinidumpFileBackedMemoryList::kVersion;
+
+  size_t range_count = descriptors_.size();
+  if (!AssignIfInRange(&file_backed_memory_list_base_.count, range_count)) {
+    LOG(ERROR) << "range_count " << range_count << " out of range";
+    return false;
+  }
+
+  for (size_t index = 0; index < descriptors_.size(); ++index) {
+    file_names_[descriptor_file_names_[index]]->RegisterRVA(
+        &descriptors_[index].file_name);
+  }
+
+  return true;
+}
+
+size_t MinidumpFileBackedMemoryListWriter::SizeOfObject() {
+  DCHECK_GE(state(), kStateFrozen);
+
+  return sizeof(file_backed_memory_list_base_) +
+         descriptors_.size() * sizeof(MinidumpFileBackedMemoryDescriptor);
+}
+
+std::vector<internal::MinidumpWritable*>
+MinidumpFileBackedMemoryListWriter::Children() {
+  DCHECK_GE(state(), kStateFrozen);
+
+  std::vector<MinidumpWritable*> children;
+  for (internal::MinidumpUTF8StringWriter* file_name : file_names_) {
+    children.push_back(file_name);
+  }
+
+  return children;
+}
+
+bool MinidumpFileBackedMemoryListWriter::WriteObject(
+    FileWriterInterface* file_writer) {
+  DCHECK_EQ(state(), kStateWritable);
+
+  WritableIoVec iov;
+  iov.iov_base = &file_backed_memory_list_base_;
+  iov.iov_len = sizeof(file_backed_memory_list_base_);
+  std::vector<WritableIoVec> iovecs(1, iov);
+
+  if (!descriptors_.empty()) {
+    iov.iov_base = &descriptors_[0];
+    iov.iov_len = descriptors_.size() * sizeof(descriptors_[0]);
+    iovecs.push_back(iov);
+  }
+
+  return file_writer->WriteIoVec(&iovecs);
+}
+
+MinidumpStreamType MinidumpFileBackedMemoryListWriter::StreamType() const {
+  return kMinidumpStreamTypeCrashpadFileBackedMemoryList;
+}
+
+}  // namespace crashpad
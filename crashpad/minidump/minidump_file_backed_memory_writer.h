@@ -0,0 +1,94 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_MINIDUMP_MINIDUMP_FILE_BACKED_MEMORY_WRITER_H_
+#define CRASHPAD_MINIDUMP_MINIDUMP_FILE_BACKED_MEMORY_WRITER_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "minidump/minidump_extensions.h"
+#include "minidump/minidump_stream_writer.h"
+#include "minidump/minidump_string_writer.h"
+#include "minidump/minidump_writable.h"
+#include "util/stdlib/pointer_container.h"
+
+namespace crashpad {
+
+//! \brief The writer for a MinidumpFileBackedMemoryList stream in a minidump
+//!     file, containing a list of MinidumpFileBackedMemoryDescriptor objects.
+//!
+//! Each distinct file name is written to the minidump file once, regardless of
+//! the number of memory ranges that refer to it.
+class MinidumpFileBackedMemoryListWriter final
+    : public internal::MinidumpStreamWriter {
+ public:
+  MinidumpFileBackedMemoryListWriter();
+  ~MinidumpFileBackedMemoryListWriter() override;
+
+  //! \brief Adds a memory range to the MinidumpFileBackedMemoryList.
+  //!
+  //! \param[in] address The base address of the memory range.
+  //! \param[in] size The size of the memory range.
+  //! \param[in] file_name The name of the file whose contents the memory range
+  //!     is identical to.
+  //! \param[in] file_offset The offset within \a file_name at which the
+  //!     contents of the memory range begin.
+  //!
+  //! \note Valid in #kStateMutable.
+  void AddRange(uint64_t address,
+                uint64_t size,
+                const std::string& file_name,
+                uint64_t file_offset);
+
+  //! \brief Determines whether the object is useful.
+  //!
+  //! A useful object is one that carries data that makes a meaningful
+  //! contribution to a minidump file. An object carrying memory ranges would be
+  //! considered useful.
+  //!
+  //! \return `true` if the object is useful, `false` otherwise.
+  bool IsUseful() const;
+
+ protected:
+  // MinidumpWritable:
+  bool Freeze() override;
+  size_t SizeOfObject() override;
+  std::vector<internal::MinidumpWritable*> Children() override;
+  bool WriteObject(FileWriterInterface* file_writer) override;
+
+  // MinidumpStreamWriter:
+  MinidumpStreamType StreamType() const override;
+
+ private:
+  MinidumpFileBackedMemoryList file_backed_memory_list_base_;
+  std::vector<MinidumpFileBackedMemoryDescriptor> descriptors_;
+
+  // Indices into file_names_, parallel to descriptors_.
+  std::vector<size_t> descriptor_file_names_;
+
+  std::map<std::string, size_t> file_name_indices_;
+  PointerVector<internal::MinidumpUTF8StringWriter> file_names_;
+
+  DISALLOW_COPY_AND_ASSIGN(MinidumpFileBackedMemoryListWriter);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_MINIDUMP_MINIDUMP_FILE_BACKED_MEMORY_WRITER_H_
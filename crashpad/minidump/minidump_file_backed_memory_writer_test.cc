@@ -0,0 +1,242 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "minidump/minidump_file_backed_memory_writer.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/memory/ptr_util.h"
+#include "gtest/gtest.h"
+#include "minidump/minidump_extensions.h"
+#include "minidump/minidump_file_writer.h"
+#include "minidump/minidump_memory_writer.h"
+#include "minidump/test/minidump_file_writer_test_util.h"
+#include "minidump/test/minidump_string_writer_test_util.h"
+#include "minidump/test/minidump_writable_test_util.h"
+#include "snapshot/file_backed_memory_resolver.h"
+#include "snapshot/test/test_memory_snapshot.h"
+#include "util/file/string_file.h"
+#include "util/stdlib/pointer_container.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+const MinidumpFileBackedMemoryList* GetFileBackedMemoryListStream(
+    const std::string& file_contents,
+    uint32_t expected_streams) {
+  const MINIDUMP_DIRECTORY* directory;
+  const MINIDUMP_HEADER* header =
+      MinidumpHeaderAtStart(file_contents, &directory);
+  EXPECT_NO_FATAL_FAILURE(VerifyMinidumpHeader(header, expected_streams, 0));
+  if (!directory) {
+    return nullptr;
+  }
+
+  for (uint32_t index = 0; index < expected_streams; ++index) {
+    if (directory[index].StreamType ==
+        kMinidumpStreamTypeCrashpadFileBackedMemoryList) {
+      return MinidumpWritableAtLocationDescriptor<MinidumpFileBackedMemoryList>(
+          file_contents, directory[index].Location);
+    }
+  }
+
+  ADD_FAILURE() << "no file-backed memory list stream";
+  return nullptr;
+}
+
+TEST(MinidumpFileBackedMemoryListWriter, Empty) {
+  auto list_writer = base::WrapUnique(new MinidumpFileBackedMemoryListWriter());
+  EXPECT_FALSE(list_writer->IsUseful());
+
+  MinidumpFileWriter minidump_file_writer;
+  ASSERT_TRUE(minidump_file_writer.AddStream(std::move(list_writer)));
+
+  StringFile string_file;
+  ASSERT_TRUE(minidump_file_writer.WriteEverything(&string_file));
+
+  const MinidumpFileBackedMemoryList* list =
+      GetFileBackedMemoryListStream(string_file.string(), 1);
+  ASSERT_TRUE(list);
+  EXPECT_EQ(list->version, MinidumpFileBackedMemoryList::kVersion);
+  EXPECT_EQ(list->count, 0u);
+}
+
+TEST(MinidumpFileBackedMemoryListWriter, Ranges) {
+  constexpr char kLibrary[] = "/system/lib/libc.so";
+  constexpr char kExecutable[] = "/system/bin/app_process";
+
+  auto list_writer = base::WrapUnique(new MinidumpFileBackedMemoryListWriter());
+  list_writer->AddRange(0x7f0000001000, 0x100, kLibrary, 0x1000);
+  list_writer->AddRange(0x555500002080, 0x40, kExecutable, 0x2080);
+  list_writer->AddRange(0x7f0000003000, 0x2000, kLibrary, 0x3000);
+  EXPECT_TRUE(list_writer->IsUseful());
+
+  MinidumpFileWriter minidump_file_writer;
+  ASSERT_TRUE(minidump_file_writer.AddStream(std::move(list_writer)));
+
+  StringFile string_file;
+  ASSERT_TRUE(minidump_file_writer.WriteEverything(&string_file));
+
+  const MinidumpFileBackedMemoryList* list =
+      GetFileBackedMemoryListStream(string_file.string(), 1);
+  ASSERT_TRUE(list);
+  EXPECT_EQ(list->version, MinidumpFileBackedMemoryList::kVersion);
+  ASSERT_EQ(list->count, 3u);
+
+  EXPECT_EQ(list->ranges[0].start_of_memory_range, 0x7f0000001000u);
+  EXPECT_EQ(list->ranges[0].data_size, 0x100u);
+  EXPECT_EQ(list->ranges[0].file_offset, 0x1000u);
+  EXPECT_EQ(MinidumpUTF8StringAtRVAAsString(string_file.string(),
+                                            list->ranges[0].file_name),
+            kLibrary);
+
+  EXPECT_EQ(list->ranges[1].start_of_memory_range, 0x555500002080u);
+  EXPECT_EQ(list->ranges[1].data_size, 0x40u);
+  EXPECT_EQ(list->ranges[1].file_offset, 0x2080u);
+  EXPECT_EQ(MinidumpUTF8StringAtRVAAsString(string_file.string(),
+                                            list->ranges[1].file_name),
+            kExecutable);
+
+  EXPECT_EQ(list->ranges[2].start_of_memory_range, 0x7f0000003000u);
+  EXPECT_EQ(list->ranges[2].data_size, 0x2000u);
+  EXPECT_EQ(list->ranges[2].file_offset, 0x3000u);
+
+  // Each file name is only written once.
+  EXPECT_EQ(list->ranges[2].file_name, list->ranges[0].file_name);
+  EXPECT_NE(list->ranges[1].file_name, list->ranges[0].file_name);
+}
+
+// Resolves memory snapshots filled with a particular value to a file, as though
+// that file contained only that value.
+class TestFileBackedMemoryResolver final : public FileBackedMemoryResolver {
+ public:
+  TestFileBackedMemoryResolver(char value, const std::string& file_name)
+      : file_name_(file_name), value_(value) {}
+  ~TestFileBackedMemoryResolver() override {}
+
+  // FileBackedMemoryResolver:
+  bool Resolve(const MemorySnapshot& memory,
+               std::string* file_name,
+               uint64_t* file_offset) override {
+    ValueDelegate delegate(value_);
+    if (!memory.Read(&delegate) || !delegate.matched()) {
+      return false;
+    }
+    *file_name = file_name_;
+    *file_offset = memory.Address() & 0xffff;
+    return true;
+  }
+
+ private:
+  class ValueDelegate final : public MemorySnapshot::Delegate {
+   public:
+    explicit ValueDelegate(char value) : value_(value), matched_(false) {}
+    ~ValueDelegate() override {}
+
+    bool matched() const { return matched_; }
+
+    // MemorySnapshot::Delegate:
+    bool MemorySnapshotDelegateRead(void* data, size_t size) override {
+      matched_ = size > 0 && static_cast<char*>(data)[0] == value_;
+      return true;
+    }
+
+   private:
+    char value_;
+    bool matched_;
+
+    DISALLOW_COPY_AND_ASSIGN(ValueDelegate);
+  };
+
+  std::string file_name_;
+  char value_;
+
+  DISALLOW_COPY_AND_ASSIGN(TestFileBackedMemoryResolver);
+};
+
+TEST(MinidumpFileBackedMemoryListWriter, MemoryListAddFromSnapshot) {
+  constexpr char kFileValue = 'f';
+  constexpr char kFileName[] = "/lib/libtest.so";
+
+  struct {
+    uint64_t address;
+    size_t size;
+    char value;
+  } const kSnapshots[] = {
+      {0x10000, 0x100, 'a'},
+      {0x21230, 0x80, kFileValue},
+      {0x30000, 0x200, 'b'},
+      {0x45670, 0x10, kFileValue},
+  };
+
+  PointerVector<TestMemorySnapshot> memory_snapshots_owner;
+  std::vector<const MemorySnapshot*> memory_snapshots;
+  for (const auto& snapshot : kSnapshots) {
+    TestMemorySnapshot* memory_snapshot = new TestMemorySnapshot();
+    memory_snapshots_owner.push_back(memory_snapshot);
+    memory_snapshot->SetAddress(snapshot.address);
+    memory_snapshot->SetSize(snapshot.size);
+    memory_snapshot->SetValue(snapshot.value);
+    memory_snapshots.push_back(memory_snapshot);
+  }
+
+  TestFileBackedMemoryResolver resolver(kFileValue, kFileName);
+  auto list_writer = base::WrapUnique(new MinidumpFileBackedMemoryListWriter());
+  auto memory_list_writer = base::WrapUnique(new MinidumpMemoryListWriter());
+  memory_list_writer->SetFileBackedMemory(&resolver, list_writer.get());
+  memory_list_writer->AddFromSnapshot(memory_snapshots);
+
+  MinidumpFileWriter minidump_file_writer;
+  ASSERT_TRUE(minidump_file_writer.AddStream(std::move(list_writer)));
+  ASSERT_TRUE(minidump_file_writer.AddStream(std::move(memory_list_writer)));
+
+  StringFile string_file;
+  ASSERT_TRUE(minidump_file_writer.WriteEverything(&string_file));
+
+  const MINIDUMP_DIRECTORY* directory;
+  const MINIDUMP_HEADER* header =
+      MinidumpHeaderAtStart(string_file.string(), &directory);
+  ASSERT_NO_FATAL_FAILURE(VerifyMinidumpHeader(header, 2, 0));
+  ASSERT_TRUE(directory);
+  ASSERT_EQ(directory[1].StreamType, kMinidumpStreamTypeMemoryList);
+  const MINIDUMP_MEMORY_LIST* memory_list =
+      MinidumpWritableAtLocationDescriptor<MINIDUMP_MEMORY_LIST>(
+          string_file.string(), directory[1].Location);
+  ASSERT_TRUE(memory_list);
+  ASSERT_EQ(memory_list->NumberOfMemoryRanges, 2u);
+  EXPECT_EQ(memory_list->MemoryRanges[0].StartOfMemoryRange, 0x10000u);
+  EXPECT_EQ(memory_list->MemoryRanges[1].StartOfMemoryRange, 0x30000u);
+
+  const MinidumpFileBackedMemoryList* list =
+      GetFileBackedMemoryListStream(string_file.string(), 2);
+  ASSERT_TRUE(list);
+  ASSERT_EQ(list->count, 2u);
+  EXPECT_EQ(list->ranges[0].start_of_memory_range, 0x21230u);
+  EXPECT_EQ(list->ranges[0].data_size, 0x80u);
+  EXPECT_EQ(list->ranges[0].file_offset, 0x1230u);
+  EXPECT_EQ(MinidumpUTF8StringAtRVAAsString(string_file.string(),
+                                            list->ranges[0].file_name),
+            kFileName);
+  EXPECT_EQ(list->ranges[1].start_of_memory_range, 0x45670u);
+  EXPECT_EQ(list->ranges[1].data_size, 0x10u);
+  EXPECT_EQ(list->ranges[1].file_offset, 0x5670u);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
@@ -14,12 +14,15 @@
 
 #include "minidump/minidump_file_writer.h"
 
+#include <limits>
 #include <utility>
 
 #include "base/logging.h"
 #include "base/memory/ptr_util.h"
 #include "minidump/minidump_crashpad_info_writer.h"
+#include "minidump/minidump_deduplicated_memory_writer.h"
 #include "minidump/minidump_exception_writer.h"
+#include "minidump/minidump_file_backed_memory_writer.h"
 #include "minidump/minidump_handle_writer.h"
 #include "minidump/minidump_memory_info_writer.h"
 #include "minidump/minidump_memory_writer.h"
@@ -28,11 +31,13 @@
 #include "minidump/minidump_system_info_writer.h"
 #include "minidump/minidump_thread_id_map.h"
 #include "minidump/minidump_thread_writer.h"
+#include "minidump/minidump_triage_summary_writer.h"
 #include "minidump/minidump_unloaded_module_writer.h"
 #include "minidump/minidump_user_extension_stream_data_source.h"
 #include "minidump/minidump_user_stream_writer.h"
 #include "minidump/minidump_writer_util.h"
 #include "snapshot/exception_snapshot.h"
+#include "snapshot/memory_snapshot.h"
 #include "snapshot/module_snapshot.h"
 #include "snapshot/process_snapshot.h"
 #include "util/file/file_writer.h"
@@ -40,11 +45,40 @@
 
 namespace crashpad {
 
+namespace {
+
+// Returns the regions of |memory| that fit within |*remaining| bytes, in
+// order, and reduces |*remaining| by their total size.
+std::vector<const MemorySnapshot*> ExtraMemoryWithinLimit(
+    const std::vector<const MemorySnapshot*>& memory,
+    uint64_t* remaining) {
+  std::vector<const MemorySnapshot*> limited_memory;
+  for (const MemorySnapshot* region : memory) {
+    if (region->Size() <= *remaining) {
+      limited_memory.push_back(region);
+      *remaining -= region->Size();
+    }
+  }
+  return limited_memory;
+}
+
+}  // namespace
+
 MinidumpFileWriter::MinidumpFileWriter()
-    : MinidumpWritable(), header_(), streams_(), stream_types_() {
+    : MinidumpWritable(),
+      header_(),
+      streams_(),
+      stream_types_(),
+      file_backed_memory_resolver_(nullptr),
+      deduplicate_memory_(false),
+      triage_summary_(false),
+      triage_summary_annotation_keys_(),
+      extra_memory_limit_(std::numeric_limits<uint64_t>::max()),
+      reduced_capture_(false) {
   // Don’t set the signature field right away. Leave it set to 0, so that a
   // partially-written minidump file isn’t confused for a complete and valid
-  // one. The header will be rewritten in WriteToFile().
+  // one. The header will be rewritten in WriteEverything(), unless
+  // WriteMinidump() is used without seeking.
   header_.Signature = 0;
 
   header_.Version = MINIDUMP_VERSION;
@@ -72,10 +106,25 @@ void MinidumpFileWriter::InitializeFromSnapshot(
   process_snapshot->SnapshotTime(&snapshot_time);
   SetTimestamp(snapshot_time.tv_sec);
 
+  bool add_stream_result;
+
+  // The triage summary is added first so that it immediately follows the
+  // stream directory, where it can be found by reading only the start of the
+  // file.
+  if (triage_summary_) {
+    auto triage_summary = base::WrapUnique(new MinidumpTriageSummaryWriter());
+    triage_summary->InitializeFromSnapshot(
+        process_snapshot,
+        triage_summary_annotation_keys_,
+        MinidumpTriageSummaryWriter::kDefaultMaxFrames);
+    add_stream_result = AddStream(std::move(triage_summary));
+    DCHECK(add_stream_result);
+  }
+
   const SystemSnapshot* system_snapshot = process_snapshot->System();
   auto system_info = base::WrapUnique(new MinidumpSystemInfoWriter());
   system_info->InitializeFromSnapshot(system_snapshot);
-  bool add_stream_result = AddStream(std::move(system_info));
+  add_stream_result = AddStream(std::move(system_info));
   DCHECK(add_stream_result);
 
   auto misc_info = base::WrapUnique(new MinidumpMiscInfoWriter());
@@ -84,15 +133,27 @@ void MinidumpFileWriter::InitializeFromSnapshot(
   DCHECK(add_stream_result);
 
   auto memory_list = base::WrapUnique(new MinidumpMemoryListWriter());
+  std::unique_ptr<MinidumpDeduplicatedMemoryListWriter>
+      deduplicated_memory_list;
+  if (deduplicate_memory_) {
+    deduplicated_memory_list.reset(new MinidumpDeduplicatedMemoryListWriter());
+    memory_list->SetDeduplicatedMemoryListWriter(
+        deduplicated_memory_list.get());
+  }
+
+  const ExceptionSnapshot* exception_snapshot = process_snapshot->Exception();
+
   auto thread_list = base::WrapUnique(new MinidumpThreadListWriter());
   thread_list->SetMemoryListWriter(memory_list.get());
+  if (reduced_capture_ && exception_snapshot) {
+    thread_list->RestrictStacksToThread(exception_snapshot->ThreadID());
+  }
   MinidumpThreadIDMap thread_id_map;
   thread_list->InitializeFromSnapshot(process_snapshot->Threads(),
                                       &thread_id_map);
   add_stream_result = AddStream(std::move(thread_list));
   DCHECK(add_stream_result);
 
-  const ExceptionSnapshot* exception_snapshot = process_snapshot->Exception();
   if (exception_snapshot) {
     auto exception = base::WrapUnique(new MinidumpExceptionWriter());
     exception->InitializeFromSnapshot(exception_snapshot, thread_id_map);
@@ -124,8 +185,15 @@ void MinidumpFileWriter::InitializeFromSnapshot(
     DCHECK(add_stream_result);
   }
 
-  std::vector<const MemoryMapRegionSnapshot*> memory_map_snapshot =
-      process_snapshot->MemoryMap();
+  // A reduced capture omits the memory map and handle data, which can be
+  // large.
+  std::vector<const MemoryMapRegionSnapshot*> memory_map_snapshot;
+  std::vector<HandleSnapshot> handles_snapshot;
+  if (!reduced_capture_) {
+    memory_map_snapshot = process_snapshot->MemoryMap();
+    handles_snapshot = process_snapshot->Handles();
+  }
+
   if (!memory_map_snapshot.empty()) {
     auto memory_info_list =
         base::WrapUnique(new MinidumpMemoryInfoListWriter());
@@ -134,7 +202,6 @@ void MinidumpFileWriter::InitializeFromSnapshot(
     DCHECK(add_stream_result);
   }
 
-  std::vector<HandleSnapshot> handles_snapshot = process_snapshot->Handles();
   if (!handles_snapshot.empty()) {
     auto handle_data_writer = base::WrapUnique(new MinidumpHandleDataWriter());
     handle_data_writer->InitializeFromSnapshot(handles_snapshot);
@@ -142,9 +209,31 @@ void MinidumpFileWriter::InitializeFromSnapshot(
     DCHECK(add_stream_result);
   }
 
-  memory_list->AddFromSnapshot(process_snapshot->ExtraMemory());
-  if (exception_snapshot) {
-    memory_list->AddFromSnapshot(exception_snapshot->ExtraMemory());
+  std::unique_ptr<MinidumpFileBackedMemoryListWriter> file_backed_memory_list;
+  if (file_backed_memory_resolver_) {
+    file_backed_memory_list.reset(new MinidumpFileBackedMemoryListWriter());
+    memory_list->SetFileBackedMemory(file_backed_memory_resolver_,
+                                     file_backed_memory_list.get());
+  }
+
+  if (!reduced_capture_) {
+    uint64_t extra_memory_remaining = extra_memory_limit_;
+    memory_list->AddFromSnapshot(ExtraMemoryWithinLimit(
+        process_snapshot->ExtraMemory(), &extra_memory_remaining));
+    if (exception_snapshot) {
+      memory_list->AddFromSnapshot(ExtraMemoryWithinLimit(
+          exception_snapshot->ExtraMemory(), &extra_memory_remaining));
+    }
+  }
+
+  if (file_backed_memory_list && file_backed_memory_list->IsUseful()) {
+    add_stream_result = AddStream(std::move(file_backed_memory_list));
+    DCHECK(add_stream_result);
+  }
+
+  if (deduplicated_memory_list && deduplicated_memory_list->IsUseful()) {
+    add_stream_result = AddStream(std::move(deduplicated_memory_list));
+    DCHECK(add_stream_result);
   }
 
   // These user streams must be added last. Otherwise, a user stream with the
@@ -153,16 +242,18 @@ void MinidumpFileWriter::InitializeFromSnapshot(
   // later-discovered ones. The well-known memory list stream is added after
   // these user streams, but only with a check here to avoid adding a user
   // stream that would preempt the memory list stream.
-  for (const auto& module : process_snapshot->Modules()) {
-    for (const UserMinidumpStream* stream : module->CustomMinidumpStreams()) {
-      if (stream->stream_type() == kMinidumpStreamTypeMemoryList) {
-        LOG(WARNING) << "discarding duplicate stream of type "
-                     << stream->stream_type();
-        continue;
+  if (!reduced_capture_) {
+    for (const auto& module : process_snapshot->Modules()) {
+      for (const UserMinidumpStream* stream : module->CustomMinidumpStreams()) {
+        if (stream->stream_type() == kMinidumpStreamTypeMemoryList) {
+          LOG(WARNING) << "discarding duplicate stream of type "
+                       << stream->stream_type();
+          continue;
+        }
+        auto user_stream = base::WrapUnique(new MinidumpUserStreamWriter());
+        user_stream->InitializeFromSnapshot(stream);
+        AddStream(std::move(user_stream));
       }
-      auto user_stream = base::WrapUnique(new MinidumpUserStreamWriter());
-      user_stream->InitializeFromSnapshot(stream);
-      AddStream(std::move(user_stream));
     }
   }
 
@@ -176,6 +267,45 @@ void MinidumpFileWriter::InitializeFromSnapshot(
   DCHECK(add_stream_result);
 }
 
+void MinidumpFileWriter::SetFileBackedMemoryResolver(
+    FileBackedMemoryResolver* resolver) {
+  DCHECK_EQ(state(), kStateMutable);
+  DCHECK(streams_.empty());
+
+  file_backed_memory_resolver_ = resolver;
+}
+
+void MinidumpFileWriter::SetDeduplicateMemory(bool deduplicate_memory) {
+  DCHECK_EQ(state(), kStateMutable);
+  DCHECK(streams_.empty());
+
+  deduplicate_memory_ = deduplicate_memory;
+}
+
+void MinidumpFileWriter::SetTriageSummary(
+    bool triage_summary,
+    const std::vector<std::string>& annotation_keys) {
+  DCHECK_EQ(state(), kStateMutable);
+  DCHECK(streams_.empty());
+
+  triage_summary_ = triage_summary;
+  triage_summary_annotation_keys_ = annotation_keys;
+}
+
+void MinidumpFileWriter::SetReducedCapture(bool reduced_capture) {
+  DCHECK_EQ(state(), kStateMutable);
+  DCHECK(streams_.empty());
+
+  reduced_capture_ = reduced_capture;
+}
+
+void MinidumpFileWriter::SetExtraMemoryLimit(uint64_t limit) {
+  DCHECK_EQ(state(), kStateMutable);
+  DCHECK(streams_.empty());
+
+  extra_memory_limit_ = limit;
+}
+
 void MinidumpFileWriter::SetTimestamp(time_t timestamp) {
   DCHECK_EQ(state(), kStateMutable);
 
@@ -213,8 +343,20 @@ bool MinidumpFileWriter::AddUserExtensionStream(
 }
 
 bool MinidumpFileWriter::WriteEverything(FileWriterInterface* file_writer) {
+  return WriteMinidump(file_writer, true);
+}
+
+bool MinidumpFileWriter::WriteMinidump(FileWriterInterface* file_writer,
+                                       bool allow_seek) {
   DCHECK_EQ(state(), kStateMutable);
 
+  if (!allow_seek) {
+    // The header can’t be rewritten once the rest of the file has been
+    // written, so it must carry its final signature from the outset.
+    header_.Signature = MINIDUMP_SIGNATURE;
+    return MinidumpWritable::WriteEverything(file_writer);
+  }
+
   FileOffset start_offset = file_writer->Seek(0, SEEK_CUR);
   if (start_offset < 0) {
     return false;
@@ -21,6 +21,7 @@
 
 #include <memory>
 #include <set>
+#include <string>
 #include <vector>
 
 #include "base/macros.h"
@@ -32,6 +33,7 @@
 
 namespace crashpad {
 
+class FileBackedMemoryResolver;
 class ProcessSnapshot;
 class MinidumpUserExtensionStreamDataSource;
 
@@ -57,6 +59,7 @@ class MinidumpFileWriter final : public internal::MinidumpWritable {
   //! The streams are added in the order that they are expected to be most
   //! useful to minidump readers, to improve data locality and minimize seeking.
   //! The streams are added in this order:
+  //!  - kMinidumpStreamTypeCrashpadTriageSummary (if enabled)
   //!  - kMinidumpStreamTypeSystemInfo
   //!  - kMinidumpStreamTypeMiscInfo
   //!  - kMinidumpStreamTypeThreadList
@@ -66,6 +69,8 @@ class MinidumpFileWriter final : public internal::MinidumpWritable {
   //!  - kMinidumpStreamTypeCrashpadInfo (if present)
   //!  - kMinidumpStreamTypeMemoryInfoList (if present)
   //!  - kMinidumpStreamTypeHandleData (if present)
+  //!  - kMinidumpStreamTypeCrashpadFileBackedMemoryList (if present)
+  //!  - kMinidumpStreamTypeCrashpadDeduplicatedMemoryList (if present)
   //!  - User streams (if present)
   //!  - kMinidumpStreamTypeMemoryList
   //!
@@ -76,6 +81,86 @@ class MinidumpFileWriter final : public internal::MinidumpWritable {
   //!     methods after this method.
   void InitializeFromSnapshot(const ProcessSnapshot* process_snapshot);
 
+  //! \brief Sets an object that InitializeFromSnapshot() will use to avoid
+  //!     writing the contents of extra memory that is identical to file
+  //!     contents.
+  //!
+  //! Extra memory, such as memory captured indirectly and ranges requested by
+  //! the client, often includes the text or read-only data of modules. A
+  //! minidump consumer with access to the modules can rebuild those contents.
+  //! Memory that \a resolver resolves is listed in a
+  //! kMinidumpStreamTypeCrashpadFileBackedMemoryList stream instead of the
+  //! kMinidumpStreamTypeMemoryList stream.
+  //!
+  //! \param[in] resolver The resolver to use. This object does not take
+  //!     ownership of \a resolver, which must remain valid until
+  //!     InitializeFromSnapshot() returns. May be `nullptr` to write all extra
+  //!     memory, which is the default.
+  //!
+  //! \note Valid in #kStateMutable, before InitializeFromSnapshot().
+  void SetFileBackedMemoryResolver(FileBackedMemoryResolver* resolver);
+
+  //! \brief Sets whether InitializeFromSnapshot() will store memory contents
+  //!     as deduplicated pages.
+  //!
+  //! When enabled, the contents of thread stacks and extra memory are stored
+  //! in a kMinidumpStreamTypeCrashpadDeduplicatedMemoryList stream, in which
+  //! each distinct page appears once. This greatly reduces the size of
+  //! minidump files for processes with many similar threads, but the memory
+  //! is only available to readers that understand that stream.
+  //!
+  //! \param[in] deduplicate_memory Whether to deduplicate memory. The default
+  //!     is `false`.
+  //!
+  //! \note Valid in #kStateMutable, before InitializeFromSnapshot().
+  void SetDeduplicateMemory(bool deduplicate_memory);
+
+  //! \brief Sets whether InitializeFromSnapshot() will write a
+  //!     kMinidumpStreamTypeCrashpadTriageSummary stream.
+  //!
+  //! The stream is written immediately after the stream directory, so that a
+  //! reader can classify the crash by reading only the start of the file, as
+  //! ReadMinidumpTriageSummary() does.
+  //!
+  //! \param[in] triage_summary Whether to write the stream. The default is
+  //!     `false`.
+  //! \param[in] annotation_keys The keys of the annotations to include in the
+  //!     stream, as in MinidumpTriageSummaryWriter::InitializeFromSnapshot().
+  //!
+  //! \note Valid in #kStateMutable, before InitializeFromSnapshot().
+  void SetTriageSummary(bool triage_summary,
+                        const std::vector<std::string>& annotation_keys);
+
+  //! \brief Sets whether InitializeFromSnapshot() will write a reduced
+  //!     minidump file.
+  //!
+  //! A reduced minidump file retains the CPU context of every thread, the
+  //! stack of the exception thread, and the small descriptive streams such as
+  //! the module list and annotations. It omits the stacks of other threads,
+  //! all extra memory, the memory map, handle data, and user streams from
+  //! modules. A handler under heavy load can use this to capture crashes at a
+  //! fraction of the usual cost.
+  //!
+  //! \param[in] reduced_capture Whether to write a reduced minidump file. The
+  //!     default is `false`. This has no effect on the thread stacks if the
+  //!     snapshot does not contain an exception.
+  //!
+  //! \note Valid in #kStateMutable, before InitializeFromSnapshot().
+  void SetReducedCapture(bool reduced_capture);
+
+  //! \brief Sets the maximum total size of the extra memory that
+  //!     InitializeFromSnapshot() will record.
+  //!
+  //! This applies to ProcessSnapshot::ExtraMemory() and
+  //! ExceptionSnapshot::ExtraMemory(), which are considered in that order. A
+  //! region that would exceed the limit is omitted, but smaller regions after
+  //! it may still be recorded. Thread stacks are not counted.
+  //!
+  //! \param[in] limit The limit, in bytes. The default is unlimited.
+  //!
+  //! \note Valid in #kStateMutable, before InitializeFromSnapshot().
+  void SetExtraMemoryLimit(uint64_t limit);
+
   //! \brief Sets MINIDUMP_HEADER::Timestamp.
   //!
   //! \note Valid in #kStateMutable.
@@ -124,6 +209,31 @@ class MinidumpFileWriter final : public internal::MinidumpWritable {
       std::unique_ptr<MinidumpUserExtensionStreamDataSource>
           user_extension_stream_data);
 
+  //! \brief Writes this object to a minidump file.
+  //!
+  //! This is the same as WriteEverything(), but optionally writes without
+  //! seeking, so that output may be sent directly to a pipe, a socket, or a
+  //! compressing stream.
+  //!
+  //! The layout of the entire minidump file, including the stream directory, is
+  //! computed before anything is written, so the header can be written first
+  //! and the rest of the file written in a single forward pass.
+  //!
+  //! \param[in] file_writer The file writer to receive the minidump file’s
+  //!     content.
+  //! \param[in] allow_seek Whether seeking is allowed. If `false`, \a
+  //!     file_writer’s Seek() method is never called, and the header is written
+  //!     with its final MINIDUMP_HEADER::Signature value from the start. An
+  //!     incompletely-written minidump file may then be mistaken for a valid
+  //!     one, so a reader must be able to detect a premature end of its input
+  //!     by other means.
+  //!
+  //! \return `true` on success. `false` on failure, with an appropriate message
+  //!     logged.
+  //!
+  //! \note Valid in #kStateMutable.
+  bool WriteMinidump(FileWriterInterface* file_writer, bool allow_seek);
+
   // MinidumpWritable:
 
   //! \copydoc internal::MinidumpWritable::WriteEverything()
@@ -150,6 +260,13 @@ class MinidumpFileWriter final : public internal::MinidumpWritable {
   // Protects against multiple streams with the same ID being added.
   std::set<MinidumpStreamType> stream_types_;
 
+  FileBackedMemoryResolver* file_backed_memory_resolver_;  // weak
+  bool deduplicate_memory_;
+  bool triage_summary_;
+  std::vector<std::string> triage_summary_annotation_keys_;
+  uint64_t extra_memory_limit_;
+  bool reduced_capture_;
+
   DISALLOW_COPY_AND_ASSIGN(MinidumpFileWriter);
 };
 
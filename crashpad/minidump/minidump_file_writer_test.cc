@@ -30,6 +30,7 @@
 #include "minidump/test/minidump_file_writer_test_util.h"
 #include "minidump/test/minidump_user_extension_stream_util.h"
 #include "minidump/test/minidump_writable_test_util.h"
+#include "snapshot/handle_snapshot.h"
 #include "snapshot/test/test_cpu_context.h"
 #include "snapshot/test/test_exception_snapshot.h"
 #include "snapshot/test/test_memory_snapshot.h"
@@ -131,6 +132,60 @@ TEST(MinidumpFileWriter, OneStream) {
   EXPECT_EQ(memcmp(stream_data, expected_stream.c_str(), kStreamSize), 0);
 }
 
+// A StringFile that can’t seek, standing in for a pipe or a socket.
+class NonSeekableStringFile final : public StringFile {
+ public:
+  NonSeekableStringFile() : StringFile() {}
+  ~NonSeekableStringFile() override {}
+
+  // FileSeekerInterface:
+  FileOffset Seek(FileOffset offset, int whence) override {
+    ADD_FAILURE() << "Seek() called";
+    return -1;
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(NonSeekableStringFile);
+};
+
+TEST(MinidumpFileWriter, WriteMinidumpWithoutSeek) {
+  constexpr time_t kTimestamp = 0x155d2fb8;
+  constexpr MinidumpStreamType kStreamType0 =
+      static_cast<MinidumpStreamType>(0x4d);
+  constexpr MinidumpStreamType kStreamType1 =
+      static_cast<MinidumpStreamType>(0x4e);
+
+  StringFile seekable_file;
+  NonSeekableStringFile non_seekable_file;
+  for (bool allow_seek : {true, false}) {
+    SCOPED_TRACE(allow_seek ? "allow_seek" : "no seek");
+
+    MinidumpFileWriter minidump_file;
+    minidump_file.SetTimestamp(kTimestamp);
+    ASSERT_TRUE(minidump_file.AddStream(
+        base::WrapUnique(new TestStream(kStreamType0, 5, 0x5a))));
+    ASSERT_TRUE(minidump_file.AddStream(
+        base::WrapUnique(new TestStream(kStreamType1, 3, 0xa5))));
+
+    if (allow_seek) {
+      ASSERT_TRUE(minidump_file.WriteMinidump(&seekable_file, true));
+    } else {
+      ASSERT_TRUE(minidump_file.WriteMinidump(&non_seekable_file, false));
+    }
+  }
+
+  // Writing without seeking must produce exactly the same file.
+  EXPECT_EQ(non_seekable_file.string(), seekable_file.string());
+
+  const MINIDUMP_DIRECTORY* directory;
+  const MINIDUMP_HEADER* header =
+      MinidumpHeaderAtStart(non_seekable_file.string(), &directory);
+  ASSERT_NO_FATAL_FAILURE(VerifyMinidumpHeader(header, 2, kTimestamp));
+  ASSERT_TRUE(directory);
+  EXPECT_EQ(directory[0].StreamType, kStreamType0);
+  EXPECT_EQ(directory[1].StreamType, kStreamType1);
+}
+
 TEST(MinidumpFileWriter, AddUserExtensionStream) {
   MinidumpFileWriter minidump_file;
   constexpr time_t kTimestamp = 0x155d2fb8;
@@ -529,6 +584,145 @@ TEST(MinidumpFileWriter, InitializeFromSnapshot_CrashpadInfo) {
                   string_file.string(), directory[6].Location));
 }
 
+TEST(MinidumpFileWriter, InitializeFromSnapshot_ReducedCapture) {
+  constexpr uint32_t kSnapshotTime = 0x4976043c;
+  constexpr timeval kSnapshotTimeval = {static_cast<time_t>(kSnapshotTime), 0};
+
+  TestProcessSnapshot process_snapshot;
+  process_snapshot.SetSnapshotTime(kSnapshotTimeval);
+
+  auto system_snapshot = base::WrapUnique(new TestSystemSnapshot());
+  system_snapshot->SetCPUArchitecture(kCPUArchitectureX86_64);
+  system_snapshot->SetOperatingSystem(SystemSnapshot::kOperatingSystemMacOSX);
+  process_snapshot.SetSystem(std::move(system_snapshot));
+
+  constexpr uint64_t kThreadIDs[] = {0x1000, 0x2000};
+  constexpr uint64_t kStackAddresses[] = {0x7ffe0000, 0x7ffd0000};
+  constexpr size_t kStackSize = 0x100;
+  for (size_t index = 0; index < arraysize(kThreadIDs); ++index) {
+    auto thread_snapshot = base::WrapUnique(new TestThreadSnapshot());
+    InitializeCPUContextX86_64(thread_snapshot->MutableContext(), 5);
+    thread_snapshot->SetThreadID(kThreadIDs[index]);
+
+    auto stack = base::WrapUnique(new TestMemorySnapshot());
+    stack->SetAddress(kStackAddresses[index]);
+    stack->SetSize(kStackSize);
+    stack->SetValue('s');
+    thread_snapshot->SetStack(std::move(stack));
+
+    auto thread_extra_memory = base::WrapUnique(new TestMemorySnapshot());
+    thread_extra_memory->SetAddress(0x20000 + index * 0x1000);
+    thread_extra_memory->SetSize(0x10);
+    thread_extra_memory->SetValue('t');
+    thread_snapshot->AddExtraMemory(std::move(thread_extra_memory));
+
+    process_snapshot.AddThread(std::move(thread_snapshot));
+  }
+
+  auto exception_snapshot = base::WrapUnique(new TestExceptionSnapshot());
+  InitializeCPUContextX86_64(exception_snapshot->MutableContext(), 11);
+  exception_snapshot->SetThreadID(kThreadIDs[1]);
+  process_snapshot.SetException(std::move(exception_snapshot));
+
+  auto module_snapshot = base::WrapUnique(new TestModuleSnapshot());
+  process_snapshot.AddModule(std::move(module_snapshot));
+
+  auto extra_memory = base::WrapUnique(new TestMemorySnapshot());
+  extra_memory->SetAddress(0x10000);
+  extra_memory->SetSize(0x10);
+  extra_memory->SetValue('x');
+  process_snapshot.AddExtraMemory(std::move(extra_memory));
+
+  HandleSnapshot handle_snapshot;
+  handle_snapshot.handle = 4;
+  process_snapshot.AddHandle(handle_snapshot);
+
+  MinidumpFileWriter minidump_file_writer;
+  minidump_file_writer.SetReducedCapture(true);
+  minidump_file_writer.InitializeFromSnapshot(&process_snapshot);
+
+  StringFile string_file;
+  ASSERT_TRUE(minidump_file_writer.WriteEverything(&string_file));
+
+  const MINIDUMP_DIRECTORY* directory;
+  const MINIDUMP_HEADER* header =
+      MinidumpHeaderAtStart(string_file.string(), &directory);
+  ASSERT_NO_FATAL_FAILURE(VerifyMinidumpHeader(header, 6, kSnapshotTime));
+  ASSERT_TRUE(directory);
+
+  EXPECT_EQ(directory[0].StreamType, kMinidumpStreamTypeSystemInfo);
+  EXPECT_EQ(directory[1].StreamType, kMinidumpStreamTypeMiscInfo);
+  EXPECT_EQ(directory[2].StreamType, kMinidumpStreamTypeThreadList);
+  EXPECT_EQ(directory[3].StreamType, kMinidumpStreamTypeException);
+  EXPECT_EQ(directory[4].StreamType, kMinidumpStreamTypeModuleList);
+  EXPECT_EQ(directory[5].StreamType, kMinidumpStreamTypeMemoryList);
+
+  const MINIDUMP_THREAD_LIST* thread_list =
+      MinidumpWritableAtLocationDescriptor<MINIDUMP_THREAD_LIST>(
+          string_file.string(), directory[2].Location);
+  ASSERT_TRUE(thread_list);
+  ASSERT_EQ(thread_list->NumberOfThreads, 2u);
+
+  // Both threads have contexts, but only the exception thread has a stack.
+  EXPECT_NE(thread_list->Threads[0].ThreadContext.DataSize, 0u);
+  EXPECT_EQ(thread_list->Threads[0].Stack.Memory.DataSize, 0u);
+  EXPECT_NE(thread_list->Threads[1].ThreadContext.DataSize, 0u);
+  EXPECT_EQ(thread_list->Threads[1].Stack.StartOfMemoryRange,
+            kStackAddresses[1]);
+  EXPECT_EQ(thread_list->Threads[1].Stack.Memory.DataSize, kStackSize);
+
+  // The memory list refers only to the exception thread’s stack.
+  const MINIDUMP_MEMORY_LIST* memory_list =
+      MinidumpWritableAtLocationDescriptor<MINIDUMP_MEMORY_LIST>(
+          string_file.string(), directory[5].Location);
+  ASSERT_TRUE(memory_list);
+  ASSERT_EQ(memory_list->NumberOfMemoryRanges, 1u);
+  EXPECT_EQ(memory_list->MemoryRanges[0].StartOfMemoryRange,
+            kStackAddresses[1]);
+}
+
+TEST(MinidumpFileWriter, InitializeFromSnapshot_ExtraMemoryLimit) {
+  TestProcessSnapshot process_snapshot;
+
+  auto system_snapshot = base::WrapUnique(new TestSystemSnapshot());
+  system_snapshot->SetCPUArchitecture(kCPUArchitectureX86_64);
+  system_snapshot->SetOperatingSystem(SystemSnapshot::kOperatingSystemMacOSX);
+  process_snapshot.SetSystem(std::move(system_snapshot));
+
+  // The second region does not fit after the first, but the third does.
+  constexpr uint64_t kAddresses[] = {0x10000, 0x20000, 0x30000};
+  constexpr size_t kSizes[] = {0x300, 0x200, 0x100};
+  for (size_t index = 0; index < arraysize(kAddresses); ++index) {
+    auto extra_memory = base::WrapUnique(new TestMemorySnapshot());
+    extra_memory->SetAddress(kAddresses[index]);
+    extra_memory->SetSize(kSizes[index]);
+    extra_memory->SetValue('m');
+    process_snapshot.AddExtraMemory(std::move(extra_memory));
+  }
+
+  MinidumpFileWriter minidump_file_writer;
+  minidump_file_writer.SetExtraMemoryLimit(0x400);
+  minidump_file_writer.InitializeFromSnapshot(&process_snapshot);
+
+  StringFile string_file;
+  ASSERT_TRUE(minidump_file_writer.WriteEverything(&string_file));
+
+  const MINIDUMP_DIRECTORY* directory;
+  const MINIDUMP_HEADER* header =
+      MinidumpHeaderAtStart(string_file.string(), &directory);
+  ASSERT_NO_FATAL_FAILURE(VerifyMinidumpHeader(header, 5, 0));
+  ASSERT_TRUE(directory);
+
+  ASSERT_EQ(directory[4].StreamType, kMinidumpStreamTypeMemoryList);
+  const MINIDUMP_MEMORY_LIST* memory_list =
+      MinidumpWritableAtLocationDescriptor<MINIDUMP_MEMORY_LIST>(
+          string_file.string(), directory[4].Location);
+  ASSERT_TRUE(memory_list);
+  ASSERT_EQ(memory_list->NumberOfMemoryRanges, 2u);
+  EXPECT_EQ(memory_list->MemoryRanges[0].StartOfMemoryRange, kAddresses[0]);
+  EXPECT_EQ(memory_list->MemoryRanges[1].StartOfMemoryRange, kAddresses[2]);
+}
+
 TEST(MinidumpFileWriter, SameStreamType) {
   MinidumpFileWriter minidump_file;
 
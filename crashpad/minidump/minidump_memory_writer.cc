@@ -14,11 +14,15 @@
 
 #include "minidump/minidump_memory_writer.h"
 
+#include <string>
 #include <utility>
 
 #include "base/auto_reset.h"
 #include "base/logging.h"
 #include "base/memory/ptr_util.h"
+#include "minidump/minidump_deduplicated_memory_writer.h"
+#include "minidump/minidump_file_backed_memory_writer.h"
+#include "snapshot/file_backed_memory_resolver.h"
 #include "snapshot/memory_snapshot.h"
 #include "util/file/file_writer.h"
 #include "util/numeric/safe_assignment.h"
@@ -32,7 +36,8 @@ SnapshotMinidumpMemoryWriter::SnapshotMinidumpMemoryWriter(
       memory_descriptor_(),
       registered_memory_descriptors_(),
       memory_snapshot_(memory_snapshot),
-      file_writer_(nullptr) {}
+      file_writer_(nullptr),
+      omit_contents_(false) {}
 
 SnapshotMinidumpMemoryWriter::~SnapshotMinidumpMemoryWriter() {}
 
@@ -48,6 +53,10 @@ bool SnapshotMinidumpMemoryWriter::WriteObject(
   DCHECK_EQ(state(), kStateWritable);
   DCHECK(!file_writer_);
 
+  if (omit_contents_) {
+    return true;
+  }
+
   base::AutoReset<FileWriterInterface*> file_writer_reset(&file_writer_,
                                                           file_writer);
 
@@ -70,6 +79,12 @@ void SnapshotMinidumpMemoryWriter::RegisterMemoryDescriptor(
   RegisterLocationDescriptor(&memory_descriptor->Memory);
 }
 
+void SnapshotMinidumpMemoryWriter::OmitContents() {
+  DCHECK_EQ(state(), kStateMutable);
+
+  omit_contents_ = true;
+}
+
 bool SnapshotMinidumpMemoryWriter::Freeze() {
   DCHECK_EQ(state(), kStateMutable);
 
@@ -91,7 +106,7 @@ size_t SnapshotMinidumpMemoryWriter::Alignment() {
 size_t SnapshotMinidumpMemoryWriter::SizeOfObject() {
   DCHECK_GE(state(), kStateFrozen);
 
-  return UnderlyingSnapshot().Size();
+  return omit_contents_ ? 0 : UnderlyingSnapshot().Size();
 }
 
 bool SnapshotMinidumpMemoryWriter::WillWriteAtOffsetImpl(FileOffset offset) {
@@ -129,6 +144,9 @@ MinidumpMemoryListWriter::MinidumpMemoryListWriter()
     : MinidumpStreamWriter(),
       memory_writers_(),
       children_(),
+      file_backed_memory_resolver_(nullptr),
+      file_backed_memory_list_(nullptr),
+      deduplicated_memory_list_(nullptr),
       memory_list_base_() {
 }
 
@@ -140,12 +158,41 @@ void MinidumpMemoryListWriter::AddFromSnapshot(
   DCHECK_EQ(state(), kStateMutable);
 
   for (const MemorySnapshot* memory_snapshot : memory_snapshots) {
+    std::string file_name;
+    uint64_t file_offset;
+    if (file_backed_memory_resolver_ &&
+        file_backed_memory_resolver_->Resolve(
+            *memory_snapshot, &file_name, &file_offset)) {
+      file_backed_memory_list_->AddRange(memory_snapshot->Address(),
+                                         memory_snapshot->Size(),
+                                         file_name,
+                                         file_offset);
+      continue;
+    }
+
     std::unique_ptr<SnapshotMinidumpMemoryWriter> memory(
         new SnapshotMinidumpMemoryWriter(memory_snapshot));
     AddMemory(std::move(memory));
   }
 }
 
+void MinidumpMemoryListWriter::SetFileBackedMemory(
+    FileBackedMemoryResolver* resolver,
+    MinidumpFileBackedMemoryListWriter* file_backed_memory_list) {
+  DCHECK_EQ(state(), kStateMutable);
+  DCHECK_EQ(!resolver, !file_backed_memory_list);
+
+  file_backed_memory_resolver_ = resolver;
+  file_backed_memory_list_ = file_backed_memory_list;
+}
+
+void MinidumpMemoryListWriter::SetDeduplicatedMemoryListWriter(
+    MinidumpDeduplicatedMemoryListWriter* deduplicated_memory_list) {
+  DCHECK_EQ(state(), kStateMutable);
+
+  deduplicated_memory_list_ = deduplicated_memory_list;
+}
+
 void MinidumpMemoryListWriter::AddMemory(
     std::unique_ptr<SnapshotMinidumpMemoryWriter> memory_writer) {
   DCHECK_EQ(state(), kStateMutable);
@@ -158,6 +205,11 @@ void MinidumpMemoryListWriter::AddExtraMemory(
     SnapshotMinidumpMemoryWriter* memory_writer) {
   DCHECK_EQ(state(), kStateMutable);
 
+  if (deduplicated_memory_list_) {
+    memory_writer->OmitContents();
+    deduplicated_memory_list_->AddMemory(&memory_writer->UnderlyingSnapshot());
+  }
+
   memory_writers_.push_back(memory_writer);
 }
 
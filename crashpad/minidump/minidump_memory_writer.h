@@ -32,6 +32,10 @@
 
 namespace crashpad {
 
+class FileBackedMemoryResolver;
+class MinidumpDeduplicatedMemoryListWriter;
+class MinidumpFileBackedMemoryListWriter;
+
 //! \brief The base class for writers of memory ranges pointed to by
 //!     MINIDUMP_MEMORY_DESCRIPTOR objects in a minidump file.
 class SnapshotMinidumpMemoryWriter : public internal::MinidumpWritable,
@@ -61,6 +65,19 @@ class SnapshotMinidumpMemoryWriter : public internal::MinidumpWritable,
   //! \note Valid in #kStateFrozen or any preceding state.
   void RegisterMemoryDescriptor(MINIDUMP_MEMORY_DESCRIPTOR* memory_descriptor);
 
+  //! \brief Arranges for this object to write none of the memory’s contents.
+  //!
+  //! This is used when the contents are written elsewhere, as they are by a
+  //! MinidumpDeduplicatedMemoryListWriter. Memory descriptors pointing to this
+  //! object will carry the memory’s address, but a data size of `0`.
+  //!
+  //! \note Valid in #kStateMutable.
+  void OmitContents();
+
+  //! \brief Gets the underlying memory snapshot that the memory writer will
+  //!     write to the minidump.
+  const MemorySnapshot& UnderlyingSnapshot() const { return *memory_snapshot_; }
+
  private:
   // MemorySnapshot::Delegate:
   bool MemorySnapshotDelegateRead(void* data, size_t size) override;
@@ -94,16 +111,13 @@ class SnapshotMinidumpMemoryWriter : public internal::MinidumpWritable,
   //! \note Valid in any state.
   Phase WritePhase() final;
 
-  //! \brief Gets the underlying memory snapshot that the memory writer will
-  //!     write to the minidump.
-  const MemorySnapshot& UnderlyingSnapshot() const { return *memory_snapshot_; }
-
   MINIDUMP_MEMORY_DESCRIPTOR memory_descriptor_;
 
   // weak
   std::vector<MINIDUMP_MEMORY_DESCRIPTOR*> registered_memory_descriptors_;
   const MemorySnapshot* memory_snapshot_;
   FileWriterInterface* file_writer_;
+  bool omit_contents_;
 
   DISALLOW_COPY_AND_ASSIGN(SnapshotMinidumpMemoryWriter);
 };
@@ -118,7 +132,9 @@ class MinidumpMemoryListWriter final : public internal::MinidumpStreamWriter {
   //! \brief Adds a concrete initialized SnapshotMinidumpMemoryWriter for each
   //!     memory snapshot in \a memory_snapshots to the MINIDUMP_MEMORY_LIST.
   //!
-  //! Memory snapshots are added in the fashion of AddMemory().
+  //! Memory snapshots are added in the fashion of AddMemory(). If
+  //! SetFileBackedMemory() has been called, memory snapshots that its resolver
+  //! resolves are added to its MinidumpFileBackedMemoryListWriter instead.
   //!
   //! \param[in] memory_snapshots The memory snapshots to use as source data.
   //!
@@ -126,6 +142,40 @@ class MinidumpMemoryListWriter final : public internal::MinidumpStreamWriter {
   void AddFromSnapshot(
       const std::vector<const MemorySnapshot*>& memory_snapshots);
 
+  //! \brief Arranges for memory snapshots added by AddFromSnapshot() whose
+  //!     contents are identical to file contents to be referenced in a
+  //!     MinidumpFileBackedMemoryList instead of being written.
+  //!
+  //! \param[in] resolver The object that determines which memory snapshots
+  //!     are identical to file contents.
+  //! \param[in] file_backed_memory_list The writer that will list the memory
+  //!     snapshots that \a resolver resolves. The caller is responsible for
+  //!     adding this object to the minidump file.
+  //!
+  //! Neither object is owned by this object. Both must remain valid until the
+  //! last call to AddFromSnapshot().
+  //!
+  //! \note Valid in #kStateMutable.
+  void SetFileBackedMemory(
+      FileBackedMemoryResolver* resolver,
+      MinidumpFileBackedMemoryListWriter* file_backed_memory_list);
+
+  //! \brief Arranges for the contents of all memory subsequently added to this
+  //!     object to be stored by \a deduplicated_memory_list instead of being
+  //!     written directly.
+  //!
+  //! Memory added by AddMemory(), AddExtraMemory(), or AddFromSnapshot() after
+  //! this method is called still appears in the MINIDUMP_MEMORY_LIST, but with
+  //! SnapshotMinidumpMemoryWriter::OmitContents() in effect.
+  //!
+  //! \param[in] deduplicated_memory_list The writer that will store the
+  //!     memory’s contents. This object does not take ownership of it. The
+  //!     caller is responsible for adding it to the minidump file.
+  //!
+  //! \note Valid in #kStateMutable.
+  void SetDeduplicatedMemoryListWriter(
+      MinidumpDeduplicatedMemoryListWriter* deduplicated_memory_list);
+
   //! \brief Adds a SnapshotMinidumpMemoryWriter to the MINIDUMP_MEMORY_LIST.
   //!
   //! This object takes ownership of \a memory_writer and becomes its parent in
@@ -163,6 +213,9 @@ class MinidumpMemoryListWriter final : public internal::MinidumpStreamWriter {
  private:
   std::vector<SnapshotMinidumpMemoryWriter*> memory_writers_;  // weak
   PointerVector<SnapshotMinidumpMemoryWriter> children_;
+  FileBackedMemoryResolver* file_backed_memory_resolver_;  // weak
+  MinidumpFileBackedMemoryListWriter* file_backed_memory_list_;  // weak
+  MinidumpDeduplicatedMemoryListWriter* deduplicated_memory_list_;  // weak
   MINIDUMP_MEMORY_LIST memory_list_base_;
 
   DISALLOW_COPY_AND_ASSIGN(MinidumpMemoryListWriter);
@@ -64,7 +64,9 @@
       'sources': [
         'minidump_context_writer_test.cc',
         'minidump_crashpad_info_writer_test.cc',
+        'minidump_deduplicated_memory_writer_test.cc',
         'minidump_exception_writer_test.cc',
+        'minidump_file_backed_memory_writer_test.cc',
         'minidump_file_writer_test.cc',
         'minidump_handle_writer_test.cc',
         'minidump_memory_info_writer_test.cc',
@@ -78,6 +80,7 @@
         'minidump_system_info_writer_test.cc',
         'minidump_thread_id_map_test.cc',
         'minidump_thread_writer_test.cc',
+        'minidump_triage_summary_writer_test.cc',
         'minidump_unloaded_module_writer_test.cc',
         'minidump_user_stream_writer_test.cc',
         'minidump_writable_test.cc',
@@ -133,7 +133,9 @@ MinidumpThreadListWriter::MinidumpThreadListWriter()
     : MinidumpStreamWriter(),
       threads_(),
       memory_list_writer_(nullptr),
-      thread_list_base_() {
+      thread_list_base_(),
+      stack_thread_id_(0),
+      restrict_stacks_(false) {
 }
 
 MinidumpThreadListWriter::~MinidumpThreadListWriter() {
@@ -150,9 +152,16 @@ void MinidumpThreadListWriter::InitializeFromSnapshot(
   for (const ThreadSnapshot* thread_snapshot : thread_snapshots) {
     auto thread = base::WrapUnique(new MinidumpThreadWriter());
     thread->InitializeFromSnapshot(thread_snapshot, thread_id_map);
+    if (restrict_stacks_ && thread_snapshot->ThreadID() != stack_thread_id_) {
+      thread->SetStack(nullptr);
+    }
     AddThread(std::move(thread));
   }
 
+  if (restrict_stacks_) {
+    return;
+  }
+
   // Do this in a separate loop to keep the thread stacks earlier in the dump,
   // and together.
   for (const ThreadSnapshot* thread_snapshot : thread_snapshots)
@@ -167,6 +176,14 @@ void MinidumpThreadListWriter::SetMemoryListWriter(
   memory_list_writer_ = memory_list_writer;
 }
 
+void MinidumpThreadListWriter::RestrictStacksToThread(uint64_t thread_id) {
+  DCHECK_EQ(state(), kStateMutable);
+  DCHECK(threads_.empty());
+
+  stack_thread_id_ = thread_id;
+  restrict_stacks_ = true;
+}
+
 void MinidumpThreadListWriter::AddThread(
     std::unique_ptr<MinidumpThreadWriter> thread) {
   DCHECK_EQ(state(), kStateMutable);
@@ -184,6 +184,20 @@ class MinidumpThreadListWriter final : public internal::MinidumpStreamWriter {
   //! \note Valid in #kStateMutable.
   void SetMemoryListWriter(MinidumpMemoryListWriter* memory_list_writer);
 
+  //! \brief Arranges for InitializeFromSnapshot() to record the stack of only
+  //!     one thread.
+  //!
+  //! All threads are still listed with their CPU contexts, but the stacks of
+  //! other threads, and the extra memory of every thread, are omitted. This
+  //! greatly reduces the size of a minidump file for a process with many
+  //! threads while retaining what is needed to examine the crashing thread.
+  //!
+  //! \param[in] thread_id The ThreadSnapshot::ThreadID() of the thread whose
+  //!     stack will be recorded.
+  //!
+  //! \note Valid in #kStateMutable, before InitializeFromSnapshot().
+  void RestrictStacksToThread(uint64_t thread_id);
+
   //! \brief Adds a MinidumpThreadWriter to the MINIDUMP_THREAD_LIST.
   //!
   //! This object takes ownership of \a thread and becomes its parent in the
@@ -206,6 +220,8 @@ class MinidumpThreadListWriter final : public internal::MinidumpStreamWriter {
   PointerVector<MinidumpThreadWriter> threads_;
   MinidumpMemoryListWriter* memory_list_writer_;  // weak
   MINIDUMP_THREAD_LIST thread_list_base_;
+  uint64_t stack_thread_id_;
+  bool restrict_stacks_;
 
   DISALLOW_COPY_AND_ASSIGN(MinidumpThreadListWriter);
 };
@@ -0,0 +1,351 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "minidump/minidump_triage_summary_writer.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "base/logging.h"
+#include "snapshot/cpu_context.h"
+#include "snapshot/exception_snapshot.h"
+#include "snapshot/memory_snapshot.h"
+#include "snapshot/module_snapshot.h"
+#include "snapshot/process_snapshot.h"
+#include "snapshot/thread_snapshot.h"
+#include "util/file/file_writer.h"
+#include "util/numeric/safe_assignment.h"
+
+namespace crashpad {
+
+namespace {
+
+// The largest portion of the crashing thread’s stack, starting at its stack
+// pointer, that will be scanned for frames.
+constexpr size_t kMaxStackScanBytes = 8192;
+
+constexpr uint64_t kFNVOffsetBasis = 0xcbf29ce484222325;
+constexpr uint64_t kFNVPrime = 0x100000001b3;
+
+void FNV1aHash(uint64_t* hash, const void* data, size_t size) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  for (size_t index = 0; index < size; ++index) {
+    *hash ^= bytes[index];
+    *hash *= kFNVPrime;
+  }
+}
+
+void FNV1aHashLittleEndian(uint64_t* hash, uint64_t value, size_t size) {
+  for (size_t index = 0; index < size; ++index) {
+    uint8_t byte = static_cast<uint8_t>(value >> (index * 8));
+    FNV1aHash(hash, &byte, sizeof(byte));
+  }
+}
+
+std::string BaseName(const std::string& path) {
+  size_t slash = path.find_last_of("/\\");
+  return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+// Truncates |string| to at most |size| bytes without splitting a UTF-8
+// sequence.
+std::string TruncateUTF8(const std::string& string, size_t size) {
+  if (string.size() <= size) {
+    return string;
+  }
+  while (size > 0 && (static_cast<uint8_t>(string[size]) & 0xc0) == 0x80) {
+    --size;
+  }
+  return string.substr(0, size);
+}
+
+struct ModuleRange {
+  uint64_t address;
+  uint64_t size;
+  std::string name;
+};
+
+// Finds the module in |modules|, sorted by address, that contains |address|.
+const ModuleRange* FindModule(const std::vector<ModuleRange>& modules,
+                              uint64_t address) {
+  auto it = std::upper_bound(
+      modules.begin(),
+      modules.end(),
+      address,
+      [](uint64_t address, const ModuleRange& module) {
+        return address < module.address;
+      });
+  if (it == modules.begin()) {
+    return nullptr;
+  }
+  --it;
+  return address - it->address < it->size ? &*it : nullptr;
+}
+
+class StackReadDelegate final : public MemorySnapshot::Delegate {
+ public:
+  explicit StackReadDelegate(std::vector<uint8_t>* contents)
+      : contents_(contents) {}
+  ~StackReadDelegate() override {}
+
+  // MemorySnapshot::Delegate:
+  bool MemorySnapshotDelegateRead(void* data, size_t size) override {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    contents_->assign(bytes, bytes + size);
+    return true;
+  }
+
+ private:
+  std::vector<uint8_t>* contents_;
+
+  DISALLOW_COPY_AND_ASSIGN(StackReadDelegate);
+};
+
+}  // namespace
+
+constexpr size_t MinidumpTriageSummaryWriter::kDefaultMaxFrames;
+constexpr size_t MinidumpTriageSummaryWriter::kMaxStringLength;
+
+MinidumpTriageSummaryWriter::MinidumpTriageSummaryWriter()
+    : MinidumpStreamWriter(),
+      summary_(),
+      frames_(),
+      annotations_(),
+      string_data_(),
+      string_offsets_() {
+  summary_.version = MinidumpTriageSummary::kVersion;
+}
+
+MinidumpTriageSummaryWriter::~MinidumpTriageSummaryWriter() {}
+
+void MinidumpTriageSummaryWriter::InitializeFromSnapshot(
+    const ProcessSnapshot* process_snapshot,
+    const std::vector<std::string>& annotation_keys,
+    size_t max_frames) {
+  DCHECK_EQ(state(), kStateMutable);
+  DCHECK(frames_.empty());
+  DCHECK(annotations_.empty());
+
+  std::vector<const ModuleSnapshot*> module_snapshots =
+      process_snapshot->Modules();
+
+  const ExceptionSnapshot* exception_snapshot = process_snapshot->Exception();
+  if (exception_snapshot) {
+    SetException(exception_snapshot->Exception(),
+                 exception_snapshot->ExceptionAddress());
+
+    std::vector<ModuleRange> modules;
+    modules.reserve(module_snapshots.size());
+    for (const ModuleSnapshot* module : module_snapshots) {
+      modules.push_back({module->Address(), module->Size(),
+                         BaseName(module->Name())});
+    }
+    std::sort(modules.begin(),
+              modules.end(),
+              [](const ModuleRange& lhs, const ModuleRange& rhs) {
+                return lhs.address < rhs.address;
+              });
+
+    auto add_frame = [this, &modules](uint64_t address) {
+      const ModuleRange* module = FindModule(modules, address);
+      if (module) {
+        AddFrame(module->name, address - module->address);
+      } else {
+        AddFrame(std::string(), address);
+      }
+    };
+
+    const CPUContext* context = exception_snapshot->Context();
+    if (max_frames > 0) {
+      add_frame(context->InstructionPointer());
+    }
+
+    const ThreadSnapshot* crashing_thread = nullptr;
+    for (const ThreadSnapshot* thread : process_snapshot->Threads()) {
+      if (thread->ThreadID() == exception_snapshot->ThreadID()) {
+        crashing_thread = thread;
+        break;
+      }
+    }
+
+    const MemorySnapshot* stack =
+        crashing_thread ? crashing_thread->Stack() : nullptr;
+    const size_t pointer_size =
+        context->architecture == kCPUArchitectureX86 ? 4 : 8;
+    const uint64_t stack_pointer = context->StackPointer();
+    std::vector<uint8_t> stack_contents;
+    StackReadDelegate delegate(&stack_contents);
+    if (frames_.size() < max_frames && stack &&
+        stack_pointer >= stack->Address() &&
+        stack_pointer - stack->Address() < stack->Size() &&
+        stack->Read(&delegate)) {
+      const size_t start =
+          static_cast<size_t>(stack_pointer - stack->Address());
+      const size_t end = std::min(stack_contents.size(),
+                                  start + kMaxStackScanBytes);
+      for (size_t offset = start;
+           offset + pointer_size <= end && frames_.size() < max_frames;
+           offset += pointer_size) {
+        uint64_t value = 0;
+        memcpy(&value, &stack_contents[offset], pointer_size);
+        if (FindModule(modules, value)) {
+          add_frame(value);
+        }
+      }
+    }
+  }
+
+  const std::map<std::string, std::string>& process_annotations =
+      process_snapshot->AnnotationsSimpleMap();
+  for (const std::string& key : annotation_keys) {
+    auto it = process_annotations.find(key);
+    if (it != process_annotations.end()) {
+      AddAnnotation(key, it->second);
+      continue;
+    }
+
+    for (const ModuleSnapshot* module : module_snapshots) {
+      const std::map<std::string, std::string> module_annotations =
+          module->AnnotationsSimpleMap();
+      auto module_it = module_annotations.find(key);
+      if (module_it != module_annotations.end()) {
+        AddAnnotation(key, module_it->second);
+        break;
+      }
+    }
+  }
+}
+
+void MinidumpTriageSummaryWriter::SetException(uint32_t exception_code,
+                                               uint64_t exception_address) {
+  DCHECK_EQ(state(), kStateMutable);
+
+  summary_.flags |= MinidumpTriageSummary::kFlagHasException;
+  summary_.exception_code = exception_code;
+  summary_.exception_address = exception_address;
+}
+
+void MinidumpTriageSummaryWriter::AddFrame(const std::string& module_name,
+                                           uint64_t address) {
+  DCHECK_EQ(state(), kStateMutable);
+
+  MinidumpTriageFrame frame;
+  frame.module_name_offset = module_name.empty()
+                                 ? MinidumpTriageFrame::kNoModule
+                                 : AddString(module_name);
+  frame.address = address;
+  frames_.push_back(frame);
+}
+
+void MinidumpTriageSummaryWriter::AddAnnotation(const std::string& key,
+                                                const std::string& value) {
+  DCHECK_EQ(state(), kStateMutable);
+
+  MinidumpTriageAnnotation annotation;
+  annotation.key_offset = AddString(key);
+  annotation.value_offset = AddString(value);
+  annotations_.push_back(annotation);
+}
+
+bool MinidumpTriageSummaryWriter::Freeze() {
+  DCHECK_EQ(state(), kStateMutable);
+
+  if (!MinidumpStreamWriter::Freeze()) {
+    return false;
+  }
+
+  if (!AssignIfInRange(&summary_.frame_count, frames_.size()) ||
+      !AssignIfInRange(&summary_.annotation_count, annotations_.size()) ||
+      !AssignIfInRange(&summary_.string_data_size, string_data_.size())) {
+    LOG(ERROR) << "triage summary too large";
+    return false;
+  }
+
+  uint64_t hash = kFNVOffsetBasis;
+  FNV1aHashLittleEndian(&hash, summary_.exception_code, sizeof(uint32_t));
+  for (const MinidumpTriageFrame& frame : frames_) {
+    if (frame.module_name_offset == MinidumpTriageFrame::kNoModule) {
+      FNV1aHash(&hash, "", 1);
+      continue;
+    }
+
+    // Hash the name including its NUL terminator.
+    const char* name = &string_data_[frame.module_name_offset];
+    FNV1aHash(&hash, name, strlen(name) + 1);
+    FNV1aHashLittleEndian(&hash, frame.address, sizeof(uint64_t));
+  }
+  summary_.signature_hash = hash;
+
+  return true;
+}
+
+size_t MinidumpTriageSummaryWriter::SizeOfObject() {
+  DCHECK_GE(state(), kStateFrozen);
+
+  return sizeof(summary_) + frames_.size() * sizeof(frames_[0]) +
+         annotations_.size() * sizeof(annotations_[0]) + string_data_.size();
+}
+
+bool MinidumpTriageSummaryWriter::WriteObject(
+    FileWriterInterface* file_writer) {
+  DCHECK_EQ(state(), kStateWritable);
+
+  WritableIoVec iov;
+  iov.iov_base = &summary_;
+  iov.iov_len = sizeof(summary_);
+  std::vector<WritableIoVec> iovecs(1, iov);
+
+  if (!frames_.empty()) {
+    iov.iov_base = &frames_[0];
+    iov.iov_len = frames_.size() * sizeof(frames_[0]);
+    iovecs.push_back(iov);
+  }
+
+  if (!annotations_.empty()) {
+    iov.iov_base = &annotations_[0];
+    iov.iov_len = annotations_.size() * sizeof(annotations_[0]);
+    iovecs.push_back(iov);
+  }
+
+  if (!string_data_.empty()) {
+    iov.iov_base = &string_data_[0];
+    iov.iov_len = string_data_.size();
+    iovecs.push_back(iov);
+  }
+
+  return file_writer->WriteIoVec(&iovecs);
+}
+
+MinidumpStreamType MinidumpTriageSummaryWriter::StreamType() const {
+  return kMinidumpStreamTypeCrashpadTriageSummary;
+}
+
+uint32_t MinidumpTriageSummaryWriter::AddString(const std::string& string) {
+  const std::string truncated = TruncateUTF8(string, kMaxStringLength);
+
+  auto it = string_offsets_.find(truncated);
+  if (it != string_offsets_.end()) {
+    return it->second;
+  }
+
+  const uint32_t offset = static_cast<uint32_t>(string_data_.size());
+  string_data_.append(truncated);
+  string_data_.push_back('\0');
+  string_offsets_.insert(std::make_pair(truncated, offset));
+  return offset;
+}
+
+}  // namespace crashpad
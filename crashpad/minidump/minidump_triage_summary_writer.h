@@ -0,0 +1,117 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_MINIDUMP_MINIDUMP_TRIAGE_SUMMARY_WRITER_H_
+#define CRASHPAD_MINIDUMP_MINIDUMP_TRIAGE_SUMMARY_WRITER_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "minidump/minidump_extensions.h"
+#include "minidump/minidump_stream_writer.h"
+
+namespace crashpad {
+
+class ProcessSnapshot;
+
+//! \brief The writer for a MinidumpTriageSummary stream in a minidump file.
+class MinidumpTriageSummaryWriter final
+    : public internal::MinidumpStreamWriter {
+ public:
+  //! \brief The number of frames that MinidumpFileWriter records.
+  static constexpr size_t kDefaultMaxFrames = 8;
+
+  //! \brief The maximum length of a string, in bytes. Longer module names,
+  //!     annotation keys, and annotation values are truncated.
+  static constexpr size_t kMaxStringLength = 255;
+
+  MinidumpTriageSummaryWriter();
+  ~MinidumpTriageSummaryWriter() override;
+
+  //! \brief Initializes the MinidumpTriageSummary based on \a process_snapshot.
+  //!
+  //! Crashpad does not unwind stacks, so frames are found heuristically. The
+  //! first frame is the exception’s instruction pointer. Subsequent frames are
+  //! the pointer-sized values on the crashing thread’s stack, scanning upwards
+  //! from its stack pointer, that lie within a module. Some of these may be
+  //! pointers to data rather than return addresses, but they are stable for a
+  //! given crash, which is what the signature hash requires.
+  //!
+  //! \param[in] process_snapshot The process snapshot to use as source data.
+  //! \param[in] annotation_keys The keys of the annotations to include. Each
+  //!     key is looked up first in ProcessSnapshot::AnnotationsSimpleMap(), and
+  //!     then in each module’s ModuleSnapshot::AnnotationsSimpleMap(). Keys
+  //!     that are not found are omitted.
+  //! \param[in] max_frames The maximum number of frames to record.
+  //!
+  //! \note Valid in #kStateMutable. No mutator methods may be called before
+  //!     this method, and it is not normally necessary to call any mutator
+  //!     methods after this method.
+  void InitializeFromSnapshot(const ProcessSnapshot* process_snapshot,
+                              const std::vector<std::string>& annotation_keys,
+                              size_t max_frames);
+
+  //! \brief Sets MinidumpTriageSummary::exception_code and
+  //!     MinidumpTriageSummary::exception_address, and sets
+  //!     MinidumpTriageSummary::kFlagHasException.
+  //!
+  //! \note Valid in #kStateMutable.
+  void SetException(uint32_t exception_code, uint64_t exception_address);
+
+  //! \brief Appends a frame.
+  //!
+  //! \param[in] module_name The base name of the module containing the frame,
+  //!     or an empty string if the frame is not within any module.
+  //! \param[in] address The module-relative address of the frame, or its
+  //!     absolute address if \a module_name is empty.
+  //!
+  //! \note Valid in #kStateMutable.
+  void AddFrame(const std::string& module_name, uint64_t address);
+
+  //! \brief Appends an annotation.
+  //!
+  //! \note Valid in #kStateMutable.
+  void AddAnnotation(const std::string& key, const std::string& value);
+
+ protected:
+  // MinidumpWritable:
+  bool Freeze() override;
+  size_t SizeOfObject() override;
+  bool WriteObject(FileWriterInterface* file_writer) override;
+
+  // MinidumpStreamWriter:
+  MinidumpStreamType StreamType() const override;
+
+ private:
+  // Adds |string|, truncated to kMaxStringLength, to string_data_ unless it is
+  // already present, and returns its offset.
+  uint32_t AddString(const std::string& string);
+
+  MinidumpTriageSummary summary_;
+  std::vector<MinidumpTriageFrame> frames_;
+  std::vector<MinidumpTriageAnnotation> annotations_;
+  std::string string_data_;
+  std::map<std::string, uint32_t> string_offsets_;
+
+  DISALLOW_COPY_AND_ASSIGN(MinidumpTriageSummaryWriter);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_MINIDUMP_MINIDUMP_TRIAGE_SUMMARY_WRITER_H_
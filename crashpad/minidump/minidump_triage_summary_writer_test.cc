@@ -0,0 +1,339 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "minidump/minidump_triage_summary_writer.h"
+
+#include <string.h>
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/memory/ptr_util.h"
+#include "gtest/gtest.h"
+#include "minidump/minidump_extensions.h"
+#include "minidump/minidump_file_writer.h"
+#include "minidump/test/minidump_file_writer_test_util.h"
+#include "minidump/test/minidump_writable_test_util.h"
+#include "snapshot/memory_snapshot.h"
+#include "snapshot/minidump/minidump_triage_summary_reader.h"
+#include "snapshot/test/test_cpu_context.h"
+#include "snapshot/test/test_exception_snapshot.h"
+#include "snapshot/test/test_module_snapshot.h"
+#include "snapshot/test/test_process_snapshot.h"
+#include "snapshot/test/test_system_snapshot.h"
+#include "snapshot/test/test_thread_snapshot.h"
+#include "util/file/string_file.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+constexpr uint64_t kThreadID = 5;
+constexpr uint32_t kExceptionCode = 11;
+constexpr uint64_t kStackAddress = 0x7000;
+
+// A MemorySnapshot with arbitrary contents.
+class BufferMemorySnapshot final : public MemorySnapshot {
+ public:
+  BufferMemorySnapshot(uint64_t address, const std::vector<uint64_t>& words)
+      : contents_(words), address_(address) {}
+  ~BufferMemorySnapshot() override {}
+
+  // MemorySnapshot:
+  uint64_t Address() const override { return address_; }
+  size_t Size() const override { return contents_.size() * sizeof(uint64_t); }
+  bool Read(Delegate* delegate) const override {
+    std::vector<uint64_t> contents(contents_);
+    return delegate->MemorySnapshotDelegateRead(&contents[0], Size());
+  }
+
+ private:
+  std::vector<uint64_t> contents_;
+  uint64_t address_;
+
+  DISALLOW_COPY_AND_ASSIGN(BufferMemorySnapshot);
+};
+
+// Builds a process that crashed in libfoo.so, with stack contents pointing
+// into libfoo.so and app. The modules are loaded at |module_bias| from their
+// usual addresses.
+void InitializeProcessSnapshot(TestProcessSnapshot* process_snapshot,
+                               uint64_t module_bias,
+                               uint64_t crash_offset) {
+  auto system_snapshot = base::WrapUnique(new TestSystemSnapshot());
+  system_snapshot->SetCPUArchitecture(kCPUArchitectureX86_64);
+  system_snapshot->SetOperatingSystem(SystemSnapshot::kOperatingSystemMacOSX);
+  process_snapshot->SetSystem(std::move(system_snapshot));
+
+  auto libfoo = base::WrapUnique(new TestModuleSnapshot());
+  libfoo->SetName("/usr/lib/libfoo.so");
+  libfoo->SetAddressAndSize(0x10000 + module_bias, 0x1000);
+  std::map<std::string, std::string> module_annotations;
+  module_annotations["prod"] = "Product";
+  module_annotations["ver"] = "2.0";
+  libfoo->SetAnnotationsSimpleMap(module_annotations);
+  process_snapshot->AddModule(std::move(libfoo));
+
+  auto app = base::WrapUnique(new TestModuleSnapshot());
+  app->SetName("/usr/bin/app");
+  app->SetAddressAndSize(0x400000 + module_bias, 0x10000);
+  process_snapshot->AddModule(std::move(app));
+
+  std::map<std::string, std::string> process_annotations;
+  process_annotations["ver"] = "1.0";
+  process_snapshot->SetAnnotationsSimpleMap(process_annotations);
+
+  auto exception = base::WrapUnique(new TestExceptionSnapshot());
+  exception->SetThreadID(kThreadID);
+  exception->SetException(kExceptionCode);
+  exception->SetExceptionAddress(0xdead);
+  CPUContext* context = exception->MutableContext();
+  InitializeCPUContextX86_64(context, 0);
+  context->x86_64->rip = 0x10000 + module_bias + crash_offset;
+  context->x86_64->rsp = kStackAddress + 0x10;
+  process_snapshot->SetException(std::move(exception));
+
+  auto thread = base::WrapUnique(new TestThreadSnapshot());
+  thread->SetThreadID(kThreadID);
+  InitializeCPUContextX86_64(thread->MutableContext(), 1);
+  thread->SetStack(base::WrapUnique(new BufferMemorySnapshot(
+      kStackAddress,
+      {0x10000 + module_bias,  // Below the stack pointer.
+       0x10010 + module_bias,  // Below the stack pointer.
+       0x1234,
+       0x400500 + module_bias,
+       0xffffffff00000000,
+       0x10200 + module_bias,
+       0x410000 + module_bias})));  // Just past the end of app.
+  process_snapshot->AddThread(std::move(thread));
+}
+
+TriageSummary WriteAndReadTriageSummary(
+    const ProcessSnapshot* process_snapshot,
+    const std::vector<std::string>& annotation_keys,
+    size_t max_frames) {
+  auto summary_writer = base::WrapUnique(new MinidumpTriageSummaryWriter());
+  summary_writer->InitializeFromSnapshot(
+      process_snapshot, annotation_keys, max_frames);
+
+  MinidumpFileWriter minidump_file_writer;
+  EXPECT_TRUE(minidump_file_writer.AddStream(std::move(summary_writer)));
+
+  StringFile string_file;
+  EXPECT_TRUE(minidump_file_writer.WriteEverything(&string_file));
+
+  TriageSummary summary;
+  EXPECT_TRUE(ReadMinidumpTriageSummary(
+      string_file.string().data(), string_file.string().size(), &summary));
+  return summary;
+}
+
+TEST(MinidumpTriageSummaryWriter, Empty) {
+  MinidumpFileWriter minidump_file_writer;
+  ASSERT_TRUE(minidump_file_writer.AddStream(
+      base::WrapUnique(new MinidumpTriageSummaryWriter())));
+
+  StringFile string_file;
+  ASSERT_TRUE(minidump_file_writer.WriteEverything(&string_file));
+
+  const MINIDUMP_DIRECTORY* directory;
+  const MINIDUMP_HEADER* header =
+      MinidumpHeaderAtStart(string_file.string(), &directory);
+  ASSERT_NO_FATAL_FAILURE(VerifyMinidumpHeader(header, 1, 0));
+  ASSERT_TRUE(directory);
+  EXPECT_EQ(directory[0].StreamType, kMinidumpStreamTypeCrashpadTriageSummary);
+  ASSERT_EQ(directory[0].Location.DataSize, sizeof(MinidumpTriageSummary));
+  const MinidumpTriageSummary* summary_base =
+      MinidumpWritableAtLocationDescriptor<MinidumpTriageSummary>(
+          string_file.string(), directory[0].Location);
+  ASSERT_TRUE(summary_base);
+  EXPECT_EQ(summary_base->version, MinidumpTriageSummary::kVersion);
+  EXPECT_EQ(summary_base->flags, 0u);
+  EXPECT_EQ(summary_base->frame_count, 0u);
+  EXPECT_EQ(summary_base->annotation_count, 0u);
+  EXPECT_EQ(summary_base->string_data_size, 0u);
+
+  TriageSummary summary;
+  ASSERT_TRUE(ReadMinidumpTriageSummary(
+      string_file.string().data(), string_file.string().size(), &summary));
+  EXPECT_FALSE(summary.has_exception);
+  EXPECT_TRUE(summary.frames.empty());
+  EXPECT_TRUE(summary.annotations.empty());
+}
+
+TEST(MinidumpTriageSummaryWriter, InitializeFromSnapshot) {
+  TestProcessSnapshot process_snapshot;
+  InitializeProcessSnapshot(&process_snapshot, 0, 0x100);
+
+  TriageSummary summary = WriteAndReadTriageSummary(
+      &process_snapshot, {"prod", "ver", "missing"}, 8);
+
+  EXPECT_TRUE(summary.has_exception);
+  EXPECT_EQ(summary.exception_code, kExceptionCode);
+  EXPECT_EQ(summary.exception_address, 0xdeadu);
+
+  ASSERT_EQ(summary.frames.size(), 3u);
+  EXPECT_EQ(summary.frames[0].module_name, "libfoo.so");
+  EXPECT_EQ(summary.frames[0].address, 0x100u);
+  EXPECT_EQ(summary.frames[1].module_name, "app");
+  EXPECT_EQ(summary.frames[1].address, 0x500u);
+  EXPECT_EQ(summary.frames[2].module_name, "libfoo.so");
+  EXPECT_EQ(summary.frames[2].address, 0x200u);
+
+  // Process annotations take precedence over module annotations.
+  std::map<std::string, std::string> expected_annotations;
+  expected_annotations["prod"] = "Product";
+  expected_annotations["ver"] = "1.0";
+  EXPECT_EQ(summary.annotations, expected_annotations);
+
+  TriageSummary truncated_summary =
+      WriteAndReadTriageSummary(&process_snapshot, {}, 2);
+  ASSERT_EQ(truncated_summary.frames.size(), 2u);
+  EXPECT_EQ(truncated_summary.frames[1].module_name, "app");
+  EXPECT_TRUE(truncated_summary.annotations.empty());
+}
+
+TEST(MinidumpTriageSummaryWriter, SignatureHash) {
+  TestProcessSnapshot process_snapshot;
+  InitializeProcessSnapshot(&process_snapshot, 0, 0x100);
+  const uint64_t hash =
+      WriteAndReadTriageSummary(&process_snapshot, {}, 8).signature_hash;
+
+  // Frames without modules contribute only their position, and the hash
+  // follows its documented definition.
+  auto summary_writer = base::WrapUnique(new MinidumpTriageSummaryWriter());
+  summary_writer->SetException(kExceptionCode, 0);
+  summary_writer->AddFrame("libfoo.so", 0x100);
+  summary_writer->AddFrame(std::string(), 0x1234);
+  MinidumpFileWriter minidump_file_writer;
+  ASSERT_TRUE(minidump_file_writer.AddStream(std::move(summary_writer)));
+  StringFile string_file;
+  ASSERT_TRUE(minidump_file_writer.WriteEverything(&string_file));
+  TriageSummary summary;
+  ASSERT_TRUE(ReadMinidumpTriageSummary(
+      string_file.string().data(), string_file.string().size(), &summary));
+
+  std::string hashed_data;
+  const uint32_t exception_code = kExceptionCode;
+  hashed_data.append(reinterpret_cast<const char*>(&exception_code),
+                     sizeof(exception_code));
+  hashed_data.append("libfoo.so", sizeof("libfoo.so"));
+  const uint64_t address = 0x100;
+  hashed_data.append(reinterpret_cast<const char*>(&address), sizeof(address));
+  hashed_data.push_back('\0');
+  uint64_t expected_hash = 0xcbf29ce484222325;
+  for (char c : hashed_data) {
+    expected_hash ^= static_cast<uint8_t>(c);
+    expected_hash *= 0x100000001b3;
+  }
+  EXPECT_EQ(summary.signature_hash, expected_hash);
+
+  // The same crash with modules loaded elsewhere has the same hash.
+  TestProcessSnapshot relocated_process_snapshot;
+  InitializeProcessSnapshot(&relocated_process_snapshot, 0x7f0000000000, 0x100);
+  EXPECT_EQ(
+      WriteAndReadTriageSummary(&relocated_process_snapshot, {}, 8)
+          .signature_hash,
+      hash);
+
+  // A crash elsewhere has a different hash.
+  TestProcessSnapshot other_process_snapshot;
+  InitializeProcessSnapshot(&other_process_snapshot, 0, 0x104);
+  EXPECT_NE(
+      WriteAndReadTriageSummary(&other_process_snapshot, {}, 8).signature_hash,
+      hash);
+}
+
+TEST(MinidumpTriageSummaryWriter, TruncatedStrings) {
+  // A three-byte UTF-8 sequence straddling the length limit is dropped whole.
+  std::string value(MinidumpTriageSummaryWriter::kMaxStringLength - 1, 'v');
+  value.append("\xe2\x82\xac");
+
+  auto summary_writer = base::WrapUnique(new MinidumpTriageSummaryWriter());
+  summary_writer->AddAnnotation("key", value);
+  MinidumpFileWriter minidump_file_writer;
+  ASSERT_TRUE(minidump_file_writer.AddStream(std::move(summary_writer)));
+  StringFile string_file;
+  ASSERT_TRUE(minidump_file_writer.WriteEverything(&string_file));
+
+  TriageSummary summary;
+  ASSERT_TRUE(ReadMinidumpTriageSummary(
+      string_file.string().data(), string_file.string().size(), &summary));
+  EXPECT_EQ(summary.annotations["key"],
+            std::string(MinidumpTriageSummaryWriter::kMaxStringLength - 1,
+                        'v'));
+}
+
+TEST(MinidumpTriageSummaryWriter, MinidumpFileWriter) {
+  TestProcessSnapshot process_snapshot;
+  InitializeProcessSnapshot(&process_snapshot, 0, 0x100);
+
+  MinidumpFileWriter minidump_file_writer;
+  minidump_file_writer.SetTriageSummary(true, {"prod"});
+  minidump_file_writer.InitializeFromSnapshot(&process_snapshot);
+
+  StringFile string_file;
+  ASSERT_TRUE(minidump_file_writer.WriteEverything(&string_file));
+
+  // The summary immediately follows the stream directory.
+  const MINIDUMP_DIRECTORY* directory;
+  const MINIDUMP_HEADER* header =
+      MinidumpHeaderAtStart(string_file.string(), &directory);
+  ASSERT_TRUE(header);
+  ASSERT_TRUE(directory);
+  EXPECT_EQ(directory[0].StreamType, kMinidumpStreamTypeCrashpadTriageSummary);
+  EXPECT_EQ(directory[0].Location.Rva,
+            sizeof(MINIDUMP_HEADER) +
+                header->NumberOfStreams * sizeof(MINIDUMP_DIRECTORY));
+  ASSERT_GT(string_file.string().size(), kMinidumpTriageSummaryReadSize);
+
+  // The summary can be decoded from the start of the file alone.
+  TriageSummary summary;
+  ASSERT_TRUE(ReadMinidumpTriageSummary(string_file.string().data(),
+                                        kMinidumpTriageSummaryReadSize,
+                                        &summary));
+  EXPECT_EQ(summary.exception_code, kExceptionCode);
+  EXPECT_EQ(summary.frames.size(), 3u);
+  EXPECT_EQ(summary.annotations["prod"], "Product");
+
+  // A prefix ending within the summary is not enough.
+  EXPECT_FALSE(ReadMinidumpTriageSummary(string_file.string().data(),
+                                         directory[0].Location.Rva + 8,
+                                         &summary));
+
+  TriageSummary file_summary;
+  ASSERT_TRUE(ReadMinidumpTriageSummary(&string_file, &file_summary));
+  EXPECT_EQ(file_summary.signature_hash, summary.signature_hash);
+}
+
+TEST(MinidumpTriageSummaryWriter, NoTriageSummary) {
+  TestProcessSnapshot process_snapshot;
+  InitializeProcessSnapshot(&process_snapshot, 0, 0x100);
+
+  MinidumpFileWriter minidump_file_writer;
+  minidump_file_writer.InitializeFromSnapshot(&process_snapshot);
+
+  StringFile string_file;
+  ASSERT_TRUE(minidump_file_writer.WriteEverything(&string_file));
+
+  TriageSummary summary;
+  EXPECT_FALSE(ReadMinidumpTriageSummary(&string_file, &summary));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
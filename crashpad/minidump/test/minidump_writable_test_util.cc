@@ -215,6 +215,22 @@ struct MinidumpModuleCrashpadInfoListTraits {
   }
 };
 
+struct MinidumpFileBackedMemoryListTraits {
+  using ListType = MinidumpFileBackedMemoryList;
+  enum : size_t { kElementSize = sizeof(MinidumpFileBackedMemoryDescriptor) };
+  static size_t ElementCount(const ListType* list) {
+    return list->count;
+  }
+};
+
+struct MinidumpDeduplicatedMemoryListTraits {
+  using ListType = MinidumpDeduplicatedMemoryList;
+  enum : size_t { kElementSize = sizeof(MinidumpDeduplicatedMemoryRange) };
+  static size_t ElementCount(const ListType* list) {
+    return list->range_count;
+  }
+};
+
 struct MinidumpSimpleStringDictionaryListTraits {
   using ListType = MinidumpSimpleStringDictionary;
   enum : size_t { kElementSize = sizeof(MinidumpSimpleStringDictionaryEntry) };
@@ -304,6 +320,24 @@ MinidumpWritableAtLocationDescriptor<MinidumpModuleCrashpadInfoList>(
       file_contents, location);
 }
 
+template <>
+const MinidumpFileBackedMemoryList*
+MinidumpWritableAtLocationDescriptor<MinidumpFileBackedMemoryList>(
+    const std::string& file_contents,
+    const MINIDUMP_LOCATION_DESCRIPTOR& location) {
+  return MinidumpListAtLocationDescriptor<MinidumpFileBackedMemoryListTraits>(
+      file_contents, location);
+}
+
+template <>
+const MinidumpDeduplicatedMemoryList*
+MinidumpWritableAtLocationDescriptor<MinidumpDeduplicatedMemoryList>(
+    const std::string& file_contents,
+    const MINIDUMP_LOCATION_DESCRIPTOR& location) {
+  return MinidumpListAtLocationDescriptor<
+      MinidumpDeduplicatedMemoryListTraits>(file_contents, location);
+}
+
 template <>
 const MinidumpSimpleStringDictionary*
 MinidumpWritableAtLocationDescriptor<MinidumpSimpleStringDictionary>(
@@ -0,0 +1,145 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "snapshot/elf/elf_core_process_memory.h"
+
+#include <elf.h>
+#include <string.h>
+
+#include "base/logging.h"
+#include "base/numerics/safe_math.h"
+#include "build/build_config.h"
+
+namespace crashpad {
+
+ElfCoreProcessMemory::ElfCoreProcessMemory()
+    : source_(), memory_(), is_64_bit_(false), initialized_() {}
+
+ElfCoreProcessMemory::~ElfCoreProcessMemory() {}
+
+bool ElfCoreProcessMemory::Initialize(const base::FilePath& path) {
+  INITIALIZATION_STATE_SET_INITIALIZING(initialized_);
+
+  if (!source_.Initialize(path)) {
+    return false;
+  }
+
+  unsigned char ident[EI_NIDENT];
+  if (!source_.ReadFileRange(0, sizeof(ident), &ident)) {
+    return false;
+  }
+  if (memcmp(ident, ELFMAG, SELFMAG) != 0) {
+    LOG(ERROR) << "not an ELF file";
+    return false;
+  }
+
+#if defined(ARCH_CPU_LITTLE_ENDIAN)
+  constexpr unsigned char kNativeData = ELFDATA2LSB;
+#else
+  constexpr unsigned char kNativeData = ELFDATA2MSB;
+#endif  // ARCH_CPU_LITTLE_ENDIAN
+  if (ident[EI_DATA] != kNativeData) {
+    LOG(ERROR) << "unsupported byte order " << static_cast<int>(ident[EI_DATA]);
+    return false;
+  }
+
+  switch (ident[EI_CLASS]) {
+    case ELFCLASS32:
+      is_64_bit_ = false;
+      if (!AddLoadSegments<Elf32_Ehdr, Elf32_Phdr, Elf32_Shdr>()) {
+        return false;
+      }
+      break;
+    case ELFCLASS64:
+      is_64_bit_ = true;
+      if (!AddLoadSegments<Elf64_Ehdr, Elf64_Phdr, Elf64_Shdr>()) {
+        return false;
+      }
+      break;
+    default:
+      LOG(ERROR) << "unknown class " << static_cast<int>(ident[EI_CLASS]);
+      return false;
+  }
+
+  if (!memory_.InitializeWithSource(&source_)) {
+    return false;
+  }
+
+  INITIALIZATION_STATE_SET_VALID(initialized_);
+  return true;
+}
+
+bool ElfCoreProcessMemory::Is64Bit() const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  return is_64_bit_;
+}
+
+const ProcessMemory* ElfCoreProcessMemory::Memory() const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  return &memory_;
+}
+
+template <typename Ehdr, typename Phdr, typename Shdr>
+bool ElfCoreProcessMemory::AddLoadSegments() {
+  Ehdr header;
+  if (!source_.ReadFileRange(0, sizeof(header), &header)) {
+    return false;
+  }
+  if (header.e_type != ET_CORE) {
+    LOG(ERROR) << "not a core file, type " << header.e_type;
+    return false;
+  }
+  if (header.e_phentsize != sizeof(Phdr)) {
+    LOG(ERROR) << "unexpected program header size " << header.e_phentsize;
+    return false;
+  }
+
+  // A core file with too many segments to count in e_phnum keeps the count in
+  // the first section header instead.
+  uint64_t segment_count = header.e_phnum;
+  if (segment_count == PN_XNUM) {
+    Shdr section_header;
+    if (!source_.ReadFileRange(
+            header.e_shoff, sizeof(section_header), &section_header)) {
+      return false;
+    }
+    segment_count = section_header.sh_info;
+  }
+
+  for (uint64_t index = 0; index < segment_count; ++index) {
+    Phdr program_header;
+    base::CheckedNumeric<uint64_t> offset = index;
+    offset *= sizeof(program_header);
+    offset += header.e_phoff;
+    if (!offset.IsValid()) {
+      LOG(ERROR) << "program header outside of file";
+      return false;
+    }
+    if (!source_.ReadFileRange(
+            offset.ValueOrDie(), sizeof(program_header), &program_header)) {
+      return false;
+    }
+    if (program_header.p_type != PT_LOAD || program_header.p_filesz == 0) {
+      continue;
+    }
+    if (!source_.AddRange(program_header.p_vaddr,
+                          program_header.p_offset,
+                          program_header.p_filesz)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace crashpad
@@ -0,0 +1,66 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_SNAPSHOT_ELF_ELF_CORE_PROCESS_MEMORY_H_
+#define CRASHPAD_SNAPSHOT_ELF_ELF_CORE_PROCESS_MEMORY_H_
+
+#include "base/files/file_path.h"
+#include "base/macros.h"
+#include "util/misc/initialization_state_dcheck.h"
+#include "util/process/mapped_file_memory_source.h"
+#include "util/process/process_memory.h"
+
+namespace crashpad {
+
+//! \brief Reads the memory of a process from an ELF core file.
+//!
+//! The memory is served from the file’s `PT_LOAD` segments, so the same
+//! readers used on a live process, such as ElfImageReader, can be used on the
+//! core file. Only the parts of each segment present in the file are served.
+//! The parts that the kernel omitted from the file, such as unmodified
+//! file-backed mappings, can’t be read.
+class ElfCoreProcessMemory {
+ public:
+  ElfCoreProcessMemory();
+  ~ElfCoreProcessMemory();
+
+  //! \brief Initializes this object to read memory from the core file at \a
+  //!     path.
+  //!
+  //! This method must be successfully called before calling any other.
+  //!
+  //! \return `true` on success. `false` on failure with a message logged.
+  bool Initialize(const base::FilePath& path);
+
+  //! \brief Returns `true` if the core file is of a 64-bit process.
+  bool Is64Bit() const;
+
+  //! \brief Returns the memory of the process.
+  const ProcessMemory* Memory() const;
+
+ private:
+  template <typename Ehdr, typename Phdr, typename Shdr>
+  bool AddLoadSegments();
+
+  MappedFileMemorySource source_;
+  ProcessMemory memory_;
+  bool is_64_bit_;
+  InitializationStateDcheck initialized_;
+
+  DISALLOW_COPY_AND_ASSIGN(ElfCoreProcessMemory);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_SNAPSHOT_ELF_ELF_CORE_PROCESS_MEMORY_H_
@@ -0,0 +1,185 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "snapshot/elf/elf_core_process_memory.h"
+
+#include <dlfcn.h>
+#include <elf.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "build/build_config.h"
+#include "gtest/gtest.h"
+#include "snapshot/elf/elf_image_reader.h"
+#include "test/scoped_temp_dir.h"
+#include "util/file/file_io.h"
+#include "util/linux/memory_map.h"
+#include "util/misc/from_pointer_cast.h"
+#include "util/process/process_memory_range.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+#if defined(ARCH_CPU_64_BITS)
+using Ehdr = Elf64_Ehdr;
+using Phdr = Elf64_Phdr;
+constexpr unsigned char kElfClass = ELFCLASS64;
+#else
+using Ehdr = Elf32_Ehdr;
+using Phdr = Elf32_Phdr;
+constexpr unsigned char kElfClass = ELFCLASS32;
+#endif  // ARCH_CPU_64_BITS
+
+struct Segment {
+  VMAddress address;
+  std::string data;
+};
+
+// Copies the readable mappings of libc in this process.
+void ReadLibcSegments(VMAddress* libc_address, std::vector<Segment>* segments) {
+  Dl_info info;
+  ASSERT_TRUE(dladdr(reinterpret_cast<void*>(getpid), &info)) << "dladdr:"
+                                                              << dlerror();
+  *libc_address = FromPointerCast<VMAddress>(info.dli_fbase);
+
+  MemoryMap memory_map;
+  ASSERT_TRUE(memory_map.Initialize(getpid()));
+  ProcessMemory memory;
+  ASSERT_TRUE(memory.Initialize(getpid()));
+
+  const MemoryMap::Mapping* first = memory_map.FindMapping(*libc_address);
+  ASSERT_TRUE(first);
+  for (const MemoryMap::Mapping* mapping = first;
+       mapping && mapping->device == first->device &&
+       mapping->inode == first->inode;
+       mapping = memory_map.FindMapping(mapping->range.End())) {
+    if (!mapping->readable) {
+      continue;
+    }
+    Segment segment;
+    segment.address = mapping->range.Base();
+    segment.data.resize(mapping->range.Size());
+    ASSERT_TRUE(memory.Read(
+        segment.address, segment.data.size(), &segment.data[0]));
+    segments->push_back(segment);
+  }
+  ASSERT_FALSE(segments->empty());
+}
+
+base::FilePath WriteCoreFile(const ScopedTempDir& temp_dir,
+                             const std::vector<Segment>& segments) {
+  // A note and an empty PT_LOAD segment precede the segments with contents,
+  // as in core files written by the kernel.
+  std::vector<Phdr> program_headers(segments.size() + 2);
+  memset(&program_headers[0],
+         0,
+         program_headers.size() * sizeof(program_headers[0]));
+  program_headers[0].p_type = PT_NOTE;
+  program_headers[1].p_type = PT_LOAD;
+  program_headers[1].p_vaddr = 0x1000;
+  program_headers[1].p_memsz = 0x1000;
+
+  Ehdr header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.e_ident, ELFMAG, SELFMAG);
+  header.e_ident[EI_CLASS] = kElfClass;
+#if defined(ARCH_CPU_LITTLE_ENDIAN)
+  header.e_ident[EI_DATA] = ELFDATA2LSB;
+#else
+  header.e_ident[EI_DATA] = ELFDATA2MSB;
+#endif  // ARCH_CPU_LITTLE_ENDIAN
+  header.e_ident[EI_VERSION] = EV_CURRENT;
+  header.e_type = ET_CORE;
+  header.e_version = EV_CURRENT;
+  header.e_ehsize = sizeof(header);
+  header.e_phoff = sizeof(header);
+  header.e_phentsize = sizeof(Phdr);
+  header.e_phnum = program_headers.size();
+
+  size_t offset =
+      sizeof(header) + program_headers.size() * sizeof(program_headers[0]);
+  for (size_t index = 0; index < segments.size(); ++index) {
+    Phdr& program_header = program_headers[index + 2];
+    program_header.p_type = PT_LOAD;
+    program_header.p_vaddr = segments[index].address;
+    program_header.p_offset = offset;
+    program_header.p_filesz = segments[index].data.size();
+    program_header.p_memsz = segments[index].data.size();
+    offset += segments[index].data.size();
+  }
+
+  base::FilePath path = temp_dir.path().Append("core");
+  ScopedFileHandle handle(LoggingOpenFileForWrite(
+      path, FileWriteMode::kCreateOrFail, FilePermissions::kOwnerOnly));
+  EXPECT_TRUE(handle.is_valid());
+  CheckedWriteFile(handle.get(), &header, sizeof(header));
+  CheckedWriteFile(handle.get(),
+                   &program_headers[0],
+                   program_headers.size() * sizeof(program_headers[0]));
+  for (const Segment& segment : segments) {
+    CheckedWriteFile(handle.get(), segment.data.data(), segment.data.size());
+  }
+  return path;
+}
+
+TEST(ElfCoreProcessMemory, ReadLibc) {
+  VMAddress libc_address;
+  std::vector<Segment> segments;
+  ASSERT_NO_FATAL_FAILURE(ReadLibcSegments(&libc_address, &segments));
+
+  ScopedTempDir temp_dir;
+  ElfCoreProcessMemory core;
+  ASSERT_TRUE(core.Initialize(WriteCoreFile(temp_dir, segments)));
+#if defined(ARCH_CPU_64_BITS)
+  EXPECT_TRUE(core.Is64Bit());
+#else
+  EXPECT_FALSE(core.Is64Bit());
+#endif  // ARCH_CPU_64_BITS
+
+  std::string data(segments[0].data.size(), '\0');
+  ASSERT_TRUE(
+      core.Memory()->Read(segments[0].address, data.size(), &data[0]));
+  EXPECT_EQ(data, segments[0].data);
+
+  char byte;
+  EXPECT_FALSE(core.Memory()->Read(0x1000, 1, &byte));
+
+  ProcessMemoryRange range;
+  ASSERT_TRUE(range.Initialize(core.Memory(), core.Is64Bit()));
+  ElfImageReader reader;
+  ASSERT_TRUE(reader.Initialize(range, libc_address));
+
+  VMAddress symbol_address;
+  VMSize symbol_size;
+  ASSERT_TRUE(reader.GetDynamicSymbol("getpid", &symbol_address, &symbol_size));
+  EXPECT_EQ(symbol_address, FromPointerCast<VMAddress>(getpid));
+}
+
+TEST(ElfCoreProcessMemory, NotACoreFile) {
+  Dl_info info;
+  ASSERT_TRUE(dladdr(reinterpret_cast<void*>(getpid), &info)) << "dladdr:"
+                                                              << dlerror();
+
+  // libc is an ELF file, but not a core file.
+  ElfCoreProcessMemory core;
+  EXPECT_FALSE(core.Initialize(base::FilePath(info.dli_fname)));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
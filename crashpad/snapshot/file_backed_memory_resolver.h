@@ -0,0 +1,59 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_SNAPSHOT_FILE_BACKED_MEMORY_RESOLVER_H_
+#define CRASHPAD_SNAPSHOT_FILE_BACKED_MEMORY_RESOLVER_H_
+
+#include <stdint.h>
+
+#include <string>
+
+#include "snapshot/memory_snapshot.h"
+
+namespace crashpad {
+
+//! \brief An abstract interface to an object that determines whether memory
+//!     in a snapshot process is identical to the contents of a file.
+//!
+//! Memory that a minidump consumer can rebuild from a file that it already has,
+//! such as the text or read-only data of a module, need not be written to a
+//! minidump file. A reference to the file’s contents can be written in its
+//! place.
+class FileBackedMemoryResolver {
+ public:
+  virtual ~FileBackedMemoryResolver() {}
+
+  //! \brief Determines whether the contents of \a memory are identical to a
+  //!     range of a file.
+  //!
+  //! Implementations must only return `true` when \a memory is known to match
+  //! the file exactly. When in doubt, they must return `false`, so that the
+  //! memory is captured directly.
+  //!
+  //! \param[in] memory The memory to resolve.
+  //! \param[out] file_name The name of the file, in the form that the snapshot
+  //!     process knows it by.
+  //! \param[out] file_offset The offset within the file at which the contents
+  //!     of \a memory begin.
+  //!
+  //! \return `true` if \a memory is identical to the \a memory.Size() bytes of
+  //!     \a file_name beginning at \a file_offset. `false` otherwise.
+  virtual bool Resolve(const MemorySnapshot& memory,
+                       std::string* file_name,
+                       uint64_t* file_offset) = 0;
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_SNAPSHOT_FILE_BACKED_MEMORY_RESOLVER_H_
@@ -14,8 +14,11 @@
 
 #include "snapshot/linux/debug_rendezvous.h"
 
+#include <elf.h>
 #include <stdint.h>
+#include <string.h>
 
+#include <algorithm>
 #include <set>
 
 #include "base/logging.h"
@@ -27,11 +30,17 @@ namespace {
 struct Traits32 {
   using Integer = int32_t;
   using Address = uint32_t;
+  using Ehdr = Elf32_Ehdr;
+  using Phdr = Elf32_Phdr;
+  static constexpr unsigned char kElfClass = ELFCLASS32;
 };
 
 struct Traits64 {
   using Integer = int64_t;
   using Address = uint64_t;
+  using Ehdr = Elf64_Ehdr;
+  using Phdr = Elf64_Phdr;
+  static constexpr unsigned char kElfClass = ELFCLASS64;
 };
 
 template <typename Traits>
@@ -74,6 +83,71 @@ bool ReadLinkEntry(const ProcessMemoryRange& memory,
   return true;
 }
 
+// Reads the entries in the dynamic linker’s list of loaded objects, without
+// reading their names.
+template <typename Traits>
+bool ReadLinkEntriesWithoutNames(
+    const ProcessMemoryRange& memory,
+    LinuxVMAddress address,
+    std::vector<LinkEntrySpecific<Traits>>* entries) {
+  DebugRendezvousSpecific<Traits> debug;
+  if (!memory.Read(address, sizeof(debug), &debug)) {
+    return false;
+  }
+  if (debug.r_version != 1) {
+    LOG(ERROR) << "unexpected version " << debug.r_version;
+    return false;
+  }
+
+  std::set<LinuxVMAddress> visited;
+  LinuxVMAddress link_entry_address = debug.r_map;
+  while (link_entry_address) {
+    if (!visited.insert(link_entry_address).second) {
+      LOG(ERROR) << "cycle at address 0x" << std::hex << link_entry_address;
+      return false;
+    }
+
+    LinkEntrySpecific<Traits> entry;
+    if (!memory.Read(link_entry_address, sizeof(entry), &entry)) {
+      return false;
+    }
+    entries->push_back(entry);
+    link_entry_address = entry.l_next;
+  }
+
+  return true;
+}
+
+// Returns true if |mapping| could hold a module: the VDSO, or a mapped file
+// that isn’t a device or shared memory segment. Reading a device’s mapping
+// may fail or have side effects.
+bool IsModuleCandidate(const MemoryMap::Mapping& mapping) {
+  if (mapping.name == "[vdso]") {
+    return true;
+  }
+  return !mapping.name.empty() && mapping.name[0] == '/' &&
+         mapping.name.compare(0, 5, "/dev/") != 0 &&
+         mapping.name.compare(0, 5, "/SYSV") != 0;
+}
+
+// Reads |requests| in a batch. If that fails, each request is retried on its
+// own, so that one unreadable region doesn’t prevent the rest from being read.
+// |read| is set to whether each request was read.
+void ReadBatchOrEach(const ProcessMemoryRange& memory,
+                     const std::vector<ProcessMemory::ReadRequest>& requests,
+                     std::vector<bool>* read) {
+  if (memory.ReadBatch(requests)) {
+    read->assign(requests.size(), true);
+    return;
+  }
+
+  read->resize(requests.size());
+  for (size_t index = 0; index < requests.size(); ++index) {
+    const ProcessMemory::ReadRequest& request = requests[index];
+    (*read)[index] = memory.Read(request.address, request.size, request.buffer);
+  }
+}
+
 }  // namespace
 
 DebugRendezvous::LinkEntry::LinkEntry()
@@ -95,6 +169,25 @@ bool DebugRendezvous::Initialize(const ProcessMemoryRange& memory,
   return true;
 }
 
+bool DebugRendezvous::InitializeFromMemoryMap(const ProcessMemoryRange& memory,
+                                              const MemoryMap& memory_map) {
+  INITIALIZATION_STATE_SET_INITIALIZING(initialized_);
+  if (!(memory.Is64Bit()
+            ? InitializeFromMemoryMapSpecific<Traits64>(memory, memory_map)
+            : InitializeFromMemoryMapSpecific<Traits32>(memory, memory_map))) {
+    return false;
+  }
+  INITIALIZATION_STATE_SET_VALID(initialized_);
+  return true;
+}
+
+bool DebugRendezvous::Validate(const ProcessMemoryRange& memory,
+                               LinuxVMAddress address) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  return memory.Is64Bit() ? ValidateSpecific<Traits64>(memory, address)
+                          : ValidateSpecific<Traits32>(memory, address);
+}
+
 const DebugRendezvous::LinkEntry* DebugRendezvous::Executable() const {
   INITIALIZATION_STATE_DCHECK_VALID(initialized_);
   return &executable_;
@@ -140,4 +233,172 @@ bool DebugRendezvous::InitializeSpecific(const ProcessMemoryRange& memory,
   return true;
 }
 
+template <typename Traits>
+bool DebugRendezvous::InitializeFromMemoryMapSpecific(
+    const ProcessMemoryRange& memory,
+    const MemoryMap& memory_map) {
+  using Address = typename Traits::Address;
+  using Ehdr = typename Traits::Ehdr;
+  using Phdr = typename Traits::Phdr;
+
+  std::vector<const MemoryMap::Mapping*> mappings;
+  for (const MemoryMap::Mapping* mapping : memory_map.FindFileMmapStarts()) {
+    if (mapping->readable && mapping->range.Size() >= sizeof(Ehdr) &&
+        IsModuleCandidate(*mapping)) {
+      mappings.push_back(mapping);
+    }
+  }
+
+  // Read every candidate’s ELF header in one batch. Candidates whose header
+  // can’t be read are dropped.
+  std::vector<Ehdr> headers(mappings.size());
+  std::vector<ProcessMemory::ReadRequest> requests(mappings.size());
+  for (size_t index = 0; index < mappings.size(); ++index) {
+    requests[index].address = mappings[index]->range.Base();
+    requests[index].size = sizeof(Ehdr);
+    requests[index].buffer = &headers[index];
+  }
+  std::vector<bool> read;
+  ReadBatchOrEach(memory, requests, &read);
+
+  // Keep the candidates that are ELF images of the target’s bitness whose
+  // program headers lie within the mapping, and read all of those program
+  // headers in a second batch.
+  std::vector<size_t> elf_indices;
+  for (size_t index = 0; index < mappings.size(); ++index) {
+    const Ehdr& header = headers[index];
+    const LinuxVMSize mapping_size = mappings[index]->range.Size();
+    const LinuxVMSize table_size =
+        static_cast<LinuxVMSize>(header.e_phnum) * sizeof(Phdr);
+    if (read[index] && memcmp(header.e_ident, ELFMAG, SELFMAG) == 0 &&
+        header.e_ident[EI_CLASS] == Traits::kElfClass &&
+        (header.e_type == ET_EXEC || header.e_type == ET_DYN) &&
+        header.e_phentsize == sizeof(Phdr) && header.e_phnum > 0 &&
+        header.e_phoff <= mapping_size &&
+        table_size <= mapping_size - header.e_phoff) {
+      elf_indices.push_back(index);
+    }
+  }
+
+  std::vector<std::vector<Phdr>> program_headers(elf_indices.size());
+  requests.resize(elf_indices.size());
+  for (size_t elf_index = 0; elf_index < elf_indices.size(); ++elf_index) {
+    const size_t index = elf_indices[elf_index];
+    program_headers[elf_index].resize(headers[index].e_phnum);
+    requests[elf_index].address =
+        mappings[index]->range.Base() + headers[index].e_phoff;
+    requests[elf_index].size = headers[index].e_phnum * sizeof(Phdr);
+    requests[elf_index].buffer = program_headers[elf_index].data();
+  }
+  ReadBatchOrEach(memory, requests, &read);
+
+  bool found_executable = false;
+  for (size_t elf_index = 0; elf_index < elf_indices.size(); ++elf_index) {
+    if (!read[elf_index]) {
+      continue;
+    }
+
+    const size_t index = elf_indices[elf_index];
+    const MemoryMap::Mapping* mapping = mappings[index];
+
+    const Phdr* first_load = nullptr;
+    const Phdr* dynamic = nullptr;
+    bool has_interpreter = false;
+    for (const Phdr& phdr : program_headers[elf_index]) {
+      switch (phdr.p_type) {
+        case PT_LOAD:
+          if (!first_load) {
+            first_load = &phdr;
+          }
+          break;
+        case PT_DYNAMIC:
+          dynamic = &phdr;
+          break;
+        case PT_INTERP:
+          has_interpreter = true;
+          break;
+      }
+    }
+    if (!first_load) {
+      continue;
+    }
+
+    // The mapping at file offset 0 places the start of the file at its base,
+    // so the first loadable segment’s file offset identifies the address that
+    // the file’s start would have had without relocation.
+    const Address load_bias = static_cast<Address>(
+        mapping->range.Base() - (first_load->p_vaddr - first_load->p_offset));
+
+    LinkEntry entry;
+    entry.name = mapping->name;
+    entry.load_bias = load_bias;
+    entry.dynamic_array =
+        dynamic ? static_cast<Address>(dynamic->p_vaddr + load_bias) : 0;
+
+    if (!found_executable &&
+        (headers[index].e_type == ET_EXEC || has_interpreter)) {
+      found_executable = true;
+      executable_ = entry;
+    } else {
+      modules_.push_back(entry);
+    }
+  }
+
+  return true;
+}
+
+template <typename Traits>
+bool DebugRendezvous::ValidateSpecific(const ProcessMemoryRange& memory,
+                                       LinuxVMAddress address) {
+  std::vector<LinkEntrySpecific<Traits>> link_entries;
+  if (!ReadLinkEntriesWithoutNames<Traits>(memory, address, &link_entries)) {
+    return false;
+  }
+
+  const LinkEntry discovered_executable = executable_;
+  std::vector<LinkEntry> discovered;
+  discovered.swap(modules_);
+  discovered.push_back(discovered_executable);
+  executable_ = LinkEntry();
+
+  bool agrees = true;
+  for (size_t index = 0; index < link_entries.size(); ++index) {
+    const LinkEntrySpecific<Traits>& link_entry = link_entries[index];
+    if (!link_entry.l_ld) {
+      // Some loaders don’t record the executable’s dynamic array, so keep the
+      // executable that was discovered.
+      if (index == 0) {
+        executable_ = discovered_executable;
+      }
+      continue;
+    }
+
+    auto module = std::find_if(discovered.begin(),
+                               discovered.end(),
+                               [&link_entry](const LinkEntry& entry) {
+                                 return entry.dynamic_array == link_entry.l_ld;
+                               });
+    if (module == discovered.end()) {
+      LOG(ERROR) << "no module for dynamic array 0x" << std::hex
+                 << link_entry.l_ld;
+      agrees = false;
+      continue;
+    }
+
+    const LinuxVMOffset load_bias = link_entry.l_addr;
+    if (module->load_bias != load_bias) {
+      LOG(ERROR) << "load bias mismatch for " << module->name;
+      agrees = false;
+    }
+
+    if (index == 0) {
+      executable_ = *module;
+    } else {
+      modules_.push_back(*module);
+    }
+  }
+
+  return agrees;
+}
+
 }  // namespace crashpad
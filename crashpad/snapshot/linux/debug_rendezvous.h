@@ -20,6 +20,7 @@
 
 #include "base/macros.h"
 #include "util/linux/address_types.h"
+#include "util/linux/memory_map.h"
 #include "util/misc/initialization_state_dcheck.h"
 #include "util/process/process_memory_range.h"
 
@@ -62,6 +63,49 @@ class DebugRendezvous {
   //! \return `true` on success. `false` on failure with a message logged.
   bool Initialize(const ProcessMemoryRange& memory, LinuxVMAddress address);
 
+  //! \brief Initializes this object by finding the modules mapped in a target
+  //!     process.
+  //!
+  //! This is an alternative to Initialize() that doesn’t walk the dynamic
+  //! linker’s list of loaded objects. Walking that list requires reading each
+  //! entry and its name in turn, because each read depends on the previous
+  //! one. Here, modules are found in \a memory_map as mapped files that begin
+  //! with an ELF header. Their ELF headers are read in one batch, and their
+  //! program headers in another, so the number of round trips to the target
+  //! process doesn’t grow with the number of modules.
+  //!
+  //! Each LinkEntry is named by the path of its mapping. The executable is the
+  //! module of type `ET_EXEC`, or the lowest-addressed module that names a
+  //! program interpreter. Mapped files that have ELF headers but were not
+  //! loaded by the dynamic linker, such as those mapped for reading, are also
+  //! found. Use Validate() to remove them. Mapped devices are not examined,
+  //! and mapped files whose headers can’t be read are skipped.
+  //!
+  //! This method must be called successfully prior to calling any other method
+  //! in this class.
+  //!
+  //! \param[in] memory A memory reader for the remote process.
+  //! \param[in] memory_map The memory map of the remote process.
+  //! \return `true` on success. `false` on failure with a message logged.
+  bool InitializeFromMemoryMap(const ProcessMemoryRange& memory,
+                               const MemoryMap& memory_map);
+
+  //! \brief Confirms the modules found by InitializeFromMemoryMap() against
+  //!     the dynamic linker’s list of loaded objects.
+  //!
+  //! Entries in the list are matched to modules by their dynamic array
+  //! addresses. Only the entries themselves are read, not their names. Modules
+  //! that are not in the list are removed. If the first entry in the list, for
+  //! the executable, matches a module, that module becomes the executable.
+  //!
+  //! \param[in] memory A memory reader for the remote process.
+  //! \param[in] address The address of an `r_debug` struct in the remote
+  //!     process.
+  //! \return `true` if the list was read and every load bias it records
+  //!     agrees with the one that was computed for its module. `false`
+  //!     otherwise, with a message logged.
+  bool Validate(const ProcessMemoryRange& memory, LinuxVMAddress address);
+
   //! \brief Returns the LinkEntry for the main executable.
   const LinkEntry* Executable() const;
 
@@ -75,6 +119,12 @@ class DebugRendezvous {
   template <typename Traits>
   bool InitializeSpecific(const ProcessMemoryRange& memory,
                           LinuxVMAddress address);
+  template <typename Traits>
+  bool InitializeFromMemoryMapSpecific(const ProcessMemoryRange& memory,
+                                       const MemoryMap& memory_map);
+  template <typename Traits>
+  bool ValidateSpecific(const ProcessMemoryRange& memory,
+                        LinuxVMAddress address);
 
   std::vector<LinkEntry> modules_;
   LinkEntry executable_;
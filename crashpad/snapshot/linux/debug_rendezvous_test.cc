@@ -16,8 +16,10 @@
 
 #include <linux/auxvec.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <limits>
 
 #include "base/format_macros.h"
@@ -28,9 +30,12 @@
 #include "gtest/gtest.h"
 #include "snapshot/elf/elf_image_reader.h"
 #include "test/multiprocess.h"
+#include "test/scoped_temp_dir.h"
 #include "util/linux/address_types.h"
 #include "util/linux/auxiliary_vector.h"
+#include "util/file/file_io.h"
 #include "util/linux/memory_map.h"
+#include "util/posix/scoped_mmap.h"
 #include "util/process/process_memory.h"
 #include "util/process/process_memory_range.h"
 
@@ -182,6 +187,37 @@ void TestAgainstTarget(pid_t pid, bool is_64_bit) {
         is_64_bit, module_reader.Address(), module_reader.Size());
     EXPECT_TRUE(module_range.ContainsValue(module.dynamic_array));
   }
+
+  // Modules found in the memory map agree with the dynamic linker’s list.
+  DebugRendezvous discovered;
+  ASSERT_TRUE(discovered.InitializeFromMemoryMap(range, mappings));
+  EXPECT_EQ(discovered.Executable()->name, exe_mapping->name);
+  EXPECT_EQ(discovered.Executable()->load_bias, exe_reader.GetLoadBias());
+
+  for (const DebugRendezvous::LinkEntry& module : debug.Modules()) {
+    if (!module.dynamic_array) {
+      continue;
+    }
+    SCOPED_TRACE(module.name);
+    auto found = std::find_if(
+        discovered.Modules().begin(),
+        discovered.Modules().end(),
+        [&module](const DebugRendezvous::LinkEntry& entry) {
+          return entry.dynamic_array == module.dynamic_array;
+        });
+    ASSERT_NE(found, discovered.Modules().end());
+    EXPECT_EQ(found->load_bias, module.load_bias);
+  }
+
+  ASSERT_TRUE(discovered.Validate(range, debug_address));
+  size_t linked_modules = std::count_if(
+      debug.Modules().begin(),
+      debug.Modules().end(),
+      [](const DebugRendezvous::LinkEntry& entry) {
+        return entry.dynamic_array != 0;
+      });
+  EXPECT_EQ(discovered.Modules().size(), linked_modules);
+  EXPECT_EQ(discovered.Executable()->name, exe_mapping->name);
 }
 
 TEST(DebugRendezvous, Self) {
@@ -220,6 +256,48 @@ TEST(DebugRendezvous, Child) {
   test.Run();
 }
 
+TEST(DebugRendezvous, UnreadableMapping) {
+#if defined(ARCH_CPU_64_BITS)
+  constexpr bool is_64_bit = true;
+#else
+  constexpr bool is_64_bit = false;
+#endif
+
+  // A mapped file that has been truncated is still listed as readable, but
+  // reading it fails. It’s skipped without preventing the other modules from
+  // being found.
+  ScopedTempDir temp_dir;
+  const base::FilePath path = temp_dir.path().Append("truncated");
+  ScopedFileHandle handle(LoggingOpenFileForReadAndWrite(
+      path, FileWriteMode::kCreateOrFail, FilePermissions::kOwnerOnly));
+  ASSERT_TRUE(handle.is_valid());
+  const std::string contents(getpagesize(), 'x');
+  ASSERT_TRUE(
+      LoggingWriteFile(handle.get(), contents.data(), contents.size()));
+
+  ScopedMmap mapping;
+  ASSERT_TRUE(mapping.ResetMmap(
+      nullptr, contents.size(), PROT_READ, MAP_SHARED, handle.get(), 0));
+  ASSERT_TRUE(LoggingTruncateFile(handle.get()));
+
+  MemoryMap mappings;
+  ASSERT_TRUE(mappings.Initialize(getpid()));
+  const MemoryMap::Mapping* truncated_mapping =
+      mappings.FindMapping(mapping.addr_as<LinuxVMAddress>());
+  ASSERT_TRUE(truncated_mapping);
+  ASSERT_TRUE(truncated_mapping->readable);
+
+  ProcessMemory memory;
+  ASSERT_TRUE(memory.Initialize(getpid()));
+  ProcessMemoryRange range;
+  ASSERT_TRUE(range.Initialize(&memory, is_64_bit));
+
+  DebugRendezvous discovered;
+  ASSERT_TRUE(discovered.InitializeFromMemoryMap(range, mappings));
+  EXPECT_FALSE(discovered.Executable()->name.empty());
+  EXPECT_FALSE(discovered.Modules().empty());
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace crashpad
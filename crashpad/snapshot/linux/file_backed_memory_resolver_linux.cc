@@ -0,0 +1,119 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "snapshot/linux/file_backed_memory_resolver_linux.h"
+
+#include <fcntl.h>
+#include <linux/kdev_t.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "base/files/scoped_file.h"
+#include "base/posix/eintr_wrapper.h"
+
+namespace crashpad {
+
+namespace {
+
+// Compares memory delivered by MemorySnapshot::Read() with the contents of a
+// file.
+class FileComparingDelegate final : public MemorySnapshot::Delegate {
+ public:
+  FileComparingDelegate(int fd, off_t offset) : fd_(fd), offset_(offset) {}
+  ~FileComparingDelegate() override {}
+
+  // MemorySnapshot::Delegate:
+  bool MemorySnapshotDelegateRead(void* data, size_t size) override {
+    const char* memory = static_cast<const char*>(data);
+    char buffer[4096];
+    size_t compared = 0;
+    while (compared < size) {
+      const size_t chunk = std::min(sizeof(buffer), size - compared);
+      const ssize_t rv = HANDLE_EINTR(pread(fd_, buffer, chunk, offset_));
+      if (rv <= 0) {
+        // The mapping extends beyond the end of the file, or the file can’t be
+        // read. Either way, the memory can’t be rebuilt from the file.
+        return false;
+      }
+      if (memcmp(buffer, memory + compared, rv) != 0) {
+        return false;
+      }
+      compared += rv;
+      offset_ += rv;
+    }
+    return true;
+  }
+
+ private:
+  int fd_;
+  off_t offset_;
+
+  DISALLOW_COPY_AND_ASSIGN(FileComparingDelegate);
+};
+
+}  // namespace
+
+FileBackedMemoryResolverLinux::FileBackedMemoryResolverLinux(
+    const MemoryMap* memory_map)
+    : FileBackedMemoryResolver(), memory_map_(memory_map) {}
+
+FileBackedMemoryResolverLinux::~FileBackedMemoryResolverLinux() {}
+
+bool FileBackedMemoryResolverLinux::Resolve(const MemorySnapshot& memory,
+                                            std::string* file_name,
+                                            uint64_t* file_offset) {
+  const LinuxVMAddress address = memory.Address();
+  const LinuxVMSize size = memory.Size();
+  if (size == 0) {
+    return false;
+  }
+
+  const MemoryMap::Mapping* mapping = memory_map_->FindMapping(address);
+  if (!mapping || mapping->inode == 0 || mapping->writable ||
+      !mapping->readable || mapping->name.empty() ||
+      mapping->name[0] != '/' ||
+      size > mapping->range.End() - address) {
+    return false;
+  }
+
+  base::ScopedFD fd(
+      HANDLE_EINTR(open(mapping->name.c_str(), O_RDONLY | O_CLOEXEC)));
+  if (!fd.is_valid()) {
+    return false;
+  }
+
+  // Make sure that the file is the one that’s mapped, and hasn’t been replaced
+  // since. MemoryMap encodes devices in the kernel’s format.
+  struct stat st;
+  if (fstat(fd.get(), &st) != 0 || st.st_ino != mapping->inode ||
+      MKDEV(major(st.st_dev), minor(st.st_dev)) != mapping->device) {
+    return false;
+  }
+
+  const off_t offset = mapping->offset + (address - mapping->range.Base());
+  FileComparingDelegate delegate(fd.get(), offset);
+  if (!memory.Read(&delegate)) {
+    return false;
+  }
+
+  *file_name = mapping->name;
+  *file_offset = offset;
+  return true;
+}
+
+}  // namespace crashpad
@@ -0,0 +1,59 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_SNAPSHOT_LINUX_FILE_BACKED_MEMORY_RESOLVER_LINUX_H_
+#define CRASHPAD_SNAPSHOT_LINUX_FILE_BACKED_MEMORY_RESOLVER_LINUX_H_
+
+#include <stdint.h>
+
+#include <string>
+
+#include "base/macros.h"
+#include "snapshot/file_backed_memory_resolver.h"
+#include "util/linux/memory_map.h"
+
+namespace crashpad {
+
+//! \brief A FileBackedMemoryResolver for a process on the running system, when
+//!     the system runs Linux.
+//!
+//! Memory is resolved when it lies entirely within a clean file-backed mapping:
+//! a MemoryMap::Mapping with an inode that is not writable. That alone is not
+//! sufficient, because a private mapping may have been written before being
+//! made read-only, as happens to relocated data made read-only after
+//! relocation. The file is therefore opened, checked to be the same file that
+//! is mapped, and compared with the memory’s contents. Memory that does not
+//! match, or a file that cannot be opened from the handler’s point of view, is
+//! left to be captured directly.
+class FileBackedMemoryResolverLinux final : public FileBackedMemoryResolver {
+ public:
+  //! \param[in] memory_map The mappings of the snapshot process. The caller
+  //!     retains ownership of this object, which must outlive this object.
+  explicit FileBackedMemoryResolverLinux(const MemoryMap* memory_map);
+  ~FileBackedMemoryResolverLinux() override;
+
+  // FileBackedMemoryResolver:
+  bool Resolve(const MemorySnapshot& memory,
+               std::string* file_name,
+               uint64_t* file_offset) override;
+
+ private:
+  const MemoryMap* memory_map_;  // weak
+
+  DISALLOW_COPY_AND_ASSIGN(FileBackedMemoryResolverLinux);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_SNAPSHOT_LINUX_FILE_BACKED_MEMORY_RESOLVER_LINUX_H_
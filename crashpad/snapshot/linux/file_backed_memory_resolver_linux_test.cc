@@ -0,0 +1,152 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "snapshot/linux/file_backed_memory_resolver_linux.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "gtest/gtest.h"
+#include "snapshot/test/test_memory_snapshot.h"
+#include "test/scoped_temp_dir.h"
+#include "util/file/file_io.h"
+#include "util/posix/scoped_mmap.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+constexpr char kFileValue = 'x';
+
+class FileBackedMemoryResolverLinuxTest : public testing::Test {
+ protected:
+  FileBackedMemoryResolverLinuxTest()
+      : temp_dir_(),
+        mapping_(),
+        mapped_file_name_(),
+        page_size_(getpagesize()) {}
+
+  // Creates a file of kFileValue bytes of size file_size, and maps map_size
+  // bytes of it with the given protection and flags.
+  void MapFile(size_t file_size, size_t map_size, int prot, int flags) {
+    base::FilePath path = temp_dir_.path().Append(FILE_PATH_LITERAL("file"));
+    ScopedFileHandle handle(LoggingOpenFileForReadAndWrite(
+        path, FileWriteMode::kTruncateOrCreate, FilePermissions::kOwnerOnly));
+    ASSERT_TRUE(handle.is_valid());
+    const std::string contents(file_size, kFileValue);
+    ASSERT_TRUE(
+        LoggingWriteFile(handle.get(), contents.data(), contents.size()));
+    ASSERT_TRUE(
+        mapping_.ResetMmap(nullptr, map_size, prot, flags, handle.get(), 0));
+  }
+
+  // Resolves a TestMemorySnapshot of size bytes of value at offset within the
+  // mapping.
+  bool Resolve(size_t offset,
+               size_t size,
+               char value,
+               std::string* file_name,
+               uint64_t* file_offset) {
+    MemoryMap memory_map;
+    EXPECT_TRUE(memory_map.Initialize(getpid()));
+
+    TestMemorySnapshot memory;
+    memory.SetAddress(mapping_.addr_as<LinuxVMAddress>() + offset);
+    memory.SetSize(size);
+    memory.SetValue(value);
+
+    const MemoryMap::Mapping* mapping =
+        memory_map.FindMapping(mapping_.addr_as<LinuxVMAddress>());
+    EXPECT_TRUE(mapping);
+    if (mapping) {
+      mapped_file_name_ = mapping->name;
+    }
+
+    FileBackedMemoryResolverLinux resolver(&memory_map);
+    return resolver.Resolve(memory, file_name, file_offset);
+  }
+
+  const std::string& mapped_file_name() const { return mapped_file_name_; }
+  size_t page_size() const { return page_size_; }
+  ScopedMmap* mapping() { return &mapping_; }
+
+ private:
+  ScopedTempDir temp_dir_;
+  ScopedMmap mapping_;
+  std::string mapped_file_name_;
+  size_t page_size_;
+
+  DISALLOW_COPY_AND_ASSIGN(FileBackedMemoryResolverLinuxTest);
+};
+
+TEST_F(FileBackedMemoryResolverLinuxTest, ReadOnlyFileMapping) {
+  ASSERT_NO_FATAL_FAILURE(
+      MapFile(3 * page_size(), 3 * page_size(), PROT_READ, MAP_PRIVATE));
+
+  std::string file_name;
+  uint64_t file_offset;
+  ASSERT_TRUE(Resolve(
+      page_size() + 0x40, 0x100, kFileValue, &file_name, &file_offset));
+  EXPECT_EQ(file_name, mapped_file_name());
+  EXPECT_EQ(file_offset, page_size() + 0x40);
+
+  // The whole mapping.
+  ASSERT_TRUE(
+      Resolve(0, 3 * page_size(), kFileValue, &file_name, &file_offset));
+  EXPECT_EQ(file_offset, 0u);
+
+  // Memory that differs from the file, as a private mapping may after being
+  // written and then made read-only.
+  EXPECT_FALSE(Resolve(0, 0x100, 'y', &file_name, &file_offset));
+
+  // Memory that extends beyond the end of the mapping.
+  EXPECT_FALSE(Resolve(
+      3 * page_size() - 0x10, 0x20, kFileValue, &file_name, &file_offset));
+}
+
+TEST_F(FileBackedMemoryResolverLinuxTest, BeyondEndOfFile) {
+  ASSERT_NO_FATAL_FAILURE(MapFile(
+      2 * page_size() + 0x100, 3 * page_size(), PROT_READ, MAP_PRIVATE));
+
+  std::string file_name;
+  uint64_t file_offset;
+  EXPECT_TRUE(
+      Resolve(2 * page_size(), 0x100, kFileValue, &file_name, &file_offset));
+  EXPECT_FALSE(Resolve(
+      2 * page_size() + 0x80, 0x100, kFileValue, &file_name, &file_offset));
+}
+
+TEST_F(FileBackedMemoryResolverLinuxTest, WritableFileMapping) {
+  ASSERT_NO_FATAL_FAILURE(MapFile(
+      page_size(), page_size(), PROT_READ | PROT_WRITE, MAP_SHARED));
+
+  std::string file_name;
+  uint64_t file_offset;
+  EXPECT_FALSE(Resolve(0, 0x100, kFileValue, &file_name, &file_offset));
+}
+
+TEST_F(FileBackedMemoryResolverLinuxTest, AnonymousMapping) {
+  ASSERT_TRUE(mapping()->ResetMmap(
+      nullptr, page_size(), PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+
+  std::string file_name;
+  uint64_t file_offset;
+  EXPECT_FALSE(Resolve(0, 0x100, 0, &file_name, &file_offset));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
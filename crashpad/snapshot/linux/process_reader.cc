@@ -14,21 +14,15 @@
 
 #include "snapshot/linux/process_reader.h"
 
-#include <dirent.h>
-#include <errno.h>
-#include <sched.h>
-#include <stdio.h>
-#include <string.h>
-#include <sys/resource.h>
 #include <unistd.h>
 
 #include <algorithm>
+#include <string>
 
+#include "base/files/file_path.h"
 #include "base/logging.h"
-#include "base/strings/string_number_conversions.h"
 #include "build/build_config.h"
 #include "util/linux/proc_stat_reader.h"
-#include "util/posix/scoped_dir.h"
 
 namespace crashpad {
 
@@ -53,37 +47,14 @@ ProcessReader::Thread::Thread()
 
 ProcessReader::Thread::~Thread() {}
 
-bool ProcessReader::Thread::InitializePtrace(PtraceConnection* connection) {
-  if (!connection->GetThreadInfo(tid, &thread_info)) {
-    return false;
-  }
-
-  // TODO(jperaza): Starting with Linux 3.14, scheduling policy, static
-  // priority, and nice value can be collected all in one call with
-  // sched_getattr().
-  int res = sched_getscheduler(tid);
-  if (res < 0) {
-    PLOG(ERROR) << "sched_getscheduler";
-    return false;
-  }
-  sched_policy = res;
-
-  sched_param param;
-  if (sched_getparam(tid, &param) != 0) {
-    PLOG(ERROR) << "sched_getparam";
-    return false;
-  }
-  static_priority = param.sched_priority;
-
-  errno = 0;
-  res = getpriority(PRIO_PROCESS, tid);
-  if (res == -1 && errno) {
-    PLOG(ERROR) << "getpriority";
-    return false;
-  }
-  nice_value = res;
-
-  return true;
+bool ProcessReader::Thread::InitializeScheduling(
+    const std::string& stat_contents) {
+  // The scheduling parameters are read from the thread’s stat file rather
+  // than with sched_getscheduler(), sched_getparam(), and getpriority(), so
+  // that they come through the connection along with everything else.
+  ProcStatReader stat;
+  return stat.InitializeWithContents(stat_contents) &&
+         stat.Scheduling(&sched_policy, &static_priority, &nice_value);
 }
 
 void ProcessReader::Thread::InitializeStack(ProcessReader* reader) {
@@ -171,7 +142,6 @@ ProcessReader::ProcessReader()
       process_info_(),
       memory_map_(),
       threads_(),
-      process_memory_(),
       is_64_bit_(false),
       initialized_threads_(false),
       initialized_() {}
@@ -187,13 +157,7 @@ bool ProcessReader::Initialize(PtraceConnection* connection) {
     return false;
   }
 
-  pid_t pid = connection->GetProcessID();
-  if (!memory_map_.Initialize(pid)) {
-    return false;
-  }
-
-  process_memory_.reset(new ProcessMemory());
-  if (!process_memory_->Initialize(pid)) {
+  if (!memory_map_.Initialize(connection_)) {
     return false;
   }
 
@@ -218,9 +182,22 @@ bool ProcessReader::CPUTimes(timeval* user_time, timeval* system_time) const {
   timeval local_system_time;
   timerclear(&local_system_time);
 
+  // The stat files are read together, so that a connection that forwards
+  // requests to another process reads them in a single round trip.
+  std::vector<base::FilePath> paths;
+  paths.reserve(threads_.size());
   for (const Thread& thread : threads_) {
+    paths.push_back(base::FilePath(
+        ProcStatReader::ThreadStatPath(ProcessID(), thread.tid)));
+  }
+  std::vector<std::string> contents;
+  if (!connection_->ReadFilesContents(paths, &contents)) {
+    return false;
+  }
+
+  for (const std::string& thread_contents : contents) {
     ProcStatReader stat;
-    if (!stat.Initialize(thread.tid)) {
+    if (!stat.InitializeWithContents(thread_contents)) {
       return false;
     }
 
@@ -247,6 +224,7 @@ const std::vector<ProcessReader::Thread>& ProcessReader::Threads() {
   INITIALIZATION_STATE_DCHECK_VALID(initialized_);
   if (!initialized_threads_) {
     InitializeThreads();
+    initialized_threads_ = true;
   }
   return threads_;
 }
@@ -264,51 +242,71 @@ void ProcessReader::InitializeThreads() {
     return;
   }
 
-  char path[32];
-  snprintf(path, arraysize(path), "/proc/%d/task", pid);
-  DIR* dir = opendir(path);
-  if (!dir) {
-    PLOG(ERROR) << "opendir";
+  std::vector<pid_t> tids;
+  if (!connection_->Threads(&tids)) {
     return;
   }
-  ScopedDIR scoped_dir(dir);
+
+  std::vector<Thread> threads;
+  threads.reserve(tids.size());
 
   Thread main_thread;
   main_thread.tid = pid;
-  if (main_thread.InitializePtrace(connection_)) {
-    main_thread.InitializeStack(this);
-    threads_.push_back(main_thread);
+  if (connection_->GetThreadInfo(pid, &main_thread.thread_info)) {
+    threads.push_back(main_thread);
   } else {
     LOG(WARNING) << "Couldn't initialize main thread.";
   }
 
-  bool main_thread_found = false;
-  dirent* dir_entry;
-  while ((dir_entry = readdir(scoped_dir.get()))) {
-    if (strncmp(dir_entry->d_name, ".", arraysize(dir_entry->d_name)) == 0 ||
-        strncmp(dir_entry->d_name, "..", arraysize(dir_entry->d_name)) == 0) {
-      continue;
+  std::vector<pid_t> other_tids;
+  other_tids.reserve(tids.size());
+  for (pid_t tid : tids) {
+    if (tid != pid) {
+      other_tids.push_back(tid);
     }
-    pid_t tid;
-    if (!base::StringToInt(dir_entry->d_name, &tid)) {
-      LOG(ERROR) << "format error";
+  }
+  DCHECK_EQ(other_tids.size() + 1, tids.size());
+
+  // The threads are attached together, so that a connection that forwards
+  // requests to another process attaches them in a single round trip.
+  std::vector<ThreadInfo> infos;
+  std::vector<bool> succeeded;
+  connection_->AttachAndGetThreadInfos(other_tids, &infos, &succeeded);
+  for (size_t index = 0; index < other_tids.size(); ++index) {
+    if (!succeeded[index]) {
       continue;
     }
 
-    if (tid == pid) {
-      DCHECK(!main_thread_found);
-      main_thread_found = true;
-      continue;
+    Thread thread;
+    thread.tid = other_tids[index];
+    thread.thread_info = infos[index];
+    threads.push_back(thread);
+  }
+
+  // Likewise, the stat files holding the threads’ scheduling parameters are
+  // read together. If that fails, they’re read one at a time so that only the
+  // threads whose files couldn’t be read are omitted.
+  std::vector<base::FilePath> paths;
+  paths.reserve(threads.size());
+  for (const Thread& thread : threads) {
+    paths.push_back(
+        base::FilePath(ProcStatReader::ThreadStatPath(pid, thread.tid)));
+  }
+  std::vector<std::string> contents;
+  if (!connection_->ReadFilesContents(paths, &contents)) {
+    contents.assign(paths.size(), std::string());
+    for (size_t index = 0; index < paths.size(); ++index) {
+      connection_->ReadFileContents(paths[index], &contents[index]);
     }
+  }
 
-    Thread thread;
-    thread.tid = tid;
-    if (connection_->Attach(tid) && thread.InitializePtrace(connection_)) {
+  for (size_t index = 0; index < threads.size(); ++index) {
+    Thread& thread = threads[index];
+    if (thread.InitializeScheduling(contents[index])) {
       thread.InitializeStack(this);
       threads_.push_back(thread);
     }
   }
-  DCHECK(main_thread_found);
 }
 
 }  // namespace crashpad
@@ -18,7 +18,7 @@
 #include <sys/time.h>
 #include <sys/types.h>
 
-#include <memory>
+#include <string>
 #include <vector>
 
 #include "base/macros.h"
@@ -52,7 +52,7 @@ class ProcessReader {
    private:
     friend class ProcessReader;
 
-    bool InitializePtrace(PtraceConnection* connection);
+    bool InitializeScheduling(const std::string& stat_contents);
     void InitializeStack(ProcessReader* reader);
   };
 
@@ -78,7 +78,7 @@ class ProcessReader {
   pid_t ParentProcessID() const { return process_info_.ParentProcessID(); }
 
   //! \brief Return a memory reader for the target process.
-  ProcessMemory* Memory() { return process_memory_.get(); }
+  ProcessMemory* Memory() { return connection_->Memory(); }
 
   //! \brief Return a memory map of the target process.
   MemoryMap* GetMemoryMap() { return &memory_map_; }
@@ -114,7 +114,6 @@ class ProcessReader {
   ProcessInfo process_info_;
   class MemoryMap memory_map_;
   std::vector<Thread> threads_;
-  std::unique_ptr<ProcessMemory> process_memory_;
   bool is_64_bit_;
   bool initialized_threads_;
   InitializationStateDcheck initialized_;
@@ -35,7 +35,11 @@
 #include "test/linux/fake_ptrace_connection.h"
 #include "test/multiprocess.h"
 #include "util/file/file_io.h"
+#include "util/file/string_file.h"
 #include "util/linux/direct_ptrace_connection.h"
+#include "util/linux/ptrace_recording.h"
+#include "util/linux/recording_ptrace_connection.h"
+#include "util/linux/replay_ptrace_connection.h"
 #include "util/misc/from_pointer_cast.h"
 #include "util/stdlib/pointer_container.h"
 #include "util/synchronization/semaphore.h"
@@ -294,10 +298,81 @@ void ExpectThreads(const ThreadMap& thread_map,
   }
 }
 
+// Reads the stacks and CPU times of the threads found by |process_reader|,
+// which is recording to |recording|, then replays the recording into a new
+// ProcessReader and checks that it finds the same.
+void ExpectReplay(const PtraceRecording& recording,
+                  ProcessReader* process_reader) {
+  const std::vector<ProcessReader::Thread>& threads =
+      process_reader->Threads();
+  std::vector<std::string> stacks;
+  for (const ProcessReader::Thread& thread : threads) {
+    stacks.push_back(std::string(thread.stack_region_size, '\0'));
+    ASSERT_TRUE(process_reader->Memory()->Read(
+        thread.stack_region_address, stacks.back().size(), &stacks.back()[0]));
+  }
+  timeval user_time;
+  timeval system_time;
+  ASSERT_TRUE(process_reader->CPUTimes(&user_time, &system_time));
+
+  StringFile recording_file;
+  ASSERT_TRUE(recording.Write(&recording_file));
+  ASSERT_EQ(recording_file.Seek(0, SEEK_SET), 0);
+  PtraceRecording replayed_recording;
+  ASSERT_TRUE(replayed_recording.Read(&recording_file));
+
+  ReplayPtraceConnection connection;
+  ASSERT_TRUE(connection.Initialize(&replayed_recording));
+  ProcessReader replayed_reader;
+  ASSERT_TRUE(replayed_reader.Initialize(&connection));
+  EXPECT_EQ(replayed_reader.ProcessID(), process_reader->ProcessID());
+  EXPECT_EQ(replayed_reader.ParentProcessID(),
+            process_reader->ParentProcessID());
+  EXPECT_EQ(replayed_reader.Is64Bit(), process_reader->Is64Bit());
+
+  const std::vector<ProcessReader::Thread>& replayed_threads =
+      replayed_reader.Threads();
+  ASSERT_EQ(replayed_threads.size(), threads.size());
+  for (size_t index = 0; index < threads.size(); ++index) {
+    const ProcessReader::Thread& thread = threads[index];
+    const ProcessReader::Thread& replayed_thread = replayed_threads[index];
+    EXPECT_EQ(replayed_thread.tid, thread.tid);
+    EXPECT_EQ(replayed_thread.thread_info.thread_specific_data_address,
+              thread.thread_info.thread_specific_data_address);
+    EXPECT_EQ(replayed_thread.stack_region_address,
+              thread.stack_region_address);
+    EXPECT_EQ(replayed_thread.stack_region_size, thread.stack_region_size);
+    EXPECT_EQ(replayed_thread.sched_policy, thread.sched_policy);
+    EXPECT_EQ(replayed_thread.static_priority, thread.static_priority);
+    EXPECT_EQ(replayed_thread.nice_value, thread.nice_value);
+
+    std::string replayed_stack(replayed_thread.stack_region_size, '\0');
+    ASSERT_TRUE(
+        replayed_reader.Memory()->Read(replayed_thread.stack_region_address,
+                                       replayed_stack.size(),
+                                       &replayed_stack[0]));
+    EXPECT_EQ(replayed_stack, stacks[index]);
+  }
+
+  timeval replayed_user_time;
+  timeval replayed_system_time;
+  ASSERT_TRUE(
+      replayed_reader.CPUTimes(&replayed_user_time, &replayed_system_time));
+  EXPECT_EQ(replayed_user_time.tv_sec, user_time.tv_sec);
+  EXPECT_EQ(replayed_user_time.tv_usec, user_time.tv_usec);
+  EXPECT_EQ(replayed_system_time.tv_sec, system_time.tv_sec);
+  EXPECT_EQ(replayed_system_time.tv_usec, system_time.tv_usec);
+}
+
 class ChildThreadTest : public Multiprocess {
  public:
-  ChildThreadTest(size_t stack_size = 0)
-      : Multiprocess(), stack_size_(stack_size) {}
+  ChildThreadTest(size_t stack_size = 0,
+                  bool frozen = false,
+                  bool recorded = false)
+      : Multiprocess(),
+        stack_size_(stack_size),
+        frozen_(frozen),
+        recorded_(recorded) {}
   ~ChildThreadTest() {}
 
  private:
@@ -315,13 +390,30 @@ class ChildThreadTest : public Multiprocess {
     }
 
     DirectPtraceConnection connection;
-    ASSERT_TRUE(connection.Initialize(ChildPID()));
+    if (frozen_) {
+      ASSERT_TRUE(connection.InitializeFrozen(
+          ChildPID(), ScopedProcessFreeze::Method::kAutomatic, 5));
+    } else {
+      ASSERT_TRUE(connection.Initialize(ChildPID()));
+    }
+
+    PtraceRecording recording;
+    RecordingPtraceConnection recording_connection;
+    PtraceConnection* reader_connection = &connection;
+    if (recorded_) {
+      ASSERT_TRUE(recording_connection.Initialize(&connection, &recording));
+      reader_connection = &recording_connection;
+    }
 
     ProcessReader process_reader;
-    ASSERT_TRUE(process_reader.Initialize(&connection));
+    ASSERT_TRUE(process_reader.Initialize(reader_connection));
     const std::vector<ProcessReader::Thread>& threads =
         process_reader.Threads();
     ExpectThreads(thread_map, threads, ChildPID());
+
+    if (recorded_) {
+      ExpectReplay(recording, &process_reader);
+    }
   }
 
   void MultiprocessChild() override {
@@ -361,6 +453,8 @@ class ChildThreadTest : public Multiprocess {
 
   static constexpr size_t kThreadCount = 3;
   const size_t stack_size_;
+  const bool frozen_;
+  const bool recorded_;
 
   DISALLOW_COPY_AND_ASSIGN(ChildThreadTest);
 };
@@ -375,6 +469,16 @@ TEST(ProcessReader, ChildThreadsWithSmallUserStacks) {
   test.Run();
 }
 
+TEST(ProcessReader, ChildWithThreadsFrozen) {
+  ChildThreadTest test(0, true);
+  test.Run();
+}
+
+TEST(ProcessReader, ChildWithThreadsReplayed) {
+  ChildThreadTest test(0, false, true);
+  test.Run();
+}
+
 // Tests a thread with a stack that spans multiple mappings.
 class ChildWithSplitStackTest : public Multiprocess {
  public:
@@ -18,9 +18,11 @@
 #include <mach/mach.h>
 #include <sys/types.h>
 
+#include <memory>
 #include <utility>
 
 #include "base/logging.h"
+#include "client/annotation_arena.h"
 #include "client/crashpad_info.h"
 #include "client/simple_string_dictionary.h"
 #include "snapshot/mac/mach_o_image_reader.h"
@@ -53,6 +55,7 @@ std::map<std::string, std::string> MachOImageAnnotationsReader::SimpleMap()
   std::map<std::string, std::string> simple_map_annotations;
 
   ReadCrashpadSimpleAnnotations(&simple_map_annotations);
+  ReadCrashpadAnnotationArena(&simple_map_annotations);
 
   return simple_map_annotations;
 }
@@ -173,4 +176,42 @@ void MachOImageAnnotationsReader::ReadCrashpadSimpleAnnotations(
   }
 }
 
+void MachOImageAnnotationsReader::ReadCrashpadAnnotationArena(
+    std::map<std::string, std::string>* simple_map_annotations) const {
+  process_types::CrashpadInfo crashpad_info;
+  if (!image_reader_->GetCrashpadInfo(&crashpad_info)) {
+    return;
+  }
+
+  if (!crashpad_info.annotation_arena) {
+    return;
+  }
+
+  // Read the header to learn how much of the arena is in use, then read all of
+  // that at once.
+  AnnotationArenaHeader header;
+  if (!process_reader_->Memory()->Read(
+          crashpad_info.annotation_arena, sizeof(header), &header)) {
+    LOG(WARNING) << "could not read annotation arena from " << name_;
+    return;
+  }
+
+  const size_t size = AnnotationArenaSizeInUse(header);
+  if (!size) {
+    LOG(WARNING) << "unexpected annotation arena header in " << name_;
+    return;
+  }
+
+  std::unique_ptr<char[]> arena(new char[size]);
+  if (!process_reader_->Memory()->Read(
+          crashpad_info.annotation_arena, size, arena.get())) {
+    LOG(WARNING) << "could not read annotation arena from " << name_;
+    return;
+  }
+
+  if (!ReadAnnotationArena(arena.get(), size, simple_map_annotations)) {
+    LOG(WARNING) << "could not parse annotation arena in " << name_;
+  }
+}
+
 }  // namespace crashpad
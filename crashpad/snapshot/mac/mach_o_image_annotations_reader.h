@@ -34,8 +34,9 @@ class ProcessReader;
 //! information thought to be potentially useful for crash analysis. This class
 //! can decode annotations stored in these formats:
 //!  - CrashpadInfo. This format is used by Crashpad clients. The “simple
-//!    annotations” are recovered from any module with a compatible data
-//!    section, and are included in the annotations returned by SimpleMap().
+//!    annotations” and the annotations in the AnnotationArena are recovered
+//!    from any module with a compatible data section, and are included in the
+//!    annotations returned by SimpleMap().
 //!  - `CrashReporterClient.h`’s `crashreporter_annotations_t`. This format is
 //!    used by Apple code. The `message` and `message2` fields can be recovered
 //!    from any module with a compatible data section, and are included in the
@@ -81,6 +82,10 @@ class MachOImageAnnotationsReader {
   void ReadCrashpadSimpleAnnotations(
       std::map<std::string, std::string>* simple_map_annotations) const;
 
+  // Reads CrashpadInfo::annotation_arena_ on behalf of SimpleMap().
+  void ReadCrashpadAnnotationArena(
+      std::map<std::string, std::string>* simple_map_annotations) const;
+
   std::string name_;
   ProcessReader* process_reader_;  // weak
   const MachOImageReader* image_reader_;  // weak
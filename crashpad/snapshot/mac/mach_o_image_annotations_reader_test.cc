@@ -28,6 +28,7 @@
 
 #include "base/files/file_path.h"
 #include "base/macros.h"
+#include "client/annotation_arena.h"
 #include "client/crashpad_info.h"
 #include "client/simple_string_dictionary.h"
 #include "gtest/gtest.h"
@@ -261,12 +262,15 @@ class TestMachOImageAnnotationsReader final
                                         module_annotations_simple_map.end());
     }
 
-    EXPECT_GE(all_annotations_simple_map.size(), 5u);
+    EXPECT_GE(all_annotations_simple_map.size(), 7u);
     EXPECT_EQ(all_annotations_simple_map["#TEST# pad"], "crash");
     EXPECT_EQ(all_annotations_simple_map["#TEST# key"], "value");
     EXPECT_EQ(all_annotations_simple_map["#TEST# x"], "y");
     EXPECT_EQ(all_annotations_simple_map["#TEST# longer"], "shorter");
     EXPECT_EQ(all_annotations_simple_map["#TEST# empty_value"], "");
+    EXPECT_EQ(all_annotations_simple_map["#TEST# arena"], "arena value");
+    EXPECT_EQ(all_annotations_simple_map["#TEST# arena_long"],
+              std::string(1000, 'l'));
 
     // Tell the child process that it’s permitted to crash.
     CheckedWriteFile(WritePipeHandle(), &c, sizeof(c));
@@ -329,6 +333,15 @@ class TestMachOImageAnnotationsReader final
 
     crashpad_info->set_simple_annotations(simple_annotations);
 
+    // This is also “leaked” to crashpad_info. Its key conflicting with a simple
+    // annotation is ignored.
+    AnnotationArena* annotation_arena = new AnnotationArena();
+    annotation_arena->SetKeyValue("#TEST# arena", "arena value");
+    annotation_arena->SetKeyValue("#TEST# arena_long", std::string(1000, 'l'));
+    annotation_arena->SetKeyValue("#TEST# key", "arena");
+
+    crashpad_info->set_annotation_arena(annotation_arena);
+
     // Tell the parent that the environment has been set up.
     char c = '\0';
     CheckedWriteFile(WritePipeHandle(), &c, sizeof(c));
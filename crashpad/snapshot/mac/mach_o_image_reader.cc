@@ -482,8 +482,11 @@ bool MachOImageReader::GetCrashpadInfo(
     return false;
   }
 
+  // A module built with an older client has a smaller structure, so only the
+  // size of the oldest version is required here. Read() copies only the fields
+  // present in the structure’s version, and zeroes the rest.
   if (crashpad_info_section->size <
-      crashpad_info->ExpectedSize(process_reader_)) {
+      process_types::CrashpadInfo::ExpectedSizeForVersion(process_reader_, 1)) {
     LOG(WARNING) << "small crashpad info section size "
                  << crashpad_info_section->size << module_info_;
     return false;
@@ -501,6 +504,16 @@ bool MachOImageReader::GetCrashpadInfo(
     return false;
   }
 
+  const size_t expected_size =
+      process_types::CrashpadInfo::ExpectedSizeForVersion(
+          process_reader_, crashpad_info->version);
+  if (crashpad_info_section->size < expected_size) {
+    LOG(WARNING) << "small crashpad info section size "
+                 << crashpad_info_section->size << " < " << expected_size
+                 << " for version " << crashpad_info->version << module_info_;
+    return false;
+  }
+
   return true;
 }
 
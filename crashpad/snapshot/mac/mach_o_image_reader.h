@@ -269,6 +269,9 @@ class MachOImageReader {
 
   //! \brief Obtains the module’s CrashpadInfo structure.
   //!
+  //! A module built with an older client may have a CrashpadInfo structure of
+  //! an older version. Fields not present in its version are zeroed.
+  //!
   //! \return `true` on success, `false` on failure. If the module does not have
   //!     a `__DATA,crashpad_info` section, this will return `false` without
   //!     logging any messages. Other failures will result in messages being
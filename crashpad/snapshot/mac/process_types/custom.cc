@@ -37,8 +37,9 @@ bool ReadIntoVersioned(ProcessReader* process_reader,
                        mach_vm_address_t address,
                        T* specific) {
   TaskMemory* task_memory = process_reader->Memory();
-  if (!task_memory->Read(
-          address, sizeof(specific->version), &specific->version)) {
+  if (!task_memory->Read(address + offsetof(T, version),
+                         sizeof(specific->version),
+                         &specific->version)) {
     return false;
   }
 
@@ -125,6 +126,24 @@ bool crashreporter_annotations_t<Traits>::ReadInto(
   return ReadIntoVersioned(process_reader, address, specific);
 }
 
+// static
+template <typename Traits>
+size_t CrashpadInfo<Traits>::ExpectedSizeForVersion(
+    decltype(CrashpadInfo<Traits>::version) version) {
+  if (version >= 2) {
+    return sizeof(CrashpadInfo<Traits>);
+  }
+  return offsetof(CrashpadInfo<Traits>, annotation_arena);
+}
+
+// static
+template <typename Traits>
+bool CrashpadInfo<Traits>::ReadInto(ProcessReader* process_reader,
+                                    mach_vm_address_t address,
+                                    CrashpadInfo<Traits>* specific) {
+  return ReadIntoVersioned(process_reader, address, specific);
+}
+
 // Explicit template instantiation of the above.
 #define PROCESS_TYPE_FLAVOR_TRAITS(lp_bits)                                    \
   template size_t                                                              \
@@ -140,7 +159,13 @@ bool crashreporter_annotations_t<Traits>::ReadInto(
   template bool crashreporter_annotations_t<Traits##lp_bits>::ReadInto(        \
       ProcessReader*,                                                          \
       mach_vm_address_t,                                                       \
-      crashreporter_annotations_t<Traits##lp_bits>*);
+      crashreporter_annotations_t<Traits##lp_bits>*);                          \
+  template size_t CrashpadInfo<Traits##lp_bits>::ExpectedSizeForVersion(       \
+      decltype(CrashpadInfo<Traits##lp_bits>::version));                       \
+  template bool CrashpadInfo<Traits##lp_bits>::ReadInto(                       \
+      ProcessReader*,                                                          \
+      mach_vm_address_t,                                                       \
+      CrashpadInfo<Traits##lp_bits>*);
 
 #include "snapshot/mac/process_types/flavors.h"
 
@@ -23,6 +23,7 @@
 #include "base/macros.h"
 #include "base/strings/stringprintf.h"
 #include "build/build_config.h"
+#include "client/crashpad_info.h"
 #include "gtest/gtest.h"
 #include "snapshot/mac/process_types/internal.h"
 #include "test/mac/dyld.h"
@@ -379,6 +380,53 @@ TEST(ProcessTypes, DyldImagesSelf) {
 #endif
 }
 
+TEST(ProcessTypes, CrashpadInfoVersions) {
+  // annotation_arena was added in version 2.
+  using CrashpadInfo32 =
+      process_types::internal::CrashpadInfo<process_types::internal::Traits32>;
+  using CrashpadInfo64 =
+      process_types::internal::CrashpadInfo<process_types::internal::Traits64>;
+  EXPECT_EQ(CrashpadInfo32::ExpectedSizeForVersion(1), 36u);
+  EXPECT_EQ(CrashpadInfo32::ExpectedSizeForVersion(2), 40u);
+  EXPECT_EQ(CrashpadInfo64::ExpectedSizeForVersion(1), 48u);
+  EXPECT_EQ(CrashpadInfo64::ExpectedSizeForVersion(2), 56u);
+
+  ProcessReader process_reader;
+  ASSERT_TRUE(process_reader.Initialize(mach_task_self()));
+
+#if defined(ARCH_CPU_64_BITS)
+  using CrashpadInfoSpecific = CrashpadInfo64;
+#else
+  using CrashpadInfoSpecific = CrashpadInfo32;
+#endif
+
+  // A module built with a version 1 client has a structure that ends before
+  // annotation_arena. Whatever follows it must not be taken as a pointer.
+  CrashpadInfoSpecific specific;
+  memset(&specific, 0, sizeof(specific));
+  specific.signature = CrashpadInfo::kSignature;
+  specific.size = CrashpadInfoSpecific::ExpectedSizeForVersion(1);
+  specific.version = 1;
+  specific.simple_annotations = 0x1000;
+  specific.annotation_arena = 0x2000;
+
+  const mach_vm_address_t address =
+      FromPointerCast<mach_vm_address_t>(&specific);
+  process_types::CrashpadInfo crashpad_info;
+  ASSERT_TRUE(crashpad_info.Read(&process_reader, address));
+  EXPECT_EQ(crashpad_info.signature, CrashpadInfo::kSignature);
+  EXPECT_EQ(crashpad_info.version, 1u);
+  EXPECT_EQ(crashpad_info.simple_annotations, 0x1000u);
+  EXPECT_EQ(crashpad_info.annotation_arena, 0u);
+
+  specific.size = CrashpadInfoSpecific::ExpectedSizeForVersion(2);
+  specific.version = 2;
+  ASSERT_TRUE(crashpad_info.Read(&process_reader, address));
+  EXPECT_EQ(crashpad_info.version, 2u);
+  EXPECT_EQ(crashpad_info.simple_annotations, 0x1000u);
+  EXPECT_EQ(crashpad_info.annotation_arena, 0x2000u);
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace crashpad
@@ -0,0 +1,146 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "snapshot/minidump/deduplicated_memory_snapshot_minidump.h"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+
+#include "base/logging.h"
+
+namespace crashpad {
+namespace internal {
+
+namespace {
+
+// Returns the number of chunks that a range is divided into, at multiples of
+// page_size in the address space.
+uint64_t ChunkCount(uint64_t address, uint64_t size, uint32_t page_size) {
+  if (size == 0) {
+    return 0;
+  }
+  const uint64_t first_page = address / page_size;
+  const uint64_t last_page = (address + size - 1) / page_size;
+  return last_page - first_page + 1;
+}
+
+}  // namespace
+
+DeduplicatedMemorySnapshotMinidump::DeduplicatedMemorySnapshotMinidump()
+    : MemorySnapshot(),
+      page_references_(),
+      file_reader_(nullptr),
+      address_(0),
+      size_(0),
+      pages_rva_(0),
+      page_size_(0),
+      initialized_() {}
+
+DeduplicatedMemorySnapshotMinidump::~DeduplicatedMemorySnapshotMinidump() {}
+
+bool DeduplicatedMemorySnapshotMinidump::Initialize(
+    FileReaderInterface* file_reader,
+    const MinidumpDeduplicatedMemoryList& memory_list,
+    const MinidumpDeduplicatedMemoryRange& range,
+    const std::vector<uint32_t>& page_references) {
+  INITIALIZATION_STATE_SET_INITIALIZING(initialized_);
+
+  if (memory_list.page_size == 0) {
+    LOG(ERROR) << "page_size 0";
+    return false;
+  }
+
+  if (range.start_of_memory_range + range.data_size <
+          range.start_of_memory_range ||
+      range.data_size > std::numeric_limits<size_t>::max()) {
+    LOG(ERROR) << "range size out of range";
+    return false;
+  }
+
+  if (range.page_reference_count !=
+      ChunkCount(range.start_of_memory_range,
+                 range.data_size,
+                 memory_list.page_size)) {
+    LOG(ERROR) << "page_reference_count mismatch";
+    return false;
+  }
+
+  if (range.first_page_reference > page_references.size() ||
+      range.page_reference_count >
+          page_references.size() - range.first_page_reference) {
+    LOG(ERROR) << "page references out of range";
+    return false;
+  }
+
+  page_references_.assign(
+      page_references.begin() + range.first_page_reference,
+      page_references.begin() + range.first_page_reference +
+          range.page_reference_count);
+  for (uint32_t page_reference : page_references_) {
+    if (page_reference >= memory_list.page_count) {
+      LOG(ERROR) << "page reference " << page_reference << " out of range";
+      return false;
+    }
+  }
+
+  file_reader_ = file_reader;
+  address_ = range.start_of_memory_range;
+  size_ = static_cast<size_t>(range.data_size);
+  pages_rva_ = memory_list.pages.Rva;
+  page_size_ = memory_list.page_size;
+
+  INITIALIZATION_STATE_SET_VALID(initialized_);
+  return true;
+}
+
+uint64_t DeduplicatedMemorySnapshotMinidump::Address() const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  return address_;
+}
+
+size_t DeduplicatedMemorySnapshotMinidump::Size() const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  return size_;
+}
+
+bool DeduplicatedMemorySnapshotMinidump::Read(Delegate* delegate) const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+
+  if (size_ == 0) {
+    return delegate->MemorySnapshotDelegateRead(nullptr, size_);
+  }
+
+  std::unique_ptr<uint8_t[]> buffer(new uint8_t[size_]);
+  size_t rebuilt = 0;
+  for (uint32_t page_reference : page_references_) {
+    const size_t page_offset = (address_ + rebuilt) % page_size_;
+    const size_t chunk_size =
+        std::min(page_size_ - page_offset, size_ - rebuilt);
+    const FileOffset chunk_offset =
+        pages_rva_ + static_cast<FileOffset>(page_reference) * page_size_ +
+        page_offset;
+    if (!file_reader_->SeekSet(chunk_offset) ||
+        !file_reader_->ReadExactly(&buffer[rebuilt], chunk_size)) {
+      return false;
+    }
+    rebuilt += chunk_size;
+  }
+  DCHECK_EQ(rebuilt, size_);
+
+  return delegate->MemorySnapshotDelegateRead(buffer.get(), size_);
+}
+
+}  // namespace internal
+}  // namespace crashpad
@@ -0,0 +1,82 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_SNAPSHOT_MINIDUMP_DEDUPLICATED_MEMORY_SNAPSHOT_MINIDUMP_H_
+#define CRASHPAD_SNAPSHOT_MINIDUMP_DEDUPLICATED_MEMORY_SNAPSHOT_MINIDUMP_H_
+
+#include <windows.h>
+#include <dbghelp.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <vector>
+
+#include "base/macros.h"
+#include "minidump/minidump_extensions.h"
+#include "snapshot/memory_snapshot.h"
+#include "util/file/file_reader.h"
+#include "util/misc/initialization_state_dcheck.h"
+
+namespace crashpad {
+namespace internal {
+
+//! \brief A MemorySnapshot based on a range carried in a
+//!     MinidumpDeduplicatedMemoryList in a minidump file.
+class DeduplicatedMemorySnapshotMinidump final : public MemorySnapshot {
+ public:
+  DeduplicatedMemorySnapshotMinidump();
+  ~DeduplicatedMemorySnapshotMinidump() override;
+
+  //! \brief Initializes the object.
+  //!
+  //! Memory is read lazily. No attempt is made to read the memory snapshot data
+  //! until Read() is called, at which point the range is rebuilt from its
+  //! pages.
+  //!
+  //! \param[in] file_reader A file reader corresponding to a minidump file.
+  //!     The file reader must support seeking.
+  //! \param[in] memory_list The MinidumpDeduplicatedMemoryList carrying the
+  //!     range.
+  //! \param[in] range The range.
+  //! \param[in] page_references All of the page references in \a memory_list.
+  //!
+  //! \return `true` if the snapshot could be created, `false` otherwise with
+  //!     an appropriate message logged.
+  bool Initialize(FileReaderInterface* file_reader,
+                  const MinidumpDeduplicatedMemoryList& memory_list,
+                  const MinidumpDeduplicatedMemoryRange& range,
+                  const std::vector<uint32_t>& page_references);
+
+  // MemorySnapshot:
+
+  uint64_t Address() const override;
+  size_t Size() const override;
+  bool Read(Delegate* delegate) const override;
+
+ private:
+  std::vector<uint32_t> page_references_;
+  FileReaderInterface* file_reader_;  // weak
+  uint64_t address_;
+  size_t size_;
+  RVA pages_rva_;
+  uint32_t page_size_;
+  InitializationStateDcheck initialized_;
+
+  DISALLOW_COPY_AND_ASSIGN(DeduplicatedMemorySnapshotMinidump);
+};
+
+}  // namespace internal
+}  // namespace crashpad
+
+#endif  // CRASHPAD_SNAPSHOT_MINIDUMP_DEDUPLICATED_MEMORY_SNAPSHOT_MINIDUMP_H_
@@ -0,0 +1,241 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "snapshot/minidump/light_minidump.h"
+
+#include <windows.h>
+#include <dbghelp.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "base/logging.h"
+#include "minidump/minidump_extensions.h"
+
+namespace crashpad {
+
+namespace {
+
+bool IsMemoryStream(uint32_t stream_type) {
+  switch (stream_type) {
+    case kMinidumpStreamTypeMemoryList:
+    case kMinidumpStreamTypeMemory64List:
+    case kMinidumpStreamTypeCrashpadDeduplicatedMemoryList:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Reads a list made up of a count of type |Count| followed by that many
+// elements of type |Element|, as found in |location|.
+template <typename Count, typename Element>
+bool ReadList(FileReaderInterface* file_reader,
+              const MINIDUMP_LOCATION_DESCRIPTOR& location,
+              std::vector<Element>* elements) {
+  Count count;
+  if (location.DataSize < sizeof(count) ||
+      !file_reader->SeekSet(location.Rva) ||
+      !file_reader->ReadExactly(&count, sizeof(count))) {
+    return false;
+  }
+
+  if (count > (location.DataSize - sizeof(count)) / sizeof(Element)) {
+    LOG(ERROR) << "list size mismatch";
+    return false;
+  }
+
+  elements->resize(static_cast<size_t>(count));
+  return elements->empty() ||
+         file_reader->ReadExactly(&(*elements)[0],
+                                  elements->size() * sizeof(Element));
+}
+
+}  // namespace
+
+bool WriteLightMinidump(FileReaderInterface* minidump_file_reader,
+                        FileWriterInterface* light_file_writer) {
+  const FileOffset file_size = minidump_file_reader->Seek(0, SEEK_END);
+  if (file_size < 0) {
+    return false;
+  }
+
+  MINIDUMP_HEADER header;
+  if (!minidump_file_reader->SeekSet(0) ||
+      !minidump_file_reader->ReadExactly(&header, sizeof(header))) {
+    return false;
+  }
+
+  if (header.Signature != MINIDUMP_SIGNATURE ||
+      header.Version != MINIDUMP_VERSION) {
+    LOG(ERROR) << "minidump signature or version mismatch";
+    return false;
+  }
+
+  std::vector<MINIDUMP_DIRECTORY> directory(header.NumberOfStreams);
+  if (!directory.empty() &&
+      (!minidump_file_reader->SeekSet(header.StreamDirectoryRva) ||
+       !minidump_file_reader->ReadExactly(
+           &directory[0], directory.size() * sizeof(directory[0])))) {
+    return false;
+  }
+
+  // Find where the contents of memory begin, and the data that must not be
+  // carried past that point.
+  uint64_t memory_start = file_size;
+  auto note_memory = [&memory_start](uint64_t rva, uint64_t size) {
+    if (size > 0) {
+      memory_start = std::min(memory_start, rva);
+    }
+  };
+
+  std::vector<MINIDUMP_LOCATION_DESCRIPTOR> thread_contexts;
+  RVA thread_list_rva = 0;
+  std::vector<MINIDUMP_THREAD> threads;
+
+  for (const MINIDUMP_DIRECTORY& entry : directory) {
+    switch (entry.StreamType) {
+      case kMinidumpStreamTypeMemoryList: {
+        std::vector<MINIDUMP_MEMORY_DESCRIPTOR> descriptors;
+        if (!ReadList<uint32_t>(
+                minidump_file_reader, entry.Location, &descriptors)) {
+          return false;
+        }
+        for (const MINIDUMP_MEMORY_DESCRIPTOR& descriptor : descriptors) {
+          note_memory(descriptor.Memory.Rva, descriptor.Memory.DataSize);
+        }
+        break;
+      }
+
+      case kMinidumpStreamTypeMemory64List: {
+        MINIDUMP_MEMORY64_LIST memory64_list;
+        if (entry.Location.DataSize < sizeof(memory64_list) ||
+            !minidump_file_reader->SeekSet(entry.Location.Rva) ||
+            !minidump_file_reader->ReadExactly(&memory64_list,
+                                               sizeof(memory64_list))) {
+          return false;
+        }
+        // The contents of all of the ranges begin at BaseRva.
+        note_memory(memory64_list.BaseRva, memory64_list.NumberOfMemoryRanges);
+        break;
+      }
+
+      case kMinidumpStreamTypeCrashpadDeduplicatedMemoryList: {
+        MinidumpDeduplicatedMemoryList memory_list;
+        if (entry.Location.DataSize < sizeof(memory_list) ||
+            !minidump_file_reader->SeekSet(entry.Location.Rva) ||
+            !minidump_file_reader->ReadExactly(&memory_list,
+                                               sizeof(memory_list))) {
+          return false;
+        }
+        note_memory(memory_list.pages.Rva, memory_list.pages.DataSize);
+        break;
+      }
+
+      case kMinidumpStreamTypeThreadList: {
+        if (!ReadList<uint32_t>(
+                minidump_file_reader, entry.Location, &threads)) {
+          return false;
+        }
+        thread_list_rva = entry.Location.Rva;
+        for (const MINIDUMP_THREAD& thread : threads) {
+          note_memory(thread.Stack.Memory.Rva, thread.Stack.Memory.DataSize);
+          thread_contexts.push_back(thread.ThreadContext);
+        }
+        break;
+      }
+
+      case kMinidumpStreamTypeException: {
+        MINIDUMP_EXCEPTION_STREAM exception;
+        if (entry.Location.DataSize < sizeof(exception) ||
+            !minidump_file_reader->SeekSet(entry.Location.Rva) ||
+            !minidump_file_reader->ReadExactly(&exception,
+                                               sizeof(exception))) {
+          return false;
+        }
+        thread_contexts.push_back(exception.ThreadContext);
+        break;
+      }
+    }
+  }
+
+  auto precedes_memory = [memory_start](uint64_t rva, uint64_t size) {
+    return rva + size <= memory_start;
+  };
+
+  if (!precedes_memory(0, sizeof(header)) ||
+      !precedes_memory(header.StreamDirectoryRva,
+                       directory.size() * sizeof(directory[0]))) {
+    LOG(ERROR) << "stream directory follows memory";
+    return false;
+  }
+
+  std::vector<MINIDUMP_DIRECTORY> light_directory;
+  for (const MINIDUMP_DIRECTORY& entry : directory) {
+    if (IsMemoryStream(entry.StreamType)) {
+      continue;
+    }
+    if (!precedes_memory(entry.Location.Rva, entry.Location.DataSize)) {
+      LOG(ERROR) << "stream type " << entry.StreamType << " follows memory";
+      return false;
+    }
+    light_directory.push_back(entry);
+  }
+
+  for (const MINIDUMP_LOCATION_DESCRIPTOR& context : thread_contexts) {
+    if (!precedes_memory(context.Rva, context.DataSize)) {
+      LOG(ERROR) << "thread context follows memory";
+      return false;
+    }
+  }
+
+  // Copy everything that precedes the contents of memory, and patch the
+  // header, stream directory, and thread list in the copy.
+  std::string light(static_cast<size_t>(memory_start), '\0');
+  if (!light.empty() &&
+      (!minidump_file_reader->SeekSet(0) ||
+       !minidump_file_reader->ReadExactly(&light[0], light.size()))) {
+    return false;
+  }
+
+  header.NumberOfStreams = static_cast<uint32_t>(light_directory.size());
+  memcpy(&light[0], &header, sizeof(header));
+
+  char* directory_c = &light[header.StreamDirectoryRva];
+  memset(directory_c, 0, directory.size() * sizeof(directory[0]));
+  if (!light_directory.empty()) {
+    memcpy(directory_c,
+           &light_directory[0],
+           light_directory.size() * sizeof(light_directory[0]));
+  }
+
+  for (size_t index = 0; index < threads.size(); ++index) {
+    MINIDUMP_THREAD& thread = threads[index];
+    thread.Stack.Memory.DataSize = 0;
+    thread.Stack.Memory.Rva = 0;
+    memcpy(&light[thread_list_rva + sizeof(uint32_t) +
+                  index * sizeof(MINIDUMP_THREAD)],
+           &thread,
+           sizeof(thread));
+  }
+
+  return light_file_writer->Write(light.data(), light.size());
+}
+
+}  // namespace crashpad
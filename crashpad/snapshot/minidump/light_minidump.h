@@ -0,0 +1,49 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_SNAPSHOT_MINIDUMP_LIGHT_MINIDUMP_H_
+#define CRASHPAD_SNAPSHOT_MINIDUMP_LIGHT_MINIDUMP_H_
+
+#include "util/file/file_reader.h"
+#include "util/file/file_writer.h"
+
+namespace crashpad {
+
+//! \brief Writes a “light” copy of a minidump file, without the contents of
+//!     memory.
+//!
+//! The light copy keeps every stream except MINIDUMP_MEMORY_LIST,
+//! MINIDUMP_MEMORY64_LIST, and MinidumpDeduplicatedMemoryList, and the stack
+//! of each thread in MINIDUMP_THREAD_LIST is emptied. The thread contexts,
+//! exception, modules, annotations, and triage summary are all retained, which
+//! is enough to triage a crash, but a small fraction of the size of the full
+//! minidump file.
+//!
+//! MinidumpFileWriter writes the contents of memory after all other data, so
+//! the light copy is produced by truncating the file where the contents of
+//! memory begin, and rewriting the stream directory. Minidump files in which
+//! other streams refer to data beyond that point are not supported.
+//!
+//! \param[in] minidump_file_reader A file reader corresponding to a minidump
+//!     file. The file reader must support seeking.
+//! \param[in] light_file_writer The writer to write the light copy to.
+//!
+//! \return `true` on success. `false` on failure, with a message logged. The
+//!     full minidump file can be used instead.
+bool WriteLightMinidump(FileReaderInterface* minidump_file_reader,
+                        FileWriterInterface* light_file_writer);
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_SNAPSHOT_MINIDUMP_LIGHT_MINIDUMP_H_
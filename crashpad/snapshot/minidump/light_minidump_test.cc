@@ -0,0 +1,187 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "snapshot/minidump/light_minidump.h"
+
+#include <windows.h>
+#include <dbghelp.h>
+#include <string.h>
+
+#include <string>
+
+#include "base/macros.h"
+#include "gtest/gtest.h"
+#include "minidump/minidump_extensions.h"
+#include "snapshot/minidump/process_snapshot_minidump.h"
+#include "util/file/string_file.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+constexpr uint64_t kModuleAddress = 0x10000;
+constexpr uint64_t kStackAddress = 0x7f00;
+constexpr char kStack[] = "the contents of the stack";
+
+// Writes a minidump file laid out as MinidumpFileWriter lays it out, with the
+// contents of memory last. If |user_stream_last| is true, a user stream is
+// written after the contents of memory.
+void WriteFullMinidump(StringFile* string_file, bool user_stream_last) {
+  MINIDUMP_HEADER header = {};
+  EXPECT_TRUE(string_file->Write(&header, sizeof(header)));
+
+  MINIDUMP_DIRECTORY directory[4] = {};
+  header.StreamDirectoryRva = static_cast<RVA>(string_file->SeekGet());
+  EXPECT_TRUE(string_file->Write(directory, sizeof(directory)));
+
+  directory[0].StreamType = kMinidumpStreamTypeModuleList;
+  directory[0].Location.DataSize =
+      sizeof(MINIDUMP_MODULE_LIST) + sizeof(MINIDUMP_MODULE);
+  directory[0].Location.Rva = static_cast<RVA>(string_file->SeekGet());
+  uint32_t module_count = 1;
+  EXPECT_TRUE(string_file->Write(&module_count, sizeof(module_count)));
+  MINIDUMP_MODULE module = {};
+  module.BaseOfImage = kModuleAddress;
+  module.SizeOfImage = 0x1000;
+  EXPECT_TRUE(string_file->Write(&module, sizeof(module)));
+
+  const char kContext[] = "thread context";
+  MINIDUMP_THREAD thread = {};
+  thread.ThreadId = 1;
+  thread.ThreadContext.DataSize = sizeof(kContext);
+  thread.ThreadContext.Rva = static_cast<RVA>(string_file->SeekGet());
+  EXPECT_TRUE(string_file->Write(kContext, sizeof(kContext)));
+
+  directory[1].StreamType = kMinidumpStreamTypeThreadList;
+  directory[1].Location.DataSize =
+      sizeof(MINIDUMP_THREAD_LIST) + sizeof(MINIDUMP_THREAD);
+  directory[1].Location.Rva = static_cast<RVA>(string_file->SeekGet());
+  uint32_t thread_count = 1;
+  EXPECT_TRUE(string_file->Write(&thread_count, sizeof(thread_count)));
+  const FileOffset thread_offset = string_file->SeekGet();
+  EXPECT_TRUE(string_file->Write(&thread, sizeof(thread)));
+
+  directory[2].StreamType = kMinidumpStreamTypeMemoryList;
+  directory[2].Location.DataSize =
+      sizeof(MINIDUMP_MEMORY_LIST) + sizeof(MINIDUMP_MEMORY_DESCRIPTOR);
+  directory[2].Location.Rva = static_cast<RVA>(string_file->SeekGet());
+  uint32_t range_count = 1;
+  EXPECT_TRUE(string_file->Write(&range_count, sizeof(range_count)));
+  const FileOffset descriptor_offset = string_file->SeekGet();
+  MINIDUMP_MEMORY_DESCRIPTOR descriptor = {};
+  EXPECT_TRUE(string_file->Write(&descriptor, sizeof(descriptor)));
+
+  const char kUserStream[] = "user stream";
+  const auto write_user_stream = [&]() {
+    directory[3].StreamType = 0x10000;
+    directory[3].Location.DataSize = sizeof(kUserStream);
+    directory[3].Location.Rva = static_cast<RVA>(string_file->SeekGet());
+    EXPECT_TRUE(string_file->Write(kUserStream, sizeof(kUserStream)));
+  };
+  if (!user_stream_last) {
+    write_user_stream();
+  }
+
+  // The contents of memory.
+  descriptor.StartOfMemoryRange = kStackAddress;
+  descriptor.Memory.DataSize = sizeof(kStack);
+  descriptor.Memory.Rva = static_cast<RVA>(string_file->SeekGet());
+  EXPECT_TRUE(string_file->Write(kStack, sizeof(kStack)));
+  thread.Stack = descriptor;
+
+  if (user_stream_last) {
+    write_user_stream();
+  }
+
+  EXPECT_TRUE(string_file->SeekSet(thread_offset));
+  EXPECT_TRUE(string_file->Write(&thread, sizeof(thread)));
+  EXPECT_TRUE(string_file->SeekSet(descriptor_offset));
+  EXPECT_TRUE(string_file->Write(&descriptor, sizeof(descriptor)));
+
+  EXPECT_TRUE(string_file->SeekSet(header.StreamDirectoryRva));
+  EXPECT_TRUE(string_file->Write(directory, sizeof(directory)));
+
+  header.Signature = MINIDUMP_SIGNATURE;
+  header.Version = MINIDUMP_VERSION;
+  header.NumberOfStreams = arraysize(directory);
+  EXPECT_TRUE(string_file->SeekSet(0));
+  EXPECT_TRUE(string_file->Write(&header, sizeof(header)));
+}
+
+TEST(LightMinidump, WriteLightMinidump) {
+  StringFile full_file;
+  ASSERT_NO_FATAL_FAILURE(WriteFullMinidump(&full_file, false));
+
+  ProcessSnapshotMinidump full_snapshot;
+  ASSERT_TRUE(full_snapshot.Initialize(&full_file));
+  char stack[sizeof(kStack)];
+  ASSERT_TRUE(full_snapshot.ReadMemory(kStackAddress, sizeof(stack), stack));
+  EXPECT_STREQ(stack, kStack);
+
+  StringFile light_file;
+  ASSERT_TRUE(WriteLightMinidump(&full_file, &light_file));
+  EXPECT_EQ(light_file.string().size(),
+            full_file.string().size() - sizeof(kStack));
+
+  ProcessSnapshotMinidump light_snapshot;
+  ASSERT_TRUE(light_snapshot.Initialize(&light_file));
+  EXPECT_FALSE(light_snapshot.ReadMemory(kStackAddress, sizeof(stack), stack));
+  ASSERT_EQ(light_snapshot.Modules().size(), 1u);
+  EXPECT_EQ(light_snapshot.ModuleForAddress(kModuleAddress),
+            light_snapshot.Modules()[0]);
+
+  MINIDUMP_HEADER header;
+  ASSERT_TRUE(light_file.SeekSet(0));
+  ASSERT_TRUE(light_file.ReadExactly(&header, sizeof(header)));
+  ASSERT_EQ(header.NumberOfStreams, 3u);
+
+  MINIDUMP_DIRECTORY directory[3];
+  ASSERT_TRUE(light_file.SeekSet(header.StreamDirectoryRva));
+  ASSERT_TRUE(light_file.ReadExactly(directory, sizeof(directory)));
+  EXPECT_EQ(directory[0].StreamType, kMinidumpStreamTypeModuleList);
+  EXPECT_EQ(directory[1].StreamType, kMinidumpStreamTypeThreadList);
+  EXPECT_EQ(directory[2].StreamType, 0x10000u);
+
+  // The thread is retained, with its context, but without its stack.
+  MINIDUMP_THREAD thread;
+  ASSERT_TRUE(light_file.SeekSet(directory[1].Location.Rva + sizeof(uint32_t)));
+  ASSERT_TRUE(light_file.ReadExactly(&thread, sizeof(thread)));
+  EXPECT_EQ(thread.ThreadId, 1u);
+  EXPECT_EQ(thread.Stack.StartOfMemoryRange, kStackAddress);
+  EXPECT_EQ(thread.Stack.Memory.DataSize, 0u);
+  EXPECT_EQ(thread.Stack.Memory.Rva, 0u);
+  EXPECT_NE(thread.ThreadContext.DataSize, 0u);
+  EXPECT_LE(thread.ThreadContext.Rva + thread.ThreadContext.DataSize,
+            light_file.string().size());
+}
+
+TEST(LightMinidump, StreamFollowsMemory) {
+  StringFile full_file;
+  ASSERT_NO_FATAL_FAILURE(WriteFullMinidump(&full_file, true));
+
+  StringFile light_file;
+  EXPECT_FALSE(WriteLightMinidump(&full_file, &light_file));
+}
+
+TEST(LightMinidump, NotAMinidump) {
+  StringFile full_file;
+  full_file.SetString(std::string(1024, 'x'));
+
+  StringFile light_file;
+  EXPECT_FALSE(WriteLightMinidump(&full_file, &light_file));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
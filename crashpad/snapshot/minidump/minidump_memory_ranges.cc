@@ -0,0 +1,181 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "snapshot/minidump/minidump_memory_ranges.h"
+
+#include <algorithm>
+#include <map>
+
+#include "base/logging.h"
+
+namespace crashpad {
+namespace internal {
+
+namespace {
+
+// Ranges indexed by address. They do not overlap.
+using RangeMap = std::map<uint64_t, MinidumpMemoryRange>;
+
+// Adds the parts of |range| not already in |range_map| to it.
+bool AddRange(const MinidumpMemoryRange& range, RangeMap* range_map) {
+  if (range.address + range.size < range.address ||
+      range.file_offset + range.size < range.file_offset) {
+    LOG(ERROR) << "memory range overflow";
+    return false;
+  }
+
+  uint64_t cursor = range.address;
+  const uint64_t end = range.address + range.size;
+  auto previous = range_map->upper_bound(cursor);
+  if (previous != range_map->begin()) {
+    --previous;
+    cursor = std::max(cursor, previous->first + previous->second.size);
+  }
+  while (cursor < end) {
+    auto next = range_map->lower_bound(cursor);
+    const uint64_t gap_end =
+        next == range_map->end() ? end : std::min(end, next->first);
+    if (gap_end > cursor) {
+      MinidumpMemoryRange& gap = (*range_map)[cursor];
+      gap.address = cursor;
+      gap.size = gap_end - cursor;
+      gap.file_offset = range.file_offset + (cursor - range.address);
+    }
+    if (next == range_map->end() || next->first >= end) {
+      break;
+    }
+    cursor = next->first + next->second.size;
+  }
+  return true;
+}
+
+bool ReadMemoryList(FileReaderInterface* file_reader,
+                    const MINIDUMP_LOCATION_DESCRIPTOR& location,
+                    RangeMap* range_map) {
+  if (location.DataSize < sizeof(MINIDUMP_MEMORY_LIST)) {
+    LOG(ERROR) << "memory_list size mismatch";
+    return false;
+  }
+
+  if (!file_reader->SeekSet(location.Rva)) {
+    return false;
+  }
+
+  uint32_t range_count;
+  if (!file_reader->ReadExactly(&range_count, sizeof(range_count))) {
+    return false;
+  }
+
+  if (sizeof(MINIDUMP_MEMORY_LIST) +
+          static_cast<uint64_t>(range_count) *
+              sizeof(MINIDUMP_MEMORY_DESCRIPTOR) !=
+      location.DataSize) {
+    LOG(ERROR) << "memory_list size mismatch";
+    return false;
+  }
+
+  std::vector<MINIDUMP_MEMORY_DESCRIPTOR> descriptors(range_count);
+  if (!descriptors.empty() &&
+      !file_reader->ReadExactly(&descriptors[0],
+                                descriptors.size() * sizeof(descriptors[0]))) {
+    return false;
+  }
+
+  for (const MINIDUMP_MEMORY_DESCRIPTOR& descriptor : descriptors) {
+    MinidumpMemoryRange range;
+    range.address = descriptor.StartOfMemoryRange;
+    range.size = descriptor.Memory.DataSize;
+    range.file_offset = descriptor.Memory.Rva;
+    if (!AddRange(range, range_map)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool ReadMemory64List(FileReaderInterface* file_reader,
+                      const MINIDUMP_LOCATION_DESCRIPTOR& location,
+                      RangeMap* range_map) {
+  if (location.DataSize < sizeof(MINIDUMP_MEMORY64_LIST)) {
+    LOG(ERROR) << "memory64_list size mismatch";
+    return false;
+  }
+
+  if (!file_reader->SeekSet(location.Rva)) {
+    return false;
+  }
+
+  MINIDUMP_MEMORY64_LIST memory64_list;
+  if (!file_reader->ReadExactly(&memory64_list, sizeof(memory64_list))) {
+    return false;
+  }
+
+  if (memory64_list.NumberOfMemoryRanges > location.DataSize ||
+      sizeof(MINIDUMP_MEMORY64_LIST) +
+              memory64_list.NumberOfMemoryRanges *
+                  sizeof(MINIDUMP_MEMORY_DESCRIPTOR64) !=
+          location.DataSize) {
+    LOG(ERROR) << "memory64_list size mismatch";
+    return false;
+  }
+
+  std::vector<MINIDUMP_MEMORY_DESCRIPTOR64> descriptors(
+      static_cast<size_t>(memory64_list.NumberOfMemoryRanges));
+  if (!descriptors.empty() &&
+      !file_reader->ReadExactly(&descriptors[0],
+                                descriptors.size() * sizeof(descriptors[0]))) {
+    return false;
+  }
+
+  // The contents of the ranges are stored contiguously, in order.
+  uint64_t file_offset = memory64_list.BaseRva;
+  for (const MINIDUMP_MEMORY_DESCRIPTOR64& descriptor : descriptors) {
+    MinidumpMemoryRange range;
+    range.address = descriptor.StartOfMemoryRange;
+    range.size = descriptor.DataSize;
+    range.file_offset = file_offset;
+    if (!AddRange(range, range_map)) {
+      return false;
+    }
+    file_offset += descriptor.DataSize;
+  }
+  return true;
+}
+
+}  // namespace
+
+bool ReadMinidumpMemoryRanges(
+    FileReaderInterface* file_reader,
+    const MINIDUMP_LOCATION_DESCRIPTOR* memory_list,
+    const MINIDUMP_LOCATION_DESCRIPTOR* memory64_list,
+    std::vector<MinidumpMemoryRange>* ranges) {
+  RangeMap range_map;
+  if (memory_list && !ReadMemoryList(file_reader, *memory_list, &range_map)) {
+    return false;
+  }
+  if (memory64_list &&
+      !ReadMemory64List(file_reader, *memory64_list, &range_map)) {
+    return false;
+  }
+
+  ranges->clear();
+  ranges->reserve(range_map.size());
+  for (const auto& it : range_map) {
+    ranges->push_back(it.second);
+  }
+  return true;
+}
+
+}  // namespace internal
+}  // namespace crashpad
@@ -0,0 +1,67 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_SNAPSHOT_MINIDUMP_MINIDUMP_MEMORY_RANGES_H_
+#define CRASHPAD_SNAPSHOT_MINIDUMP_MINIDUMP_MEMORY_RANGES_H_
+
+#include <windows.h>
+#include <dbghelp.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "util/file/file_reader.h"
+
+namespace crashpad {
+namespace internal {
+
+//! \brief A range of process memory captured in a minidump file.
+struct MinidumpMemoryRange {
+  //! \brief The address of the memory in the process.
+  uint64_t address;
+
+  //! \brief The number of bytes of memory.
+  uint64_t size;
+
+  //! \brief The offset of the memory’s contents in the minidump file.
+  uint64_t file_offset;
+};
+
+//! \brief Reads the ranges of memory described by a minidump file’s
+//!     `MINIDUMP_MEMORY_LIST` and `MINIDUMP_MEMORY64_LIST` streams.
+//!
+//! Where ranges overlap, the range listed first supplies the contents of the
+//! overlap. Ranges in `MINIDUMP_MEMORY_LIST` are listed before those in
+//! `MINIDUMP_MEMORY64_LIST`. Ranges with no contents, including those left
+//! empty by overlaps, are omitted.
+//!
+//! \param[in] file_reader The reader for the minidump file.
+//! \param[in] memory_list The location of the `MINIDUMP_MEMORY_LIST` stream,
+//!     or `nullptr` if there is none.
+//! \param[in] memory64_list The location of the `MINIDUMP_MEMORY64_LIST`
+//!     stream, or `nullptr` if there is none.
+//! \param[out] ranges The ranges, sorted by address. They do not overlap.
+//!
+//! \return `true` on success, with \a ranges set by replacing its contents.
+//!     `false` on failure, with a message logged.
+bool ReadMinidumpMemoryRanges(
+    FileReaderInterface* file_reader,
+    const MINIDUMP_LOCATION_DESCRIPTOR* memory_list,
+    const MINIDUMP_LOCATION_DESCRIPTOR* memory64_list,
+    std::vector<MinidumpMemoryRange>* ranges);
+
+}  // namespace internal
+}  // namespace crashpad
+
+#endif  // CRASHPAD_SNAPSHOT_MINIDUMP_MINIDUMP_MEMORY_RANGES_H_
@@ -0,0 +1,189 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "snapshot/minidump/minidump_memory_ranges.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "util/file/string_file.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+using internal::MinidumpMemoryRange;
+
+// Writes MINIDUMP_MEMORY_LIST and MINIDUMP_MEMORY64_LIST streams, each range
+// given as its address and its contents, and returns their locations.
+void WriteMemoryLists(
+    StringFile* string_file,
+    const std::vector<std::pair<uint64_t, std::string>>& memory_list,
+    const std::vector<std::pair<uint64_t, std::string>>& memory64_list,
+    MINIDUMP_LOCATION_DESCRIPTOR* memory_list_location,
+    MINIDUMP_LOCATION_DESCRIPTOR* memory64_list_location) {
+  std::vector<MINIDUMP_MEMORY_DESCRIPTOR> descriptors;
+  for (const auto& range : memory_list) {
+    MINIDUMP_MEMORY_DESCRIPTOR descriptor = {};
+    descriptor.StartOfMemoryRange = range.first;
+    descriptor.Memory.DataSize = static_cast<uint32_t>(range.second.size());
+    descriptor.Memory.Rva = static_cast<RVA>(string_file->SeekGet());
+    EXPECT_TRUE(string_file->Write(range.second.data(), range.second.size()));
+    descriptors.push_back(descriptor);
+  }
+
+  MINIDUMP_MEMORY64_LIST memory64_list_header = {};
+  memory64_list_header.NumberOfMemoryRanges = memory64_list.size();
+  memory64_list_header.BaseRva = string_file->SeekGet();
+  std::vector<MINIDUMP_MEMORY_DESCRIPTOR64> descriptors64;
+  for (const auto& range : memory64_list) {
+    MINIDUMP_MEMORY_DESCRIPTOR64 descriptor = {};
+    descriptor.StartOfMemoryRange = range.first;
+    descriptor.DataSize = range.second.size();
+    EXPECT_TRUE(string_file->Write(range.second.data(), range.second.size()));
+    descriptors64.push_back(descriptor);
+  }
+
+  memory_list_location->DataSize = static_cast<uint32_t>(
+      sizeof(MINIDUMP_MEMORY_LIST) +
+      descriptors.size() * sizeof(MINIDUMP_MEMORY_DESCRIPTOR));
+  memory_list_location->Rva = static_cast<RVA>(string_file->SeekGet());
+  uint32_t range_count = static_cast<uint32_t>(descriptors.size());
+  EXPECT_TRUE(string_file->Write(&range_count, sizeof(range_count)));
+  for (const MINIDUMP_MEMORY_DESCRIPTOR& descriptor : descriptors) {
+    EXPECT_TRUE(string_file->Write(&descriptor, sizeof(descriptor)));
+  }
+
+  memory64_list_location->DataSize = static_cast<uint32_t>(
+      sizeof(MINIDUMP_MEMORY64_LIST) +
+      descriptors64.size() * sizeof(MINIDUMP_MEMORY_DESCRIPTOR64));
+  memory64_list_location->Rva = static_cast<RVA>(string_file->SeekGet());
+  EXPECT_TRUE(string_file->Write(&memory64_list_header,
+                                 sizeof(memory64_list_header)));
+  for (const MINIDUMP_MEMORY_DESCRIPTOR64& descriptor : descriptors64) {
+    EXPECT_TRUE(string_file->Write(&descriptor, sizeof(descriptor)));
+  }
+}
+
+// Returns the contents of each range, keyed by its address.
+std::vector<std::pair<uint64_t, std::string>> RangeContents(
+    const StringFile& string_file,
+    const std::vector<MinidumpMemoryRange>& ranges) {
+  std::vector<std::pair<uint64_t, std::string>> contents;
+  for (const MinidumpMemoryRange& range : ranges) {
+    contents.push_back(std::make_pair(
+        range.address,
+        string_file.string().substr(range.file_offset, range.size)));
+  }
+  return contents;
+}
+
+TEST(MinidumpMemoryRanges, Sorted) {
+  StringFile string_file;
+  MINIDUMP_LOCATION_DESCRIPTOR memory_list;
+  MINIDUMP_LOCATION_DESCRIPTOR memory64_list;
+  WriteMemoryLists(&string_file,
+                   {{0x3000, "stack"}, {0x1000, "0123"}},
+                   {{0x2000, "heap"}, {0x1004, "45"}},
+                   &memory_list,
+                   &memory64_list);
+
+  std::vector<MinidumpMemoryRange> ranges;
+  ASSERT_TRUE(internal::ReadMinidumpMemoryRanges(
+      &string_file, &memory_list, &memory64_list, &ranges));
+  const std::vector<std::pair<uint64_t, std::string>> expected = {
+      {0x1000, "0123"}, {0x1004, "45"}, {0x2000, "heap"}, {0x3000, "stack"}};
+  EXPECT_EQ(RangeContents(string_file, ranges), expected);
+
+  // Either stream may be absent.
+  ASSERT_TRUE(internal::ReadMinidumpMemoryRanges(
+      &string_file, &memory_list, nullptr, &ranges));
+  EXPECT_EQ(ranges.size(), 2u);
+  ASSERT_TRUE(internal::ReadMinidumpMemoryRanges(
+      &string_file, nullptr, &memory64_list, &ranges));
+  EXPECT_EQ(ranges.size(), 2u);
+  ASSERT_TRUE(internal::ReadMinidumpMemoryRanges(
+      &string_file, nullptr, nullptr, &ranges));
+  EXPECT_TRUE(ranges.empty());
+}
+
+TEST(MinidumpMemoryRanges, OverlappingAndEmpty) {
+  StringFile string_file;
+  MINIDUMP_LOCATION_DESCRIPTOR memory_list;
+  MINIDUMP_LOCATION_DESCRIPTOR memory64_list;
+  WriteMemoryLists(&string_file,
+                   {{0x1004, "ABCDEFGH"},
+                    {0x1800, ""},
+                    {0x1000, "01234567"},
+                    {0x1006, "xy"}},
+                   {{0x0ffe, "!!abcdefghijklmn"},
+                    {0x2000, ""},
+                    {0x1010, "oo"},
+                    {0x2000, "heap"}},
+                   &memory_list,
+                   &memory64_list);
+
+  // The range listed first supplies the contents of an overlap, and
+  // MINIDUMP_MEMORY_LIST is listed before MINIDUMP_MEMORY64_LIST. Empty ranges
+  // are omitted, and an empty MINIDUMP_MEMORY64_LIST range doesn’t move the
+  // contents of those following it.
+  std::vector<MinidumpMemoryRange> ranges;
+  ASSERT_TRUE(internal::ReadMinidumpMemoryRanges(
+      &string_file, &memory_list, &memory64_list, &ranges));
+  const std::vector<std::pair<uint64_t, std::string>> expected = {
+      {0x0ffe, "!!"},
+      {0x1000, "0123"},
+      {0x1004, "ABCDEFGH"},
+      {0x100c, "mn"},
+      {0x1010, "oo"},
+      {0x2000, "heap"}};
+  EXPECT_EQ(RangeContents(string_file, ranges), expected);
+}
+
+TEST(MinidumpMemoryRanges, Overflow) {
+  StringFile string_file;
+  MINIDUMP_LOCATION_DESCRIPTOR memory_list;
+  MINIDUMP_LOCATION_DESCRIPTOR memory64_list;
+  WriteMemoryLists(&string_file,
+                   {},
+                   {{0xfffffffffffffffe, "abcd"}},
+                   &memory_list,
+                   &memory64_list);
+
+  std::vector<MinidumpMemoryRange> ranges;
+  EXPECT_FALSE(internal::ReadMinidumpMemoryRanges(
+      &string_file, &memory_list, &memory64_list, &ranges));
+}
+
+TEST(MinidumpMemoryRanges, SizeMismatch) {
+  StringFile string_file;
+  MINIDUMP_LOCATION_DESCRIPTOR memory_list;
+  MINIDUMP_LOCATION_DESCRIPTOR memory64_list;
+  WriteMemoryLists(
+      &string_file, {{0x1000, "0123"}}, {}, &memory_list, &memory64_list);
+
+  std::vector<MinidumpMemoryRange> ranges;
+  ++memory_list.DataSize;
+  EXPECT_FALSE(internal::ReadMinidumpMemoryRanges(
+      &string_file, &memory_list, nullptr, &ranges));
+  memory_list.DataSize -= 2;
+  EXPECT_FALSE(internal::ReadMinidumpMemoryRanges(
+      &string_file, &memory_list, nullptr, &ranges));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
@@ -0,0 +1,152 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "snapshot/minidump/minidump_process_memory.h"
+
+#include <map>
+#include <vector>
+
+#include "base/logging.h"
+#include "minidump/minidump_extensions.h"
+#include "snapshot/minidump/minidump_memory_ranges.h"
+#include "util/file/file_reader.h"
+
+namespace crashpad {
+
+MinidumpProcessMemory::MinidumpProcessMemory()
+    : source_(), memory_(), is_64_bit_(false), initialized_() {}
+
+MinidumpProcessMemory::~MinidumpProcessMemory() {}
+
+bool MinidumpProcessMemory::Initialize(const base::FilePath& path) {
+  INITIALIZATION_STATE_SET_INITIALIZING(initialized_);
+
+  if (!source_.Initialize(path)) {
+    return false;
+  }
+
+  MINIDUMP_HEADER header;
+  if (!source_.ReadFileRange(0, sizeof(header), &header)) {
+    return false;
+  }
+
+  if (header.Signature != MINIDUMP_SIGNATURE) {
+    LOG(ERROR) << "minidump signature mismatch";
+    return false;
+  }
+
+  if (header.Version != MINIDUMP_VERSION) {
+    LOG(ERROR) << "minidump version mismatch";
+    return false;
+  }
+
+  std::vector<MINIDUMP_DIRECTORY> stream_directory(header.NumberOfStreams);
+  if (!stream_directory.empty() &&
+      !source_.ReadFileRange(
+          header.StreamDirectoryRva,
+          stream_directory.size() * sizeof(stream_directory[0]),
+          &stream_directory[0])) {
+    return false;
+  }
+
+  std::map<MinidumpStreamType, const MINIDUMP_LOCATION_DESCRIPTOR*> stream_map;
+  for (const MINIDUMP_DIRECTORY& directory : stream_directory) {
+    const MinidumpStreamType stream_type =
+        static_cast<MinidumpStreamType>(directory.StreamType);
+    if (stream_map.find(stream_type) != stream_map.end()) {
+      LOG(ERROR) << "duplicate streams for type " << directory.StreamType;
+      return false;
+    }
+
+    stream_map[stream_type] = &directory.Location;
+  }
+
+  const auto& system_info_it = stream_map.find(kMinidumpStreamTypeSystemInfo);
+  if (system_info_it == stream_map.end()) {
+    LOG(ERROR) << "no system info stream";
+    return false;
+  }
+  if (!ReadSystemInfo(*system_info_it->second)) {
+    return false;
+  }
+
+  const auto& memory_list_it = stream_map.find(kMinidumpStreamTypeMemoryList);
+  const auto& memory64_list_it =
+      stream_map.find(kMinidumpStreamTypeMemory64List);
+  FileReader file_reader;
+  std::vector<internal::MinidumpMemoryRange> ranges;
+  if (!file_reader.Open(path) ||
+      !internal::ReadMinidumpMemoryRanges(
+          &file_reader,
+          memory_list_it != stream_map.end() ? memory_list_it->second
+                                             : nullptr,
+          memory64_list_it != stream_map.end() ? memory64_list_it->second
+                                               : nullptr,
+          &ranges)) {
+    return false;
+  }
+
+  for (const internal::MinidumpMemoryRange& range : ranges) {
+    if (!source_.AddRange(range.address, range.file_offset, range.size)) {
+      return false;
+    }
+  }
+
+  if (!memory_.InitializeWithSource(&source_)) {
+    return false;
+  }
+
+  INITIALIZATION_STATE_SET_VALID(initialized_);
+  return true;
+}
+
+bool MinidumpProcessMemory::Is64Bit() const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  return is_64_bit_;
+}
+
+const ProcessMemory* MinidumpProcessMemory::Memory() const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  return &memory_;
+}
+
+bool MinidumpProcessMemory::ReadSystemInfo(
+    const MINIDUMP_LOCATION_DESCRIPTOR& location) {
+  if (location.DataSize < sizeof(MINIDUMP_SYSTEM_INFO)) {
+    LOG(ERROR) << "system_info size mismatch";
+    return false;
+  }
+
+  MINIDUMP_SYSTEM_INFO system_info;
+  if (!source_.ReadFileRange(location.Rva, sizeof(system_info), &system_info)) {
+    return false;
+  }
+
+  switch (system_info.ProcessorArchitecture) {
+    case kMinidumpCPUArchitectureAMD64:
+    case kMinidumpCPUArchitectureARM64:
+    case kMinidumpCPUArchitectureARM64Breakpad:
+    case kMinidumpCPUArchitecturePPC64:
+    case kMinidumpCPUArchitectureIA64:
+    case kMinidumpCPUArchitectureAlpha64:
+      is_64_bit_ = true;
+      break;
+    default:
+      is_64_bit_ = false;
+      break;
+  }
+  return true;
+}
+
+}  // namespace crashpad
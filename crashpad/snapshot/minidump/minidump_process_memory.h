@@ -0,0 +1,71 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_SNAPSHOT_MINIDUMP_MINIDUMP_PROCESS_MEMORY_H_
+#define CRASHPAD_SNAPSHOT_MINIDUMP_MINIDUMP_PROCESS_MEMORY_H_
+
+#include <windows.h>
+#include <dbghelp.h>
+
+#include "base/files/file_path.h"
+#include "base/macros.h"
+#include "util/misc/initialization_state_dcheck.h"
+#include "util/process/mapped_file_memory_source.h"
+#include "util/process/process_memory.h"
+
+namespace crashpad {
+
+//! \brief Reads the memory of a process from a minidump file.
+//!
+//! The memory is served from the file’s MINIDUMP_MEMORY_LIST and
+//! MINIDUMP_MEMORY64_LIST streams, so the same readers used on a live process,
+//! such as ElfImageReader, can be used on the minidump file. Overlapping
+//! ranges are resolved as described by internal::ReadMinidumpMemoryRanges().
+//! MinidumpDeduplicatedMemoryList is not supported.
+class MinidumpProcessMemory {
+ public:
+  MinidumpProcessMemory();
+  ~MinidumpProcessMemory();
+
+  //! \brief Initializes this object to read memory from the minidump file at
+  //!     \a path.
+  //!
+  //! The minidump file must contain a MINIDUMP_SYSTEM_INFO stream, which
+  //! determines whether the process was 64-bit.
+  //!
+  //! This method must be successfully called before calling any other.
+  //!
+  //! \return `true` on success. `false` on failure with a message logged.
+  bool Initialize(const base::FilePath& path);
+
+  //! \brief Returns `true` if the minidump file is of a 64-bit process.
+  bool Is64Bit() const;
+
+  //! \brief Returns the memory of the process.
+  const ProcessMemory* Memory() const;
+
+ private:
+  bool ReadSystemInfo(const MINIDUMP_LOCATION_DESCRIPTOR& location);
+
+  MappedFileMemorySource source_;
+  ProcessMemory memory_;
+  bool is_64_bit_;
+  InitializationStateDcheck initialized_;
+
+  DISALLOW_COPY_AND_ASSIGN(MinidumpProcessMemory);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_SNAPSHOT_MINIDUMP_MINIDUMP_PROCESS_MEMORY_H_
@@ -0,0 +1,153 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "snapshot/minidump/minidump_process_memory.h"
+
+#include <string.h>
+
+#include <string>
+
+#include "gtest/gtest.h"
+#include "minidump/minidump_extensions.h"
+#include "test/scoped_temp_dir.h"
+#include "util/file/file_io.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+template <typename T>
+void Append(std::string* contents, const T& value) {
+  contents->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+base::FilePath WriteContents(const ScopedTempDir& temp_dir,
+                             const std::string& contents) {
+  base::FilePath path = temp_dir.path().Append("minidump");
+  ScopedFileHandle handle(LoggingOpenFileForWrite(
+      path, FileWriteMode::kCreateOrFail, FilePermissions::kOwnerOnly));
+  EXPECT_TRUE(handle.is_valid());
+  CheckedWriteFile(handle.get(), contents.data(), contents.size());
+  return path;
+}
+
+// Writes a minidump file with a MINIDUMP_SYSTEM_INFO stream and, if
+// |with_memory| is true, MINIDUMP_MEMORY_LIST and MINIDUMP_MEMORY64_LIST
+// streams that overlap at 0x1000.
+base::FilePath WriteMinidump(const ScopedTempDir& temp_dir,
+                             uint16_t architecture,
+                             bool with_memory) {
+  const uint32_t stream_count = with_memory ? 3 : 1;
+  const RVA system_info_rva =
+      sizeof(MINIDUMP_HEADER) + stream_count * sizeof(MINIDUMP_DIRECTORY);
+  const RVA memory_list_rva = system_info_rva + sizeof(MINIDUMP_SYSTEM_INFO);
+  const uint32_t memory_list_size =
+      sizeof(MINIDUMP_MEMORY_LIST) + sizeof(MINIDUMP_MEMORY_DESCRIPTOR);
+  const RVA memory64_list_rva = memory_list_rva + memory_list_size;
+  const uint32_t memory64_list_size =
+      sizeof(MINIDUMP_MEMORY64_LIST) + 2 * sizeof(MINIDUMP_MEMORY_DESCRIPTOR64);
+  const RVA data_rva = memory64_list_rva + memory64_list_size;
+
+  std::string contents;
+  MINIDUMP_HEADER header = {};
+  header.Signature = MINIDUMP_SIGNATURE;
+  header.Version = MINIDUMP_VERSION;
+  header.NumberOfStreams = stream_count;
+  header.StreamDirectoryRva = sizeof(header);
+  Append(&contents, header);
+
+  MINIDUMP_DIRECTORY directory = {};
+  directory.StreamType = kMinidumpStreamTypeSystemInfo;
+  directory.Location.DataSize = sizeof(MINIDUMP_SYSTEM_INFO);
+  directory.Location.Rva = system_info_rva;
+  Append(&contents, directory);
+  if (with_memory) {
+    directory.StreamType = kMinidumpStreamTypeMemoryList;
+    directory.Location.DataSize = memory_list_size;
+    directory.Location.Rva = memory_list_rva;
+    Append(&contents, directory);
+    directory.StreamType = kMinidumpStreamTypeMemory64List;
+    directory.Location.DataSize = memory64_list_size;
+    directory.Location.Rva = memory64_list_rva;
+    Append(&contents, directory);
+  }
+
+  MINIDUMP_SYSTEM_INFO system_info = {};
+  system_info.ProcessorArchitecture = architecture;
+  Append(&contents, system_info);
+  if (!with_memory) {
+    return WriteContents(temp_dir, contents);
+  }
+
+  // “abcd” at 0x1000.
+  Append(&contents, uint32_t{1});
+  MINIDUMP_MEMORY_DESCRIPTOR descriptor = {};
+  descriptor.StartOfMemoryRange = 0x1000;
+  descriptor.Memory.DataSize = 4;
+  descriptor.Memory.Rva = data_rva;
+  Append(&contents, descriptor);
+
+  // “wxyzefgh” at 0x1000 and “ijkl” at 0x2000.
+  MINIDUMP_MEMORY64_LIST memory64_list = {};
+  memory64_list.NumberOfMemoryRanges = 2;
+  memory64_list.BaseRva = data_rva + 4;
+  Append(&contents, memory64_list);
+  MINIDUMP_MEMORY_DESCRIPTOR64 descriptor64 = {};
+  descriptor64.StartOfMemoryRange = 0x1000;
+  descriptor64.DataSize = 8;
+  Append(&contents, descriptor64);
+  descriptor64.StartOfMemoryRange = 0x2000;
+  descriptor64.DataSize = 4;
+  Append(&contents, descriptor64);
+
+  EXPECT_EQ(contents.size(), data_rva);
+  contents.append("abcdwxyzefghijkl");
+  return WriteContents(temp_dir, contents);
+}
+
+std::string ReadMemory(const ProcessMemory* memory,
+                       VMAddress address,
+                       size_t size) {
+  std::string buffer(size, '\0');
+  if (!memory->Read(address, size, &buffer[0])) {
+    return "-";
+  }
+  return buffer;
+}
+
+TEST(MinidumpProcessMemory, Memory) {
+  ScopedTempDir temp_dir;
+  MinidumpProcessMemory minidump;
+  ASSERT_TRUE(minidump.Initialize(
+      WriteMinidump(temp_dir, kMinidumpCPUArchitectureAMD64, true)));
+  EXPECT_TRUE(minidump.Is64Bit());
+
+  EXPECT_EQ(ReadMemory(minidump.Memory(), 0x1000, 8), "abcdefgh");
+  EXPECT_EQ(ReadMemory(minidump.Memory(), 0x2000, 4), "ijkl");
+  EXPECT_EQ(ReadMemory(minidump.Memory(), 0x1006, 4), "-");
+  EXPECT_EQ(ReadMemory(minidump.Memory(), 0x0fff, 1), "-");
+}
+
+TEST(MinidumpProcessMemory, NoMemory) {
+  ScopedTempDir temp_dir;
+  MinidumpProcessMemory minidump;
+  ASSERT_TRUE(minidump.Initialize(
+      WriteMinidump(temp_dir, kMinidumpCPUArchitectureX86, false)));
+  EXPECT_FALSE(minidump.Is64Bit());
+  EXPECT_EQ(ReadMemory(minidump.Memory(), 0x1000, 1), "-");
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
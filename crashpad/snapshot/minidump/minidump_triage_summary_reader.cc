@@ -0,0 +1,265 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "snapshot/minidump/minidump_triage_summary_reader.h"
+
+#include <windows.h>
+#include <dbghelp.h>
+#include <string.h>
+
+#include "base/logging.h"
+#include "minidump/minidump_extensions.h"
+
+namespace crashpad {
+
+namespace {
+
+// Stream directories and triage summaries are small. These limit the memory
+// allocated for malformed ones.
+constexpr uint64_t kMaxDirectorySize = 1024 * 1024;
+constexpr uint32_t kMaxTriageSummarySize = 1024 * 1024;
+
+// Copies |size| bytes at |offset| in a minidump file to |contents|. The bytes
+// are taken from |prefix|, the first |prefix_size| bytes of the file, if they
+// lie within it. Otherwise, they are read from |file_reader|, unless it is
+// nullptr.
+bool ReadRange(const char* prefix,
+               size_t prefix_size,
+               FileReaderInterface* file_reader,
+               uint64_t offset,
+               size_t size,
+               std::string* contents) {
+  if (offset <= prefix_size && size <= prefix_size - offset) {
+    contents->assign(prefix + offset, size);
+    return true;
+  }
+
+  if (!file_reader || !file_reader->SeekSet(offset)) {
+    return false;
+  }
+
+  contents->resize(size);
+  return size == 0 || file_reader->ReadExactly(&(*contents)[0], size);
+}
+
+// Returns the NUL-terminated string at |offset| in |string_data|.
+bool StringAtOffset(const char* string_data,
+                    size_t string_data_size,
+                    uint32_t offset,
+                    std::string* string) {
+  if (offset >= string_data_size) {
+    LOG(ERROR) << "triage_summary string offset out of range";
+    return false;
+  }
+
+  const char* start = string_data + offset;
+  const void* nul = memchr(start, '\0', string_data_size - offset);
+  if (!nul) {
+    LOG(ERROR) << "triage_summary string not terminated";
+    return false;
+  }
+
+  string->assign(start, static_cast<const char*>(nul) - start);
+  return true;
+}
+
+bool DecodeTriageSummary(const std::string& stream, TriageSummary* summary) {
+  MinidumpTriageSummary summary_base;
+  if (stream.size() < sizeof(summary_base)) {
+    LOG(ERROR) << "triage_summary size mismatch";
+    return false;
+  }
+  memcpy(&summary_base, stream.data(), sizeof(summary_base));
+
+  if (summary_base.version != MinidumpTriageSummary::kVersion) {
+    LOG(ERROR) << "triage_summary version mismatch";
+    return false;
+  }
+
+  const uint64_t frames_size =
+      static_cast<uint64_t>(summary_base.frame_count) *
+      sizeof(MinidumpTriageFrame);
+  const uint64_t annotations_size =
+      static_cast<uint64_t>(summary_base.annotation_count) *
+      sizeof(MinidumpTriageAnnotation);
+  if (sizeof(summary_base) + frames_size + annotations_size +
+          summary_base.string_data_size !=
+      stream.size()) {
+    LOG(ERROR) << "triage_summary size mismatch";
+    return false;
+  }
+
+  const char* frames_data = stream.data() + sizeof(summary_base);
+  const char* annotations_data = frames_data + frames_size;
+  const char* string_data = annotations_data + annotations_size;
+
+  TriageSummary local_summary;
+  local_summary.has_exception =
+      (summary_base.flags & MinidumpTriageSummary::kFlagHasException) != 0;
+  local_summary.exception_code = summary_base.exception_code;
+  local_summary.exception_address = summary_base.exception_address;
+  local_summary.signature_hash = summary_base.signature_hash;
+
+  for (uint32_t index = 0; index < summary_base.frame_count; ++index) {
+    MinidumpTriageFrame frame_base;
+    memcpy(&frame_base,
+           frames_data + index * sizeof(frame_base),
+           sizeof(frame_base));
+
+    TriageSummary::Frame frame;
+    frame.address = frame_base.address;
+    if (frame_base.module_name_offset != MinidumpTriageFrame::kNoModule &&
+        !StringAtOffset(string_data,
+                        summary_base.string_data_size,
+                        frame_base.module_name_offset,
+                        &frame.module_name)) {
+      return false;
+    }
+    local_summary.frames.push_back(frame);
+  }
+
+  for (uint32_t index = 0; index < summary_base.annotation_count; ++index) {
+    MinidumpTriageAnnotation annotation;
+    memcpy(&annotation,
+           annotations_data + index * sizeof(annotation),
+           sizeof(annotation));
+
+    std::string key;
+    std::string value;
+    if (!StringAtOffset(string_data,
+                        summary_base.string_data_size,
+                        annotation.key_offset,
+                        &key) ||
+        !StringAtOffset(string_data,
+                        summary_base.string_data_size,
+                        annotation.value_offset,
+                        &value)) {
+      return false;
+    }
+    local_summary.annotations[key] = value;
+  }
+
+  *summary = local_summary;
+  return true;
+}
+
+bool ReadTriageSummary(const char* prefix,
+                       size_t prefix_size,
+                       FileReaderInterface* file_reader,
+                       TriageSummary* summary) {
+  std::string contents;
+  MINIDUMP_HEADER header;
+  if (!ReadRange(
+          prefix, prefix_size, file_reader, 0, sizeof(header), &contents)) {
+    return false;
+  }
+  memcpy(&header, contents.data(), sizeof(header));
+
+  if (header.Signature != MINIDUMP_SIGNATURE) {
+    LOG(ERROR) << "minidump signature mismatch";
+    return false;
+  }
+
+  if (header.Version != MINIDUMP_VERSION) {
+    LOG(ERROR) << "minidump version mismatch";
+    return false;
+  }
+
+  const uint64_t directory_size = static_cast<uint64_t>(
+      header.NumberOfStreams) * sizeof(MINIDUMP_DIRECTORY);
+  if (directory_size > kMaxDirectorySize) {
+    LOG(ERROR) << "stream directory size " << directory_size << " too large";
+    return false;
+  }
+
+  if (!ReadRange(prefix,
+                 prefix_size,
+                 file_reader,
+                 header.StreamDirectoryRva,
+                 static_cast<size_t>(directory_size),
+                 &contents)) {
+    return false;
+  }
+
+  for (uint32_t index = 0; index < header.NumberOfStreams; ++index) {
+    MINIDUMP_DIRECTORY directory;
+    memcpy(&directory,
+           &contents[index * sizeof(directory)],
+           sizeof(directory));
+    if (directory.StreamType != kMinidumpStreamTypeCrashpadTriageSummary) {
+      continue;
+    }
+
+    if (directory.Location.DataSize > kMaxTriageSummarySize) {
+      LOG(ERROR) << "triage_summary size " << directory.Location.DataSize
+                 << " too large";
+      return false;
+    }
+
+    std::string stream;
+    return ReadRange(prefix,
+                     prefix_size,
+                     file_reader,
+                     directory.Location.Rva,
+                     directory.Location.DataSize,
+                     &stream) &&
+           DecodeTriageSummary(stream, summary);
+  }
+
+  return false;
+}
+
+}  // namespace
+
+TriageSummary::TriageSummary()
+    : has_exception(false),
+      exception_code(0),
+      exception_address(0),
+      signature_hash(0),
+      frames(),
+      annotations() {}
+
+TriageSummary::~TriageSummary() {}
+
+bool ReadMinidumpTriageSummary(const void* data,
+                               size_t size,
+                               TriageSummary* summary) {
+  return ReadTriageSummary(
+      static_cast<const char*>(data), size, nullptr, summary);
+}
+
+bool ReadMinidumpTriageSummary(FileReaderInterface* file_reader,
+                               TriageSummary* summary) {
+  if (!file_reader->SeekSet(0)) {
+    return false;
+  }
+
+  char prefix[kMinidumpTriageSummaryReadSize];
+  size_t prefix_size = 0;
+  while (prefix_size < sizeof(prefix)) {
+    FileOperationResult rv =
+        file_reader->Read(prefix + prefix_size, sizeof(prefix) - prefix_size);
+    if (rv < 0) {
+      return false;
+    }
+    if (rv == 0) {
+      break;
+    }
+    prefix_size += rv;
+  }
+
+  return ReadTriageSummary(prefix, prefix_size, file_reader, summary);
+}
+
+}  // namespace crashpad
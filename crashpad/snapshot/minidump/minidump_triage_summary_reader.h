@@ -0,0 +1,104 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_SNAPSHOT_MINIDUMP_MINIDUMP_TRIAGE_SUMMARY_READER_H_
+#define CRASHPAD_SNAPSHOT_MINIDUMP_MINIDUMP_TRIAGE_SUMMARY_READER_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "util/file/file_reader.h"
+
+namespace crashpad {
+
+//! \brief The contents of a MinidumpTriageSummary stream.
+struct TriageSummary {
+  //! \brief A stack frame.
+  struct Frame {
+    //! \brief The base name of the module containing the frame, or an empty
+    //!     string if the frame is not within any module.
+    std::string module_name;
+
+    //! \brief The frame’s address relative to its module, or its absolute
+    //!     address if #module_name is empty.
+    uint64_t address;
+  };
+
+  TriageSummary();
+  ~TriageSummary();
+
+  //! \brief Whether the minidump file contains an exception.
+  bool has_exception;
+
+  //! \brief The exception code, valid if #has_exception is `true`.
+  uint32_t exception_code;
+
+  //! \brief The exception address, valid if #has_exception is `true`.
+  uint64_t exception_address;
+
+  //! \brief A hash identifying the crash. See
+  //!     MinidumpTriageSummary::signature_hash.
+  uint64_t signature_hash;
+
+  //! \brief The frames, starting with the exception’s instruction pointer.
+  std::vector<Frame> frames;
+
+  //! \brief The annotations selected when the minidump file was written.
+  std::map<std::string, std::string> annotations;
+};
+
+//! \brief The number of bytes from the start of a minidump file that should
+//!     be read in order to find a triage summary without further reads.
+constexpr size_t kMinidumpTriageSummaryReadSize = 4096;
+
+//! \brief Decodes the triage summary from a prefix of a minidump file.
+//!
+//! This is suitable for a reader that has only the first
+//! #kMinidumpTriageSummaryReadSize bytes of a minidump file, such as a server
+//! that has received only the start of an upload.
+//!
+//! \param[in] data The start of a minidump file.
+//! \param[in] size The number of bytes available at \a data.
+//! \param[out] summary The triage summary.
+//!
+//! \return `true` on success, with \a summary set. `false` if \a data does not
+//!     contain a complete triage summary or is not a valid minidump file, with
+//!     a message logged if the data is malformed.
+bool ReadMinidumpTriageSummary(const void* data,
+                               size_t size,
+                               TriageSummary* summary);
+
+//! \brief Reads the triage summary from a minidump file.
+//!
+//! The first #kMinidumpTriageSummaryReadSize bytes of the file are read in a
+//! single operation. If the summary does not lie entirely within them, the
+//! remainder is read separately.
+//!
+//! \param[in] file_reader A file reader corresponding to a minidump file. The
+//!     file reader must support seeking.
+//! \param[out] summary The triage summary.
+//!
+//! \return `true` on success, with \a summary set. `false` if the file contains
+//!     no triage summary or could not be read, with a message logged if the
+//!     file is malformed.
+bool ReadMinidumpTriageSummary(FileReaderInterface* file_reader,
+                               TriageSummary* summary);
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_SNAPSHOT_MINIDUMP_MINIDUMP_TRIAGE_SUMMARY_READER_H_
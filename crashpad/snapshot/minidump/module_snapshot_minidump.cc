@@ -64,14 +64,12 @@ std::string ModuleSnapshotMinidump::Name() const {
 
 uint64_t ModuleSnapshotMinidump::Address() const {
   INITIALIZATION_STATE_DCHECK_VALID(initialized_);
-  NOTREACHED();  // https://crashpad.chromium.org/bug/10
-  return 0;
+  return minidump_module_.BaseOfImage;
 }
 
 uint64_t ModuleSnapshotMinidump::Size() const {
   INITIALIZATION_STATE_DCHECK_VALID(initialized_);
-  NOTREACHED();  // https://crashpad.chromium.org/bug/10
-  return 0;
+  return minidump_module_.SizeOfImage;
 }
 
 time_t ModuleSnapshotMinidump::Timestamp() const {
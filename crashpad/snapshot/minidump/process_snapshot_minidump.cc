@@ -14,10 +14,12 @@
 
 #include "snapshot/minidump/process_snapshot_minidump.h"
 
+#include <algorithm>
 #include <memory>
 #include <utility>
 
 #include "base/memory/ptr_util.h"
+#include "snapshot/minidump/minidump_memory_ranges.h"
 #include "snapshot/minidump/minidump_simple_string_dictionary_reader.h"
 #include "util/file/file_io.h"
 
@@ -29,7 +31,12 @@ ProcessSnapshotMinidump::ProcessSnapshotMinidump()
       stream_directory_(),
       stream_map_(),
       modules_(),
+      modules_by_address_(),
+      memory_ranges_(),
+      memory_initialized_(),
       unloaded_modules_(),
+      deduplicated_memory_(),
+      deduplicated_memory_initialized_(),
       crashpad_info_(),
       annotations_simple_map_(),
       file_reader_(nullptr),
@@ -91,6 +98,8 @@ bool ProcessSnapshotMinidump::Initialize(FileReaderInterface* file_reader) {
     return false;
   }
 
+  // Memory is indexed when it is first needed, so that a damaged memory
+  // stream doesn’t prevent the rest of the file from being used.
   return InitializeModules();
 }
 
@@ -206,6 +215,80 @@ std::vector<const MemorySnapshot*> ProcessSnapshotMinidump::ExtraMemory()
   return std::vector<const MemorySnapshot*>();
 }
 
+std::vector<const MemorySnapshot*>
+ProcessSnapshotMinidump::DeduplicatedMemory() const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  InitializeDeduplicatedMemory();
+  std::vector<const MemorySnapshot*> memory;
+  for (internal::DeduplicatedMemorySnapshotMinidump* range :
+       deduplicated_memory_) {
+    memory.push_back(range);
+  }
+  return memory;
+}
+
+bool ProcessSnapshotMinidump::ReadMemory(uint64_t address,
+                                         size_t size,
+                                         void* buffer) const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  InitializeMemory();
+
+  // Find the last range that begins at or before |address|.
+  auto it = std::upper_bound(
+      memory_ranges_.begin(),
+      memory_ranges_.end(),
+      address,
+      [](uint64_t value, const internal::MinidumpMemoryRange& range) {
+        return value < range.address;
+      });
+  if (it == memory_ranges_.begin()) {
+    return size == 0;
+  }
+  --it;
+
+  char* buffer_c = static_cast<char*>(buffer);
+  while (size > 0) {
+    if (it == memory_ranges_.end() || address < it->address ||
+        address - it->address >= it->size) {
+      return false;
+    }
+
+    const uint64_t offset = address - it->address;
+    const size_t read_size =
+        static_cast<size_t>(std::min<uint64_t>(size, it->size - offset));
+    if (!file_reader_->SeekSet(it->file_offset + offset) ||
+        !file_reader_->ReadExactly(buffer_c, read_size)) {
+      return false;
+    }
+
+    buffer_c += read_size;
+    address += read_size;
+    size -= read_size;
+    ++it;
+  }
+
+  return true;
+}
+
+const ModuleSnapshot* ProcessSnapshotMinidump::ModuleForAddress(
+    uint64_t address) const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+
+  auto it = std::upper_bound(
+      modules_by_address_.begin(),
+      modules_by_address_.end(),
+      address,
+      [](uint64_t value, const internal::ModuleSnapshotMinidump* module) {
+        return value < module->Address();
+      });
+  if (it == modules_by_address_.begin()) {
+    return nullptr;
+  }
+  --it;
+
+  return address - (*it)->Address() < (*it)->Size() ? *it : nullptr;
+}
+
 bool ProcessSnapshotMinidump::InitializeCrashpadInfo() {
   const auto& stream_it = stream_map_.find(kMinidumpStreamTypeCrashpadInfo);
   if (stream_it == stream_map_.end()) {
@@ -236,6 +319,90 @@ bool ProcessSnapshotMinidump::InitializeCrashpadInfo() {
       &annotations_simple_map_);
 }
 
+void ProcessSnapshotMinidump::InitializeDeduplicatedMemory() const {
+  if (!deduplicated_memory_initialized_.is_uninitialized()) {
+    return;
+  }
+
+  // A stream that can’t be read leaves no deduplicated memory.
+  deduplicated_memory_initialized_.set_invalid();
+  if (!ReadDeduplicatedMemory()) {
+    LOG(WARNING) << "deduplicated memory unavailable";
+    return;
+  }
+  deduplicated_memory_initialized_.set_valid();
+}
+
+bool ProcessSnapshotMinidump::ReadDeduplicatedMemory() const {
+  const auto& stream_it =
+      stream_map_.find(kMinidumpStreamTypeCrashpadDeduplicatedMemoryList);
+  if (stream_it == stream_map_.end()) {
+    return true;
+  }
+
+  MinidumpDeduplicatedMemoryList memory_list;
+  if (stream_it->second->DataSize < sizeof(memory_list)) {
+    LOG(ERROR) << "deduplicated_memory_list size mismatch";
+    return false;
+  }
+
+  if (!file_reader_->SeekSet(stream_it->second->Rva)) {
+    return false;
+  }
+
+  if (!file_reader_->ReadExactly(&memory_list, sizeof(memory_list))) {
+    return false;
+  }
+
+  if (memory_list.version != MinidumpDeduplicatedMemoryList::kVersion) {
+    LOG(ERROR) << "deduplicated_memory_list version mismatch";
+    return false;
+  }
+
+  if (sizeof(memory_list) + static_cast<uint64_t>(memory_list.range_count) *
+                                sizeof(MinidumpDeduplicatedMemoryRange) !=
+          stream_it->second->DataSize ||
+      static_cast<uint64_t>(memory_list.page_reference_count) *
+              sizeof(uint32_t) !=
+          memory_list.page_references.DataSize ||
+      static_cast<uint64_t>(memory_list.page_count) * memory_list.page_size !=
+          memory_list.pages.DataSize) {
+    LOG(ERROR) << "deduplicated_memory_list size mismatch";
+    return false;
+  }
+
+  std::vector<MinidumpDeduplicatedMemoryRange> ranges(memory_list.range_count);
+  if (!ranges.empty() &&
+      !file_reader_->ReadExactly(&ranges[0],
+                                 ranges.size() * sizeof(ranges[0]))) {
+    return false;
+  }
+
+  std::vector<uint32_t> page_references(memory_list.page_reference_count);
+  if (!page_references.empty() &&
+      (!file_reader_->SeekSet(memory_list.page_references.Rva) ||
+       !file_reader_->ReadExactly(
+           &page_references[0],
+           page_references.size() * sizeof(page_references[0])))) {
+    return false;
+  }
+
+  PointerVector<internal::DeduplicatedMemorySnapshotMinidump>
+      deduplicated_memory;
+  for (const MinidumpDeduplicatedMemoryRange& range : ranges) {
+    auto memory =
+        base::WrapUnique(new internal::DeduplicatedMemorySnapshotMinidump());
+    if (!memory->Initialize(
+            file_reader_, memory_list, range, page_references)) {
+      return false;
+    }
+    deduplicated_memory.push_back(memory.release());
+  }
+
+  deduplicated_memory_.swap(deduplicated_memory);
+  return true;
+}
+
 bool ProcessSnapshotMinidump::InitializeModules() {
   const auto& stream_it = stream_map_.find(kMinidumpStreamTypeModuleList);
   if (stream_it == stream_map_.end()) {
@@ -287,14 +454,52 @@ bool ProcessSnapshotMinidump::InitializeModules() {
     modules_.push_back(module.release());
   }
 
+  modules_by_address_.assign(modules_.begin(), modules_.end());
+  std::sort(modules_by_address_.begin(),
+            modules_by_address_.end(),
+            [](const internal::ModuleSnapshotMinidump* left,
+               const internal::ModuleSnapshotMinidump* right) {
+              return left->Address() < right->Address();
+            });
+
   return true;
 }
 
+void ProcessSnapshotMinidump::InitializeMemory() const {
+  if (!memory_initialized_.is_uninitialized()) {
+    return;
+  }
+
+  // Streams that can’t be read leave no memory to read.
+  memory_initialized_.set_invalid();
+  const auto& memory_list_it = stream_map_.find(kMinidumpStreamTypeMemoryList);
+  const auto& memory64_list_it =
+      stream_map_.find(kMinidumpStreamTypeMemory64List);
+  if (!internal::ReadMinidumpMemoryRanges(
+          file_reader_,
+          memory_list_it != stream_map_.end() ? memory_list_it->second
+                                              : nullptr,
+          memory64_list_it != stream_map_.end() ? memory64_list_it->second
+                                                : nullptr,
+          &memory_ranges_)) {
+    memory_ranges_.clear();
+    LOG(WARNING) << "memory unavailable";
+    return;
+  }
+  memory_initialized_.set_valid();
+}
+
 bool ProcessSnapshotMinidump::InitializeModulesCrashpadInfo(
     std::map<uint32_t, MINIDUMP_LOCATION_DESCRIPTOR>*
         module_crashpad_info_links) {
   module_crashpad_info_links->clear();
 
+  // Minidump files not written by Crashpad have no MinidumpCrashpadInfo stream,
+  // and so no Crashpad-specific module information.
+  if (stream_map_.find(kMinidumpStreamTypeCrashpadInfo) == stream_map_.end()) {
+    return true;
+  }
+
   if (crashpad_info_.version != MinidumpCrashpadInfo::kVersion) {
     return false;
   }
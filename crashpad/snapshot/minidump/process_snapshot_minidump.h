@@ -17,6 +17,7 @@
 
 #include <windows.h>
 #include <dbghelp.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <sys/time.h>
 
@@ -28,6 +29,8 @@
 #include "minidump/minidump_extensions.h"
 #include "snapshot/exception_snapshot.h"
 #include "snapshot/memory_snapshot.h"
+#include "snapshot/minidump/deduplicated_memory_snapshot_minidump.h"
+#include "snapshot/minidump/minidump_memory_ranges.h"
 #include "snapshot/minidump/module_snapshot_minidump.h"
 #include "snapshot/module_snapshot.h"
 #include "snapshot/process_snapshot.h"
@@ -35,6 +38,7 @@
 #include "snapshot/thread_snapshot.h"
 #include "snapshot/unloaded_module_snapshot.h"
 #include "util/file/file_reader.h"
+#include "util/misc/initialization_state.h"
 #include "util/misc/initialization_state_dcheck.h"
 #include "util/misc/uuid.h"
 #include "util/stdlib/pointer_container.h"
@@ -76,11 +80,69 @@ class ProcessSnapshotMinidump final : public ProcessSnapshot {
   std::vector<HandleSnapshot> Handles() const override;
   std::vector<const MemorySnapshot*> ExtraMemory() const override;
 
+  //! \brief Returns the memory ranges carried in the minidump file’s
+  //!     MinidumpDeduplicatedMemoryList stream, if it has one.
+  //!
+  //! These are the thread stacks and extra memory of a minidump file written
+  //! with MinidumpFileWriter::SetDeduplicateMemory(). Each range’s contents are
+  //! rebuilt from its pages when it is read.
+  //!
+  //! The stream is read the first time that this method is called. If it can’t
+  //! be read, a message is logged, and no ranges are returned.
+  //!
+  //! \return The memory ranges, in the order in which they were written. The
+  //!     caller does not take ownership of these objects, which are scoped to
+  //!     the lifetime of this object.
+  std::vector<const MemorySnapshot*> DeduplicatedMemory() const;
+
+  //! \brief Reads memory of the process that the minidump file contains a
+  //!     snapshot of.
+  //!
+  //! Memory is read from the ranges carried in the minidump file’s
+  //! MINIDUMP_MEMORY_LIST and MINIDUMP_MEMORY64_LIST streams, which are indexed
+  //! by address the first time that this method is called, as described by
+  //! internal::ReadMinidumpMemoryRanges(). If they can’t be indexed, a message
+  //! is logged, and no memory can be read. A read may span adjacent ranges.
+  //! Each read takes time logarithmic in the number of ranges.
+  //!
+  //! \param[in] address The address of the memory to read.
+  //! \param[in] size The number of bytes to read.
+  //! \param[out] buffer A buffer of at least \a size bytes to receive the
+  //!     memory.
+  //!
+  //! \return `true` on success. `false` if any part of the memory was not
+  //!     captured in the minidump file, which is not logged so that callers
+  //!     may probe for memory, or if it could not be read from the file, in
+  //!     which case a message is logged.
+  bool ReadMemory(uint64_t address, size_t size, void* buffer) const;
+
+  //! \brief Returns the module whose image contains \a address.
+  //!
+  //! Modules are indexed by address when the object is initialized, so that
+  //! each lookup takes time logarithmic in the number of modules.
+  //!
+  //! \return The module, or `nullptr` if no module contains \a address. The
+  //!     caller does not take ownership of this object, which is scoped to the
+  //!     lifetime of this object.
+  const ModuleSnapshot* ModuleForAddress(uint64_t address) const;
+
  private:
+  // Indexes data carried in MINIDUMP_MEMORY_LIST and MINIDUMP_MEMORY64_LIST
+  // streams on behalf of ReadMemory(), the first time that it is called.
+  void InitializeMemory() const;
+
   // Initializes data carried in a MinidumpCrashpadInfo stream on behalf of
   // Initialize().
   bool InitializeCrashpadInfo();
 
+  // Initializes data carried in a MinidumpDeduplicatedMemoryList stream on
+  // behalf of DeduplicatedMemory(), the first time that it is called.
+  void InitializeDeduplicatedMemory() const;
+
+  // Reads a MinidumpDeduplicatedMemoryList stream into deduplicated_memory_ on
+  // behalf of InitializeDeduplicatedMemory().
+  bool ReadDeduplicatedMemory() const;
+
   // Initializes data carried in a MINIDUMP_MODULE_LIST stream on behalf of
   // Initialize().
   bool InitializeModules();
@@ -96,7 +158,20 @@ class ProcessSnapshotMinidump final : public ProcessSnapshot {
   std::vector<MINIDUMP_DIRECTORY> stream_directory_;
   std::map<MinidumpStreamType, const MINIDUMP_LOCATION_DESCRIPTOR*> stream_map_;
   PointerVector<internal::ModuleSnapshotMinidump> modules_;
+
+  // modules_, sorted by address.
+  std::vector<const internal::ModuleSnapshotMinidump*> modules_by_address_;
+
+  // Captured memory, sorted by address. The ranges do not overlap. These are
+  // indexed lazily, tracked by memory_initialized_.
+  mutable std::vector<internal::MinidumpMemoryRange> memory_ranges_;
+  mutable InitializationState memory_initialized_;
+
   std::vector<UnloadedModuleSnapshot> unloaded_modules_;
+  // Read lazily, tracked by deduplicated_memory_initialized_.
+  mutable PointerVector<internal::DeduplicatedMemorySnapshotMinidump>
+      deduplicated_memory_;
+  mutable InitializationState deduplicated_memory_initialized_;
   MinidumpCrashpadInfo crashpad_info_;
   std::map<std::string, std::string> annotations_simple_map_;
   FileReaderInterface* file_reader_;  // weak
@@ -19,8 +19,13 @@
 #include <string.h>
 
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
+#include "base/macros.h"
 #include "gtest/gtest.h"
+#include "snapshot/memory_snapshot.h"
 #include "snapshot/module_snapshot.h"
 #include "util/file/string_file.h"
 
@@ -334,6 +339,343 @@ TEST(ProcessSnapshotMinidump, Modules) {
   EXPECT_EQ(annotations_vector, list_annotations_2);
 }
 
+// Writes a minidump file containing only a MinidumpDeduplicatedMemoryList
+// stream with 16-byte pages to |string_file|.
+void WriteDeduplicatedMemoryMinidump(
+    StringFile* string_file,
+    const std::string& pages,
+    const std::vector<uint32_t>& page_references,
+    const std::vector<MinidumpDeduplicatedMemoryRange>& ranges) {
+  constexpr uint32_t kPageSize = 16;
+
+  MINIDUMP_HEADER header = {};
+  EXPECT_TRUE(string_file->Write(&header, sizeof(header)));
+
+  MinidumpDeduplicatedMemoryList memory_list = {};
+  memory_list.version = MinidumpDeduplicatedMemoryList::kVersion;
+  memory_list.page_size = kPageSize;
+  memory_list.page_count = static_cast<uint32_t>(pages.size() / kPageSize);
+  memory_list.page_reference_count =
+      static_cast<uint32_t>(page_references.size());
+  memory_list.range_count = static_cast<uint32_t>(ranges.size());
+
+  memory_list.pages.Rva = static_cast<RVA>(string_file->SeekGet());
+  memory_list.pages.DataSize = static_cast<uint32_t>(pages.size());
+  EXPECT_TRUE(string_file->Write(pages.data(), pages.size()));
+
+  memory_list.page_references.Rva = static_cast<RVA>(string_file->SeekGet());
+  memory_list.page_references.DataSize =
+      static_cast<uint32_t>(page_references.size() * sizeof(uint32_t));
+  EXPECT_TRUE(string_file->Write(page_references.data(),
+                                 memory_list.page_references.DataSize));
+
+  MINIDUMP_DIRECTORY directory = {};
+  directory.StreamType = kMinidumpStreamTypeCrashpadDeduplicatedMemoryList;
+  directory.Location.Rva = static_cast<RVA>(string_file->SeekGet());
+  EXPECT_TRUE(string_file->Write(&memory_list, sizeof(memory_list)));
+  for (const MinidumpDeduplicatedMemoryRange& range : ranges) {
+    EXPECT_TRUE(string_file->Write(&range, sizeof(range)));
+  }
+  directory.Location.DataSize = static_cast<uint32_t>(
+      sizeof(memory_list) + ranges.size() * sizeof(ranges[0]));
+
+  header.StreamDirectoryRva = static_cast<RVA>(string_file->SeekGet());
+  EXPECT_TRUE(string_file->Write(&directory, sizeof(directory)));
+
+  header.Signature = MINIDUMP_SIGNATURE;
+  header.Version = MINIDUMP_VERSION;
+  header.NumberOfStreams = 1;
+  EXPECT_TRUE(string_file->SeekSet(0));
+  EXPECT_TRUE(string_file->Write(&header, sizeof(header)));
+}
+
+MinidumpDeduplicatedMemoryRange DeduplicatedMemoryRange(
+    uint64_t address,
+    uint64_t size,
+    uint32_t first_page_reference,
+    uint32_t page_reference_count) {
+  MinidumpDeduplicatedMemoryRange range = {};
+  range.start_of_memory_range = address;
+  range.data_size = size;
+  range.first_page_reference = first_page_reference;
+  range.page_reference_count = page_reference_count;
+  return range;
+}
+
+class ReadToStringDelegate final : public MemorySnapshot::Delegate {
+ public:
+  explicit ReadToStringDelegate(std::string* contents) : contents_(contents) {}
+  ~ReadToStringDelegate() override {}
+
+  // MemorySnapshot::Delegate:
+  bool MemorySnapshotDelegateRead(void* data, size_t size) override {
+    contents_->assign(static_cast<const char*>(data), size);
+    return true;
+  }
+
+ private:
+  std::string* contents_;
+
+  DISALLOW_COPY_AND_ASSIGN(ReadToStringDelegate);
+};
+
+TEST(ProcessSnapshotMinidump, DeduplicatedMemory) {
+  StringFile string_file;
+  WriteDeduplicatedMemoryMinidump(
+      &string_file,
+      "0123456789abcdefABCDEFGHIJKLMNOP",
+      {0, 1, 0, 1, 1},
+      {DeduplicatedMemoryRange(0x1000, 32, 0, 2),
+       DeduplicatedMemoryRange(0x2008, 16, 2, 2),
+       DeduplicatedMemoryRange(0x3004, 4, 4, 1)});
+
+  ProcessSnapshotMinidump process_snapshot;
+  ASSERT_TRUE(process_snapshot.Initialize(&string_file));
+
+  std::vector<const MemorySnapshot*> memory =
+      process_snapshot.DeduplicatedMemory();
+  ASSERT_EQ(memory.size(), 3u);
+
+  std::string contents;
+  ReadToStringDelegate delegate(&contents);
+
+  EXPECT_EQ(memory[0]->Address(), 0x1000u);
+  EXPECT_EQ(memory[0]->Size(), 32u);
+  ASSERT_TRUE(memory[0]->Read(&delegate));
+  EXPECT_EQ(contents, "0123456789abcdefABCDEFGHIJKLMNOP");
+
+  // A range that starts and ends partway through pages.
+  EXPECT_EQ(memory[1]->Address(), 0x2008u);
+  EXPECT_EQ(memory[1]->Size(), 16u);
+  ASSERT_TRUE(memory[1]->Read(&delegate));
+  EXPECT_EQ(contents, "89abcdefABCDEFGH");
+
+  EXPECT_EQ(memory[2]->Address(), 0x3004u);
+  EXPECT_EQ(memory[2]->Size(), 4u);
+  ASSERT_TRUE(memory[2]->Read(&delegate));
+  EXPECT_EQ(contents, "EFGH");
+}
+
+TEST(ProcessSnapshotMinidump, DeduplicatedMemoryBadPageReference) {
+  StringFile string_file;
+  WriteDeduplicatedMemoryMinidump(&string_file,
+                                  "0123456789abcdef",
+                                  {1},
+                                  {DeduplicatedMemoryRange(0x1000, 16, 0, 1)});
+
+  // A damaged stream leaves no deduplicated memory, but the rest of the file
+  // can still be used.
+  ProcessSnapshotMinidump process_snapshot;
+  ASSERT_TRUE(process_snapshot.Initialize(&string_file));
+  EXPECT_TRUE(process_snapshot.DeduplicatedMemory().empty());
+}
+
+TEST(ProcessSnapshotMinidump, DeduplicatedMemoryBadPageReferenceCount) {
+  StringFile string_file;
+  WriteDeduplicatedMemoryMinidump(&string_file,
+                                  "0123456789abcdef",
+                                  {0},
+                                  {DeduplicatedMemoryRange(0x1008, 16, 0, 1)});
+
+  ProcessSnapshotMinidump process_snapshot;
+  ASSERT_TRUE(process_snapshot.Initialize(&string_file));
+  EXPECT_TRUE(process_snapshot.DeduplicatedMemory().empty());
+}
+
+// Writes a minidump file with a MINIDUMP_MEMORY_LIST stream containing
+// |memory_list| and a MINIDUMP_MEMORY64_LIST stream containing |memory64_list|.
+// Each range is given as its address and its contents.
+void WriteMemoryMinidump(
+    StringFile* string_file,
+    const std::vector<std::pair<uint64_t, std::string>>& memory_list,
+    const std::vector<std::pair<uint64_t, std::string>>& memory64_list) {
+  MINIDUMP_HEADER header = {};
+  EXPECT_TRUE(string_file->Write(&header, sizeof(header)));
+
+  std::vector<MINIDUMP_MEMORY_DESCRIPTOR> descriptors;
+  for (const auto& range : memory_list) {
+    MINIDUMP_MEMORY_DESCRIPTOR descriptor = {};
+    descriptor.StartOfMemoryRange = range.first;
+    descriptor.Memory.DataSize = static_cast<uint32_t>(range.second.size());
+    descriptor.Memory.Rva = static_cast<RVA>(string_file->SeekGet());
+    EXPECT_TRUE(string_file->Write(range.second.data(), range.second.size()));
+    descriptors.push_back(descriptor);
+  }
+
+  MINIDUMP_MEMORY64_LIST memory64_list_header = {};
+  memory64_list_header.NumberOfMemoryRanges = memory64_list.size();
+  memory64_list_header.BaseRva = string_file->SeekGet();
+  std::vector<MINIDUMP_MEMORY_DESCRIPTOR64> descriptors64;
+  for (const auto& range : memory64_list) {
+    MINIDUMP_MEMORY_DESCRIPTOR64 descriptor = {};
+    descriptor.StartOfMemoryRange = range.first;
+    descriptor.DataSize = range.second.size();
+    EXPECT_TRUE(string_file->Write(range.second.data(), range.second.size()));
+    descriptors64.push_back(descriptor);
+  }
+
+  MINIDUMP_DIRECTORY directories[2] = {};
+  directories[0].StreamType = kMinidumpStreamTypeMemoryList;
+  directories[0].Location.DataSize = static_cast<uint32_t>(
+      sizeof(MINIDUMP_MEMORY_LIST) +
+      descriptors.size() * sizeof(MINIDUMP_MEMORY_DESCRIPTOR));
+  directories[0].Location.Rva = static_cast<RVA>(string_file->SeekGet());
+  uint32_t range_count = static_cast<uint32_t>(descriptors.size());
+  EXPECT_TRUE(string_file->Write(&range_count, sizeof(range_count)));
+  for (const MINIDUMP_MEMORY_DESCRIPTOR& descriptor : descriptors) {
+    EXPECT_TRUE(string_file->Write(&descriptor, sizeof(descriptor)));
+  }
+
+  directories[1].StreamType = kMinidumpStreamTypeMemory64List;
+  directories[1].Location.DataSize = static_cast<uint32_t>(
+      sizeof(MINIDUMP_MEMORY64_LIST) +
+      descriptors64.size() * sizeof(MINIDUMP_MEMORY_DESCRIPTOR64));
+  directories[1].Location.Rva = static_cast<RVA>(string_file->SeekGet());
+  EXPECT_TRUE(string_file->Write(&memory64_list_header,
+                                 sizeof(memory64_list_header)));
+  for (const MINIDUMP_MEMORY_DESCRIPTOR64& descriptor : descriptors64) {
+    EXPECT_TRUE(string_file->Write(&descriptor, sizeof(descriptor)));
+  }
+
+  header.StreamDirectoryRva = static_cast<RVA>(string_file->SeekGet());
+  EXPECT_TRUE(string_file->Write(directories, sizeof(directories)));
+
+  header.Signature = MINIDUMP_SIGNATURE;
+  header.Version = MINIDUMP_VERSION;
+  header.NumberOfStreams = arraysize(directories);
+  EXPECT_TRUE(string_file->SeekSet(0));
+  EXPECT_TRUE(string_file->Write(&header, sizeof(header)));
+}
+
+std::string ReadMemoryToString(const ProcessSnapshotMinidump& process_snapshot,
+                               uint64_t address,
+                               size_t size) {
+  std::string contents(size, '\0');
+  if (!process_snapshot.ReadMemory(address, size, &contents[0])) {
+    return "(failed)";
+  }
+  return contents;
+}
+
+TEST(ProcessSnapshotMinidump, ReadMemory) {
+  StringFile string_file;
+  WriteMemoryMinidump(&string_file,
+                      {{0x3000, "stack"}, {0x1000, "0123456789"}},
+                      {{0x100a, "abcdef"}, {0x2000, "heap"}});
+
+  ProcessSnapshotMinidump process_snapshot;
+  ASSERT_TRUE(process_snapshot.Initialize(&string_file));
+
+  EXPECT_EQ(ReadMemoryToString(process_snapshot, 0x1000, 10), "0123456789");
+  EXPECT_EQ(ReadMemoryToString(process_snapshot, 0x1004, 4), "4567");
+  EXPECT_EQ(ReadMemoryToString(process_snapshot, 0x2000, 4), "heap");
+  EXPECT_EQ(ReadMemoryToString(process_snapshot, 0x3001, 4), "tack");
+
+  // Reads may span adjacent ranges, even from different streams.
+  EXPECT_EQ(ReadMemoryToString(process_snapshot, 0x1008, 5), "89abc");
+  EXPECT_EQ(ReadMemoryToString(process_snapshot, 0x1000, 16),
+            "0123456789abcdef");
+
+  // Memory that wasn’t captured can’t be read, even in part.
+  EXPECT_EQ(ReadMemoryToString(process_snapshot, 0x0fff, 2), "(failed)");
+  EXPECT_EQ(ReadMemoryToString(process_snapshot, 0x100e, 4), "(failed)");
+  EXPECT_EQ(ReadMemoryToString(process_snapshot, 0x1fff, 1), "(failed)");
+  EXPECT_EQ(ReadMemoryToString(process_snapshot, 0x2002, 4), "(failed)");
+  EXPECT_EQ(ReadMemoryToString(process_snapshot, 0x4000, 1), "(failed)");
+  EXPECT_EQ(ReadMemoryToString(process_snapshot, 0x3000, 0), "");
+}
+
+TEST(ProcessSnapshotMinidump, ReadMemoryOverlapping) {
+  StringFile string_file;
+  WriteMemoryMinidump(&string_file,
+                      {{0x1000, "01234567"}, {0x1004, "ABCDEFGH"}},
+                      {{0x1002, "xy"}});
+
+  ProcessSnapshotMinidump process_snapshot;
+  ASSERT_TRUE(process_snapshot.Initialize(&string_file));
+
+  // The range listed first supplies the contents of an overlap.
+  EXPECT_EQ(ReadMemoryToString(process_snapshot, 0x1000, 12), "01234567EFGH");
+}
+
+TEST(ProcessSnapshotMinidump, ReadMemoryBadStream) {
+  StringFile string_file;
+  WriteMemoryMinidump(&string_file, {{0x1000, "01234567"}}, {});
+
+  // Damage the size of the MINIDUMP_MEMORY_LIST stream, the first in the
+  // directory.
+  MINIDUMP_HEADER header;
+  ASSERT_TRUE(string_file.SeekSet(0));
+  ASSERT_TRUE(string_file.ReadExactly(&header, sizeof(header)));
+  MINIDUMP_DIRECTORY directory;
+  ASSERT_TRUE(string_file.SeekSet(header.StreamDirectoryRva));
+  ASSERT_TRUE(string_file.ReadExactly(&directory, sizeof(directory)));
+  ASSERT_EQ(directory.StreamType, kMinidumpStreamTypeMemoryList);
+  ++directory.Location.DataSize;
+  ASSERT_TRUE(string_file.SeekSet(header.StreamDirectoryRva));
+  ASSERT_TRUE(string_file.Write(&directory, sizeof(directory)));
+
+  // The memory can’t be read, but the rest of the file can still be used.
+  ProcessSnapshotMinidump process_snapshot;
+  ASSERT_TRUE(process_snapshot.Initialize(&string_file));
+  EXPECT_EQ(ReadMemoryToString(process_snapshot, 0x1000, 4), "(failed)");
+}
+
+TEST(ProcessSnapshotMinidump, ModuleForAddress) {
+  StringFile string_file;
+
+  MINIDUMP_HEADER header = {};
+  EXPECT_TRUE(string_file.Write(&header, sizeof(header)));
+
+  const struct {
+    uint64_t base;
+    uint32_t size;
+  } kModules[] = {
+      {0x7000, 0x1000},
+      {0x1000, 0x2000},
+      {0x4000, 0x1000},
+  };
+
+  MINIDUMP_DIRECTORY directory = {};
+  directory.StreamType = kMinidumpStreamTypeModuleList;
+  directory.Location.DataSize = sizeof(MINIDUMP_MODULE_LIST) +
+                                arraysize(kModules) * sizeof(MINIDUMP_MODULE);
+  directory.Location.Rva = static_cast<RVA>(string_file.SeekGet());
+
+  uint32_t module_count = arraysize(kModules);
+  EXPECT_TRUE(string_file.Write(&module_count, sizeof(module_count)));
+  for (const auto& module : kModules) {
+    MINIDUMP_MODULE minidump_module = {};
+    minidump_module.BaseOfImage = module.base;
+    minidump_module.SizeOfImage = module.size;
+    EXPECT_TRUE(string_file.Write(&minidump_module, sizeof(minidump_module)));
+  }
+
+  header.StreamDirectoryRva = static_cast<RVA>(string_file.SeekGet());
+  EXPECT_TRUE(string_file.Write(&directory, sizeof(directory)));
+
+  header.Signature = MINIDUMP_SIGNATURE;
+  header.Version = MINIDUMP_VERSION;
+  header.NumberOfStreams = 1;
+  EXPECT_TRUE(string_file.SeekSet(0));
+  EXPECT_TRUE(string_file.Write(&header, sizeof(header)));
+
+  ProcessSnapshotMinidump process_snapshot;
+  ASSERT_TRUE(process_snapshot.Initialize(&string_file));
+
+  std::vector<const ModuleSnapshot*> modules = process_snapshot.Modules();
+  ASSERT_EQ(modules.size(), arraysize(kModules));
+
+  EXPECT_EQ(process_snapshot.ModuleForAddress(0x0fff), nullptr);
+  EXPECT_EQ(process_snapshot.ModuleForAddress(0x1000), modules[1]);
+  EXPECT_EQ(process_snapshot.ModuleForAddress(0x2fff), modules[1]);
+  EXPECT_EQ(process_snapshot.ModuleForAddress(0x3000), nullptr);
+  EXPECT_EQ(process_snapshot.ModuleForAddress(0x4800), modules[2]);
+  EXPECT_EQ(process_snapshot.ModuleForAddress(0x5000), nullptr);
+  EXPECT_EQ(process_snapshot.ModuleForAddress(0x7abc), modules[0]);
+  EXPECT_EQ(process_snapshot.ModuleForAddress(0x8000), nullptr);
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace crashpad
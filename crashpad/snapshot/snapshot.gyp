@@ -37,6 +37,8 @@
         'cpu_context.h',
         'crashpad_info_client_options.cc',
         'crashpad_info_client_options.h',
+        'elf/elf_core_process_memory.cc',
+        'elf/elf_core_process_memory.h',
         'elf/elf_dynamic_array_reader.cc',
         'elf/elf_dynamic_array_reader.h',
         'elf/elf_image_reader.cc',
@@ -44,6 +46,7 @@
         'elf/elf_symbol_table_reader.cc',
         'elf/elf_symbol_table_reader.h',
         'exception_snapshot.h',
+        'file_backed_memory_resolver.h',
         'handle_snapshot.cc',
         'handle_snapshot.h',
         'linux/cpu_context_linux.cc',
@@ -52,6 +55,8 @@
         'linux/debug_rendezvous.h',
         'linux/exception_snapshot_linux.cc',
         'linux/exception_snapshot_linux.h',
+        'linux/file_backed_memory_resolver_linux.cc',
+        'linux/file_backed_memory_resolver_linux.h',
         'linux/memory_snapshot_linux.cc',
         'linux/memory_snapshot_linux.h',
         'linux/process_reader.cc',
@@ -98,12 +103,22 @@
         'mac/thread_snapshot_mac.cc',
         'mac/thread_snapshot_mac.h',
         'memory_snapshot.h',
+        'minidump/deduplicated_memory_snapshot_minidump.cc',
+        'minidump/deduplicated_memory_snapshot_minidump.h',
+        'minidump/light_minidump.cc',
+        'minidump/light_minidump.h',
+        'minidump/minidump_memory_ranges.cc',
+        'minidump/minidump_memory_ranges.h',
+        'minidump/minidump_process_memory.cc',
+        'minidump/minidump_process_memory.h',
         'minidump/minidump_simple_string_dictionary_reader.cc',
         'minidump/minidump_simple_string_dictionary_reader.h',
         'minidump/minidump_string_list_reader.cc',
         'minidump/minidump_string_list_reader.h',
         'minidump/minidump_string_reader.cc',
         'minidump/minidump_string_reader.h',
+        'minidump/minidump_triage_summary_reader.cc',
+        'minidump/minidump_triage_summary_reader.h',
         'minidump/module_snapshot_minidump.cc',
         'minidump/module_snapshot_minidump.h',
         'minidump/process_snapshot_minidump.cc',
@@ -161,6 +176,10 @@
             'capture_memory.h',
           ],
         }, {  # else: OS!="linux" and OS!="android"
+          'sources!': [
+            'minidump/minidump_process_memory.cc',
+            'minidump/minidump_process_memory.h',
+          ],
           'sources/': [
             ['exclude', '^elf/'],
           ],
@@ -70,9 +70,11 @@
         'cpu_context_test.cc',
         'crashpad_info_client_options_test.cc',
         'api/module_annotations_win_test.cc',
+        'elf/elf_core_process_memory_test.cc',
         'elf/elf_image_reader_test.cc',
         'linux/debug_rendezvous_test.cc',
         'linux/exception_snapshot_linux_test.cc',
+        'linux/file_backed_memory_resolver_linux_test.cc',
         'linux/process_reader_test.cc',
         'linux/system_snapshot_linux_test.cc',
         'mac/cpu_context_mac_test.cc',
@@ -82,6 +84,9 @@
         'mac/process_reader_test.cc',
         'mac/process_types_test.cc',
         'mac/system_snapshot_mac_test.cc',
+        'minidump/light_minidump_test.cc',
+        'minidump/minidump_memory_ranges_test.cc',
+        'minidump/minidump_process_memory_test.cc',
         'minidump/process_snapshot_minidump_test.cc',
         'posix/timezone_test.cc',
         'win/cpu_context_win_test.cc',
@@ -132,6 +137,9 @@
             ],
           },
         }, {  # else: OS!="linux" and OS!="android"
+          'sources!': [
+            'minidump/minidump_process_memory_test.cc',
+          ],
           'sources/': [
             ['exclude', '^elf/'],
           ],
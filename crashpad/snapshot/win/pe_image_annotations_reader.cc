@@ -17,7 +17,10 @@
 #include <string.h>
 #include <sys/types.h>
 
+#include <memory>
+
 #include "base/strings/utf_string_conversions.h"
+#include "client/annotation_arena.h"
 #include "client/simple_string_dictionary.h"
 #include "snapshot/win/pe_image_reader.h"
 #include "snapshot/win/process_reader_win.h"
@@ -39,9 +42,13 @@ std::map<std::string, std::string> PEImageAnnotationsReader::SimpleMap() const {
   if (process_reader_->Is64Bit()) {
     ReadCrashpadSimpleAnnotations<process_types::internal::Traits64>(
         &simple_map_annotations);
+    ReadCrashpadAnnotationArena<process_types::internal::Traits64>(
+        &simple_map_annotations);
   } else {
     ReadCrashpadSimpleAnnotations<process_types::internal::Traits32>(
         &simple_map_annotations);
+    ReadCrashpadAnnotationArena<process_types::internal::Traits32>(
+        &simple_map_annotations);
   }
   return simple_map_annotations;
 }
@@ -80,4 +87,45 @@ void PEImageAnnotationsReader::ReadCrashpadSimpleAnnotations(
   }
 }
 
+template <class Traits>
+void PEImageAnnotationsReader::ReadCrashpadAnnotationArena(
+    std::map<std::string, std::string>* simple_map_annotations) const {
+  process_types::CrashpadInfo<Traits> crashpad_info;
+  if (!pe_image_reader_->GetCrashpadInfo(&crashpad_info))
+    return;
+
+  if (!crashpad_info.annotation_arena)
+    return;
+
+  // Read the header to learn how much of the arena is in use, then read all of
+  // that at once.
+  AnnotationArenaHeader header;
+  if (!process_reader_->ReadMemory(
+          crashpad_info.annotation_arena, sizeof(header), &header)) {
+    LOG(WARNING) << "could not read annotation arena from "
+                 << base::UTF16ToUTF8(name_);
+    return;
+  }
+
+  const size_t size = AnnotationArenaSizeInUse(header);
+  if (!size) {
+    LOG(WARNING) << "unexpected annotation arena header in "
+                 << base::UTF16ToUTF8(name_);
+    return;
+  }
+
+  std::unique_ptr<char[]> arena(new char[size]);
+  if (!process_reader_->ReadMemory(
+          crashpad_info.annotation_arena, size, arena.get())) {
+    LOG(WARNING) << "could not read annotation arena from "
+                 << base::UTF16ToUTF8(name_);
+    return;
+  }
+
+  if (!ReadAnnotationArena(arena.get(), size, simple_map_annotations)) {
+    LOG(WARNING) << "could not parse annotation arena in "
+                 << base::UTF16ToUTF8(name_);
+  }
+}
+
 }  // namespace crashpad
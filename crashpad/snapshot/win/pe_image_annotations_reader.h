@@ -34,8 +34,9 @@ class ProcessReaderWin;
 //!
 //! Currently, this class can decode information stored only in the CrashpadInfo
 //! structure. This format is used by Crashpad clients. The "simple annotations"
-//! are recovered from any module with a compatible data section, and are
-//! included in the annotations returned by SimpleMap().
+//! and the annotations in the AnnotationArena are recovered from any module
+//! with a compatible data section, and are included in the annotations returned
+//! by SimpleMap().
 class PEImageAnnotationsReader {
  public:
   //! \brief Constructs the object.
@@ -60,6 +61,11 @@ class PEImageAnnotationsReader {
   void ReadCrashpadSimpleAnnotations(
       std::map<std::string, std::string>* simple_map_annotations) const;
 
+  // Reads CrashpadInfo::annotation_arena_ on behalf of SimpleMap().
+  template <class Traits>
+  void ReadCrashpadAnnotationArena(
+      std::map<std::string, std::string>* simple_map_annotations) const;
+
   std::wstring name_;
   ProcessReaderWin* process_reader_;  // weak
   const PEImageReader* pe_image_reader_;  // weak
@@ -17,6 +17,7 @@
 #include <stddef.h>
 #include <string.h>
 
+#include <algorithm>
 #include <memory>
 
 #include "base/logging.h"
@@ -46,6 +47,52 @@ struct NtHeadersForTraits<process_types::internal::Traits64> {
 
 }  // namespace
 
+template <class Traits>
+bool ReadCrashpadInfoSection(
+    const ProcessSubrangeReader& section_reader,
+    process_types::CrashpadInfo<Traits>* crashpad_info) {
+  using CrashpadInfoTraits = process_types::CrashpadInfo<Traits>;
+
+  // annotation_arena was added in version 2. Anything smaller than version 1
+  // can’t be a CrashpadInfo structure.
+  constexpr size_t kVersion1Size =
+      offsetof(CrashpadInfoTraits, annotation_arena);
+  if (section_reader.Size() < kVersion1Size) {
+    LOG(WARNING) << "small crashpad info section size "
+                 << section_reader.Size() << ", " << section_reader.name();
+    return false;
+  }
+
+  memset(crashpad_info, 0, sizeof(*crashpad_info));
+  const WinVMSize read_size = std::min(
+      section_reader.Size(), static_cast<WinVMSize>(sizeof(*crashpad_info)));
+  if (!section_reader.ReadMemory(
+          section_reader.Base(), read_size, crashpad_info)) {
+    LOG(WARNING) << "could not read crashpad info from "
+                 << section_reader.name();
+    return false;
+  }
+
+  if (crashpad_info->signature != CrashpadInfo::kSignature ||
+      crashpad_info->version < 1) {
+    LOG(WARNING) << "unexpected crashpad info data in "
+                 << section_reader.name();
+    return false;
+  }
+
+  if (crashpad_info->version < 2) {
+    // Whatever follows a version 1 structure in the section is not a field.
+    crashpad_info->annotation_arena = 0;
+  } else if (section_reader.Size() < sizeof(*crashpad_info)) {
+    LOG(WARNING) << "small crashpad info section size "
+                 << section_reader.Size() << " for version "
+                 << crashpad_info->version << ", " << section_reader.name();
+    return false;
+  }
+
+  return true;
+}
+
 PEImageReader::PEImageReader()
     : module_subrange_reader_(),
       initialized_() {
@@ -80,13 +127,6 @@ bool PEImageReader::GetCrashpadInfo(
     return false;
   }
 
-  if (section.Misc.VirtualSize < sizeof(process_types::CrashpadInfo<Traits>)) {
-    LOG(WARNING) << "small crashpad info section size "
-                 << section.Misc.VirtualSize << ", "
-                 << module_subrange_reader_.name();
-    return false;
-  }
-
   ProcessSubrangeReader crashpad_info_subrange_reader;
   const WinVMAddress crashpad_info_address = Address() + section.VirtualAddress;
   if (!crashpad_info_subrange_reader.InitializeSubrange(
@@ -97,23 +137,7 @@ bool PEImageReader::GetCrashpadInfo(
     return false;
   }
 
-  if (!crashpad_info_subrange_reader.ReadMemory(
-          crashpad_info_address,
-          sizeof(process_types::CrashpadInfo<Traits>),
-          crashpad_info)) {
-    LOG(WARNING) << "could not read crashpad info from "
-                 << module_subrange_reader_.name();
-    return false;
-  }
-
-  if (crashpad_info->signature != CrashpadInfo::kSignature ||
-      crashpad_info->version < 1) {
-    LOG(WARNING) << "unexpected crashpad info data in "
-                 << module_subrange_reader_.name();
-    return false;
-  }
-
-  return true;
+  return ReadCrashpadInfoSection(crashpad_info_subrange_reader, crashpad_info);
 }
 
 bool PEImageReader::DebugDirectoryInformation(UUID* uuid,
@@ -378,6 +402,14 @@ bool PEImageReader::ImageDataDirectoryEntryT(
 
 // Explicit instantiations with the only 2 valid template arguments to avoid
 // putting the body of the function in the header.
+template bool ReadCrashpadInfoSection<process_types::internal::Traits32>(
+    const ProcessSubrangeReader& section_reader,
+    process_types::CrashpadInfo<process_types::internal::Traits32>*
+        crashpad_info);
+template bool ReadCrashpadInfoSection<process_types::internal::Traits64>(
+    const ProcessSubrangeReader& section_reader,
+    process_types::CrashpadInfo<process_types::internal::Traits64>*
+        crashpad_info);
 template bool PEImageReader::GetCrashpadInfo<process_types::internal::Traits32>(
     process_types::CrashpadInfo<process_types::internal::Traits32>*
         crashpad_info) const;
@@ -48,10 +48,29 @@ struct CrashpadInfo {
   typename Traits::Pointer extra_address_ranges;
   typename Traits::Pointer simple_annotations;
   typename Traits::Pointer user_data_minidump_stream_head;
+
+  // Fields present in version 2:
+  typename Traits::Pointer annotation_arena;
 };
 
 }  // namespace process_types
 
+//! \brief Reads a CrashpadInfo structure from a module’s `CPADinfo` section.
+//!
+//! Modules built with an older client carry a smaller structure that ends
+//! before the fields added in later versions. Any section large enough to hold
+//! the oldest version is accepted. Fields that the structure’s version does not
+//! have are set to zero.
+//!
+//! \param[in] section_reader A reader restricted to the `CPADinfo` section.
+//! \param[out] crashpad_info The structure read from the section.
+//!
+//! \return `true` on success, `false` on failure with a message logged.
+template <class Traits>
+bool ReadCrashpadInfoSection(
+    const ProcessSubrangeReader& section_reader,
+    process_types::CrashpadInfo<Traits>* crashpad_info);
+
 //! \brief A reader for PE images mapped into another process.
 //!
 //! This class is capable of reading both 32-bit and 64-bit images based on the
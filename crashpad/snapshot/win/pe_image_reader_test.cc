@@ -16,11 +16,16 @@
 
 #define PSAPI_VERSION 1
 #include <psapi.h>
+#include <stddef.h>
+#include <string.h>
 
 #include "base/files/file_path.h"
 #include "base/strings/utf_string_conversions.h"
+#include "build/build_config.h"
+#include "client/crashpad_info.h"
 #include "gtest/gtest.h"
 #include "snapshot/win/process_reader_win.h"
+#include "snapshot/win/process_subrange_reader.h"
 #include "test/errors.h"
 #include "util/misc/from_pointer_cast.h"
 #include "util/win/get_module_information.h"
@@ -160,6 +165,64 @@ TEST(PEImageReader, VSFixedFileInfo_AllModules) {
   }
 }
 
+TEST(PEImageReader, CrashpadInfoVersions) {
+  ProcessReaderWin process_reader;
+  ASSERT_TRUE(process_reader.Initialize(GetCurrentProcess(),
+                                        ProcessSuspensionState::kRunning));
+
+#if defined(ARCH_CPU_64_BITS)
+  using Traits = process_types::internal::Traits64;
+#else
+  using Traits = process_types::internal::Traits32;
+#endif
+  using CrashpadInfoTraits = process_types::CrashpadInfo<Traits>;
+
+  // A module built with a version 1 client has a section that ends before
+  // annotation_arena. Whatever follows it must not be taken as a pointer.
+  CrashpadInfoTraits section;
+  memset(&section, 0, sizeof(section));
+  section.signature = CrashpadInfo::kSignature;
+  section.size = offsetof(CrashpadInfoTraits, annotation_arena);
+  section.version = 1;
+  section.simple_annotations = 0x1000;
+  section.annotation_arena = 0x2000;
+
+  const WinVMAddress section_address = FromPointerCast<WinVMAddress>(&section);
+  ProcessSubrangeReader version_1_reader;
+  ASSERT_TRUE(version_1_reader.Initialize(
+      &process_reader, section_address, section.size, "version 1"));
+  CrashpadInfoTraits crashpad_info;
+  ASSERT_TRUE(ReadCrashpadInfoSection(version_1_reader, &crashpad_info));
+  EXPECT_EQ(crashpad_info.version, 1u);
+  EXPECT_EQ(crashpad_info.simple_annotations, 0x1000u);
+  EXPECT_EQ(crashpad_info.annotation_arena, 0u);
+
+  // A version 1 structure in a section with room to spare is still read as
+  // version 1.
+  ProcessSubrangeReader padded_reader;
+  ASSERT_TRUE(padded_reader.Initialize(
+      &process_reader, section_address, sizeof(section), "padded version 1"));
+  ASSERT_TRUE(ReadCrashpadInfoSection(padded_reader, &crashpad_info));
+  EXPECT_EQ(crashpad_info.annotation_arena, 0u);
+
+  // A version 2 structure needs the whole section.
+  section.size = sizeof(section);
+  section.version = 2;
+  EXPECT_FALSE(ReadCrashpadInfoSection(version_1_reader, &crashpad_info));
+  ASSERT_TRUE(ReadCrashpadInfoSection(padded_reader, &crashpad_info));
+  EXPECT_EQ(crashpad_info.version, 2u);
+  EXPECT_EQ(crashpad_info.annotation_arena, 0x2000u);
+
+  // Anything smaller than version 1 is rejected.
+  ProcessSubrangeReader small_reader;
+  ASSERT_TRUE(small_reader.Initialize(
+      &process_reader,
+      section_address,
+      offsetof(CrashpadInfoTraits, annotation_arena) - 1,
+      "small"));
+  EXPECT_FALSE(ReadCrashpadInfoSection(small_reader, &crashpad_info));
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace crashpad
@@ -14,8 +14,12 @@
 
 #include "test/linux/fake_ptrace_connection.h"
 
+#include <utility>
+
 #include "build/build_config.h"
 #include "gtest/gtest.h"
+#include "util/file/file_io.h"
+#include "util/linux/proc_task_reader.h"
 
 namespace crashpad {
 namespace test {
@@ -23,6 +27,7 @@ namespace test {
 FakePtraceConnection::FakePtraceConnection()
     : PtraceConnection(),
       attachments_(),
+      memory_(),
       pid_(-1),
       is_64_bit_(false),
       initialized_() {}
@@ -70,5 +75,54 @@ bool FakePtraceConnection::GetThreadInfo(pid_t tid, ThreadInfo* info) {
   return attached;
 }
 
+void FakePtraceConnection::AttachAndGetThreadInfos(
+    const std::vector<pid_t>& tids,
+    std::vector<ThreadInfo>* infos,
+    std::vector<bool>* succeeded) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  infos->resize(tids.size());
+  succeeded->resize(tids.size());
+  for (size_t index = 0; index < tids.size(); ++index) {
+    (*succeeded)[index] =
+        Attach(tids[index]) && GetThreadInfo(tids[index], &(*infos)[index]);
+  }
+}
+
+bool FakePtraceConnection::Threads(std::vector<pid_t>* threads) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  return ReadThreadIDs(pid_, threads);
+}
+
+bool FakePtraceConnection::ReadFileContents(const base::FilePath& path,
+                                            std::string* contents) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  return LoggingReadEntireFile(path, contents);
+}
+
+bool FakePtraceConnection::ReadFilesContents(
+    const std::vector<base::FilePath>& paths,
+    std::vector<std::string>* contents) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  contents->resize(paths.size());
+  for (size_t index = 0; index < paths.size(); ++index) {
+    if (!ReadFileContents(paths[index], &(*contents)[index])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+ProcessMemory* FakePtraceConnection::Memory() {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  if (!memory_) {
+    std::unique_ptr<ProcessMemory> memory(new ProcessMemory());
+    if (!memory->Initialize(pid_)) {
+      return nullptr;
+    }
+    memory_ = std::move(memory);
+  }
+  return memory_.get();
+}
+
 }  // namespace test
 }  // namespace crashpad
@@ -17,7 +17,10 @@
 
 #include <sys/types.h>
 
+#include <memory>
 #include <set>
+#include <string>
+#include <vector>
 
 #include "base/macros.h"
 #include "util/linux/ptrace_connection.h"
@@ -53,8 +56,26 @@ class FakePtraceConnection : public PtraceConnection {
   //! \brief Does not modify \a info.
   bool GetThreadInfo(pid_t tid, ThreadInfo* info) override;
 
+  //! \brief Does not modify the elements of \a infos.
+  void AttachAndGetThreadInfos(const std::vector<pid_t>& tids,
+                               std::vector<ThreadInfo>* infos,
+                               std::vector<bool>* succeeded) override;
+
+  bool Threads(std::vector<pid_t>* threads) override;
+  bool ReadFileContents(const base::FilePath& path,
+                        std::string* contents) override;
+  bool ReadFilesContents(const std::vector<base::FilePath>& paths,
+                         std::vector<std::string>* contents) override;
+
+  //! \brief Opens the process’ memory the first time it is called.
+  //!
+  //! \return `nullptr` if the memory couldn’t be opened, with a message
+  //!     logged.
+  ProcessMemory* Memory() override;
+
  private:
   std::set<pid_t> attachments_;
+  std::unique_ptr<ProcessMemory> memory_;
   pid_t pid_;
   bool is_64_bit_;
   InitializationStateDcheck initialized_;
@@ -14,6 +14,7 @@
 
 #include <errno.h>
 #include <getopt.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -246,23 +247,49 @@ void ShowReport(const CrashReportDatabase::Report& report,
   printf("%sUpload attempts: %d\n", spaces.c_str(), report.upload_attempts);
 }
 
-// Shows information about a vector of |reports|. |space_count| is the number of
-// spaces to print before each line that is printed. |options| will be consulted
-// to determine whether to show expanded information
+// Shows information about each report that it visits. |space_count| is the
+// number of spaces to print before each line that is printed. |options| will be
+// consulted to determine whether to show expanded information
 // (options.show_all_report_info) and what time zone to use when showing
 // expanded information (options.utc).
-void ShowReports(const std::vector<CrashReportDatabase::Report>& reports,
-                 size_t space_count,
-                 const Options& options) {
-  std::string spaces(space_count, ' ');
-  const char* colon = options.show_all_report_info ? ":" : "";
+class ReportPrinter final : public CrashReportDatabase::ReportVisitor {
+ public:
+  ReportPrinter(size_t space_count, const Options& options)
+      : options_(options), space_count_(space_count) {}
+
+  ~ReportPrinter() {}
 
-  for (const CrashReportDatabase::Report& report : reports) {
+  // CrashReportDatabase::ReportVisitor:
+  void VisitReport(const CrashReportDatabase::Report& report) override {
+    std::string spaces(space_count_, ' ');
+    const char* colon = options_.show_all_report_info ? ":" : "";
     printf("%s%s%s\n", spaces.c_str(), report.uuid.ToString().c_str(), colon);
-    if (options.show_all_report_info) {
-      ShowReport(report, space_count + 2, options.utc);
+    if (options_.show_all_report_info) {
+      ShowReport(report, space_count_ + 2, options_.utc);
     }
   }
+
+ private:
+  const Options& options_;
+  size_t space_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(ReportPrinter);
+};
+
+// Shows all reports in |database| in the given states (a bitfield of
+// CrashReportDatabase::ReportQuery::State values), in no particular order.
+// Reports are shown as they are found, in a single pass over the database.
+// Returns false on failure.
+bool ShowReportsInStates(CrashReportDatabase* database,
+                         uint8_t states,
+                         size_t space_count,
+                         const Options& options) {
+  CrashReportDatabase::ReportQuery query;
+  query.states = states;
+
+  ReportPrinter printer(space_count, options);
+  return database->ForEachReport(query, &printer) ==
+         CrashReportDatabase::kNoError;
 }
 
 int DatabaseUtilMain(int argc, char* argv[]) {
@@ -499,31 +526,29 @@ int DatabaseUtilMain(int argc, char* argv[]) {
   }
 
   if (options.show_pending_reports) {
-    std::vector<CrashReportDatabase::Report> pending_reports;
-    if (database->GetPendingReports(&pending_reports) !=
-        CrashReportDatabase::kNoError) {
-      return EXIT_FAILURE;
-    }
-
     if (show_operations > 1) {
       printf("Pending reports:\n");
     }
 
-    ShowReports(pending_reports, show_operations > 1 ? 2 : 0, options);
-  }
-
-  if (options.show_completed_reports) {
-    std::vector<CrashReportDatabase::Report> completed_reports;
-    if (database->GetCompletedReports(&completed_reports) !=
-        CrashReportDatabase::kNoError) {
+    if (!ShowReportsInStates(database.get(),
+                             CrashReportDatabase::ReportQuery::kStatePending,
+                             show_operations > 1 ? 2 : 0,
+                             options)) {
       return EXIT_FAILURE;
     }
+  }
 
+  if (options.show_completed_reports) {
     if (show_operations > 1) {
       printf("Completed reports:\n");
     }
 
-    ShowReports(completed_reports, show_operations > 1 ? 2 : 0, options);
+    if (!ShowReportsInStates(database.get(),
+                             CrashReportDatabase::ReportQuery::kStateCompleted,
+                             show_operations > 1 ? 2 : 0,
+                             options)) {
+      return EXIT_FAILURE;
+    }
   }
 
   for (const UUID& uuid : options.show_reports) {
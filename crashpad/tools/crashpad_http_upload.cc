@@ -13,20 +13,38 @@
 // limitations under the License.
 
 #include <getopt.h>
+#include <inttypes.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/types.h>
 
+#include <algorithm>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "base/files/file_path.h"
+#include "base/macros.h"
+#include "base/strings/stringprintf.h"
+#include "base/synchronization/lock.h"
+#include "build/build_config.h"
 #include "tools/tool_support.h"
 #include "util/file/file_writer.h"
+#include "util/misc/clock.h"
 #include "util/net/http_body.h"
 #include "util/net/http_multipart_builder.h"
 #include "util/net/http_transport.h"
+#include "util/stdlib/string_number_conversion.h"
 #include "util/string/split_string.h"
+#include "util/thread/thread.h"
+
+#if defined(OS_POSIX)
+#include <sys/resource.h>
+#elif defined(OS_WIN)
+#include <windows.h>
+#endif  // OS_POSIX
 
 namespace crashpad {
 namespace {
@@ -35,10 +53,17 @@ void Usage(const base::FilePath& me) {
   fprintf(stderr,
 "Usage: %" PRFilePath " [OPTION]...\n"
 "Send an HTTP POST request.\n"
+"      --benchmark=COUNT   send COUNT requests and report throughput instead\n"
+"                          of the response body\n"
+"      --concurrency=N     with --benchmark, send N requests at a time\n"
 "  -f, --file=KEY=PATH     upload the file at PATH for the HTTP KEY parameter\n"
+"      --gzip-level=LEVEL  compress uploads at zlib LEVEL, from 0 to 9\n"
 "      --no-upload-gzip    don't use gzip compression when uploading\n"
 "  -o, --output=FILE       write the response body to FILE instead of stdout\n"
 "  -s, --string=KEY=VALUE  set the HTTP KEY parameter to VALUE\n"
+"      --synthetic=KEY=SIZE\n"
+"                          set the HTTP KEY parameter to SIZE bytes of\n"
+"                          generated data resembling minidump memory\n"
 "  -u, --url=URL           send the request to URL\n"
 "      --help              display this help and exit\n"
 "      --version           output version information and exit\n",
@@ -46,6 +71,286 @@ void Usage(const base::FilePath& me) {
   ToolSupport::UsageTail(me);
 }
 
+// Generates |size| bytes resembling the memory captured in a minidump: runs of
+// zeros, small integers, pointers into a few regions, and incompressible data.
+// The output is the same on every run, so that results are comparable.
+std::string SyntheticMinidumpData(size_t size) {
+  std::string data;
+  data.reserve(size + 4096);
+
+  uint64_t state = UINT64_C(0x9e3779b97f4a7c15);
+  auto next = [&state]() {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+  };
+
+  while (data.size() < size) {
+    const uint64_t choice = next();
+    const size_t words = 8 + choice % 512;
+    for (size_t word = 0; word < words; ++word) {
+      uint64_t value;
+      switch ((choice >> 32) % 4) {
+        case 0:
+          value = 0;
+          break;
+        case 1:
+          value = next() % 256;
+          break;
+        case 2:
+          value = UINT64_C(0x00007f0000000000) +
+                  ((choice >> 40) % 4) * UINT64_C(0x100000000) +
+                  (next() % 0x100000) * 8;
+          break;
+        default:
+          value = next();
+          break;
+      }
+      data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+  }
+
+  data.resize(size);
+  return data;
+}
+
+// Counts the bytes that a transport reads from a body stream, which are the
+// bytes that are sent, after any compression.
+class CountingHTTPBodyStream : public HTTPBodyStream {
+ public:
+  CountingHTTPBodyStream(std::unique_ptr<HTTPBodyStream> source,
+                         uint64_t* count)
+      : HTTPBodyStream(), source_(std::move(source)), count_(count) {}
+
+  ~CountingHTTPBodyStream() override {}
+
+  FileOperationResult GetBytesBuffer(uint8_t* buffer,
+                                     size_t max_len) override {
+    FileOperationResult rv = source_->GetBytesBuffer(buffer, max_len);
+    if (rv > 0) {
+      *count_ += rv;
+    }
+    return rv;
+  }
+
+ private:
+  std::unique_ptr<HTTPBodyStream> source_;
+  uint64_t* count_;  // weak
+
+  DISALLOW_COPY_AND_ASSIGN(CountingHTTPBodyStream);
+};
+
+// Returns the user and system CPU time consumed by this process, in seconds.
+double ProcessCPUSeconds() {
+#if defined(OS_POSIX)
+  rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+  return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+         (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1E6;
+#elif defined(OS_WIN)
+  FILETIME creation_time, exit_time, kernel_time, user_time;
+  if (!GetProcessTimes(GetCurrentProcess(),
+                       &creation_time,
+                       &exit_time,
+                       &kernel_time,
+                       &user_time)) {
+    return 0;
+  }
+  auto to_seconds = [](const FILETIME& time) {
+    return ((static_cast<uint64_t>(time.dwHighDateTime) << 32) |
+            time.dwLowDateTime) /
+           1E7;
+  };
+  return to_seconds(kernel_time) + to_seconds(user_time);
+#endif  // OS_POSIX
+}
+
+// Sends the same request repeatedly, from several threads, and measures each
+// request.
+class UploadBenchmark {
+ public:
+  struct Result {
+    uint64_t latency_ns;
+    uint64_t sent_bytes;
+    bool success;
+  };
+
+  UploadBenchmark(const std::string& url,
+                  HTTPMultipartBuilder* http_multipart_builder,
+                  size_t requests)
+      : url_(url),
+        http_multipart_builder_(http_multipart_builder),
+        content_headers_(),
+        results_(requests),
+        next_request_(0),
+        lock_() {
+    http_multipart_builder_->PopulateContentHeaders(&content_headers_);
+  }
+
+  const std::vector<Result>& results() const { return results_; }
+
+  // Sends requests until all have been sent. Called on each thread.
+  void Run() {
+    size_t index;
+    while (NextRequest(&index)) {
+      Result& result = results_[index];
+      result.sent_bytes = 0;
+
+      std::unique_ptr<HTTPTransport> http_transport(HTTPTransport::Create());
+      http_transport->SetURL(url_);
+      for (const auto& content_header : content_headers_) {
+        http_transport->SetHeader(content_header.first, content_header.second);
+      }
+
+      std::unique_ptr<HTTPBodyStream> body_stream;
+      {
+        base::AutoLock lock(lock_);
+        body_stream = http_multipart_builder_->GetBodyStream();
+      }
+      http_transport->SetBodyStream(std::unique_ptr<HTTPBodyStream>(
+          new CountingHTTPBodyStream(std::move(body_stream),
+                                     &result.sent_bytes)));
+
+      const uint64_t start = ClockMonotonicNanoseconds();
+      std::string response_body;
+      result.success = http_transport->ExecuteSynchronously(&response_body);
+      result.latency_ns = ClockMonotonicNanoseconds() - start;
+    }
+  }
+
+ private:
+  bool NextRequest(size_t* index) {
+    base::AutoLock lock(lock_);
+    if (next_request_ >= results_.size()) {
+      return false;
+    }
+    *index = next_request_++;
+    return true;
+  }
+
+  std::string url_;
+  HTTPMultipartBuilder* http_multipart_builder_;  // weak
+  HTTPHeaders content_headers_;
+  std::vector<Result> results_;
+  size_t next_request_;
+  base::Lock lock_;
+
+  DISALLOW_COPY_AND_ASSIGN(UploadBenchmark);
+};
+
+class UploadBenchmarkThread : public Thread {
+ public:
+  explicit UploadBenchmarkThread(UploadBenchmark* benchmark)
+      : Thread(), benchmark_(benchmark) {}
+  ~UploadBenchmarkThread() override {}
+
+ private:
+  void ThreadMain() override { benchmark_->Run(); }
+
+  UploadBenchmark* benchmark_;  // weak
+
+  DISALLOW_COPY_AND_ASSIGN(UploadBenchmarkThread);
+};
+
+// Returns the |fraction| percentile of |sorted|, which must not be empty.
+double Percentile(const std::vector<uint64_t>& sorted, double fraction) {
+  size_t index = static_cast<size_t>(fraction * sorted.size());
+  return sorted[std::min(index, sorted.size() - 1)];
+}
+
+// Measures the uncompressed size of the request body.
+uint64_t UncompressedBodySize(HTTPMultipartBuilder* http_multipart_builder,
+                              bool upload_gzip) {
+  http_multipart_builder->SetGzipEnabled(false);
+  std::unique_ptr<HTTPBodyStream> body_stream =
+      http_multipart_builder->GetBodyStream();
+  http_multipart_builder->SetGzipEnabled(upload_gzip);
+
+  uint64_t size = 0;
+  uint8_t buffer[32 * 1024];
+  FileOperationResult rv;
+  while ((rv = body_stream->GetBytesBuffer(buffer, sizeof(buffer))) > 0) {
+    size += rv;
+  }
+  return size;
+}
+
+int RunUploadBenchmark(const std::string& url,
+                       HTTPMultipartBuilder* http_multipart_builder,
+                       bool upload_gzip,
+                       size_t requests,
+                       size_t concurrency,
+                       FileWriterInterface* file_writer) {
+  const uint64_t uncompressed_size =
+      UncompressedBodySize(http_multipart_builder, upload_gzip);
+
+  UploadBenchmark benchmark(url, http_multipart_builder, requests);
+  std::vector<std::unique_ptr<UploadBenchmarkThread>> threads;
+  for (size_t index = 0; index < concurrency; ++index) {
+    threads.push_back(std::unique_ptr<UploadBenchmarkThread>(
+        new UploadBenchmarkThread(&benchmark)));
+  }
+
+  const double start_cpu_seconds = ProcessCPUSeconds();
+  const uint64_t start = ClockMonotonicNanoseconds();
+  for (const auto& thread : threads) {
+    thread->Start();
+  }
+  for (const auto& thread : threads) {
+    thread->Join();
+  }
+  const double elapsed_seconds = (ClockMonotonicNanoseconds() - start) / 1E9;
+  const double cpu_seconds = ProcessCPUSeconds() - start_cpu_seconds;
+
+  std::vector<uint64_t> latencies;
+  uint64_t sent_bytes = 0;
+  for (const UploadBenchmark::Result& result : benchmark.results()) {
+    if (result.success) {
+      latencies.push_back(result.latency_ns);
+      sent_bytes += result.sent_bytes;
+    }
+  }
+  std::sort(latencies.begin(), latencies.end());
+
+  const size_t succeeded = latencies.size();
+  const double uncompressed_mb =
+      static_cast<double>(uncompressed_size) * succeeded / (1024 * 1024);
+
+  std::string report = base::StringPrintf(
+      "requests: %zu succeeded, %zu failed, concurrency %zu\n"
+      "elapsed: %.3f s, %.1f requests/s\n",
+      succeeded,
+      requests - succeeded,
+      concurrency,
+      elapsed_seconds,
+      succeeded / elapsed_seconds);
+  if (succeeded) {
+    report += base::StringPrintf(
+        "latency: p50 %.2f ms, p99 %.2f ms\n"
+        "body: %" PRIu64 " bytes uncompressed, %.0f bytes sent, "
+        "compression ratio %.2f\n"
+        "cpu: %.3f s, %.2f ms per uncompressed MB\n",
+        Percentile(latencies, 0.5) / 1E6,
+        Percentile(latencies, 0.99) / 1E6,
+        uncompressed_size,
+        static_cast<double>(sent_bytes) / succeeded,
+        sent_bytes ? static_cast<double>(uncompressed_size) * succeeded /
+                         sent_bytes
+                   : 0,
+        cpu_seconds,
+        uncompressed_mb ? cpu_seconds * 1E3 / uncompressed_mb : 0);
+  }
+
+  if (!file_writer->Write(&report[0], report.size())) {
+    return EXIT_FAILURE;
+  }
+
+  return succeeded == requests ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
 int HTTPUploadMain(int argc, char* argv[]) {
   const base::FilePath argv0(
       ToolSupport::CommandLineArgumentToFilePathStringType(argv[0]));
@@ -60,7 +365,11 @@ int HTTPUploadMain(int argc, char* argv[]) {
 
     // Long options without short equivalents.
     kOptionLastChar = 255,
+    kOptionBenchmark,
+    kOptionConcurrency,
+    kOptionGzipLevel,
     kOptionNoUploadGzip,
+    kOptionSynthetic,
 
     // Standard options.
     kOptionHelp = -2,
@@ -70,15 +379,24 @@ int HTTPUploadMain(int argc, char* argv[]) {
   struct {
     std::string url;
     const char* output;
+    unsigned int benchmark_requests;
+    unsigned int concurrency;
+    int gzip_level;
     bool upload_gzip;
   } options = {};
+  options.concurrency = 1;
+  options.gzip_level = -1;
   options.upload_gzip = true;
 
   static constexpr option long_options[] = {
+      {"benchmark", required_argument, nullptr, kOptionBenchmark},
+      {"concurrency", required_argument, nullptr, kOptionConcurrency},
       {"file", required_argument, nullptr, kOptionFile},
+      {"gzip-level", required_argument, nullptr, kOptionGzipLevel},
       {"no-upload-gzip", no_argument, nullptr, kOptionNoUploadGzip},
       {"output", required_argument, nullptr, kOptionOutput},
       {"string", required_argument, nullptr, kOptionString},
+      {"synthetic", required_argument, nullptr, kOptionSynthetic},
       {"url", required_argument, nullptr, kOptionURL},
       {"help", no_argument, nullptr, kOptionHelp},
       {"version", no_argument, nullptr, kOptionVersion},
@@ -91,6 +409,22 @@ int HTTPUploadMain(int argc, char* argv[]) {
   while ((opt = getopt_long(argc, argv, "f:o:s:u:", long_options, nullptr)) !=
          -1) {
     switch (opt) {
+      case kOptionBenchmark: {
+        if (!StringToNumber(optarg, &options.benchmark_requests) ||
+            options.benchmark_requests == 0) {
+          ToolSupport::UsageHint(me, "--benchmark requires a positive COUNT");
+          return EXIT_FAILURE;
+        }
+        break;
+      }
+      case kOptionConcurrency: {
+        if (!StringToNumber(optarg, &options.concurrency) ||
+            options.concurrency == 0) {
+          ToolSupport::UsageHint(me, "--concurrency requires a positive N");
+          return EXIT_FAILURE;
+        }
+        break;
+      }
       case kOptionFile: {
         std::string key;
         std::string path;
@@ -106,6 +440,14 @@ int HTTPUploadMain(int argc, char* argv[]) {
             key, file_name, file_path, "application/octet-stream");
         break;
       }
+      case kOptionGzipLevel: {
+        if (!StringToNumber(optarg, &options.gzip_level) ||
+            options.gzip_level < 0 || options.gzip_level > 9) {
+          ToolSupport::UsageHint(me, "--gzip-level requires LEVEL from 0 to 9");
+          return EXIT_FAILURE;
+        }
+        break;
+      }
       case kOptionNoUploadGzip: {
         options.upload_gzip = false;
         break;
@@ -124,6 +466,18 @@ int HTTPUploadMain(int argc, char* argv[]) {
         http_multipart_builder.SetFormData(key, value);
         break;
       }
+      case kOptionSynthetic: {
+        std::string key;
+        std::string size_string;
+        unsigned int size;
+        if (!SplitStringFirst(optarg, '=', &key, &size_string) ||
+            !StringToNumber(size_string, &size)) {
+          ToolSupport::UsageHint(me, "--synthetic requires KEY=SIZE");
+          return EXIT_FAILURE;
+        }
+        http_multipart_builder.SetFormData(key, SyntheticMinidumpData(size));
+        break;
+      }
       case kOptionURL:
         options.url = optarg;
         break;
@@ -168,6 +522,18 @@ int HTTPUploadMain(int argc, char* argv[]) {
   }
 
   http_multipart_builder.SetGzipEnabled(options.upload_gzip);
+  if (options.gzip_level >= 0) {
+    http_multipart_builder.SetGzipCompressionLevel(options.gzip_level);
+  }
+
+  if (options.benchmark_requests) {
+    return RunUploadBenchmark(options.url,
+                              &http_multipart_builder,
+                              options.upload_gzip,
+                              options.benchmark_requests,
+                              options.concurrency,
+                              file_writer.get());
+  }
 
   std::unique_ptr<HTTPTransport> http_transport(HTTPTransport::Create());
   http_transport->SetURL(options.url);
@@ -53,7 +53,8 @@ void Usage(const base::FilePath& me) {
 "Generate a minidump file containing a snapshot of a running process.\n"
 "\n"
 "  -r, --no-suspend   don't suspend the target process during dump generation\n"
-"  -o, --output=FILE  write the minidump to FILE instead of minidump.PID\n"
+"  -o, --output=FILE  write the minidump to FILE instead of minidump.PID, or to\n"
+"                     standard output if FILE is -\n"
 "      --help         display this help and exit\n"
 "      --version      output version information and exit\n",
           me.value().c_str());
@@ -190,6 +191,19 @@ int GenerateDumpMain(int argc, char* argv[]) {
     }
 #endif  // OS_MACOSX
 
+    MinidumpFileWriter minidump;
+    minidump.InitializeFromSnapshot(&process_snapshot);
+
+    if (options.dump_path == "-") {
+      // Standard output may be a pipe, so write without seeking.
+      WeakFileHandleFileWriter stdout_writer(
+          StdioFileHandle(StdioStream::kStandardOutput));
+      if (!minidump.WriteMinidump(&stdout_writer, false)) {
+        return EXIT_FAILURE;
+      }
+      return EXIT_SUCCESS;
+    }
+
     FileWriter file_writer;
     base::FilePath dump_path(
         ToolSupport::CommandLineArgumentToFilePathStringType(
@@ -200,8 +214,6 @@ int GenerateDumpMain(int argc, char* argv[]) {
       return EXIT_FAILURE;
     }
 
-    MinidumpFileWriter minidump;
-    minidump.InitializeFromSnapshot(&process_snapshot);
     if (!minidump.WriteEverything(&file_writer)) {
       file_writer.Close();
       if (unlink(options.dump_path.c_str()) != 0) {
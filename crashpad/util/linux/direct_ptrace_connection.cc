@@ -16,13 +16,19 @@
 
 #include <memory>
 
+#include "util/file/file_io.h"
+#include "util/linux/proc_task_reader.h"
+
 namespace crashpad {
 
 DirectPtraceConnection::DirectPtraceConnection()
     : PtraceConnection(),
+      freeze_(),
       attachments_(),
+      memory_(),
       pid_(-1),
       ptracer_(),
+      frozen_(false),
       initialized_() {}
 
 DirectPtraceConnection::~DirectPtraceConnection() {}
@@ -30,15 +36,52 @@ DirectPtraceConnection::~DirectPtraceConnection() {}
 bool DirectPtraceConnection::Initialize(pid_t pid) {
   INITIALIZATION_STATE_SET_INITIALIZING(initialized_);
 
-  if (!Attach(pid) || !ptracer_.Initialize(pid)) {
+  if (!InitializeInternal(pid)) {
     return false;
   }
-  pid_ = pid;
 
   INITIALIZATION_STATE_SET_VALID(initialized_);
   return true;
 }
 
+bool DirectPtraceConnection::InitializeFrozen(
+    pid_t pid,
+    ScopedProcessFreeze::Method method,
+    double timeout_seconds) {
+  INITIALIZATION_STATE_SET_INITIALIZING(initialized_);
+
+  if (!freeze_.ResetFreeze(pid, method, timeout_seconds)) {
+    return false;
+  }
+  frozen_ = true;
+  if (!InitializeInternal(pid)) {
+    return false;
+  }
+
+  INITIALIZATION_STATE_SET_VALID(initialized_);
+  return true;
+}
+
+bool DirectPtraceConnection::InitializeAlreadyFrozen(pid_t pid) {
+  INITIALIZATION_STATE_SET_INITIALIZING(initialized_);
+
+  frozen_ = true;
+  if (!InitializeInternal(pid)) {
+    return false;
+  }
+
+  INITIALIZATION_STATE_SET_VALID(initialized_);
+  return true;
+}
+
+bool DirectPtraceConnection::InitializeInternal(pid_t pid) {
+  if (!Attach(pid) || !ptracer_.Initialize(pid) || !memory_.Initialize(pid)) {
+    return false;
+  }
+  pid_ = pid;
+  return true;
+}
+
 pid_t DirectPtraceConnection::GetProcessID() {
   INITIALIZATION_STATE_DCHECK_VALID(initialized_);
   return pid_;
@@ -46,7 +89,9 @@ pid_t DirectPtraceConnection::GetProcessID() {
 
 bool DirectPtraceConnection::Attach(pid_t tid) {
   std::unique_ptr<ScopedPtraceAttach> attach(new ScopedPtraceAttach);
-  if (!attach->ResetAttach(tid)) {
+  const bool attached =
+      frozen_ ? attach->ResetSeize(tid) : attach->ResetAttach(tid);
+  if (!attached) {
     return false;
   }
   attachments_.push_back(attach.release());
@@ -63,4 +108,46 @@ bool DirectPtraceConnection::GetThreadInfo(pid_t tid, ThreadInfo* info) {
   return ptracer_.GetThreadInfo(tid, info);
 }
 
+void DirectPtraceConnection::AttachAndGetThreadInfos(
+    const std::vector<pid_t>& tids,
+    std::vector<ThreadInfo>* infos,
+    std::vector<bool>* succeeded) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  infos->resize(tids.size());
+  succeeded->resize(tids.size());
+  for (size_t index = 0; index < tids.size(); ++index) {
+    (*succeeded)[index] =
+        Attach(tids[index]) && GetThreadInfo(tids[index], &(*infos)[index]);
+  }
+}
+
+bool DirectPtraceConnection::Threads(std::vector<pid_t>* threads) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  return ReadThreadIDs(pid_, threads);
+}
+
+bool DirectPtraceConnection::ReadFileContents(const base::FilePath& path,
+                                              std::string* contents) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  return LoggingReadEntireFile(path, contents);
+}
+
+bool DirectPtraceConnection::ReadFilesContents(
+    const std::vector<base::FilePath>& paths,
+    std::vector<std::string>* contents) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  contents->resize(paths.size());
+  for (size_t index = 0; index < paths.size(); ++index) {
+    if (!ReadFileContents(paths[index], &(*contents)[index])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+ProcessMemory* DirectPtraceConnection::Memory() {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  return &memory_;
+}
+
 }  // namespace crashpad
@@ -17,9 +17,13 @@
 
 #include <sys/types.h>
 
+#include <string>
+#include <vector>
+
 #include "base/macros.h"
 #include "util/linux/ptrace_connection.h"
 #include "util/linux/ptracer.h"
+#include "util/linux/scoped_process_freeze.h"
 #include "util/linux/scoped_ptrace_attach.h"
 #include "util/misc/initialization_state_dcheck.h"
 #include "util/stdlib/pointer_container.h"
@@ -44,17 +48,65 @@ class DirectPtraceConnection : public PtraceConnection {
   //! \return `true` on success. `false` on failure with a message logged.
   bool Initialize(pid_t pid);
 
+  //! \brief Initializes this connection for the process whose process ID is
+  //!     \a pid, first freezing all of its threads at once.
+  //!
+  //! The process remains frozen until this object is destroyed, so the threads
+  //! found while it is frozen are all of its threads. The main thread and any
+  //! threads attached later are attached with ScopedPtraceAttach::ResetSeize().
+  //!
+  //! \param[in] pid The process ID of the process to connect to.
+  //! \param[in] method The method with which to freeze the process. See
+  //!     ScopedProcessFreeze::ResetFreeze().
+  //! \param[in] timeout_seconds The maximum time to wait for the threads to
+  //!     stop.
+  //! \return `true` on success. `false` on failure with a message logged.
+  bool InitializeFrozen(pid_t pid,
+                        ScopedProcessFreeze::Method method,
+                        double timeout_seconds);
+
+  //! \brief Initializes this connection for the process whose process ID is
+  //!     \a pid, which the caller has already frozen.
+  //!
+  //! This is used when several processes are frozen together by one
+  //! ScopedProcessFreeze. The process must remain frozen until this object is
+  //! destroyed. Threads are attached as by InitializeFrozen().
+  //!
+  //! \param[in] pid The process ID of the process to connect to.
+  //! \return `true` on success. `false` on failure with a message logged.
+  bool InitializeAlreadyFrozen(pid_t pid);
+
   // PtraceConnection:
 
   pid_t GetProcessID() override;
   bool Attach(pid_t tid) override;
   bool Is64Bit() override;
   bool GetThreadInfo(pid_t tid, ThreadInfo* info) override;
+  void AttachAndGetThreadInfos(const std::vector<pid_t>& tids,
+                               std::vector<ThreadInfo>* infos,
+                               std::vector<bool>* succeeded) override;
+  bool Threads(std::vector<pid_t>* threads) override;
+  bool ReadFileContents(const base::FilePath& path,
+                        std::string* contents) override;
+  bool ReadFilesContents(const std::vector<base::FilePath>& paths,
+                         std::vector<std::string>* contents) override;
+  ProcessMemory* Memory() override;
 
  private:
+  bool InitializeInternal(pid_t pid);
+
+  // Declared before attachments_ so that threads are detached before the
+  // process is resumed.
+  ScopedProcessFreeze freeze_;
+
   PointerVector<ScopedPtraceAttach> attachments_;
+  ProcessMemory memory_;
   pid_t pid_;
   Ptracer ptracer_;
+
+  // Whether the process is frozen, so that threads are attached with
+  // ScopedPtraceAttach::ResetSeize().
+  bool frozen_;
   InitializationStateDcheck initialized_;
 
   DISALLOW_COPY_AND_ASSIGN(DirectPtraceConnection);
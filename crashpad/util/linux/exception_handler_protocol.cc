@@ -0,0 +1,124 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/linux/exception_handler_protocol.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+
+#include "base/logging.h"
+#include "base/posix/eintr_wrapper.h"
+
+namespace crashpad {
+
+bool RequestCrashDump(int sock, const ClientInformation& info) {
+  ClientToServerMessage message;
+  memset(&message, 0, sizeof(message));
+  message.version = ClientToServerMessage::kVersion;
+  message.type = ClientToServerMessage::kCrashDumpRequest;
+  message.client_info = info;
+
+  // MSG_NOSIGNAL avoids SIGPIPE if the handler has gone away.
+  ssize_t rv =
+      HANDLE_EINTR(send(sock, &message, sizeof(message), MSG_NOSIGNAL));
+  if (rv != static_cast<ssize_t>(sizeof(message))) {
+    return false;
+  }
+
+  ServerToClientMessage response;
+  rv = HANDLE_EINTR(recv(sock, &response, sizeof(response), 0));
+  if (rv != static_cast<ssize_t>(sizeof(response))) {
+    return false;
+  }
+
+  return response.type == ServerToClientMessage::kCrashDumpComplete;
+}
+
+bool EnableClientCredentials(int sock) {
+  const int enable = 1;
+  if (setsockopt(sock, SOL_SOCKET, SO_PASSCRED, &enable, sizeof(enable)) !=
+      0) {
+    PLOG(ERROR) << "setsockopt";
+    return false;
+  }
+  return true;
+}
+
+bool ReceiveClientMessage(int sock,
+                          ClientToServerMessage* message,
+                          pid_t* client_pid) {
+  iovec iov;
+  iov.iov_base = message;
+  iov.iov_len = sizeof(*message);
+
+  char control[CMSG_SPACE(sizeof(ucred))];
+  msghdr msg = {};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  ssize_t rv = HANDLE_EINTR(recvmsg(sock, &msg, MSG_CMSG_CLOEXEC));
+  if (rv < 0) {
+    PLOG(ERROR) << "recvmsg";
+    return false;
+  }
+  if (rv == 0) {
+    return false;
+  }
+  if (rv != static_cast<ssize_t>(sizeof(*message)) ||
+      (msg.msg_flags & (MSG_TRUNC | MSG_CTRUNC)) != 0) {
+    LOG(ERROR) << "unexpected message size " << rv;
+    return false;
+  }
+
+  if (message->version != ClientToServerMessage::kVersion) {
+    LOG(ERROR) << "unexpected version " << message->version;
+    return false;
+  }
+
+  for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg;
+       cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+    if (cmsg->cmsg_level == SOL_SOCKET &&
+        cmsg->cmsg_type == SCM_CREDENTIALS &&
+        cmsg->cmsg_len == CMSG_LEN(sizeof(ucred))) {
+      ucred credentials;
+      memcpy(&credentials, CMSG_DATA(cmsg), sizeof(credentials));
+      *client_pid = credentials.pid;
+      return true;
+    }
+  }
+
+  LOG(ERROR) << "missing credentials";
+  return false;
+}
+
+bool SendServerResponse(int sock, ServerToClientMessage::Type type) {
+  ServerToClientMessage response;
+  response.type = type;
+  ssize_t rv =
+      HANDLE_EINTR(send(sock, &response, sizeof(response), MSG_NOSIGNAL));
+  if (rv < 0) {
+    PLOG(ERROR) << "send";
+    return false;
+  }
+  if (rv != static_cast<ssize_t>(sizeof(response))) {
+    LOG(ERROR) << "send: short write";
+    return false;
+  }
+  return true;
+}
+
+}  // namespace crashpad
@@ -0,0 +1,122 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_LINUX_EXCEPTION_HANDLER_PROTOCOL_H_
+#define CRASHPAD_UTIL_LINUX_EXCEPTION_HANDLER_PROTOCOL_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "util/linux/address_types.h"
+
+namespace crashpad {
+
+#pragma pack(push, 1)
+
+//! \brief Information about a client, sent with a crash dump request.
+struct ClientInformation {
+  //! \brief The address, in the client process’ address space, of an
+  //!     ExceptionInformation structure describing the crash.
+  LinuxVMAddress exception_information_address;
+};
+
+//! \brief The message passed from client to server.
+//!
+//! Messages are exchanged over a connected `AF_UNIX` `SOCK_SEQPACKET` socket,
+//! so that each message is received whole. The server identifies the client
+//! process by the credentials that the kernel attaches to the message once
+//! EnableClientCredentials() has been called on the server’s socket.
+struct ClientToServerMessage {
+  //! \brief The expected value of #version. This should be changed whenever
+  //!     the messages, ClientInformation, or ExceptionInformation are modified
+  //!     incompatibly.
+  enum { kVersion = 1 };
+
+  //! \brief Version field to detect skew between client and server. Should be
+  //!     set to #kVersion.
+  int32_t version;
+
+  //! \brief Indicates which field of the union is in use.
+  enum Type : uint32_t {
+    //! \brief A request to capture a dump of a crashed client. The client
+    //!     waits for a ServerToClientMessage before proceeding.
+    kCrashDumpRequest = 0,
+  } type;
+
+  union {
+    //! \brief Valid for kCrashDumpRequest.
+    ClientInformation client_info;
+  };
+};
+
+//! \brief The message passed from server to client in response to a
+//!     ClientToServerMessage.
+struct ServerToClientMessage {
+  //! \brief The outcome of the request.
+  enum Type : uint32_t {
+    //! \brief The dump was written.
+    kCrashDumpComplete = 0,
+
+    //! \brief The dump could not be written.
+    kCrashDumpFailed,
+  } type;
+};
+
+#pragma pack(pop)
+
+//! \brief Sends a crash dump request to a handler and waits for its response.
+//!
+//! This function is safe to call from a signal handler. It does not allocate
+//! memory or log messages.
+//!
+//! \param[in] sock A socket connected to the handler.
+//! \param[in] info Information about the crash.
+//!
+//! \return `true` if the handler reported that the dump was written. `false`
+//!     if the handler could not be reached, closed the connection, or failed to
+//!     write the dump, with `errno` set when a system call failed.
+bool RequestCrashDump(int sock, const ClientInformation& info);
+
+//! \brief Configures a server’s socket so that the kernel attaches the sending
+//!     process’ credentials to each message received.
+//!
+//! This must be called before any message that will be passed to
+//! ReceiveClientMessage() is sent by the client.
+//!
+//! \return `true` on success. `false` on failure with a message logged.
+bool EnableClientCredentials(int sock);
+
+//! \brief Receives a message from a client.
+//!
+//! \param[in] sock A socket connected to the client, which has been configured
+//!     with EnableClientCredentials().
+//! \param[out] message The message received.
+//! \param[out] client_pid The process ID of the client that sent \a message, as
+//!     seen in the server’s PID namespace.
+//!
+//! \return `true` on success. `false` without a message logged if the client
+//!     closed the connection. `false` with a message logged if the client
+//!     sent a malformed message, or on any other failure.
+bool ReceiveClientMessage(int sock,
+                          ClientToServerMessage* message,
+                          pid_t* client_pid);
+
+//! \brief Sends a response to a client.
+//!
+//! \return `true` on success. `false` on failure with a message logged.
+bool SendServerResponse(int sock, ServerToClientMessage::Type type);
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_LINUX_EXCEPTION_HANDLER_PROTOCOL_H_
@@ -0,0 +1,300 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/linux/io_uring.h"
+
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "base/posix/eintr_wrapper.h"
+
+#if !defined(__NR_io_uring_setup)
+#define __NR_io_uring_setup 425
+#endif
+#if !defined(__NR_io_uring_enter)
+#define __NR_io_uring_enter 426
+#endif
+
+namespace crashpad {
+
+namespace {
+
+int IoUringSetup(unsigned int entries, io_uring_params* params) {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int IoUringEnter(int fd,
+                 unsigned int to_submit,
+                 unsigned int min_complete,
+                 unsigned int flags) {
+  return static_cast<int>(syscall(
+      __NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+size_t RoundUpToPageSize(size_t size) {
+  const size_t page_size = getpagesize();
+  return (size + page_size - 1) & ~(page_size - 1);
+}
+
+template <typename T>
+T* RingPointer(const ScopedMmap& ring, uint32_t offset) {
+  return reinterpret_cast<T*>(ring.addr_as<char*>() + offset);
+}
+
+}  // namespace
+
+IoUring::IoUring()
+    : sq_ring_(),
+      cq_ring_(),
+      sqes_(),
+      iovecs_(),
+      ring_fd_(),
+      sq_head_(nullptr),
+      sq_tail_(nullptr),
+      sq_mask_(nullptr),
+      sq_array_(nullptr),
+      cq_head_(nullptr),
+      cq_tail_(nullptr),
+      cq_mask_(nullptr),
+      cqes_(nullptr),
+      sq_entries_(0),
+      failed_(false),
+      initialized_() {}
+
+IoUring::~IoUring() {}
+
+// static
+bool IoUring::IsSupported() {
+  static const bool supported = []() {
+    io_uring_params params = {};
+    base::ScopedFD fd(IoUringSetup(1, &params));
+    return fd.is_valid();
+  }();
+  return supported;
+}
+
+bool IoUring::Initialize(unsigned int entries) {
+  INITIALIZATION_STATE_SET_INITIALIZING(initialized_);
+
+  io_uring_params params = {};
+  ring_fd_.reset(IoUringSetup(entries, &params));
+  if (!ring_fd_.is_valid()) {
+    PLOG(ERROR) << "io_uring_setup";
+    return false;
+  }
+
+  // ScopedMmap requires whole pages.
+  const size_t sq_ring_size = RoundUpToPageSize(
+      params.sq_off.array + params.sq_entries * sizeof(uint32_t));
+  const size_t cq_ring_size = RoundUpToPageSize(
+      params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+  const size_t sqes_size =
+      RoundUpToPageSize(params.sq_entries * sizeof(io_uring_sqe));
+
+  if (!sq_ring_.ResetMmap(nullptr,
+                          sq_ring_size,
+                          PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE,
+                          ring_fd_.get(),
+                          IORING_OFF_SQ_RING) ||
+      !cq_ring_.ResetMmap(nullptr,
+                          cq_ring_size,
+                          PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE,
+                          ring_fd_.get(),
+                          IORING_OFF_CQ_RING) ||
+      !sqes_.ResetMmap(nullptr,
+                       sqes_size,
+                       PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE,
+                       ring_fd_.get(),
+                       IORING_OFF_SQES)) {
+    return false;
+  }
+
+  sq_head_ = RingPointer<uint32_t>(sq_ring_, params.sq_off.head);
+  sq_tail_ = RingPointer<uint32_t>(sq_ring_, params.sq_off.tail);
+  sq_mask_ = RingPointer<uint32_t>(sq_ring_, params.sq_off.ring_mask);
+  sq_array_ = RingPointer<uint32_t>(sq_ring_, params.sq_off.array);
+  cq_head_ = RingPointer<uint32_t>(cq_ring_, params.cq_off.head);
+  cq_tail_ = RingPointer<uint32_t>(cq_ring_, params.cq_off.tail);
+  cq_mask_ = RingPointer<uint32_t>(cq_ring_, params.cq_off.ring_mask);
+  cqes_ = RingPointer<void>(cq_ring_, params.cq_off.cqes);
+  sq_entries_ = params.sq_entries;
+
+  // Reserve space up front so that queued operations’ iovecs never move.
+  iovecs_.reserve(sq_entries_);
+
+  INITIALIZATION_STATE_SET_VALID(initialized_);
+  return true;
+}
+
+unsigned int IoUring::capacity() const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  return sq_entries_;
+}
+
+bool IoUring::QueueRead(int fd,
+                        void* buffer,
+                        size_t size,
+                        uint64_t offset,
+                        uint64_t user_data) {
+  return Queue(IORING_OP_READV, fd, buffer, size, offset, user_data);
+}
+
+bool IoUring::QueueWrite(int fd,
+                         const void* buffer,
+                         size_t size,
+                         uint64_t offset,
+                         uint64_t user_data) {
+  // IORING_OP_WRITEV does not write to the buffer, so this cast is safe.
+  return Queue(IORING_OP_WRITEV,
+               fd,
+               const_cast<void*>(buffer),
+               size,
+               offset,
+               user_data);
+}
+
+bool IoUring::Queue(uint8_t opcode,
+                    int fd,
+                    void* buffer,
+                    size_t size,
+                    uint64_t offset,
+                    uint64_t user_data) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+
+  if (failed_ || iovecs_.size() >= sq_entries_) {
+    return false;
+  }
+
+  iovecs_.push_back({buffer, size});
+
+  uint32_t tail = *sq_tail_;
+  DCHECK_LT(tail - *sq_head_, sq_entries_);
+  uint32_t index = tail & *sq_mask_;
+  io_uring_sqe* sqe = sqes_.addr_as<io_uring_sqe*>() + index;
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = opcode;
+  sqe->fd = fd;
+  sqe->off = offset;
+  sqe->addr = reinterpret_cast<uint64_t>(&iovecs_.back());
+  sqe->len = 1;
+  sqe->user_data = user_data;
+  sq_array_[index] = index;
+
+  // The kernel must observe the fully-written entry before the new tail.
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+bool IoUring::SubmitAndWait(std::vector<Completion>* completions) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+
+  completions->clear();
+  if (failed_) {
+    LOG(ERROR) << "io_uring unusable after an earlier failure";
+    return false;
+  }
+
+  unsigned int to_submit = pending();
+  if (to_submit == 0) {
+    return true;
+  }
+
+  const uint32_t first_sq_head = *sq_tail_ - to_submit;
+  unsigned int submitted = 0;
+  while (submitted < to_submit) {
+    int rv = HANDLE_EINTR(Enter(to_submit - submitted,
+                                to_submit - submitted,
+                                IORING_ENTER_GETEVENTS));
+    if (rv < 0) {
+      PLOG(ERROR) << "io_uring_enter";
+      Abandon(first_sq_head, completions->size());
+      completions->clear();
+      return false;
+    }
+    submitted += rv;
+  }
+
+  completions->reserve(to_submit);
+  while (completions->size() < to_submit) {
+    uint32_t head = *cq_head_;
+    uint32_t tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    if (head == tail) {
+      // Everything was submitted, but not everything has completed yet.
+      if (HANDLE_EINTR(Enter(0, 1, IORING_ENTER_GETEVENTS)) < 0) {
+        PLOG(ERROR) << "io_uring_enter";
+        Abandon(first_sq_head, completions->size());
+        completions->clear();
+        return false;
+      }
+      continue;
+    }
+
+    for (; head != tail; ++head) {
+      const io_uring_cqe* cqe =
+          static_cast<const io_uring_cqe*>(cqes_) + (head & *cq_mask_);
+      completions->push_back({cqe->user_data, cqe->res});
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+  }
+
+  iovecs_.clear();
+  return true;
+}
+
+int IoUring::Enter(unsigned int to_submit,
+                   unsigned int min_complete,
+                   unsigned int flags) {
+  return IoUringEnter(ring_fd_.get(), to_submit, min_complete, flags);
+}
+
+void IoUring::Abandon(uint32_t first_sq_head, size_t completed) {
+  failed_ = true;
+
+  // The kernel only looks for new submissions in io_uring_enter(), so moving
+  // the tail back to the head withdraws the operations it hasn’t taken.
+  const uint32_t sq_head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+  __atomic_store_n(sq_tail_, sq_head, __ATOMIC_RELEASE);
+
+  // The operations the kernel has taken may still be using their buffers, so
+  // wait for them to complete. If that isn’t possible, they’re left to be
+  // cancelled when the ring is destroyed.
+  size_t in_flight = sq_head - first_sq_head - completed;
+  while (in_flight > 0) {
+    const uint32_t head = *cq_head_;
+    const uint32_t tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    if (head != tail) {
+      in_flight -= std::min(in_flight, static_cast<size_t>(tail - head));
+      __atomic_store_n(cq_head_, tail, __ATOMIC_RELEASE);
+      continue;
+    }
+    if (HANDLE_EINTR(Enter(0, 1, IORING_ENTER_GETEVENTS)) < 0) {
+      PLOG(ERROR) << "io_uring_enter";
+      break;
+    }
+  }
+
+  iovecs_.clear();
+}
+
+}  // namespace crashpad
@@ -0,0 +1,185 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_LINUX_IO_URING_H_
+#define CRASHPAD_UTIL_LINUX_IO_URING_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include <vector>
+
+#include "base/files/scoped_file.h"
+#include "base/macros.h"
+#include "util/misc/initialization_state_dcheck.h"
+#include "util/posix/scoped_mmap.h"
+
+namespace crashpad {
+
+//! \brief A minimal io_uring submission and completion queue pair.
+//!
+//! This class issues the `io_uring_setup()` and `io_uring_enter()` system calls
+//! directly, so it has no dependency on liburing. It supports only the
+//! operations that Crashpad needs: positioned reads and writes, submitted as a
+//! batch and then waited on together.
+//!
+//! io_uring may be unavailable because the kernel predates it, because it has
+//! been disabled by `kernel.io_uring_disabled`, or because a seccomp policy
+//! forbids it. Callers must be prepared for Initialize() to fail, and should
+//! fall back to ordinary synchronous system calls when it does.
+class IoUring {
+ public:
+  //! \brief The result of a single completed operation.
+  struct Completion {
+    //! \brief The value passed as `user_data` when the operation was queued.
+    uint64_t user_data;
+
+    //! \brief The operation’s result: a byte count on success, or a negated
+    //!     `errno` value on failure.
+    int32_t result;
+  };
+
+  IoUring();
+  virtual ~IoUring();
+
+  //! \brief Determines whether io_uring can be used in this process.
+  //!
+  //! The result is computed once and cached. No message is logged when
+  //! io_uring is unavailable.
+  static bool IsSupported();
+
+  //! \brief Creates the submission and completion queues.
+  //!
+  //! This method must be called successfully prior to calling any other method
+  //! in this class.
+  //!
+  //! \param[in] entries The maximum number of operations that may be queued
+  //!     between calls to SubmitAndWait(). The kernel may round this up.
+  //!
+  //! \return `true` on success, `false` on failure with a message logged.
+  bool Initialize(unsigned int entries);
+
+  //! \brief The number of operations that may be queued before
+  //!     SubmitAndWait() must be called.
+  unsigned int capacity() const;
+
+  //! \brief The number of operations queued but not yet submitted.
+  unsigned int pending() const {
+    return static_cast<unsigned int>(iovecs_.size());
+  }
+
+  //! \brief Queues a positioned read of \a size bytes from \a fd at \a offset
+  //!     into \a buffer.
+  //!
+  //! \a buffer must remain valid until SubmitAndWait() returns.
+  //!
+  //! \return `true` on success. `false` if the submission queue is full, in
+  //!     which case SubmitAndWait() must be called before queueing more
+  //!     operations.
+  bool QueueRead(int fd,
+                 void* buffer,
+                 size_t size,
+                 uint64_t offset,
+                 uint64_t user_data);
+
+  //! \brief Queues a positioned write of \a size bytes from \a buffer to \a fd
+  //!     at \a offset.
+  //!
+  //! \a buffer must remain valid until SubmitAndWait() returns.
+  //!
+  //! \return `true` on success. `false` if the submission queue is full, in
+  //!     which case SubmitAndWait() must be called before queueing more
+  //!     operations.
+  bool QueueWrite(int fd,
+                  const void* buffer,
+                  size_t size,
+                  uint64_t offset,
+                  uint64_t user_data);
+
+  //! \brief Submits all queued operations and waits for all of them to
+  //!     complete.
+  //!
+  //! \param[out] completions The results of the submitted operations, in the
+  //!     order that they completed, which need not be the order in which they
+  //!     were queued.
+  //!
+  //! If `io_uring_enter()` fails, operations not yet taken by the kernel are
+  //! withdrawn, and those already taken are waited on when possible so that
+  //! they no longer use their buffers. Their completions are discarded. The
+  //! object is then unusable: further operations can’t be queued, and this
+  //! method fails. Callers should destroy it and fall back to ordinary
+  //! synchronous system calls.
+  //!
+  //! \return `true` on success, with \a completions set appropriately. `false`
+  //!     on failure, with a message logged. Success indicates only that every
+  //!     operation was submitted and completed. The result of each operation
+  //!     must be checked individually in \a completions.
+  bool SubmitAndWait(std::vector<Completion>* completions);
+
+ protected:
+  //! \brief Calls `io_uring_enter()` on the ring.
+  //!
+  //! This is virtual so that tests can inject failures.
+  //!
+  //! \return As for `io_uring_enter()`, with `errno` set on failure.
+  virtual int Enter(unsigned int to_submit,
+                    unsigned int min_complete,
+                    unsigned int flags);
+
+ private:
+  bool Queue(uint8_t opcode,
+             int fd,
+             void* buffer,
+             size_t size,
+             uint64_t offset,
+             uint64_t user_data);
+
+  // Recovers from a failed io_uring_enter() on behalf of SubmitAndWait(),
+  // leaving the ring with nothing queued or in flight if possible, and marks
+  // this object as failed. |first_sq_head| is the submission queue head before
+  // any of the queued operations were submitted, and |completed| is the number
+  // of their completions already collected.
+  void Abandon(uint32_t first_sq_head, size_t completed);
+
+  ScopedMmap sq_ring_;
+  ScopedMmap cq_ring_;
+  ScopedMmap sqes_;
+
+  // The iovecs referenced by queued IORING_OP_READV and IORING_OP_WRITEV
+  // operations. These must remain valid until the operations are submitted.
+  std::vector<iovec> iovecs_;
+
+  base::ScopedFD ring_fd_;
+
+  // Pointers into sq_ring_ and cq_ring_, at offsets supplied by the kernel.
+  volatile uint32_t* sq_head_;
+  volatile uint32_t* sq_tail_;
+  const uint32_t* sq_mask_;
+  uint32_t* sq_array_;
+  volatile uint32_t* cq_head_;
+  volatile uint32_t* cq_tail_;
+  const uint32_t* cq_mask_;
+  void* cqes_;
+
+  unsigned int sq_entries_;
+  bool failed_;
+  InitializationStateDcheck initialized_;
+
+  DISALLOW_COPY_AND_ASSIGN(IoUring);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_LINUX_IO_URING_H_
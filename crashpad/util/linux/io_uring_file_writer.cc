@@ -0,0 +1,280 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/linux/io_uring_file_writer.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "base/logging.h"
+#include "base/posix/eintr_wrapper.h"
+#include "util/linux/io_uring.h"
+
+namespace crashpad {
+
+namespace {
+
+// Contiguous writes are coalesced into chunks of roughly this size.
+constexpr size_t kChunkSize = 64 * 1024;
+
+bool LoggingPwrite(FileHandle file_handle,
+                   const char* data,
+                   size_t size,
+                   FileOffset offset) {
+  while (size > 0) {
+    ssize_t written = HANDLE_EINTR(pwrite(file_handle, data, size, offset));
+    if (written < 0) {
+      PLOG(ERROR) << "pwrite";
+      return false;
+    }
+    if (written == 0) {
+      LOG(ERROR) << "pwrite: returned 0";
+      return false;
+    }
+    data += written;
+    size -= written;
+    offset += written;
+  }
+  return true;
+}
+
+}  // namespace
+
+constexpr size_t IoUringFileWriter::kDefaultMaxBufferedBytes;
+
+IoUringFileWriter::IoUringFileWriter(FileHandle file_handle, Backend backend)
+    : IoUringFileWriter(file_handle, backend, kDefaultMaxBufferedBytes) {}
+
+IoUringFileWriter::IoUringFileWriter(FileHandle file_handle,
+                                     Backend backend,
+                                     size_t max_buffered_bytes)
+    : sealed_chunks_(),
+      current_chunk_(),
+      io_uring_(),
+      file_handle_(file_handle),
+      max_sealed_chunks_(static_cast<unsigned int>(
+          std::max(max_buffered_bytes / kChunkSize, static_cast<size_t>(1)))),
+      position_(-1) {
+  // The sealed chunks are submitted together, so this is also the size of the
+  // io_uring submission queue.
+  if (backend == Backend::kAutomatic && IoUring::IsSupported()) {
+    io_uring_.reset(new IoUring());
+    if (!io_uring_->Initialize(max_sealed_chunks_)) {
+      io_uring_.reset();
+    }
+  }
+  sealed_chunks_.reserve(max_sealed_chunks_);
+}
+
+IoUringFileWriter::~IoUringFileWriter() {
+  Flush();
+}
+
+bool IoUringFileWriter::Flush() {
+  DCHECK_NE(file_handle_, kInvalidFileHandle);
+
+  if (!SealChunk() || !SubmitChunks()) {
+    return false;
+  }
+  return position_ < 0 ||
+         LoggingSeekFile(file_handle_, position_, SEEK_SET) >= 0;
+}
+
+bool IoUringFileWriter::Write(const void* data, size_t size) {
+  DCHECK_NE(file_handle_, kInvalidFileHandle);
+
+  if (size == 0) {
+    return true;
+  }
+
+  if (!EnsurePosition()) {
+    return false;
+  }
+
+  if (!current_chunk_.data.empty() &&
+      current_chunk_.offset +
+              static_cast<FileOffset>(current_chunk_.data.size()) !=
+          position_) {
+    if (!SealChunk()) {
+      return false;
+    }
+  }
+
+  if (current_chunk_.data.empty()) {
+    current_chunk_.offset = position_;
+  }
+  current_chunk_.data.append(static_cast<const char*>(data), size);
+  position_ += size;
+
+  return current_chunk_.data.size() < kChunkSize || SealChunk();
+}
+
+bool IoUringFileWriter::WriteIoVec(std::vector<WritableIoVec>* iovecs) {
+  if (iovecs->empty()) {
+    LOG(ERROR) << "WriteIoVec(): no iovecs";
+    return false;
+  }
+
+  for (const WritableIoVec& iov : *iovecs) {
+    if (!Write(iov.iov_base, iov.iov_len)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+FileOffset IoUringFileWriter::Seek(FileOffset offset, int whence) {
+  DCHECK_NE(file_handle_, kInvalidFileHandle);
+
+  FileOffset new_position;
+  switch (whence) {
+    case SEEK_SET:
+      new_position = offset;
+      break;
+    case SEEK_CUR:
+      if (!EnsurePosition()) {
+        return -1;
+      }
+      new_position = position_ + offset;
+      break;
+    case SEEK_END:
+      // The file’s size can only be known once everything has been written.
+      if (!Flush()) {
+        return -1;
+      }
+      position_ = LoggingSeekFile(file_handle_, offset, SEEK_END);
+      return position_;
+    default:
+      LOG(ERROR) << "Seek(): invalid whence " << whence;
+      return -1;
+  }
+
+  if (new_position < 0) {
+    LOG(ERROR) << "Seek(): invalid offset " << new_position;
+    return -1;
+  }
+
+  position_ = new_position;
+  return position_;
+}
+
+bool IoUringFileWriter::EnsurePosition() {
+  if (position_ < 0) {
+    position_ = LoggingSeekFile(file_handle_, 0, SEEK_CUR);
+  }
+  return position_ >= 0;
+}
+
+bool IoUringFileWriter::SealChunk() {
+  if (current_chunk_.data.empty()) {
+    return true;
+  }
+
+  // Operations submitted together may complete in any order, so a chunk that
+  // overlaps one already awaiting submission, such as a minidump header
+  // rewritten after the body, must wait for the earlier chunks to be written.
+  const FileOffset begin = current_chunk_.offset;
+  const FileOffset end = begin + current_chunk_.data.size();
+  for (const Chunk& chunk : sealed_chunks_) {
+    if (begin < chunk.offset + static_cast<FileOffset>(chunk.data.size()) &&
+        chunk.offset < end) {
+      if (!SubmitChunks()) {
+        return false;
+      }
+      break;
+    }
+  }
+
+  sealed_chunks_.push_back(std::move(current_chunk_));
+  current_chunk_ = Chunk();
+
+  return sealed_chunks_.size() < max_sealed_chunks_ || SubmitChunks();
+}
+
+bool IoUringFileWriter::SubmitChunks() {
+  if (sealed_chunks_.empty()) {
+    return true;
+  }
+
+  bool rv = io_uring_ ? SubmitChunksIoUring() : SubmitChunksSynchronous();
+  sealed_chunks_.clear();
+  return rv;
+}
+
+bool IoUringFileWriter::SubmitChunksIoUring() {
+  // If the io_uring fails, it can’t be used again. Rewriting every chunk
+  // without it is simpler than working out which writes completed.
+  std::vector<IoUring::Completion> completions;
+  for (size_t index = 0; index < sealed_chunks_.size(); ++index) {
+    const Chunk& chunk = sealed_chunks_[index];
+    if (!io_uring_->QueueWrite(file_handle_,
+                               chunk.data.data(),
+                               chunk.data.size(),
+                               chunk.offset,
+                               index)) {
+      LOG(WARNING) << "io_uring submission queue full, writing synchronously";
+      io_uring_.reset();
+      return SubmitChunksSynchronous();
+    }
+  }
+
+  if (!io_uring_->SubmitAndWait(&completions)) {
+    LOG(WARNING) << "io_uring failed, writing synchronously";
+    io_uring_.reset();
+    return SubmitChunksSynchronous();
+  }
+
+  bool rv = true;
+  for (const IoUring::Completion& completion : completions) {
+    if (completion.user_data >= sealed_chunks_.size()) {
+      LOG(ERROR) << "unexpected io_uring completion " << completion.user_data;
+      rv = false;
+      continue;
+    }
+    const Chunk& chunk = sealed_chunks_[completion.user_data];
+    if (completion.result < 0) {
+      errno = -completion.result;
+      PLOG(ERROR) << "io_uring write";
+      rv = false;
+      continue;
+    }
+
+    // Finish a short write synchronously.
+    size_t written = completion.result;
+    if (written < chunk.data.size() &&
+        !LoggingPwrite(file_handle_,
+                       chunk.data.data() + written,
+                       chunk.data.size() - written,
+                       chunk.offset + written)) {
+      rv = false;
+    }
+  }
+  return rv;
+}
+
+bool IoUringFileWriter::SubmitChunksSynchronous() {
+  for (const Chunk& chunk : sealed_chunks_) {
+    if (!LoggingPwrite(
+            file_handle_, chunk.data.data(), chunk.data.size(), chunk.offset)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace crashpad
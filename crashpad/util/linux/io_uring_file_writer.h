@@ -0,0 +1,141 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_LINUX_IO_URING_FILE_WRITER_H_
+#define CRASHPAD_UTIL_LINUX_IO_URING_FILE_WRITER_H_
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "util/file/file_io.h"
+#include "util/file/file_writer.h"
+
+namespace crashpad {
+
+class IoUring;
+
+//! \brief A file writer that queues positioned writes and submits them in
+//!     batches through io_uring.
+//!
+//! Minidump writing produces a large number of small writes, most of which are
+//! contiguous. This class coalesces contiguous writes into larger chunks, and
+//! tracks the file position itself so that Seek() does not require a system
+//! call. Chunks are written at their known offsets, many at a time, through a
+//! single `io_uring_enter()` call.
+//!
+//! When io_uring is unavailable, or when #Backend::kSynchronous is requested,
+//! chunks are instead written with `pwrite()`. The coalescing still applies.
+//! If io_uring fails, this object switches to `pwrite()` for good.
+//!
+//! Because writes are deferred, errors may not be reported by the Write() call
+//! that queued the data. Flush() must be called, and must succeed, before the
+//! written file can be relied upon. After Flush(), the position of the
+//! underlying file handle matches the position of this object.
+//!
+//! Like WeakFileHandleFileWriter, this class does not own its file handle.
+//! The file handle must refer to a seekable file.
+class IoUringFileWriter : public FileWriterInterface {
+ public:
+  //! \brief The mechanism used to write queued data.
+  enum class Backend {
+    //! \brief Use io_uring when it is available, and `pwrite()` otherwise.
+    kAutomatic,
+
+    //! \brief Always use `pwrite()`.
+    kSynchronous,
+  };
+
+  //! \brief The amount of data queued by default before it is written.
+  static constexpr size_t kDefaultMaxBufferedBytes = 2 * 1024 * 1024;
+
+  //! \brief Constructs the writer.
+  //!
+  //! \param[in] file_handle The file handle to write to. This object does not
+  //!     take ownership of it.
+  //! \param[in] backend The mechanism to use to write queued data.
+  IoUringFileWriter(FileHandle file_handle, Backend backend);
+
+  //! \brief Constructs the writer with a limit on the data it queues.
+  //!
+  //! \param[in] file_handle The file handle to write to. This object does not
+  //!     take ownership of it.
+  //! \param[in] backend The mechanism to use to write queued data.
+  //! \param[in] max_buffered_bytes The approximate amount of data to queue
+  //!     before writing it. Smaller values use less memory at the cost of more
+  //!     system calls. At least one chunk is always queued.
+  IoUringFileWriter(FileHandle file_handle,
+                    Backend backend,
+                    size_t max_buffered_bytes);
+
+  //! \brief Destroys the writer.
+  //!
+  //! Any data that has not yet been written by Flush() is written, but errors
+  //! can only be logged. Callers should call Flush() explicitly.
+  ~IoUringFileWriter() override;
+
+  //! \brief Writes all queued data to the file.
+  //!
+  //! \return `true` on success, `false` on failure with a message logged.
+  bool Flush();
+
+  //! \return `true` if this object is writing through io_uring, `false` if it
+  //!     is using the synchronous fallback.
+  bool using_io_uring() const { return io_uring_.get() != nullptr; }
+
+  // FileWriterInterface:
+  bool Write(const void* data, size_t size) override;
+  bool WriteIoVec(std::vector<WritableIoVec>* iovecs) override;
+
+  // FileSeekerInterface:
+  FileOffset Seek(FileOffset offset, int whence) override;
+
+ private:
+  struct Chunk {
+    FileOffset offset;
+    std::string data;
+  };
+
+  //! \brief Determines the file handle’s position the first time it is
+  //!     needed.
+  bool EnsurePosition();
+
+  //! \brief Moves the chunk currently being filled to the list of chunks
+  //!     awaiting submission, submitting them if the list is full.
+  bool SealChunk();
+
+  //! \brief Writes all sealed chunks.
+  bool SubmitChunks();
+  bool SubmitChunksIoUring();
+  bool SubmitChunksSynchronous();
+
+  std::vector<Chunk> sealed_chunks_;
+  Chunk current_chunk_;
+  std::unique_ptr<IoUring> io_uring_;
+  FileHandle file_handle_;  // weak
+  unsigned int max_sealed_chunks_;
+
+  // The logical file position, which may differ from the underlying file
+  // handle’s until Flush() is called. This is -1 until it is first needed.
+  FileOffset position_;
+
+  DISALLOW_COPY_AND_ASSIGN(IoUringFileWriter);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_LINUX_IO_URING_FILE_WRITER_H_
@@ -0,0 +1,147 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/linux/io_uring_file_writer.h"
+
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "test/scoped_temp_dir.h"
+#include "util/file/file_io.h"
+#include "util/linux/io_uring.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+std::string ReadWholeFile(const base::FilePath& path) {
+  ScopedFileHandle handle(LoggingOpenFileForRead(path));
+  EXPECT_TRUE(handle.is_valid());
+  std::string contents;
+  char buffer[4096];
+  FileOperationResult rv;
+  while ((rv = ReadFile(handle.get(), buffer, sizeof(buffer))) > 0) {
+    contents.append(buffer, rv);
+  }
+  EXPECT_EQ(rv, 0);
+  return contents;
+}
+
+void TestWriteAndRewrite(IoUringFileWriter::Backend backend,
+                         size_t max_buffered_bytes) {
+  ScopedTempDir temp_dir;
+  base::FilePath path = temp_dir.path().Append(FILE_PATH_LITERAL("file"));
+  ScopedFileHandle handle(LoggingOpenFileForWrite(
+      path, FileWriteMode::kTruncateOrCreate, FilePermissions::kOwnerOnly));
+  ASSERT_TRUE(handle.is_valid());
+
+  // Build the expected contents alongside the file, in the same pattern as a
+  // minidump: a placeholder header, many small contiguous writes, then a seek
+  // back to rewrite the header.
+  std::string expected;
+  {
+    IoUringFileWriter writer(handle.get(), backend, max_buffered_bytes);
+    if (backend == IoUringFileWriter::Backend::kSynchronous) {
+      EXPECT_FALSE(writer.using_io_uring());
+    } else {
+      EXPECT_EQ(writer.using_io_uring(), IoUring::IsSupported());
+    }
+
+    EXPECT_EQ(writer.Seek(0, SEEK_CUR), 0);
+
+    const std::string header(32, '\0');
+    ASSERT_TRUE(writer.Write(header.data(), header.size()));
+    expected.append(header);
+
+    for (size_t index = 0; index < 20000; ++index) {
+      std::string record(index % 97 + 1, 'a' + index % 26);
+      if (index % 3 == 0) {
+        std::vector<WritableIoVec> iovecs(2);
+        iovecs[0].iov_base = record.data();
+        iovecs[0].iov_len = record.size() / 2;
+        iovecs[1].iov_base = record.data() + iovecs[0].iov_len;
+        iovecs[1].iov_len = record.size() - iovecs[0].iov_len;
+        ASSERT_TRUE(writer.WriteIoVec(&iovecs));
+      } else {
+        ASSERT_TRUE(writer.Write(record.data(), record.size()));
+      }
+      expected.append(record);
+    }
+
+    const FileOffset end = writer.Seek(0, SEEK_CUR);
+    EXPECT_EQ(end, static_cast<FileOffset>(expected.size()));
+
+    const std::string real_header("MDMP, rewritten after the body...");
+    EXPECT_EQ(writer.Seek(0, SEEK_SET), 0);
+    ASSERT_TRUE(writer.Write(real_header.data(), real_header.size()));
+    expected.replace(0, real_header.size(), real_header);
+
+    EXPECT_EQ(writer.Seek(end, SEEK_SET), end);
+    ASSERT_TRUE(writer.Write("tail", 4));
+    expected.append("tail");
+
+    ASSERT_TRUE(writer.Flush());
+    EXPECT_EQ(writer.Seek(0, SEEK_END),
+              static_cast<FileOffset>(expected.size()));
+  }
+
+  // After Flush(), the handle’s position matches the writer’s.
+  EXPECT_EQ(LoggingSeekFile(handle.get(), 0, SEEK_CUR),
+            static_cast<FileOffset>(expected.size()));
+
+  handle.reset();
+  EXPECT_EQ(ReadWholeFile(path), expected);
+}
+
+TEST(IoUringFileWriter, Automatic) {
+  TestWriteAndRewrite(IoUringFileWriter::Backend::kAutomatic,
+                      IoUringFileWriter::kDefaultMaxBufferedBytes);
+}
+
+TEST(IoUringFileWriter, Synchronous) {
+  TestWriteAndRewrite(IoUringFileWriter::Backend::kSynchronous,
+                      IoUringFileWriter::kDefaultMaxBufferedBytes);
+}
+
+TEST(IoUringFileWriter, SmallBuffer) {
+  // A limit smaller than one chunk still queues one chunk at a time.
+  TestWriteAndRewrite(IoUringFileWriter::Backend::kAutomatic, 0);
+  TestWriteAndRewrite(IoUringFileWriter::Backend::kSynchronous, 0);
+}
+
+TEST(IoUringFileWriter, FlushOnDestruction) {
+  ScopedTempDir temp_dir;
+  base::FilePath path = temp_dir.path().Append(FILE_PATH_LITERAL("file"));
+  ScopedFileHandle handle(LoggingOpenFileForWrite(
+      path, FileWriteMode::kTruncateOrCreate, FilePermissions::kOwnerOnly));
+  ASSERT_TRUE(handle.is_valid());
+
+  {
+    IoUringFileWriter writer(handle.get(),
+                             IoUringFileWriter::Backend::kAutomatic);
+    ASSERT_TRUE(writer.Write("abc", 3));
+    EXPECT_EQ(writer.Seek(-2, SEEK_CUR), 1);
+    ASSERT_TRUE(writer.Write("B", 1));
+  }
+
+  handle.reset();
+  EXPECT_EQ(ReadWholeFile(path), "aBc");
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
@@ -0,0 +1,201 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/linux/io_uring.h"
+
+#include <errno.h>
+#include <unistd.h>
+#include <linux/io_uring.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "test/errors.h"
+#include "test/scoped_temp_dir.h"
+#include "util/file/file_io.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+constexpr char kContents[] = "0123456789abcdef";
+constexpr size_t kReadSize = 4;
+
+// Fails the io_uring_enter() call numbered |fail_call|, counting from 0,
+// after running |before_failure|. Calls before it only submit, without waiting
+// for completions, so that the failure can strike while operations are in
+// flight.
+class FailingIoUring : public IoUring {
+ public:
+  FailingIoUring(int fail_call, std::function<void()> before_failure)
+      : IoUring(), before_failure_(before_failure), fail_call_(fail_call) {}
+  ~FailingIoUring() override {}
+
+  int calls() const { return calls_; }
+
+ private:
+  int Enter(unsigned int to_submit,
+            unsigned int min_complete,
+            unsigned int flags) override {
+    const int call = calls_++;
+    if (call == fail_call_) {
+      if (before_failure_) {
+        before_failure_();
+      }
+      errno = EIO;
+      return -1;
+    }
+    if (call < fail_call_) {
+      min_complete = 0;
+      flags &= ~IORING_ENTER_GETEVENTS;
+    }
+    return IoUring::Enter(to_submit, min_complete, flags);
+  }
+
+  std::function<void()> before_failure_;
+  int calls_ = 0;
+  int fail_call_;
+
+  DISALLOW_COPY_AND_ASSIGN(FailingIoUring);
+};
+
+class IoUringTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    const base::FilePath path = temp_dir_.path().Append("file");
+    {
+      ScopedFileHandle handle(LoggingOpenFileForWrite(
+          path, FileWriteMode::kCreateOrFail, FilePermissions::kOwnerOnly));
+      ASSERT_TRUE(handle.is_valid());
+      ASSERT_TRUE(
+          LoggingWriteFile(handle.get(), kContents, sizeof(kContents) - 1));
+    }
+    file_.reset(LoggingOpenFileForRead(path));
+    ASSERT_TRUE(file_.is_valid());
+  }
+
+  // Queues a read of each kReadSize piece of the file into |buffers|.
+  void QueueReads(IoUring* io_uring, std::vector<std::string>* buffers) {
+    const size_t count = (sizeof(kContents) - 1) / kReadSize;
+    buffers->assign(count, std::string(kReadSize, '-'));
+    for (size_t index = 0; index < count; ++index) {
+      ASSERT_TRUE(io_uring->QueueRead(file_.get(),
+                                      &(*buffers)[index][0],
+                                      kReadSize,
+                                      index * kReadSize,
+                                      index));
+    }
+  }
+
+  std::string Piece(size_t index) {
+    return std::string(kContents + index * kReadSize, kReadSize);
+  }
+
+  ScopedFileHandle file_;
+
+ private:
+  ScopedTempDir temp_dir_;
+};
+
+TEST_F(IoUringTest, Read) {
+  if (!IoUring::IsSupported()) {
+    return;
+  }
+
+  IoUring io_uring;
+  ASSERT_TRUE(io_uring.Initialize(8));
+
+  // The ring can be reused once a batch completes.
+  for (int batch = 0; batch < 2; ++batch) {
+    std::vector<std::string> buffers;
+    QueueReads(&io_uring, &buffers);
+    std::vector<IoUring::Completion> completions;
+    ASSERT_TRUE(io_uring.SubmitAndWait(&completions));
+    ASSERT_EQ(completions.size(), buffers.size());
+    for (const IoUring::Completion& completion : completions) {
+      ASSERT_LT(completion.user_data, buffers.size());
+      EXPECT_EQ(completion.result, static_cast<int32_t>(kReadSize));
+      EXPECT_EQ(buffers[completion.user_data], Piece(completion.user_data));
+    }
+  }
+}
+
+TEST_F(IoUringTest, SubmitFailure) {
+  if (!IoUring::IsSupported()) {
+    return;
+  }
+
+  FailingIoUring io_uring(0, nullptr);
+  ASSERT_TRUE(io_uring.Initialize(8));
+
+  std::vector<std::string> buffers;
+  QueueReads(&io_uring, &buffers);
+  std::vector<IoUring::Completion> completions;
+  EXPECT_FALSE(io_uring.SubmitAndWait(&completions));
+  EXPECT_TRUE(completions.empty());
+  EXPECT_EQ(io_uring.pending(), 0u);
+
+  // The kernel never saw the reads, so nothing was read into the buffers.
+  for (const std::string& buffer : buffers) {
+    EXPECT_EQ(buffer, std::string(kReadSize, '-'));
+  }
+
+  // The ring can’t be used again.
+  char byte;
+  EXPECT_FALSE(io_uring.QueueRead(file_.get(), &byte, 1, 0, 0));
+  EXPECT_FALSE(io_uring.SubmitAndWait(&completions));
+}
+
+TEST_F(IoUringTest, WaitFailure) {
+  if (!IoUring::IsSupported()) {
+    return;
+  }
+
+  // A read from an empty pipe is submitted but can’t complete, so
+  // SubmitAndWait() has to wait for it, and that wait fails. Data is written
+  // to the pipe just before the failure so that the read in flight can
+  // complete while the ring is abandoned.
+  int pipe_fds[2];
+  ASSERT_EQ(pipe(pipe_fds), 0) << ErrnoMessage("pipe");
+  ScopedFileHandle read_handle(pipe_fds[0]);
+  ScopedFileHandle write_handle(pipe_fds[1]);
+
+  FailingIoUring io_uring(1, [&write_handle]() {
+    ASSERT_TRUE(LoggingWriteFile(write_handle.get(), kContents, kReadSize));
+  });
+  ASSERT_TRUE(io_uring.Initialize(8));
+
+  std::string buffer(kReadSize, '-');
+  ASSERT_TRUE(io_uring.QueueRead(read_handle.get(), &buffer[0], kReadSize, 0,
+                                 0));
+  std::vector<IoUring::Completion> completions;
+  EXPECT_FALSE(io_uring.SubmitAndWait(&completions));
+  EXPECT_TRUE(completions.empty());
+  EXPECT_EQ(io_uring.pending(), 0u);
+
+  // The read in flight was waited on, so it no longer uses the buffer once
+  // SubmitAndWait() returns.
+  EXPECT_EQ(buffer, Piece(0));
+
+  // The ring isn’t used again.
+  const int calls = io_uring.calls();
+  EXPECT_FALSE(io_uring.SubmitAndWait(&completions));
+  EXPECT_EQ(io_uring.calls(), calls);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
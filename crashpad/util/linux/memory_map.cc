@@ -24,6 +24,7 @@
 #include "util/file/delimited_file_reader.h"
 #include "util/file/file_io.h"
 #include "util/file/string_file.h"
+#include "util/linux/ptrace_connection.h"
 #include "util/stdlib/string_number_conversion.h"
 
 namespace crashpad {
@@ -213,6 +214,14 @@ bool MemoryMap::Mapping::Equals(const Mapping& other) const {
 }
 
 bool MemoryMap::Initialize(pid_t pid) {
+  return InitializeInternal(pid, nullptr);
+}
+
+bool MemoryMap::Initialize(PtraceConnection* connection) {
+  return InitializeInternal(connection->GetProcessID(), connection);
+}
+
+bool MemoryMap::InitializeInternal(pid_t pid, PtraceConnection* connection) {
   INITIALIZATION_STATE_SET_INITIALIZING(initialized_);
 
   // If the maps file is not read atomically, entries can be read multiple times
@@ -227,7 +236,11 @@ bool MemoryMap::Initialize(pid_t pid) {
     std::string contents;
     char path[32];
     snprintf(path, sizeof(path), "/proc/%d/maps", pid);
-    if (!LoggingReadEntireFile(base::FilePath(path), &contents)) {
+    const bool read =
+        connection
+            ? connection->ReadFileContents(base::FilePath(path), &contents)
+            : LoggingReadEntireFile(base::FilePath(path), &contents);
+    if (!read) {
       return false;
     }
 
@@ -313,4 +326,18 @@ const MemoryMap::Mapping* MemoryMap::FindFileMmapStart(
   return nullptr;
 }
 
+std::vector<const MemoryMap::Mapping*> MemoryMap::FindFileMmapStarts() const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+
+  std::vector<const Mapping*> starts;
+  for (const Mapping& mapping : mappings_) {
+    const bool is_file = mapping.device != 0 || mapping.inode != 0;
+    if ((is_file && mapping.offset == 0) ||
+        (!is_file && mapping.name == "[vdso]")) {
+      starts.push_back(&mapping);
+    }
+  }
+  return starts;
+}
+
 }  // namespace crashpad
@@ -26,6 +26,8 @@
 
 namespace crashpad {
 
+class PtraceConnection;
+
 //! \brief Accesses information about mapped memory in another process.
 //!
 //! The target process must be stopped to guarantee correct mappings. If the
@@ -64,6 +66,19 @@ class MemoryMap {
   //! \return `true` on success, `false` on failure with a message logged.
   bool Initialize(pid_t pid);
 
+  //! \brief Initializes this object with information about the mapped memory
+  //!     regions in the process connected to \a connection.
+  //!
+  //! This method must be called successfully prior to calling any other method
+  //! in this class, unless Initialize(pid_t) is called instead. This method may
+  //! only be called once.
+  //!
+  //! \param[in] connection A connection to the process to obtain information
+  //!     for.
+  //!
+  //! \return `true` on success, `false` on failure with a message logged.
+  bool Initialize(PtraceConnection* connection);
+
   //! \return The Mapping containing \a address or `nullptr` if no match is
   //!     found. The caller does not take ownership of this object. It is scoped
   //!     to the lifetime of the MemoryMap object that it was obtained from.
@@ -90,7 +105,22 @@ class MemoryMap {
   //!     message logged.
   const Mapping* FindFileMmapStart(const Mapping& mapping) const;
 
+  //! \brief Finds every Mapping that could begin a mapped executable or
+  //!     library.
+  //!
+  //! These are the mappings that map a file from offset 0, along with
+  //! anonymous mappings named `[vdso]`, in order of increasing address.
+  //!
+  //! \return The mappings found. The caller does not take ownership of these
+  //!     objects. They are scoped to the lifetime of the MemoryMap object that
+  //!     they were obtained from.
+  std::vector<const Mapping*> FindFileMmapStarts() const;
+
  private:
+  // Reads /proc/[pid]/maps through |connection| if it is not nullptr, and
+  // directly otherwise.
+  bool InitializeInternal(pid_t pid, PtraceConnection* connection);
+
   std::vector<Mapping> mappings_;
   InitializationStateDcheck initialized_;
 };
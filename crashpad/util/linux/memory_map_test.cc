@@ -20,6 +20,9 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <vector>
+
 #include "base/files/file_path.h"
 #include "base/strings/stringprintf.h"
 #include "build/build_config.h"
@@ -408,6 +411,12 @@ TEST(MemoryMap, FindFileMmapStart) {
     EXPECT_EQ(map.FindFileMmapStart(*mapping2), mapping1);
     EXPECT_EQ(map.FindFileMmapStart(*mapping3), mapping1);
 
+    const std::vector<const MemoryMap::Mapping*> starts =
+        map.FindFileMmapStarts();
+    EXPECT_NE(std::find(starts.begin(), starts.end(), mapping1), starts.end());
+    EXPECT_EQ(std::find(starts.begin(), starts.end(), mapping2), starts.end());
+    EXPECT_EQ(std::find(starts.begin(), starts.end(), mapping3), starts.end());
+
 #if defined(ARCH_CPU_64_BITS)
     constexpr bool is_64_bit = true;
 #else
@@ -0,0 +1,190 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/linux/memory_pressure.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "base/logging.h"
+#include "util/linux/read_file_quietly.h"
+#include "util/misc/clock.h"
+#include "util/misc/lexing.h"
+
+namespace crashpad {
+
+namespace {
+
+// Parses a line of /proc/meminfo of the form “Key:   1234 kB” whose key is
+// |key|, including its colon.
+bool ParseMemInfoLine(const char* line, const char* key, uint64_t* bytes) {
+  if (!AdvancePastPrefix(&line, key)) {
+    return false;
+  }
+  while (*line == ' ') {
+    ++line;
+  }
+
+  uint64_t kilobytes;
+  if (!AdvancePastNumber(&line, &kilobytes) || strcmp(line, " kB") != 0) {
+    return false;
+  }
+
+  *bytes = kilobytes * 1024;
+  return true;
+}
+
+// Parses a line of /proc/pressure/memory of the form
+// “some avg10=1.23 avg60=…”, whose type is |type|, returning the avg10 value.
+bool ParsePressureLine(const char* line, const char* type, double* avg10) {
+  if (!AdvancePastPrefix(&line, type) ||
+      !AdvancePastPrefix(&line, " avg10=")) {
+    return false;
+  }
+
+  char* end;
+  *avg10 = strtod(line, &end);
+  return end != line && (*end == ' ' || *end == '\0');
+}
+
+// Calls |function| with each line of |contents|, without its newline.
+template <typename Function>
+void ForEachLine(const std::string& contents, Function function) {
+  size_t start = 0;
+  while (start < contents.size()) {
+    size_t end = contents.find('\n', start);
+    if (end == std::string::npos) {
+      end = contents.size();
+    }
+    function(contents.substr(start, end - start).c_str());
+    start = end + 1;
+  }
+}
+
+}  // namespace
+
+MemoryPressure::MemoryPressure()
+    : total_bytes(0),
+      available_bytes(0),
+      has_pressure_stall_information(false),
+      some_avg10(0),
+      full_avg10(0) {}
+
+constexpr uint64_t MemoryPressureReader::kDefaultCacheNanoseconds;
+
+MemoryPressureReader::MemoryPressureReader()
+    : MemoryPressureReader(base::FilePath("/proc"),
+                           kDefaultCacheNanoseconds) {}
+
+MemoryPressureReader::MemoryPressureReader(const base::FilePath& proc_path,
+                                           uint64_t cache_nanoseconds)
+    : proc_path_(proc_path),
+      cached_(),
+      cache_nanoseconds_(cache_nanoseconds),
+      cache_time_(0),
+      cache_valid_(false) {}
+
+MemoryPressureReader::~MemoryPressureReader() {}
+
+bool MemoryPressureReader::Read(MemoryPressure* pressure) {
+  const uint64_t now = ClockMonotonicNanoseconds();
+  if (cache_valid_ && now - cache_time_ < cache_nanoseconds_) {
+    *pressure = cached_;
+    return true;
+  }
+
+  const base::FilePath meminfo_path = proc_path_.Append("meminfo");
+  std::string contents;
+  if (!ReadFileQuietly(meminfo_path, &contents)) {
+    PLOG(ERROR) << "read " << meminfo_path.value();
+    return false;
+  }
+
+  MemoryPressure local_pressure;
+  if (!ParseMemInfo(contents, &local_pressure)) {
+    return false;
+  }
+
+  if (ReadFileQuietly(proc_path_.Append("pressure").Append("memory"),
+                      &contents)) {
+    ParsePressure(contents, &local_pressure);
+  }
+
+  cached_ = local_pressure;
+  cache_time_ = now;
+  cache_valid_ = true;
+  *pressure = local_pressure;
+  return true;
+}
+
+// static
+bool MemoryPressureReader::ParseMemInfo(const std::string& contents,
+                                        MemoryPressure* pressure) {
+  bool have_total = false;
+  bool have_available = false;
+  bool have_free = false;
+  uint64_t free_bytes = 0;
+  ForEachLine(contents, [&](const char* line) {
+    if (ParseMemInfoLine(line, "MemTotal:", &pressure->total_bytes)) {
+      have_total = true;
+    } else if (ParseMemInfoLine(
+                   line, "MemAvailable:", &pressure->available_bytes)) {
+      have_available = true;
+    } else if (ParseMemInfoLine(line, "MemFree:", &free_bytes)) {
+      have_free = true;
+    }
+  });
+
+  if (!have_total || !(have_available || have_free)) {
+    LOG(ERROR) << "meminfo format error";
+    return false;
+  }
+
+  if (!have_available) {
+    pressure->available_bytes = free_bytes;
+  }
+  return true;
+}
+
+// static
+bool MemoryPressureReader::ParsePressure(const std::string& contents,
+                                         MemoryPressure* pressure) {
+  PressureStallInformation stall;
+  pressure->has_pressure_stall_information =
+      ParsePressureStallInformation(contents, &stall);
+  pressure->some_avg10 = stall.some_avg10;
+  pressure->full_avg10 = stall.full_avg10;
+  return pressure->has_pressure_stall_information;
+}
+
+PressureStallInformation::PressureStallInformation()
+    : some_avg10(0), full_avg10(0) {}
+
+bool ParsePressureStallInformation(const std::string& contents,
+                                   PressureStallInformation* pressure) {
+  PressureStallInformation local_pressure;
+  bool have_some = false;
+  ForEachLine(contents, [&](const char* line) {
+    if (ParsePressureLine(line, "some", &local_pressure.some_avg10)) {
+      have_some = true;
+    } else {
+      ParsePressureLine(line, "full", &local_pressure.full_avg10);
+    }
+  });
+
+  *pressure = local_pressure;
+  return have_some;
+}
+
+}  // namespace crashpad
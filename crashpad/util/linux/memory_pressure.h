@@ -0,0 +1,149 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_LINUX_MEMORY_PRESSURE_H_
+#define CRASHPAD_UTIL_LINUX_MEMORY_PRESSURE_H_
+
+#include <stdint.h>
+
+#include <string>
+
+#include "base/files/file_path.h"
+#include "base/macros.h"
+
+namespace crashpad {
+
+//! \brief The system’s memory availability and pressure.
+struct MemoryPressure {
+  MemoryPressure();
+
+  //! \brief The total usable memory, in bytes, from `MemTotal` in
+  //!     `/proc/meminfo`.
+  uint64_t total_bytes;
+
+  //! \brief The memory available to start new work without swapping, in bytes,
+  //!     from `MemAvailable` in `/proc/meminfo`. On kernels that do not report
+  //!     `MemAvailable`, this is `MemFree` instead.
+  uint64_t available_bytes;
+
+  //! \brief Whether #some_avg10 and #full_avg10 are valid.
+  //!
+  //! Pressure stall information is not available on kernels built without
+  //! `CONFIG_PSI`.
+  bool has_pressure_stall_information;
+
+  //! \brief The percentage of the last 10 seconds in which at least one task
+  //!     was stalled on memory, from the `some` line of
+  //!     `/proc/pressure/memory`.
+  double some_avg10;
+
+  //! \brief The percentage of the last 10 seconds in which all non-idle tasks
+  //!     were stalled on memory, from the `full` line of
+  //!     `/proc/pressure/memory`.
+  double full_avg10;
+};
+
+//! \brief The averages from a `/proc/pressure` file.
+struct PressureStallInformation {
+  PressureStallInformation();
+
+  //! \brief The percentage of the last 10 seconds in which at least one task
+  //!     was stalled on the resource, from the `some` line.
+  double some_avg10;
+
+  //! \brief The percentage of the last 10 seconds in which all non-idle tasks
+  //!     were stalled on the resource, from the `full` line, or `0` if there is
+  //!     no `full` line.
+  double full_avg10;
+};
+
+//! \brief Parses the contents of a `/proc/pressure` file, such as
+//!     `/proc/pressure/memory`, `/proc/pressure/cpu`, or `/proc/pressure/io`.
+//!
+//! \param[in] contents The contents of the file.
+//! \param[out] pressure The averages.
+//!
+//! \return `true` on success. `false` if \a contents has no valid `some` line.
+bool ParsePressureStallInformation(const std::string& contents,
+                                   PressureStallInformation* pressure);
+
+//! \brief Reads the system’s memory pressure from `/proc`.
+//!
+//! Results are cached, so that a handler can consult this before each capture
+//! without rereading `/proc` for every one during a burst of crashes.
+class MemoryPressureReader {
+ public:
+  //! \brief The default time for which a reading is reused.
+  static constexpr uint64_t kDefaultCacheNanoseconds = 1000000000;
+
+  //! \brief Constructs a reader for the system’s `/proc`.
+  MemoryPressureReader();
+
+  //! \brief Constructs a reader for files in an alternate location.
+  //!
+  //! \param[in] proc_path The directory to read `meminfo` and
+  //!     `pressure/memory` from, in place of `/proc`.
+  //! \param[in] cache_nanoseconds The time for which a reading is reused.
+  MemoryPressureReader(const base::FilePath& proc_path,
+                       uint64_t cache_nanoseconds);
+
+  ~MemoryPressureReader();
+
+  //! \brief Returns the current memory pressure.
+  //!
+  //! If a reading was taken within the cache period, it is returned without
+  //! reading `/proc` again.
+  //!
+  //! \param[out] pressure The memory pressure.
+  //!
+  //! \return `true` on success, with \a pressure set. `false` if `meminfo`
+  //!     could not be read or parsed, with a message logged. A missing or
+  //!     malformed `pressure/memory` is not an error.
+  bool Read(MemoryPressure* pressure);
+
+  //! \brief Parses the contents of `/proc/meminfo`.
+  //!
+  //! \param[in] contents The contents of the file.
+  //! \param[in,out] pressure The object whose MemoryPressure::total_bytes and
+  //!     MemoryPressure::available_bytes are set.
+  //!
+  //! \return `true` on success. `false` if `MemTotal` or both of `MemAvailable`
+  //!     and `MemFree` are missing, with a message logged.
+  static bool ParseMemInfo(const std::string& contents,
+                           MemoryPressure* pressure);
+
+  //! \brief Parses the contents of `/proc/pressure/memory`.
+  //!
+  //! \param[in] contents The contents of the file.
+  //! \param[in,out] pressure The object whose MemoryPressure::some_avg10,
+  //!     MemoryPressure::full_avg10, and
+  //!     MemoryPressure::has_pressure_stall_information are set.
+  //!
+  //! \return `true` on success. `false` if \a contents is malformed.
+  static bool ParsePressure(const std::string& contents,
+                            MemoryPressure* pressure);
+
+ private:
+  base::FilePath proc_path_;
+  MemoryPressure cached_;
+  uint64_t cache_nanoseconds_;
+  uint64_t cache_time_;
+  bool cache_valid_;
+
+  DISALLOW_COPY_AND_ASSIGN(MemoryPressureReader);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_LINUX_MEMORY_PRESSURE_H_
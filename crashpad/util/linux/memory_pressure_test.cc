@@ -0,0 +1,160 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/linux/memory_pressure.h"
+
+#include <sys/stat.h>
+
+#include <string>
+
+#include "gtest/gtest.h"
+#include "test/errors.h"
+#include "test/scoped_temp_dir.h"
+#include "util/file/file_io.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+constexpr char kMemInfo[] =
+    "MemTotal:        8000000 kB\n"
+    "MemFree:          500000 kB\n"
+    "MemAvailable:    2000000 kB\n"
+    "Buffers:          100000 kB\n"
+    "Cached:          1400000 kB\n";
+
+constexpr char kPressure[] =
+    "some avg10=12.50 avg60=3.00 avg300=1.00 total=123456\n"
+    "full avg10=0.75 avg60=0.10 avg300=0.00 total=4567\n";
+
+void WriteTestFile(const base::FilePath& path, const std::string& contents) {
+  ScopedFileHandle handle(LoggingOpenFileForWrite(
+      path, FileWriteMode::kTruncateOrCreate, FilePermissions::kOwnerOnly));
+  ASSERT_TRUE(handle.is_valid());
+  ASSERT_TRUE(LoggingWriteFile(handle.get(), contents.data(), contents.size()));
+}
+
+TEST(MemoryPressure, ParseMemInfo) {
+  MemoryPressure pressure;
+  ASSERT_TRUE(MemoryPressureReader::ParseMemInfo(kMemInfo, &pressure));
+  EXPECT_EQ(pressure.total_bytes, 8000000ull * 1024);
+  EXPECT_EQ(pressure.available_bytes, 2000000ull * 1024);
+}
+
+TEST(MemoryPressure, ParseMemInfoWithoutMemAvailable) {
+  MemoryPressure pressure;
+  ASSERT_TRUE(MemoryPressureReader::ParseMemInfo(
+      "MemTotal:        8000000 kB\n"
+      "MemFree:          500000 kB\n",
+      &pressure));
+  EXPECT_EQ(pressure.total_bytes, 8000000ull * 1024);
+  EXPECT_EQ(pressure.available_bytes, 500000ull * 1024);
+}
+
+TEST(MemoryPressure, ParseMemInfoMalformed) {
+  MemoryPressure pressure;
+  EXPECT_FALSE(MemoryPressureReader::ParseMemInfo("", &pressure));
+  EXPECT_FALSE(MemoryPressureReader::ParseMemInfo(
+      "MemTotal:        8000000 kB\n", &pressure));
+  EXPECT_FALSE(MemoryPressureReader::ParseMemInfo(
+      "MemTotal:        8000000\n"
+      "MemAvailable:    2000000 kB\n",
+      &pressure));
+}
+
+TEST(MemoryPressure, ParsePressure) {
+  MemoryPressure pressure;
+  ASSERT_TRUE(MemoryPressureReader::ParsePressure(kPressure, &pressure));
+  EXPECT_TRUE(pressure.has_pressure_stall_information);
+  EXPECT_EQ(pressure.some_avg10, 12.5);
+  EXPECT_EQ(pressure.full_avg10, 0.75);
+
+  EXPECT_FALSE(MemoryPressureReader::ParsePressure("some avg10=x\n",
+                                                   &pressure));
+  EXPECT_FALSE(pressure.has_pressure_stall_information);
+}
+
+TEST(MemoryPressureReader, FakeProc) {
+  ScopedTempDir temp_dir;
+  const base::FilePath proc = temp_dir.path();
+  ASSERT_NO_FATAL_FAILURE(
+      WriteTestFile(proc.Append(FILE_PATH_LITERAL("meminfo")), kMemInfo));
+
+  // Without pressure stall information.
+  {
+    MemoryPressureReader reader(proc, 0);
+    MemoryPressure pressure;
+    ASSERT_TRUE(reader.Read(&pressure));
+    EXPECT_EQ(pressure.available_bytes, 2000000ull * 1024);
+    EXPECT_FALSE(pressure.has_pressure_stall_information);
+  }
+
+  const base::FilePath pressure_dir =
+      proc.Append(FILE_PATH_LITERAL("pressure"));
+  ASSERT_EQ(mkdir(pressure_dir.value().c_str(), 0700), 0)
+      << ErrnoMessage("mkdir");
+  ASSERT_NO_FATAL_FAILURE(WriteTestFile(
+      pressure_dir.Append(FILE_PATH_LITERAL("memory")), kPressure));
+
+  MemoryPressureReader reader(proc, 0);
+  MemoryPressure pressure;
+  ASSERT_TRUE(reader.Read(&pressure));
+  EXPECT_TRUE(pressure.has_pressure_stall_information);
+  EXPECT_EQ(pressure.some_avg10, 12.5);
+}
+
+TEST(MemoryPressureReader, Cached) {
+  ScopedTempDir temp_dir;
+  const base::FilePath proc = temp_dir.path();
+  const base::FilePath meminfo = proc.Append(FILE_PATH_LITERAL("meminfo"));
+  ASSERT_NO_FATAL_FAILURE(WriteTestFile(meminfo, kMemInfo));
+
+  MemoryPressureReader reader(proc,
+                              MemoryPressureReader::kDefaultCacheNanoseconds *
+                                  3600);
+  MemoryPressure pressure;
+  ASSERT_TRUE(reader.Read(&pressure));
+  EXPECT_EQ(pressure.available_bytes, 2000000ull * 1024);
+
+  // The file is not reread while the reading is cached.
+  ASSERT_NO_FATAL_FAILURE(WriteTestFile(
+      meminfo,
+      "MemTotal:        8000000 kB\n"
+      "MemAvailable:     100000 kB\n"));
+  ASSERT_TRUE(reader.Read(&pressure));
+  EXPECT_EQ(pressure.available_bytes, 2000000ull * 1024);
+
+  MemoryPressureReader uncached_reader(proc, 0);
+  ASSERT_TRUE(uncached_reader.Read(&pressure));
+  EXPECT_EQ(pressure.available_bytes, 100000ull * 1024);
+}
+
+TEST(MemoryPressureReader, MissingMemInfo) {
+  ScopedTempDir temp_dir;
+  MemoryPressureReader reader(temp_dir.path(), 0);
+  MemoryPressure pressure;
+  EXPECT_FALSE(reader.Read(&pressure));
+}
+
+TEST(MemoryPressureReader, Proc) {
+  MemoryPressureReader reader;
+  MemoryPressure pressure;
+  ASSERT_TRUE(reader.Read(&pressure));
+  EXPECT_GT(pressure.total_bytes, 0u);
+  EXPECT_LE(pressure.available_bytes, pressure.total_bytes);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
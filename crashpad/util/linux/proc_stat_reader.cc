@@ -20,7 +20,9 @@
 
 #include "base/files/file_path.h"
 #include "base/logging.h"
+#include "base/strings/stringprintf.h"
 #include "util/file/file_io.h"
+#include "util/linux/ptrace_connection.h"
 #include "util/misc/lexing.h"
 
 namespace crashpad {
@@ -60,25 +62,31 @@ ProcStatReader::~ProcStatReader() {}
 
 bool ProcStatReader::Initialize(pid_t tid) {
   INITIALIZATION_STATE_SET_INITIALIZING(initialized_);
-  if (!ReadFile(tid)) {
+  if (!ReadFile(tid) || !FindThirdColumn()) {
     return false;
   }
 
-  // The first column is process ID and the second column is the executable name
-  // in parentheses. This class only cares about columns after the second, so
-  // find the start of the third here and save it for later.
-  // The executable name may have parentheses itself, so find the end of the
-  // second column by working backwards to find the last closing parens.
-  size_t stat_pos = contents_.rfind(')');
-  if (stat_pos == std::string::npos) {
-    LOG(ERROR) << "format error";
+  INITIALIZATION_STATE_SET_VALID(initialized_);
+  return true;
+}
+
+bool ProcStatReader::Initialize(PtraceConnection* connection, pid_t tid) {
+  INITIALIZATION_STATE_SET_INITIALIZING(initialized_);
+  if (!connection->ReadFileContents(
+          base::FilePath(ThreadStatPath(connection->GetProcessID(), tid)),
+          &contents_) ||
+      !FindThirdColumn()) {
     return false;
   }
 
-  third_column_position_ = contents_.find(' ', stat_pos);
-  if (third_column_position_ == std::string::npos ||
-      ++third_column_position_ >= contents_.size()) {
-    LOG(ERROR) << "format error";
+  INITIALIZATION_STATE_SET_VALID(initialized_);
+  return true;
+}
+
+bool ProcStatReader::InitializeWithContents(const std::string& contents) {
+  INITIALIZATION_STATE_SET_INITIALIZING(initialized_);
+  contents_ = contents;
+  if (!FindThirdColumn()) {
     return false;
   }
 
@@ -86,6 +94,11 @@ bool ProcStatReader::Initialize(pid_t tid) {
   return true;
 }
 
+// static
+std::string ProcStatReader::ThreadStatPath(pid_t pid, pid_t tid) {
+  return base::StringPrintf("/proc/%d/task/%d/stat", pid, tid);
+}
+
 bool ProcStatReader::UserCPUTime(timeval* user_time) const {
   INITIALIZATION_STATE_DCHECK_VALID(initialized_);
   return ReadTimeAtIndex(13, user_time);
@@ -125,6 +138,34 @@ bool ProcStatReader::StartTime(timeval* start_time) const {
   return true;
 }
 
+bool ProcStatReader::State(char* state) const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  const char* state_ptr;
+  if (!FindColumn(2, &state_ptr)) {
+    return false;
+  }
+  *state = *state_ptr;
+  return true;
+}
+
+bool ProcStatReader::Scheduling(int* policy,
+                                int* static_priority,
+                                int* nice_value) const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  int local_policy;
+  int local_static_priority;
+  int local_nice_value;
+  if (!ReadIntAtIndex(40, &local_policy) ||
+      !ReadIntAtIndex(39, &local_static_priority) ||
+      !ReadIntAtIndex(18, &local_nice_value)) {
+    return false;
+  }
+  *policy = local_policy;
+  *static_priority = local_static_priority;
+  *nice_value = local_nice_value;
+  return true;
+}
+
 bool ProcStatReader::ReadFile(pid_t tid) {
   char path[32];
   snprintf(path, arraysize(path), "/proc/%d/stat", tid);
@@ -134,6 +175,27 @@ bool ProcStatReader::ReadFile(pid_t tid) {
   return true;
 }
 
+bool ProcStatReader::FindThirdColumn() {
+  // The first column is process ID and the second column is the executable name
+  // in parentheses. This class only cares about columns after the second, so
+  // find the start of the third here and save it for later.
+  // The executable name may have parentheses itself, so find the end of the
+  // second column by working backwards to find the last closing parens.
+  size_t stat_pos = contents_.rfind(')');
+  if (stat_pos == std::string::npos) {
+    LOG(ERROR) << "format error";
+    return false;
+  }
+
+  third_column_position_ = contents_.find(' ', stat_pos);
+  if (third_column_position_ == std::string::npos ||
+      ++third_column_position_ >= contents_.size()) {
+    LOG(ERROR) << "format error";
+    return false;
+  }
+  return true;
+}
+
 bool ProcStatReader::FindColumn(int col_index, const char** column) const {
   size_t position = third_column_position_;
   for (int index = 2; index < col_index; ++index) {
@@ -151,6 +213,19 @@ bool ProcStatReader::FindColumn(int col_index, const char** column) const {
   return true;
 }
 
+bool ProcStatReader::ReadIntAtIndex(int index, int* value) const {
+  const char* value_ptr;
+  if (!FindColumn(index, &value_ptr)) {
+    return false;
+  }
+
+  if (!AdvancePastNumber<int>(&value_ptr, value)) {
+    LOG(ERROR) << "format error";
+    return false;
+  }
+  return true;
+}
+
 bool ProcStatReader::ReadTimeAtIndex(int index, timeval* time_val) const {
   const char* ticks_ptr;
   if (!FindColumn(index, &ticks_ptr)) {
@@ -26,6 +26,8 @@
 
 namespace crashpad {
 
+class PtraceConnection;
+
 //! \brief Reads the /proc/[pid]/stat file for a thread.
 class ProcStatReader {
  public:
@@ -39,6 +41,30 @@ class ProcStatReader {
   //! \param[in] tid The thread ID to read the stat file for.
   bool Initialize(pid_t tid);
 
+  //! \brief Initializes the reader, reading the stat file through \a
+  //!     connection.
+  //!
+  //! This method must be successfully called before calling any other, unless
+  //! another Initialize() method is called instead.
+  //!
+  //! \param[in] connection A connection to the process containing \a tid.
+  //! \param[in] tid The thread ID to read the stat file for.
+  bool Initialize(PtraceConnection* connection, pid_t tid);
+
+  //! \brief Initializes the reader with the contents of a stat file that has
+  //!     already been read, such as by PtraceConnection::ReadFilesContents().
+  //!
+  //! This method must be successfully called before calling any other, unless
+  //! another Initialize() method is called instead.
+  //!
+  //! \param[in] contents The contents of the stat file.
+  bool InitializeWithContents(const std::string& contents);
+
+  //! \brief Returns the path of the stat file for thread \a tid in process \a
+  //!     pid, which is within `/proc/[pid]` as required by
+  //!     PtraceConnection::ReadFileContents().
+  static std::string ThreadStatPath(pid_t pid, pid_t tid);
+
   //! \brief Determines the time the thread has spent executing in user mode.
   //!
   //! \param[out] user_time The time spent executing in user mode.
@@ -63,9 +89,35 @@ class ProcStatReader {
   //!     a message logged.
   bool StartTime(timeval* start_time) const;
 
+  //! \brief Determines the target thread’s state.
+  //!
+  //! \param[out] state The single-character state code, such as `'R'` for
+  //!     running or `'T'` for stopped. See `proc(5)`.
+  //!
+  //! \return `true` on success, with \a state set. Otherwise, `false` with a
+  //!     message logged.
+  bool State(char* state) const;
+
+  //! \brief Determines the target thread’s scheduling parameters.
+  //!
+  //! These are the values that `sched_getscheduler()`, `sched_getparam()`,
+  //! and `getpriority()` would return for the thread, but they are read from
+  //! the stat file so that they are available wherever the file is.
+  //!
+  //! \param[out] policy The scheduling policy, such as `SCHED_OTHER`.
+  //! \param[out] static_priority The real-time scheduling priority, which is
+  //!     `0` for threads not scheduled with a real-time policy.
+  //! \param[out] nice_value The nice value, from `-20` to `19`.
+  //!
+  //! \return `true` on success, with all of the values set. Otherwise,
+  //!     `false` with a message logged.
+  bool Scheduling(int* policy, int* static_priority, int* nice_value) const;
+
  private:
   bool ReadFile(pid_t tid);
+  bool FindThirdColumn();
   bool FindColumn(int index, const char** column) const;
+  bool ReadIntAtIndex(int index, int* value) const;
   bool ReadTimeAtIndex(int index, timeval* time_val) const;
 
   std::string contents_;
@@ -14,12 +14,16 @@
 
 #include "util/linux/proc_stat_reader.h"
 
+#include <errno.h>
+#include <sched.h>
+#include <sys/resource.h>
 #include <sys/syscall.h>
 #include <time.h>
 #include <unistd.h>
 
 #include "base/logging.h"
 #include "gtest/gtest.h"
+#include "test/errors.h"
 #include "util/thread/thread.h"
 
 namespace crashpad {
@@ -90,6 +94,30 @@ TEST(ProcStatReader, Threads) {
       thread_time.tv_usec);
 }
 
+TEST(ProcStatReader, Scheduling) {
+  ProcStatReader stat;
+  ASSERT_TRUE(stat.Initialize(gettid()));
+
+  int policy;
+  int static_priority;
+  int nice_value;
+  ASSERT_TRUE(stat.Scheduling(&policy, &static_priority, &nice_value));
+
+  int expected_policy = sched_getscheduler(0);
+  ASSERT_GE(expected_policy, 0) << ErrnoMessage("sched_getscheduler");
+  EXPECT_EQ(policy, expected_policy & ~SCHED_RESET_ON_FORK);
+
+  sched_param param;
+  ASSERT_EQ(sched_getparam(0, &param), 0) << ErrnoMessage("sched_getparam");
+  EXPECT_EQ(static_priority, param.sched_priority);
+
+  errno = 0;
+  int expected_nice_value = getpriority(PRIO_PROCESS, 0);
+  ASSERT_FALSE(expected_nice_value == -1 && errno)
+      << ErrnoMessage("getpriority");
+  EXPECT_EQ(nice_value, expected_nice_value);
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace crashpad
@@ -0,0 +1,60 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/linux/proc_task_reader.h"
+
+#include <dirent.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "base/macros.h"
+#include "base/strings/string_number_conversions.h"
+#include "util/posix/scoped_dir.h"
+
+namespace crashpad {
+
+bool ReadThreadIDs(pid_t pid, std::vector<pid_t>* tids) {
+  char path[32];
+  snprintf(path, arraysize(path), "/proc/%d/task", pid);
+  DIR* dir = opendir(path);
+  if (!dir) {
+    PLOG(ERROR) << "opendir";
+    return false;
+  }
+  ScopedDIR scoped_dir(dir);
+
+  std::vector<pid_t> local_tids;
+  dirent* dir_entry;
+  while ((dir_entry = readdir(scoped_dir.get()))) {
+    if (strcmp(dir_entry->d_name, ".") == 0 ||
+        strcmp(dir_entry->d_name, "..") == 0) {
+      continue;
+    }
+    pid_t tid;
+    if (!base::StringToInt(dir_entry->d_name, &tid)) {
+      LOG(ERROR) << "format error";
+      continue;
+    }
+    local_tids.push_back(tid);
+  }
+
+  std::sort(local_tids.begin(), local_tids.end());
+  tids->swap(local_tids);
+  return true;
+}
+
+}  // namespace crashpad
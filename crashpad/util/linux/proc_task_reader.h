@@ -0,0 +1,34 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_LINUX_PROC_TASK_READER_H_
+#define CRASHPAD_UTIL_LINUX_PROC_TASK_READER_H_
+
+#include <sys/types.h>
+
+#include <vector>
+
+namespace crashpad {
+
+//! \brief Enumerates the thread IDs of a process by reading
+//!     `/proc/[pid]/task`.
+//!
+//! \param[in] pid The process ID of the process.
+//! \param[out] tids The thread IDs, in ascending order.
+//! \return `true` on success. `false` on failure with a message logged.
+bool ReadThreadIDs(pid_t pid, std::vector<pid_t>* tids);
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_LINUX_PROC_TASK_READER_H_
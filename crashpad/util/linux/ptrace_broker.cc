@@ -0,0 +1,401 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/linux/ptrace_broker.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "base/logging.h"
+#include "base/posix/eintr_wrapper.h"
+#include "base/strings/stringprintf.h"
+#include "util/file/file_io.h"
+#include "util/linux/proc_task_reader.h"
+#include "util/linux/thread_info.h"
+
+namespace crashpad {
+
+namespace {
+
+// Data this size or smaller is returned inline, where it costs less than
+// copying it through the shared memory.
+constexpr size_t kMaxInlineSize = 4096;
+
+// Limits on requests, so that a malformed request can’t exhaust the broker’s
+// memory.
+constexpr uint32_t kMaxOperations = 1 << 20;
+constexpr uint64_t kMaxReadMemorySize = 64 * 1024 * 1024;
+constexpr size_t kMaxReadFileSize = 16 * 1024 * 1024;
+
+// The most data carried inline in a response. Once a result would exceed it,
+// that operation fails with ENOBUFS instead, and the client may retry it in
+// another request. The first result carrying data inline is always allowed,
+// so that any one operation can succeed. Along with the limits above, this
+// bounds the response to the larger of this and kMaxReadMemorySize, plus a
+// PtraceBrokerResult for each operation.
+constexpr size_t kMaxInlineResponseSize = 16 * 1024 * 1024;
+
+// Returns the errno value for a failed call, which may not have set errno.
+int ErrorFromErrno() {
+  return errno ? errno : EINVAL;
+}
+
+// Returns whether |path|, relative to /proc/[pid], may be read on behalf of
+// the client. Only files directly within /proc/[pid] or
+// /proc/[pid]/task/[tid] are allowed, so that links such as /proc/[pid]/root
+// and /proc/[pid]/fd can’t be used to reach arbitrary files.
+bool IsAllowedRelativePath(const std::string& path) {
+  std::string name = path;
+  if (name.compare(0, 5, "task/") == 0) {
+    const size_t tid_end = name.find('/', 5);
+    if (tid_end == std::string::npos || tid_end == 5) {
+      return false;
+    }
+    for (size_t index = 5; index < tid_end; ++index) {
+      if (name[index] < '0' || name[index] > '9') {
+        return false;
+      }
+    }
+    name = name.substr(tid_end + 1);
+  }
+  return !name.empty() && name != "." && name != ".." &&
+         name.find('/') == std::string::npos;
+}
+
+}  // namespace
+
+PtraceBroker::PtraceBroker()
+    : attachments_(),
+      ptracer_(),
+      response_(),
+      mem_fd_(),
+      file_root_(),
+      shared_memory_(nullptr),
+      shared_memory_size_(0),
+      shared_memory_used_(0),
+      inline_response_size_(0),
+      sock_(-1),
+      pid_(-1),
+      ptracer_initialized_(false),
+      initialized_() {}
+
+PtraceBroker::~PtraceBroker() {}
+
+bool PtraceBroker::Initialize(int sock,
+                              pid_t pid,
+                              void* shared_memory,
+                              size_t shared_memory_size) {
+  INITIALIZATION_STATE_SET_INITIALIZING(initialized_);
+
+  const std::string mem_path = base::StringPrintf("/proc/%d/mem", pid);
+  mem_fd_.reset(
+      HANDLE_EINTR(open(mem_path.c_str(), O_RDONLY | O_NOCTTY | O_CLOEXEC)));
+  if (!mem_fd_.is_valid()) {
+    PLOG(ERROR) << "open";
+    return false;
+  }
+
+  sock_ = sock;
+  pid_ = pid;
+  file_root_ = base::StringPrintf("/proc/%d/", pid);
+  shared_memory_ = static_cast<char*>(shared_memory);
+  shared_memory_size_ = shared_memory_size;
+
+  INITIALIZATION_STATE_SET_VALID(initialized_);
+  return true;
+}
+
+bool PtraceBroker::Run() {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+
+  while (true) {
+    PtraceBrokerRequestHeader header;
+    const FileOperationResult rv = ReadFile(sock_, &header, sizeof(header));
+    if (rv == 0) {
+      return true;
+    }
+    if (rv < 0) {
+      PLOG(ERROR) << "read";
+      return false;
+    }
+    if (static_cast<size_t>(rv) < sizeof(header) &&
+        !LoggingReadFileExactly(sock_,
+                                reinterpret_cast<char*>(&header) + rv,
+                                sizeof(header) - rv)) {
+      return false;
+    }
+
+    if (!HandleRequest(header)) {
+      return false;
+    }
+  }
+}
+
+bool PtraceBroker::HandleRequest(const PtraceBrokerRequestHeader& header) {
+  if (header.version != PtraceBrokerRequestHeader::kVersion) {
+    LOG(ERROR) << "version mismatch " << header.version;
+    return false;
+  }
+  if (header.operation_count > kMaxOperations) {
+    LOG(ERROR) << "too many operations " << header.operation_count;
+    return false;
+  }
+
+  response_.clear();
+  shared_memory_used_ = 0;
+  inline_response_size_ = 0;
+
+  for (uint32_t index = 0; index < header.operation_count; ++index) {
+    PtraceBrokerOperation operation;
+    if (!LoggingReadFileExactly(sock_, &operation, sizeof(operation))) {
+      return false;
+    }
+
+    switch (operation.type) {
+      case PtraceBrokerOperation::kAttach: {
+        // Only threads of the target process may be attached.
+        const std::string task_path =
+            base::StringPrintf("%stask/%d", file_root_.c_str(), operation.tid);
+        if (operation.tid <= 0 || access(task_path.c_str(), F_OK) != 0) {
+          LOG(ERROR) << "thread " << operation.tid << " not in process "
+                     << pid_;
+          AppendFailure(ESRCH);
+          break;
+        }
+
+        std::unique_ptr<ScopedPtraceAttach> attach(new ScopedPtraceAttach());
+        errno = 0;
+        if (!attach->ResetAttach(operation.tid)) {
+          AppendFailure(ErrorFromErrno());
+          break;
+        }
+        attachments_.push_back(attach.release());
+        AppendData(nullptr, 0);
+        break;
+      }
+
+      case PtraceBrokerOperation::kIs64Bit:
+      case PtraceBrokerOperation::kGetThreadInfo: {
+        errno = 0;
+        if (!ptracer_initialized_) {
+          ptracer_initialized_ = ptracer_.Initialize(pid_);
+          if (!ptracer_initialized_) {
+            AppendFailure(ErrorFromErrno());
+            break;
+          }
+        }
+
+        if (operation.type == PtraceBrokerOperation::kIs64Bit) {
+          const char is_64_bit = ptracer_.Is64Bit();
+          AppendData(&is_64_bit, sizeof(is_64_bit));
+          break;
+        }
+
+        ThreadInfo info;
+        if (!ptracer_.GetThreadInfo(operation.tid, &info)) {
+          AppendFailure(ErrorFromErrno());
+          break;
+        }
+        AppendData(&info, sizeof(info));
+        break;
+      }
+
+      case PtraceBrokerOperation::kThreads: {
+        std::vector<pid_t> tids;
+        errno = 0;
+        if (!ReadThreadIDs(pid_, &tids)) {
+          AppendFailure(ErrorFromErrno());
+          break;
+        }
+        std::vector<int32_t> tids_32(tids.begin(), tids.end());
+        AppendData(tids_32.data(), tids_32.size() * sizeof(tids_32[0]));
+        break;
+      }
+
+      case PtraceBrokerOperation::kReadFile: {
+        if (operation.size > PATH_MAX) {
+          LOG(ERROR) << "path too long " << operation.size;
+          return false;
+        }
+        std::string path(operation.size, '\0');
+        if (!LoggingReadFileExactly(sock_, &path[0], path.size())) {
+          return false;
+        }
+
+        if (path.compare(0, file_root_.size(), file_root_) != 0 ||
+            !IsAllowedRelativePath(path.substr(file_root_.size()))) {
+          LOG(ERROR) << "access to " << path << " denied";
+          AppendFailure(EACCES);
+          break;
+        }
+
+        // Links within /proc/[pid], such as exe, are not followed.
+        ScopedFileHandle handle(HANDLE_EINTR(
+            open(path.c_str(), O_RDONLY | O_NOCTTY | O_NOFOLLOW | O_CLOEXEC)));
+        if (!handle.is_valid()) {
+          const int error = errno;
+          PLOG(ERROR) << "open " << path;
+          AppendFailure(error);
+          break;
+        }
+
+        // One byte more than the limit is read, to find files that exceed it.
+        std::string contents;
+        char buffer[4096];
+        FileOperationResult rv;
+        do {
+          rv = ReadFile(
+              handle.get(),
+              buffer,
+              std::min(sizeof(buffer), kMaxReadFileSize + 1 - contents.size()));
+          if (rv > 0) {
+            contents.append(buffer, rv);
+          }
+        } while (rv > 0 && contents.size() <= kMaxReadFileSize);
+        if (contents.size() > kMaxReadFileSize) {
+          LOG(ERROR) << "file too large " << path;
+          AppendFailure(EFBIG);
+          break;
+        }
+        if (rv < 0) {
+          const int error = errno;
+          PLOG(ERROR) << "read " << path;
+          AppendFailure(error);
+          break;
+        }
+        AppendData(contents.data(), contents.size());
+        break;
+      }
+
+      case PtraceBrokerOperation::kReadMemory:
+        if (operation.size > kMaxReadMemorySize) {
+          LOG(ERROR) << "read too large " << operation.size;
+          AppendFailure(EINVAL);
+          break;
+        }
+        AppendMemory(operation.address, operation.size);
+        break;
+
+      default:
+        LOG(ERROR) << "unknown operation " << operation.type;
+        return false;
+    }
+  }
+
+  return LoggingWriteFile(sock_, response_.data(), response_.size());
+}
+
+void PtraceBroker::AppendFailure(int error) {
+  PtraceBrokerResult result = {};
+  result.error = error;
+  result.location = PtraceBrokerResult::kInline;
+  response_.append(reinterpret_cast<const char*>(&result), sizeof(result));
+}
+
+bool PtraceBroker::FitsInShared(uint64_t size) const {
+  return size > kMaxInlineSize &&
+         size <= shared_memory_size_ - shared_memory_used_;
+}
+
+bool PtraceBroker::FitsInline(uint64_t size) const {
+  return size == 0 || inline_response_size_ == 0 ||
+         (inline_response_size_ <= kMaxInlineResponseSize &&
+          size <= kMaxInlineResponseSize - inline_response_size_);
+}
+
+void PtraceBroker::AppendData(const void* data, size_t size) {
+  PtraceBrokerResult result = {};
+  result.size = size;
+  if (FitsInShared(size)) {
+    result.location = PtraceBrokerResult::kSharedMemory;
+    result.offset = shared_memory_used_;
+    memcpy(shared_memory_ + shared_memory_used_, data, size);
+    shared_memory_used_ += size;
+    response_.append(reinterpret_cast<const char*>(&result), sizeof(result));
+    return;
+  }
+
+  if (!FitsInline(size)) {
+    AppendFailure(ENOBUFS);
+    return;
+  }
+
+  result.location = PtraceBrokerResult::kInline;
+  response_.append(reinterpret_cast<const char*>(&result), sizeof(result));
+  response_.append(static_cast<const char*>(data), size);
+  inline_response_size_ += size;
+}
+
+void PtraceBroker::AppendMemory(uint64_t address, uint64_t size) {
+  const size_t result_position = response_.size();
+  PtraceBrokerResult result = {};
+  char* destination;
+  if (FitsInShared(size)) {
+    result.location = PtraceBrokerResult::kSharedMemory;
+    result.offset = shared_memory_used_;
+    destination = shared_memory_ + shared_memory_used_;
+    response_.resize(result_position + sizeof(result));
+  } else if (FitsInline(size)) {
+    result.location = PtraceBrokerResult::kInline;
+    response_.resize(result_position + sizeof(result) + size);
+    destination = &response_[result_position + sizeof(result)];
+  } else {
+    AppendFailure(ENOBUFS);
+    return;
+  }
+
+  // Memory is read directly into its destination. A short read means that
+  // the memory following what was read couldn’t be read.
+  size_t bytes_read = 0;
+  int error = 0;
+  while (bytes_read < size) {
+    const ssize_t rv = HANDLE_EINTR(pread64(mem_fd_.get(),
+                                            destination + bytes_read,
+                                            size - bytes_read,
+                                            address + bytes_read));
+    if (rv < 0) {
+      error = errno;
+      break;
+    }
+    if (rv == 0) {
+      break;
+    }
+    bytes_read += rv;
+  }
+
+  // Unreadable memory is expected when the client probes, so it isn’t logged.
+  if (bytes_read == 0 && size > 0) {
+    response_.resize(result_position);
+    AppendFailure(error ? error : EIO);
+    return;
+  }
+
+  result.size = bytes_read;
+  if (result.location == PtraceBrokerResult::kSharedMemory) {
+    shared_memory_used_ += bytes_read;
+  } else {
+    response_.resize(result_position + sizeof(result) + bytes_read);
+    inline_response_size_ += bytes_read;
+  }
+  memcpy(&response_[result_position], &result, sizeof(result));
+}
+
+}  // namespace crashpad
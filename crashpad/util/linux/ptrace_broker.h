@@ -0,0 +1,218 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_LINUX_PTRACE_BROKER_H_
+#define CRASHPAD_UTIL_LINUX_PTRACE_BROKER_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <string>
+
+#include "base/files/scoped_file.h"
+#include "base/macros.h"
+#include "util/linux/ptracer.h"
+#include "util/linux/scoped_ptrace_attach.h"
+#include "util/misc/initialization_state_dcheck.h"
+#include "util/stdlib/pointer_container.h"
+
+namespace crashpad {
+
+#pragma pack(push, 1)
+
+//! \brief Precedes the operations in a request sent from a PtraceClient to a
+//!     PtraceBroker.
+//!
+//! Requests and responses are exchanged over a connected `AF_UNIX`
+//! `SOCK_STREAM` socket. A request is a PtraceBrokerRequestHeader followed by
+//! #operation_count PtraceBrokerOperation structures, each immediately followed
+//! by any data it carries. The response is a PtraceBrokerResult for each
+//! operation, in the same order, each immediately followed by any data it
+//! carries inline.
+struct PtraceBrokerRequestHeader {
+  //! \brief The expected value of #version. This should be changed whenever
+  //!     the request or response formats are modified incompatibly.
+  enum { kVersion = 1 };
+
+  //! \brief Version field to detect skew between client and broker. Should be
+  //!     set to #kVersion.
+  int32_t version;
+
+  //! \brief The number of operations in the request.
+  uint32_t operation_count;
+};
+
+//! \brief One operation in a request to a PtraceBroker.
+struct PtraceBrokerOperation {
+  //! \brief The operation to perform.
+  enum Type : uint32_t {
+    //! \brief Attaches to the thread #tid. The result carries no data.
+    kAttach = 0,
+
+    //! \brief Determines whether the process is 64-bit. The main thread must
+    //!     have been attached. The result carries one byte, which is nonzero
+    //!     for a 64-bit process.
+    kIs64Bit,
+
+    //! \brief Retrieves a ThreadInfo for the attached thread #tid. The result
+    //!     carries the ThreadInfo.
+    kGetThreadInfo,
+
+    //! \brief Lists the process’ threads. The result carries an `int32_t`
+    //!     thread ID for each thread.
+    kThreads,
+
+    //! \brief Reads the file whose path, #size bytes long and not
+    //!     `NUL`-terminated, follows this operation. The path must be directly
+    //!     within `/proc/[pid]` or `/proc/[pid]/task/[tid]`. The result carries
+    //!     the file’s contents. A file larger than the broker’s limit fails
+    //!     with `EFBIG`.
+    kReadFile,
+
+    //! \brief Reads #size bytes of memory at #address. The result carries the
+    //!     memory, stopping early if the memory following it couldn’t be read.
+    kReadMemory,
+  } type;
+
+  //! \brief The thread ID, for #kAttach and #kGetThreadInfo.
+  int32_t tid;
+
+  //! \brief The address of the memory to read, for #kReadMemory.
+  uint64_t address;
+
+  //! \brief The number of bytes of memory to read for #kReadMemory, and the
+  //!     length of the path for #kReadFile.
+  uint64_t size;
+};
+
+//! \brief The result of one operation, in a response from a PtraceBroker.
+struct PtraceBrokerResult {
+  //! \brief Where the data carried by the result is.
+  enum Location : uint32_t {
+    //! \brief The data immediately follows this structure.
+    kInline = 0,
+
+    //! \brief The data is in the shared memory, at #offset.
+    kSharedMemory,
+  };
+
+  //! \brief `0` on success. Otherwise, an `errno` value describing the
+  //!     failure. The broker logs failures other than memory that couldn’t be
+  //!     read. A result that failed carries no data.
+  //!
+  //! `ENOBUFS` means that the response had no room left for the data. The
+  //! operation may succeed if retried in another request.
+  int32_t error;
+
+  //! \brief Where the data is.
+  Location location;
+
+  //! \brief The number of bytes of data.
+  uint64_t size;
+
+  //! \brief The offset of the data in the shared memory, for #kSharedMemory.
+  uint64_t offset;
+};
+
+#pragma pack(pop)
+
+//! \brief Performs `ptrace`, memory, and `/proc` requests on behalf of a
+//!     PtraceClient in a process that can’t make them itself, such as a
+//!     handler running in a seccomp sandbox.
+//!
+//! Each request may contain many operations, so that the client can, for
+//! example, attach to every thread or read every region of memory it needs in
+//! a single round trip. Data larger than a page is returned through memory
+//! shared with the client rather than over the socket, as long as it fits.
+//! Data returned over the socket is limited per request, and operations past
+//! the limit fail with `ENOBUFS`.
+//!
+//! The broker serves a single target process. It only attaches to that
+//! process’ threads, and only reads files directly within `/proc/[pid]` or
+//! `/proc/[pid]/task/[tid]` for it, without following links.
+class PtraceBroker {
+ public:
+  PtraceBroker();
+  ~PtraceBroker();
+
+  //! \brief Initializes this object.
+  //!
+  //! This method must be successfully called before Run().
+  //!
+  //! \param[in] sock A socket connected to a PtraceClient. This object does
+  //!     not take ownership of it.
+  //! \param[in] pid The process ID of the target process.
+  //! \param[in] shared_memory Memory that is also mapped in the client’s
+  //!     process, such as a `MAP_SHARED | MAP_ANONYMOUS` mapping made before
+  //!     the broker’s process was forked. This object does not take
+  //!     ownership of it.
+  //! \param[in] shared_memory_size The size of \a shared_memory, which must be
+  //!     the same as the size passed to PtraceClient::Initialize().
+  //! \return `true` on success. `false` on failure with a message logged.
+  bool Initialize(int sock,
+                  pid_t pid,
+                  void* shared_memory,
+                  size_t shared_memory_size);
+
+  //! \brief Serves requests until the client closes the connection.
+  //!
+  //! Threads attached on behalf of the client remain attached until this
+  //! object is destroyed.
+  //!
+  //! \return `true` if the client closed the connection. `false` on failure,
+  //!     such as a malformed request, with a message logged.
+  bool Run();
+
+ private:
+  // Appends a result for a request that failed with |error| to the response.
+  void AppendFailure(int error);
+
+  // Returns whether a result carrying |size| bytes goes in the shared memory.
+  bool FitsInShared(uint64_t size) const;
+
+  // Returns whether a result carrying |size| bytes may be carried inline
+  // without exceeding the limit on the response’s size.
+  bool FitsInline(uint64_t size) const;
+
+  // Appends a result carrying |size| bytes of |data| to the response, or a
+  // failure with ENOBUFS if there’s no room left for it.
+  void AppendData(const void* data, size_t size);
+
+  // Reads memory directly into the shared memory if it fits there, and into
+  // the response otherwise, or appends a failure with ENOBUFS if there’s no
+  // room left for it.
+  void AppendMemory(uint64_t address, uint64_t size);
+
+  bool HandleRequest(const PtraceBrokerRequestHeader& header);
+
+  PointerVector<ScopedPtraceAttach> attachments_;
+  Ptracer ptracer_;
+  std::string response_;
+  base::ScopedFD mem_fd_;
+  std::string file_root_;
+  char* shared_memory_;  // weak
+  size_t shared_memory_size_;
+  size_t shared_memory_used_;
+  size_t inline_response_size_;
+  int sock_;
+  pid_t pid_;
+  bool ptracer_initialized_;
+  InitializationStateDcheck initialized_;
+
+  DISALLOW_COPY_AND_ASSIGN(PtraceBroker);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_LINUX_PTRACE_BROKER_H_
@@ -0,0 +1,305 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/linux/ptrace_broker.h"
+
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/files/scoped_file.h"
+#include "base/strings/stringprintf.h"
+#include "build/build_config.h"
+#include "gtest/gtest.h"
+#include "test/errors.h"
+#include "test/multiprocess.h"
+#include "util/file/file_io.h"
+#include "util/linux/proc_task_reader.h"
+#include "util/linux/ptrace_client.h"
+#include "util/misc/clock.h"
+#include "util/misc/from_pointer_cast.h"
+#include "util/posix/scoped_mmap.h"
+#include "util/thread/thread.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+constexpr size_t kSharedMemorySize = 1024 * 1024;
+constexpr size_t kBufferSize = 256 * 1024;
+constexpr char kString[] = "a string in the child";
+constexpr size_t kChildThreads = 3;
+
+char Pattern(size_t index) {
+  return static_cast<char>(index * 7 + index / 4096);
+}
+
+// Runs a PtraceBroker. Threads attached by the broker can only be examined and
+// detached by the thread that attached them, so the broker lives entirely on
+// this thread.
+class BrokerThread : public Thread {
+ public:
+  BrokerThread(int sock, pid_t pid, void* shared_memory)
+      : sock_(sock), pid_(pid), shared_memory_(shared_memory) {}
+  ~BrokerThread() override {}
+
+ private:
+  void ThreadMain() override {
+    PtraceBroker broker;
+    ASSERT_TRUE(broker.Initialize(sock_, pid_, shared_memory_,
+                                  kSharedMemorySize));
+    EXPECT_TRUE(broker.Run());
+  }
+
+  int sock_;
+  pid_t pid_;
+  void* shared_memory_;
+
+  DISALLOW_COPY_AND_ASSIGN(BrokerThread);
+};
+
+class SleepingThread : public Thread {
+ public:
+  explicit SleepingThread(const std::atomic<bool>* stop) : stop_(stop) {}
+  ~SleepingThread() override {}
+
+ private:
+  void ThreadMain() override {
+    while (!stop_->load()) {
+      SleepNanoseconds(1000 * 1000);
+    }
+  }
+
+  const std::atomic<bool>* stop_;  // weak
+
+  DISALLOW_COPY_AND_ASSIGN(SleepingThread);
+};
+
+class BrokerTest : public Multiprocess {
+ public:
+  BrokerTest() : Multiprocess() {}
+  ~BrokerTest() {}
+
+ private:
+  void MultiprocessParent() override {
+    VMAddress addresses[2];
+    CheckedReadFileExactly(ReadPipeHandle(), addresses, sizeof(addresses));
+    const VMAddress buffer_address = addresses[0];
+    const VMAddress string_address = addresses[1];
+    const pid_t pid = ChildPID();
+
+    int socks[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, socks), 0)
+        << ErrnoMessage("socketpair");
+    base::ScopedFD broker_sock(socks[0]);
+    base::ScopedFD client_sock(socks[1]);
+
+    ScopedMmap shared_memory;
+    ASSERT_TRUE(shared_memory.ResetMmap(nullptr,
+                                        kSharedMemorySize,
+                                        PROT_READ | PROT_WRITE,
+                                        MAP_SHARED | MAP_ANONYMOUS,
+                                        -1,
+                                        0));
+
+    BrokerThread broker_thread(broker_sock.get(), pid, shared_memory.addr());
+    broker_thread.Start();
+
+    {
+      PtraceClient client;
+      ASSERT_TRUE(client.Initialize(
+          client_sock.get(), pid, shared_memory.addr(), kSharedMemorySize));
+      EXPECT_EQ(client.GetProcessID(), pid);
+#if defined(ARCH_CPU_64_BITS)
+      EXPECT_TRUE(client.Is64Bit());
+#else
+      EXPECT_FALSE(client.Is64Bit());
+#endif
+
+      // Threads.
+      std::vector<pid_t> tids;
+      ASSERT_TRUE(client.Threads(&tids));
+      std::vector<pid_t> expected_tids;
+      ASSERT_TRUE(ReadThreadIDs(pid, &expected_tids));
+      EXPECT_EQ(tids, expected_tids);
+      ASSERT_EQ(tids.size(), kChildThreads + 1);
+
+      ThreadInfo info;
+      EXPECT_TRUE(client.GetThreadInfo(pid, &info));
+
+      std::vector<pid_t> other_tids;
+      for (pid_t tid : tids) {
+        if (tid != pid) {
+          other_tids.push_back(tid);
+        }
+      }
+      size_t round_trips = client.RoundTrips();
+      std::vector<ThreadInfo> infos;
+      std::vector<bool> succeeded;
+      client.AttachAndGetThreadInfos(other_tids, &infos, &succeeded);
+      EXPECT_EQ(client.RoundTrips(), round_trips + 1);
+      ASSERT_EQ(infos.size(), other_tids.size());
+      ASSERT_EQ(succeeded.size(), other_tids.size());
+      for (size_t index = 0; index < other_tids.size(); ++index) {
+        EXPECT_TRUE(succeeded[index]) << other_tids[index];
+      }
+
+      // A process other than the target can’t be attached.
+      EXPECT_FALSE(client.Attach(getpid()));
+
+      // Memory read in small pieces costs few round trips.
+      ProcessMemory* memory = client.Memory();
+      std::string string;
+      ASSERT_TRUE(memory->ReadCString(string_address, &string));
+      EXPECT_EQ(string, kString);
+
+      round_trips = client.RoundTrips();
+      for (size_t offset = 0; offset < 16 * 1024; offset += 64) {
+        char piece[64];
+        ASSERT_TRUE(
+            memory->Read(buffer_address + offset, sizeof(piece), piece));
+        for (size_t index = 0; index < sizeof(piece); ++index) {
+          ASSERT_EQ(piece[index], Pattern(offset + index)) << offset + index;
+        }
+      }
+      EXPECT_LE(client.RoundTrips(), round_trips + 2);
+
+      // Large reads in a batch are returned together through the shared
+      // memory and, once it is full, inline.
+      std::vector<char> copy(kBufferSize * 2);
+      std::vector<ProcessMemory::ReadRequest> requests;
+      for (size_t offset = 0; offset < copy.size(); offset += kBufferSize / 4) {
+        ProcessMemory::ReadRequest request;
+        request.address = buffer_address + offset % kBufferSize;
+        request.size = kBufferSize / 4;
+        request.buffer = &copy[offset];
+        requests.push_back(request);
+      }
+      round_trips = client.RoundTrips();
+      ASSERT_TRUE(memory->ReadBatch(requests));
+      EXPECT_EQ(client.RoundTrips(), round_trips + 1);
+      for (size_t index = 0; index < copy.size(); ++index) {
+        ASSERT_EQ(copy[index], Pattern(index % kBufferSize)) << index;
+      }
+
+      // A batch larger than the broker returns over the socket in one
+      // response is completed with further requests.
+      std::vector<char> large_copy(32 * 1024 * 1024);
+      requests.clear();
+      for (size_t offset = 0; offset < large_copy.size();
+           offset += kBufferSize) {
+        ProcessMemory::ReadRequest request;
+        request.address = buffer_address;
+        request.size = kBufferSize;
+        request.buffer = &large_copy[offset];
+        requests.push_back(request);
+      }
+      round_trips = client.RoundTrips();
+      ASSERT_TRUE(memory->ReadBatch(requests));
+      EXPECT_GT(client.RoundTrips(), round_trips + 1);
+      for (size_t index = 0; index < large_copy.size(); ++index) {
+        ASSERT_EQ(large_copy[index], Pattern(index % kBufferSize)) << index;
+      }
+
+      // Unmapped memory can’t be read.
+      char byte;
+      EXPECT_FALSE(memory->Read(0, sizeof(byte), &byte));
+      requests.resize(1);
+      requests[0].address = 0;
+      requests[0].size = 1;
+      requests[0].buffer = &byte;
+      EXPECT_FALSE(memory->ReadBatch(requests));
+
+      // Files.
+      const std::string proc = base::StringPrintf("/proc/%d/", pid);
+      std::string contents;
+      ASSERT_TRUE(client.ReadFileContents(base::FilePath(proc + "maps"),
+                                          &contents));
+      EXPECT_NE(contents.find("[stack]"), std::string::npos);
+
+      std::vector<base::FilePath> paths;
+      std::vector<std::string> expected_contents;
+      for (pid_t tid : tids) {
+        paths.push_back(base::FilePath(
+            base::StringPrintf("%stask/%d/comm", proc.c_str(), tid)));
+        expected_contents.push_back(std::string());
+        ASSERT_TRUE(LoggingReadEntireFile(paths.back(),
+                                          &expected_contents.back()));
+      }
+      std::vector<std::string> files_contents;
+      round_trips = client.RoundTrips();
+      ASSERT_TRUE(client.ReadFilesContents(paths, &files_contents));
+      EXPECT_EQ(client.RoundTrips(), round_trips + 1);
+      EXPECT_EQ(files_contents, expected_contents);
+
+      // Only files describing the target process can be read.
+      EXPECT_FALSE(client.ReadFileContents(base::FilePath("/proc/self/maps"),
+                                           &contents));
+      EXPECT_FALSE(client.ReadFileContents(
+          base::FilePath(proc + "root/proc/self/maps"), &contents));
+      EXPECT_FALSE(client.ReadFileContents(
+          base::FilePath(proc + "task/../maps"), &contents));
+      EXPECT_FALSE(
+          client.ReadFileContents(base::FilePath(proc + "exe"), &contents));
+    }
+
+    // The broker finishes when the client closes its socket.
+    client_sock.reset();
+    broker_thread.Join();
+
+    CheckedWriteFile(WritePipeHandle(), addresses, 1);
+  }
+
+  void MultiprocessChild() override {
+    std::unique_ptr<char[]> buffer(new char[kBufferSize]);
+    for (size_t index = 0; index < kBufferSize; ++index) {
+      buffer[index] = Pattern(index);
+    }
+
+    std::atomic<bool> stop(false);
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (size_t index = 0; index < kChildThreads; ++index) {
+      threads.push_back(std::unique_ptr<Thread>(new SleepingThread(&stop)));
+      threads.back()->Start();
+    }
+
+    const VMAddress addresses[2] = {FromPointerCast<VMAddress>(buffer.get()),
+                                    FromPointerCast<VMAddress>(kString)};
+    CheckedWriteFile(WritePipeHandle(), addresses, sizeof(addresses));
+
+    char c;
+    CheckedReadFileExactly(ReadPipeHandle(), &c, sizeof(c));
+
+    stop.store(true);
+    for (auto& thread : threads) {
+      thread->Join();
+    }
+  }
+
+  DISALLOW_COPY_AND_ASSIGN(BrokerTest);
+};
+
+TEST(PtraceBroker, Client) {
+  BrokerTest test;
+  test.Run();
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
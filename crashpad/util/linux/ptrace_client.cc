@@ -0,0 +1,500 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/linux/ptrace_client.h"
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "util/file/file_io.h"
+
+namespace crashpad {
+
+namespace {
+
+// Memory is fetched from the broker and cached in blocks of this size, starting
+// at a page boundary. Reads at least this large bypass the cache.
+constexpr size_t kCacheBlockSize = 64 * 1024;
+
+// The cache is emptied when it reaches this many blocks.
+constexpr size_t kMaxCachedBlocks = 64;
+
+// A limit on the data carried by a result, so that a malformed response can’t
+// exhaust this process’ memory.
+constexpr uint64_t kMaxResultSize = 256 * 1024 * 1024;
+
+PtraceBrokerOperation MakeOperation(PtraceBrokerOperation::Type type,
+                                    pid_t tid) {
+  PtraceBrokerOperation operation = {};
+  operation.type = type;
+  operation.tid = tid;
+  return operation;
+}
+
+PtraceBrokerOperation MakeReadMemoryOperation(VMAddress address, size_t size) {
+  PtraceBrokerOperation operation =
+      MakeOperation(PtraceBrokerOperation::kReadMemory, 0);
+  operation.address = address;
+  operation.size = size;
+  return operation;
+}
+
+}  // namespace
+
+PtraceClient::Call::Call()
+    : operation(), path(), buffer(nullptr), error(0), size(0), data() {}
+
+PtraceClient::Call::~Call() {}
+
+PtraceClient::PtraceClient()
+    : PtraceConnection(),
+      ProcessMemory::Source(),
+      memory_(),
+      cache_(),
+      shared_memory_(nullptr),
+      shared_memory_size_(0),
+      page_size_(getpagesize()),
+      round_trips_(0),
+      sock_(-1),
+      pid_(-1),
+      is_64_bit_(false),
+      initialized_() {}
+
+PtraceClient::~PtraceClient() {}
+
+bool PtraceClient::Initialize(int sock,
+                              pid_t pid,
+                              const void* shared_memory,
+                              size_t shared_memory_size) {
+  INITIALIZATION_STATE_SET_INITIALIZING(initialized_);
+  sock_ = sock;
+  pid_ = pid;
+  shared_memory_ = static_cast<const char*>(shared_memory);
+  shared_memory_size_ = shared_memory_size;
+
+  std::vector<Call> calls(2);
+  calls[0].operation = MakeOperation(PtraceBrokerOperation::kAttach, pid);
+  calls[1].operation = MakeOperation(PtraceBrokerOperation::kIs64Bit, pid);
+  if (!Transact(&calls)) {
+    return false;
+  }
+  if (calls[0].error) {
+    errno = calls[0].error;
+    PLOG(ERROR) << "broker attach";
+    return false;
+  }
+  if (calls[1].error) {
+    errno = calls[1].error;
+    PLOG(ERROR) << "broker Is64Bit";
+    return false;
+  }
+  if (calls[1].size != 1) {
+    LOG(ERROR) << "unexpected size " << calls[1].size;
+    return false;
+  }
+  is_64_bit_ = calls[1].data[0] != 0;
+
+  if (!memory_.InitializeWithSource(this)) {
+    return false;
+  }
+
+  INITIALIZATION_STATE_SET_VALID(initialized_);
+  return true;
+}
+
+pid_t PtraceClient::GetProcessID() {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  return pid_;
+}
+
+bool PtraceClient::Attach(pid_t tid) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  std::vector<Call> calls(1);
+  calls[0].operation = MakeOperation(PtraceBrokerOperation::kAttach, tid);
+  if (!Transact(&calls)) {
+    return false;
+  }
+  if (calls[0].error) {
+    errno = calls[0].error;
+    PLOG(ERROR) << "broker attach " << tid;
+    return false;
+  }
+  return true;
+}
+
+bool PtraceClient::Is64Bit() {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  return is_64_bit_;
+}
+
+bool PtraceClient::GetThreadInfo(pid_t tid, ThreadInfo* info) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  std::vector<Call> calls(1);
+  calls[0].operation =
+      MakeOperation(PtraceBrokerOperation::kGetThreadInfo, tid);
+  calls[0].operation.size = sizeof(*info);
+  calls[0].buffer = info;
+  if (!Transact(&calls)) {
+    return false;
+  }
+  if (calls[0].error) {
+    errno = calls[0].error;
+    PLOG(ERROR) << "broker GetThreadInfo " << tid;
+    return false;
+  }
+  if (calls[0].size != sizeof(*info)) {
+    LOG(ERROR) << "unexpected size " << calls[0].size;
+    return false;
+  }
+  return true;
+}
+
+void PtraceClient::AttachAndGetThreadInfos(const std::vector<pid_t>& tids,
+                                           std::vector<ThreadInfo>* infos,
+                                           std::vector<bool>* succeeded) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  infos->resize(tids.size());
+  succeeded->assign(tids.size(), false);
+
+  std::vector<Call> calls(tids.size() * 2);
+  for (size_t index = 0; index < tids.size(); ++index) {
+    calls[index * 2].operation =
+        MakeOperation(PtraceBrokerOperation::kAttach, tids[index]);
+    Call& get_thread_info = calls[index * 2 + 1];
+    get_thread_info.operation =
+        MakeOperation(PtraceBrokerOperation::kGetThreadInfo, tids[index]);
+    get_thread_info.operation.size = sizeof(ThreadInfo);
+    get_thread_info.buffer = &(*infos)[index];
+  }
+  if (!Transact(&calls)) {
+    return;
+  }
+
+  for (size_t index = 0; index < tids.size(); ++index) {
+    const Call& attach = calls[index * 2];
+    const Call& get_thread_info = calls[index * 2 + 1];
+    if (attach.error) {
+      errno = attach.error;
+      PLOG(ERROR) << "broker attach " << tids[index];
+      continue;
+    }
+    if (get_thread_info.error) {
+      errno = get_thread_info.error;
+      PLOG(ERROR) << "broker GetThreadInfo " << tids[index];
+      continue;
+    }
+    if (get_thread_info.size != sizeof(ThreadInfo)) {
+      LOG(ERROR) << "unexpected size " << get_thread_info.size;
+      continue;
+    }
+    (*succeeded)[index] = true;
+  }
+}
+
+bool PtraceClient::Threads(std::vector<pid_t>* threads) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  std::vector<Call> calls(1);
+  calls[0].operation = MakeOperation(PtraceBrokerOperation::kThreads, 0);
+  if (!Transact(&calls)) {
+    return false;
+  }
+  if (calls[0].error) {
+    errno = calls[0].error;
+    PLOG(ERROR) << "broker Threads";
+    return false;
+  }
+  if (calls[0].size % sizeof(int32_t) != 0) {
+    LOG(ERROR) << "unexpected size " << calls[0].size;
+    return false;
+  }
+
+  threads->resize(calls[0].size / sizeof(int32_t));
+  for (size_t index = 0; index < threads->size(); ++index) {
+    int32_t tid;
+    memcpy(&tid, &calls[0].data[index * sizeof(tid)], sizeof(tid));
+    (*threads)[index] = tid;
+  }
+  return true;
+}
+
+bool PtraceClient::ReadFileContents(const base::FilePath& path,
+                                    std::string* contents) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  std::vector<std::string> contents_vector;
+  if (!ReadFilesContents(std::vector<base::FilePath>(1, path),
+                         &contents_vector)) {
+    return false;
+  }
+  contents->swap(contents_vector[0]);
+  return true;
+}
+
+bool PtraceClient::ReadFilesContents(const std::vector<base::FilePath>& paths,
+                                     std::vector<std::string>* contents) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  std::vector<Call> calls(paths.size());
+  for (size_t index = 0; index < paths.size(); ++index) {
+    calls[index].operation =
+        MakeOperation(PtraceBrokerOperation::kReadFile, 0);
+    calls[index].path = paths[index].value();
+  }
+  if (!Transact(&calls)) {
+    return false;
+  }
+
+  contents->resize(paths.size());
+  for (size_t index = 0; index < paths.size(); ++index) {
+    if (calls[index].error) {
+      errno = calls[index].error;
+      PLOG(ERROR) << "broker read " << paths[index].value();
+      return false;
+    }
+    (*contents)[index].swap(calls[index].data);
+  }
+  return true;
+}
+
+ProcessMemory* PtraceClient::Memory() {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  return &memory_;
+}
+
+ssize_t PtraceClient::ReadUpTo(VMAddress address, size_t size, void* buffer) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  if (size >= kCacheBlockSize) {
+    return ReadUpToUncached(address, size, buffer);
+  }
+
+  char* buffer_c = static_cast<char*>(buffer);
+  size_t bytes_read = 0;
+  while (bytes_read < size) {
+    const VMAddress current = address + bytes_read;
+    VMAddress block_address;
+    const std::string* block = CachedBlock(current, &block_address);
+    if (!block) {
+      return bytes_read > 0 ? static_cast<ssize_t>(bytes_read) : -1;
+    }
+
+    const size_t offset = current - block_address;
+    const size_t copy_size =
+        std::min(size - bytes_read, block->size() - offset);
+    memcpy(buffer_c + bytes_read, &(*block)[offset], copy_size);
+    bytes_read += copy_size;
+
+    // The memory after a short block couldn’t be read.
+    if (block->size() < kCacheBlockSize &&
+        offset + copy_size == block->size()) {
+      break;
+    }
+  }
+  return bytes_read;
+}
+
+bool PtraceClient::ReadBatch(
+    const std::vector<ProcessMemory::ReadRequest>& requests) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  std::vector<Call> calls(requests.size());
+  for (size_t index = 0; index < requests.size(); ++index) {
+    calls[index].operation =
+        MakeReadMemoryOperation(requests[index].address, requests[index].size);
+    calls[index].buffer = requests[index].buffer;
+  }
+  if (!Transact(&calls)) {
+    return false;
+  }
+
+  for (size_t index = 0; index < requests.size(); ++index) {
+    if (calls[index].error) {
+      errno = calls[index].error;
+      PLOG(ERROR) << "broker read memory";
+      return false;
+    }
+    if (calls[index].size < requests[index].size) {
+      LOG(ERROR) << "short read";
+      return false;
+    }
+  }
+  return true;
+}
+
+ssize_t PtraceClient::ReadUpToUncached(VMAddress address,
+                                       size_t size,
+                                       void* buffer) {
+  std::vector<Call> calls(1);
+  calls[0].operation = MakeReadMemoryOperation(address, size);
+  calls[0].buffer = buffer;
+  if (!Transact(&calls)) {
+    errno = EIO;
+    return -1;
+  }
+  if (calls[0].error) {
+    errno = calls[0].error;
+    return -1;
+  }
+  return calls[0].size;
+}
+
+const std::string* PtraceClient::CachedBlock(VMAddress address,
+                                             VMAddress* block_address) {
+  auto iterator = cache_.upper_bound(address);
+  if (iterator != cache_.begin()) {
+    --iterator;
+    if (address - iterator->first < iterator->second.size()) {
+      *block_address = iterator->first;
+      return &iterator->second;
+    }
+  }
+
+  if (cache_.size() >= kMaxCachedBlocks) {
+    cache_.clear();
+  }
+
+  // Blocks start at the page containing |address|, because the memory before
+  // it may not be mapped.
+  const VMAddress page_address = address & ~VMAddress{page_size_ - 1};
+  std::vector<Call> calls(1);
+  calls[0].operation = MakeReadMemoryOperation(page_address, kCacheBlockSize);
+  if (!Transact(&calls)) {
+    errno = EIO;
+    return nullptr;
+  }
+  if (calls[0].error) {
+    errno = calls[0].error;
+    return nullptr;
+  }
+  if (address - page_address >= calls[0].data.size()) {
+    errno = EIO;
+    return nullptr;
+  }
+
+  // A new block may overlap blocks already cached. Those are replaced, so that
+  // lookups find the block containing an address.
+  cache_.erase(cache_.lower_bound(page_address),
+               cache_.lower_bound(page_address + calls[0].data.size()));
+  std::string& block = cache_[page_address];
+  block.swap(calls[0].data);
+  *block_address = page_address;
+  return &block;
+}
+
+bool PtraceClient::Transact(std::vector<Call>* calls) {
+  std::vector<Call*> pending;
+  for (Call& call : *calls) {
+    pending.push_back(&call);
+  }
+
+  // Calls that didn’t fit in a response are sent again. The broker always
+  // returns the first result with data, so each request makes progress.
+  while (true) {
+    if (!TransactOnce(pending)) {
+      return false;
+    }
+
+    std::vector<Call*> retry;
+    for (Call* call : pending) {
+      if (call->error == ENOBUFS) {
+        retry.push_back(call);
+      }
+    }
+    if (retry.empty() || retry.size() == pending.size()) {
+      return true;
+    }
+    pending.swap(retry);
+  }
+}
+
+bool PtraceClient::TransactOnce(const std::vector<Call*>& calls) {
+  ++round_trips_;
+
+  PtraceBrokerRequestHeader header;
+  header.version = PtraceBrokerRequestHeader::kVersion;
+  header.operation_count = calls.size();
+  std::string request(reinterpret_cast<const char*>(&header), sizeof(header));
+  for (Call* call : calls) {
+    if (call->operation.type == PtraceBrokerOperation::kReadFile) {
+      call->operation.size = call->path.size();
+    }
+    request.append(reinterpret_cast<const char*>(&call->operation),
+                   sizeof(call->operation));
+    if (call->operation.type == PtraceBrokerOperation::kReadFile) {
+      request.append(call->path);
+    }
+  }
+  if (!LoggingWriteFile(sock_, request.data(), request.size())) {
+    return false;
+  }
+
+  for (Call* call : calls) {
+    PtraceBrokerResult result;
+    if (!LoggingReadFileExactly(sock_, &result, sizeof(result))) {
+      return false;
+    }
+
+    call->error = result.error;
+    call->size = 0;
+    call->data.clear();
+    if (result.error) {
+      if (result.size != 0) {
+        LOG(ERROR) << "unexpected data with error";
+        return false;
+      }
+      continue;
+    }
+
+    // A buffer is only as large as the operation’s size.
+    if (result.size > kMaxResultSize ||
+        (call->buffer && result.size > call->operation.size)) {
+      LOG(ERROR) << "unexpected size " << result.size;
+      return false;
+    }
+
+    char* destination;
+    if (call->buffer) {
+      destination = static_cast<char*>(call->buffer);
+    } else {
+      call->data.resize(result.size);
+      destination = result.size ? &call->data[0] : nullptr;
+    }
+
+    switch (result.location) {
+      case PtraceBrokerResult::kInline:
+        if (result.size &&
+            !LoggingReadFileExactly(sock_, destination, result.size)) {
+          return false;
+        }
+        break;
+
+      case PtraceBrokerResult::kSharedMemory:
+        if (result.offset > shared_memory_size_ ||
+            result.size > shared_memory_size_ - result.offset) {
+          LOG(ERROR) << "shared memory out of range";
+          return false;
+        }
+        memcpy(destination, shared_memory_ + result.offset, result.size);
+        break;
+
+      default:
+        LOG(ERROR) << "unexpected location " << result.location;
+        return false;
+    }
+    call->size = result.size;
+  }
+  return true;
+}
+
+}  // namespace crashpad
@@ -0,0 +1,152 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_LINUX_PTRACE_CLIENT_H_
+#define CRASHPAD_UTIL_LINUX_PTRACE_CLIENT_H_
+
+#include <sys/types.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "util/linux/ptrace_broker.h"
+#include "util/linux/ptrace_connection.h"
+#include "util/misc/initialization_state_dcheck.h"
+#include "util/process/process_memory.h"
+
+namespace crashpad {
+
+//! \brief A PtraceConnection that makes its requests through a PtraceBroker in
+//!     another process.
+//!
+//! This is used when the current process can’t use `ptrace` or read
+//! `/proc/[pid]/mem` itself, such as when it is sandboxed.
+//!
+//! Memory read through Memory() in small pieces is fetched from the broker in
+//! larger blocks and cached, so that reading, for example, a string or a
+//! structure at a time doesn’t cost a round trip for each read. The target
+//! process must remain stopped while memory is read, as it does while its
+//! threads are attached.
+class PtraceClient : public PtraceConnection, public ProcessMemory::Source {
+ public:
+  PtraceClient();
+  ~PtraceClient() override;
+
+  //! \brief Initializes this object, attaching the main thread of the process
+  //!     whose process ID is \a pid.
+  //!
+  //! \param[in] sock A socket connected to a PtraceBroker serving the process.
+  //!     This object does not take ownership of it.
+  //! \param[in] pid The process ID of the process.
+  //! \param[in] shared_memory Memory that is also mapped in the broker’s
+  //!     process. See PtraceBroker::Initialize(). This object does not take
+  //!     ownership of it.
+  //! \param[in] shared_memory_size The size of \a shared_memory.
+  //! \return `true` on success. `false` on failure with a message logged.
+  bool Initialize(int sock,
+                  pid_t pid,
+                  const void* shared_memory,
+                  size_t shared_memory_size);
+
+  // PtraceConnection:
+
+  pid_t GetProcessID() override;
+  bool Attach(pid_t tid) override;
+  bool Is64Bit() override;
+  bool GetThreadInfo(pid_t tid, ThreadInfo* info) override;
+  void AttachAndGetThreadInfos(const std::vector<pid_t>& tids,
+                               std::vector<ThreadInfo>* infos,
+                               std::vector<bool>* succeeded) override;
+  bool Threads(std::vector<pid_t>* threads) override;
+  bool ReadFileContents(const base::FilePath& path,
+                        std::string* contents) override;
+  bool ReadFilesContents(const std::vector<base::FilePath>& paths,
+                         std::vector<std::string>* contents) override;
+  ProcessMemory* Memory() override;
+
+  // ProcessMemory::Source:
+
+  ssize_t ReadUpTo(VMAddress address, size_t size, void* buffer) override;
+  bool ReadBatch(const std::vector<ProcessMemory::ReadRequest>& requests)
+      override;
+
+  //! \brief Returns the number of requests made of the broker so far.
+  size_t RoundTrips() const { return round_trips_; }
+
+ private:
+  // An operation to send to the broker, and its result.
+  struct Call {
+    Call();
+    ~Call();
+
+    PtraceBrokerOperation operation;
+
+    // The path, for PtraceBrokerOperation::kReadFile.
+    std::string path;
+
+    // If not nullptr, the data is copied here instead of to data. It must be
+    // at least operation.size bytes long, and a result carrying more is
+    // rejected.
+    void* buffer;
+
+    // The error from PtraceBrokerResult.
+    int error;
+
+    // The number of bytes of data received.
+    size_t size;
+
+    // The data received, if buffer is nullptr.
+    std::string data;
+  };
+
+  // Sends |calls| to the broker and receives their results, using more than
+  // one request if they don’t all fit in one response. Returns false with a
+  // message logged if the broker couldn’t be reached or its response was
+  // malformed. Otherwise, the result of each call is in its error, size, and
+  // data or buffer.
+  bool Transact(std::vector<Call>* calls);
+
+  // Like Transact(), but sends |calls| in a single request. Calls that didn’t
+  // fit in the response fail with ENOBUFS.
+  bool TransactOnce(const std::vector<Call*>& calls);
+
+  // Reads memory with a single request, bypassing the cache.
+  ssize_t ReadUpToUncached(VMAddress address, size_t size, void* buffer);
+
+  // Returns the cached block of memory containing |address|, fetching it from
+  // the broker if necessary, and sets |block_address| to the block’s address.
+  // The block is shorter than the block size if not all of it could be read.
+  // Returns nullptr with errno set if the memory at |address| couldn’t be
+  // read.
+  const std::string* CachedBlock(VMAddress address, VMAddress* block_address);
+
+  ProcessMemory memory_;
+  std::map<VMAddress, std::string> cache_;
+  const char* shared_memory_;  // weak
+  size_t shared_memory_size_;
+  size_t page_size_;
+  size_t round_trips_;
+  int sock_;
+  pid_t pid_;
+  bool is_64_bit_;
+  InitializationStateDcheck initialized_;
+
+  DISALLOW_COPY_AND_ASSIGN(PtraceClient);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_LINUX_PTRACE_CLIENT_H_
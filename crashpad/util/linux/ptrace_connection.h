@@ -17,7 +17,12 @@
 
 #include <sys/types.h>
 
+#include <string>
+#include <vector>
+
+#include "base/files/file_path.h"
 #include "util/linux/thread_info.h"
+#include "util/process/process_memory.h"
 
 namespace crashpad {
 
@@ -45,6 +50,57 @@ class PtraceConnection {
   //! \param[out] info Information about the thread.
   //! \return `true` on success. `false` on failure with a message logged.
   virtual bool GetThreadInfo(pid_t tid, ThreadInfo* info) = 0;
+
+  //! \brief Attaches to several threads, as if by Attach(), and retrieves a
+  //!     ThreadInfo for each, as if by GetThreadInfo().
+  //!
+  //! A connection that forwards requests to another process makes all of the
+  //! requests in a single round trip.
+  //!
+  //! \param[in] tids The thread IDs of the threads, none of which may already
+  //!     be attached.
+  //! \param[out] infos A ThreadInfo for each thread in \a tids, in the same
+  //!     order.
+  //! \param[out] succeeded Whether each thread in \a tids, in the same order,
+  //!     was attached and had its ThreadInfo retrieved. Messages are logged
+  //!     for those that weren’t.
+  virtual void AttachAndGetThreadInfos(const std::vector<pid_t>& tids,
+                                       std::vector<ThreadInfo>* infos,
+                                       std::vector<bool>* succeeded) = 0;
+
+  //! \brief Lists the threads of the connected process.
+  //!
+  //! \param[out] threads The thread IDs of the process’ threads.
+  //! \return `true` on success. `false` on failure with a message logged.
+  virtual bool Threads(std::vector<pid_t>* threads) = 0;
+
+  //! \brief Reads the entire contents of a file describing the connected
+  //!     process.
+  //!
+  //! \param[in] path The path of the file, which must be within
+  //!     `/proc/[pid]` for the connected process.
+  //! \param[out] contents The contents of the file.
+  //! \return `true` on success. `false` on failure with a message logged.
+  virtual bool ReadFileContents(const base::FilePath& path,
+                                std::string* contents) = 0;
+
+  //! \brief Reads the entire contents of several files, as if by
+  //!     ReadFileContents().
+  //!
+  //! A connection that forwards requests to another process reads all of the
+  //! files in a single round trip.
+  //!
+  //! \param[in] paths The paths of the files.
+  //! \param[out] contents The contents of each file in \a paths, in the same
+  //!     order.
+  //! \return `true` if every file was read. `false` on failure with a message
+  //!     logged.
+  virtual bool ReadFilesContents(const std::vector<base::FilePath>& paths,
+                                 std::vector<std::string>* contents) = 0;
+
+  //! \brief Returns a ProcessMemory for the connected process, owned by this
+  //!     connection.
+  virtual ProcessMemory* Memory() = 0;
 };
 
 }  // namespace crashpad
@@ -0,0 +1,378 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/linux/ptrace_recording.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <iterator>
+
+#include "base/logging.h"
+
+namespace crashpad {
+
+namespace {
+
+#pragma pack(push, 1)
+
+// A recording is a Header, followed by each attach, ThreadInfo, thread, file,
+// and memory range in turn, as described by the structures below. A file or
+// memory range is followed by its data.
+struct Header {
+  enum : uint32_t {
+    kSignature = 'R' << 24 | 'P' << 16 | 'p' << 8 | 'C',
+    kVersion = 1,
+  };
+
+  uint32_t signature;
+  uint32_t version;
+
+  // ThreadInfo is recorded as it is laid out in memory, so a recording can
+  // only be replayed by a build with the same layout.
+  uint32_t thread_info_size;
+
+  int32_t pid;
+  uint8_t is_64_bit;
+  uint8_t have_threads;
+  uint32_t attach_count;
+  uint32_t thread_info_count;
+  uint32_t thread_count;
+  uint32_t file_count;
+  uint32_t memory_count;
+};
+
+struct AttachRecord {
+  int32_t tid;
+  uint8_t succeeded;
+};
+
+struct FileRecord {
+  uint32_t path_size;
+  uint8_t succeeded;
+  uint64_t contents_size;
+};
+
+struct MemoryRecord {
+  uint64_t address;
+  uint64_t size;
+};
+
+#pragma pack(pop)
+
+// A limit on the size of a single file or memory range, so that a malformed
+// recording can’t exhaust this process’ memory.
+constexpr uint64_t kMaxDataSize = 1024 * 1024 * 1024;
+
+bool ReadString(FileReaderInterface* reader, uint64_t size, std::string* data) {
+  if (size > kMaxDataSize) {
+    LOG(ERROR) << "record too large " << size;
+    return false;
+  }
+  data->resize(size);
+  return size == 0 || reader->ReadExactly(&(*data)[0], size);
+}
+
+}  // namespace
+
+PtraceRecording::PtraceRecording()
+    : attaches_(),
+      thread_infos_(),
+      threads_(),
+      files_(),
+      memory_(),
+      pid_(-1),
+      is_64_bit_(false),
+      have_threads_(false) {}
+
+PtraceRecording::~PtraceRecording() {}
+
+void PtraceRecording::SetProcess(pid_t pid, bool is_64_bit) {
+  pid_ = pid;
+  is_64_bit_ = is_64_bit;
+}
+
+void PtraceRecording::AddAttach(pid_t tid, bool succeeded) {
+  attaches_[tid] = succeeded;
+}
+
+bool PtraceRecording::GetAttach(pid_t tid, bool* succeeded) const {
+  auto iterator = attaches_.find(tid);
+  if (iterator == attaches_.end()) {
+    return false;
+  }
+  *succeeded = iterator->second;
+  return true;
+}
+
+void PtraceRecording::AddThreadInfo(pid_t tid, const ThreadInfo& info) {
+  thread_infos_[tid] = info;
+}
+
+bool PtraceRecording::GetThreadInfo(pid_t tid, ThreadInfo* info) const {
+  auto iterator = thread_infos_.find(tid);
+  if (iterator == thread_infos_.end()) {
+    return false;
+  }
+  *info = iterator->second;
+  return true;
+}
+
+void PtraceRecording::SetThreads(const std::vector<pid_t>& threads) {
+  threads_ = threads;
+  have_threads_ = true;
+}
+
+bool PtraceRecording::GetThreads(std::vector<pid_t>* threads) const {
+  if (!have_threads_) {
+    return false;
+  }
+  *threads = threads_;
+  return true;
+}
+
+void PtraceRecording::AddFile(const std::string& path,
+                              bool succeeded,
+                              const std::string& contents) {
+  files_[path] = std::make_pair(succeeded,
+                                succeeded ? contents : std::string());
+}
+
+bool PtraceRecording::GetFile(const std::string& path,
+                              bool* succeeded,
+                              std::string* contents) const {
+  auto iterator = files_.find(path);
+  if (iterator == files_.end()) {
+    return false;
+  }
+  *succeeded = iterator->second.first;
+  if (*succeeded) {
+    *contents = iterator->second.second;
+  }
+  return true;
+}
+
+void PtraceRecording::AddMemory(VMAddress address,
+                                const void* data,
+                                size_t size) {
+  if (size == 0) {
+    return;
+  }
+
+  // Find the recorded ranges that overlap or touch the new one, and replace
+  // them with a single range covering all of them. The new data takes
+  // precedence where it overlaps what was recorded before.
+  VMAddress start = address;
+  VMAddress end = address + size;
+  auto first = memory_.upper_bound(address);
+  if (first != memory_.begin()) {
+    auto previous = std::prev(first);
+    if (previous->first + previous->second.size() >= address) {
+      first = previous;
+      start = previous->first;
+    }
+  }
+  auto last = first;
+  while (last != memory_.end() && last->first <= end) {
+    end = std::max(end, last->first + last->second.size());
+    ++last;
+  }
+
+  std::string merged(end - start, '\0');
+  for (auto iterator = first; iterator != last; ++iterator) {
+    memcpy(&merged[iterator->first - start],
+           iterator->second.data(),
+           iterator->second.size());
+  }
+  memcpy(&merged[address - start], data, size);
+
+  memory_.erase(first, last);
+  memory_[start].swap(merged);
+}
+
+ssize_t PtraceRecording::ReadMemory(VMAddress address,
+                                    size_t size,
+                                    void* buffer) const {
+  if (size == 0) {
+    return 0;
+  }
+
+  auto iterator = memory_.upper_bound(address);
+  if (iterator == memory_.begin()) {
+    errno = EIO;
+    return -1;
+  }
+  --iterator;
+  const VMAddress offset = address - iterator->first;
+  if (offset >= iterator->second.size()) {
+    errno = EIO;
+    return -1;
+  }
+
+  const size_t copy_size = std::min(size, iterator->second.size() - offset);
+  memcpy(buffer, &iterator->second[offset], copy_size);
+  return copy_size;
+}
+
+bool PtraceRecording::Write(FileWriterInterface* writer) const {
+  Header header = {};
+  header.signature = Header::kSignature;
+  header.version = Header::kVersion;
+  header.thread_info_size = sizeof(ThreadInfo);
+  header.pid = pid_;
+  header.is_64_bit = is_64_bit_;
+  header.have_threads = have_threads_;
+  header.attach_count = attaches_.size();
+  header.thread_info_count = thread_infos_.size();
+  header.thread_count = threads_.size();
+  header.file_count = files_.size();
+  header.memory_count = memory_.size();
+  if (!writer->Write(&header, sizeof(header))) {
+    return false;
+  }
+
+  for (const auto& attach : attaches_) {
+    AttachRecord record;
+    record.tid = attach.first;
+    record.succeeded = attach.second;
+    if (!writer->Write(&record, sizeof(record))) {
+      return false;
+    }
+  }
+
+  for (const auto& thread_info : thread_infos_) {
+    const int32_t tid = thread_info.first;
+    if (!writer->Write(&tid, sizeof(tid)) ||
+        !writer->Write(&thread_info.second, sizeof(thread_info.second))) {
+      return false;
+    }
+  }
+
+  for (pid_t thread : threads_) {
+    const int32_t tid = thread;
+    if (!writer->Write(&tid, sizeof(tid))) {
+      return false;
+    }
+  }
+
+  for (const auto& file : files_) {
+    FileRecord record;
+    record.path_size = file.first.size();
+    record.succeeded = file.second.first;
+    record.contents_size = file.second.second.size();
+    if (!writer->Write(&record, sizeof(record)) ||
+        !writer->Write(file.first.data(), file.first.size()) ||
+        !writer->Write(file.second.second.data(), file.second.second.size())) {
+      return false;
+    }
+  }
+
+  for (const auto& range : memory_) {
+    MemoryRecord record;
+    record.address = range.first;
+    record.size = range.second.size();
+    if (!writer->Write(&record, sizeof(record)) ||
+        !writer->Write(range.second.data(), range.second.size())) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool PtraceRecording::Read(FileReaderInterface* reader) {
+  Header header;
+  if (!reader->ReadExactly(&header, sizeof(header))) {
+    return false;
+  }
+  if (header.signature != Header::kSignature) {
+    LOG(ERROR) << "not a ptrace recording";
+    return false;
+  }
+  if (header.version != Header::kVersion) {
+    LOG(ERROR) << "unsupported version " << header.version;
+    return false;
+  }
+  if (header.thread_info_size != sizeof(ThreadInfo)) {
+    LOG(ERROR) << "ThreadInfo size mismatch " << header.thread_info_size;
+    return false;
+  }
+
+  std::map<pid_t, bool> attaches;
+  for (uint32_t index = 0; index < header.attach_count; ++index) {
+    AttachRecord record;
+    if (!reader->ReadExactly(&record, sizeof(record))) {
+      return false;
+    }
+    attaches[record.tid] = record.succeeded != 0;
+  }
+
+  std::map<pid_t, ThreadInfo> thread_infos;
+  for (uint32_t index = 0; index < header.thread_info_count; ++index) {
+    int32_t tid;
+    ThreadInfo info;
+    if (!reader->ReadExactly(&tid, sizeof(tid)) ||
+        !reader->ReadExactly(&info, sizeof(info))) {
+      return false;
+    }
+    thread_infos[tid] = info;
+  }
+
+  std::vector<pid_t> threads;
+  for (uint32_t index = 0; index < header.thread_count; ++index) {
+    int32_t tid;
+    if (!reader->ReadExactly(&tid, sizeof(tid))) {
+      return false;
+    }
+    threads.push_back(tid);
+  }
+
+  std::map<std::string, std::pair<bool, std::string>> files;
+  for (uint32_t index = 0; index < header.file_count; ++index) {
+    FileRecord record;
+    std::string path;
+    std::string contents;
+    if (!reader->ReadExactly(&record, sizeof(record)) ||
+        !ReadString(reader, record.path_size, &path) ||
+        !ReadString(reader, record.contents_size, &contents)) {
+      return false;
+    }
+    files[path] = std::make_pair(record.succeeded != 0, contents);
+  }
+
+  std::map<VMAddress, std::string> memory;
+  for (uint32_t index = 0; index < header.memory_count; ++index) {
+    MemoryRecord record;
+    std::string data;
+    if (!reader->ReadExactly(&record, sizeof(record)) ||
+        !ReadString(reader, record.size, &data)) {
+      return false;
+    }
+    memory[record.address].swap(data);
+  }
+
+  attaches_.swap(attaches);
+  thread_infos_.swap(thread_infos);
+  threads_.swap(threads);
+  files_.swap(files);
+  memory_.swap(memory);
+  pid_ = header.pid;
+  is_64_bit_ = header.is_64_bit != 0;
+  have_threads_ = header.have_threads != 0;
+  return true;
+}
+
+}  // namespace crashpad
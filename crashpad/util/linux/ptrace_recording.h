@@ -0,0 +1,144 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_LINUX_PTRACE_RECORDING_H_
+#define CRASHPAD_UTIL_LINUX_PTRACE_RECORDING_H_
+
+#include <sys/types.h>
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/macros.h"
+#include "util/file/file_reader.h"
+#include "util/file/file_writer.h"
+#include "util/linux/thread_info.h"
+#include "util/misc/address_types.h"
+
+namespace crashpad {
+
+//! \brief The responses a PtraceConnection gave while a process was examined.
+//!
+//! A RecordingPtraceConnection fills a recording as it is used, and a
+//! ReplayPtraceConnection serves the recorded responses back without the
+//! process, so that code examining a process can be run and profiled
+//! repeatably, and on machines other than the one the process ran on.
+//!
+//! Each kind of response is recorded once for each distinct request. Memory
+//! is recorded as the ranges that were read, merged where they overlap or
+//! touch, so that reading the same memory repeatedly doesn’t grow the
+//! recording.
+class PtraceRecording {
+ public:
+  PtraceRecording();
+  ~PtraceRecording();
+
+  //! \brief Records the process ID and bitness of the process.
+  void SetProcess(pid_t pid, bool is_64_bit);
+
+  //! \brief Returns the process ID recorded by SetProcess().
+  pid_t ProcessID() const { return pid_; }
+
+  //! \brief Returns the bitness recorded by SetProcess().
+  bool Is64Bit() const { return is_64_bit_; }
+
+  //! \brief Records whether attaching to thread \a tid succeeded.
+  void AddAttach(pid_t tid, bool succeeded);
+
+  //! \brief Retrieves whether attaching to thread \a tid succeeded.
+  //!
+  //! \return `true` if an attempt to attach to \a tid was recorded, with \a
+  //!     succeeded set. Otherwise, `false`.
+  bool GetAttach(pid_t tid, bool* succeeded) const;
+
+  //! \brief Records the ThreadInfo retrieved for thread \a tid.
+  void AddThreadInfo(pid_t tid, const ThreadInfo& info);
+
+  //! \brief Retrieves the ThreadInfo recorded for thread \a tid.
+  //!
+  //! \return `true` with \a info set if one was recorded. Otherwise, `false`.
+  bool GetThreadInfo(pid_t tid, ThreadInfo* info) const;
+
+  //! \brief Records the process’ threads.
+  void SetThreads(const std::vector<pid_t>& threads);
+
+  //! \brief Retrieves the threads recorded by SetThreads().
+  //!
+  //! \return `true` with \a threads set if they were recorded. Otherwise,
+  //!     `false`.
+  bool GetThreads(std::vector<pid_t>* threads) const;
+
+  //! \brief Records the result of reading the file at \a path.
+  //!
+  //! \param[in] path The path of the file.
+  //! \param[in] succeeded Whether the file was read.
+  //! \param[in] contents The file’s contents, if it was read.
+  void AddFile(const std::string& path,
+               bool succeeded,
+               const std::string& contents);
+
+  //! \brief Retrieves the result of reading the file at \a path.
+  //!
+  //! \return `true` if reading the file was recorded, with \a succeeded set
+  //!     and, if it was read, \a contents set. Otherwise, `false`.
+  bool GetFile(const std::string& path,
+               bool* succeeded,
+               std::string* contents) const;
+
+  //! \brief Records \a size bytes of memory read from \a address.
+  void AddMemory(VMAddress address, const void* data, size_t size);
+
+  //! \brief Copies recorded memory, as ProcessMemory::Source::ReadUpTo()
+  //!     does.
+  //!
+  //! \return The number of bytes copied, which is less than \a size if the
+  //!     memory following them wasn’t recorded. `-1` with `errno` set to
+  //!     `EIO` if the memory at \a address wasn’t recorded.
+  ssize_t ReadMemory(VMAddress address, size_t size, void* buffer) const;
+
+  //! \brief Writes the recording to \a writer.
+  //!
+  //! \return `true` on success. `false` on failure with a message logged.
+  bool Write(FileWriterInterface* writer) const;
+
+  //! \brief Replaces the contents of this object with a recording read from
+  //!     \a reader, as written by Write().
+  //!
+  //! \return `true` on success. `false` on failure with a message logged,
+  //!     such as when the recording was made by an incompatible version or
+  //!     architecture.
+  bool Read(FileReaderInterface* reader);
+
+ private:
+  std::map<pid_t, bool> attaches_;
+  std::map<pid_t, ThreadInfo> thread_infos_;
+  std::vector<pid_t> threads_;
+  std::map<std::string, std::pair<bool, std::string>> files_;
+
+  // Memory that was read, keyed by address. The ranges neither overlap nor
+  // touch.
+  std::map<VMAddress, std::string> memory_;
+
+  pid_t pid_;
+  bool is_64_bit_;
+  bool have_threads_;
+
+  DISALLOW_COPY_AND_ASSIGN(PtraceRecording);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_LINUX_PTRACE_RECORDING_H_
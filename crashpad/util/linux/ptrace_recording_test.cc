@@ -0,0 +1,144 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/linux/ptrace_recording.h"
+
+#include <errno.h>
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "util/file/string_file.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+std::string ReadMemory(const PtraceRecording& recording,
+                       VMAddress address,
+                       size_t size) {
+  std::string buffer(size, '\0');
+  const ssize_t rv = recording.ReadMemory(address, size, &buffer[0]);
+  if (rv < 0) {
+    EXPECT_EQ(errno, EIO);
+    return "-";
+  }
+  buffer.resize(rv);
+  return buffer;
+}
+
+TEST(PtraceRecording, Memory) {
+  PtraceRecording recording;
+  EXPECT_EQ(ReadMemory(recording, 0x1000, 4), "-");
+
+  recording.AddMemory(0x1000, "abcd", 4);
+  recording.AddMemory(0x1008, "ijkl", 4);
+  EXPECT_EQ(ReadMemory(recording, 0x1000, 4), "abcd");
+  EXPECT_EQ(ReadMemory(recording, 0x1002, 4), "cd");
+  EXPECT_EQ(ReadMemory(recording, 0x1004, 4), "-");
+  EXPECT_EQ(ReadMemory(recording, 0x0fff, 4), "-");
+  EXPECT_EQ(ReadMemory(recording, 0x1008, 8), "ijkl");
+  EXPECT_EQ(ReadMemory(recording, 0x100c, 1), "-");
+
+  // A range touching both recorded ranges merges them.
+  recording.AddMemory(0x1004, "efgh", 4);
+  EXPECT_EQ(ReadMemory(recording, 0x1000, 12), "abcdefghijkl");
+
+  // Newer data replaces older data where they overlap.
+  recording.AddMemory(0x0ffe, "yzAB", 4);
+  recording.AddMemory(0x100a, "KLmn", 4);
+  EXPECT_EQ(ReadMemory(recording, 0x0ffe, 16), "yzABcdefghijKLmn");
+  EXPECT_EQ(ReadMemory(recording, 0x0ffe, 0), "");
+}
+
+TEST(PtraceRecording, WriteAndRead) {
+  PtraceRecording recording;
+  recording.SetProcess(123, true);
+  recording.AddAttach(124, true);
+  recording.AddAttach(125, false);
+
+  ThreadInfo info;
+  info.thread_specific_data_address = 0x1234;
+  recording.AddThreadInfo(124, info);
+
+  std::vector<pid_t> threads;
+  EXPECT_FALSE(recording.GetThreads(&threads));
+  recording.SetThreads({123, 124, 125});
+
+  recording.AddFile("/proc/123/maps", true, "maps contents");
+  recording.AddFile("/proc/123/auxv", false, std::string());
+  recording.AddMemory(0x7000, "memory", 6);
+  recording.AddMemory(0x9000, "more memory", 11);
+
+  StringFile file;
+  ASSERT_TRUE(recording.Write(&file));
+  ASSERT_EQ(file.Seek(0, SEEK_SET), 0);
+
+  PtraceRecording read_recording;
+  ASSERT_TRUE(read_recording.Read(&file));
+  EXPECT_EQ(read_recording.ProcessID(), 123);
+  EXPECT_TRUE(read_recording.Is64Bit());
+
+  bool succeeded;
+  ASSERT_TRUE(read_recording.GetAttach(124, &succeeded));
+  EXPECT_TRUE(succeeded);
+  ASSERT_TRUE(read_recording.GetAttach(125, &succeeded));
+  EXPECT_FALSE(succeeded);
+  EXPECT_FALSE(read_recording.GetAttach(126, &succeeded));
+
+  ThreadInfo read_info;
+  ASSERT_TRUE(read_recording.GetThreadInfo(124, &read_info));
+  EXPECT_EQ(read_info.thread_specific_data_address, 0x1234u);
+  EXPECT_FALSE(read_recording.GetThreadInfo(125, &read_info));
+
+  ASSERT_TRUE(read_recording.GetThreads(&threads));
+  EXPECT_EQ(threads, std::vector<pid_t>({123, 124, 125}));
+
+  std::string contents;
+  ASSERT_TRUE(
+      read_recording.GetFile("/proc/123/maps", &succeeded, &contents));
+  EXPECT_TRUE(succeeded);
+  EXPECT_EQ(contents, "maps contents");
+  ASSERT_TRUE(
+      read_recording.GetFile("/proc/123/auxv", &succeeded, &contents));
+  EXPECT_FALSE(succeeded);
+  EXPECT_FALSE(
+      read_recording.GetFile("/proc/123/stat", &succeeded, &contents));
+
+  EXPECT_EQ(ReadMemory(read_recording, 0x7000, 6), "memory");
+  EXPECT_EQ(ReadMemory(read_recording, 0x9005, 6), "memory");
+  EXPECT_EQ(ReadMemory(read_recording, 0x8000, 6), "-");
+}
+
+TEST(PtraceRecording, ReadBadRecording) {
+  StringFile file;
+  file.SetString("not a recording, but long enough to have a header");
+  PtraceRecording recording;
+  EXPECT_FALSE(recording.Read(&file));
+
+  PtraceRecording good_recording;
+  good_recording.AddMemory(0x1000, "data", 4);
+  StringFile good_file;
+  ASSERT_TRUE(good_recording.Write(&good_file));
+  std::string truncated = good_file.string();
+  truncated.resize(truncated.size() - 1);
+  file.SetString(truncated);
+  EXPECT_FALSE(recording.Read(&file));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
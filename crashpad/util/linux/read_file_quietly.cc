@@ -0,0 +1,36 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/linux/read_file_quietly.h"
+
+#include "util/file/file_io.h"
+
+namespace crashpad {
+
+bool ReadFileQuietly(const base::FilePath& path, std::string* contents) {
+  ScopedFileHandle handle(OpenFileForRead(path));
+  if (!handle.is_valid()) {
+    return false;
+  }
+
+  contents->clear();
+  char buffer[4096];
+  FileOperationResult rv;
+  while ((rv = ReadFile(handle.get(), buffer, sizeof(buffer))) > 0) {
+    contents->append(buffer, rv);
+  }
+  return rv == 0;
+}
+
+}  // namespace crashpad
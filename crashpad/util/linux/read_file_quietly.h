@@ -0,0 +1,39 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_LINUX_READ_FILE_QUIETLY_H_
+#define CRASHPAD_UTIL_LINUX_READ_FILE_QUIETLY_H_
+
+#include <string>
+
+#include "base/files/file_path.h"
+
+namespace crashpad {
+
+//! \brief Reads the entire file at \a path into \a contents without logging.
+//!
+//! This is for files under `/proc` and the cgroup hierarchy that disappear when
+//! a process exits or a cgroup is removed, where failing to read them is
+//! expected. Use LoggingReadEntireFile() for files that should exist.
+//!
+//! \param[in] path The file to read.
+//! \param[out] contents The file’s contents.
+//!
+//! \return `true` on success. `false` without a message logged if the file
+//!     could not be opened or read.
+bool ReadFileQuietly(const base::FilePath& path, std::string* contents);
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_LINUX_READ_FILE_QUIETLY_H_
@@ -0,0 +1,65 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/linux/read_file_quietly.h"
+
+#include <unistd.h>
+
+#include "base/strings/string_number_conversions.h"
+#include "gtest/gtest.h"
+#include "test/scoped_temp_dir.h"
+#include "util/file/file_io.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+TEST(ReadFileQuietly, ReadsEntireFile) {
+  ScopedTempDir temp_dir;
+  const base::FilePath path = temp_dir.path().Append("file");
+
+  // Larger than the read buffer, so that it takes more than one read.
+  std::string expected(10000, 'x');
+  expected.back() = 'y';
+  {
+    ScopedFileHandle handle(LoggingOpenFileForWrite(
+        path, FileWriteMode::kCreateOrFail, FilePermissions::kOwnerOnly));
+    ASSERT_TRUE(handle.is_valid());
+    ASSERT_TRUE(
+        LoggingWriteFile(handle.get(), expected.data(), expected.size()));
+  }
+
+  std::string contents("stale");
+  ASSERT_TRUE(ReadFileQuietly(path, &contents));
+  EXPECT_EQ(contents, expected);
+}
+
+TEST(ReadFileQuietly, ProcFile) {
+  // Files under /proc report a size of 0, so they must be read until EOF.
+  std::string contents;
+  ASSERT_TRUE(ReadFileQuietly(base::FilePath("/proc/self/stat"), &contents));
+  EXPECT_EQ(contents.substr(0, contents.find(' ')),
+            base::IntToString(getpid()));
+}
+
+TEST(ReadFileQuietly, MissingFile) {
+  ScopedTempDir temp_dir;
+  std::string contents;
+  EXPECT_FALSE(
+      ReadFileQuietly(temp_dir.path().Append("missing"), &contents));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
@@ -0,0 +1,152 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/linux/recording_ptrace_connection.h"
+
+#include "base/logging.h"
+
+namespace crashpad {
+
+RecordingPtraceConnection::RecordingPtraceConnection()
+    : PtraceConnection(),
+      ProcessMemory::Source(),
+      memory_(),
+      connection_(nullptr),
+      recording_(nullptr),
+      initialized_() {}
+
+RecordingPtraceConnection::~RecordingPtraceConnection() {}
+
+bool RecordingPtraceConnection::Initialize(PtraceConnection* connection,
+                                           PtraceRecording* recording) {
+  INITIALIZATION_STATE_SET_INITIALIZING(initialized_);
+  DCHECK(connection);
+  DCHECK(recording);
+
+  if (!memory_.InitializeWithSource(this)) {
+    return false;
+  }
+
+  connection_ = connection;
+  recording_ = recording;
+  recording_->SetProcess(connection_->GetProcessID(), connection_->Is64Bit());
+
+  INITIALIZATION_STATE_SET_VALID(initialized_);
+  return true;
+}
+
+pid_t RecordingPtraceConnection::GetProcessID() {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  return connection_->GetProcessID();
+}
+
+bool RecordingPtraceConnection::Attach(pid_t tid) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  const bool succeeded = connection_->Attach(tid);
+  recording_->AddAttach(tid, succeeded);
+  return succeeded;
+}
+
+bool RecordingPtraceConnection::Is64Bit() {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  return connection_->Is64Bit();
+}
+
+bool RecordingPtraceConnection::GetThreadInfo(pid_t tid, ThreadInfo* info) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  if (!connection_->GetThreadInfo(tid, info)) {
+    return false;
+  }
+  recording_->AddThreadInfo(tid, *info);
+  return true;
+}
+
+void RecordingPtraceConnection::AttachAndGetThreadInfos(
+    const std::vector<pid_t>& tids,
+    std::vector<ThreadInfo>* infos,
+    std::vector<bool>* succeeded) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  connection_->AttachAndGetThreadInfos(tids, infos, succeeded);
+
+  // A thread that wasn’t both attached and examined is recorded as not
+  // attached, which is how ReplayPtraceConnection will report it.
+  for (size_t index = 0; index < tids.size(); ++index) {
+    recording_->AddAttach(tids[index], (*succeeded)[index]);
+    if ((*succeeded)[index]) {
+      recording_->AddThreadInfo(tids[index], (*infos)[index]);
+    }
+  }
+}
+
+bool RecordingPtraceConnection::Threads(std::vector<pid_t>* threads) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  if (!connection_->Threads(threads)) {
+    return false;
+  }
+  recording_->SetThreads(*threads);
+  return true;
+}
+
+bool RecordingPtraceConnection::ReadFileContents(const base::FilePath& path,
+                                                 std::string* contents) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  const bool succeeded = connection_->ReadFileContents(path, contents);
+  recording_->AddFile(path.value(), succeeded, *contents);
+  return succeeded;
+}
+
+bool RecordingPtraceConnection::ReadFilesContents(
+    const std::vector<base::FilePath>& paths,
+    std::vector<std::string>* contents) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  if (!connection_->ReadFilesContents(paths, contents)) {
+    // It isn’t known which of the files couldn’t be read, so none are
+    // recorded. ReplayPtraceConnection will fail to read them too.
+    return false;
+  }
+  for (size_t index = 0; index < paths.size(); ++index) {
+    recording_->AddFile(paths[index].value(), true, (*contents)[index]);
+  }
+  return true;
+}
+
+ProcessMemory* RecordingPtraceConnection::Memory() {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  return &memory_;
+}
+
+ssize_t RecordingPtraceConnection::ReadUpTo(VMAddress address,
+                                            size_t size,
+                                            void* buffer) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  const ssize_t rv = connection_->Memory()->ReadUpTo(address, size, buffer);
+  if (rv > 0) {
+    recording_->AddMemory(address, buffer, rv);
+  }
+  return rv;
+}
+
+bool RecordingPtraceConnection::ReadBatch(
+    const std::vector<ProcessMemory::ReadRequest>& requests) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  if (!connection_->Memory()->ReadBatch(requests)) {
+    return false;
+  }
+  for (const ProcessMemory::ReadRequest& request : requests) {
+    recording_->AddMemory(request.address, request.buffer, request.size);
+  }
+  return true;
+}
+
+}  // namespace crashpad
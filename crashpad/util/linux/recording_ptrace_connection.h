@@ -0,0 +1,84 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_LINUX_RECORDING_PTRACE_CONNECTION_H_
+#define CRASHPAD_UTIL_LINUX_RECORDING_PTRACE_CONNECTION_H_
+
+#include <sys/types.h>
+
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "util/linux/ptrace_connection.h"
+#include "util/linux/ptrace_recording.h"
+#include "util/misc/initialization_state_dcheck.h"
+#include "util/process/process_memory.h"
+
+namespace crashpad {
+
+//! \brief A PtraceConnection that forwards requests to another connection and
+//!     records its responses in a PtraceRecording.
+//!
+//! The recording can later be served by a ReplayPtraceConnection in place of
+//! the process.
+class RecordingPtraceConnection : public PtraceConnection,
+                                  public ProcessMemory::Source {
+ public:
+  RecordingPtraceConnection();
+  ~RecordingPtraceConnection() override;
+
+  //! \brief Initializes this object.
+  //!
+  //! \param[in] connection The connection to forward requests to. This object
+  //!     does not take ownership of it.
+  //! \param[in] recording The recording to add responses to. This object does
+  //!     not take ownership of it.
+  //! \return `true` on success. `false` on failure with a message logged.
+  bool Initialize(PtraceConnection* connection, PtraceRecording* recording);
+
+  // PtraceConnection:
+
+  pid_t GetProcessID() override;
+  bool Attach(pid_t tid) override;
+  bool Is64Bit() override;
+  bool GetThreadInfo(pid_t tid, ThreadInfo* info) override;
+  void AttachAndGetThreadInfos(const std::vector<pid_t>& tids,
+                               std::vector<ThreadInfo>* infos,
+                               std::vector<bool>* succeeded) override;
+  bool Threads(std::vector<pid_t>* threads) override;
+  bool ReadFileContents(const base::FilePath& path,
+                        std::string* contents) override;
+  bool ReadFilesContents(const std::vector<base::FilePath>& paths,
+                         std::vector<std::string>* contents) override;
+  ProcessMemory* Memory() override;
+
+  // ProcessMemory::Source:
+
+  ssize_t ReadUpTo(VMAddress address, size_t size, void* buffer) override;
+  bool ReadBatch(const std::vector<ProcessMemory::ReadRequest>& requests)
+      override;
+
+ private:
+  ProcessMemory memory_;
+  PtraceConnection* connection_;  // weak
+  PtraceRecording* recording_;  // weak
+  InitializationStateDcheck initialized_;
+
+  DISALLOW_COPY_AND_ASSIGN(RecordingPtraceConnection);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_LINUX_RECORDING_PTRACE_CONNECTION_H_
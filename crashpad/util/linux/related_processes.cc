@@ -0,0 +1,216 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/linux/related_processes.h"
+
+#include <dirent.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+
+#include "base/logging.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/stringprintf.h"
+#include "util/file/file_io.h"
+#include "util/linux/read_file_quietly.h"
+#include "util/posix/scoped_dir.h"
+
+namespace crashpad {
+
+namespace {
+
+// Finds where the cgroup v2 hierarchy is mounted in this process’ mount
+// namespace, from lines of /proc/self/mountinfo of the form
+// “id parent major:minor root mount_point options... - cgroup2 source ...”.
+bool FindCgroup2MountPoint(std::string* mount_point) {
+  std::string mountinfo;
+  if (!ReadFileQuietly(base::FilePath("/proc/self/mountinfo"), &mountinfo)) {
+    return false;
+  }
+
+  size_t line_start = 0;
+  while (line_start < mountinfo.size()) {
+    size_t line_end = mountinfo.find('\n', line_start);
+    if (line_end == std::string::npos) {
+      line_end = mountinfo.size();
+    }
+    const std::string line =
+        mountinfo.substr(line_start, line_end - line_start);
+    line_start = line_end + 1;
+
+    if (line.find(" - cgroup2 ") == std::string::npos) {
+      continue;
+    }
+
+    std::vector<std::string> fields;
+    size_t field_start = 0;
+    while (fields.size() < 5) {
+      const size_t field_end = line.find(' ', field_start);
+      if (field_end == std::string::npos) {
+        break;
+      }
+      fields.push_back(line.substr(field_start, field_end - field_start));
+      field_start = field_end + 1;
+    }
+
+    // Paths in /proc/[pid]/cgroup are relative to the root of the hierarchy,
+    // so only a mount of the root can be used to find them.
+    if (fields.size() == 5 && fields[3] == "/") {
+      *mount_point = fields[4];
+      return true;
+    }
+  }
+  return false;
+}
+
+// Reads the parent process ID from the fourth column of /proc/[pid]/stat.
+bool ReadParentProcessID(pid_t pid, pid_t* ppid) {
+  std::string contents;
+  if (!ReadFileQuietly(
+          base::FilePath(base::StringPrintf("/proc/%d/stat", pid)),
+          &contents)) {
+    return false;
+  }
+
+  // The executable name in the second column may contain parentheses itself,
+  // so find its end by working backwards. It is followed by “) state ppid ”.
+  const size_t name_end = contents.rfind(')');
+  if (name_end == std::string::npos) {
+    return false;
+  }
+  const size_t ppid_start = contents.find(' ', name_end + 2);
+  if (ppid_start == std::string::npos) {
+    return false;
+  }
+  const size_t ppid_end = contents.find(' ', ppid_start + 1);
+  return base::StringToInt(
+      base::StringPiece(&contents[ppid_start + 1],
+                        (ppid_end == std::string::npos ? contents.size()
+                                                       : ppid_end) -
+                            ppid_start - 1),
+      ppid);
+}
+
+}  // namespace
+
+bool FindCgroupDirectory(pid_t pid, base::FilePath* directory) {
+  std::string mount_point;
+  if (!FindCgroup2MountPoint(&mount_point)) {
+    return false;
+  }
+
+  // The cgroup v2 entry in /proc/[pid]/cgroup is the line “0::path”.
+  std::string cgroups;
+  if (!ReadFileQuietly(
+          base::FilePath(base::StringPrintf("/proc/%d/cgroup", pid)),
+          &cgroups)) {
+    return false;
+  }
+  std::string path;
+  if (cgroups.compare(0, 3, "0::") == 0) {
+    path = cgroups.substr(3, cgroups.find('\n') - 3);
+  } else {
+    const size_t entry = cgroups.find("\n0::");
+    if (entry == std::string::npos) {
+      return false;
+    }
+    const size_t start = entry + 4;
+    path = cgroups.substr(start, cgroups.find('\n', start) - start);
+  }
+
+  if (path.empty() || path == "/") {
+    return false;
+  }
+
+  *directory = base::FilePath(mount_point + path);
+  return true;
+}
+
+bool ReadCgroupProcesses(pid_t pid, std::vector<pid_t>* pids) {
+  base::FilePath directory;
+  if (!FindCgroupDirectory(pid, &directory)) {
+    LOG(ERROR) << "no cgroup v2 cgroup for process " << pid;
+    return false;
+  }
+
+  std::string procs;
+  if (!LoggingReadEntireFile(directory.Append("cgroup.procs"), &procs)) {
+    return false;
+  }
+
+  std::vector<pid_t> local_pids;
+  size_t line_start = 0;
+  while (line_start < procs.size()) {
+    size_t line_end = procs.find('\n', line_start);
+    if (line_end == std::string::npos) {
+      line_end = procs.size();
+    }
+    pid_t member;
+    if (!base::StringToInt(
+            base::StringPiece(&procs[line_start], line_end - line_start),
+            &member)) {
+      LOG(ERROR) << "format error";
+      return false;
+    }
+    local_pids.push_back(member);
+    line_start = line_end + 1;
+  }
+
+  std::sort(local_pids.begin(), local_pids.end());
+  pids->swap(local_pids);
+  return true;
+}
+
+bool ReadProcessTree(pid_t root, std::vector<pid_t>* pids) {
+  DIR* dir = opendir("/proc");
+  if (!dir) {
+    PLOG(ERROR) << "opendir";
+    return false;
+  }
+  ScopedDIR scoped_dir(dir);
+
+  std::multimap<pid_t, pid_t> children;
+  bool found_root = false;
+  dirent* dir_entry;
+  while ((dir_entry = readdir(scoped_dir.get()))) {
+    pid_t pid;
+    pid_t ppid;
+    if (!base::StringToInt(dir_entry->d_name, &pid) ||
+        !ReadParentProcessID(pid, &ppid)) {
+      continue;
+    }
+    children.insert(std::make_pair(ppid, pid));
+    found_root |= pid == root;
+  }
+
+  if (!found_root) {
+    LOG(ERROR) << "no process " << root;
+    return false;
+  }
+
+  std::vector<pid_t> local_pids(1, root);
+  for (size_t index = 0; index < local_pids.size(); ++index) {
+    const auto range = children.equal_range(local_pids[index]);
+    for (auto it = range.first; it != range.second; ++it) {
+      local_pids.push_back(it->second);
+    }
+  }
+
+  std::sort(local_pids.begin(), local_pids.end());
+  pids->swap(local_pids);
+  return true;
+}
+
+}  // namespace crashpad
@@ -0,0 +1,62 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_LINUX_RELATED_PROCESSES_H_
+#define CRASHPAD_UTIL_LINUX_RELATED_PROCESSES_H_
+
+#include <sys/types.h>
+
+#include <vector>
+
+#include "base/files/file_path.h"
+
+namespace crashpad {
+
+//! \brief Finds the directory of the cgroup v2 cgroup of process \a pid.
+//!
+//! \param[in] pid The process ID of the process.
+//! \param[out] directory The directory of the cgroup, under the mount point of
+//!     the cgroup v2 hierarchy.
+//!
+//! \return `true` on success. `false` without a message logged if the cgroup v2
+//!     hierarchy isn’t mounted, or the process has exited or is in the root
+//!     cgroup.
+bool FindCgroupDirectory(pid_t pid, base::FilePath* directory);
+
+//! \brief Reads the process IDs of the processes in the cgroup v2 cgroup of
+//!     process \a pid.
+//!
+//! Processes in descendant cgroups are not included.
+//!
+//! \param[in] pid The process ID of a process in the cgroup.
+//! \param[out] pids The process IDs, in ascending order, including \a pid.
+//!
+//! \return `true` on success. `false` on failure with a message logged.
+bool ReadCgroupProcesses(pid_t pid, std::vector<pid_t>* pids);
+
+//! \brief Reads the process IDs of process \a root and all of its descendants.
+//!
+//! Processes that are created while the tree is read may be missed, and those
+//! that exit may be included. Freezing the processes with ScopedProcessFreeze
+//! and reading the tree again finds a stable set.
+//!
+//! \param[in] root The process ID of the root of the tree.
+//! \param[out] pids The process IDs, in ascending order, including \a root.
+//!
+//! \return `true` on success. `false` on failure with a message logged.
+bool ReadProcessTree(pid_t root, std::vector<pid_t>* pids);
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_LINUX_RELATED_PROCESSES_H_
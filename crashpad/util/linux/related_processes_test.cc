@@ -0,0 +1,108 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/linux/related_processes.h"
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "test/errors.h"
+#include "test/multiprocess.h"
+#include "util/file/file_io.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+bool Contains(const std::vector<pid_t>& pids, pid_t pid) {
+  return std::find(pids.begin(), pids.end(), pid) != pids.end();
+}
+
+// The child creates a grandchild, and both wait until the parent is done.
+class ProcessTreeTest : public Multiprocess {
+ public:
+  ProcessTreeTest() : Multiprocess() {}
+  ~ProcessTreeTest() {}
+
+ private:
+  void MultiprocessParent() override {
+    pid_t grandchild;
+    CheckedReadFileExactly(ReadPipeHandle(), &grandchild, sizeof(grandchild));
+
+    std::vector<pid_t> pids;
+    ASSERT_TRUE(ReadProcessTree(ChildPID(), &pids));
+    EXPECT_EQ(pids, std::vector<pid_t>({ChildPID(), grandchild}));
+
+    ASSERT_TRUE(ReadProcessTree(getpid(), &pids));
+    EXPECT_TRUE(std::is_sorted(pids.begin(), pids.end()));
+    EXPECT_TRUE(Contains(pids, getpid()));
+    EXPECT_TRUE(Contains(pids, ChildPID()));
+    EXPECT_TRUE(Contains(pids, grandchild));
+    EXPECT_FALSE(Contains(pids, getppid()));
+
+    char c = '\0';
+    CheckedWriteFile(WritePipeHandle(), &c, sizeof(c));
+  }
+
+  void MultiprocessChild() override {
+    const pid_t grandchild = fork();
+    ASSERT_GE(grandchild, 0) << ErrnoMessage("fork");
+    if (grandchild == 0) {
+      pause();
+      _exit(0);
+    }
+
+    CheckedWriteFile(WritePipeHandle(), &grandchild, sizeof(grandchild));
+    char c;
+    CheckedReadFileExactly(ReadPipeHandle(), &c, sizeof(c));
+
+    ASSERT_EQ(kill(grandchild, SIGKILL), 0) << ErrnoMessage("kill");
+    ASSERT_EQ(waitpid(grandchild, nullptr, 0), grandchild)
+        << ErrnoMessage("waitpid");
+  }
+
+  DISALLOW_COPY_AND_ASSIGN(ProcessTreeTest);
+};
+
+TEST(RelatedProcesses, ProcessTree) {
+  ProcessTreeTest test;
+  test.Run();
+}
+
+TEST(RelatedProcesses, NoProcessTree) {
+  std::vector<pid_t> pids;
+  EXPECT_FALSE(ReadProcessTree(-1, &pids));
+}
+
+TEST(RelatedProcesses, Cgroup) {
+  base::FilePath directory;
+  if (!FindCgroupDirectory(getpid(), &directory)) {
+    // The cgroup v2 hierarchy isn’t available.
+    return;
+  }
+
+  std::vector<pid_t> pids;
+  ASSERT_TRUE(ReadCgroupProcesses(getpid(), &pids));
+  EXPECT_TRUE(std::is_sorted(pids.begin(), pids.end()));
+  EXPECT_TRUE(Contains(pids, getpid()));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
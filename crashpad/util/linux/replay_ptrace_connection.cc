@@ -0,0 +1,145 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/linux/replay_ptrace_connection.h"
+
+#include "base/logging.h"
+
+namespace crashpad {
+
+ReplayPtraceConnection::ReplayPtraceConnection()
+    : PtraceConnection(),
+      ProcessMemory::Source(),
+      memory_(),
+      recording_(nullptr),
+      initialized_() {}
+
+ReplayPtraceConnection::~ReplayPtraceConnection() {}
+
+bool ReplayPtraceConnection::Initialize(const PtraceRecording* recording) {
+  INITIALIZATION_STATE_SET_INITIALIZING(initialized_);
+  DCHECK(recording);
+
+  if (!memory_.InitializeWithSource(this)) {
+    return false;
+  }
+  recording_ = recording;
+
+  INITIALIZATION_STATE_SET_VALID(initialized_);
+  return true;
+}
+
+pid_t ReplayPtraceConnection::GetProcessID() {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  return recording_->ProcessID();
+}
+
+bool ReplayPtraceConnection::Attach(pid_t tid) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  bool succeeded;
+  if (!recording_->GetAttach(tid, &succeeded)) {
+    LOG(ERROR) << "no recorded attach for thread " << tid;
+    return false;
+  }
+  LOG_IF(ERROR, !succeeded) << "attach to thread " << tid << " failed";
+  return succeeded;
+}
+
+bool ReplayPtraceConnection::Is64Bit() {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  return recording_->Is64Bit();
+}
+
+bool ReplayPtraceConnection::GetThreadInfo(pid_t tid, ThreadInfo* info) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  if (!recording_->GetThreadInfo(tid, info)) {
+    LOG(ERROR) << "no recorded ThreadInfo for thread " << tid;
+    return false;
+  }
+  return true;
+}
+
+void ReplayPtraceConnection::AttachAndGetThreadInfos(
+    const std::vector<pid_t>& tids,
+    std::vector<ThreadInfo>* infos,
+    std::vector<bool>* succeeded) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  infos->resize(tids.size());
+  succeeded->resize(tids.size());
+  for (size_t index = 0; index < tids.size(); ++index) {
+    (*succeeded)[index] =
+        Attach(tids[index]) && GetThreadInfo(tids[index], &(*infos)[index]);
+  }
+}
+
+bool ReplayPtraceConnection::Threads(std::vector<pid_t>* threads) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  if (!recording_->GetThreads(threads)) {
+    LOG(ERROR) << "no recorded threads";
+    return false;
+  }
+  return true;
+}
+
+bool ReplayPtraceConnection::ReadFileContents(const base::FilePath& path,
+                                              std::string* contents) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  bool succeeded;
+  if (!recording_->GetFile(path.value(), &succeeded, contents)) {
+    LOG(ERROR) << "no recorded contents for " << path.value();
+    return false;
+  }
+  LOG_IF(ERROR, !succeeded) << "read " << path.value() << " failed";
+  return succeeded;
+}
+
+bool ReplayPtraceConnection::ReadFilesContents(
+    const std::vector<base::FilePath>& paths,
+    std::vector<std::string>* contents) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  contents->resize(paths.size());
+  for (size_t index = 0; index < paths.size(); ++index) {
+    if (!ReadFileContents(paths[index], &(*contents)[index])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+ProcessMemory* ReplayPtraceConnection::Memory() {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  return &memory_;
+}
+
+ssize_t ReplayPtraceConnection::ReadUpTo(VMAddress address,
+                                         size_t size,
+                                         void* buffer) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  return recording_->ReadMemory(address, size, buffer);
+}
+
+bool ReplayPtraceConnection::ReadBatch(
+    const std::vector<ProcessMemory::ReadRequest>& requests) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  for (const ProcessMemory::ReadRequest& request : requests) {
+    if (recording_->ReadMemory(request.address, request.size, request.buffer) !=
+        static_cast<ssize_t>(request.size)) {
+      LOG(ERROR) << "no recorded memory at " << request.address;
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace crashpad
@@ -0,0 +1,82 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_LINUX_REPLAY_PTRACE_CONNECTION_H_
+#define CRASHPAD_UTIL_LINUX_REPLAY_PTRACE_CONNECTION_H_
+
+#include <sys/types.h>
+
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "util/linux/ptrace_connection.h"
+#include "util/linux/ptrace_recording.h"
+#include "util/misc/initialization_state_dcheck.h"
+#include "util/process/process_memory.h"
+
+namespace crashpad {
+
+//! \brief A PtraceConnection that serves the responses in a PtraceRecording,
+//!     without the process that was recorded.
+//!
+//! Requests that weren’t recorded fail with a message logged, as do requests
+//! that failed when they were recorded. Memory is served from the ranges that
+//! were recorded, so reads needn’t match the recorded reads exactly.
+class ReplayPtraceConnection : public PtraceConnection,
+                               public ProcessMemory::Source {
+ public:
+  ReplayPtraceConnection();
+  ~ReplayPtraceConnection() override;
+
+  //! \brief Initializes this object.
+  //!
+  //! \param[in] recording The recording to serve. This object does not take
+  //!     ownership of it.
+  //! \return `true` on success. `false` on failure with a message logged.
+  bool Initialize(const PtraceRecording* recording);
+
+  // PtraceConnection:
+
+  pid_t GetProcessID() override;
+  bool Attach(pid_t tid) override;
+  bool Is64Bit() override;
+  bool GetThreadInfo(pid_t tid, ThreadInfo* info) override;
+  void AttachAndGetThreadInfos(const std::vector<pid_t>& tids,
+                               std::vector<ThreadInfo>* infos,
+                               std::vector<bool>* succeeded) override;
+  bool Threads(std::vector<pid_t>* threads) override;
+  bool ReadFileContents(const base::FilePath& path,
+                        std::string* contents) override;
+  bool ReadFilesContents(const std::vector<base::FilePath>& paths,
+                         std::vector<std::string>* contents) override;
+  ProcessMemory* Memory() override;
+
+  // ProcessMemory::Source:
+
+  ssize_t ReadUpTo(VMAddress address, size_t size, void* buffer) override;
+  bool ReadBatch(const std::vector<ProcessMemory::ReadRequest>& requests)
+      override;
+
+ private:
+  ProcessMemory memory_;
+  const PtraceRecording* recording_;  // weak
+  InitializationStateDcheck initialized_;
+
+  DISALLOW_COPY_AND_ASSIGN(ReplayPtraceConnection);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_LINUX_REPLAY_PTRACE_CONNECTION_H_
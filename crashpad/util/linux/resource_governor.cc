@@ -0,0 +1,188 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/linux/resource_governor.h"
+
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+
+#include "base/logging.h"
+#include "base/strings/stringprintf.h"
+#include "util/file/file_io.h"
+#include "util/linux/memory_pressure.h"
+#include "util/linux/read_file_quietly.h"
+#include "util/misc/clock.h"
+
+namespace crashpad {
+
+namespace {
+
+// From <linux/ioprio.h>, which is not available on all systems.
+constexpr int kIOPrioWhoProcess = 1;
+constexpr int kIOPrioClassShift = 13;
+
+pid_t GetTid() {
+  return static_cast<pid_t>(syscall(SYS_gettid));
+}
+
+// Writes |tid| to the first of |cgroup|’s thread membership files that can be
+// opened.
+bool MoveToCgroup(const base::FilePath& cgroup, pid_t tid) {
+  const std::string tid_string = base::StringPrintf("%d", tid);
+  for (const char* name : {"cgroup.threads", "tasks"}) {
+    ScopedFileHandle handle(
+        OpenFileForWrite(cgroup.Append(name),
+                         FileWriteMode::kReuseOrFail,
+                         FilePermissions::kOwnerOnly));
+    if (handle.is_valid()) {
+      return LoggingWriteFile(
+          handle.get(), tid_string.data(), tid_string.size());
+    }
+  }
+
+  PLOG(ERROR) << "open " << cgroup.value();
+  return false;
+}
+
+}  // namespace
+
+constexpr int ResourceGovernor::kNiceUnchanged;
+
+ResourceGovernor::Options::Options()
+    : policies(),
+      max_load_per_cpu(1),
+      max_cpu_pressure(20),
+      max_io_pressure(20),
+      poll_interval(5),
+      proc_path("/proc"),
+      cpu_count(0) {
+  ClassPolicy& capture = policies[static_cast<size_t>(WorkClass::kCapture)];
+  capture.nice = kNiceUnchanged;
+  capture.io_class = IOPriorityClass::kUnchanged;
+  capture.io_level = 0;
+
+  ClassPolicy& upload = policies[static_cast<size_t>(WorkClass::kUpload)];
+  upload.nice = 10;
+  upload.io_class = IOPriorityClass::kBestEffort;
+  upload.io_level = 7;
+
+  ClassPolicy& maintenance =
+      policies[static_cast<size_t>(WorkClass::kMaintenance)];
+  maintenance.nice = 19;
+  maintenance.io_class = IOPriorityClass::kIdle;
+  maintenance.io_level = 0;
+}
+
+ResourceGovernor::ResourceGovernor(const Options& options)
+    : options_(options), cpu_count_(options.cpu_count) {
+  if (cpu_count_ <= 0) {
+    long cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+    cpu_count_ = cpu_count > 0 ? static_cast<int>(cpu_count) : 1;
+  }
+}
+
+ResourceGovernor::~ResourceGovernor() {}
+
+bool ResourceGovernor::ApplyToCurrentThread(WorkClass work_class) const {
+  DCHECK_LT(static_cast<size_t>(work_class),
+            static_cast<size_t>(WorkClass::kCount));
+  const ClassPolicy& policy =
+      options_.policies[static_cast<size_t>(work_class)];
+  const pid_t tid = GetTid();
+  bool success = true;
+
+  // On Linux, these calls affect only the thread identified by |tid|, not its
+  // whole process.
+  if (policy.nice != kNiceUnchanged &&
+      setpriority(PRIO_PROCESS, tid, policy.nice) != 0) {
+    PLOG(ERROR) << "setpriority";
+    success = false;
+  }
+
+  if (policy.io_class != IOPriorityClass::kUnchanged) {
+    const int level =
+        policy.io_class == IOPriorityClass::kIdle ? 0 : policy.io_level;
+    const int ioprio =
+        (static_cast<int>(policy.io_class) << kIOPrioClassShift) | level;
+    if (syscall(SYS_ioprio_set, kIOPrioWhoProcess, tid, ioprio) != 0) {
+      PLOG(ERROR) << "ioprio_set";
+      success = false;
+    }
+  }
+
+  if (!policy.cgroup.empty() && !MoveToCgroup(policy.cgroup, tid)) {
+    success = false;
+  }
+
+  return success;
+}
+
+bool ResourceGovernor::IsBusy() const {
+  std::string contents;
+
+  if (options_.max_load_per_cpu > 0 &&
+      ReadFileQuietly(options_.proc_path.Append("loadavg"), &contents)) {
+    char* end;
+    const double load = strtod(contents.c_str(), &end);
+    if (end != contents.c_str() &&
+        load / cpu_count_ > options_.max_load_per_cpu) {
+      return true;
+    }
+  }
+
+  const base::FilePath pressure_path = options_.proc_path.Append("pressure");
+  PressureStallInformation pressure;
+  if (options_.max_cpu_pressure > 0 &&
+      ReadFileQuietly(pressure_path.Append("cpu"), &contents) &&
+      ParsePressureStallInformation(contents, &pressure) &&
+      pressure.some_avg10 > options_.max_cpu_pressure) {
+    return true;
+  }
+
+  if (options_.max_io_pressure > 0 &&
+      ReadFileQuietly(pressure_path.Append("io"), &contents) &&
+      ParsePressureStallInformation(contents, &pressure) &&
+      pressure.some_avg10 > options_.max_io_pressure) {
+    return true;
+  }
+
+  return false;
+}
+
+bool ResourceGovernor::WaitWhileBusy(WorkClass work_class,
+                                     double max_wait) const {
+  if (work_class == WorkClass::kCapture) {
+    return true;
+  }
+
+  const uint64_t poll_interval =
+      static_cast<uint64_t>(options_.poll_interval * 1E9);
+  const uint64_t deadline =
+      ClockMonotonicNanoseconds() + static_cast<uint64_t>(max_wait * 1E9);
+  while (IsBusy()) {
+    const uint64_t now = ClockMonotonicNanoseconds();
+    if (now >= deadline) {
+      return false;
+    }
+    SleepNanoseconds(std::min(poll_interval, deadline - now));
+  }
+  return true;
+}
+
+}  // namespace crashpad
@@ -0,0 +1,164 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_LINUX_RESOURCE_GOVERNOR_H_
+#define CRASHPAD_UTIL_LINUX_RESOURCE_GOVERNOR_H_
+
+#include <stddef.h>
+
+#include <limits>
+
+#include "base/files/file_path.h"
+#include "base/macros.h"
+
+namespace crashpad {
+
+//! \brief Keeps a handler’s background work from competing with the services
+//!     on the host.
+//!
+//! Each thread that does work on the handler’s behalf calls
+//! ApplyToCurrentThread() with the class of work it does. Crash capture keeps
+//! its normal priority, while uploads and maintenance such as pruning run at
+//! reduced CPU and I/O priority, and optionally in a separate cgroup. Before
+//! each unit of background work, such as an upload, the thread calls
+//! WaitWhileBusy() to defer the work while the host is heavily loaded.
+class ResourceGovernor {
+ public:
+  //! \brief A class of work.
+  enum class WorkClass {
+    //! \brief Capturing a crash, which should not be delayed.
+    kCapture = 0,
+
+    //! \brief Compressing and uploading reports.
+    kUpload,
+
+    //! \brief Pruning and other database maintenance.
+    kMaintenance,
+
+    //! \brief The number of classes.
+    kCount,
+  };
+
+  //! \brief The I/O scheduling classes for `ioprio_set()`.
+  enum class IOPriorityClass {
+    //! \brief Leave the I/O priority unchanged.
+    kUnchanged = 0,
+
+    //! \brief `IOPRIO_CLASS_BE`, best-effort scheduling.
+    kBestEffort = 2,
+
+    //! \brief `IOPRIO_CLASS_IDLE`, scheduling only when no other I/O is
+    //!     pending.
+    kIdle = 3,
+  };
+
+  //! \brief A ClassPolicy::nice value that leaves the nice value unchanged.
+  static constexpr int kNiceUnchanged = std::numeric_limits<int>::max();
+
+  //! \brief How a class of work is run.
+  struct ClassPolicy {
+    //! \brief The nice value, from `-20` to `19`, or #kNiceUnchanged. Lowering
+    //!     a thread’s nice value may require privileges.
+    int nice;
+
+    //! \brief The I/O scheduling class.
+    IOPriorityClass io_class;
+
+    //! \brief The priority within #io_class, from `0` (highest) to `7`
+    //!     (lowest). Ignored for IOPriorityClass::kIdle.
+    int io_level;
+
+    //! \brief A cgroup directory to move the thread to, or an empty path to
+    //!     leave the thread’s cgroup unchanged.
+    //!
+    //! The thread is moved by writing its ID to `cgroup.threads` in this
+    //! directory, which requires a threaded cgroup v2 hierarchy, or to `tasks`
+    //! for cgroup v1.
+    base::FilePath cgroup;
+  };
+
+  //! \brief Configuration for a ResourceGovernor.
+  struct Options {
+    Options();
+
+    //! \brief The policy for each WorkClass, indexed by its value.
+    //!
+    //! By default, capture runs with its priorities unchanged. Uploads run at
+    //! nice `10` and best-effort I/O level `7`. Maintenance runs at nice `19`
+    //! and idle I/O.
+    ClassPolicy policies[static_cast<size_t>(WorkClass::kCount)];
+
+    //! \brief The host is busy when its one-minute load average divided by the
+    //!     number of online CPUs exceeds this. `0` disables this test.
+    double max_load_per_cpu;
+
+    //! \brief The host is busy when some task was stalled on CPU for more than
+    //!     this percentage of the last 10 seconds. `0` disables this test.
+    double max_cpu_pressure;
+
+    //! \brief The host is busy when some task was stalled on I/O for more than
+    //!     this percentage of the last 10 seconds. `0` disables this test.
+    double max_io_pressure;
+
+    //! \brief The interval, in seconds, at which WaitWhileBusy() checks whether
+    //!     the host is still busy.
+    double poll_interval;
+
+    //! \brief The directory to read `loadavg` and `pressure/cpu` and
+    //!     `pressure/io` from, in place of `/proc`.
+    base::FilePath proc_path;
+
+    //! \brief The number of online CPUs, or `0` to determine it from the
+    //!     system.
+    int cpu_count;
+  };
+
+  explicit ResourceGovernor(const Options& options);
+  ~ResourceGovernor();
+
+  //! \brief Applies the policy for \a work_class to the calling thread.
+  //!
+  //! \return `true` on success. `false` if any part of the policy could not be
+  //!     applied, with a message logged. Other parts of the policy are still
+  //!     applied.
+  bool ApplyToCurrentThread(WorkClass work_class) const;
+
+  //! \brief Determines whether the host is busy.
+  //!
+  //! Information that cannot be read, such as pressure stall information on
+  //! kernels without it, is ignored.
+  bool IsBusy() const;
+
+  //! \brief Blocks while the host is busy.
+  //!
+  //! Work of class WorkClass::kCapture never waits.
+  //!
+  //! \param[in] work_class The class of the work about to be done.
+  //! \param[in] max_wait The maximum time to wait, in seconds.
+  //!
+  //! \return `true` if the host is not busy. `false` if \a max_wait elapsed
+  //!     while the host was still busy. The caller may do its work anyway, or
+  //!     defer it further.
+  bool WaitWhileBusy(WorkClass work_class, double max_wait) const;
+
+ private:
+  Options options_;
+  int cpu_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(ResourceGovernor);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_LINUX_RESOURCE_GOVERNOR_H_
@@ -0,0 +1,246 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/linux/resource_governor.h"
+
+#include <errno.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+
+#include "base/strings/stringprintf.h"
+#include "gtest/gtest.h"
+#include "test/errors.h"
+#include "test/scoped_temp_dir.h"
+#include "util/file/file_io.h"
+#include "util/thread/thread.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+pid_t GetTid() {
+  return static_cast<pid_t>(syscall(SYS_gettid));
+}
+
+void WriteTestFile(const base::FilePath& path, const std::string& contents) {
+  ScopedFileHandle handle(LoggingOpenFileForWrite(
+      path, FileWriteMode::kTruncateOrCreate, FilePermissions::kOwnerOnly));
+  ASSERT_TRUE(handle.is_valid());
+  ASSERT_TRUE(LoggingWriteFile(handle.get(), contents.data(), contents.size()));
+}
+
+std::string ReadTestFile(const base::FilePath& path) {
+  std::string contents;
+  EXPECT_TRUE(LoggingReadEntireFile(path, &contents));
+  return contents;
+}
+
+// Applies a policy on a separate thread, so that the test’s own thread keeps
+// its priorities.
+class ApplyThread : public Thread {
+ public:
+  ApplyThread(const ResourceGovernor* governor,
+              ResourceGovernor::WorkClass work_class)
+      : Thread(),
+        governor_(governor),
+        work_class_(work_class),
+        tid_(-1),
+        nice_(0),
+        ioprio_(-1),
+        success_(false) {}
+  ~ApplyThread() override {}
+
+  pid_t tid() const { return tid_; }
+  int nice() const { return nice_; }
+  int ioprio() const { return ioprio_; }
+  bool success() const { return success_; }
+
+ private:
+  void ThreadMain() override {
+    tid_ = GetTid();
+    success_ = governor_->ApplyToCurrentThread(work_class_);
+
+    errno = 0;
+    nice_ = getpriority(PRIO_PROCESS, tid_);
+    EXPECT_EQ(errno, 0) << ErrnoMessage("getpriority");
+
+    ioprio_ = static_cast<int>(syscall(SYS_ioprio_get, 1, tid_));
+    EXPECT_GE(ioprio_, 0) << ErrnoMessage("ioprio_get");
+  }
+
+  const ResourceGovernor* governor_;
+  ResourceGovernor::WorkClass work_class_;
+  pid_t tid_;
+  int nice_;
+  int ioprio_;
+  bool success_;
+
+  DISALLOW_COPY_AND_ASSIGN(ApplyThread);
+};
+
+TEST(ResourceGovernor, ApplyToCurrentThread) {
+  errno = 0;
+  const int original_nice = getpriority(PRIO_PROCESS, GetTid());
+  ASSERT_EQ(errno, 0) << ErrnoMessage("getpriority");
+
+  ScopedTempDir temp_dir;
+  const base::FilePath cgroup = temp_dir.path();
+  ASSERT_NO_FATAL_FAILURE(
+      WriteTestFile(cgroup.Append(FILE_PATH_LITERAL("cgroup.threads")), ""));
+
+  ResourceGovernor::Options options;
+  options.policies[static_cast<size_t>(ResourceGovernor::WorkClass::kUpload)]
+      .cgroup = cgroup;
+  ResourceGovernor governor(options);
+
+  ApplyThread upload(&governor, ResourceGovernor::WorkClass::kUpload);
+  upload.Start();
+  upload.Join();
+  EXPECT_TRUE(upload.success());
+  EXPECT_EQ(upload.nice(), std::max(original_nice, 10));
+  EXPECT_EQ(upload.ioprio(), (2 << 13) | 7);
+  EXPECT_EQ(ReadTestFile(cgroup.Append(FILE_PATH_LITERAL("cgroup.threads"))),
+            base::StringPrintf("%d", upload.tid()));
+
+  ApplyThread maintenance(&governor, ResourceGovernor::WorkClass::kMaintenance);
+  maintenance.Start();
+  maintenance.Join();
+  EXPECT_TRUE(maintenance.success());
+  EXPECT_EQ(maintenance.nice(), 19);
+  EXPECT_EQ(maintenance.ioprio() >> 13, 3);
+
+  ApplyThread capture(&governor, ResourceGovernor::WorkClass::kCapture);
+  capture.Start();
+  capture.Join();
+  EXPECT_TRUE(capture.success());
+  EXPECT_EQ(capture.nice(), original_nice);
+
+  // The test’s own thread is unaffected.
+  errno = 0;
+  EXPECT_EQ(getpriority(PRIO_PROCESS, GetTid()), original_nice);
+}
+
+TEST(ResourceGovernor, MissingCgroup) {
+  ScopedTempDir temp_dir;
+
+  ResourceGovernor::Options options;
+  options.policies[static_cast<size_t>(ResourceGovernor::WorkClass::kUpload)]
+      .cgroup = temp_dir.path().Append(FILE_PATH_LITERAL("missing"));
+  ResourceGovernor governor(options);
+
+  ApplyThread upload(&governor, ResourceGovernor::WorkClass::kUpload);
+  upload.Start();
+  upload.Join();
+  EXPECT_FALSE(upload.success());
+
+  // The rest of the policy is still applied.
+  EXPECT_EQ(upload.ioprio(), (2 << 13) | 7);
+}
+
+class ResourceGovernorBusyTest : public testing::Test {
+ protected:
+  ResourceGovernorBusyTest() : temp_dir_(), options_() {}
+
+  void SetUp() override {
+    options_.proc_path = temp_dir_.path();
+    options_.cpu_count = 4;
+    options_.poll_interval = 0.001;
+    ASSERT_EQ(mkdir(PressurePath().value().c_str(), 0700), 0)
+        << ErrnoMessage("mkdir");
+  }
+
+  base::FilePath PressurePath() const {
+    return temp_dir_.path().Append(FILE_PATH_LITERAL("pressure"));
+  }
+
+  void SetLoadAverage(const std::string& loadavg) {
+    WriteTestFile(temp_dir_.path().Append(FILE_PATH_LITERAL("loadavg")),
+                  loadavg);
+  }
+
+  void SetPressure(const char* resource, double some_avg10) {
+    WriteTestFile(
+        PressurePath().Append(resource),
+        base::StringPrintf(
+            "some avg10=%.2f avg60=0.00 avg300=0.00 total=0\n"
+            "full avg10=0.00 avg60=0.00 avg300=0.00 total=0\n",
+            some_avg10));
+  }
+
+  ScopedTempDir temp_dir_;
+  ResourceGovernor::Options options_;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(ResourceGovernorBusyTest);
+};
+
+TEST_F(ResourceGovernorBusyTest, NoInformation) {
+  ResourceGovernor governor(options_);
+  EXPECT_FALSE(governor.IsBusy());
+}
+
+TEST_F(ResourceGovernorBusyTest, LoadAverage) {
+  ResourceGovernor governor(options_);
+
+  ASSERT_NO_FATAL_FAILURE(SetLoadAverage("3.50 2.00 1.00 2/345 6789\n"));
+  EXPECT_FALSE(governor.IsBusy());
+
+  ASSERT_NO_FATAL_FAILURE(SetLoadAverage("8.25 2.00 1.00 2/345 6789\n"));
+  EXPECT_TRUE(governor.IsBusy());
+
+  options_.max_load_per_cpu = 0;
+  ResourceGovernor disabled_governor(options_);
+  EXPECT_FALSE(disabled_governor.IsBusy());
+}
+
+TEST_F(ResourceGovernorBusyTest, Pressure) {
+  ResourceGovernor governor(options_);
+
+  ASSERT_NO_FATAL_FAILURE(SetPressure("cpu", 5));
+  ASSERT_NO_FATAL_FAILURE(SetPressure("io", 5));
+  EXPECT_FALSE(governor.IsBusy());
+
+  ASSERT_NO_FATAL_FAILURE(SetPressure("cpu", 45));
+  EXPECT_TRUE(governor.IsBusy());
+
+  ASSERT_NO_FATAL_FAILURE(SetPressure("cpu", 5));
+  ASSERT_NO_FATAL_FAILURE(SetPressure("io", 45));
+  EXPECT_TRUE(governor.IsBusy());
+}
+
+TEST_F(ResourceGovernorBusyTest, WaitWhileBusy) {
+  ResourceGovernor governor(options_);
+
+  EXPECT_TRUE(
+      governor.WaitWhileBusy(ResourceGovernor::WorkClass::kUpload, 0));
+
+  ASSERT_NO_FATAL_FAILURE(SetPressure("io", 45));
+  EXPECT_FALSE(
+      governor.WaitWhileBusy(ResourceGovernor::WorkClass::kUpload, 0.01));
+  EXPECT_FALSE(
+      governor.WaitWhileBusy(ResourceGovernor::WorkClass::kMaintenance, 0));
+
+  // Capture never waits.
+  EXPECT_TRUE(
+      governor.WaitWhileBusy(ResourceGovernor::WorkClass::kCapture, 0));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
@@ -0,0 +1,369 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/linux/scoped_process_freeze.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "base/logging.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/stringprintf.h"
+#include "util/file/file_io.h"
+#include "util/linux/proc_task_reader.h"
+#include "util/linux/read_file_quietly.h"
+#include "util/linux/related_processes.h"
+#include "util/misc/clock.h"
+
+namespace crashpad {
+
+namespace {
+
+constexpr uint64_t kPollIntervalNanoseconds = 100 * 1000;
+
+uint64_t DeadlineNanoseconds(double timeout_seconds) {
+  return ClockMonotonicNanoseconds() +
+         static_cast<uint64_t>(timeout_seconds * 1E9);
+}
+
+// Finds the value of |key| in a file of lines of the form “key value”, as used
+// by cgroup.events and cgroup.stat.
+bool ReadKeyedValue(const base::FilePath& path,
+                    const std::string& key,
+                    std::string* value) {
+  std::string contents;
+  if (!ReadFileQuietly(path, &contents)) {
+    return false;
+  }
+
+  const std::string prefix = key + " ";
+  size_t line_start = 0;
+  while (line_start < contents.size()) {
+    size_t line_end = contents.find('\n', line_start);
+    if (line_end == std::string::npos) {
+      line_end = contents.size();
+    }
+    if (contents.compare(line_start, prefix.size(), prefix) == 0) {
+      *value = contents.substr(line_start + prefix.size(),
+                               line_end - line_start - prefix.size());
+      return true;
+    }
+    line_start = line_end + 1;
+  }
+  return false;
+}
+
+// Finds the cgroup v2 directory containing exactly the processes |pids|,
+// sorted, if it has no descendants, so that freezing it freezes nothing else.
+bool FindExclusiveCgroup(const std::vector<pid_t>& pids,
+                         base::FilePath* directory) {
+  base::FilePath cgroup_directory;
+  if (pids.empty() || !FindCgroupDirectory(pids[0], &cgroup_directory)) {
+    return false;
+  }
+
+  // cgroup.procs lists one process ID per line, in no particular order.
+  std::string procs;
+  if (!ReadFileQuietly(cgroup_directory.Append("cgroup.procs"), &procs)) {
+    return false;
+  }
+  std::vector<pid_t> members;
+  size_t line_start = 0;
+  while (line_start < procs.size()) {
+    size_t line_end = procs.find('\n', line_start);
+    if (line_end == std::string::npos) {
+      line_end = procs.size();
+    }
+    pid_t member;
+    if (!base::StringToInt(
+            base::StringPiece(&procs[line_start], line_end - line_start),
+            &member)) {
+      return false;
+    }
+    members.push_back(member);
+    line_start = line_end + 1;
+  }
+  std::sort(members.begin(), members.end());
+  if (members != pids) {
+    return false;
+  }
+
+  std::string descendants;
+  if (!ReadKeyedValue(cgroup_directory.Append("cgroup.stat"),
+                      "nr_descendants",
+                      &descendants) ||
+      descendants != "0") {
+    return false;
+  }
+
+  if (access(cgroup_directory.Append("cgroup.freeze").value().c_str(),
+             W_OK) != 0) {
+    return false;
+  }
+
+  *directory = cgroup_directory;
+  return true;
+}
+
+bool WriteCgroupFreeze(const base::FilePath& directory, bool freeze) {
+  const base::FilePath path = directory.Append("cgroup.freeze");
+  ScopedFileHandle handle(LoggingOpenFileForWrite(
+      path, FileWriteMode::kReuseOrFail, FilePermissions::kOwnerOnly));
+  if (!handle.is_valid()) {
+    return false;
+  }
+  return LoggingWriteFile(handle.get(), freeze ? "1" : "0", 1);
+}
+
+// Reads the state of thread |tid| in process |pid| from the third column of
+// /proc/[pid]/task/[tid]/stat. This is much faster than /proc/[tid]/stat for
+// threads other than the main thread, and doesn’t log if the thread has
+// exited.
+bool ReadThreadState(pid_t pid, pid_t tid, char* state) {
+  std::string contents;
+  if (!ReadFileQuietly(base::FilePath(base::StringPrintf(
+                           "/proc/%d/task/%d/stat", pid, tid)),
+                       &contents)) {
+    return false;
+  }
+
+  // The executable name in the second column may contain parentheses itself,
+  // so find its end by working backwards.
+  const size_t name_end = contents.rfind(')');
+  if (name_end == std::string::npos || name_end + 2 >= contents.size()) {
+    return false;
+  }
+  *state = contents[name_end + 2];
+  return true;
+}
+
+// Waits until every thread in process |pid| is stopped by a signal or by
+// ptrace, or until |deadline|.
+bool WaitForThreadsStopped(pid_t pid, uint64_t deadline) {
+  // Threads can’t leave group-stop until the process is continued, so each
+  // thread only needs to be seen stopped once. This keeps each pass
+  // proportional to the number of threads still running.
+  std::vector<pid_t> stopped_tids;
+  std::vector<pid_t> newly_stopped_tids;
+  std::vector<pid_t> previous_tids;
+  std::vector<pid_t> tids;
+  while (true) {
+    if (!ReadThreadIDs(pid, &tids)) {
+      return false;
+    }
+
+    bool all_stopped = true;
+    newly_stopped_tids.clear();
+    for (pid_t tid : tids) {
+      if (std::binary_search(stopped_tids.begin(), stopped_tids.end(), tid)) {
+        continue;
+      }
+
+      // A thread that has exited since it was enumerated can’t run again.
+      char state;
+      if (!ReadThreadState(pid, tid, &state) || state == 'T' || state == 't' ||
+          state == 'Z' || state == 'X') {
+        newly_stopped_tids.push_back(tid);
+      } else {
+        all_stopped = false;
+      }
+    }
+    if (!newly_stopped_tids.empty()) {
+      stopped_tids.insert(stopped_tids.end(),
+                          newly_stopped_tids.begin(),
+                          newly_stopped_tids.end());
+      std::sort(stopped_tids.begin(), stopped_tids.end());
+    }
+
+    // A thread that was being created as the stop began joins it, and only
+    // appears in a later enumeration. The threads have settled once an
+    // enumeration finds the same threads, all stopped.
+    if (all_stopped && tids == previous_tids) {
+      return true;
+    }
+
+    if (ClockMonotonicNanoseconds() >= deadline) {
+      LOG(ERROR) << "timed out waiting for threads to stop";
+      return false;
+    }
+
+    if (!all_stopped) {
+      SleepNanoseconds(kPollIntervalNanoseconds);
+    }
+    previous_tids.swap(tids);
+  }
+}
+
+}  // namespace
+
+ScopedProcessFreeze::ScopedProcessFreeze()
+    : cgroup_directory_(),
+      stopped_pids_(),
+      method_(Method::kNone),
+      was_frozen_(false) {}
+
+ScopedProcessFreeze::~ScopedProcessFreeze() {
+  Reset();
+}
+
+bool ScopedProcessFreeze::Reset() {
+  bool result = true;
+  switch (method_) {
+    case Method::kCgroupFreezer:
+      if (!was_frozen_) {
+        result = WriteCgroupFreeze(cgroup_directory_, false);
+      }
+      break;
+
+    case Method::kGroupStop:
+      for (pid_t pid : stopped_pids_) {
+        if (kill(pid, SIGCONT) != 0 && errno != ESRCH) {
+          PLOG(ERROR) << "kill";
+          result = false;
+        }
+      }
+      break;
+
+    case Method::kNone:
+    case Method::kAutomatic:
+      break;
+  }
+
+  cgroup_directory_ = base::FilePath();
+  stopped_pids_.clear();
+  method_ = Method::kNone;
+  was_frozen_ = false;
+  return result;
+}
+
+bool ScopedProcessFreeze::ResetFreeze(pid_t pid,
+                                      Method method,
+                                      double timeout_seconds) {
+  return ResetFreeze(std::vector<pid_t>(1, pid), method, timeout_seconds);
+}
+
+bool ScopedProcessFreeze::ResetFreeze(const std::vector<pid_t>& pids,
+                                      Method method,
+                                      double timeout_seconds) {
+  DCHECK(method != Method::kNone);
+  DCHECK(!pids.empty());
+  Reset();
+
+  std::vector<pid_t> sorted_pids(pids);
+  std::sort(sorted_pids.begin(), sorted_pids.end());
+  sorted_pids.erase(std::unique(sorted_pids.begin(), sorted_pids.end()),
+                    sorted_pids.end());
+
+  switch (method) {
+    case Method::kAutomatic:
+      if (FindExclusiveCgroup(sorted_pids, &cgroup_directory_) &&
+          FreezeCgroup(timeout_seconds)) {
+        return true;
+      }
+      return FreezeGroupStop(sorted_pids, timeout_seconds);
+
+    case Method::kCgroupFreezer:
+      if (!FindExclusiveCgroup(sorted_pids, &cgroup_directory_)) {
+        LOG(ERROR) << "no cgroup v2 cgroup to freeze for process "
+                   << sorted_pids[0];
+        return false;
+      }
+      return FreezeCgroup(timeout_seconds);
+
+    case Method::kGroupStop:
+      return FreezeGroupStop(sorted_pids, timeout_seconds);
+
+    case Method::kNone:
+      break;
+  }
+  return false;
+}
+
+bool ScopedProcessFreeze::FreezeCgroup(double timeout_seconds) {
+  std::string frozen;
+  if (!LoggingReadEntireFile(cgroup_directory_.Append("cgroup.freeze"),
+                             &frozen)) {
+    return false;
+  }
+  was_frozen_ = frozen == "1\n";
+
+  if (!was_frozen_ && !WriteCgroupFreeze(cgroup_directory_, true)) {
+    return false;
+  }
+  method_ = Method::kCgroupFreezer;
+
+  // The kernel reports “frozen 1” in cgroup.events once every thread in the
+  // cgroup has stopped.
+  const uint64_t deadline = DeadlineNanoseconds(timeout_seconds);
+  const base::FilePath events = cgroup_directory_.Append("cgroup.events");
+  while (true) {
+    if (!ReadKeyedValue(events, "frozen", &frozen)) {
+      LOG(ERROR) << "could not read " << events.value();
+      break;
+    }
+    if (frozen == "1") {
+      return true;
+    }
+    if (ClockMonotonicNanoseconds() >= deadline) {
+      LOG(ERROR) << "timed out waiting for cgroup to freeze";
+      break;
+    }
+    SleepNanoseconds(kPollIntervalNanoseconds);
+  }
+
+  Reset();
+  return false;
+}
+
+bool ScopedProcessFreeze::FreezeGroupStop(const std::vector<pid_t>& pids,
+                                          double timeout_seconds) {
+  method_ = Method::kGroupStop;
+
+  // Every process is sent SIGSTOP before waiting for any of them, so that they
+  // stop together rather than one after another.
+  for (pid_t pid : pids) {
+    char state;
+    if (!ReadThreadState(pid, pid, &state)) {
+      LOG(ERROR) << "could not read state of process " << pid;
+      Reset();
+      return false;
+    }
+    if (state == 'T') {
+      continue;
+    }
+
+    if (kill(pid, SIGSTOP) != 0) {
+      PLOG(ERROR) << "kill";
+      Reset();
+      return false;
+    }
+    stopped_pids_.push_back(pid);
+  }
+
+  const uint64_t deadline = DeadlineNanoseconds(timeout_seconds);
+  for (pid_t pid : pids) {
+    if (!WaitForThreadsStopped(pid, deadline)) {
+      Reset();
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace crashpad
@@ -0,0 +1,129 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_LINUX_SCOPED_PROCESS_FREEZE_H_
+#define CRASHPAD_UTIL_LINUX_SCOPED_PROCESS_FREEZE_H_
+
+#include <sys/types.h>
+
+#include <vector>
+
+#include "base/files/file_path.h"
+#include "base/macros.h"
+
+namespace crashpad {
+
+//! \brief Stops every thread in a process at once, so that the set of threads
+//!     and their state don’t change while they are attached one at a time.
+//!
+//! Attaching to each thread with `ptrace()` as it is found races with threads
+//! that are still running and creating new threads. Once the process is frozen,
+//! no thread can run or create another, so a single enumeration of
+//! `/proc/[pid]/task` is complete. Threads that are frozen can still be
+//! attached with ScopedPtraceAttach::ResetSeize().
+//!
+//! On destruction, the process is resumed.
+class ScopedProcessFreeze {
+ public:
+  //! \brief The ways in which a process may be frozen.
+  enum class Method {
+    //! \brief The process has not been frozen.
+    kNone = 0,
+
+    //! \brief Uses #kCgroupFreezer if the process can be frozen that way, and
+    //!     #kGroupStop otherwise.
+    kAutomatic,
+
+    //! \brief Writes to `cgroup.freeze` of the process’ cgroup v2 cgroup.
+    //!
+    //! This is only used if the process is the only one in its cgroup, which
+    //! has no descendants, so that no other process is frozen along with it.
+    //! It is invisible to the process and its parent.
+    kCgroupFreezer,
+
+    //! \brief Sends `SIGSTOP` to the process, putting all of its threads into
+    //!     group-stop, and `SIGCONT` to resume it.
+    //!
+    //! The process’ parent may observe the stop and continuation. If the
+    //! process was already stopped, it is left stopped.
+    kGroupStop,
+  };
+
+  ScopedProcessFreeze();
+  ~ScopedProcessFreeze();
+
+  //! \brief Resumes the process, if it was frozen.
+  //!
+  //! \return `true` on success. `false` on failure, with a message logged.
+  bool Reset();
+
+  //! \brief Resumes any previously frozen process, freezes the process with
+  //!     process ID \a pid, and blocks until all of its threads have stopped.
+  //!
+  //! \param[in] pid The process ID of the process to freeze.
+  //! \param[in] method The method to use. This must not be Method::kNone.
+  //! \param[in] timeout_seconds The maximum time to wait for the threads to
+  //!     stop.
+  //!
+  //! \return `true` on success. `false` on failure, with a message logged, in
+  //!     which case the process is not left frozen.
+  bool ResetFreeze(pid_t pid, Method method, double timeout_seconds);
+
+  //! \brief Resumes any previously frozen processes, freezes the processes
+  //!     with process IDs \a pids together, and blocks until all of their
+  //!     threads have stopped.
+  //!
+  //! With Method::kCgroupFreezer, the processes must be exactly those in a
+  //! cgroup with no descendants. With Method::kGroupStop, every process is sent
+  //! `SIGSTOP` before waiting for any to stop, so that none runs on for long
+  //! after the others have stopped.
+  //!
+  //! \param[in] pids The process IDs of the processes to freeze. This must not
+  //!     be empty.
+  //! \param[in] method The method to use. This must not be Method::kNone.
+  //! \param[in] timeout_seconds The maximum time to wait for all of the
+  //!     threads to stop.
+  //!
+  //! \return `true` on success. `false` on failure, with a message logged, in
+  //!     which case none of the processes are left frozen.
+  bool ResetFreeze(const std::vector<pid_t>& pids,
+                   Method method,
+                   double timeout_seconds);
+
+  //! \brief Returns the method with which the process was frozen, or
+  //!     Method::kNone if it isn’t frozen.
+  Method method() const { return method_; }
+
+ private:
+  bool FreezeCgroup(double timeout_seconds);
+  bool FreezeGroupStop(const std::vector<pid_t>& pids, double timeout_seconds);
+
+  base::FilePath cgroup_directory_;
+
+  // The processes sent SIGSTOP by Method::kGroupStop. Processes that were
+  // already stopped aren’t included, so Reset() leaves them stopped.
+  std::vector<pid_t> stopped_pids_;
+
+  Method method_;
+
+  // Whether the cgroup was already frozen by some other means, in which case
+  // Reset() leaves it frozen.
+  bool was_frozen_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedProcessFreeze);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_LINUX_SCOPED_PROCESS_FREEZE_H_
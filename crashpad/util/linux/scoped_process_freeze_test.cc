@@ -0,0 +1,317 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/linux/scoped_process_freeze.h"
+
+#include <dirent.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/ptrace.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/stringprintf.h"
+#include "gtest/gtest.h"
+#include "test/errors.h"
+#include "test/multiprocess.h"
+#include "util/file/file_io.h"
+#include "util/linux/proc_stat_reader.h"
+#include "util/linux/scoped_ptrace_attach.h"
+#include "util/misc/clock.h"
+#include "util/posix/scoped_dir.h"
+#include "util/thread/thread.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+constexpr double kTimeoutSeconds = 5;
+
+std::vector<pid_t> ThreadIDs(pid_t pid) {
+  std::vector<pid_t> tids;
+  const std::string path = base::StringPrintf("/proc/%d/task", pid);
+  DIR* dir = opendir(path.c_str());
+  EXPECT_TRUE(dir) << ErrnoMessage("opendir");
+  if (!dir) {
+    return tids;
+  }
+  ScopedDIR scoped_dir(dir);
+
+  dirent* dir_entry;
+  while ((dir_entry = readdir(scoped_dir.get()))) {
+    pid_t tid;
+    if (base::StringToInt(dir_entry->d_name, &tid)) {
+      tids.push_back(tid);
+    }
+  }
+  return tids;
+}
+
+char ThreadState(pid_t tid) {
+  ProcStatReader stat;
+  char state;
+  if (!stat.Initialize(tid) || !stat.State(&state)) {
+    return '\0';
+  }
+  return state;
+}
+
+// Returns whether the thread was seen running within a short time.
+bool ThreadResumes(pid_t tid) {
+  for (int attempt = 0; attempt < 1000; ++attempt) {
+    if (ThreadState(tid) != 'T') {
+      return true;
+    }
+    SleepNanoseconds(1000 * 1000);
+  }
+  return false;
+}
+
+class SpinningThread : public Thread {
+ public:
+  explicit SpinningThread(const std::atomic<bool>* stop) : stop_(stop) {}
+  ~SpinningThread() override {}
+
+ private:
+  void ThreadMain() override {
+    while (!stop_->load()) {
+    }
+  }
+
+  const std::atomic<bool>* stop_;  // weak
+
+  DISALLOW_COPY_AND_ASSIGN(SpinningThread);
+};
+
+// Continually creates short-lived threads, racing with the freeze.
+class SpawningThread : public Thread {
+ public:
+  explicit SpawningThread(const std::atomic<bool>* stop) : stop_(stop) {}
+  ~SpawningThread() override {}
+
+ private:
+  void ThreadMain() override {
+    std::atomic<bool> child_stop(true);
+    while (!stop_->load()) {
+      SpinningThread child(&child_stop);
+      child.Start();
+      child.Join();
+    }
+  }
+
+  const std::atomic<bool>* stop_;  // weak
+
+  DISALLOW_COPY_AND_ASSIGN(SpawningThread);
+};
+
+class FreezeTest : public Multiprocess {
+ public:
+  FreezeTest(ScopedProcessFreeze::Method method, bool already_stopped)
+      : Multiprocess(),
+        method_(method),
+        already_stopped_(already_stopped) {}
+  ~FreezeTest() {}
+
+ private:
+  void MultiprocessParent() override {
+    char c;
+    CheckedReadFileExactly(ReadPipeHandle(), &c, sizeof(c));
+    const pid_t pid = ChildPID();
+
+    if (already_stopped_) {
+      ASSERT_EQ(kill(pid, SIGSTOP), 0) << ErrnoMessage("kill");
+      while (ThreadState(pid) != 'T') {
+        SleepNanoseconds(1000 * 1000);
+      }
+    }
+
+    {
+      ScopedProcessFreeze freeze;
+      ASSERT_TRUE(freeze.ResetFreeze(pid, method_, kTimeoutSeconds));
+      if (method_ == ScopedProcessFreeze::Method::kAutomatic) {
+        EXPECT_NE(freeze.method(), ScopedProcessFreeze::Method::kNone);
+      } else {
+        EXPECT_EQ(freeze.method(), method_);
+      }
+
+      // The threads don’t change while frozen.
+      std::vector<pid_t> tids = ThreadIDs(pid);
+      EXPECT_GE(tids.size(), 4u);
+      SleepNanoseconds(10 * 1000 * 1000);
+      EXPECT_EQ(ThreadIDs(pid), tids);
+
+      if (freeze.method() == ScopedProcessFreeze::Method::kGroupStop) {
+        for (pid_t tid : tids) {
+          EXPECT_EQ(ThreadState(tid), 'T') << tid;
+        }
+      }
+
+      // A frozen thread can be attached and detached without resuming it.
+      ScopedPtraceAttach attach;
+      ASSERT_TRUE(attach.ResetSeize(tids.back()));
+      EXPECT_EQ(ThreadState(tids.back()), 't');
+      ASSERT_TRUE(attach.Reset());
+      SleepNanoseconds(10 * 1000 * 1000);
+      EXPECT_EQ(ThreadIDs(pid), tids);
+    }
+
+    if (already_stopped_) {
+      // A process that was already stopped is left stopped.
+      EXPECT_EQ(ThreadState(pid), 'T');
+      ASSERT_EQ(kill(pid, SIGCONT), 0) << ErrnoMessage("kill");
+    }
+    EXPECT_TRUE(ThreadResumes(pid));
+
+    CheckedWriteFile(WritePipeHandle(), &c, sizeof(c));
+  }
+
+  void MultiprocessChild() override {
+    std::atomic<bool> stop(false);
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int index = 0; index < 2; ++index) {
+      threads.push_back(std::unique_ptr<Thread>(new SpinningThread(&stop)));
+    }
+    threads.push_back(std::unique_ptr<Thread>(new SpawningThread(&stop)));
+    for (auto& thread : threads) {
+      thread->Start();
+    }
+
+    char c = '\0';
+    CheckedWriteFile(WritePipeHandle(), &c, sizeof(c));
+    CheckedReadFileExactly(ReadPipeHandle(), &c, sizeof(c));
+
+    stop.store(true);
+    for (auto& thread : threads) {
+      thread->Join();
+    }
+  }
+
+  ScopedProcessFreeze::Method method_;
+  bool already_stopped_;
+
+  DISALLOW_COPY_AND_ASSIGN(FreezeTest);
+};
+
+TEST(ScopedProcessFreeze, GroupStop) {
+  FreezeTest test(ScopedProcessFreeze::Method::kGroupStop, false);
+  test.Run();
+}
+
+TEST(ScopedProcessFreeze, GroupStopAlreadyStopped) {
+  FreezeTest test(ScopedProcessFreeze::Method::kGroupStop, true);
+  test.Run();
+}
+
+TEST(ScopedProcessFreeze, Automatic) {
+  FreezeTest test(ScopedProcessFreeze::Method::kAutomatic, false);
+  test.Run();
+}
+
+// The child creates a grandchild, and both spin until the parent is done.
+class FreezeSeveralTest : public Multiprocess {
+ public:
+  FreezeSeveralTest() : Multiprocess() {}
+  ~FreezeSeveralTest() {}
+
+ private:
+  void MultiprocessParent() override {
+    pid_t grandchild;
+    CheckedReadFileExactly(ReadPipeHandle(), &grandchild, sizeof(grandchild));
+    const std::vector<pid_t> pids = {ChildPID(), grandchild};
+
+    {
+      ScopedProcessFreeze freeze;
+      ASSERT_TRUE(freeze.ResetFreeze(
+          pids, ScopedProcessFreeze::Method::kGroupStop, kTimeoutSeconds));
+      EXPECT_EQ(freeze.method(), ScopedProcessFreeze::Method::kGroupStop);
+      for (pid_t pid : pids) {
+        for (pid_t tid : ThreadIDs(pid)) {
+          EXPECT_EQ(ThreadState(tid), 'T') << tid;
+        }
+      }
+    }
+
+    for (pid_t pid : pids) {
+      EXPECT_TRUE(ThreadResumes(pid)) << pid;
+    }
+
+    char c = '\0';
+    CheckedWriteFile(WritePipeHandle(), &c, sizeof(c));
+  }
+
+  void MultiprocessChild() override {
+    const pid_t grandchild = fork();
+    ASSERT_GE(grandchild, 0) << ErrnoMessage("fork");
+    if (grandchild == 0) {
+      while (true) {
+      }
+    }
+
+    std::atomic<bool> stop(false);
+    SpinningThread thread(&stop);
+    thread.Start();
+
+    CheckedWriteFile(WritePipeHandle(), &grandchild, sizeof(grandchild));
+    char c;
+    CheckedReadFileExactly(ReadPipeHandle(), &c, sizeof(c));
+
+    stop.store(true);
+    thread.Join();
+    ASSERT_EQ(kill(grandchild, SIGKILL), 0) << ErrnoMessage("kill");
+    ASSERT_EQ(waitpid(grandchild, nullptr, 0), grandchild)
+        << ErrnoMessage("waitpid");
+  }
+
+  DISALLOW_COPY_AND_ASSIGN(FreezeSeveralTest);
+};
+
+TEST(ScopedProcessFreeze, GroupStopSeveral) {
+  FreezeSeveralTest test;
+  test.Run();
+}
+
+class CgroupSharedTest : public Multiprocess {
+ public:
+  CgroupSharedTest() : Multiprocess() {}
+  ~CgroupSharedTest() {}
+
+ private:
+  void MultiprocessParent() override {
+    // The child shares this process’ cgroup, so freezing the cgroup would
+    // freeze this process too.
+    ScopedProcessFreeze freeze;
+    EXPECT_FALSE(freeze.ResetFreeze(ChildPID(),
+                                    ScopedProcessFreeze::Method::kCgroupFreezer,
+                                    kTimeoutSeconds));
+    EXPECT_EQ(freeze.method(), ScopedProcessFreeze::Method::kNone);
+  }
+
+  void MultiprocessChild() override { CheckedReadFileAtEOF(ReadPipeHandle()); }
+
+  DISALLOW_COPY_AND_ASSIGN(CgroupSharedTest);
+};
+
+TEST(ScopedProcessFreeze, CgroupShared) {
+  CgroupSharedTest test;
+  test.Run();
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
@@ -46,7 +46,26 @@ bool ScopedPtraceAttach::ResetAttach(pid_t pid) {
     return false;
   }
   pid_ = pid;
+  return WaitForStop();
+}
+
+bool ScopedPtraceAttach::ResetSeize(pid_t pid) {
+  Reset();
+
+  if (ptrace(PTRACE_SEIZE, pid, nullptr, nullptr) != 0) {
+    PLOG(ERROR) << "ptrace";
+    return false;
+  }
+  pid_ = pid;
+
+  if (ptrace(PTRACE_INTERRUPT, pid_, nullptr, nullptr) != 0) {
+    PLOG(ERROR) << "ptrace";
+    return false;
+  }
+  return WaitForStop();
+}
 
+bool ScopedPtraceAttach::WaitForStop() {
   int status;
   if (HANDLE_EINTR(waitpid(pid_, &status, __WALL)) < 0) {
     PLOG(ERROR) << "waitpid";
@@ -41,7 +41,22 @@ class ScopedPtraceAttach {
   //! \return `true` on success. `false` on failure, with a message logged.
   bool ResetAttach(pid_t pid);
 
+  //! \brief Detaches from any previously attached process, attaches to the
+  //!     process with process ID \a pid with `PTRACE_SEIZE`, interrupts it with
+  //!     `PTRACE_INTERRUPT`, and blocks until it has stopped by calling
+  //!     `waitpid()`.
+  //!
+  //! Unlike ResetAttach(), this doesn’t send `SIGSTOP` to the process. It is
+  //! suitable for attaching to threads that are already stopped, such as
+  //! those of a process frozen by ScopedProcessFreeze, which remain stopped
+  //! once detached.
+  //!
+  //! \return `true` on success. `false` on failure, with a message logged.
+  bool ResetSeize(pid_t pid);
+
  private:
+  bool WaitForStop();
+
   pid_t pid_;
 
   DISALLOW_COPY_AND_ASSIGN(ScopedPtraceAttach);
@@ -71,6 +71,23 @@ void Metrics::CrashUploadAttempted(bool successful) {
                        static_cast<int32_t>(successful));
 }
 
+// static
+void Metrics::CrashUploadCompression(bool gzip_enabled,
+                                     int compression_level,
+                                     int compressed_percent) {
+  UMA_HISTOGRAM_COUNTS("Crashpad.CrashUpload.Gzipped",
+                       static_cast<int32_t>(gzip_enabled));
+  if (gzip_enabled) {
+    UMA_HISTOGRAM_SPARSE_SLOWLY("Crashpad.CrashUpload.GzipLevel",
+                                compression_level);
+  }
+  UMA_HISTOGRAM_CUSTOM_COUNTS("Crashpad.CrashUpload.CompressedPercent",
+                              compressed_percent,
+                              0,
+                              200,
+                              50);
+}
+
 // static
 void Metrics::CrashUploadSkipped(CrashSkippedReason reason) {
   UMA_HISTOGRAM_ENUMERATION(
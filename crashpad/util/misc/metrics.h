@@ -55,6 +55,17 @@ class Metrics {
   //! \brief Reports on a crash upload attempt, and if it succeeded.
   static void CrashUploadAttempted(bool successful);
 
+  //! \brief Reports the compression used for a successful crash upload.
+  //!
+  //! \param[in] gzip_enabled Whether the upload was `gzip`-compressed.
+  //! \param[in] compression_level The zlib compression level used, if \a
+  //!     gzip_enabled is `true`. `-1` denotes zlib’s default level.
+  //! \param[in] compressed_percent The size of the body that was uploaded, as
+  //!     a percentage of the size of the crash report file.
+  static void CrashUploadCompression(bool gzip_enabled,
+                                     int compression_level,
+                                     int compressed_percent);
+
   //! \brief Values for CrashUploadSkipped().
   //!
   //! \note These are used as metrics enumeration values, so new values should
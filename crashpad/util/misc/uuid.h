@@ -41,6 +41,10 @@ struct UUID {
   bool operator==(const UUID& that) const;
   bool operator!=(const UUID& that) const { return !operator==(that); }
 
+  //! \brief Orders UUIDs by their bytes in memory, so that they may be used
+  //!     as keys in ordered containers. The order has no other meaning.
+  bool operator<(const UUID& that) const;
+
   //! \brief Initializes the %UUID to zero.
   void InitializeToZero();
 
@@ -85,9 +85,12 @@ TEST(UUID, UUID) {
   EXPECT_EQ(uuid_2, uuid);
   EXPECT_FALSE(uuid != uuid_2);
 
-  // Make sure that operator== and operator!= check the entire UUID.
+  // Make sure that operator== and operator!= check the entire UUID, and that
+  // operator< orders UUIDs that differ anywhere.
+  EXPECT_FALSE(uuid < uuid_2);
   ++uuid.data_1;
   EXPECT_NE(uuid, uuid_2);
+  EXPECT_NE(uuid < uuid_2, uuid_2 < uuid);
   --uuid.data_1;
   ++uuid.data_2;
   EXPECT_NE(uuid, uuid_2);
@@ -103,6 +106,7 @@ TEST(UUID, UUID) {
   for (size_t index = 0; index < arraysize(uuid.data_5); ++index) {
     ++uuid.data_5[index];
     EXPECT_NE(uuid, uuid_2);
+    EXPECT_NE(uuid < uuid_2, uuid_2 < uuid);
     --uuid.data_5[index];
   }
 
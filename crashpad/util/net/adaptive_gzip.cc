@@ -0,0 +1,224 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/net/adaptive_gzip.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "base/logging.h"
+#include "base/numerics/safe_conversions.h"
+#include "third_party/zlib/zlib_crashpad.h"
+#include "util/misc/clock.h"
+#include "util/misc/zlib.h"
+#include "util/net/http_body_gzip.h"
+
+namespace crashpad {
+
+namespace {
+
+constexpr double kNanosecondsPerSecond = 1E9;
+
+// The weight given to each new measurement in the moving averages.
+constexpr double kSmoothingFactor = 0.3;
+
+// Uploads smaller than this are dominated by latency rather than throughput,
+// and are not used to estimate the network’s throughput.
+constexpr uint64_t kMinimumMeasuredUploadSize = 16 * 1024;
+
+// Durations shorter than this are not measured reliably, and are rounded up to
+// it.
+constexpr uint64_t kMinimumMeasuredNanoseconds = 1000;
+
+double Smooth(double average, double sample) {
+  if (average == 0) {
+    return sample;
+  }
+  return average + kSmoothingFactor * (sample - average);
+}
+
+// Compresses |size| bytes at |data| at |compression_level|, returning the size
+// of the compressed output, or 0 on failure with a message logged.
+size_t CompressedSize(const void* data, size_t size, int compression_level) {
+  z_stream zlib = {};
+  zlib.zalloc = Z_NULL;
+  zlib.zfree = Z_NULL;
+  zlib.opaque = Z_NULL;
+
+  // These match the parameters used by GzipHTTPBodyStream.
+  constexpr int kZlibMaxWindowBits = 15;
+  constexpr int kZlibDefaultMemoryLevel = 8;
+  int zr = deflateInit2(&zlib,
+                        compression_level,
+                        Z_DEFLATED,
+                        ZlibWindowBitsWithGzipWrapper(kZlibMaxWindowBits),
+                        kZlibDefaultMemoryLevel,
+                        Z_DEFAULT_STRATEGY);
+  if (zr != Z_OK) {
+    LOG(ERROR) << "deflateInit2: " << ZlibErrorString(zr);
+    return 0;
+  }
+
+  zlib.next_in = static_cast<Bytef*>(const_cast<void*>(data));
+  zlib.avail_in = base::checked_cast<uInt>(size);
+
+  uint8_t output[4096];
+  size_t compressed_size = 0;
+  do {
+    zlib.next_out = output;
+    zlib.avail_out = sizeof(output);
+    zr = deflate(&zlib, Z_FINISH);
+    compressed_size += sizeof(output) - zlib.avail_out;
+  } while (zr == Z_OK);
+
+  if (zr != Z_STREAM_END) {
+    LOG(ERROR) << "deflate: " << ZlibErrorString(zr);
+    compressed_size = 0;
+  }
+
+  zr = deflateEnd(&zlib);
+  if (zr != Z_OK) {
+    LOG(ERROR) << "deflateEnd: " << ZlibErrorString(zr);
+    return 0;
+  }
+
+  return compressed_size;
+}
+
+}  // namespace
+
+MeasuringHTTPBodyStream::MeasuringHTTPBodyStream(
+    std::unique_ptr<HTTPBodyStream> source,
+    Measurements* measurements)
+    : source_(std::move(source)), measurements_(measurements) {
+  measurements_->bytes = 0;
+  measurements_->nanoseconds = 0;
+}
+
+MeasuringHTTPBodyStream::~MeasuringHTTPBodyStream() {}
+
+FileOperationResult MeasuringHTTPBodyStream::GetBytesBuffer(uint8_t* buffer,
+                                                            size_t max_len) {
+  const uint64_t start_time = ClockMonotonicNanoseconds();
+  FileOperationResult rv = source_->GetBytesBuffer(buffer, max_len);
+  measurements_->nanoseconds += ClockMonotonicNanoseconds() - start_time;
+  if (rv > 0) {
+    measurements_->bytes += rv;
+  }
+  return rv;
+}
+
+constexpr size_t AdaptiveGzip::kSampleSize;
+constexpr int AdaptiveGzip::kCandidateLevels[];
+
+AdaptiveGzip::AdaptiveGzip()
+    : compression_bytes_per_second_(), network_bytes_per_second_(0) {}
+
+AdaptiveGzip::~AdaptiveGzip() {}
+
+AdaptiveGzip::Choice AdaptiveGzip::Choose(const void* sample,
+                                          size_t sample_size,
+                                          uint64_t file_size) {
+  DCHECK_LE(sample_size, kSampleSize);
+
+  Choice default_choice;
+  default_choice.gzip_enabled = true;
+  default_choice.compression_level =
+      GzipHTTPBodyStream::kDefaultCompressionLevel;
+  default_choice.sample_ratio = 1;
+  if (sample_size == 0) {
+    return default_choice;
+  }
+
+  double ratios[arraysize(kCandidateLevels)];
+  for (size_t index = 0; index < arraysize(kCandidateLevels); ++index) {
+    const uint64_t start_time = ClockMonotonicNanoseconds();
+    const size_t compressed_size =
+        CompressedSize(sample, sample_size, kCandidateLevels[index]);
+    const uint64_t nanoseconds = std::max(
+        ClockMonotonicNanoseconds() - start_time, kMinimumMeasuredNanoseconds);
+    if (compressed_size == 0) {
+      return default_choice;
+    }
+
+    ratios[index] = static_cast<double>(compressed_size) / sample_size;
+    compression_bytes_per_second_[index] =
+        Smooth(compression_bytes_per_second_[index],
+               sample_size * kNanosecondsPerSecond / nanoseconds);
+  }
+
+  if (network_bytes_per_second_ == 0) {
+    // Without a measurement of the network, keep to the default level, whose
+    // ratio was measured as a candidate.
+    static_assert(kCandidateLevels[1] == 6,
+                  "kCandidateLevels[1] must be zlib’s default level");
+    default_choice.sample_ratio = ratios[1];
+    return default_choice;
+  }
+
+  return ChooseFastest(compression_bytes_per_second_,
+                       ratios,
+                       network_bytes_per_second_,
+                       file_size);
+}
+
+void AdaptiveGzip::RecordUpload(
+    const MeasuringHTTPBodyStream::Measurements& measurements,
+    uint64_t request_nanoseconds) {
+  if (measurements.bytes < kMinimumMeasuredUploadSize) {
+    return;
+  }
+
+  const uint64_t network_nanoseconds =
+      request_nanoseconds > measurements.nanoseconds
+          ? std::max(request_nanoseconds - measurements.nanoseconds,
+                     kMinimumMeasuredNanoseconds)
+          : kMinimumMeasuredNanoseconds;
+  network_bytes_per_second_ =
+      Smooth(network_bytes_per_second_,
+             measurements.bytes * kNanosecondsPerSecond / network_nanoseconds);
+}
+
+// static
+AdaptiveGzip::Choice AdaptiveGzip::ChooseFastest(
+    const double* compression_bytes_per_second,
+    const double* ratios,
+    double network_bytes_per_second,
+    uint64_t file_size) {
+  DCHECK_GT(network_bytes_per_second, 0);
+
+  const double size = static_cast<double>(file_size);
+
+  Choice choice;
+  choice.gzip_enabled = false;
+  choice.compression_level = 0;
+  choice.sample_ratio = 1;
+  double best_seconds = size / network_bytes_per_second;
+
+  for (size_t index = 0; index < arraysize(kCandidateLevels); ++index) {
+    DCHECK_GT(compression_bytes_per_second[index], 0);
+    const double seconds = size / compression_bytes_per_second[index] +
+                           size * ratios[index] / network_bytes_per_second;
+    if (seconds < best_seconds) {
+      best_seconds = seconds;
+      choice.gzip_enabled = true;
+      choice.compression_level = kCandidateLevels[index];
+      choice.sample_ratio = ratios[index];
+    }
+  }
+
+  return choice;
+}
+
+}  // namespace crashpad
@@ -0,0 +1,158 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_NET_ADAPTIVE_GZIP_H_
+#define CRASHPAD_UTIL_NET_ADAPTIVE_GZIP_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <memory>
+
+#include "base/macros.h"
+#include "util/file/file_io.h"
+#include "util/net/http_body.h"
+
+namespace crashpad {
+
+//! \brief An HTTPBodyStream that passes another HTTPBodyStream through
+//!     unchanged, measuring the data that it produces.
+//!
+//! The time measured is the time spent within the source stream’s
+//! GetBytesBuffer(), such as time spent reading and compressing data. When the
+//! stream is used as the body of an HTTPTransport, the remainder of the
+//! request’s duration is time spent on the network.
+class MeasuringHTTPBodyStream : public HTTPBodyStream {
+ public:
+  //! \brief Measurements taken by a MeasuringHTTPBodyStream.
+  struct Measurements {
+    //! \brief The number of bytes produced.
+    uint64_t bytes;
+
+    //! \brief The time spent producing them, in nanoseconds.
+    uint64_t nanoseconds;
+  };
+
+  //! \brief Constructs the stream.
+  //!
+  //! \param[in] source The stream to measure.
+  //! \param[out] measurements The measurements, updated as data is produced.
+  //!     This object must outlive the stream. Its members are zeroed by this
+  //!     constructor.
+  MeasuringHTTPBodyStream(std::unique_ptr<HTTPBodyStream> source,
+                          Measurements* measurements);
+  ~MeasuringHTTPBodyStream() override;
+
+  // HTTPBodyStream:
+  FileOperationResult GetBytesBuffer(uint8_t* buffer, size_t max_len) override;
+
+ private:
+  std::unique_ptr<HTTPBodyStream> source_;
+  Measurements* measurements_;  // weak
+
+  DISALLOW_COPY_AND_ASSIGN(MeasuringHTTPBodyStream);
+};
+
+//! \brief Chooses the `gzip` compression level expected to minimize the time
+//!     taken to upload a file.
+//!
+//! Compression is performed in line with the upload, so the time taken to
+//! upload a file of size _S_ at a compression level is estimated as _S_ ÷ _C_
+//! \+ _S_ × _R_ ÷ _B_, where _C_ is the speed of compression at that level, _R_
+//! is the ratio of compressed to uncompressed size, and _B_ is the throughput
+//! of the network. Without compression, it is _S_ ÷ _B_.
+//!
+//! _B_ is measured from previous uploads, reported by RecordUpload(). _C_ and
+//! _R_ are measured by compressing a sample taken from the start of each file
+//! at each candidate level. When a fast network makes compression the
+//! bottleneck, a fast level or no compression at all is chosen. When a slow
+//! network is the bottleneck, the level with the best ratio is chosen.
+//!
+//! This class is not thread-safe.
+class AdaptiveGzip {
+ public:
+  //! \brief The size of the sample that should be supplied to Choose().
+  static constexpr size_t kSampleSize = 64 * 1024;
+
+  //! \brief A compression setting chosen by Choose().
+  struct Choice {
+    //! \brief Whether `gzip` compression should be used.
+    bool gzip_enabled;
+
+    //! \brief The zlib compression level to use, if #gzip_enabled is `true`.
+    int compression_level;
+
+    //! \brief The ratio of compressed to uncompressed size measured on the
+    //!     sample at #compression_level, or `1` if #gzip_enabled is `false`.
+    double sample_ratio;
+  };
+
+  AdaptiveGzip();
+  ~AdaptiveGzip();
+
+  //! \brief Chooses how a file should be compressed.
+  //!
+  //! Until RecordUpload() has measured the network’s throughput, this chooses
+  //! `gzip` at GzipHTTPBodyStream::kDefaultCompressionLevel.
+  //!
+  //! \param[in] sample Data from the start of the file, up to #kSampleSize
+  //!     bytes.
+  //! \param[in] sample_size The size of \a sample.
+  //! \param[in] file_size The size of the entire file.
+  //!
+  //! \return The choice expected to upload the file in the least time.
+  Choice Choose(const void* sample, size_t sample_size, uint64_t file_size);
+
+  //! \brief Records the outcome of a successful upload, updating the estimate
+  //!     of the network’s throughput.
+  //!
+  //! \param[in] measurements Measurements of the body of the request, taken by
+  //!     a MeasuringHTTPBodyStream.
+  //! \param[in] request_nanoseconds The total duration of the request.
+  void RecordUpload(const MeasuringHTTPBodyStream::Measurements& measurements,
+                    uint64_t request_nanoseconds);
+
+  //! \return The estimated network throughput, in bytes per second, or `0` if
+  //!     it has not yet been measured.
+  double network_bytes_per_second() const { return network_bytes_per_second_; }
+
+  //! \brief Chooses the setting that minimizes the estimated upload time,
+  //!     given measurements for each candidate compression level.
+  //!
+  //! This is the decision made by Choose(), exposed for testing.
+  //!
+  //! \param[in] compression_bytes_per_second The speed of compression at each
+  //!     level in #kCandidateLevels, measured in uncompressed bytes.
+  //! \param[in] ratios The compression ratio at each level in
+  //!     #kCandidateLevels.
+  //! \param[in] network_bytes_per_second The network throughput.
+  //! \param[in] file_size The size of the file to upload.
+  static Choice ChooseFastest(const double* compression_bytes_per_second,
+                              const double* ratios,
+                              double network_bytes_per_second,
+                              uint64_t file_size);
+
+  //! \brief The compression levels considered, fastest first.
+  static constexpr int kCandidateLevels[] = {1, 6, 9};
+
+ private:
+  double compression_bytes_per_second_[arraysize(kCandidateLevels)];
+  double network_bytes_per_second_;
+
+  DISALLOW_COPY_AND_ASSIGN(AdaptiveGzip);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_NET_ADAPTIVE_GZIP_H_
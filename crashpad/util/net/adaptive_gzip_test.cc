@@ -0,0 +1,140 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/net/adaptive_gzip.h"
+
+#include <string>
+
+#include "base/rand_util.h"
+#include "gtest/gtest.h"
+#include "util/net/http_body.h"
+#include "util/net/http_body_gzip.h"
+#include "util/net/http_body_test_util.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+constexpr uint64_t kNanosecondsPerSecond = 1000000000;
+
+TEST(MeasuringHTTPBodyStream, Measure) {
+  const std::string string(10000, 'x');
+  MeasuringHTTPBodyStream::Measurements measurements = {1, 1};
+  MeasuringHTTPBodyStream stream(
+      std::unique_ptr<HTTPBodyStream>(new StringHTTPBodyStream(string)),
+      &measurements);
+  EXPECT_EQ(measurements.bytes, 0u);
+  EXPECT_EQ(measurements.nanoseconds, 0u);
+
+  EXPECT_EQ(ReadStreamToString(&stream), string);
+  EXPECT_EQ(measurements.bytes, string.size());
+}
+
+TEST(AdaptiveGzip, ChooseFastest) {
+  // Fast but weak, slower and stronger, slowest and strongest.
+  const double compression_bytes_per_second[] = {100E6, 30E6, 5E6};
+  const double ratios[] = {0.3, 0.25, 0.2};
+  constexpr uint64_t kFileSize = 10 * 1024 * 1024;
+
+  // On a very fast network, compression only slows the upload down.
+  AdaptiveGzip::Choice choice = AdaptiveGzip::ChooseFastest(
+      compression_bytes_per_second, ratios, 1E9, kFileSize);
+  EXPECT_FALSE(choice.gzip_enabled);
+  EXPECT_EQ(choice.sample_ratio, 1);
+
+  // On a moderately fast network, fast compression pays for itself.
+  choice = AdaptiveGzip::ChooseFastest(
+      compression_bytes_per_second, ratios, 50E6, kFileSize);
+  EXPECT_TRUE(choice.gzip_enabled);
+  EXPECT_EQ(choice.compression_level, 1);
+  EXPECT_EQ(choice.sample_ratio, 0.3);
+
+  // On a slow network, the best ratio wins.
+  choice = AdaptiveGzip::ChooseFastest(
+      compression_bytes_per_second, ratios, 100E3, kFileSize);
+  EXPECT_TRUE(choice.gzip_enabled);
+  EXPECT_EQ(choice.compression_level, 9);
+  EXPECT_EQ(choice.sample_ratio, 0.2);
+
+  // Data that doesn’t compress is never worth compressing.
+  const double incompressible_ratios[] = {1.01, 1.01, 1.01};
+  choice = AdaptiveGzip::ChooseFastest(
+      compression_bytes_per_second, incompressible_ratios, 100E3, kFileSize);
+  EXPECT_FALSE(choice.gzip_enabled);
+}
+
+TEST(AdaptiveGzip, Choose) {
+  AdaptiveGzip adaptive_gzip;
+  EXPECT_EQ(adaptive_gzip.network_bytes_per_second(), 0);
+
+  const std::string compressible(AdaptiveGzip::kSampleSize, 'c');
+
+  // Without a network measurement, the default level is used.
+  AdaptiveGzip::Choice choice =
+      adaptive_gzip.Choose(compressible.data(), compressible.size(), 1 << 20);
+  EXPECT_TRUE(choice.gzip_enabled);
+  EXPECT_EQ(choice.compression_level,
+            GzipHTTPBodyStream::kDefaultCompressionLevel);
+  EXPECT_LT(choice.sample_ratio, 0.1);
+
+  choice = adaptive_gzip.Choose(nullptr, 0, 0);
+  EXPECT_TRUE(choice.gzip_enabled);
+  EXPECT_EQ(choice.compression_level,
+            GzipHTTPBodyStream::kDefaultCompressionLevel);
+
+  // A very slow network makes compression worthwhile, even for data that
+  // barely compresses.
+  MeasuringHTTPBodyStream::Measurements measurements;
+  measurements.bytes = 1024 * 1024;
+  measurements.nanoseconds = 0;
+  adaptive_gzip.RecordUpload(measurements, 1000 * kNanosecondsPerSecond);
+  EXPECT_GT(adaptive_gzip.network_bytes_per_second(), 1000);
+  EXPECT_LT(adaptive_gzip.network_bytes_per_second(), 1100);
+  choice =
+      adaptive_gzip.Choose(compressible.data(), compressible.size(), 1 << 20);
+  EXPECT_TRUE(choice.gzip_enabled);
+  EXPECT_GT(choice.compression_level, 0);
+
+  // Random data doesn’t compress.
+  const std::string random = base::RandBytesAsString(AdaptiveGzip::kSampleSize);
+  choice = adaptive_gzip.Choose(random.data(), random.size(), 1 << 20);
+  EXPECT_FALSE(choice.gzip_enabled);
+}
+
+TEST(AdaptiveGzip, RecordUpload) {
+  AdaptiveGzip adaptive_gzip;
+
+  // Small uploads aren’t measured.
+  MeasuringHTTPBodyStream::Measurements measurements;
+  measurements.bytes = 100;
+  measurements.nanoseconds = 0;
+  adaptive_gzip.RecordUpload(measurements, kNanosecondsPerSecond);
+  EXPECT_EQ(adaptive_gzip.network_bytes_per_second(), 0);
+
+  // Time spent producing the body isn’t attributed to the network.
+  measurements.bytes = 1000000;
+  measurements.nanoseconds = kNanosecondsPerSecond;
+  adaptive_gzip.RecordUpload(measurements, 2 * kNanosecondsPerSecond);
+  EXPECT_DOUBLE_EQ(adaptive_gzip.network_bytes_per_second(), 1000000);
+
+  // Later measurements move the estimate gradually.
+  measurements.nanoseconds = 0;
+  adaptive_gzip.RecordUpload(measurements, kNanosecondsPerSecond / 2);
+  EXPECT_GT(adaptive_gzip.network_bytes_per_second(), 1000000);
+  EXPECT_LT(adaptive_gzip.network_bytes_per_second(), 2000000);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
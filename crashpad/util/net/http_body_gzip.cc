@@ -23,11 +23,25 @@
 
 namespace crashpad {
 
+static_assert(GzipHTTPBodyStream::kDefaultCompressionLevel ==
+                  Z_DEFAULT_COMPRESSION,
+              "kDefaultCompressionLevel must match zlib");
+
 GzipHTTPBodyStream::GzipHTTPBodyStream(std::unique_ptr<HTTPBodyStream> source)
+    : GzipHTTPBodyStream(std::move(source), kDefaultCompressionLevel) {}
+
+GzipHTTPBodyStream::GzipHTTPBodyStream(std::unique_ptr<HTTPBodyStream> source,
+                                       int compression_level)
     : input_(),
       source_(std::move(source)),
       z_stream_(new z_stream()),
-      state_(State::kUninitialized) {}
+      compression_level_(compression_level),
+      state_(State::kUninitialized) {
+  DCHECK(compression_level_ == kDefaultCompressionLevel ||
+         (compression_level_ >= Z_NO_COMPRESSION &&
+          compression_level_ <= Z_BEST_COMPRESSION))
+      << compression_level_;
+}
 
 GzipHTTPBodyStream::~GzipHTTPBodyStream() {
   DCHECK(state_ == State::kUninitialized ||
@@ -58,7 +72,7 @@ FileOperationResult GzipHTTPBodyStream::GetBytesBuffer(uint8_t* buffer,
     constexpr int kZlibDefaultMemoryLevel = 8;
 
     int zr = deflateInit2(z_stream_.get(),
-                          Z_DEFAULT_COMPRESSION,
+                          compression_level_,
                           Z_DEFLATED,
                           ZlibWindowBitsWithGzipWrapper(kZlibMaxWindowBits),
                           kZlibDefaultMemoryLevel,
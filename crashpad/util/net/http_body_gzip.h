@@ -34,8 +34,22 @@ namespace crashpad {
 //!     HTTPBodyStream.
 class GzipHTTPBodyStream : public HTTPBodyStream {
  public:
+  //! \brief The compression level that zlib considers to be a good default,
+  //!     equivalent to `Z_DEFAULT_COMPRESSION`.
+  static constexpr int kDefaultCompressionLevel = -1;
+
+  //! \brief Constructs an object that compresses \a source at
+  //!     #kDefaultCompressionLevel.
   explicit GzipHTTPBodyStream(std::unique_ptr<HTTPBodyStream> source);
 
+  //! \brief Constructs an object that compresses \a source.
+  //!
+  //! \param[in] source The stream to compress.
+  //! \param[in] compression_level The zlib compression level, from `0` (no
+  //!     compression) to `9` (best compression), or #kDefaultCompressionLevel.
+  GzipHTTPBodyStream(std::unique_ptr<HTTPBodyStream> source,
+                     int compression_level);
+
   ~GzipHTTPBodyStream() override;
 
   // HTTPBodyStream:
@@ -57,6 +71,7 @@ class GzipHTTPBodyStream : public HTTPBodyStream {
   uint8_t input_[4096];
   std::unique_ptr<HTTPBodyStream> source_;
   std::unique_ptr<z_stream> z_stream_;
+  int compression_level_;
   State state_;
 
   DISALLOW_COPY_AND_ASSIGN(GzipHTTPBodyStream);
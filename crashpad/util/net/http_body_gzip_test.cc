@@ -76,10 +76,11 @@ void GzipInflate(const std::string& compressed,
                        buf_size - zlib.avail_out);
 }
 
-void TestGzipDeflateInflate(const std::string& string) {
+void TestGzipDeflateInflateAtLevel(const std::string& string,
+                                   int compression_level) {
   std::unique_ptr<HTTPBodyStream> string_stream(
       new StringHTTPBodyStream(string));
-  GzipHTTPBodyStream gzip_stream(std::move(string_stream));
+  GzipHTTPBodyStream gzip_stream(std::move(string_stream), compression_level);
 
   // The minimum size of a gzip wrapper per RFC 1952: a 10-byte header and an
   // 8-byte trailer.
@@ -117,7 +118,8 @@ void TestGzipDeflateInflate(const std::string& string) {
 
   // In block mode, compression should be identical.
   string_stream.reset(new StringHTTPBodyStream(string));
-  GzipHTTPBodyStream block_gzip_stream(std::move(string_stream));
+  GzipHTTPBodyStream block_gzip_stream(std::move(string_stream),
+                                       compression_level);
   uint8_t block_buf[4096];
   std::string block_compressed;
   FileOperationResult block_compressed_bytes;
@@ -130,6 +132,11 @@ void TestGzipDeflateInflate(const std::string& string) {
   EXPECT_EQ(block_compressed, compressed);
 }
 
+void TestGzipDeflateInflate(const std::string& string) {
+  TestGzipDeflateInflateAtLevel(string,
+                                GzipHTTPBodyStream::kDefaultCompressionLevel);
+}
+
 std::string MakeString(size_t size) {
   std::string string;
   for (size_t i = 0; i < size; ++i) {
@@ -173,6 +180,15 @@ TEST(GzipHTTPBodyStream, ManyBytes_Random) {
   TestGzipDeflateInflate(base::RandBytesAsString(kManyBytes));
 }
 
+TEST(GzipHTTPBodyStream, CompressionLevels) {
+  const std::string string = MakeString(kManyBytes);
+  for (int compression_level = 0; compression_level <= 9;
+       ++compression_level) {
+    SCOPED_TRACE(compression_level);
+    TestGzipDeflateInflateAtLevel(string, compression_level);
+  }
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace crashpad
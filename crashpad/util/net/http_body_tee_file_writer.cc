@@ -0,0 +1,229 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/net/http_body_tee_file_writer.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "util/misc/clock.h"
+#include "util/net/http_body.h"
+
+namespace crashpad {
+
+class HTTPBodyTeeFileWriter::Stream final : public HTTPBodyStream {
+ public:
+  explicit Stream(HTTPBodyTeeFileWriter* writer) : writer_(writer) {}
+
+  ~Stream() override { writer_->ReaderClosed(); }
+
+  // HTTPBodyStream:
+  FileOperationResult GetBytesBuffer(uint8_t* buffer, size_t max_len) override {
+    return writer_->Read(buffer, max_len);
+  }
+
+ private:
+  HTTPBodyTeeFileWriter* writer_;  // weak
+
+  DISALLOW_COPY_AND_ASSIGN(Stream);
+};
+
+HTTPBodyTeeFileWriter::HTTPBodyTeeFileWriter(FileWriterInterface* file_writer,
+                                             size_t buffer_size,
+                                             double max_stall_seconds)
+    : FileWriterInterface(),
+      file_writer_(file_writer),
+      max_stall_seconds_(max_stall_seconds),
+      stalled_ns_(0),
+      writer_semaphore_(0),
+      reader_semaphore_(0),
+      lock_(),
+      buffer_(std::max(buffer_size, static_cast<size_t>(1))),
+      reader_waited_ns_(0),
+      buffer_start_(0),
+      buffer_used_(0),
+      state_(kStateStreaming),
+      writer_waiting_(false),
+      reader_waiting_(false),
+      reader_closed_(false),
+      stream_created_(false) {}
+
+HTTPBodyTeeFileWriter::~HTTPBodyTeeFileWriter() {}
+
+std::unique_ptr<HTTPBodyStream> HTTPBodyTeeFileWriter::GetBodyStream() {
+  base::AutoLock lock(lock_);
+  DCHECK(!stream_created_);
+  stream_created_ = true;
+  return std::unique_ptr<HTTPBodyStream>(new Stream(this));
+}
+
+void HTTPBodyTeeFileWriter::Finish(bool success) {
+  base::AutoLock lock(lock_);
+  if (state_ != kStateStreaming) {
+    return;
+  }
+  if (!success) {
+    FailLocked();
+    return;
+  }
+  state_ = kStateFinished;
+  if (reader_waiting_) {
+    reader_waiting_ = false;
+    reader_semaphore_.Signal();
+  }
+}
+
+bool HTTPBodyTeeFileWriter::streaming() const {
+  base::AutoLock lock(lock_);
+  return state_ != kStateFailed && !reader_closed_;
+}
+
+uint64_t HTTPBodyTeeFileWriter::reader_waited_ns() const {
+  base::AutoLock lock(lock_);
+  return reader_waited_ns_;
+}
+
+bool HTTPBodyTeeFileWriter::Write(const void* data, size_t size) {
+  if (!file_writer_->Write(data, size)) {
+    Finish(false);
+    return false;
+  }
+
+  Tee(static_cast<const uint8_t*>(data), size);
+  return true;
+}
+
+bool HTTPBodyTeeFileWriter::WriteIoVec(std::vector<WritableIoVec>* iovecs) {
+  // The underlying writer leaves the contents of |iovecs| undefined, so tee
+  // from a copy.
+  const std::vector<WritableIoVec> iovecs_copy(*iovecs);
+  if (!file_writer_->WriteIoVec(iovecs)) {
+    Finish(false);
+    return false;
+  }
+
+  for (const WritableIoVec& iov : iovecs_copy) {
+    Tee(static_cast<const uint8_t*>(iov.iov_base), iov.iov_len);
+  }
+  return true;
+}
+
+FileOffset HTTPBodyTeeFileWriter::Seek(FileOffset offset, int whence) {
+  if (offset != 0 || whence != SEEK_CUR) {
+    base::AutoLock lock(lock_);
+    if (state_ == kStateStreaming) {
+      LOG(WARNING) << "seek abandons stream";
+      FailLocked();
+    }
+  }
+  return file_writer_->Seek(offset, whence);
+}
+
+void HTTPBodyTeeFileWriter::Tee(const uint8_t* data, size_t size) {
+  base::AutoLock lock(lock_);
+  while (size > 0 && state_ == kStateStreaming && !reader_closed_) {
+    const size_t available = buffer_.size() - buffer_used_;
+    if (available == 0) {
+      const double remaining_seconds = max_stall_seconds_ - stalled_ns_ / 1E9;
+      if (remaining_seconds <= 0) {
+        LOG(WARNING) << "reader stalled, abandoning stream";
+        FailLocked();
+        break;
+      }
+
+      writer_waiting_ = true;
+      {
+        base::AutoUnlock unlock(lock_);
+        const uint64_t wait_start_ns = ClockMonotonicNanoseconds();
+        writer_semaphore_.TimedWait(remaining_seconds);
+        stalled_ns_ += ClockMonotonicNanoseconds() - wait_start_ns;
+      }
+      continue;
+    }
+
+    // Copy into the free space, which may wrap around the end of the buffer.
+    const size_t write_position =
+        (buffer_start_ + buffer_used_) % buffer_.size();
+    const size_t length =
+        std::min(std::min(size, available), buffer_.size() - write_position);
+    memcpy(&buffer_[write_position], data, length);
+    buffer_used_ += length;
+    data += length;
+    size -= length;
+
+    if (reader_waiting_) {
+      reader_waiting_ = false;
+      reader_semaphore_.Signal();
+    }
+  }
+}
+
+FileOperationResult HTTPBodyTeeFileWriter::Read(uint8_t* buffer,
+                                                size_t max_len) {
+  base::AutoLock lock(lock_);
+  while (buffer_used_ == 0) {
+    switch (state_) {
+      case kStateFinished:
+        return 0;
+      case kStateFailed:
+        return -1;
+      case kStateStreaming:
+        break;
+    }
+
+    reader_waiting_ = true;
+    const uint64_t wait_start_ns = ClockMonotonicNanoseconds();
+    {
+      base::AutoUnlock unlock(lock_);
+      reader_semaphore_.Wait();
+    }
+    reader_waited_ns_ += ClockMonotonicNanoseconds() - wait_start_ns;
+  }
+
+  const size_t length = std::min(std::min(max_len, buffer_used_),
+                                 buffer_.size() - buffer_start_);
+  memcpy(buffer, &buffer_[buffer_start_], length);
+  buffer_start_ = (buffer_start_ + length) % buffer_.size();
+  buffer_used_ -= length;
+
+  if (writer_waiting_) {
+    writer_waiting_ = false;
+    writer_semaphore_.Signal();
+  }
+
+  return length;
+}
+
+void HTTPBodyTeeFileWriter::ReaderClosed() {
+  base::AutoLock lock(lock_);
+  reader_closed_ = true;
+  if (writer_waiting_) {
+    writer_waiting_ = false;
+    writer_semaphore_.Signal();
+  }
+}
+
+void HTTPBodyTeeFileWriter::FailLocked() {
+  lock_.AssertAcquired();
+  state_ = kStateFailed;
+  if (reader_waiting_) {
+    reader_waiting_ = false;
+    reader_semaphore_.Signal();
+  }
+}
+
+}  // namespace crashpad
@@ -0,0 +1,150 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_NET_HTTP_BODY_TEE_FILE_WRITER_H_
+#define CRASHPAD_UTIL_NET_HTTP_BODY_TEE_FILE_WRITER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/synchronization/lock.h"
+#include "util/file/file_writer.h"
+#include "util/synchronization/semaphore.h"
+
+namespace crashpad {
+
+class HTTPBodyStream;
+
+//! \brief A FileWriterInterface that writes to another FileWriterInterface,
+//!     and also makes the data written available as an HTTPBodyStream while it
+//!     is being written.
+//!
+//! This allows a file to be uploaded while it is still being produced. Data is
+//! passed from the writing thread to the thread reading the body stream
+//! through a bounded buffer. When the buffer is full, the writer waits for the
+//! reader. Once the writer has waited for the stall limit given at construction
+//! in total, the stream is abandoned: the reader receives an error, and
+//! subsequent writes go only to the underlying file. The underlying file is
+//! therefore never delayed by more than the stall limit.
+//!
+//! Because the body stream can only move forward, any seek other than a query
+//! of the current position also abandons the stream.
+class HTTPBodyTeeFileWriter : public FileWriterInterface {
+ public:
+  //! \param[in] file_writer The writer that all data will be written to. This
+  //!     object does not take ownership of \a file_writer, which must outlive
+  //!     it.
+  //! \param[in] buffer_size The maximum number of bytes held for the reader
+  //!     at any time.
+  //! \param[in] max_stall_seconds The maximum total time that writes will wait
+  //!     for the reader to make room in the buffer before the stream is
+  //!     abandoned.
+  HTTPBodyTeeFileWriter(FileWriterInterface* file_writer,
+                        size_t buffer_size,
+                        double max_stall_seconds);
+  ~HTTPBodyTeeFileWriter() override;
+
+  //! \brief Returns the stream that the data written will be read from.
+  //!
+  //! This method may only be called once. The returned stream may be read from
+  //! any thread, but must not outlive this object.
+  std::unique_ptr<HTTPBodyStream> GetBodyStream();
+
+  //! \brief Signals that no more data will be written.
+  //!
+  //! \param[in] success If `true`, the reader receives the end of the stream
+  //!     once it has read all of the data written. If `false`, the reader
+  //!     receives an error, because the data written was incomplete.
+  void Finish(bool success);
+
+  //! \brief Returns `false` if the stream has been abandoned or has failed,
+  //!     so that the data written will not be delivered to its reader in full.
+  bool streaming() const;
+
+  //! \brief Returns the total time that the reader of the body stream has
+  //!     waited for data to be written, in nanoseconds.
+  //!
+  //! Subtracting this from the time taken to read the stream gives the time
+  //! spent passing the data on, excluding the time spent producing it.
+  uint64_t reader_waited_ns() const;
+
+  // FileWriterInterface:
+  bool Write(const void* data, size_t size) override;
+  bool WriteIoVec(std::vector<WritableIoVec>* iovecs) override;
+
+  // FileSeekerInterface:
+  FileOffset Seek(FileOffset offset, int whence) override;
+
+ private:
+  class Stream;
+
+  enum State {
+    // Data is being written and passed to the reader.
+    kStateStreaming = 0,
+
+    // All data has been written and will be passed to the reader.
+    kStateFinished,
+
+    // The stream has been abandoned or writing failed. The reader receives an
+    // error once it has read what was already buffered.
+    kStateFailed,
+  };
+
+  // Copies |size| bytes at |data| into the buffer, waiting for the reader to
+  // make room as needed.
+  void Tee(const uint8_t* data, size_t size);
+
+  // Called by Stream to read from the buffer.
+  FileOperationResult Read(uint8_t* buffer, size_t max_len);
+
+  // Called by Stream when it is destroyed.
+  void ReaderClosed();
+
+  // Abandons the stream. lock_ must be held.
+  void FailLocked();
+
+  FileWriterInterface* file_writer_;  // weak
+  const double max_stall_seconds_;
+
+  // The total time that the writer has waited for the reader.
+  uint64_t stalled_ns_;
+
+  // Signaled to wake a writer waiting for room in the buffer, and a reader
+  // waiting for data. Each is only signaled when the corresponding waiting
+  // flag is set, so that signals do not accumulate.
+  Semaphore writer_semaphore_;
+  Semaphore reader_semaphore_;
+
+  // The following members are protected by lock_.
+  mutable base::Lock lock_;
+  std::vector<uint8_t> buffer_;
+  uint64_t reader_waited_ns_;
+  size_t buffer_start_;
+  size_t buffer_used_;
+  State state_;
+  bool writer_waiting_;
+  bool reader_waiting_;
+  bool reader_closed_;
+  bool stream_created_;
+
+  DISALLOW_COPY_AND_ASSIGN(HTTPBodyTeeFileWriter);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_NET_HTTP_BODY_TEE_FILE_WRITER_H_
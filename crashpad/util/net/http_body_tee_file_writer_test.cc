@@ -0,0 +1,193 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/net/http_body_tee_file_writer.h"
+
+#include <stdio.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "util/file/string_file.h"
+#include "util/misc/clock.h"
+#include "util/net/http_body.h"
+#include "util/thread/thread.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+// Reads a stream to its end on its own thread.
+class ReaderThread : public Thread {
+ public:
+  explicit ReaderThread(HTTPBodyStream* stream)
+      : Thread(), stream_(stream), contents_(), result_(0) {}
+  ~ReaderThread() override {}
+
+  const std::string& contents() const { return contents_; }
+  FileOperationResult result() const { return result_; }
+
+ private:
+  void ThreadMain() override {
+    uint8_t buffer[7];
+    while ((result_ = stream_->GetBytesBuffer(buffer, sizeof(buffer))) > 0) {
+      contents_.append(reinterpret_cast<char*>(buffer), result_);
+    }
+  }
+
+  HTTPBodyStream* stream_;  // weak
+  std::string contents_;
+  FileOperationResult result_;
+
+  DISALLOW_COPY_AND_ASSIGN(ReaderThread);
+};
+
+std::string TestData(size_t size) {
+  std::string data(size, '\0');
+  for (size_t index = 0; index < size; ++index) {
+    data[index] = static_cast<char>('a' + index % 26);
+  }
+  return data;
+}
+
+TEST(HTTPBodyTeeFileWriter, WriteAndRead) {
+  StringFile string_file;
+  HTTPBodyTeeFileWriter writer(&string_file, 16, 10);
+  std::unique_ptr<HTTPBodyStream> stream = writer.GetBodyStream();
+
+  ReaderThread reader(stream.get());
+  reader.Start();
+
+  const std::string data = TestData(1000);
+  ASSERT_TRUE(writer.Write(data.data(), 300));
+  EXPECT_EQ(writer.Seek(0, SEEK_CUR), 300);
+
+  std::vector<WritableIoVec> iovecs(2);
+  iovecs[0].iov_base = &data[300];
+  iovecs[0].iov_len = 200;
+  iovecs[1].iov_base = &data[500];
+  iovecs[1].iov_len = 500;
+  ASSERT_TRUE(writer.WriteIoVec(&iovecs));
+
+  writer.Finish(true);
+  reader.Join();
+
+  EXPECT_TRUE(writer.streaming());
+  EXPECT_EQ(reader.result(), 0);
+  EXPECT_EQ(reader.contents(), data);
+  EXPECT_EQ(string_file.string(), data);
+}
+
+TEST(HTTPBodyTeeFileWriter, FinishFailure) {
+  StringFile string_file;
+  HTTPBodyTeeFileWriter writer(&string_file, 1024, 10);
+  std::unique_ptr<HTTPBodyStream> stream = writer.GetBodyStream();
+
+  const std::string data = TestData(10);
+  ASSERT_TRUE(writer.Write(data.data(), data.size()));
+  writer.Finish(false);
+  EXPECT_FALSE(writer.streaming());
+
+  // What was written is still delivered, followed by an error.
+  ReaderThread reader(stream.get());
+  reader.Start();
+  reader.Join();
+  EXPECT_LT(reader.result(), 0);
+  EXPECT_EQ(reader.contents(), data);
+
+  // Everything was available to the reader, so it never waited.
+  EXPECT_EQ(writer.reader_waited_ns(), 0u);
+}
+
+TEST(HTTPBodyTeeFileWriter, ReaderWaits) {
+  StringFile string_file;
+  HTTPBodyTeeFileWriter writer(&string_file, 16, 10);
+  std::unique_ptr<HTTPBodyStream> stream = writer.GetBodyStream();
+
+  ReaderThread reader(stream.get());
+  reader.Start();
+
+  // The reader waits for data while the writer sleeps before writing
+  // anything.
+  constexpr uint64_t kSleepNanoseconds = 50E6;  // 50 milliseconds.
+  SleepNanoseconds(kSleepNanoseconds);
+
+  const std::string data = TestData(100);
+  ASSERT_TRUE(writer.Write(data.data(), data.size()));
+  writer.Finish(true);
+  reader.Join();
+
+  EXPECT_EQ(reader.contents(), data);
+  EXPECT_GT(writer.reader_waited_ns(), 0u);
+}
+
+TEST(HTTPBodyTeeFileWriter, ReaderStalls) {
+  StringFile string_file;
+  HTTPBodyTeeFileWriter writer(&string_file, 16, 0.01);
+  std::unique_ptr<HTTPBodyStream> stream = writer.GetBodyStream();
+
+  // Nothing reads from the stream, so the writer gives up on it, but every
+  // write still reaches the file.
+  const std::string data = TestData(100);
+  ASSERT_TRUE(writer.Write(data.data(), data.size()));
+  EXPECT_FALSE(writer.streaming());
+  ASSERT_TRUE(writer.Write(data.data(), data.size()));
+  EXPECT_EQ(string_file.string(), data + data);
+
+  writer.Finish(true);
+
+  ReaderThread reader(stream.get());
+  reader.Start();
+  reader.Join();
+  EXPECT_LT(reader.result(), 0);
+  EXPECT_EQ(reader.contents(), data.substr(0, 16));
+}
+
+TEST(HTTPBodyTeeFileWriter, ReaderClosed) {
+  StringFile string_file;
+  HTTPBodyTeeFileWriter writer(&string_file, 16, 10);
+  writer.GetBodyStream();
+  EXPECT_FALSE(writer.streaming());
+
+  // With no reader, writes do not wait for the buffer to drain.
+  const std::string data = TestData(100);
+  ASSERT_TRUE(writer.Write(data.data(), data.size()));
+  EXPECT_EQ(string_file.string(), data);
+}
+
+TEST(HTTPBodyTeeFileWriter, SeekAbandonsStream) {
+  StringFile string_file;
+  HTTPBodyTeeFileWriter writer(&string_file, 1024, 10);
+  std::unique_ptr<HTTPBodyStream> stream = writer.GetBodyStream();
+
+  const std::string data = TestData(10);
+  ASSERT_TRUE(writer.Write(data.data(), data.size()));
+  EXPECT_EQ(writer.Seek(0, SEEK_CUR), 10);
+  EXPECT_TRUE(writer.streaming());
+
+  EXPECT_EQ(writer.Seek(0, SEEK_SET), 0);
+  EXPECT_FALSE(writer.streaming());
+  writer.Finish(true);
+
+  ReaderThread reader(stream.get());
+  reader.Start();
+  reader.Join();
+  EXPECT_LT(reader.result(), 0);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
@@ -0,0 +1,146 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/net/http_endpoint_selector.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+
+namespace crashpad {
+
+namespace {
+
+constexpr uint64_t kNanosecondsPerSecond = 1E9;
+
+double Smooth(double average, double sample, double smoothing_factor) {
+  return average + smoothing_factor * (sample - average);
+}
+
+std::vector<std::string> NonEmptyURLs(const std::vector<std::string>& urls) {
+  std::vector<std::string> non_empty_urls;
+  for (const std::string& url : urls) {
+    if (!url.empty()) {
+      non_empty_urls.push_back(url);
+    }
+  }
+  return non_empty_urls;
+}
+
+}  // namespace
+
+HTTPEndpointSelector::Options::Options()
+    : smoothing_factor(0.25),
+      failure_cost_seconds(60),
+      failure_threshold(3),
+      open_nanoseconds(5 * 60 * kNanosecondsPerSecond),
+      max_open_nanoseconds(60 * 60 * kNanosecondsPerSecond) {}
+
+HTTPEndpointSelector::EndpointStats::EndpointStats()
+    : latency_seconds(0),
+      error_rate(0),
+      consecutive_failures(0),
+      successes(0),
+      failures(0),
+      circuit_state(CircuitState::kClosed),
+      open_until(0),
+      open_nanoseconds(0) {}
+
+HTTPEndpointSelector::HTTPEndpointSelector(const std::vector<std::string>& urls,
+                                           const Options& options)
+    : urls_(NonEmptyURLs(urls)), stats_(urls_.size()), options_(options) {
+  DCHECK_GT(options_.smoothing_factor, 0);
+  DCHECK_LE(options_.smoothing_factor, 1);
+  DCHECK_GT(options_.failure_threshold, 0);
+  for (EndpointStats& stats : stats_) {
+    stats.open_nanoseconds = options_.open_nanoseconds;
+  }
+}
+
+HTTPEndpointSelector::~HTTPEndpointSelector() {}
+
+std::vector<size_t> HTTPEndpointSelector::SelectEndpoints(uint64_t now) {
+  std::vector<size_t> indices;
+  size_t soonest_index = stats_.size();
+  for (size_t index = 0; index < stats_.size(); ++index) {
+    EndpointStats& stats = stats_[index];
+    if (stats.circuit_state == CircuitState::kOpen) {
+      if (now < stats.open_until) {
+        if (soonest_index == stats_.size() ||
+            stats.open_until < stats_[soonest_index].open_until) {
+          soonest_index = index;
+        }
+        continue;
+      }
+      stats.circuit_state = CircuitState::kHalfOpen;
+    }
+    indices.push_back(index);
+  }
+
+  if (indices.empty()) {
+    if (soonest_index != stats_.size()) {
+      indices.push_back(soonest_index);
+    }
+    return indices;
+  }
+
+  std::stable_sort(indices.begin(),
+                   indices.end(),
+                   [this](size_t lhs, size_t rhs) {
+                     return Cost(stats_[lhs]) < Cost(stats_[rhs]);
+                   });
+  return indices;
+}
+
+void HTTPEndpointSelector::RecordSuccess(size_t index,
+                                         uint64_t latency_nanoseconds) {
+  EndpointStats& stats = stats_[index];
+  const double latency_seconds =
+      static_cast<double>(latency_nanoseconds) / kNanosecondsPerSecond;
+  stats.latency_seconds =
+      stats.successes == 0 ? latency_seconds
+                           : Smooth(stats.latency_seconds,
+                                    latency_seconds,
+                                    options_.smoothing_factor);
+  stats.error_rate = Smooth(stats.error_rate, 0, options_.smoothing_factor);
+  ++stats.successes;
+  stats.consecutive_failures = 0;
+  stats.circuit_state = CircuitState::kClosed;
+  stats.open_nanoseconds = options_.open_nanoseconds;
+}
+
+void HTTPEndpointSelector::RecordFailure(size_t index, uint64_t now) {
+  EndpointStats& stats = stats_[index];
+  stats.error_rate = Smooth(stats.error_rate, 1, options_.smoothing_factor);
+  ++stats.failures;
+  ++stats.consecutive_failures;
+
+  if (stats.circuit_state == CircuitState::kHalfOpen) {
+    // The trial request failed. Stay away for longer this time.
+    stats.open_nanoseconds =
+        std::min(stats.open_nanoseconds * 2, options_.max_open_nanoseconds);
+  } else if (stats.consecutive_failures < options_.failure_threshold) {
+    return;
+  }
+
+  stats.circuit_state = CircuitState::kOpen;
+  stats.open_until = now + stats.open_nanoseconds;
+}
+
+double HTTPEndpointSelector::Cost(const EndpointStats& stats) const {
+  return stats.latency_seconds +
+         stats.error_rate * options_.failure_cost_seconds;
+}
+
+}  // namespace crashpad
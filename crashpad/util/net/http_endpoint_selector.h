@@ -0,0 +1,175 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_NET_HTTP_ENDPOINT_SELECTOR_H_
+#define CRASHPAD_UTIL_NET_HTTP_ENDPOINT_SELECTOR_H_
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+
+namespace crashpad {
+
+//! \brief Tracks the health of a set of equivalent HTTP endpoints, and chooses
+//!     the order in which they should be tried.
+//!
+//! For each endpoint, this class maintains an exponentially-weighted moving
+//! average (EWMA) of the latency of successful requests, an EWMA of the rate
+//! at which requests fail, and a circuit breaker.
+//!
+//! A circuit breaker starts out closed, allowing requests. After
+//! Options::failure_threshold consecutive failures, it opens, and the endpoint
+//! is not offered by SelectEndpoints() until Options::open_nanoseconds have
+//! elapsed. The breaker is then half-open: a single request is permitted, and
+//! its outcome either closes the breaker again or reopens it for twice as long,
+//! up to Options::max_open_nanoseconds.
+//!
+//! Times are supplied by the caller, as values of ClockMonotonicNanoseconds()
+//! or any other monotonic clock.
+//!
+//! This class is not thread-safe.
+class HTTPEndpointSelector {
+ public:
+  //! \brief Parameters controlling health tracking.
+  struct Options {
+    Options();
+
+    //! \brief The weight given to each new sample in the EWMAs, between `0`
+    //!     and `1`.
+    double smoothing_factor;
+
+    //! \brief The cost, in seconds, charged for each failure when ranking
+    //!     endpoints. This is typically the request timeout, since a failing
+    //!     endpoint often costs a full timeout.
+    double failure_cost_seconds;
+
+    //! \brief The number of consecutive failures that opens an endpoint’s
+    //!     circuit breaker.
+    int failure_threshold;
+
+    //! \brief The time that an endpoint’s circuit breaker stays open after it
+    //!     first opens.
+    uint64_t open_nanoseconds;
+
+    //! \brief The maximum time that an endpoint’s circuit breaker stays open.
+    uint64_t max_open_nanoseconds;
+  };
+
+  //! \brief The state of an endpoint’s circuit breaker.
+  enum class CircuitState {
+    //! \brief Requests are permitted.
+    kClosed,
+
+    //! \brief Requests are not permitted until the breaker’s timeout expires.
+    kOpen,
+
+    //! \brief The breaker’s timeout has expired, and a single trial request is
+    //!     permitted.
+    kHalfOpen,
+  };
+
+  //! \brief Health statistics for a single endpoint.
+  struct EndpointStats {
+    EndpointStats();
+
+    //! \brief The EWMA of the latency of successful requests, in seconds.
+    double latency_seconds;
+
+    //! \brief The EWMA of the failure rate, between `0` and `1`.
+    double error_rate;
+
+    //! \brief The number of failures since the last success.
+    int consecutive_failures;
+
+    //! \brief The number of successful requests recorded.
+    int successes;
+
+    //! \brief The number of failed requests recorded.
+    int failures;
+
+    //! \brief The state of the circuit breaker, as of the last call to
+    //!     SelectEndpoints(), RecordSuccess(), or RecordFailure().
+    CircuitState circuit_state;
+
+    //! \brief The time at which an open circuit breaker becomes half-open.
+    uint64_t open_until;
+
+    //! \brief The duration for which the circuit breaker will next open.
+    uint64_t open_nanoseconds;
+  };
+
+  //! \brief Constructs an object tracking \a urls.
+  //!
+  //! \param[in] urls The endpoints, in order of preference. This order is used
+  //!     to break ties between endpoints with equal health. Empty URLs are
+  //!     ignored, and do not count towards size().
+  //! \param[in] options Health tracking parameters.
+  HTTPEndpointSelector(const std::vector<std::string>& urls,
+                       const Options& options);
+  ~HTTPEndpointSelector();
+
+  //! \return The number of endpoints.
+  size_t size() const { return urls_.size(); }
+
+  //! \return The URL of the endpoint at \a index.
+  const std::string& url(size_t index) const { return urls_[index]; }
+
+  //! \return The health statistics of the endpoint at \a index.
+  const EndpointStats& stats(size_t index) const { return stats_[index]; }
+
+  //! \brief Returns the endpoints to try for a single request, best first.
+  //!
+  //! Endpoints whose circuit breakers are closed or half-open are returned,
+  //! ranked by their expected cost: the latency EWMA plus the error rate EWMA
+  //! weighted by Options::failure_cost_seconds. Endpoints that have not yet
+  //! been used have no cost, so they are tried early.
+  //!
+  //! If every endpoint’s circuit breaker is open, the endpoint whose breaker
+  //! would become half-open soonest is returned alone, so that requests are
+  //! never refused outright.
+  //!
+  //! \param[in] now The current time.
+  //!
+  //! \return Endpoint indices, in the order in which they should be tried.
+  //!     The caller should stop at the first successful request.
+  std::vector<size_t> SelectEndpoints(uint64_t now);
+
+  //! \brief Records a successful request to the endpoint at \a index.
+  //!
+  //! \param[in] index The endpoint.
+  //! \param[in] latency_nanoseconds The duration of the request.
+  void RecordSuccess(size_t index, uint64_t latency_nanoseconds);
+
+  //! \brief Records a failed request to the endpoint at \a index.
+  //!
+  //! \param[in] index The endpoint.
+  //! \param[in] now The time at which the request failed.
+  void RecordFailure(size_t index, uint64_t now);
+
+ private:
+  double Cost(const EndpointStats& stats) const;
+
+  std::vector<std::string> urls_;
+  std::vector<EndpointStats> stats_;
+  Options options_;
+
+  DISALLOW_COPY_AND_ASSIGN(HTTPEndpointSelector);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_NET_HTTP_ENDPOINT_SELECTOR_H_
@@ -0,0 +1,147 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/net/http_endpoint_selector.h"
+
+#include "gtest/gtest.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+constexpr uint64_t kSecond = 1000000000;
+
+std::vector<std::string> ThreeURLs() {
+  return {"https://a.example/report",
+          "https://b.example/report",
+          "https://c.example/report"};
+}
+
+TEST(HTTPEndpointSelector, InitialOrder) {
+  HTTPEndpointSelector selector(ThreeURLs(), HTTPEndpointSelector::Options());
+  ASSERT_EQ(selector.size(), 3u);
+  EXPECT_EQ(selector.url(1), "https://b.example/report");
+  EXPECT_EQ(selector.SelectEndpoints(0), (std::vector<size_t>{0, 1, 2}));
+}
+
+TEST(HTTPEndpointSelector, PrefersLowLatency) {
+  HTTPEndpointSelector selector(ThreeURLs(), HTTPEndpointSelector::Options());
+  selector.RecordSuccess(0, 5 * kSecond);
+  selector.RecordSuccess(1, 1 * kSecond);
+  selector.RecordSuccess(2, 3 * kSecond);
+  EXPECT_EQ(selector.SelectEndpoints(0), (std::vector<size_t>{1, 2, 0}));
+  EXPECT_DOUBLE_EQ(selector.stats(1).latency_seconds, 1);
+
+  // A slow response moves the average, but only part of the way.
+  selector.RecordSuccess(1, 9 * kSecond);
+  EXPECT_GT(selector.stats(1).latency_seconds, 1);
+  EXPECT_LT(selector.stats(1).latency_seconds, 9);
+}
+
+TEST(HTTPEndpointSelector, FailuresLowerRank) {
+  HTTPEndpointSelector selector(ThreeURLs(), HTTPEndpointSelector::Options());
+  selector.RecordSuccess(0, 1 * kSecond);
+  selector.RecordSuccess(1, 2 * kSecond);
+  selector.RecordSuccess(2, 3 * kSecond);
+
+  // A single failure is not enough to open the circuit breaker, but it is
+  // costly enough to demote the endpoint.
+  selector.RecordFailure(0, 0);
+  EXPECT_GT(selector.stats(0).error_rate, 0);
+  EXPECT_EQ(selector.stats(0).circuit_state,
+            HTTPEndpointSelector::CircuitState::kClosed);
+  EXPECT_EQ(selector.SelectEndpoints(0), (std::vector<size_t>{1, 2, 0}));
+}
+
+TEST(HTTPEndpointSelector, CircuitBreaker) {
+  HTTPEndpointSelector::Options options;
+  options.failure_threshold = 2;
+  options.open_nanoseconds = 10 * kSecond;
+  options.max_open_nanoseconds = 15 * kSecond;
+  HTTPEndpointSelector selector(ThreeURLs(), options);
+
+  selector.RecordFailure(0, 100 * kSecond);
+  EXPECT_EQ(selector.SelectEndpoints(100 * kSecond),
+            (std::vector<size_t>{1, 2, 0}));
+  selector.RecordFailure(0, 100 * kSecond);
+  EXPECT_EQ(selector.stats(0).circuit_state,
+            HTTPEndpointSelector::CircuitState::kOpen);
+  EXPECT_EQ(selector.SelectEndpoints(109 * kSecond),
+            (std::vector<size_t>{1, 2}));
+
+  // After the timeout, the endpoint is half-open, and may be tried again.
+  EXPECT_EQ(selector.SelectEndpoints(110 * kSecond),
+            (std::vector<size_t>{1, 2, 0}));
+  EXPECT_EQ(selector.stats(0).circuit_state,
+            HTTPEndpointSelector::CircuitState::kHalfOpen);
+
+  // A failed trial reopens it for longer, but no longer than the maximum.
+  selector.RecordFailure(0, 110 * kSecond);
+  EXPECT_EQ(selector.stats(0).circuit_state,
+            HTTPEndpointSelector::CircuitState::kOpen);
+  EXPECT_EQ(selector.SelectEndpoints(124 * kSecond),
+            (std::vector<size_t>{1, 2}));
+  EXPECT_EQ(selector.SelectEndpoints(125 * kSecond),
+            (std::vector<size_t>{1, 2, 0}));
+
+  // A successful trial closes it.
+  selector.RecordSuccess(0, 1 * kSecond);
+  EXPECT_EQ(selector.stats(0).circuit_state,
+            HTTPEndpointSelector::CircuitState::kClosed);
+  EXPECT_EQ(selector.stats(0).consecutive_failures, 0);
+  EXPECT_EQ(selector.stats(0).failures, 3);
+  EXPECT_EQ(selector.stats(0).successes, 1);
+}
+
+TEST(HTTPEndpointSelector, AllOpen) {
+  HTTPEndpointSelector::Options options;
+  options.failure_threshold = 1;
+  options.open_nanoseconds = 10 * kSecond;
+  HTTPEndpointSelector selector(ThreeURLs(), options);
+
+  selector.RecordFailure(2, 0);
+  selector.RecordFailure(0, 2 * kSecond);
+  selector.RecordFailure(1, 1 * kSecond);
+
+  // The endpoint that will recover soonest is offered alone.
+  EXPECT_EQ(selector.SelectEndpoints(3 * kSecond), (std::vector<size_t>{2}));
+  EXPECT_EQ(selector.stats(2).circuit_state,
+            HTTPEndpointSelector::CircuitState::kOpen);
+}
+
+TEST(HTTPEndpointSelector, Empty) {
+  const std::vector<std::string> no_urls;
+  HTTPEndpointSelector selector(no_urls, HTTPEndpointSelector::Options());
+  EXPECT_EQ(selector.size(), 0u);
+  EXPECT_TRUE(selector.SelectEndpoints(0).empty());
+}
+
+TEST(HTTPEndpointSelector, EmptyURLsIgnored) {
+  const std::vector<std::string> urls = {
+      std::string(), "https://a.example/report", std::string()};
+  HTTPEndpointSelector selector(urls, HTTPEndpointSelector::Options());
+  ASSERT_EQ(selector.size(), 1u);
+  EXPECT_EQ(selector.url(0), "https://a.example/report");
+  EXPECT_EQ(selector.SelectEndpoints(0), (std::vector<size_t>{0}));
+
+  const std::vector<std::string> only_empty(1, std::string());
+  HTTPEndpointSelector empty_selector(only_empty,
+                                      HTTPEndpointSelector::Options());
+  EXPECT_EQ(empty_selector.size(), 0u);
+  EXPECT_TRUE(empty_selector.SelectEndpoints(0).empty());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
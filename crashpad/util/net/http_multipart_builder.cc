@@ -115,6 +115,7 @@ HTTPMultipartBuilder::HTTPMultipartBuilder()
     : boundary_(GenerateBoundaryString()),
       form_data_(),
       file_attachments_(),
+      gzip_compression_level_(GzipHTTPBodyStream::kDefaultCompressionLevel),
       gzip_enabled_(false) {}
 
 HTTPMultipartBuilder::~HTTPMultipartBuilder() {
@@ -124,6 +125,10 @@ void HTTPMultipartBuilder::SetGzipEnabled(bool gzip_enabled) {
   gzip_enabled_ = gzip_enabled;
 }
 
+void HTTPMultipartBuilder::SetGzipCompressionLevel(int compression_level) {
+  gzip_compression_level_ = compression_level;
+}
+
 void HTTPMultipartBuilder::SetFormData(const std::string& key,
                                        const std::string& value) {
   EraseKey(key);
@@ -137,18 +142,23 @@ void HTTPMultipartBuilder::SetFileAttachment(
     const std::string& content_type) {
   EraseKey(upload_file_name);
 
-  FileAttachment attachment;
-  attachment.filename = EncodeMIMEField(upload_file_name);
+  FileAttachment& attachment = file_attachments_[key];
+  InitializeFileAttachment(upload_file_name, content_type, &attachment);
   attachment.path = path;
+  attachment.stream.reset();
+}
 
-  if (content_type.empty()) {
-    attachment.content_type = "application/octet-stream";
-  } else {
-    AssertSafeMIMEType(content_type);
-    attachment.content_type = content_type;
-  }
+void HTTPMultipartBuilder::SetFileAttachmentStream(
+    const std::string& key,
+    const std::string& upload_file_name,
+    std::unique_ptr<HTTPBodyStream> stream,
+    const std::string& content_type) {
+  EraseKey(upload_file_name);
 
-  file_attachments_[key] = attachment;
+  FileAttachment& attachment = file_attachments_[key];
+  InitializeFileAttachment(upload_file_name, content_type, &attachment);
+  attachment.path = base::FilePath();
+  attachment.stream = std::move(stream);
 }
 
 std::unique_ptr<HTTPBodyStream> HTTPMultipartBuilder::GetBodyStream() {
@@ -165,7 +175,8 @@ std::unique_ptr<HTTPBodyStream> HTTPMultipartBuilder::GetBodyStream() {
     streams.push_back(new StringHTTPBodyStream(field));
   }
 
-  for (const auto& pair : file_attachments_) {
+  for (auto it = file_attachments_.begin(); it != file_attachments_.end();) {
+    const auto& pair = *it;
     const FileAttachment& attachment = pair.second;
     std::string header = GetFormDataBoundary(boundary_, pair.first);
     header += base::StringPrintf("; filename=\"%s\"%s",
@@ -174,7 +185,13 @@ std::unique_ptr<HTTPBodyStream> HTTPMultipartBuilder::GetBodyStream() {
         attachment.content_type.c_str(), kBoundaryCRLF);
 
     streams.push_back(new StringHTTPBodyStream(header));
-    streams.push_back(new FileHTTPBodyStream(attachment.path));
+    if (attachment.stream) {
+      streams.push_back(it->second.stream.release());
+      it = file_attachments_.erase(it);
+    } else {
+      streams.push_back(new FileHTTPBodyStream(attachment.path));
+      ++it;
+    }
     streams.push_back(new StringHTTPBodyStream(kCRLF));
   }
 
@@ -185,7 +202,7 @@ std::unique_ptr<HTTPBodyStream> HTTPMultipartBuilder::GetBodyStream() {
       std::unique_ptr<HTTPBodyStream>(new CompositeHTTPBodyStream(streams));
   if (gzip_enabled_) {
     return std::unique_ptr<HTTPBodyStream>(
-        new GzipHTTPBodyStream(std::move(composite)));
+        new GzipHTTPBodyStream(std::move(composite), gzip_compression_level_));
   }
   return composite;
 }
@@ -201,6 +218,20 @@ void HTTPMultipartBuilder::PopulateContentHeaders(
   }
 }
 
+void HTTPMultipartBuilder::InitializeFileAttachment(
+    const std::string& upload_file_name,
+    const std::string& content_type,
+    FileAttachment* attachment) {
+  attachment->filename = EncodeMIMEField(upload_file_name);
+
+  if (content_type.empty()) {
+    attachment->content_type = "application/octet-stream";
+  } else {
+    AssertSafeMIMEType(content_type);
+    attachment->content_type = content_type;
+  }
+}
+
 void HTTPMultipartBuilder::EraseKey(const std::string& key) {
   auto data_it = form_data_.find(key);
   if (data_it != form_data_.end())
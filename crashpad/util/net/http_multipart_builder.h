@@ -43,6 +43,14 @@ class HTTPMultipartBuilder {
   //! PopulateContentHeaders() will contain `Content-Encoding: gzip`.
   void SetGzipEnabled(bool gzip_enabled);
 
+  //! \brief Sets the level of `gzip` compression used when it is enabled.
+  //!
+  //! \param[in] compression_level The zlib compression level, from `0` (no
+  //!     compression) to `9` (best compression), or
+  //!     GzipHTTPBodyStream::kDefaultCompressionLevel, which is used if this
+  //!     method is not called.
+  void SetGzipCompressionLevel(int compression_level);
+
   //! \brief Sets a `Content-Disposition: form-data` key-value pair.
   //!
   //! \param[in] key The key of the form data, specified as the `name` in the
@@ -67,6 +75,28 @@ class HTTPMultipartBuilder {
                          const base::FilePath& path,
                          const std::string& content_type);
 
+  //! \brief Specifies a stream whose contents are to be uploaded as multipart
+  //!     data, available at `name` of \a upload_file_name.
+  //!
+  //! This is like SetFileAttachment(), except that the contents are read from
+  //! \a stream, which may provide them as they become available. Because
+  //! \a stream can only be read once, it is included only in the body stream
+  //! returned by the next call to GetBodyStream(), and is then removed from the
+  //! builder.
+  //!
+  //! \param[in] key The key of the form data, specified as the `name` in the
+  //!     multipart message. Any data previously set on this class with this
+  //!     key will be overwritten.
+  //! \param[in] upload_file_name The `filename` to specify for this multipart
+  //!     data attachment.
+  //! \param[in] stream The stream whose contents will be uploaded.
+  //! \param[in] content_type The `Content-Type` to specify for the attachment.
+  //!     If this is empty, `"application/octet-stream"` will be used.
+  void SetFileAttachmentStream(const std::string& key,
+                               const std::string& upload_file_name,
+                               std::unique_ptr<HTTPBodyStream> stream,
+                               const std::string& content_type);
+
   //! \brief Generates the HTTPBodyStream for the data currently supplied to
   //!     the builder.
   //!
@@ -84,8 +114,16 @@ class HTTPMultipartBuilder {
     std::string filename;
     std::string content_type;
     base::FilePath path;
+
+    // If set, the contents are read from this stream instead of from |path|.
+    std::unique_ptr<HTTPBodyStream> stream;
   };
 
+  // Sets the filename and content type of |attachment|.
+  void InitializeFileAttachment(const std::string& upload_file_name,
+                                const std::string& content_type,
+                                FileAttachment* attachment);
+
   // Removes elements from both data maps at the specified |key|, to ensure
   // uniqueness across the entire HTTP body.
   void EraseKey(const std::string& key);
@@ -93,6 +131,7 @@ class HTTPMultipartBuilder {
   std::string boundary_;
   std::map<std::string, std::string> form_data_;
   std::map<std::string, FileAttachment> file_attachments_;
+  int gzip_compression_level_;
   bool gzip_enabled_;
 
   DISALLOW_COPY_AND_ASSIGN(HTTPMultipartBuilder);
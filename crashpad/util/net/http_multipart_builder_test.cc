@@ -16,6 +16,7 @@
 
 #include <sys/types.h>
 
+#include <memory>
 #include <vector>
 
 #include "gtest/gtest.h"
@@ -276,6 +277,53 @@ TEST(HTTPMultipartBuilder, SharedFormDataAndAttachmentKeyNamespace) {
   EXPECT_EQ(lines_it, lines.end());
 }
 
+TEST(HTTPMultipartBuilder, FileAttachmentStream) {
+  HTTPMultipartBuilder builder;
+  static constexpr char kValue[] = "1 2 3 test";
+  builder.SetFormData("a key", kValue);
+  static constexpr char kStreamed[] = "streamed contents";
+  builder.SetFileAttachmentStream(
+      "minidump",
+      "minidump.dmp",
+      std::unique_ptr<HTTPBodyStream>(new StringHTTPBodyStream(kStreamed)),
+      "");
+
+  std::unique_ptr<HTTPBodyStream> body(builder.GetBodyStream());
+  ASSERT_TRUE(body.get());
+  std::string contents = ReadStreamToString(body.get());
+  auto lines = SplitCRLF(contents);
+  ASSERT_EQ(lines.size(), 10u);
+  auto lines_it = lines.begin();
+
+  const std::string& boundary = *lines_it++;
+  EXPECT_GE(boundary.length(), 1u);
+  EXPECT_LE(boundary.length(), 70u);
+
+  EXPECT_EQ(*lines_it++, "Content-Disposition: form-data; name=\"a key\"");
+  EXPECT_EQ(*lines_it++, "");
+  EXPECT_EQ(*lines_it++, kValue);
+
+  EXPECT_EQ(*lines_it++, boundary);
+  EXPECT_EQ(*lines_it++,
+            "Content-Disposition: form-data; "
+            "name=\"minidump\"; filename=\"minidump.dmp\"");
+  EXPECT_EQ(*lines_it++, "Content-Type: application/octet-stream");
+  EXPECT_EQ(*lines_it++, "");
+  EXPECT_EQ(*lines_it++, kStreamed);
+
+  EXPECT_EQ(*lines_it++, boundary + "--");
+
+  EXPECT_EQ(lines_it, lines.end());
+
+  // The stream can only be read once, so it is not part of a second body.
+  body = builder.GetBodyStream();
+  ASSERT_TRUE(body.get());
+  contents = ReadStreamToString(body.get());
+  lines = SplitCRLF(contents);
+  ASSERT_EQ(lines.size(), 5u);
+  EXPECT_EQ(lines[3], kValue);
+}
+
 TEST(HTTPMultipartBuilderDeathTest, AssertUnsafeMIMEType) {
   HTTPMultipartBuilder builder;
   // Invalid and potentially dangerous:
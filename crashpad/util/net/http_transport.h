@@ -44,6 +44,9 @@ class HTTPTransport {
 
   //! \brief Sets URL to which the request will be made.
   //!
+  //! On Linux, a `unix://` URL may be used to make the request over a UNIX
+  //! domain socket. See SplitUnixSocketURL() for the format of these URLs.
+  //!
   //! \param[in] url The request URL.
   void SetURL(const std::string& url);
 
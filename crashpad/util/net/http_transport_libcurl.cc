@@ -29,6 +29,7 @@
 #include "build/build_config.h"
 #include "package.h"
 #include "util/net/http_body.h"
+#include "util/net/url.h"
 #include "util/numeric/safe_assignment.h"
 
 namespace crashpad {
@@ -255,7 +256,18 @@ bool HTTPTransportLibcurl::ExecuteSynchronously(std::string* response_body) {
   // Accept and automatically decode any encoding that libcurl understands.
   TRY_CURL_EASY_SETOPT(curl.get(), CURLOPT_ACCEPT_ENCODING, "");
 
-  TRY_CURL_EASY_SETOPT(curl.get(), CURLOPT_URL, url().c_str());
+  // A unix:// URL names a resource served over a UNIX domain socket, such as
+  // one belonging to a collector running on the same host. libcurl speaks HTTP
+  // over the socket, with the rest of the request unchanged.
+  std::string socket_path;
+  std::string http_url;
+  if (SplitUnixSocketURL(url(), &socket_path, &http_url)) {
+    TRY_CURL_EASY_SETOPT(
+        curl.get(), CURLOPT_UNIX_SOCKET_PATH, socket_path.c_str());
+    TRY_CURL_EASY_SETOPT(curl.get(), CURLOPT_URL, http_url.c_str());
+  } else {
+    TRY_CURL_EASY_SETOPT(curl.get(), CURLOPT_URL, url().c_str());
+  }
 
   constexpr int kMillisecondsPerSecond = 1E3;
   TRY_CURL_EASY_SETOPT(curl.get(),
@@ -25,12 +25,18 @@ response body in a successful response (one with code 200). The server will
 process one HTTP request, deliver the prearranged response to the client, and
 write the entire request to stdout. It will then terminate.
 
+When invoked with --benchmark, the server instead writes the URL to upload to
+as a line on stdout, and accepts any number of requests, concurrently, until it
+is interrupted. Every request receives an empty response with code 200. This
+serves as a stand-in collection server for crashpad_http_upload --benchmark.
+
 This server is written in Python since it provides a simple HTTP stack, and
 because parsing chunked encoding is safer and easier in a memory-safe language.
 This could easily have been written in C++ instead.
 """
 
 import BaseHTTPServer
+import SocketServer
 import struct
 import sys
 import zlib
@@ -145,7 +151,42 @@ class RequestHandler(BaseHTTPServer.BaseHTTPRequestHandler):
     pass
 
 
+class BenchmarkRequestHandler(RequestHandler):
+  def do_POST(self):
+    # Read and discard the request body, as a collection server would after
+    # storing it.
+    if self.headers.get('Transfer-Encoding', '').lower() == 'chunked':
+      self.handle_chunked_encoding()
+    else:
+      self.rfile.read(int(self.headers.get('Content-Length', 0)))
+    self.rfile.buffer = ''
+
+    self.send_response(200)
+    self.end_headers()
+
+
+class ThreadingHTTPServer(SocketServer.ThreadingMixIn,
+                          BaseHTTPServer.HTTPServer):
+  daemon_threads = True
+
+
+def BenchmarkMain():
+  server = ThreadingHTTPServer(('127.0.0.1', 0), BenchmarkRequestHandler)
+
+  sys.stdout.write('http://127.0.0.1:%d/upload\n' % server.server_address[1])
+  sys.stdout.flush()
+
+  try:
+    server.serve_forever()
+  except KeyboardInterrupt:
+    pass
+
+
 def Main():
+  if len(sys.argv) > 1 and sys.argv[1] == '--benchmark':
+    BenchmarkMain()
+    return
+
   if sys.platform == 'win32':
     import os, msvcrt
     msvcrt.setmode(sys.stdout.fileno(), os.O_BINARY)
@@ -16,10 +16,53 @@
 
 #include <string.h>
 
+#include "base/logging.h"
 #include "base/strings/stringprintf.h"
 
 namespace crashpad {
 
+namespace {
+
+int HexDigitValue(char character) {
+  if (character >= '0' && character <= '9') {
+    return character - '0';
+  }
+  if (character >= 'A' && character <= 'F') {
+    return character - 'A' + 10;
+  }
+  if (character >= 'a' && character <= 'f') {
+    return character - 'a' + 10;
+  }
+  return -1;
+}
+
+bool URLDecode(const std::string& encoded, std::string* decoded) {
+  decoded->clear();
+  decoded->reserve(encoded.length());
+
+  for (size_t index = 0; index < encoded.length(); ++index) {
+    if (encoded[index] != '%') {
+      decoded->push_back(encoded[index]);
+      continue;
+    }
+
+    if (index + 2 >= encoded.length()) {
+      return false;
+    }
+    int high = HexDigitValue(encoded[index + 1]);
+    int low = HexDigitValue(encoded[index + 2]);
+    if (high < 0 || low < 0) {
+      return false;
+    }
+    decoded->push_back(static_cast<char>(high << 4 | low));
+    index += 2;
+  }
+
+  return true;
+}
+
+}  // namespace
+
 std::string URLEncode(const std::string& url) {
   const char kSafeCharacters[] = "-_.~";
   std::string encoded;
@@ -41,4 +84,36 @@ std::string URLEncode(const std::string& url) {
   return encoded;
 }
 
+bool SplitUnixSocketURL(const std::string& url,
+                        std::string* socket_path,
+                        std::string* http_url) {
+  static constexpr char kUnixScheme[] = "unix://";
+  if (url.compare(0, strlen(kUnixScheme), kUnixScheme) != 0) {
+    return false;
+  }
+
+  const size_t authority_start = strlen(kUnixScheme);
+  size_t authority_end = url.find_first_of("/?", authority_start);
+  if (authority_end == std::string::npos) {
+    authority_end = url.length();
+  }
+
+  std::string path;
+  if (!URLDecode(url.substr(authority_start, authority_end - authority_start),
+                 &path) ||
+      path.empty() || path.find('\0') != std::string::npos) {
+    LOG(ERROR) << "invalid socket path in " << url;
+    return false;
+  }
+
+  std::string request = url.substr(authority_end);
+  if (request.empty() || request[0] != '/') {
+    request.insert(0, 1, '/');
+  }
+
+  socket_path->swap(path);
+  *http_url = "http://localhost" + request;
+  return true;
+}
+
 }  // namespace crashpad
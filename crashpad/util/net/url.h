@@ -26,6 +26,30 @@ namespace crashpad {
 //! \return The encoded string.
 std::string URLEncode(const std::string& url);
 
+//! \brief Splits a `unix://` URL, which identifies an HTTP resource served over
+//!     a UNIX domain socket, into the path to the socket and an equivalent
+//!     `http://` URL.
+//!
+//! The authority portion of a `unix://` URL is the percent-encoded path to the
+//! socket, and the remainder is the path and query of the HTTP request. For
+//! example, `unix://%2Frun%2Fcollector.sock/upload?prod=app` identifies the
+//! resource `/upload?prod=app` served over the socket at
+//! `/run/collector.sock`, and is split into that socket path and the URL
+//! `http://localhost/upload?prod=app`.
+//!
+//! \param[in] url The URL to split.
+//! \param[out] socket_path The path to the UNIX domain socket.
+//! \param[out] http_url An `http://` URL naming the same resource, to be
+//!     requested over the socket.
+//!
+//! \return `true` if \a url is a valid `unix://` URL, with \a socket_path and
+//!     \a http_url set appropriately. `false` otherwise, with no message
+//!     logged if \a url uses some other scheme, or with a message logged if it
+//!     is a malformed `unix://` URL.
+bool SplitUnixSocketURL(const std::string& url,
+                        std::string* socket_path,
+                        std::string* http_url);
+
 }  // namespace crashpad
 
 #endif  // CRASHPAD_UTIL_NET_URL_H_
@@ -14,6 +14,8 @@
 
 #include "util/net/url.h"
 
+#include <string>
+
 #include "gtest/gtest.h"
 
 namespace crashpad {
@@ -42,6 +44,51 @@ TEST(URLEncode, SimpleAddress) {
       "3Dvalue");
 }
 
+TEST(SplitUnixSocketURL, NotUnix) {
+  std::string socket_path("unchanged");
+  std::string http_url("unchanged");
+  EXPECT_FALSE(SplitUnixSocketURL(
+      "http://localhost/upload", &socket_path, &http_url));
+  EXPECT_FALSE(SplitUnixSocketURL("unix:/run/sock", &socket_path, &http_url));
+  EXPECT_FALSE(SplitUnixSocketURL("", &socket_path, &http_url));
+  EXPECT_EQ(socket_path, "unchanged");
+  EXPECT_EQ(http_url, "unchanged");
+}
+
+TEST(SplitUnixSocketURL, Valid) {
+  std::string socket_path;
+  std::string http_url;
+  ASSERT_TRUE(SplitUnixSocketURL(
+      "unix://%2Frun%2Fcollector.sock/upload?prod=app&ver=1",
+      &socket_path,
+      &http_url));
+  EXPECT_EQ(socket_path, "/run/collector.sock");
+  EXPECT_EQ(http_url, "http://localhost/upload?prod=app&ver=1");
+
+  ASSERT_TRUE(SplitUnixSocketURL(
+      "unix://%2ftmp%2Fdir%20with%20spaces%2Fs", &socket_path, &http_url));
+  EXPECT_EQ(socket_path, "/tmp/dir with spaces/s");
+  EXPECT_EQ(http_url, "http://localhost/");
+
+  ASSERT_TRUE(
+      SplitUnixSocketURL("unix://relative.sock?q", &socket_path, &http_url));
+  EXPECT_EQ(socket_path, "relative.sock");
+  EXPECT_EQ(http_url, "http://localhost/?q");
+}
+
+TEST(SplitUnixSocketURL, Invalid) {
+  std::string socket_path;
+  std::string http_url;
+  EXPECT_FALSE(SplitUnixSocketURL("unix:///upload", &socket_path, &http_url));
+  EXPECT_FALSE(SplitUnixSocketURL("unix://", &socket_path, &http_url));
+  EXPECT_FALSE(
+      SplitUnixSocketURL("unix://%2Frun%2/upload", &socket_path, &http_url));
+  EXPECT_FALSE(
+      SplitUnixSocketURL("unix://%2Frun%GG/upload", &socket_path, &http_url));
+  EXPECT_FALSE(
+      SplitUnixSocketURL("unix://%2Frun%00/upload", &socket_path, &http_url));
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace crashpad
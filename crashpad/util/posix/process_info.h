@@ -176,6 +176,7 @@ class ProcessInfo {
   // See https://crashpad.chromium.org/bug/9.
   std::set<gid_t> supplementary_groups_;
   mutable timeval start_time_;
+  PtraceConnection* connection_;  // weak
   pid_t pid_;
   pid_t ppid_;
   uid_t uid_;
@@ -0,0 +1,197 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/process/mapped_file_memory_source.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "base/numerics/safe_math.h"
+#include "util/file/file_io.h"
+
+namespace crashpad {
+
+MappedFileMemorySource::MappedFileMemorySource()
+    : ProcessMemory::Source(),
+      ranges_(),
+      mapping_(),
+      size_(0),
+      initialized_() {}
+
+MappedFileMemorySource::~MappedFileMemorySource() {}
+
+bool MappedFileMemorySource::Initialize(const base::FilePath& path) {
+  INITIALIZATION_STATE_SET_INITIALIZING(initialized_);
+
+  ScopedFileHandle handle(LoggingOpenFileForRead(path));
+  if (!handle.is_valid()) {
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(handle.get(), &st) != 0) {
+    PLOG(ERROR) << "fstat " << path.value();
+    return false;
+  }
+  if (!base::IsValueInRangeForNumericType<size_t>(st.st_size)) {
+    LOG(ERROR) << "file too large " << st.st_size;
+    return false;
+  }
+  size_ = st.st_size;
+
+  // An empty file can’t be mapped, but there’s nothing to read from it either.
+  if (size_ > 0) {
+    const size_t page_size = getpagesize();
+    base::CheckedNumeric<size_t> mapping_size = size_;
+    mapping_size += page_size - 1;
+    if (!mapping_size.IsValid()) {
+      LOG(ERROR) << "file too large " << size_;
+      return false;
+    }
+    if (!mapping_.ResetMmap(nullptr,
+                            mapping_size.ValueOrDie() / page_size * page_size,
+                            PROT_READ,
+                            MAP_PRIVATE,
+                            handle.get(),
+                            0)) {
+      return false;
+    }
+  }
+
+  INITIALIZATION_STATE_SET_VALID(initialized_);
+  return true;
+}
+
+const char* MappedFileMemorySource::Data() const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  return size_ > 0 ? mapping_.addr_as<const char*>() : nullptr;
+}
+
+bool MappedFileMemorySource::ReadFileRange(uint64_t offset,
+                                           size_t size,
+                                           void* buffer) const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+
+  base::CheckedNumeric<uint64_t> end = offset;
+  end += size;
+  if (!end.IsValid() || end.ValueOrDie() > size_) {
+    LOG(ERROR) << "range at " << offset << " outside of file";
+    return false;
+  }
+  if (size > 0) {
+    memcpy(buffer, Data() + offset, size);
+  }
+  return true;
+}
+
+bool MappedFileMemorySource::AddRange(VMAddress address,
+                                      uint64_t offset,
+                                      uint64_t size) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+
+  base::CheckedNumeric<uint64_t> offset_end = offset;
+  offset_end += size;
+  if (!offset_end.IsValid() || offset_end.ValueOrDie() > size_) {
+    LOG(ERROR) << "range outside of file";
+    return false;
+  }
+  base::CheckedNumeric<VMAddress> address_end = address;
+  address_end += size;
+  if (!address_end.IsValid()) {
+    LOG(ERROR) << "range outside of address space";
+    return false;
+  }
+
+  // Only the parts of the range not already covered are added, so that the
+  // ranges remain disjoint.
+  VMAddress cursor = address;
+  const VMAddress end = address_end.ValueOrDie();
+  auto previous = ranges_.upper_bound(cursor);
+  if (previous != ranges_.begin()) {
+    --previous;
+    cursor = std::max(cursor, previous->first + previous->second.size);
+  }
+  while (cursor < end) {
+    auto next = ranges_.lower_bound(cursor);
+    const VMAddress gap_end =
+        next == ranges_.end() ? end : std::min(end, next->first);
+    if (gap_end > cursor) {
+      Range range;
+      range.offset = offset + (cursor - address);
+      range.size = gap_end - cursor;
+      ranges_[cursor] = range;
+    }
+    if (next == ranges_.end() || next->first >= end) {
+      break;
+    }
+    cursor = next->first + next->second.size;
+  }
+  return true;
+}
+
+ssize_t MappedFileMemorySource::ReadUpTo(VMAddress address,
+                                         size_t size,
+                                         void* buffer) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+
+  // Adjacent ranges are read as one, as the memory would be in the process.
+  char* buffer_c = static_cast<char*>(buffer);
+  size_t bytes_read = 0;
+  while (bytes_read < size) {
+    const VMAddress current = address + bytes_read;
+    auto iterator = ranges_.upper_bound(current);
+    if (iterator == ranges_.begin()) {
+      break;
+    }
+    --iterator;
+    const VMAddress offset = current - iterator->first;
+    if (offset >= iterator->second.size) {
+      break;
+    }
+
+    const size_t copy_size = static_cast<size_t>(
+        std::min<uint64_t>(size - bytes_read, iterator->second.size - offset));
+    memcpy(buffer_c + bytes_read,
+           Data() + iterator->second.offset + offset,
+           copy_size);
+    bytes_read += copy_size;
+  }
+
+  if (bytes_read == 0 && size > 0) {
+    errno = EFAULT;
+    return -1;
+  }
+  return bytes_read;
+}
+
+bool MappedFileMemorySource::ReadBatch(
+    const std::vector<ProcessMemory::ReadRequest>& requests) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  for (const ProcessMemory::ReadRequest& request : requests) {
+    if (ReadUpTo(request.address, request.size, request.buffer) !=
+        static_cast<ssize_t>(request.size)) {
+      LOG(ERROR) << "memory at " << request.address << " not in file";
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace crashpad
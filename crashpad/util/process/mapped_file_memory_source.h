@@ -0,0 +1,100 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_PROCESS_MAPPED_FILE_MEMORY_SOURCE_H_
+#define CRASHPAD_UTIL_PROCESS_MAPPED_FILE_MEMORY_SOURCE_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <map>
+#include <vector>
+
+#include "base/files/file_path.h"
+#include "base/macros.h"
+#include "util/misc/address_types.h"
+#include "util/misc/initialization_state_dcheck.h"
+#include "util/posix/scoped_mmap.h"
+#include "util/process/process_memory.h"
+
+namespace crashpad {
+
+//! \brief Serves a process’ memory from a file containing a copy of it, such
+//!     as a minidump or an ELF core file.
+//!
+//! The file is memory-mapped, so reads are copies out of the page cache and
+//! only the parts of the file that are read are brought into memory. The
+//! caller describes where each range of the process’ memory is in the file
+//! with AddRange().
+class MappedFileMemorySource : public ProcessMemory::Source {
+ public:
+  MappedFileMemorySource();
+  ~MappedFileMemorySource() override;
+
+  //! \brief Maps the file at \a path.
+  //!
+  //! This method must be successfully called before calling any other.
+  //!
+  //! \return `true` on success. `false` on failure with a message logged.
+  bool Initialize(const base::FilePath& path);
+
+  //! \brief Returns the contents of the file, or `nullptr` if it is empty.
+  const char* Data() const;
+
+  //! \brief Returns the size of the file.
+  size_t Size() const { return size_; }
+
+  //! \brief Copies \a size bytes of the file at \a offset into \a buffer.
+  //!
+  //! This is used to read the file’s own structures, which needn’t be aligned.
+  //!
+  //! \return `true` on success. `false` with a message logged if the range
+  //!     doesn’t lie within the file.
+  bool ReadFileRange(uint64_t offset, size_t size, void* buffer) const;
+
+  //! \brief Declares that \a size bytes of the process’ memory at \a address
+  //!     are in the file at \a offset.
+  //!
+  //! Where the range overlaps ranges already added, the earlier ranges are
+  //! used.
+  //!
+  //! \return `true` on success. `false` with a message logged if the range
+  //!     doesn’t lie within the file or the address space.
+  bool AddRange(VMAddress address, uint64_t offset, uint64_t size);
+
+  // ProcessMemory::Source:
+
+  ssize_t ReadUpTo(VMAddress address, size_t size, void* buffer) override;
+  bool ReadBatch(const std::vector<ProcessMemory::ReadRequest>& requests)
+      override;
+
+ private:
+  struct Range {
+    uint64_t offset;
+    uint64_t size;
+  };
+
+  // The ranges added by AddRange(), keyed by address. They don’t overlap.
+  std::map<VMAddress, Range> ranges_;
+
+  ScopedMmap mapping_;
+  size_t size_;
+  InitializationStateDcheck initialized_;
+
+  DISALLOW_COPY_AND_ASSIGN(MappedFileMemorySource);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_PROCESS_MAPPED_FILE_MEMORY_SOURCE_H_
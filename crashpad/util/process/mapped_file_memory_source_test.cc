@@ -0,0 +1,98 @@
+// Copyright 2017 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/process/mapped_file_memory_source.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+#include "test/scoped_temp_dir.h"
+#include "util/file/file_io.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+base::FilePath WriteTestFile(const ScopedTempDir& temp_dir,
+                             const std::string& contents) {
+  base::FilePath path = temp_dir.path().Append("file");
+  ScopedFileHandle handle(LoggingOpenFileForWrite(
+      path, FileWriteMode::kTruncateOrCreate, FilePermissions::kOwnerOnly));
+  EXPECT_TRUE(handle.is_valid());
+  CheckedWriteFile(handle.get(), contents.data(), contents.size());
+  return path;
+}
+
+std::string ReadMemory(const ProcessMemory& memory,
+                       VMAddress address,
+                       size_t size) {
+  std::string buffer(size, '\0');
+  if (!memory.Read(address, size, &buffer[0])) {
+    return "-";
+  }
+  return buffer;
+}
+
+TEST(MappedFileMemorySource, Ranges) {
+  ScopedTempDir temp_dir;
+  MappedFileMemorySource source;
+  ASSERT_TRUE(
+      source.Initialize(WriteTestFile(temp_dir, "abcdefghijklmnop")));
+  EXPECT_EQ(source.Size(), 16u);
+
+  ProcessMemory memory;
+  ASSERT_TRUE(memory.InitializeWithSource(&source));
+  EXPECT_EQ(ReadMemory(memory, 0x1000, 4), "-");
+
+  ASSERT_TRUE(source.AddRange(0x1000, 0, 4));
+  ASSERT_TRUE(source.AddRange(0x1008, 8, 4));
+  EXPECT_EQ(ReadMemory(memory, 0x1000, 4), "abcd");
+  EXPECT_EQ(ReadMemory(memory, 0x1002, 2), "cd");
+  EXPECT_EQ(ReadMemory(memory, 0x1002, 4), "-");
+  EXPECT_EQ(ReadMemory(memory, 0x0fff, 2), "-");
+  EXPECT_EQ(ReadMemory(memory, 0x1008, 4), "ijkl");
+
+  // A range filling the gap joins the ranges on either side. Where it overlaps
+  // them, they’re still used.
+  ASSERT_TRUE(source.AddRange(0x0ffe, 10, 16 - 10));
+  ASSERT_TRUE(source.AddRange(0x1002, 0, 10));
+  EXPECT_EQ(ReadMemory(memory, 0x0ffe, 14), "klabcdcdefijkl");
+
+  EXPECT_FALSE(source.AddRange(0x2000, 12, 5));
+  EXPECT_FALSE(source.AddRange(0x2000, 17, 0));
+  EXPECT_FALSE(source.AddRange(0xffffffffffffffff, 0, 2));
+
+  char buffer[4];
+  ASSERT_TRUE(source.ReadFileRange(12, 4, buffer));
+  EXPECT_EQ(std::string(buffer, 4), "mnop");
+  EXPECT_FALSE(source.ReadFileRange(13, 4, buffer));
+}
+
+TEST(MappedFileMemorySource, EmptyFile) {
+  ScopedTempDir temp_dir;
+  MappedFileMemorySource source;
+  ASSERT_TRUE(source.Initialize(WriteTestFile(temp_dir, std::string())));
+  EXPECT_EQ(source.Size(), 0u);
+  EXPECT_EQ(source.Data(), nullptr);
+  EXPECT_TRUE(source.AddRange(0x1000, 0, 0));
+  EXPECT_FALSE(source.AddRange(0x1000, 0, 1));
+
+  ProcessMemory memory;
+  ASSERT_TRUE(memory.InitializeWithSource(&source));
+  EXPECT_EQ(ReadMemory(memory, 0x1000, 1), "-");
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
@@ -14,6 +14,7 @@
 
 #include "util/process/process_memory.h"
 
+#include <errno.h>
 #include <fcntl.h>
 #include <stdio.h>
 #include <string.h>
@@ -23,10 +24,23 @@
 
 #include "base/logging.h"
 #include "base/posix/eintr_wrapper.h"
+#include "util/linux/io_uring.h"
 
 namespace crashpad {
 
-ProcessMemory::ProcessMemory() : mem_fd_(), pid_(-1) {}
+namespace {
+
+// The number of reads that ReadBatch() submits together.
+constexpr unsigned int kIoUringEntries = 64;
+
+}  // namespace
+
+ProcessMemory::ProcessMemory()
+    : mem_fd_(),
+      io_uring_(),
+      source_(nullptr),
+      pid_(-1),
+      io_uring_state_(IoUringState::kUntried) {}
 
 ProcessMemory::~ProcessMemory() {}
 
@@ -42,17 +56,30 @@ bool ProcessMemory::Initialize(pid_t pid) {
   return true;
 }
 
+bool ProcessMemory::InitializeWithSource(Source* source) {
+  DCHECK(source);
+  source_ = source;
+  return true;
+}
+
+ssize_t ProcessMemory::ReadUpTo(VMAddress address,
+                                size_t size,
+                                void* buffer) const {
+  if (source_) {
+    return source_->ReadUpTo(address, size, buffer);
+  }
+  DCHECK(mem_fd_.is_valid());
+  return HANDLE_EINTR(pread64(mem_fd_.get(), buffer, size, address));
+}
+
 bool ProcessMemory::Read(VMAddress address,
                          size_t size,
                          void* buffer) const {
-  DCHECK(mem_fd_.is_valid());
-
   char* buffer_c = static_cast<char*>(buffer);
   while (size > 0) {
-    ssize_t bytes_read =
-        HANDLE_EINTR(pread64(mem_fd_.get(), buffer_c, size, address));
+    ssize_t bytes_read = ReadUpTo(address, size, buffer_c);
     if (bytes_read < 0) {
-      PLOG(ERROR) << "pread64";
+      PLOG(ERROR) << "read";
       return false;
     }
     if (bytes_read == 0) {
@@ -67,6 +94,98 @@ bool ProcessMemory::Read(VMAddress address,
   return true;
 }
 
+bool ProcessMemory::ReadBatch(const std::vector<ReadRequest>& requests) const {
+  if (source_) {
+    return source_->ReadBatch(requests);
+  }
+  DCHECK(mem_fd_.is_valid());
+
+  // The io_uring is created on first use, so that ProcessMemory objects that
+  // never read in batches don’t pay for it.
+  if (io_uring_state_ == IoUringState::kUntried) {
+    io_uring_state_ = IoUringState::kUnavailable;
+    if (IoUring::IsSupported()) {
+      io_uring_.reset(new IoUring());
+      if (io_uring_->Initialize(kIoUringEntries)) {
+        io_uring_state_ = IoUringState::kAvailable;
+      } else {
+        io_uring_.reset();
+      }
+    }
+  }
+
+  if (io_uring_state_ == IoUringState::kAvailable) {
+    return ReadBatchIoUring(requests);
+  }
+  return ReadBatchSynchronous(requests);
+}
+
+bool ProcessMemory::ReadBatchIoUring(
+    const std::vector<ReadRequest>& requests) const {
+  std::vector<IoUring::Completion> completions;
+  size_t index = 0;
+  while (index < requests.size()) {
+    const size_t batch_start = index;
+    while (index < requests.size()) {
+      const ReadRequest& request = requests[index];
+      if (request.size > 0 &&
+          !io_uring_->QueueRead(mem_fd_.get(),
+                                request.buffer,
+                                request.size,
+                                request.address,
+                                index)) {
+        break;
+      }
+      ++index;
+    }
+
+    if (!io_uring_->SubmitAndWait(&completions)) {
+      // The io_uring can’t be used again. Reading everything without it is
+      // simpler than working out which reads completed.
+      LOG(WARNING) << "io_uring failed, reading synchronously";
+      io_uring_.reset();
+      io_uring_state_ = IoUringState::kUnavailable;
+      return ReadBatchSynchronous(requests);
+    }
+
+    for (const IoUring::Completion& completion : completions) {
+      if (completion.user_data < batch_start ||
+          completion.user_data >= index) {
+        LOG(ERROR) << "unexpected io_uring completion "
+                   << completion.user_data;
+        return false;
+      }
+      const ReadRequest& request = requests[completion.user_data];
+      if (completion.result < 0) {
+        errno = -completion.result;
+        PLOG(ERROR) << "io_uring read";
+        return false;
+      }
+
+      // Finish a short read synchronously. This also produces the appropriate
+      // error if the short read was caused by an unreadable page.
+      size_t bytes_read = completion.result;
+      if (bytes_read < request.size &&
+          !Read(request.address + bytes_read,
+                request.size - bytes_read,
+                static_cast<char*>(request.buffer) + bytes_read)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool ProcessMemory::ReadBatchSynchronous(
+    const std::vector<ReadRequest>& requests) const {
+  for (const ReadRequest& request : requests) {
+    if (!Read(request.address, request.size, request.buffer)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 bool ProcessMemory::ReadCString(VMAddress address,
                                 std::string* string) const {
   return ReadCStringInternal(address, false, 0, string);
@@ -82,8 +201,6 @@ bool ProcessMemory::ReadCStringInternal(VMAddress address,
                                         bool has_size,
                                         size_t size,
                                         std::string* string) const {
-  DCHECK(mem_fd_.is_valid());
-
   string->clear();
 
   char buffer[4096];
@@ -94,11 +211,9 @@ bool ProcessMemory::ReadCStringInternal(VMAddress address,
     } else {
       read_size = sizeof(buffer);
     }
-    ssize_t bytes_read;
-    bytes_read =
-        HANDLE_EINTR(pread64(mem_fd_.get(), buffer, read_size, address));
+    ssize_t bytes_read = ReadUpTo(address, read_size, buffer);
     if (bytes_read < 0) {
-      PLOG(ERROR) << "pread64";
+      PLOG(ERROR) << "read";
       return false;
     }
     if (bytes_read == 0) {
@@ -17,7 +17,9 @@
 
 #include <sys/types.h>
 
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "base/files/scoped_file.h"
 #include "base/macros.h"
@@ -25,9 +27,53 @@
 
 namespace crashpad {
 
+class IoUring;
+
 //! \brief Accesses the memory of another process.
 class ProcessMemory {
  public:
+  //! \brief A memory region to be copied by ReadBatch().
+  struct ReadRequest {
+    //! \brief The address, in the target process’ address space, of the memory
+    //!     region to copy.
+    VMAddress address;
+
+    //! \brief The size, in bytes, of the memory region to copy.
+    size_t size;
+
+    //! \brief The buffer into which the memory region will be copied. This
+    //!     must be at least #size bytes long.
+    void* buffer;
+  };
+
+  //! \brief A source of another process’ memory, used in place of
+  //!     `/proc/[pid]/mem` by a ProcessMemory initialized with
+  //!     InitializeWithSource().
+  class Source {
+   public:
+    virtual ~Source() {}
+
+    //! \brief Copies memory from the target process into a caller-provided
+    //!     buffer, stopping early at memory that can’t be read.
+    //!
+    //! \param[in] address The address, in the target process’ address space,
+    //!     of the memory region to copy.
+    //! \param[in] size The size, in bytes, of the memory region to copy.
+    //! \param[out] buffer The buffer into which the memory will be copied.
+    //!
+    //! \return The number of bytes copied, which is less than \a size only if
+    //!     the memory following them couldn’t be read, and is `0` if \a size
+    //!     is `0`. `-1` if no memory could be read, with `errno` set.
+    virtual ssize_t ReadUpTo(VMAddress address, size_t size, void* buffer) = 0;
+
+    //! \brief Copies several memory regions, as ProcessMemory::ReadBatch()
+    //!     does.
+    //!
+    //! \return `true` if every region was copied successfully. `false` on
+    //!     failure, with a message logged.
+    virtual bool ReadBatch(const std::vector<ReadRequest>& requests) = 0;
+  };
+
   ProcessMemory();
   ~ProcessMemory();
 
@@ -42,6 +88,17 @@ class ProcessMemory {
   //! \return `true` on success, `false` on failure with a message logged.
   bool Initialize(pid_t pid);
 
+  //! \brief Initializes this object to read memory from \a source.
+  //!
+  //! This method must be called successfully prior to calling any other method
+  //! in this class, unless Initialize() is called instead.
+  //!
+  //! \param[in] source The source of the memory, which must outlive this
+  //!     object.
+  //!
+  //! \return `true` on success, `false` on failure with a message logged.
+  bool InitializeWithSource(Source* source);
+
   //! \brief Copies memory from the target process into a caller-provided buffer
   //!     in the current process.
   //!
@@ -56,6 +113,21 @@ class ProcessMemory {
   //!     failure, with a message logged.
   bool Read(VMAddress address, size_t size, void* buffer) const;
 
+  //! \brief Copies several memory regions from the target process into
+  //!     caller-provided buffers in the current process.
+  //!
+  //! When io_uring is available, the reads are submitted to the kernel
+  //! together instead of being issued one at a time. Otherwise, each region is
+  //! copied in turn as if by Read(). If io_uring fails, the batch is retried
+  //! this way, and io_uring is not used again.
+  //!
+  //! \param[in] requests The regions to copy.
+  //!
+  //! \return `true` if every region was copied successfully. `false` on
+  //!     failure, with a message logged. On failure, the contents of all of
+  //!     the buffers in \a requests are undefined.
+  bool ReadBatch(const std::vector<ReadRequest>& requests) const;
+
   //! \brief Reads a `NUL`-terminated C string from the target process into a
   //!     string in the current process.
   //!
@@ -88,14 +160,40 @@ class ProcessMemory {
                               size_t size,
                               std::string* string) const;
 
+  //! \brief Copies memory from the target process into a caller-provided
+  //!     buffer, stopping early at memory that can’t be read.
+  //!
+  //! Unlike Read(), this does not log a message on failure.
+  //!
+  //! \return As for Source::ReadUpTo().
+  ssize_t ReadUpTo(VMAddress address, size_t size, void* buffer) const;
+
  private:
   bool ReadCStringInternal(VMAddress address,
                            bool has_size,
                            size_t size,
                            std::string* string) const;
 
+  bool ReadBatchIoUring(const std::vector<ReadRequest>& requests) const;
+  bool ReadBatchSynchronous(const std::vector<ReadRequest>& requests) const;
+
+  enum class IoUringState {
+    kUntried,
+    kAvailable,
+    kUnavailable,
+  };
+
   base::ScopedFD mem_fd_;
+
+  // Used by ReadBatch() when io_uring is available, otherwise nullptr. This is
+  // created on the first call to ReadBatch(), and destroyed for good if it
+  // fails.
+  mutable std::unique_ptr<IoUring> io_uring_;
+
+  Source* source_;  // weak
+
   pid_t pid_;
+  mutable IoUringState io_uring_state_;
 
   DISALLOW_COPY_AND_ASSIGN(ProcessMemory);
 };
@@ -78,6 +78,20 @@ bool ProcessMemoryRange::Read(VMAddress address,
   return memory_->Read(address, size, buffer);
 }
 
+bool ProcessMemoryRange::ReadBatch(
+    const std::vector<ProcessMemory::ReadRequest>& requests) const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  for (const ProcessMemory::ReadRequest& request : requests) {
+    CheckedVMAddressRange read_range(
+        range_.Is64Bit(), request.address, request.size);
+    if (!read_range.IsValid() || !range_.ContainsRange(read_range)) {
+      LOG(ERROR) << "read out of range";
+      return false;
+    }
+  }
+  return memory_->ReadBatch(requests);
+}
+
 bool ProcessMemoryRange::ReadCStringSizeLimited(VMAddress address,
                                                 size_t size,
                                                 std::string* string) const {
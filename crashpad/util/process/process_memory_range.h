@@ -18,6 +18,7 @@
 #include <sys/types.h>
 
 #include <string>
+#include <vector>
 
 #include "base/macros.h"
 #include "util/misc/address_types.h"
@@ -99,6 +100,18 @@ class ProcessMemoryRange {
   //!     failure, with a message logged.
   bool Read(VMAddress address, size_t size, void* buffer) const;
 
+  //! \brief Copies several memory regions from the target process into
+  //!     caller-provided buffers in the current process.
+  //!
+  //! See ProcessMemory::ReadBatch().
+  //!
+  //! \param[in] requests The regions to copy. Every region must lie within
+  //!     this object’s range.
+  //!
+  //! \return `true` if every region was copied successfully. `false` on
+  //!     failure, with a message logged.
+  bool ReadBatch(const std::vector<ProcessMemory::ReadRequest>& requests) const;
+
   //! \brief Reads a `NUL`-terminated C string from the target process into a
   //!     string in the current process.
   //!
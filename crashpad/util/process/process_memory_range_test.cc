@@ -17,6 +17,7 @@
 #include <unistd.h>
 
 #include <limits>
+#include <vector>
 
 #include "base/logging.h"
 #include "build/build_config.h"
@@ -77,6 +78,23 @@ TEST(ProcessMemoryRange, Basic) {
       string2_addr, arraysize(kTestObject.string2), &string));
   EXPECT_FALSE(range2.Read(object_addr, sizeof(object), &object));
 
+  // A batch fails if any of its regions is outside the range.
+  TestObject batch_object;
+  std::vector<ProcessMemory::ReadRequest> requests(1);
+  requests[0].address = string1_addr;
+  requests[0].size = sizeof(batch_object.string1);
+  requests[0].buffer = batch_object.string1;
+  ASSERT_TRUE(range2.ReadBatch(requests));
+  EXPECT_STREQ(batch_object.string1, kTestObject.string1);
+
+  requests.resize(2);
+  requests[1].address = string2_addr;
+  requests[1].size = sizeof(batch_object.string2);
+  requests[1].buffer = batch_object.string2;
+  EXPECT_FALSE(range2.ReadBatch(requests));
+  ASSERT_TRUE(range.ReadBatch(requests));
+  EXPECT_STREQ(batch_object.string2, kTestObject.string2);
+
   // String reads fail if the NUL terminator is outside the range.
   ASSERT_TRUE(range2.RestrictRange(string1_addr, strlen(kTestObject.string1)));
   EXPECT_FALSE(range2.ReadCStringSizeLimited(
@@ -18,7 +18,9 @@
 #include <sys/mman.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <memory>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "test/errors.h"
@@ -121,6 +123,62 @@ TEST(ProcessMemory, ReadForked) {
   test.RunAgainstForked();
 }
 
+class ReadBatchTest : public TargetProcessTest {
+ public:
+  ReadBatchTest()
+      : TargetProcessTest(),
+        page_size_(getpagesize()),
+        region_size_(16 * page_size_),
+        region_(new char[region_size_]) {
+    for (size_t index = 0; index < region_size_; ++index) {
+      region_[index] = (index * 7) % 251;
+    }
+  }
+
+ private:
+  void DoTest(pid_t pid) override {
+    ProcessMemory memory;
+    ASSERT_TRUE(memory.Initialize(pid));
+
+    VMAddress address = FromPointerCast<VMAddress>(region_.get());
+    std::unique_ptr<char[]> result(new char[region_size_]);
+    memset(result.get(), 0, region_size_);
+
+    // Split the region into many small, unaligned reads, more than can be
+    // submitted together, including some of length 0.
+    std::vector<ProcessMemory::ReadRequest> requests;
+    size_t offset = 0;
+    for (size_t size = 0; offset < region_size_; size = (size + 37) % 301) {
+      size = std::min(size, region_size_ - offset);
+      requests.push_back({address + offset, size, result.get() + offset});
+      offset += size;
+    }
+    ASSERT_GT(requests.size(), 64u);
+
+    ASSERT_TRUE(memory.ReadBatch(requests));
+    EXPECT_EQ(memcmp(region_.get(), result.get(), region_size_), 0);
+
+    // An empty batch succeeds.
+    EXPECT_TRUE(memory.ReadBatch(std::vector<ProcessMemory::ReadRequest>()));
+  }
+
+  const size_t page_size_;
+  const size_t region_size_;
+  std::unique_ptr<char[]> region_;
+
+  DISALLOW_COPY_AND_ASSIGN(ReadBatchTest);
+};
+
+TEST(ProcessMemory, ReadBatchSelf) {
+  ReadBatchTest test;
+  test.RunAgainstSelf();
+}
+
+TEST(ProcessMemory, ReadBatchForked) {
+  ReadBatchTest test;
+  test.RunAgainstForked();
+}
+
 bool ReadCString(const ProcessMemory& memory,
                  const char* pointer,
                  std::string* result) {
@@ -270,6 +328,16 @@ class ReadUnmappedTest : public TargetProcessTest {
     EXPECT_FALSE(memory.Read(page_addr1, region_size_, result_.get()));
     EXPECT_FALSE(memory.Read(page_addr2, page_size_, result_.get()));
     EXPECT_FALSE(memory.Read(page_addr2 - 1, 2, result_.get()));
+
+    // ReadBatch() may map memory in the current process, possibly into the
+    // hole that this test relies on, so only test it against another process.
+    if (pid != getpid()) {
+      std::vector<ProcessMemory::ReadRequest> requests;
+      requests.push_back({page_addr1, page_size_, result_.get()});
+      EXPECT_TRUE(memory.ReadBatch(requests));
+      requests.push_back({page_addr2 - 1, 2, result_.get() + page_size_});
+      EXPECT_FALSE(memory.ReadBatch(requests));
+    }
   }
 
   ScopedMmap pages_;
@@ -50,13 +50,42 @@
         'linux/checked_address_range.h',
         'linux/direct_ptrace_connection.cc',
         'linux/direct_ptrace_connection.h',
+        'linux/exception_handler_protocol.cc',
+        'linux/exception_handler_protocol.h',
+        'linux/exception_information.h',
+        'linux/io_uring.cc',
+        'linux/io_uring.h',
+        'linux/io_uring_file_writer.cc',
+        'linux/io_uring_file_writer.h',
         'linux/memory_map.cc',
         'linux/memory_map.h',
+        'linux/memory_pressure.cc',
+        'linux/memory_pressure.h',
         'linux/proc_stat_reader.cc',
         'linux/proc_stat_reader.h',
+        'linux/proc_task_reader.cc',
+        'linux/proc_task_reader.h',
+        'linux/ptrace_broker.cc',
+        'linux/ptrace_broker.h',
+        'linux/ptrace_client.cc',
+        'linux/ptrace_client.h',
         'linux/ptrace_connection.h',
+        'linux/ptrace_recording.cc',
+        'linux/ptrace_recording.h',
         'linux/ptracer.cc',
         'linux/ptracer.h',
+        'linux/read_file_quietly.cc',
+        'linux/read_file_quietly.h',
+        'linux/recording_ptrace_connection.cc',
+        'linux/recording_ptrace_connection.h',
+        'linux/related_processes.cc',
+        'linux/related_processes.h',
+        'linux/replay_ptrace_connection.cc',
+        'linux/replay_ptrace_connection.h',
+        'linux/resource_governor.cc',
+        'linux/resource_governor.h',
+        'linux/scoped_process_freeze.cc',
+        'linux/scoped_process_freeze.h',
         'linux/scoped_ptrace_attach.cc',
         'linux/scoped_ptrace_attach.h',
         'linux/thread_info.cc',
@@ -139,10 +168,16 @@
         'misc/uuid.h',
         'misc/zlib.cc',
         'misc/zlib.h',
+        'net/adaptive_gzip.cc',
+        'net/adaptive_gzip.h',
         'net/http_body.cc',
         'net/http_body.h',
         'net/http_body_gzip.cc',
         'net/http_body_gzip.h',
+        'net/http_body_tee_file_writer.cc',
+        'net/http_body_tee_file_writer.h',
+        'net/http_endpoint_selector.cc',
+        'net/http_endpoint_selector.h',
         'net/http_headers.h',
         'net/http_multipart_builder.cc',
         'net/http_multipart_builder.h',
@@ -177,6 +212,8 @@
         'posix/signals.h',
         'posix/symbolic_constants_posix.cc',
         'posix/symbolic_constants_posix.h',
+        'process/mapped_file_memory_source.cc',
+        'process/mapped_file_memory_source.h',
         'process/process_memory.h',
         'process/process_memory.cc',
         'process/process_memory_range.cc',
@@ -40,9 +40,18 @@
         'file/file_reader_test.cc',
         'file/string_file_test.cc',
         'linux/auxiliary_vector_test.cc',
+        'linux/io_uring_file_writer_test.cc',
+        'linux/io_uring_test.cc',
         'linux/memory_map_test.cc',
+        'linux/memory_pressure_test.cc',
         'linux/proc_stat_reader_test.cc',
+        'linux/ptrace_broker_test.cc',
+        'linux/ptrace_recording_test.cc',
         'linux/ptracer_test.cc',
+        'linux/read_file_quietly_test.cc',
+        'linux/related_processes_test.cc',
+        'linux/resource_governor_test.cc',
+        'linux/scoped_process_freeze_test.cc',
         'linux/scoped_ptrace_attach_test.cc',
         'mac/launchd_test.mm',
         'mac/mac_util_test.mm',
@@ -73,10 +82,13 @@
         'misc/random_string_test.cc',
         'misc/reinterpret_bytes_test.cc',
         'misc/uuid_test.cc',
+        'net/adaptive_gzip_test.cc',
         'net/http_body_gzip_test.cc',
+        'net/http_body_tee_file_writer_test.cc',
         'net/http_body_test.cc',
         'net/http_body_test_util.cc',
         'net/http_body_test_util.h',
+        'net/http_endpoint_selector_test.cc',
         'net/http_multipart_builder_test.cc',
         'net/http_transport_test.cc',
         'net/url_test.cc',
@@ -88,6 +100,7 @@
         'posix/scoped_mmap_test.cc',
         'posix/signals_test.cc',
         'posix/symbolic_constants_posix_test.cc',
+        'process/mapped_file_memory_source_test.cc',
         'process/process_memory_range_test.cc',
         'process/process_memory_test.cc',
         'stdlib/aligned_allocator_test.cc',